@@ -0,0 +1,374 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "Arduino.h"
+#include "EventLoop.h"
+#include <errno.h>
+#include <new>
+#include <unistd.h>
+#include <sys/select.h>
+#include "esp_timer.h"
+#include "esp_vfs_eventfd.h"
+#include "esp32-hal-log.h"
+
+#define NEVER UINT64_MAX
+
+// The loop waits on a notification index of its own, so it neither takes nor
+// clears the ones other code on the loop task gives at index 0. With a single
+// index (CONFIG_FREERTOS_TASK_NOTIFICATION_ARRAY_ENTRIES) it has to share it.
+#ifndef EVENT_LOOP_NOTIFY_INDEX
+#define EVENT_LOOP_NOTIFY_INDEX (configTASK_NOTIFICATION_ARRAY_ENTRIES - 1)
+#endif
+
+EventLoop::EventLoop()
+  : _cells(nullptr), _mask(0), _tail(0), _head(0), _dropped(0), _selecting(false), _task(nullptr), _wakeFd(-1), _maxIdleMs(EVENT_LOOP_FOREVER),
+    _timers(nullptr), _watches(nullptr), _cursor(nullptr) {}
+
+EventLoop::~EventLoop() {
+  end();
+}
+
+bool EventLoop::begin(size_t queueSize) {
+  if (running()) {
+    return true;
+  }
+  uint32_t size = 2;
+  while (size < queueSize) {
+    size <<= 1;
+  }
+  _cells = new (std::nothrow) Cell[size];
+  if (_cells == nullptr) {
+    log_e("No memory for %u deferred calls", (unsigned)size);
+    return false;
+  }
+  // a cell is free for the post with the same sequence, and holds a call for
+  // the loop when the sequence is one more than its position
+  for (uint32_t i = 0; i < size; i++) {
+    _cells[i].sequence.store(i, std::memory_order_relaxed);
+  }
+  _mask = size - 1;
+  _head = 0;
+  _tail.store(0, std::memory_order_relaxed);
+  _task = xTaskGetCurrentTaskHandle();
+  return true;
+}
+
+void EventLoop::end() {
+  if (!running()) {
+    return;
+  }
+  while (_timers) {
+    unlink(_timers);
+  }
+  while (_watches) {
+    unwatch(_watches);
+  }
+  if (_wakeFd >= 0) {
+    close(_wakeFd);
+    _wakeFd = -1;
+  }
+  delete[] _cells;
+  _cells = nullptr;
+  _task = nullptr;
+}
+
+// Bounded multi-producer queue (D. Vyukov): a producer claims a cell by moving
+// the tail past it, fills it and publishes it by setting its sequence. It
+// never blocks, so tasks and ISRs can post concurrently.
+bool EventLoop::post(event_loop_cb_t fn, void *arg) {
+  if (!running() || fn == nullptr) {
+    return false;
+  }
+  uint32_t pos = _tail.load(std::memory_order_relaxed);
+  Cell *cell;
+  for (;;) {
+    cell = &_cells[pos & _mask];
+    int32_t diff = (int32_t)(cell->sequence.load(std::memory_order_acquire) - pos);
+    if (diff == 0) {
+      if (_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (diff < 0) {
+      // the cell still holds the call posted one lap ago
+      _dropped.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    } else {
+      pos = _tail.load(std::memory_order_relaxed);
+    }
+  }
+  cell->fn = fn;
+  cell->arg = arg;
+  cell->sequence.store(pos + 1, std::memory_order_release);
+  signal();
+  return true;
+}
+
+void EventLoop::wake() {
+  if (running()) {
+    signal();
+  }
+}
+
+// The task notification wakes a wait in ulTaskNotifyTakeIndexed(), the eventfd one in
+// select(). waitSelect() sets _selecting before it takes the notification, so
+// one of the two sees the other.
+void EventLoop::signal() {
+  if (xPortInIsrContext()) {
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveIndexedFromISR(_task, EVENT_LOOP_NOTIFY_INDEX, &woken);
+    if (_selecting.load()) {
+      wakeSelect();
+    }
+    if (woken) {
+      portYIELD_FROM_ISR();
+    }
+    return;
+  }
+  xTaskNotifyGiveIndexed(_task, EVENT_LOOP_NOTIFY_INDEX);
+  if (_selecting.load()) {
+    wakeSelect();
+  }
+}
+
+void EventLoop::wakeSelect() {
+  uint64_t one = 1;
+  ssize_t written = write(_wakeFd, &one, sizeof(one));
+  (void)written;
+}
+
+size_t EventLoop::runPosted() {
+  // only the calls posted so far, one that posts itself runs again next round
+  uint32_t end = _tail.load(std::memory_order_acquire);
+  size_t count = 0;
+  while (_head != end) {
+    Cell *cell = &_cells[_head & _mask];
+    if (cell->sequence.load(std::memory_order_acquire) != _head + 1) {
+      break;
+    }
+    event_loop_cb_t fn = cell->fn;
+    void *arg = cell->arg;
+    cell->sequence.store(_head + _mask + 1, std::memory_order_release);
+    _head++;
+    fn(arg);
+    count++;
+  }
+  return count;
+}
+
+void EventLoop::insert(EventLoopTimer *timer) {
+  EventLoopTimer **link = &_timers;
+  while (*link && (*link)->due <= timer->due) {
+    link = &(*link)->next;
+  }
+  timer->next = *link;
+  if (*link) {
+    (*link)->pprev = &timer->next;
+  }
+  *link = timer;
+  timer->pprev = link;
+}
+
+void EventLoop::unlink(EventLoopTimer *timer) {
+  *timer->pprev = timer->next;
+  if (timer->next) {
+    timer->next->pprev = timer->pprev;
+  }
+  timer->next = nullptr;
+  timer->pprev = nullptr;
+}
+
+void EventLoop::scheduleUs(EventLoopTimer *timer, uint64_t delayUs, uint64_t periodUs) {
+  if (scheduled(timer)) {
+    unlink(timer);
+  }
+  timer->due = esp_timer_get_time() + delayUs;
+  timer->period = periodUs;
+  insert(timer);
+}
+
+void EventLoop::cancel(EventLoopTimer *timer) {
+  if (scheduled(timer)) {
+    unlink(timer);
+  }
+}
+
+size_t EventLoop::runTimers(uint64_t now) {
+  size_t count = 0;
+  while (_timers && _timers->due <= now) {
+    EventLoopTimer *timer = _timers;
+    unlink(timer);
+    if (timer->period) {
+      timer->due += timer->period;
+      if (timer->due <= now) {
+        timer->due = now + timer->period;
+      }
+      insert(timer);
+    }
+    timer->callback(timer->arg);
+    count++;
+  }
+  return count;
+}
+
+bool EventLoop::watch(EventLoopWatch *w, int fd, uint8_t events) {
+  if (!running() || fd < 0 || fd >= FD_SETSIZE || w->callback == nullptr) {
+    log_e("Cannot watch fd %d", fd);
+    return false;
+  }
+  if (_wakeFd < 0) {
+    // select() is woken through an eventfd, the VFS shared with OpenThread
+    esp_err_t err = arduino_eventfd_register();
+    if (err != ESP_OK) {
+      log_e("eventfd register failed: %d", err);
+      return false;
+    }
+    _wakeFd = eventfd(0, EFD_SUPPORT_ISR);
+    if (_wakeFd < 0) {
+      log_e("eventfd failed: %d", errno);
+      return false;
+    }
+  }
+  if (w->pprev) {
+    unwatch(w);
+  }
+  w->fd = fd;
+  w->events = events;
+  w->next = _watches;
+  if (_watches) {
+    _watches->pprev = &w->next;
+  }
+  _watches = w;
+  w->pprev = &_watches;
+  return true;
+}
+
+void EventLoop::unwatch(EventLoopWatch *w) {
+  if (w->pprev == nullptr) {
+    return;
+  }
+  if (_cursor == w) {
+    _cursor = w->next;
+  }
+  *w->pprev = w->next;
+  if (w->next) {
+    w->next->pprev = w->pprev;
+  }
+  w->next = nullptr;
+  w->pprev = nullptr;
+}
+
+// Blocks until the given time or a signal, in select() when there are watches.
+// Returns the number of watch callbacks run.
+size_t EventLoop::wait(uint64_t until) {
+  if (_watches) {
+    return waitSelect(until);
+  }
+  TickType_t ticks = portMAX_DELAY;
+  if (until != NEVER) {
+    uint64_t now = esp_timer_get_time();
+    uint64_t tickUs = portTICK_PERIOD_MS * 1000ULL;
+    // rounded up, the wait must not end before the time
+    uint64_t delta = until > now ? (until - now + tickUs - 1) / tickUs : 0;
+    ticks = delta < portMAX_DELAY ? (TickType_t)delta : portMAX_DELAY - 1;
+  }
+  ulTaskNotifyTakeIndexed(EVENT_LOOP_NOTIFY_INDEX, pdTRUE, ticks);
+  return 0;
+}
+
+size_t EventLoop::waitSelect(uint64_t until) {
+  fd_set readSet, writeSet;
+  FD_ZERO(&readSet);
+  FD_ZERO(&writeSet);
+  FD_SET(_wakeFd, &readSet);
+  int maxFd = _wakeFd;
+  for (EventLoopWatch *w = _watches; w; w = w->next) {
+    if (w->events & EVENT_LOOP_READ) {
+      FD_SET(w->fd, &readSet);
+    }
+    if (w->events & EVENT_LOOP_WRITE) {
+      FD_SET(w->fd, &writeSet);
+    }
+    maxFd = w->fd > maxFd ? w->fd : maxFd;
+  }
+  _selecting.store(true);
+  // a signal sent before _selecting was set has only notified the task
+  if (ulTaskNotifyTakeIndexed(EVENT_LOOP_NOTIFY_INDEX, pdTRUE, 0)) {
+    until = 0;
+  }
+  struct timeval tv;
+  struct timeval *timeout = nullptr;
+  if (until != NEVER) {
+    uint64_t now = esp_timer_get_time();
+    uint64_t delta = until > now ? until - now : 0;
+    tv.tv_sec = delta / 1000000;
+    tv.tv_usec = delta % 1000000;
+    timeout = &tv;
+  }
+  int ready = ::select(maxFd + 1, &readSet, &writeSet, nullptr, timeout);
+  _selecting.store(false);
+  if (ready < 0) {
+    // most likely a descriptor closed while watched, do not spin on it
+    log_e("select failed: %d", errno);
+    ulTaskNotifyTakeIndexed(EVENT_LOOP_NOTIFY_INDEX, pdTRUE, until == NEVER ? portMAX_DELAY : pdMS_TO_TICKS(10));
+    return 0;
+  }
+  // the notifications sent alongside the eventfd
+  ulTaskNotifyTakeIndexed(EVENT_LOOP_NOTIFY_INDEX, pdTRUE, 0);
+  if (ready == 0) {
+    return 0;
+  }
+  if (FD_ISSET(_wakeFd, &readSet)) {
+    uint64_t value;
+    ssize_t len = read(_wakeFd, &value, sizeof(value));
+    (void)len;
+  }
+  size_t count = 0;
+  _cursor = _watches;
+  while (_cursor) {
+    EventLoopWatch *w = _cursor;
+    _cursor = w->next;
+    uint8_t events = 0;
+    if ((w->events & EVENT_LOOP_READ) && FD_ISSET(w->fd, &readSet)) {
+      events |= EVENT_LOOP_READ;
+    }
+    if ((w->events & EVENT_LOOP_WRITE) && FD_ISSET(w->fd, &writeSet)) {
+      events |= EVENT_LOOP_WRITE;
+    }
+    if (events) {
+      w->callback(w->fd, events, w->arg);
+      count++;
+    }
+  }
+  return count;
+}
+
+size_t EventLoop::runOnce(uint32_t timeoutMs) {
+  if (!running()) {
+    return 0;
+  }
+  uint32_t limitMs = timeoutMs < _maxIdleMs ? timeoutMs : _maxIdleMs;
+  uint64_t limit = limitMs == EVENT_LOOP_FOREVER ? NEVER : esp_timer_get_time() + limitMs * 1000ULL;
+  size_t count = 0;
+  for (;;) {
+    uint64_t until = limit;
+    if (_timers && _timers->due < until) {
+      until = _timers->due;
+    }
+    count += wait(until);
+    count += runPosted();
+    uint64_t now = esp_timer_get_time();
+    count += runTimers(now);
+    // a wait can end early, on a notification meant for someone else or on a
+    // tick boundary, then the loop goes on waiting
+    if (count || now >= limit) {
+      return count;
+    }
+  }
+}
+
+#if !defined(NO_GLOBAL_INSTANCES) && !defined(NO_GLOBAL_EVENTLOOP)
+EventLoop LoopEvents;
+#endif
@@ -0,0 +1,158 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+/*
+ * Opt-in event loop of the loop task.
+ *
+ * Once begin() has been called from setup(), loopTask no longer calls loop()
+ * back to back: after each loop() it blocks until there is something to do,
+ * which is one of
+ *  - a deferred call posted with post() from any task or from an ISR, kept in
+ *    a fixed size lock-free queue until the loop task runs it,
+ *  - an EventLoopTimer coming due,
+ *  - a file descriptor (lwIP socket, eventfd) watched with watch() becoming
+ *    readable or writable, waited on with select(),
+ *  - the maximum idle time set with setMaxIdle() running out,
+ * runs the callbacks and then calls loop() again. Sketches that still poll in
+ * loop() (WebServer::handleClient(), ArduinoOTA.handle(), ...) set a maximum
+ * idle time, or watch the sockets involved, so they get called often enough.
+ *
+ * Timers and watches are intrusive nodes owned by the caller, and the loop
+ * allocates nothing after begin(). Everything but post() and wake() is called
+ * from the task that called begin(); other tasks post a call that does it.
+ * Callbacks run on that task and may schedule, cancel, watch and unwatch
+ * freely, including the node they were called for.
+ */
+
+#define EVENT_LOOP_FOREVER UINT32_MAX
+#define EVENT_LOOP_READ    0x01
+#define EVENT_LOOP_WRITE   0x02
+
+typedef void (*event_loop_cb_t)(void *arg);
+// ready is EVENT_LOOP_READ and/or EVENT_LOOP_WRITE
+typedef void (*event_loop_fd_cb_t)(int fd, uint8_t ready, void *arg);
+
+struct EventLoopTimer {
+  EventLoopTimer(event_loop_cb_t cb = nullptr, void *a = nullptr) : callback(cb), arg(a) {}
+
+  EventLoopTimer *next = nullptr;
+  EventLoopTimer **pprev = nullptr;  // the pointer to this timer, nullptr when not scheduled
+  uint64_t due = 0;                  // esp_timer_get_time() it fires at
+  uint64_t period = 0;               // microseconds, 0 for a one shot timer
+  event_loop_cb_t callback = nullptr;
+  void *arg = nullptr;
+};
+
+struct EventLoopWatch {
+  EventLoopWatch(event_loop_fd_cb_t cb = nullptr, void *a = nullptr) : callback(cb), arg(a) {}
+
+  EventLoopWatch *next = nullptr;
+  EventLoopWatch **pprev = nullptr;  // nullptr when not watched
+  int fd = -1;
+  uint8_t events = 0;
+  event_loop_fd_cb_t callback = nullptr;
+  void *arg = nullptr;
+};
+
+class EventLoop {
+public:
+  EventLoop();
+  ~EventLoop();
+
+  // Starts the loop on the calling task with room for queueSize deferred
+  // calls (rounded up to a power of two)
+  bool begin(size_t queueSize = 32);
+  void end();
+  bool running() const {
+    return _cells != nullptr;
+  }
+
+  // Queues fn(arg) to run on the loop task; any task or ISR. false when the
+  // queue is full or the loop is not running.
+  bool post(event_loop_cb_t fn, void *arg = nullptr);
+  // Makes the loop task return from its wait; any task or ISR
+  void wake();
+
+  // Fires the timer in delayMs and then every periodMs if that is not 0. A
+  // periodic timer that falls more than a period behind skips the missed runs.
+  // A scheduled timer is moved.
+  void schedule(EventLoopTimer *timer, uint32_t delayMs, uint32_t periodMs = 0) {
+    scheduleUs(timer, delayMs * 1000ULL, periodMs * 1000ULL);
+  }
+  void scheduleUs(EventLoopTimer *timer, uint64_t delayUs, uint64_t periodUs = 0);
+  void cancel(EventLoopTimer *timer);
+  static bool scheduled(const EventLoopTimer *timer) {
+    return timer->pprev != nullptr;
+  }
+
+  // Calls the callback of the watch while fd is ready for any of events
+  // (level triggered). A watched node is moved to the new descriptor.
+  bool watch(EventLoopWatch *w, int fd, uint8_t events);
+  void unwatch(EventLoopWatch *w);
+
+  // Longest time loop() goes without being called, EVENT_LOOP_FOREVER for none
+  void setMaxIdle(uint32_t ms) {
+    _maxIdleMs = ms;
+  }
+  uint32_t maxIdle() const {
+    return _maxIdleMs;
+  }
+
+  // Waits up to timeoutMs (capped by the maximum idle time) for a deferred
+  // call, a timer or a watched descriptor, runs what is ready and returns the
+  // number of callbacks run. loopTask calls this after every loop().
+  size_t runOnce(uint32_t timeoutMs = EVENT_LOOP_FOREVER);
+
+  // Deferred calls dropped because the queue was full
+  uint32_t dropped() const {
+    return _dropped.load(std::memory_order_relaxed);
+  }
+
+private:
+  struct Cell {
+    std::atomic<uint32_t> sequence;
+    event_loop_cb_t fn;
+    void *arg;
+  };
+
+  Cell *_cells;
+  uint32_t _mask;
+  std::atomic<uint32_t> _tail;  // next cell to post into
+  uint32_t _head;               // next cell to run, loop task only
+  std::atomic<uint32_t> _dropped;
+  std::atomic<bool> _selecting;  // the loop task waits in select(), wake it through _wakeFd
+  TaskHandle_t _task;
+  int _wakeFd;
+  uint32_t _maxIdleMs;
+  EventLoopTimer *_timers;  // sorted by due time
+  EventLoopWatch *_watches;
+  EventLoopWatch *_cursor;  // next watch to dispatch, moved on by unwatch()
+
+  size_t runPosted();
+  size_t runTimers(uint64_t now);
+  size_t wait(uint64_t until);
+  size_t waitSelect(uint64_t until);
+  void insert(EventLoopTimer *timer);
+  void unlink(EventLoopTimer *timer);
+  void signal();
+  void wakeSelect();
+};
+
+#if !defined(NO_GLOBAL_INSTANCES) && !defined(NO_GLOBAL_EVENTLOOP)
+extern EventLoop LoopEvents;
+#endif
+
+#endif
@@ -13,22 +13,47 @@ typedef void (*voidFuncPtrArg)(void *);
 
 extern "C" {
 extern void __attachInterruptFunctionalArg(uint8_t pin, voidFuncPtrArg userFunc, void *arg, int intr_type, bool functional);
+extern void __detachInterrupt(uint8_t pin);
 }
 
-void ARDUINO_ISR_ATTR interruptFunctional(void *arg) {
-  InterruptArgStructure *localArg = (InterruptArgStructure *)arg;
-  if (localArg->interruptFunction) {
-    localArg->interruptFunction();
+// One callable per pin, in DRAM: attaching allocates nothing, and the GPIO
+// ISR reaches the callable through a single call
+static InterruptFunction functionalInterrupts[SOC_GPIO_PIN_COUNT];
+
+InterruptFunction *functionalInterruptSlot(uint8_t pin) {
+  if (pin >= SOC_GPIO_PIN_COUNT) {
+    return nullptr;
+  }
+  InterruptFunction *slot = &functionalInterrupts[pin];
+  if (*slot) {
+    // the ISR must be gone before its callable is replaced
+    __detachInterrupt(pin);
   }
+  return slot;
+}
+
+void attachFunctionalInterrupt(uint8_t pin, InterruptFunction *slot, int mode) {
+  __attachInterruptFunctionalArg(pin, (voidFuncPtrArg)slot->invoker(), slot, mode, true);
 }
 
 void attachInterrupt(uint8_t pin, std::function<void(void)> intRoutine, int mode) {
-  // use the local interrupt routine which takes the ArgStructure as argument
-  __attachInterruptFunctionalArg(pin, (voidFuncPtrArg)interruptFunctional, new InterruptArgStructure{intRoutine}, mode, true);
+  if (!intRoutine) {
+    // the ISR would call it and abort, so the pin is left without one
+    log_w("Empty function for pin %u, interrupt detached", pin);
+    if (pin < SOC_GPIO_PIN_COUNT) {
+      __detachInterrupt(pin);
+    }
+    return;
+  }
+  InterruptFunction *slot = functionalInterruptSlot(pin);
+  if (slot) {
+    slot->assign(std::move(intRoutine));
+    attachFunctionalInterrupt(pin, slot, mode);
+  }
 }
 
 extern "C" {
 void cleanupFunctional(void *arg) {
-  delete (InterruptArgStructure *)arg;
+  ((InterruptFunction *)arg)->reset();
 }
 }
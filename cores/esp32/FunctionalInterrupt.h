@@ -9,14 +9,104 @@
 #define CORE_CORE_FUNCTIONALINTERRUPT_H_
 
 #include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
 #include <stdint.h>
+#include "esp32-hal.h"
 
-struct InterruptArgStructure {
-  std::function<void(void)> interruptFunction;
+// Bytes a callable attached to a pin may take: a std::function, a member
+// function bound to an object or a lambda capturing a few words
+#ifndef FUNCTIONAL_INTERRUPT_STORAGE
+#define FUNCTIONAL_INTERRUPT_STORAGE (4 * sizeof(void *))
+#endif
+
+/*
+ * A void() callable kept inline, without allocating. Assigning one that does
+ * not fit FUNCTIONAL_INTERRUPT_STORAGE fails to compile. The call goes
+ * through one function pointer, placed in IRAM with the other ISR code when
+ * CONFIG_ARDUINO_ISR_IRAM is set; the callable itself has to be there too for
+ * the interrupt to run while the flash cache is disabled.
+ */
+class InterruptFunction {
+public:
+  typedef void (*invoke_t)(void *self);
+
+  InterruptFunction() : _invoke(nullptr), _destroy(nullptr) {}
+  ~InterruptFunction() {
+    reset();
+  }
+  InterruptFunction(const InterruptFunction &) = delete;
+  InterruptFunction &operator=(const InterruptFunction &) = delete;
+
+  template<typename F> void assign(F &&f) {
+    typedef typename std::decay<F>::type Fn;
+    static_assert(sizeof(Fn) <= FUNCTIONAL_INTERRUPT_STORAGE, "callable too large for FUNCTIONAL_INTERRUPT_STORAGE");
+    static_assert(alignof(Fn) <= alignof(long long), "callable alignment not supported");
+    reset();
+    new (_storage) Fn(std::forward<F>(f));
+    _invoke = call<Fn>;
+    _destroy = std::is_trivially_destructible<Fn>::value ? nullptr : destroy<Fn>;
+  }
+
+  void reset() {
+    if (_destroy) {
+      _destroy(_storage);
+    }
+    _invoke = nullptr;
+    _destroy = nullptr;
+  }
+
+  explicit operator bool() const {
+    return _invoke != nullptr;
+  }
+  void operator()() {
+    _invoke(this);
+  }
+  // Calls the callable of the InterruptFunction given as self, the ISR entry
+  invoke_t invoker() const {
+    return _invoke;
+  }
+
+private:
+  alignas(long long) unsigned char _storage[FUNCTIONAL_INTERRUPT_STORAGE];
+  invoke_t _invoke;
+  void (*_destroy)(void *storage);
+
+  template<typename Fn> static void ARDUINO_ISR_ATTR call(void *self) {
+    (*reinterpret_cast<Fn *>(static_cast<InterruptFunction *>(self)->_storage))();
+  }
+  template<typename Fn> static void destroy(void *storage) {
+    reinterpret_cast<Fn *>(storage)->~Fn();
+  }
 };
 
+// Detaches what the pin had and returns its InterruptFunction, nullptr for an
+// invalid pin
+InterruptFunction *functionalInterruptSlot(uint8_t pin);
+void attachFunctionalInterrupt(uint8_t pin, InterruptFunction *slot, int mode);
+
 // The extra set of parentheses here prevents macros defined
 // in io_pin_remap.h from applying to this declaration.
 void(attachInterrupt)(uint8_t pin, std::function<void(void)> intRoutine, int mode);
 
+// Any other callable is stored as it is, without a std::function around it.
+// Lambdas that capture nothing are attached as plain function pointers.
+template<
+  typename F, typename std::enable_if<
+                std::is_invocable_r<void, typename std::decay<F>::type &>::value
+                  && !std::is_same<typename std::decay<F>::type, std::function<void(void)>>::value && !std::is_pointer<typename std::decay<F>::type>::value,
+                int>::type = 0>
+void(attachInterrupt)(uint8_t pin, F &&intRoutine, int mode) {
+  if constexpr (std::is_convertible<F, void (*)(void)>::value) {
+    (attachInterrupt)(pin, static_cast<void (*)(void)>(intRoutine), mode);
+  } else {
+    InterruptFunction *slot = functionalInterruptSlot(pin);
+    if (slot) {
+      slot->assign(std::forward<F>(intRoutine));
+      attachFunctionalInterrupt(pin, slot, mode);
+    }
+  }
+}
+
 #endif /* CORE_CORE_FUNCTIONALINTERRUPT_H_ */
@@ -14,6 +14,9 @@
 
 #include "HashBuilder.h"
 
+// largest block read by addStream(), halved until the allocation succeeds
+#define HASH_STREAM_BUFFER_SIZE 4096
+
 void HashBuilder::add(const char *data) {
   add((const uint8_t *)data, strlen(data));
 }
@@ -36,3 +39,52 @@ void HashBuilder::addHexString(const char *data) {
 void HashBuilder::addHexString(String data) {
   addHexString(data.c_str());
 }
+
+bool HashBuilder::addStream(Stream &stream, const size_t maxLen) {
+  size_t left = maxLen;
+
+  if (stream.hasPeekBufferAPI()) {
+    size_t n;
+    while (left && (n = stream.peekAvailable()) > 0) {
+      if (n > left) {
+        n = left;
+      }
+      add((const uint8_t *)stream.peekBuffer(), n);
+      stream.peekConsume(n);
+      left -= n;
+    }
+    return true;
+  }
+
+  size_t bufSize = (maxLen < HASH_STREAM_BUFFER_SIZE) ? maxLen : HASH_STREAM_BUFFER_SIZE;
+  uint8_t *buf = NULL;
+  while (bufSize && !(buf = (uint8_t *)malloc(bufSize))) {
+    bufSize /= 2;
+  }
+  if (!buf) {
+    return maxLen == 0;
+  }
+
+  int bytesAvailable = stream.available();
+  while ((bytesAvailable > 0) && left) {
+    size_t readBytes = bytesAvailable;
+    if (readBytes > left) {
+      readBytes = left;
+    }
+    if (readBytes > bufSize) {
+      readBytes = bufSize;
+    }
+
+    size_t numBytesRead = stream.readBytes(buf, readBytes);
+    if (numBytesRead < 1) {
+      free(buf);
+      return false;
+    }
+    add(buf, numBytesRead);
+
+    left -= numBytesRead;
+    bytesAvailable = stream.available();
+  }
+  free(buf);
+  return true;
+}
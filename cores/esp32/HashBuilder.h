@@ -52,12 +52,35 @@ public:
   void addHexString(const char *data);
   void addHexString(String data);
 
-  virtual bool addStream(Stream &stream, const size_t maxLen) = 0;
+  // Adds up to maxLen bytes that the stream has available, read in large
+  // blocks or straight from the stream buffer when it shows one
+  virtual bool addStream(Stream &stream, const size_t maxLen);
   virtual void calculate() = 0;
   virtual void getBytes(uint8_t *output) = 0;
   virtual void getChars(char *output) = 0;
   virtual String toString() = 0;
   virtual size_t getHashSize() const = 0;
+
+  // Size of the blocks the hash function compresses, HMAC pads its key to it
+  virtual size_t getBlockSize() const {
+    return 64;
+  }
+
+  // The state of a digest that has been given whole blocks so far, so that a
+  // common prefix (the key block of an HMAC) is compressed only once.
+  // saveState() writes getStateSize() bytes and restoreState() continues a
+  // digest from them, in software. Both fail when the builder cannot do it.
+  virtual size_t getStateSize() const {
+    return 0;
+  }
+  virtual bool saveState(uint8_t *state) {
+    (void)state;
+    return false;
+  }
+  virtual bool restoreState(const uint8_t *state) {
+    (void)state;
+    return false;
+  }
 };
 
 #endif
@@ -29,45 +29,6 @@ void MD5Builder::add(const uint8_t *data, size_t len) {
   esp_rom_md5_update(&_ctx, data, len);
 }
 
-bool MD5Builder::addStream(Stream &stream, const size_t maxLen) {
-  const int buf_size = 512;
-  int maxLengthLeft = maxLen;
-  uint8_t *buf = (uint8_t *)malloc(buf_size);
-
-  if (!buf) {
-    return false;
-  }
-
-  int bytesAvailable = stream.available();
-  while ((bytesAvailable > 0) && (maxLengthLeft > 0)) {
-
-    // determine number of bytes to read
-    int readBytes = bytesAvailable;
-    if (readBytes > maxLengthLeft) {
-      readBytes = maxLengthLeft;  // read only until max_len
-    }
-    if (readBytes > buf_size) {
-      readBytes = buf_size;  // not read more the buffer can handle
-    }
-
-    // read data and check if we got something
-    int numBytesRead = stream.readBytes(buf, readBytes);
-    if (numBytesRead < 1) {
-      free(buf);
-      return false;
-    }
-
-    // Update MD5 with buffer payload
-    esp_rom_md5_update(&_ctx, buf, numBytesRead);
-
-    // update available number of bytes
-    maxLengthLeft -= numBytesRead;
-    bytesAvailable = stream.available();
-  }
-  free(buf);
-  return true;
-}
-
 void MD5Builder::calculate(void) {
   esp_rom_md5_final(_buf, &_ctx);
 }
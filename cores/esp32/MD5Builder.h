@@ -39,7 +39,6 @@ public:
 
   void begin(void) override;
   void add(const uint8_t *data, size_t len) override;
-  bool addStream(Stream &stream, const size_t maxLen) override;
   void calculate(void) override;
   void getBytes(uint8_t *output) override;
   void getChars(char *output) override;
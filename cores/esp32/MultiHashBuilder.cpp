@@ -0,0 +1,77 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "MultiHashBuilder.h"
+
+// input is handed to the builders in slices of this size, so that each
+// builder reads the slice while it is still in cache
+#define MULTI_HASH_SLICE_SIZE 1024
+
+bool MultiHashBuilder::addBuilder(HashBuilder *builder) {
+  if (!builder || builder == this || _count == MULTI_HASH_MAX_BUILDERS) {
+    log_e("Cannot add hash builder");
+    return false;
+  }
+  _builders[_count++] = builder;
+  return true;
+}
+
+void MultiHashBuilder::begin() {
+  for (size_t i = 0; i < _count; i++) {
+    _builders[i]->begin();
+  }
+}
+
+void MultiHashBuilder::add(const uint8_t *data, size_t len) {
+  while (len) {
+    size_t slice = (len < MULTI_HASH_SLICE_SIZE) ? len : MULTI_HASH_SLICE_SIZE;
+    for (size_t i = 0; i < _count; i++) {
+      _builders[i]->add(data, slice);
+    }
+    data += slice;
+    len -= slice;
+  }
+}
+
+void MultiHashBuilder::calculate() {
+  for (size_t i = 0; i < _count; i++) {
+    _builders[i]->calculate();
+  }
+}
+
+void MultiHashBuilder::getBytes(uint8_t *output) {
+  for (size_t i = 0; i < _count; i++) {
+    _builders[i]->getBytes(output);
+    output += _builders[i]->getHashSize();
+  }
+}
+
+void MultiHashBuilder::getChars(char *output) {
+  *output = 0;
+  for (size_t i = 0; i < _count; i++) {
+    _builders[i]->getChars(output);
+    output += _builders[i]->getHashSize() * 2;
+  }
+}
+
+String MultiHashBuilder::toString() {
+  String result;
+  if (!result.reserve(getHashSize() * 2)) {
+    return result;
+  }
+  for (size_t i = 0; i < _count; i++) {
+    result += _builders[i]->toString();
+  }
+  return result;
+}
+
+size_t MultiHashBuilder::getHashSize() const {
+  size_t size = 0;
+  for (size_t i = 0; i < _count; i++) {
+    size += _builders[i]->getHashSize();
+  }
+  return size;
+}
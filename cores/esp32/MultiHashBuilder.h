@@ -0,0 +1,52 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef MultiHashBuilder_h
+#define MultiHashBuilder_h
+
+#include <WString.h>
+#include <Stream.h>
+
+#include "HashBuilder.h"
+
+#define MULTI_HASH_MAX_BUILDERS 4
+
+// Feeds the same input to several hash builders, so that one pass over the
+// data (and one read of a stream) gives every digest. The builders are not
+// owned. The result is the digests one after the other, in the order the
+// builders were added.
+
+class MultiHashBuilder : public HashBuilder {
+private:
+  HashBuilder *_builders[MULTI_HASH_MAX_BUILDERS];
+  size_t _count;
+
+public:
+  using HashBuilder::add;
+
+  MultiHashBuilder() : _count(0) {}
+
+  bool addBuilder(HashBuilder *builder);
+  void clear() {
+    _count = 0;
+  }
+  size_t count() const {
+    return _count;
+  }
+  HashBuilder *builder(size_t index) const {
+    return (index < _count) ? _builders[index] : nullptr;
+  }
+
+  void begin() override;
+  void add(const uint8_t *data, size_t len) override;
+  void calculate() override;
+  void getBytes(uint8_t *output) override;
+  void getChars(char *output) override;
+  String toString() override;
+  size_t getHashSize() const override;
+};
+
+#endif
@@ -28,6 +28,7 @@
 #include "Arduino.h"
 
 #include "Print.h"
+#include "esp32-hal-format.h"
 extern "C" {
 #include "time.h"
 }
@@ -43,31 +44,22 @@ size_t Print::write(const uint8_t *buffer, size_t size) {
   return n;
 }
 
+struct print_format_ctx {
+  Print *print;
+  size_t written;
+};
+
+static void print_format_sink(void *ctx, const char *data, size_t len) {
+  print_format_ctx *c = (print_format_ctx *)ctx;
+  c->written += c->print->write((const uint8_t *)data, len);
+}
+
 size_t Print::vprintf(const char *format, va_list arg) {
-  char loc_buf[64];
-  char *temp = loc_buf;
-  va_list copy;
-  va_copy(copy, arg);
-  int len = vsnprintf(temp, sizeof(loc_buf), format, copy);
-  va_end(copy);
-  if (len < 0) {
-    va_end(arg);
-    return 0;
-  }
-  if (len >= (int)sizeof(loc_buf)) {  // comparison of same sign type for the compiler
-    temp = (char *)malloc(len + 1);
-    if (temp == NULL) {
-      va_end(arg);
-      return 0;
-    }
-    len = vsnprintf(temp, len + 1, format, arg);
-  }
-  va_end(arg);
-  len = write((uint8_t *)temp, len);
-  if (temp != loc_buf) {
-    free(temp);
-  }
-  return len;
+  // formatted in a single pass, in chunks of up to sizeof(buf) - 1 bytes
+  char buf[128];
+  print_format_ctx ctx = {this, 0};
+  format_vprintf(buf, sizeof(buf), print_format_sink, &ctx, format, arg);
+  return ctx.written;
 }
 
 size_t Print::printf(const __FlashStringHelper *ifsh, ...) {
@@ -112,12 +104,11 @@ size_t Print::print(unsigned int n, int base) {
 }
 
 size_t Print::print(long n, int base) {
-  int t = 0;
-  if (base == 10 && n < 0) {
-    t = print('-');
-    n = -n;
+  if (base == 10) {
+    char buf[FORMAT_INT_SIZE];
+    return write(buf, format_i64(n, buf));
   }
-  return printNumber(static_cast<unsigned long>(n), base) + t;
+  return printNumber(static_cast<unsigned long>(n), base);
 }
 
 size_t Print::print(unsigned long n, int base) {
@@ -129,10 +120,10 @@ size_t Print::print(unsigned long n, int base) {
 }
 
 size_t Print::print(long long n, int base) {
-  if (base == 10 && n < 0) {
-    return print('-') + printNumber(static_cast<unsigned long long>(-(n + 1)) + 1ULL, base);
+  if (base == 10) {
+    char buf[FORMAT_INT_SIZE];
+    return write(buf, format_i64(n, buf));
   }
-
   return printNumber(static_cast<unsigned long long>(n), base);
 }
 
@@ -145,6 +136,10 @@ size_t Print::print(unsigned long long n, int base) {
 }
 
 size_t Print::print(double n, int digits) {
+  if (digits < 0) {
+    char buf[FORMAT_SHORTEST_SIZE];
+    return write(buf, format_shortest(n, buf));
+  }
   return printFloat(n, digits);
 }
 
@@ -250,51 +245,17 @@ size_t Print::println(struct tm *timeinfo, const char *format) {
 // Private Methods /////////////////////////////////////////////////////////////
 
 size_t Print::printNumber(unsigned long n, uint8_t base) {
-  char buf[8 * sizeof(n) + 1];  // Assumes 8-bit chars plus zero byte.
-  char *str = &buf[sizeof(buf) - 1];
-
-  *str = '\0';
-
-  // prevent crash if called with base == 1
-  if (base < 2) {
-    base = 10;
-  }
-
-  do {
-    char c = n % base;
-    n /= base;
-
-    *--str = c < 10 ? c + '0' : c + 'A' - 10;
-  } while (n);
-
-  return write(str);
+  return printNumber(static_cast<unsigned long long>(n), base);
 }
 
 size_t Print::printNumber(unsigned long long n, uint8_t base) {
-  char buf[8 * sizeof(n) + 1];  // Assumes 8-bit chars plus zero byte.
-  char *str = &buf[sizeof(buf) - 1];
+  char buf[FORMAT_RADIX_SIZE];
 
-  *str = '\0';
-
-  // prevent crash if called with base == 1
-  if (base < 2) {
-    base = 10;
-  }
-
-  do {
-    auto m = n;
-    n /= base;
-    char c = m - base * n;
-
-    *--str = c < 10 ? c + '0' : c + 'A' - 10;
-  } while (n);
-
-  return write(str);
+  // bases below 2 (which used to crash) and above 36 are printed in decimal
+  return write(buf, format_radix(n, base, true, buf));
 }
 
 size_t Print::printFloat(double number, uint8_t digits) {
-  size_t n = 0;
-
   if (isnan(number)) {
     return print("nan");
   }
@@ -308,37 +269,20 @@ size_t Print::printFloat(double number, uint8_t digits) {
     return print("ovf");  // constant determined empirically
   }
 
-  // Handle negative numbers
-  if (number < 0.0) {
-    n += print('-');
-    number = -number;
-  }
-
-  // Round correctly so that print(1.999, 2) prints as "2.00"
-  double rounding = 0.5;
-  for (uint8_t i = 0; i < digits; ++i) {
-    rounding /= 10.0;
-  }
-
-  number += rounding;
-
-  // Extract the integer part of the number and print it
-  unsigned long int_part = (unsigned long)number;
-  double remainder = number - (double)int_part;
-  n += print(int_part);
-
-  // Print the decimal point, but only if there are digits beyond
-  if (digits > 0) {
-    n += print(".");
+  // sign, ten integer digits, the point and the decimals, rounded halfway away from zero
+  char tmp[64];
+  char *buf = tmp;
+  size_t len = format_fixed(number, digits, tmp, sizeof(tmp));
+  if (len >= sizeof(tmp)) {
+    buf = (char *)malloc(len + 1);
+    if (buf == NULL) {
+      return 0;
+    }
+    format_fixed(number, digits, buf, len + 1);
   }
-
-  // Extract digits from the remainder one at a time
-  while (digits-- > 0) {
-    remainder *= 10.0;
-    int toPrint = int(remainder);
-    n += print(toPrint);
-    remainder -= toPrint;
+  size_t n = write(buf, len);
+  if (buf != tmp) {
+    free(buf);
   }
-
   return n;
 }
@@ -77,6 +77,19 @@ public:
   virtual int availableForWrite() {
     return 0;
   }
+
+  // Buffer lending, for Stream::sendAll() and friends: a Print that collects
+  // what it is given in a buffer of its own can lend out the free part of it,
+  // so that the source reads straight into it. writeBuffer() returns that part
+  // and its size in room (nullptr when there is none), writeCommit() then
+  // takes the first size bytes placed there and returns false on an error.
+  virtual uint8_t *writeBuffer(size_t &room) {
+    room = 0;
+    return nullptr;
+  }
+  virtual bool writeCommit(size_t size) {
+    return false;
+  }
   size_t print(const __FlashStringHelper *ifsh) {
     return print(reinterpret_cast<const char *>(ifsh));
   }
@@ -90,6 +103,7 @@ public:
   size_t print(unsigned long, int = DEC);
   size_t print(long long, int = DEC);
   size_t print(unsigned long long, int = DEC);
+  // with digits < 0, the shortest text that reads back as the same double
   size_t print(double, int = 2);
   size_t print(const Printable &);
   size_t print(struct tm *timeinfo, const char *format = NULL);
@@ -246,13 +246,151 @@ String Stream::readStringUntil(char terminator) {
   return ret;
 }
 
+// Aho-Corasick automaton over the targets of one findMulti() call: a trie of
+// the targets where every node also links to the node of its longest proper
+// suffix that is in the trie. Following those links on a mismatch keeps every
+// partial match alive, so each byte of the stream is looked at once however
+// many targets there are. With a single target the links are the KMP prefix
+// function.
+struct FindMultiNode {
+  uint16_t child;    // first child, 0 for none
+  uint16_t sibling;  // next child of the same parent, 0 for none
+  uint16_t fail;     // longest proper suffix in the trie
+  uint16_t depth;    // bytes matched in this node
+  int16_t match;     // lowest index of a target ending here, -1 for none
+  uint8_t c;
+};
+
+// nodes for the usual target sets live on the stack, 14 bytes each
+#define FIND_MULTI_STACK_NODES 64
+
+static uint16_t findMultiChild(const FindMultiNode *nodes, uint16_t node, uint8_t c) {
+  for (uint16_t child = nodes[node].child; child; child = nodes[child].sibling) {
+    if (nodes[child].c == c) {
+      return child;
+    }
+  }
+  return 0;
+}
+
+static uint16_t findMultiStep(const FindMultiNode *nodes, uint16_t node, uint8_t c) {
+  for (;;) {
+    uint16_t next = findMultiChild(nodes, node, c);
+    if (next || !node) {
+      return next;
+    }
+    node = nodes[node].fail;
+  }
+}
+
 int Stream::findMulti(struct Stream::MultiTarget *targets, int tCount) {
   // any zero length target string automatically matches and would make
   // a mess of the rest of the algorithm.
+  size_t total = 1;
+  size_t shortest = SIZE_MAX;
   for (struct MultiTarget *t = targets; t < targets + tCount; ++t) {
     if (t->len <= 0) {
       return t - targets;
     }
+    total += t->len;
+    shortest = (t->len < shortest) ? t->len : shortest;
+  }
+
+  // the automaton is indexed with 16 bits, larger sets are searched without it
+  if (total > UINT16_MAX || tCount > INT16_MAX) {
+    return findMultiLinear(targets, tCount);
+  }
+  FindMultiNode stackNodes[FIND_MULTI_STACK_NODES];
+  uint16_t stackQueue[FIND_MULTI_STACK_NODES];
+  FindMultiNode *nodes = stackNodes;
+  uint16_t *queue = stackQueue;
+  if (total > FIND_MULTI_STACK_NODES) {
+    nodes = (FindMultiNode *)malloc(total * (sizeof(FindMultiNode) + sizeof(uint16_t)));
+    if (!nodes) {
+      log_w("No memory for %u target bytes, searching without an automaton", (unsigned)total);
+      return findMultiLinear(targets, tCount);
+    }
+    queue = (uint16_t *)(nodes + total);
+  }
+
+  // the trie, with the lowest target index on each node a target ends in
+  uint16_t count = 1;
+  memset(&nodes[0], 0, sizeof(nodes[0]));
+  nodes[0].match = -1;
+  for (int t = 0; t < tCount; t++) {
+    uint16_t node = 0;
+    for (size_t i = 0; i < targets[t].len; i++) {
+      uint8_t c = targets[t].str[i];
+      uint16_t next = findMultiChild(nodes, node, c);
+      if (!next) {
+        next = count++;
+        nodes[next] = {0, nodes[node].child, 0, (uint16_t)(nodes[node].depth + 1), -1, c};
+        nodes[node].child = next;
+      }
+      node = next;
+    }
+    if (nodes[node].match < 0) {
+      nodes[node].match = t;
+    }
+  }
+
+  // suffix links breadth first, as those of a node only depend on shallower ones
+  uint32_t head = 0;
+  uint32_t tail = 0;
+  for (uint16_t child = nodes[0].child; child; child = nodes[child].sibling) {
+    queue[tail++] = child;
+  }
+  while (head < tail) {
+    uint16_t node = queue[head++];
+    // targets ending at the same byte report the lowest index, as before
+    int inherited = nodes[nodes[node].fail].match;
+    if (inherited >= 0 && (nodes[node].match < 0 || inherited < nodes[node].match)) {
+      nodes[node].match = inherited;
+    }
+    for (uint16_t child = nodes[node].child; child; child = nodes[child].sibling) {
+      nodes[child].fail = findMultiStep(nodes, nodes[node].fail, nodes[child].c);
+      queue[tail++] = child;
+    }
+  }
+
+  // Bytes that are already waiting are read in blocks, but never past the
+  // point where a target could end: what follows a match stays in the stream.
+  uint16_t node = 0;
+  int found = -1;
+  while (found < 0) {
+    uint8_t block[64];
+    size_t n = 0;
+    int waiting = available();
+    if (waiting > 1) {
+      size_t safe = (shortest > nodes[node].depth) ? shortest - nodes[node].depth : 1;
+      safe = (safe < sizeof(block)) ? safe : sizeof(block);
+      n = readBytes(block, ((size_t)waiting < safe) ? (size_t)waiting : safe);
+    }
+    if (n == 0) {
+      int c = timedRead();
+      if (c < 0) {
+        break;
+      }
+      block[0] = (uint8_t)c;
+      n = 1;
+    }
+    for (size_t i = 0; i < n && found < 0; i++) {
+      node = findMultiStep(nodes, node, block[i]);
+      found = nodes[node].match;
+    }
+  }
+
+  if (nodes != stackNodes) {
+    free(nodes);
+  }
+  return found;
+}
+
+// The search before the automaton, for when there is no memory for it: every
+// mismatch walks each target back to its longest prefix that still matches.
+int Stream::findMultiLinear(struct MultiTarget *targets, int tCount) {
+  for (struct MultiTarget *t = targets; t < targets + tCount; ++t) {
+    t->index = 0;
   }
 
   while (1) {
@@ -316,3 +454,139 @@ int Stream::findMulti(struct Stream::MultiTarget *targets, int tCount) {
   // unreachable
   return -1;
 }
+
+size_t Stream::sendAvailable(Print &to) {
+  return sendGeneric(to, SIZE_MAX, -1, false, 0);
+}
+
+size_t Stream::sendAll(Print &to, unsigned long timeoutMs) {
+  return sendGeneric(to, SIZE_MAX, -1, true, timeoutMs);
+}
+
+size_t Stream::sendSize(Print &to, size_t size, unsigned long timeoutMs) {
+  return sendGeneric(to, size, -1, true, timeoutMs);
+}
+
+size_t Stream::sendUntil(Print &to, char terminator, unsigned long timeoutMs) {
+  return sendGeneric(to, SIZE_MAX, (uint8_t)terminator, true, timeoutMs);
+}
+
+// bounce buffer for when neither side lends one, about one TCP segment
+#define STREAM_SEND_BUFFER_SIZE 1436
+
+size_t Stream::sendGeneric(Print &to, size_t size, int terminator, bool wait, unsigned long timeoutMs) {
+  if (timeoutMs == (unsigned long)-1) {
+    timeoutMs = _timeout;
+  }
+  uint8_t *bounce = nullptr;
+  size_t sent = 0;
+  bool found = false;
+  bool readFailed = false;
+  _sendReport = SendReport::Success;
+  // the clock is only read once progress stops
+  unsigned long stallStart = 0;
+  bool stalled = false;
+  while (sent < size && !found) {
+    size_t want = size - sent;
+    size_t moved = 0;
+    int waiting;
+
+    if (hasPeekBufferAPI() && peekAvailable()) {
+      // straight from the source buffer, the destination makes the one copy
+      const char *data = peekBuffer();
+      size_t n = peekAvailable();
+      n = (n < want) ? n : want;
+      const char *end = (terminator >= 0) ? (const char *)memchr(data, terminator, n) : nullptr;
+      if (end) {
+        n = end - data;
+      }
+      moved = n ? to.write((const uint8_t *)data, n) : 0;
+      found = end && moved == n;
+      peekConsume(moved + found);  // the terminator goes once all before it is out
+    } else if ((waiting = available()) > 0) {
+      size_t n = ((size_t)waiting < want) ? (size_t)waiting : want;
+      size_t room = 0;
+      uint8_t *direct = (terminator < 0) ? to.writeBuffer(room) : nullptr;
+      if (direct) {
+        // straight into the destination buffer, the source makes the one copy
+        moved = readBytes(direct, (n < room) ? n : room);
+        if (moved && !to.writeCommit(moved)) {
+          _sendReport = SendReport::WriteError;
+          break;
+        }
+      } else {
+        if (!bounce && !(bounce = (uint8_t *)malloc(STREAM_SEND_BUFFER_SIZE))) {
+          log_e("No memory for the transfer buffer");
+          _sendReport = SendReport::OutOfMemory;
+          break;
+        }
+        n = (n < STREAM_SEND_BUFFER_SIZE) ? n : STREAM_SEND_BUFFER_SIZE;
+        size_t got = 0;
+        if (terminator < 0) {
+          got = readBytes(bounce, n);
+        } else {
+          // byte by byte, so that nothing past the terminator is taken
+          for (int c; got < n && (c = read()) >= 0; got++) {
+            if (c == terminator) {
+              found = true;
+              break;
+            }
+            bounce[got] = (uint8_t)c;
+          }
+        }
+        // what has been read cannot be put back, so it goes out before anything else
+        while (moved < got) {
+          size_t w = to.write(bounce + moved, got - moved);
+          moved += w;
+          if (w) {
+            stalled = false;
+          } else if (!stalled) {
+            stalled = true;
+            stallStart = millis();
+          } else if (to.getWriteError() || millis() - stallStart >= timeoutMs) {
+            break;
+          } else {
+            delay(1);
+          }
+        }
+        if (moved < got) {
+          sent += moved;
+          _sendReport = to.getWriteError() ? SendReport::WriteError : SendReport::TimedOut;
+          break;
+        }
+      }
+      readFailed = !moved && !found;
+    } else if (!wait) {
+      break;
+    } else if (!inputCanTimeout()) {
+      // the data has ended
+      if (size != SIZE_MAX || terminator >= 0) {
+        _sendReport = SendReport::ShortOperation;
+      }
+      break;
+    }
+
+    sent += moved;
+    if (moved || found) {
+      stalled = false;
+      continue;
+    }
+    if (!stalled) {
+      stalled = true;
+      stallStart = millis();
+    }
+    if (to.getWriteError()) {
+      _sendReport = SendReport::WriteError;
+      break;
+    } else if (!wait) {
+      break;
+    } else if (millis() - stallStart >= timeoutMs) {
+      _sendReport = readFailed ? SendReport::ReadError : SendReport::TimedOut;
+      break;
+    } else {
+      delay(1);
+    }
+  }
+  free(bounce);
+  return sent;
+}
@@ -60,6 +60,7 @@ public:
 
   Stream() {
     _timeout = 1000;
+    _sendReport = SendReport::Success;
   }
 
   // parsing methods
@@ -123,6 +124,52 @@ public:
   virtual String readString();
   String readStringUntil(char terminator);
 
+  // Buffer lending: a stream that keeps received bytes in a buffer of its own
+  // can expose them, so that sendAll() and friends write them out without
+  // copying them first. peekBuffer() points at peekAvailable() bytes, valid
+  // until the next call on the stream, and peekConsume() drops bytes from
+  // the front of them.
+  virtual bool hasPeekBufferAPI() const {
+    return false;
+  }
+  virtual size_t peekAvailable() {
+    return 0;
+  }
+  virtual const char *peekBuffer() {
+    return nullptr;
+  }
+  virtual void peekConsume(size_t consume) {}
+
+  // false when available() == 0 means the end of the data, as for files and
+  // strings, rather than that more is on its way
+  virtual bool inputCanTimeout() {
+    return true;
+  }
+
+  // Stream to Print transfers. Data moves with at most one copy when either
+  // side lends its buffer, through a bounce buffer otherwise. A transfer ends
+  // with an error when nothing moves for timeoutMs (getTimeout() by default)
+  // or the destination reports a write error; getLastSendReport() tells how
+  // the last one ended. All return the number of bytes written to `to`.
+  enum class SendReport {
+    Success = 0,
+    TimedOut,        // nothing arrived for timeoutMs
+    ReadError,       // available() was positive but nothing could be read
+    WriteError,      // the destination reported a write error
+    ShortOperation,  // the data ended before size bytes or the terminator
+    OutOfMemory,     // the bounce buffer could not be allocated
+  };
+  // what is available right now, without waiting
+  size_t sendAvailable(Print &to);
+  // up to the end of the data, see inputCanTimeout()
+  size_t sendAll(Print &to, unsigned long timeoutMs = (unsigned long)-1);
+  size_t sendSize(Print &to, size_t size, unsigned long timeoutMs = (unsigned long)-1);
+  // up to the terminator, which is consumed but not written
+  size_t sendUntil(Print &to, char terminator, unsigned long timeoutMs = (unsigned long)-1);
+  SendReport getLastSendReport() const {
+    return _sendReport;
+  }
+
 protected:
   long parseInt(char ignore) {
     return parseInt(SKIP_ALL, ignore);
@@ -137,12 +184,23 @@ protected:
   struct MultiTarget {
     const char *str;  // string you're searching for
     size_t len;       // length of string you're searching for
-    size_t index;     // index used by the search routine.
+    size_t index;     // progress of the search without an automaton, reset by findMulti()
   };
 
+  SendReport _sendReport;
+  size_t sendGeneric(Print &to, size_t size, int terminator, bool wait, unsigned long timeoutMs);
+
   // This allows you to search for an arbitrary number of strings.
   // Returns index of the target that is found first or -1 if timeout occurs.
+  // When several targets end at the same byte the lowest index is returned.
+  // The stream is consumed up to and including the end of the match; the
+  // search takes time linear in the bytes read, whatever the number of targets.
+  // Targets of 64 KiB or more in total, or no memory for the search tables,
+  // fall back to the previous per-target search.
   int findMulti(struct MultiTarget *targets, int tCount);
+
+private:
+  int findMultiLinear(struct MultiTarget *targets, int tCount);
 };
 
 #undef NO_IGNORE_CHAR
@@ -53,6 +53,19 @@ int StreamString::read() {
   return -1;
 }
 
+size_t StreamString::readBytes(char *buffer, size_t length) {
+  // what is there comes out in one piece, Stream::readBytes() waits for the rest
+  size_t n = (length < this->length()) ? length : this->length();
+  if (n) {
+    memcpy(buffer, c_str(), n);
+    remove(0, n);
+  }
+  if (n < length) {
+    n += Stream::readBytes(buffer + n, length - n);
+  }
+  return n;
+}
+
 int StreamString::peek() {
   if (length()) {
     char c = charAt(0);
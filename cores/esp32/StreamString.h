@@ -31,8 +31,29 @@ public:
 
   int available() override;
   int read() override;
+  size_t readBytes(char *buffer, size_t length) override;
+  size_t readBytes(uint8_t *buffer, size_t length) override {
+    return readBytes((char *)buffer, length);
+  }
   int peek() override;
   void flush() override;
+
+  // the string itself is the buffer, and nothing is on its way
+  bool hasPeekBufferAPI() const override {
+    return true;
+  }
+  size_t peekAvailable() override {
+    return length();
+  }
+  const char *peekBuffer() override {
+    return c_str();
+  }
+  void peekConsume(size_t consume) override {
+    remove(0, consume);
+  }
+  bool inputCanTimeout() override {
+    return false;
+  }
 };
 
 #endif /* STREAMSTRING_H_ */
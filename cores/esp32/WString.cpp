@@ -24,12 +24,18 @@
 #include "Arduino.h"
 #include "WString.h"
 #include "stdlib_noniso.h"
+#include "esp32-hal-format.h"
 #include "esp32-hal-log.h"
 
 /*********************************************/
 /*  Constructors                             */
 /*********************************************/
 
+// |value|, also for the most negative value
+static inline unsigned long long magnitude(long long value) {
+  return (value < 0) ? 0ULL - (unsigned long long)value : (unsigned long long)value;
+}
+
 String::String(const char *cstr) {
   init();
   if (cstr) {
@@ -60,6 +66,11 @@ String::String(StringSumHelper &&rval) {
   move(rval);
 }
 
+String::String(StringSumHelper &rval) {
+  init();
+  *this = static_cast<const String &>(rval);
+}
+
 String::String(std::initializer_list<char> list) {
   init();
   if (list.size() > 0) {
@@ -74,48 +85,40 @@ String::String(char c) {
   *this = buf;
 }
 
+// The int constructors format as newlib's itoa() and utoa() did: bases 2 to
+// 36, and a negative int in two's complement in the other bases than 10
 String::String(unsigned char value, unsigned char base) {
   init();
-  char buf[1 + 8 * sizeof(unsigned char)];
-  utoa(value, buf, base);
-  *this = buf;
+  concatNumber(value, false, base, 36);
 }
 
 String::String(int value, unsigned char base) {
   init();
-  char buf[2 + 8 * sizeof(int)];
-  itoa(value, buf, base);
-  *this = buf;
+  if (value < 0 && base != 10) {
+    concatNumber((unsigned int)value, false, base, 36);
+  } else {
+    concatNumber(magnitude(value), value < 0, base, 36);
+  }
 }
 
 String::String(unsigned int value, unsigned char base) {
   init();
-  char buf[1 + 8 * sizeof(unsigned int)];
-  utoa(value, buf, base);
-  *this = buf;
+  concatNumber(value, false, base, 36);
 }
 
 String::String(long value, unsigned char base) {
   init();
-  char buf[2 + 8 * sizeof(long)];
-  ltoa(value, buf, base);
-  *this = buf;
+  concatNumber(magnitude(value), value < 0, base);
 }
 
 String::String(unsigned long value, unsigned char base) {
   init();
-  char buf[1 + 8 * sizeof(unsigned long)];
-  ultoa(value, buf, base);
-  *this = buf;
+  concatNumber(value, false, base);
 }
 
 String::String(float value, unsigned int decimalPlaces) {
   init();
-  char *buf = (char *)malloc(decimalPlaces + 42);
-  if (buf) {
-    *this = dtostrf(value, (decimalPlaces + 2), decimalPlaces, buf);
-    free(buf);
-  } else {
+  if (!concatFloat(value, decimalPlaces)) {
     *this = "nan";
     log_e("No enough memory for the operation.");
   }
@@ -123,11 +126,7 @@ String::String(float value, unsigned int decimalPlaces) {
 
 String::String(double value, unsigned int decimalPlaces) {
   init();
-  char *buf = (char *)malloc(decimalPlaces + 312);
-  if (buf) {
-    *this = dtostrf(value, (decimalPlaces + 2), decimalPlaces, buf);
-    free(buf);
-  } else {
+  if (!concatFloat(value, decimalPlaces)) {
     *this = "nan";
     log_e("No enough memory for the operation.");
   }
@@ -135,16 +134,12 @@ String::String(double value, unsigned int decimalPlaces) {
 
 String::String(long long value, unsigned char base) {
   init();
-  char buf[2 + 8 * sizeof(long long)];
-  lltoa(value, buf, base);
-  *this = buf;
+  concatNumber(magnitude(value), value < 0, base);
 }
 
 String::String(unsigned long long value, unsigned char base) {
   init();
-  char buf[1 + 8 * sizeof(unsigned long long)];
-  ulltoa(value, buf, base);
-  *this = buf;
+  concatNumber(value, false, base);
 }
 
 String::~String() {
@@ -182,6 +177,20 @@ bool String::reserve(unsigned int size) {
   return false;
 }
 
+bool String::grow(unsigned int size) {
+  if (buffer() && capacity() >= size) {
+    return true;
+  }
+  // Appends grow the buffer by half at least, so that building a string piece
+  // by piece reallocates it a logarithmic rather than linear number of times.
+  // When that much cannot be had, the exact size is tried before giving up.
+  unsigned int geometric = capacity() + capacity() / 2;
+  if (buffer() && !isSSO() && size < geometric && geometric < CAPACITY_MAX && reserve(geometric)) {
+    return true;
+  }
+  return reserve(size);
+}
+
 bool String::changeBuffer(unsigned int maxStrLen) {
   // Can we use SSO here to avoid allocation?
   if (maxStrLen < sizeof(sso.buff) - 1) {
@@ -294,6 +303,10 @@ String &String::operator=(StringSumHelper &&rval) {
   }
   return *this;
 }
+
+String &String::operator=(StringSumHelper &rval) {
+  return *this = static_cast<const String &>(rval);
+}
 #endif
 
 String &String::operator=(const char *cstr) {
@@ -316,7 +329,7 @@ bool String::concat(const String &s) {
       return false;
     }
     unsigned int newlen = 2 * len();
-    if (!reserve(newlen)) {
+    if (!grow(newlen)) {
       return false;
     }
     memmove(wbuffer() + len(), buffer(), len());
@@ -334,7 +347,7 @@ bool String::concat(const char *cstr, unsigned int length) {
   if (length == 0) {
     return true;
   }
-  if (!reserve(newlen)) {
+  if (!grow(newlen)) {
     return false;
   }
   if (cstr >= wbuffer() && cstr < wbuffer() + len()) {
@@ -348,6 +361,16 @@ bool String::concat(const char *cstr, unsigned int length) {
   return true;
 }
 
+#ifdef __GXX_EXPERIMENTAL_CXX0X__
+bool String::concat(String &&s) {
+  if (len() != 0 || !s.buffer() || &s == this) {
+    return concat(static_cast<const String &>(s));
+  }
+  move(s);
+  return true;
+}
+#endif
+
 bool String::concat(const char *cstr) {
   if (!cstr) {
     return false;
@@ -361,59 +384,127 @@ bool String::concat(char c) {
 }
 
 bool String::concat(unsigned char num) {
-  char buf[1 + 3 * sizeof(unsigned char)];
-  utoa(num, buf, 10);
-  return concat(buf, strlen(buf));
+  return concatNumber(num, false, 10);
 }
 
 bool String::concat(int num) {
-  char buf[2 + 3 * sizeof(int)];
-  itoa(num, buf, 10);
-  return concat(buf, strlen(buf));
+  return concatNumber(magnitude(num), num < 0, 10);
 }
 
 bool String::concat(unsigned int num) {
-  char buf[1 + 3 * sizeof(unsigned int)];
-  utoa(num, buf, 10);
-  return concat(buf, strlen(buf));
+  return concatNumber(num, false, 10);
 }
 
 bool String::concat(long num) {
-  char buf[2 + 3 * sizeof(long)];
-  ltoa(num, buf, 10);
-  return concat(buf, strlen(buf));
+  return concatNumber(magnitude(num), num < 0, 10);
 }
 
 bool String::concat(unsigned long num) {
-  char buf[1 + 3 * sizeof(unsigned long)];
-  ultoa(num, buf, 10);
-  return concat(buf, strlen(buf));
+  return concatNumber(num, false, 10);
 }
 
 bool String::concat(long long num) {
-  char buf[2 + 3 * sizeof(long long)];
-  lltoa(num, buf, 10);
-  return concat(buf, strlen(buf));
+  return concatNumber(magnitude(num), num < 0, 10);
 }
 
 bool String::concat(unsigned long long num) {
-  char buf[1 + 3 * sizeof(unsigned long long)];
-  ulltoa(num, buf, 10);
-  return concat(buf, strlen(buf));
+  return concatNumber(num, false, 10);
 }
 
 bool String::concat(float num) {
-  char buf[20];
-  char *string = dtostrf(num, 4, 2, buf);
-  return concat(string, strlen(string));
+  return concatFloat(num, 2);
 }
 
 bool String::concat(double num) {
-  char buf[20];
-  char *string = dtostrf(num, 4, 2, buf);
-  return concat(string, strlen(string));
+  return concatFloat(num, 2);
+}
+
+bool String::concatNumber(unsigned long long magnitude, bool negative, unsigned char base, unsigned char maxBase) {
+  if (base == 10) {
+    // the digit count is known up front, so they are written straight into place
+    unsigned int newlen = len() + negative + format_u64_len(magnitude);
+    if (!grow(newlen)) {
+      return false;
+    }
+    char *p = wbuffer() + len();
+    if (negative) {
+      *p++ = '-';
+    }
+    format_u64(magnitude, p);
+    setLen(newlen);
+    return true;
+  }
+  if (base < 2 || base > maxBase) {
+    // like ltoa() and itoa(), an unsupported base gives an empty string
+    return reserve(len());
+  }
+  char buf[1 + FORMAT_RADIX_SIZE];
+  char *p = buf;
+  if (negative) {
+    *p++ = '-';
+  }
+  p += format_radix(magnitude, base, false, p);
+  return concat(buf, p - buf);
+}
+
+bool String::concatFloat(double num, unsigned int decimalPlaces) {
+  // formatted into the spare capacity, and formatted again only when that was too small
+  unsigned int room = buffer() ? capacity() - len() : 0;
+  char *dest = buffer() ? wbuffer() + len() : nullptr;
+  size_t n = format_fixed(num, decimalPlaces, dest, dest ? room + 1 : 0);
+  if (n > room) {
+    if (!grow(len() + n)) {
+      return false;
+    }
+    format_fixed(num, decimalPlaces, wbuffer() + len(), n + 1);
+  }
+  setLen(len() + n);
+  return true;
+}
+
+#ifdef __GXX_EXPERIMENTAL_CXX0X__
+unsigned int String::partLength(unsigned char num) {
+  return format_u64_len(num);
+}
+
+unsigned int String::partLength(int num) {
+  return (num < 0) + format_u64_len(magnitude(num));
+}
+
+unsigned int String::partLength(unsigned int num) {
+  return format_u64_len(num);
+}
+
+unsigned int String::partLength(long num) {
+  return (num < 0) + format_u64_len(magnitude(num));
+}
+
+unsigned int String::partLength(unsigned long num) {
+  return format_u64_len(num);
+}
+
+unsigned int String::partLength(long long num) {
+  return (num < 0) + format_u64_len(magnitude(num));
 }
 
+unsigned int String::partLength(unsigned long long num) {
+  return format_u64_len(num);
+}
+
+unsigned int String::partLength(float num) {
+  return partLength((double)num);
+}
+
+unsigned int String::partLength(double num) {
+  // concat() prints two decimals. Below 1e9 this is an upper bound that saves
+  // formatting the number twice ("-999999999.99", or one more when rounding up)
+  if (fabs(num) < 1e9) {
+    return 14;
+  }
+  return format_fixed(num, 2, nullptr, 0);
+}
+#endif
+
 /*********************************************/
 /*  Concatenate                              */
 /*********************************************/
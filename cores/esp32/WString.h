@@ -68,6 +68,8 @@ public:
 #ifdef __GXX_EXPERIMENTAL_CXX0X__
   String(String &&rval);
   String(StringSumHelper &&rval);
+  // a named sum keeps its value, only an rvalue one gives up its buffer
+  String(StringSumHelper &rval);
 #endif
   explicit String(char c);
   explicit String(unsigned char, unsigned char base = 10);
@@ -111,6 +113,7 @@ public:
 #ifdef __GXX_EXPERIMENTAL_CXX0X__
   String &operator=(String &&rval);
   String &operator=(StringSumHelper &&rval);
+  String &operator=(StringSumHelper &rval);
 #endif
 
   // concatenate (works w/ built-in types, same as assignment)
@@ -137,6 +140,25 @@ public:
   bool concat(const __FlashStringHelper *str) {
     return concat(reinterpret_cast<const char *>(str));
   }
+#ifdef __GXX_EXPERIMENTAL_CXX0X__
+  // takes over the buffer of str when this string is empty
+  bool concat(String &&str);
+
+  // appends every part after growing the buffer once for their total length,
+  // e.g. json.concatAll("{\"id\":", id, ",\"temp\":", temp, '}');
+  // returns false, with the string left unchanged, if any part fails
+  template<typename... Parts> bool concatAll(const Parts &...parts) {
+    unsigned int oldLen = len();
+    if (!grow(oldLen + lengthOf(parts...))) {
+      return false;
+    }
+    if (!concatEach(parts...)) {
+      setLen(oldLen);
+      return false;
+    }
+    return true;
+  }
+#endif
 
   // if there's not enough memory for the concatenated value, the string
   // will be left unchanged (but this isn't signaled in any way)
@@ -191,6 +213,12 @@ public:
   String &operator+=(const __FlashStringHelper *str) {
     return *this += reinterpret_cast<const char *>(str);
   }
+#ifdef __GXX_EXPERIMENTAL_CXX0X__
+  String &operator+=(String &&rhs) {
+    concat(static_cast<String &&>(rhs));
+    return (*this);
+  }
+#endif
 
   friend StringSumHelper &operator+(const StringSumHelper &lhs, const String &rhs);
   friend StringSumHelper &operator+(const StringSumHelper &lhs, const char *cstr);
@@ -389,6 +417,9 @@ protected:
   void init(void);
   void invalidate(void);
   bool changeBuffer(unsigned int maxStrLen);
+  bool grow(unsigned int size);
+  bool concatNumber(unsigned long long magnitude, bool negative, unsigned char base, unsigned char maxBase = 16);
+  bool concatFloat(double num, unsigned int decimalPlaces);
 
   // copy and move
   String &copy(const char *cstr, unsigned int length);
@@ -397,12 +428,52 @@ protected:
   }
 #ifdef __GXX_EXPERIMENTAL_CXX0X__
   void move(String &rhs);
+
+  // text length of each concat() argument type, for concatAll()
+  static unsigned int partLength(const String &str) {
+    return str.length();
+  }
+  static unsigned int partLength(const char *cstr) {
+    return cstr ? strlen(cstr) : 0;
+  }
+  static unsigned int partLength(const __FlashStringHelper *str) {
+    return partLength(reinterpret_cast<const char *>(str));
+  }
+  static unsigned int partLength(char) {
+    return 1;
+  }
+  static unsigned int partLength(unsigned char num);
+  static unsigned int partLength(int num);
+  static unsigned int partLength(unsigned int num);
+  static unsigned int partLength(long num);
+  static unsigned int partLength(unsigned long num);
+  static unsigned int partLength(long long num);
+  static unsigned int partLength(unsigned long long num);
+  static unsigned int partLength(float num);
+  static unsigned int partLength(double num);
+
+  static unsigned int lengthOf() {
+    return 0;
+  }
+  template<typename Part, typename... Parts> static unsigned int lengthOf(const Part &part, const Parts &...parts) {
+    return partLength(part) + lengthOf(parts...);
+  }
+  bool concatEach() {
+    return true;
+  }
+  template<typename Part, typename... Parts> bool concatEach(const Part &part, const Parts &...parts) {
+    return concat(part) && concatEach(parts...);
+  }
 #endif
 };
 
 class StringSumHelper : public String {
 public:
   StringSumHelper(const String &s) : String(s) {}
+#ifdef __GXX_EXPERIMENTAL_CXX0X__
+  // a temporary String starts the sum with its own buffer, e.g. String(id) + ":"
+  StringSumHelper(String &&s) : String(static_cast<String &&>(s)) {}
+#endif
   StringSumHelper(const char *p) : String(p) {}
   StringSumHelper(char c) : String(c) {}
   StringSumHelper(unsigned char num) : String(num) {}
@@ -420,6 +491,20 @@ inline StringSumHelper &operator+(const StringSumHelper &lhs, const __FlashStrin
   return lhs + reinterpret_cast<const char *>(rhs);
 }
 
+#ifdef __GXX_EXPERIMENTAL_CXX0X__
+// A String made of all its parts with a single allocation, in place of an
+// operator+ chain that grows the result once per part:
+// String url = StringBuilder("http://", host, ':', port, "/items?id=", id);
+class StringBuilder : public String {
+public:
+  template<typename... Parts> explicit StringBuilder(const Parts &...parts) {
+    if (!concatAll(parts...)) {
+      invalidate();
+    }
+  }
+};
+#endif
+
 extern const String emptyString;
 
 #endif  // __cplusplus
@@ -18,54 +18,38 @@
  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
  */
 
+#include <stdlib.h>
 #include "cbuf.h"
 #include "esp32-hal-log.h"
 
-#if CONFIG_DISABLE_HAL_LOCKS
-#define CBUF_MUTEX_CREATE()
-#define CBUF_MUTEX_LOCK()
-#define CBUF_MUTEX_UNLOCK()
-#define CBUF_MUTEX_DELETE()
-#else
-#define CBUF_MUTEX_CREATE()            \
-  if (_lock == NULL) {                 \
-    _lock = xSemaphoreCreateMutex();   \
-    if (_lock == NULL) {               \
-      log_e("failed to create mutex"); \
-    }                                  \
+static size_t cbuf_storage_size(size_t size) {
+  size_t storage = 1;
+  while (storage < size) {
+    storage <<= 1;
   }
-#define CBUF_MUTEX_LOCK()                          \
-  if (_lock != NULL) {                             \
-    xSemaphoreTakeRecursive(_lock, portMAX_DELAY); \
-  }
-#define CBUF_MUTEX_UNLOCK()         \
-  if (_lock != NULL) {              \
-    xSemaphoreGiveRecursive(_lock); \
-  }
-#define CBUF_MUTEX_DELETE()      \
-  if (_lock != NULL) {           \
-    SemaphoreHandle_t l = _lock; \
-    _lock = NULL;                \
-    vSemaphoreDelete(l);         \
-  }
-#endif
+  return storage;
+}
 
-cbuf::cbuf(size_t size) : next(NULL), has_peek(false), peek_byte(0), _buf(xRingbufferCreate(size, RINGBUF_TYPE_BYTEBUF)) {
+cbuf::cbuf(size_t size) : next(NULL), _head(0), _tail(0) {
+  if (!size) {
+    return;
+  }
+  size_t storage = cbuf_storage_size(size);
+  _buf = (char *)malloc(storage);
   if (_buf == NULL) {
     log_e("failed to allocate ring buffer");
+    return;
   }
-  CBUF_MUTEX_CREATE();
+  _size = size;
+  _mask = storage - 1;
 }
 
 cbuf::~cbuf() {
-  CBUF_MUTEX_LOCK();
   if (_buf != NULL) {
-    RingbufHandle_t b = _buf;
+    char *b = _buf;
     _buf = NULL;
-    vRingbufferDelete(b);
+    free(b);
   }
-  CBUF_MUTEX_UNLOCK();
-  CBUF_MUTEX_DELETE();
 }
 
 size_t cbuf::resizeAdd(size_t addSize) {
@@ -73,8 +57,6 @@ size_t cbuf::resizeAdd(size_t addSize) {
 }
 
 size_t cbuf::resize(size_t newSize) {
-  CBUF_MUTEX_LOCK();
-  size_t _size = size();
   if (newSize == _size) {
     return _size;
   }
@@ -83,81 +65,62 @@ size_t cbuf::resize(size_t newSize) {
   // if data can be lost use remove or flush before resize
   size_t bytes_available = available();
   if (newSize < bytes_available) {
-    CBUF_MUTEX_UNLOCK();
     log_e("new size is less than the currently available data size");
     return _size;
   }
 
-  RingbufHandle_t newbuf = xRingbufferCreate(newSize, RINGBUF_TYPE_BYTEBUF);
+  if (!newSize) {
+    free(_buf);
+    _buf = NULL;
+    _size = 0;
+    _mask = 0;
+    _head.store(0, std::memory_order_relaxed);
+    _tail.store(0, std::memory_order_relaxed);
+    return 0;
+  }
+
+  size_t storage = cbuf_storage_size(newSize);
+  if (_buf != NULL && storage == _mask + 1) {
+    // the existing storage already fits, only the usable size changes
+    _size = newSize;
+    return newSize;
+  }
+
+  char *newbuf = (char *)malloc(storage);
   if (newbuf == NULL) {
-    CBUF_MUTEX_UNLOCK();
     log_e("failed to allocate new ring buffer");
     return _size;
   }
 
-  if (_buf != NULL) {
-    if (bytes_available) {
-      char *old_data = (char *)malloc(bytes_available);
-      if (old_data == NULL) {
-        vRingbufferDelete(newbuf);
-        CBUF_MUTEX_UNLOCK();
-        log_e("failed to allocate temporary buffer");
-        return _size;
-      }
-      bytes_available = read(old_data, bytes_available);
-      if (!bytes_available) {
-        free(old_data);
-        vRingbufferDelete(newbuf);
-        CBUF_MUTEX_UNLOCK();
-        log_e("failed to read previous data");
-        return _size;
-      }
-      if (xRingbufferSend(newbuf, (void *)old_data, bytes_available, 0) != pdTRUE) {
-        write(old_data, bytes_available);
-        free(old_data);
-        vRingbufferDelete(newbuf);
-        CBUF_MUTEX_UNLOCK();
-        log_e("failed to restore previous data");
-        return _size;
-      }
-      free(old_data);
-    }
-
-    RingbufHandle_t b = _buf;
-    _buf = newbuf;
-    vRingbufferDelete(b);
-  } else {
-    _buf = newbuf;
+  // move the pending data to the start of the new storage, in at most two copies
+  size_t copied = 0;
+  const char *data = NULL;
+  size_t span = 0;
+  while (copied < bytes_available && (span = peekSpan(&data)) > 0) {
+    memcpy(newbuf + copied, data, span);
+    commitRead(span);
+    copied += span;
   }
-  CBUF_MUTEX_UNLOCK();
+
+  free(_buf);
+  _buf = newbuf;
+  _size = newSize;
+  _mask = storage - 1;
+  _tail.store(0, std::memory_order_relaxed);
+  _head.store(copied, std::memory_order_release);
   return newSize;
 }
 
 size_t cbuf::available() const {
-  size_t available = 0;
-  if (_buf != NULL) {
-    vRingbufferGetInfo(_buf, NULL, NULL, NULL, NULL, (UBaseType_t *)&available);
-  }
-  if (has_peek) {
-    available++;
-  }
-  return available;
+  return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire);
 }
 
 size_t cbuf::size() {
-  size_t _size = 0;
-  if (_buf != NULL) {
-    _size = xRingbufferGetMaxItemSize(_buf);
-  }
   return _size;
 }
 
 size_t cbuf::room() const {
-  size_t _room = 0;
-  if (_buf != NULL) {
-    _room = xRingbufferGetCurFreeSize(_buf);
-  }
-  return _room;
+  return _size - available();
 }
 
 bool cbuf::empty() const {
@@ -168,122 +131,114 @@ bool cbuf::full() const {
   return room() == 0;
 }
 
-int cbuf::peek() {
-  if (!available()) {
-    return -1;
+size_t cbuf::peekSpan(const char **data) const {
+  size_t tail = _tail.load(std::memory_order_relaxed);
+  size_t used = _head.load(std::memory_order_acquire) - tail;
+  if (!used) {
+    return 0;
+  }
+  size_t offset = tail & _mask;
+  size_t span = _mask + 1 - offset;
+  if (data != NULL) {
+    *data = _buf + offset;
   }
+  return (used < span) ? used : span;
+}
 
-  int c;
+void cbuf::commitRead(size_t size) {
+  _tail.store(_tail.load(std::memory_order_relaxed) + size, std::memory_order_release);
+}
 
-  CBUF_MUTEX_LOCK();
-  if (has_peek) {
-    c = peek_byte;
-  } else {
-    c = read();
-    if (c >= 0) {
-      has_peek = true;
-      peek_byte = c;
-    }
+size_t cbuf::reserveWrite(char **data) {
+  size_t head = _head.load(std::memory_order_relaxed);
+  size_t free_size = _size - (head - _tail.load(std::memory_order_acquire));
+  if (!free_size) {
+    return 0;
+  }
+  size_t offset = head & _mask;
+  size_t span = _mask + 1 - offset;
+  if (data != NULL) {
+    *data = _buf + offset;
   }
-  CBUF_MUTEX_UNLOCK();
-  return c;
+  return (free_size < span) ? free_size : span;
 }
 
-int cbuf::read() {
-  char result = 0;
-  if (!read(&result, 1)) {
-    return -1;
-  }
-  return static_cast<int>(result);
+void cbuf::commitWrite(size_t size) {
+  _head.store(_head.load(std::memory_order_relaxed) + size, std::memory_order_release);
 }
 
-size_t cbuf::read(char *dst, size_t size) {
-  CBUF_MUTEX_LOCK();
-  size_t bytes_available = available();
-  if (!bytes_available || !size) {
-    CBUF_MUTEX_UNLOCK();
-    return 0;
+int cbuf::peek() {
+  const char *data = NULL;
+  if (!peekSpan(&data)) {
+    return -1;
   }
+  return static_cast<uint8_t>(*data);
+}
 
-  if (has_peek) {
-    if (dst != NULL) {
-      *dst++ = peek_byte;
-    }
-    size--;
+int cbuf::read() {
+  const char *data = NULL;
+  if (!peekSpan(&data)) {
+    return -1;
   }
+  int result = static_cast<uint8_t>(*data);
+  commitRead(1);
+  return result;
+}
 
+size_t cbuf::read(char *dst, size_t size) {
   size_t size_read = 0;
-  if (size) {
-    size_t received_size = 0;
-    size_t size_to_read = (size < bytes_available) ? size : bytes_available;
-    uint8_t *received_buff = (uint8_t *)xRingbufferReceiveUpTo(_buf, &received_size, 0, size_to_read);
-    if (received_buff != NULL) {
-      if (dst != NULL) {
-        memcpy(dst, received_buff, received_size);
-      }
-      vRingbufferReturnItem(_buf, received_buff);
-      size_read = received_size;
-      size_to_read -= received_size;
-      // wrap around data
-      if (size_to_read) {
-        received_size = 0;
-        received_buff = (uint8_t *)xRingbufferReceiveUpTo(_buf, &received_size, 0, size_to_read);
-        if (received_buff != NULL) {
-          if (dst != NULL) {
-            memcpy(dst + size_read, received_buff, received_size);
-          }
-          vRingbufferReturnItem(_buf, received_buff);
-          size_read += received_size;
-        } else {
-          log_e("failed to read wrap around data from ring buffer");
-        }
-      }
-    } else {
-      log_e("failed to read from ring buffer");
+  const char *data = NULL;
+  size_t span = 0;
+  // the data wraps around at most once
+  while (size_read < size && (span = peekSpan(&data)) > 0) {
+    if (span > size - size_read) {
+      span = size - size_read;
     }
+    if (dst != NULL) {
+      memcpy(dst + size_read, data, span);
+    }
+    commitRead(span);
+    size_read += span;
   }
-
-  if (has_peek) {
-    has_peek = false;
-    size_read++;
-  }
-
-  CBUF_MUTEX_UNLOCK();
   return size_read;
 }
 
 size_t cbuf::write(char c) {
-  return write(&c, 1);
+  char *data = NULL;
+  if (!reserveWrite(&data)) {
+    return 0;
+  }
+  *data = c;
+  commitWrite(1);
+  return 1;
 }
 
 size_t cbuf::write(const char *src, size_t size) {
-  CBUF_MUTEX_LOCK();
-  size_t bytes_available = room();
-  if (!bytes_available || !size) {
-    CBUF_MUTEX_UNLOCK();
-    return 0;
-  }
-  size_t size_to_write = (size < bytes_available) ? size : bytes_available;
-  if (xRingbufferSend(_buf, (void *)src, size_to_write, 0) != pdTRUE) {
-    CBUF_MUTEX_UNLOCK();
-    log_e("failed to write to ring buffer");
-    return 0;
+  size_t size_written = 0;
+  char *data = NULL;
+  size_t span = 0;
+  // the free space wraps around at most once
+  while (size_written < size && (span = reserveWrite(&data)) > 0) {
+    if (span > size - size_written) {
+      span = size - size_written;
+    }
+    memcpy(data, src + size_written, span);
+    commitWrite(span);
+    size_written += span;
   }
-  CBUF_MUTEX_UNLOCK();
-  return size_to_write;
+  return size_written;
 }
 
 void cbuf::flush() {
-  read(NULL, available());
+  remove(available());
 }
 
 size_t cbuf::remove(size_t size) {
-  CBUF_MUTEX_LOCK();
   size_t bytes_available = available();
   if (bytes_available && size) {
     size_t size_to_remove = (size < bytes_available) ? size : bytes_available;
-    bytes_available -= read(NULL, size_to_remove);
+    commitRead(size_to_remove);
+    bytes_available -= size_to_remove;
   }
-  CBUF_MUTEX_UNLOCK();
   return bytes_available;
 }
@@ -23,11 +23,19 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <string.h>
-#include "sdkconfig.h"
-#include "freertos/FreeRTOS.h"
-#include "freertos/ringbuf.h"
-#include "freertos/semphr.h"
+#include <atomic>
 
+/*
+ * Single-producer / single-consumer byte ring.
+ *
+ * One task (or ISR) may write while another task reads without any locking:
+ * the producer only advances the head and the consumer only advances the tail.
+ * The backing storage is rounded up to a power of two so that wrapping is a
+ * mask, while size()/room() keep honouring the size that was requested.
+ *
+ * resize(), resizeAdd() and the destructor must not run concurrently with
+ * readers or writers.
+ */
 class cbuf {
 public:
   cbuf(size_t size);
@@ -53,13 +61,23 @@ public:
   void flush();
   size_t remove(size_t size);
 
+  // Zero-copy access. peekSpan() returns the number of contiguous bytes that
+  // can be read from *data; commitRead() consumes them once processed.
+  size_t peekSpan(const char **data) const;
+  void commitRead(size_t size);
+
+  // reserveWrite() returns the number of contiguous bytes that can be written
+  // at *data; commitWrite() publishes them to the consumer.
+  size_t reserveWrite(char **data);
+  void commitWrite(size_t size);
+
   cbuf *next;
-  bool has_peek;
-  uint8_t peek_byte;
 
 protected:
-  RingbufHandle_t _buf = NULL;
-#if !CONFIG_DISABLE_HAL_LOCKS
-  SemaphoreHandle_t _lock = NULL;
-#endif
+  char *_buf = NULL;
+  size_t _size = 0;  // usable size, as requested by the user
+  size_t _mask = 0;  // storage size - 1, storage size is a power of two
+  // Free running counters, wrapped with _mask when indexing _buf
+  std::atomic<size_t> _head;  // written by the producer
+  std::atomic<size_t> _tail;  // written by the consumer
 };
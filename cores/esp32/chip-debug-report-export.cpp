@@ -0,0 +1,331 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * JSON and CBOR output of chip_report_t. Both encoders are driven by the same
+ * walk over the report, so the two formats always carry the same keys.
+ */
+
+#include "chip-debug-report.h"
+#include "esp32-hal-format.h"
+#include "Print.h"
+
+#include <string.h>
+
+namespace {
+
+// Collects the output so that Print sees a few large writes
+class ReportWriter {
+public:
+  ReportWriter(Print &out) : _out(out), _len(0), _written(0) {}
+
+  void put(const void *data, size_t size) {
+    const uint8_t *p = (const uint8_t *)data;
+    while (size) {
+      size_t n = sizeof(_buf) - _len;
+      if (n > size) {
+        n = size;
+      }
+      memcpy(_buf + _len, p, n);
+      _len += n;
+      p += n;
+      size -= n;
+      if (_len == sizeof(_buf)) {
+        flush();
+      }
+    }
+  }
+
+  void put(uint8_t c) {
+    _buf[_len++] = c;
+    if (_len == sizeof(_buf)) {
+      flush();
+    }
+  }
+
+  size_t flush() {
+    if (_len) {
+      _written += _out.write(_buf, _len);
+      _len = 0;
+    }
+    return _written;
+  }
+
+private:
+  Print &_out;
+  uint8_t _buf[128];
+  size_t _len;
+  size_t _written;
+};
+
+class JSONEncoder : public ReportWriter {
+public:
+  JSONEncoder(Print &out) : ReportWriter(out), _depth(0), _first(1) {}
+
+  void beginMap(size_t) {
+    open('{');
+  }
+  void beginArray(size_t) {
+    open('[');
+  }
+  void endMap() {
+    close('}');
+  }
+  void endArray() {
+    close(']');
+  }
+
+  void key(const char *name) {
+    separate();
+    put((uint8_t)'"');
+    put(name, strlen(name));
+    put("\":", 2);
+    // the value that follows is not a new element
+    _first |= 1u << _depth;
+  }
+
+  void number(uint64_t value) {
+    char buf[FORMAT_INT_SIZE];
+    separate();
+    put(buf, format_u64(value, buf));
+  }
+
+  void number(int64_t value) {
+    char buf[FORMAT_INT_SIZE];
+    separate();
+    put(buf, format_i64(value, buf));
+  }
+
+  void string(const char *s) {
+    separate();
+    if (s == nullptr) {
+      put("null", 4);
+      return;
+    }
+    put((uint8_t)'"');
+    const char *run = s;
+    for (; *s; s++) {
+      uint8_t c = (uint8_t)*s;
+      if (c != '"' && c != '\\' && c >= 0x20) {
+        continue;
+      }
+      put(run, s - run);
+      if (c == '"' || c == '\\') {
+        put((uint8_t)'\\');
+        put(c);
+      } else {
+        char esc[6] = {'\\', 'u', '0', '0', "0123456789abcdef"[c >> 4], "0123456789abcdef"[c & 0x0F]};
+        put(esc, sizeof(esc));
+      }
+      run = s + 1;
+    }
+    put(run, s - run);
+    put((uint8_t)'"');
+  }
+
+private:
+  // bit n of _first is set until the first element at depth n is written
+  uint32_t _depth;
+  uint32_t _first;
+
+  void separate() {
+    if (_first & (1u << _depth)) {
+      _first &= ~(1u << _depth);
+    } else {
+      put((uint8_t)',');
+    }
+  }
+
+  void open(char c) {
+    separate();
+    put((uint8_t)c);
+    _depth++;
+    _first |= 1u << _depth;
+  }
+
+  void close(char c) {
+    _depth--;
+    put((uint8_t)c);
+  }
+};
+
+// RFC 8949, definite lengths only
+class CBOREncoder : public ReportWriter {
+public:
+  CBOREncoder(Print &out) : ReportWriter(out) {}
+
+  void beginMap(size_t count) {
+    head(5, count);
+  }
+  void beginArray(size_t count) {
+    head(4, count);
+  }
+  void endMap() {}
+  void endArray() {}
+
+  void key(const char *name) {
+    string(name);
+  }
+
+  void number(uint64_t value) {
+    head(0, value);
+  }
+
+  void number(int64_t value) {
+    if (value < 0) {
+      head(1, (uint64_t)(-(value + 1)));
+    } else {
+      head(0, (uint64_t)value);
+    }
+  }
+
+  void string(const char *s) {
+    if (s == nullptr) {
+      put((uint8_t)0xF6);
+      return;
+    }
+    size_t len = strlen(s);
+    head(3, len);
+    put(s, len);
+  }
+
+private:
+  void head(uint8_t major, uint64_t value) {
+    uint8_t buf[9];
+    size_t n;
+    major <<= 5;
+    if (value < 24) {
+      buf[0] = major | (uint8_t)value;
+      n = 1;
+    } else if (value <= 0xFF) {
+      buf[0] = major | 24;
+      n = 2;
+    } else if (value <= 0xFFFF) {
+      buf[0] = major | 25;
+      n = 3;
+    } else if (value <= 0xFFFFFFFF) {
+      buf[0] = major | 26;
+      n = 5;
+    } else {
+      buf[0] = major | 27;
+      n = 9;
+    }
+    // big endian argument
+    for (size_t i = n - 1; i > 0; i--) {
+      buf[i] = (uint8_t)value;
+      value >>= 8;
+    }
+    put(buf, n);
+  }
+};
+
+template<typename Encoder> void field(Encoder &e, const char *name, uint64_t value) {
+  e.key(name);
+  e.number(value);
+}
+
+template<typename Encoder> void field(Encoder &e, const char *name, int64_t value) {
+  e.key(name);
+  e.number(value);
+}
+
+template<typename Encoder> void field(Encoder &e, const char *name, const char *value) {
+  e.key(name);
+  e.string(value);
+}
+
+template<typename Encoder> void encodeReport(Encoder &e, const chip_report_t *report) {
+  size_t sections = 2;
+  for (uint32_t part = CHIP_REPORT_CHIP; part <= CHIP_REPORT_PINS; part <<= 1) {
+    sections += (report->parts & part) ? 1 : 0;
+  }
+  e.beginMap(sections);
+  field(e, "version", (uint64_t)CHIP_REPORT_VERSION);
+  field(e, "uptime", report->uptimeUs);
+
+  if (report->parts & CHIP_REPORT_CHIP) {
+    const chip_report_chip_t &chip = report->chip;
+    e.key("chip");
+    e.beginMap(9);
+    field(e, "model", (uint64_t)chip.model);
+    field(e, "revision", (uint64_t)chip.revision);
+    field(e, "cores", (uint64_t)chip.cores);
+    field(e, "features", (uint64_t)chip.features);
+    field(e, "cpuFreqMHz", (uint64_t)chip.cpuFreqMHz);
+    field(e, "flashSize", (uint64_t)chip.flashSize);
+    field(e, "idf", chip.idfVersion);
+    field(e, "arduino", chip.arduinoVersion);
+    field(e, "elfSha256", chip.elfSha256);
+    e.endMap();
+  }
+
+  if (report->parts & CHIP_REPORT_HEAP) {
+    e.key("heap");
+    e.beginArray(report->heapCount);
+    for (uint8_t i = 0; i < report->heapCount; i++) {
+      const chip_report_heap_t &heap = report->heap[i];
+      e.beginMap(9);
+      field(e, "name", heap.name);
+      field(e, "caps", (uint64_t)heap.caps);
+      field(e, "total", (uint64_t)heap.total);
+      field(e, "free", (uint64_t)heap.free);
+      field(e, "allocated", (uint64_t)heap.allocated);
+      field(e, "minimumFree", (uint64_t)heap.minimumFree);
+      field(e, "largestFree", (uint64_t)heap.largestFree);
+      field(e, "freeBlocks", (uint64_t)heap.freeBlocks);
+      field(e, "fragmentation", (uint64_t)heap.fragmentation);
+      e.endMap();
+    }
+    e.endArray();
+  }
+
+  if (report->parts & CHIP_REPORT_PARTITIONS) {
+    e.key("partitions");
+    e.beginArray(report->partitionCount);
+    for (uint8_t i = 0; i < report->partitionCount; i++) {
+      const chip_report_partition_t &partition = report->partitions[i];
+      e.beginMap(5);
+      field(e, "label", partition.label);
+      field(e, "type", (uint64_t)partition.type);
+      field(e, "subtype", (uint64_t)partition.subtype);
+      field(e, "address", (uint64_t)partition.address);
+      field(e, "size", (uint64_t)partition.size);
+      e.endMap();
+    }
+    e.endArray();
+  }
+
+  if (report->parts & CHIP_REPORT_PINS) {
+    e.key("pins");
+    e.beginArray(report->pinCount);
+    for (uint8_t i = 0; i < report->pinCount; i++) {
+      const chip_report_pin_t &pin = report->pins[i];
+      e.beginMap(5);
+      field(e, "gpio", (uint64_t)pin.gpio);
+      field(e, "type", (uint64_t)pin.type);
+      field(e, "name", pin.name);
+      field(e, "bus", (int64_t)pin.bus);
+      field(e, "channel", (int64_t)pin.channel);
+      e.endMap();
+    }
+    e.endArray();
+  }
+  e.endMap();
+}
+
+}  // namespace
+
+size_t chipReportPrintJSON(const chip_report_t *report, Print &out) {
+  JSONEncoder e(out);
+  encodeReport(e, report);
+  return e.flush();
+}
+
+size_t chipReportWriteCBOR(const chip_report_t *report, Print &out) {
+  CBOREncoder e(out);
+  encodeReport(e, report);
+  return e.flush();
+}
@@ -6,6 +6,8 @@
 #include "esp_flash.h"
 #include "esp_partition.h"
 #include "esp_app_format.h"
+#include "esp_app_desc.h"
+#include "esp_timer.h"
 #include "soc/efuse_reg.h"
 #include "soc/rtc.h"
 #include "soc/spi_reg.h"
@@ -24,17 +26,31 @@
 #define printMemCapsInfo(caps) _printMemCapsInfo(MALLOC_CAP_##caps, #caps)
 #define b2kb(b)                ((float)b / 1024.0)
 #define b2mb(b)                ((float)b / (1024.0 * 1024.0))
-static void _printMemCapsInfo(uint32_t caps, const char *caps_str) {
+static void collectHeap(chip_report_heap_t *heap, uint32_t caps, const char *name) {
   multi_heap_info_t info;
-  size_t total = heap_caps_get_total_size(caps);
   heap_caps_get_info(&info, caps);
+  heap->name = name;
+  heap->caps = caps;
+  heap->total = heap_caps_get_total_size(caps);
+  heap->free = info.total_free_bytes;
+  heap->allocated = info.total_allocated_bytes;
+  heap->minimumFree = info.minimum_free_bytes;
+  heap->largestFree = info.largest_free_block;
+  heap->freeBlocks = info.free_blocks;
+  heap->fragmentation = info.total_free_bytes ? (uint16_t)(1000 - (uint64_t)info.largest_free_block * 1000 / info.total_free_bytes) : 0;
+}
+
+static void _printMemCapsInfo(uint32_t caps, const char *caps_str) {
+  chip_report_heap_t heap;
+  collectHeap(&heap, caps, caps_str);
   chip_report_printf("%s Memory Info:\n", caps_str);
   chip_report_printf("------------------------------------------\n");
-  chip_report_printf("  Total Size        : %8lu B (%6.1f KB)\n", (unsigned long)total, b2kb(total));
-  chip_report_printf("  Free Bytes        : %8lu B (%6.1f KB)\n", (unsigned long)info.total_free_bytes, b2kb(info.total_free_bytes));
-  chip_report_printf("  Allocated Bytes   : %8lu B (%6.1f KB)\n", (unsigned long)info.total_allocated_bytes, b2kb(info.total_allocated_bytes));
-  chip_report_printf("  Minimum Free Bytes: %8lu B (%6.1f KB)\n", (unsigned long)info.minimum_free_bytes, b2kb(info.minimum_free_bytes));
-  chip_report_printf("  Largest Free Block: %8lu B (%6.1f KB)\n", (unsigned long)info.largest_free_block, b2kb(info.largest_free_block));
+  chip_report_printf("  Total Size        : %8lu B (%6.1f KB)\n", (unsigned long)heap.total, b2kb(heap.total));
+  chip_report_printf("  Free Bytes        : %8lu B (%6.1f KB)\n", (unsigned long)heap.free, b2kb(heap.free));
+  chip_report_printf("  Allocated Bytes   : %8lu B (%6.1f KB)\n", (unsigned long)heap.allocated, b2kb(heap.allocated));
+  chip_report_printf("  Minimum Free Bytes: %8lu B (%6.1f KB)\n", (unsigned long)heap.minimumFree, b2kb(heap.minimumFree));
+  chip_report_printf("  Largest Free Block: %8lu B (%6.1f KB)\n", (unsigned long)heap.largestFree, b2kb(heap.largestFree));
+  chip_report_printf("  Fragmentation     : %6.1f %%\n", (float)heap.fragmentation / 10.0);
 }
 
 static void printPkgVersion(void) {
@@ -253,14 +269,10 @@ static void printPerimanInfo(void) {
   chip_report_printf("  GPIO : BUS_TYPE[bus/unit][chan]\n");
 #endif
   chip_report_printf("  --------------------------------------  \n");
-  for (uint8_t i = 0; i < SOC_GPIO_PIN_COUNT; i++) {
-    if (!perimanPinIsValid(i)) {
-      continue;  //invalid pin
-    }
-    peripheral_bus_type_t type = perimanGetPinBusType(i);
-    if (type == ESP32_BUS_TYPE_INIT) {
-      continue;  //unused pin
-    }
+  periman_pin_info_t info[SOC_GPIO_PIN_COUNT];
+  size_t count = perimanGetPinsInfo(info, SOC_GPIO_PIN_COUNT);
+  for (size_t n = 0; n < count; n++) {
+    uint8_t i = info[n].pin;
 #if defined(BOARD_HAS_PIN_REMAP)
     int dpin = gpioNumberToDigitalPin(i);
     if (dpin < 0) {
@@ -271,19 +283,16 @@ static void printPerimanInfo(void) {
 #else
     chip_report_printf("  %4u : ", i);
 #endif
-    const char *extra_type = perimanGetPinBusExtraType(i);
-    if (extra_type) {
-      chip_report_printf("%s", extra_type);
+    if (info[n].extra_type) {
+      chip_report_printf("%s", info[n].extra_type);
     } else {
-      chip_report_printf("%s", perimanGetTypeName(type));
+      chip_report_printf("%s", perimanGetTypeName((peripheral_bus_type_t)info[n].type));
     }
-    int8_t bus_number = perimanGetPinBusNum(i);
-    if (bus_number != -1) {
-      chip_report_printf("[%d]", bus_number);
+    if (info[n].bus_num != -1) {
+      chip_report_printf("[%d]", info[n].bus_num);
     }
-    int8_t bus_channel = perimanGetPinBusChannel(i);
-    if (bus_channel != -1) {
-      chip_report_printf("[%d]", bus_channel);
+    if (info[n].bus_channel != -1) {
+      chip_report_printf("[%d]", info[n].bus_channel);
     }
     chip_report_printf("\n");
   }
@@ -336,3 +345,78 @@ void printAfterSetupInfo(void) {
   chip_report_printf("============ After Setup End =============\n");
   delay(20);  //allow the print to finish
 }
+
+static void collectChip(chip_report_chip_t *chip) {
+  esp_chip_info_t info;
+  esp_chip_info(&info);
+  rtc_cpu_freq_config_t conf;
+  rtc_clk_cpu_freq_get_config(&conf);
+  chip->model = info.model;
+  chip->revision = info.revision;
+  chip->cores = info.cores;
+  chip->features = info.features;
+  chip->cpuFreqMHz = conf.freq_mhz;
+  chip->flashSize = 1 << (g_rom_flashchip.device_id & 0xFF);
+  chip->idfVersion = esp_get_idf_version();
+  chip->arduinoVersion = ESP_ARDUINO_VERSION_STR;
+  esp_app_get_elf_sha256(chip->elfSha256, sizeof(chip->elfSha256));
+}
+
+static uint8_t collectPartitions(chip_report_partition_t *partitions) {
+  uint8_t count = 0;
+  esp_partition_iterator_t it = esp_partition_find(ESP_PARTITION_TYPE_ANY, ESP_PARTITION_SUBTYPE_ANY, NULL);
+  while (it != NULL) {
+    if (count == CHIP_REPORT_MAX_PARTITIONS) {
+      log_w("Partition table has more than %u entries, the rest is not reported", CHIP_REPORT_MAX_PARTITIONS);
+      esp_partition_iterator_release(it);
+      break;
+    }
+    const esp_partition_t *partition = esp_partition_get(it);
+    if (partition) {
+      chip_report_partition_t *p = &partitions[count++];
+      strlcpy(p->label, partition->label, sizeof(p->label));
+      p->type = partition->type;
+      p->subtype = partition->subtype;
+      p->address = partition->address;
+      p->size = partition->size;
+    }
+    // releases the iterator after the last partition
+    it = esp_partition_next(it);
+  }
+  return count;
+}
+
+static uint8_t collectPins(chip_report_pin_t *pins) {
+  periman_pin_info_t info[CHIP_REPORT_MAX_PINS];
+  uint8_t count = perimanGetPinsInfo(info, CHIP_REPORT_MAX_PINS);
+  for (uint8_t i = 0; i < count; i++) {
+    chip_report_pin_t *pin = &pins[i];
+    pin->gpio = info[i].pin;
+    pin->type = info[i].type;
+    pin->bus = info[i].bus_num;
+    pin->channel = info[i].bus_channel;
+    pin->name = info[i].extra_type ? info[i].extra_type : perimanGetTypeName((peripheral_bus_type_t)info[i].type);
+  }
+  return count;
+}
+
+void chipReportCollect(chip_report_t *report, uint32_t parts) {
+  if (parts & CHIP_REPORT_CHIP) {
+    collectChip(&report->chip);
+  }
+  if (parts & CHIP_REPORT_HEAP) {
+    report->heapCount = 0;
+    collectHeap(&report->heap[report->heapCount++], MALLOC_CAP_INTERNAL, "INTERNAL");
+    if (psramFound()) {
+      collectHeap(&report->heap[report->heapCount++], MALLOC_CAP_SPIRAM, "SPIRAM");
+    }
+  }
+  if (parts & CHIP_REPORT_PARTITIONS) {
+    report->partitionCount = collectPartitions(report->partitions);
+  }
+  if (parts & CHIP_REPORT_PINS) {
+    report->pinCount = collectPins(report->pins);
+  }
+  report->parts |= parts & CHIP_REPORT_ALL;
+  report->uptimeUs = esp_timer_get_time();
+}
@@ -5,5 +5,106 @@
  */
 #pragma once
 
+#include <stdint.h>
+#include <stddef.h>
+#include "soc/soc_caps.h"
+
 void printBeforeSetupInfo(void);
 void printAfterSetupInfo(void);
+
+/*
+ * Machine readable report.
+ *
+ * chipReportCollect() fills a chip_report_t with the data the reports above
+ * print: chip and build identification, the INTERNAL and SPIRAM heaps, the
+ * partition table and the pins attached through the peripheral manager. The
+ * struct is self contained (strings are copied or point to constants) and is
+ * written out as JSON or CBOR, with the same keys in both.
+ *
+ * Only the parts asked for are collected and the others are left as they
+ * were, so the chip and partitions can be read once and the heap and pins
+ * refreshed periodically. Collection allocates nothing except for the
+ * partition iterator; the cost is dominated by heap_caps_get_info(), which
+ * walks the blocks of each heap with the heap locked.
+ */
+
+#define CHIP_REPORT_VERSION 1
+
+#define CHIP_REPORT_CHIP       (1 << 0)
+#define CHIP_REPORT_HEAP       (1 << 1)
+#define CHIP_REPORT_PARTITIONS (1 << 2)
+#define CHIP_REPORT_PINS       (1 << 3)
+#define CHIP_REPORT_ALL        (CHIP_REPORT_CHIP | CHIP_REPORT_HEAP | CHIP_REPORT_PARTITIONS | CHIP_REPORT_PINS)
+
+#define CHIP_REPORT_MAX_HEAPS      2
+#define CHIP_REPORT_MAX_PARTITIONS 16
+#define CHIP_REPORT_LABEL_SIZE     17
+#define CHIP_REPORT_SHA_SIZE       17
+#ifdef SOC_GPIO_PIN_COUNT
+#define CHIP_REPORT_MAX_PINS SOC_GPIO_PIN_COUNT
+#else
+#define CHIP_REPORT_MAX_PINS 64
+#endif
+
+typedef struct {
+  uint16_t model;                        // esp_chip_model_t
+  uint16_t revision;                     // major * 100 + minor
+  uint8_t cores;                         // number of CPU cores
+  uint32_t features;                     // CHIP_FEATURE_* bits
+  uint32_t cpuFreqMHz;                   // current CPU frequency
+  uint32_t flashSize;                    // flash chip size in bytes
+  const char *idfVersion;                // ESP-IDF version string
+  const char *arduinoVersion;            // Arduino core version string
+  char elfSha256[CHIP_REPORT_SHA_SIZE];  // first 16 hex digits of the application ELF SHA-256
+} chip_report_chip_t;
+
+typedef struct {
+  const char *name;        // "INTERNAL" or "SPIRAM"
+  uint32_t caps;           // MALLOC_CAP_* the heap was selected with
+  uint32_t total;          // total size in bytes
+  uint32_t free;           // free bytes
+  uint32_t allocated;      // allocated bytes
+  uint32_t minimumFree;    // lowest free bytes since boot
+  uint32_t largestFree;    // largest free block
+  uint32_t freeBlocks;     // number of free blocks
+  uint16_t fragmentation;  // 1 - largestFree / free, in per mille
+} chip_report_heap_t;
+
+typedef struct {
+  char label[CHIP_REPORT_LABEL_SIZE];
+  uint8_t type;     // esp_partition_type_t
+  uint8_t subtype;  // esp_partition_subtype_t
+  uint32_t address;
+  uint32_t size;
+} chip_report_partition_t;
+
+typedef struct {
+  uint8_t gpio;
+  uint8_t type;      // peripheral_bus_type_t
+  int8_t bus;        // bus number or unit, -1 if not set
+  int8_t channel;    // bus channel, -1 if not set
+  const char *name;  // extra type if set, else the name of the bus type
+} chip_report_pin_t;
+
+typedef struct {
+  uint32_t parts;     // CHIP_REPORT_* of the parts collected so far
+  uint64_t uptimeUs;  // esp_timer_get_time() at the last collection
+  chip_report_chip_t chip;
+  uint8_t heapCount;
+  chip_report_heap_t heap[CHIP_REPORT_MAX_HEAPS];
+  uint8_t partitionCount;  // at most CHIP_REPORT_MAX_PARTITIONS, the rest is dropped
+  chip_report_partition_t partitions[CHIP_REPORT_MAX_PARTITIONS];
+  uint8_t pinCount;  // attached pins only
+  chip_report_pin_t pins[CHIP_REPORT_MAX_PINS];
+} chip_report_t;
+
+// Fills the CHIP_REPORT_* parts given. Zero the report before the first call.
+void chipReportCollect(chip_report_t *report, uint32_t parts);
+
+#ifdef __cplusplus
+class Print;
+
+// Write the collected parts of the report, return the number of bytes written
+size_t chipReportPrintJSON(const chip_report_t *report, Print &out);
+size_t chipReportWriteCBOR(const chip_report_t *report, Print &out);
+#endif
@@ -0,0 +1,938 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "esp32-hal-format.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+
+#define FORMAT_FLAG_LEFT  (1 << 0)  // '-'
+#define FORMAT_FLAG_PLUS  (1 << 1)  // '+'
+#define FORMAT_FLAG_SPACE (1 << 2)  // ' '
+#define FORMAT_FLAG_ALT   (1 << 3)  // '#'
+#define FORMAT_FLAG_ZERO  (1 << 4)  // '0'
+
+#define FORMAT_FLOAT_BUF_SIZE 64
+
+typedef enum {
+  FORMAT_LEN_NONE,
+  FORMAT_LEN_HH,
+  FORMAT_LEN_H,
+  FORMAT_LEN_L,
+  FORMAT_LEN_LL,
+  FORMAT_LEN_J,
+  FORMAT_LEN_Z,
+  FORMAT_LEN_T,
+  FORMAT_LEN_LD,
+} format_len_t;
+
+typedef struct {
+  char *buf;
+  size_t size;
+  size_t len;
+  size_t total;
+  format_sink_t sink;
+  void *ctx;
+} format_out_t;
+
+static void format_flush(format_out_t *out) {
+  out->buf[out->len] = '\0';
+  if (out->sink != NULL && out->len) {
+    out->sink(out->ctx, out->buf, out->len);
+    out->len = 0;
+  }
+}
+
+static void format_write(format_out_t *out, const char *data, size_t len) {
+  out->total += len;
+  while (len) {
+    size_t room = out->size - 1 - out->len;
+    if (!room) {
+      if (out->sink == NULL) {
+        // vsnprintf() mode, the rest is only counted
+        return;
+      }
+      format_flush(out);
+      room = out->size - 1;
+    }
+    size_t n = (len < room) ? len : room;
+    memcpy(out->buf + out->len, data, n);
+    out->len += n;
+    data += n;
+    len -= n;
+  }
+}
+
+static void format_pad(format_out_t *out, char c, int count) {
+  char pad[16];
+  if (count <= 0) {
+    return;
+  }
+  memset(pad, c, (count < (int)sizeof(pad)) ? count : (int)sizeof(pad));
+  while (count > 0) {
+    int n = (count < (int)sizeof(pad)) ? count : (int)sizeof(pad);
+    format_write(out, pad, n);
+    count -= n;
+  }
+}
+
+// Writes `body` (digits, string...) preceded by `prefix` (sign, 0x) and padded to `width`
+static void format_field(format_out_t *out, int flags, int width, const char *prefix, size_t prefix_len, int zeros, const char *body, size_t body_len) {
+  int pad = width - (int)(prefix_len + zeros + body_len);
+  if (!(flags & FORMAT_FLAG_LEFT)) {
+    if (flags & FORMAT_FLAG_ZERO) {
+      zeros += (pad > 0) ? pad : 0;
+    } else {
+      format_pad(out, ' ', pad);
+    }
+    pad = 0;
+  }
+  format_write(out, prefix, prefix_len);
+  format_pad(out, '0', zeros);
+  format_write(out, body, body_len);
+  format_pad(out, ' ', pad);
+}
+
+// "00" to "99", so that decimal conversions emit two digits per division
+static const char format_digit_pairs[201] = "0001020304050607080910111213141516171819"
+                                            "2021222324252627282930313233343536373839"
+                                            "4041424344454647484950515253545556575859"
+                                            "6061626364656667686970717273747576777879"
+                                            "8081828384858687888990919293949596979899";
+
+static const uint64_t format_pow10[20] = {
+  0ULL,  // so that zero has one digit
+  10ULL,
+  100ULL,
+  1000ULL,
+  10000ULL,
+  100000ULL,
+  1000000ULL,
+  10000000ULL,
+  100000000ULL,
+  1000000000ULL,
+  10000000000ULL,
+  100000000000ULL,
+  1000000000000ULL,
+  10000000000000ULL,
+  100000000000000ULL,
+  1000000000000000ULL,
+  10000000000000000ULL,
+  100000000000000000ULL,
+  1000000000000000000ULL,
+  10000000000000000000ULL,
+};
+
+static inline void format_pair(char *out, unsigned value) {
+  out[0] = format_digit_pairs[2 * value];
+  out[1] = format_digit_pairs[2 * value + 1];
+}
+
+// Writes the digits of `value` so that the last one lands just before `end`, returns the first one
+static char *format_u32_backward(uint32_t value, char *end) {
+  while (value >= 100) {
+    unsigned pair = value % 100;
+    value /= 100;
+    end -= 2;
+    format_pair(end, pair);
+  }
+  if (value >= 10) {
+    end -= 2;
+    format_pair(end, value);
+  } else {
+    *--end = (char)('0' + value);
+  }
+  return end;
+}
+
+// Exactly nine digits, with leading zeros
+static char *format_u32_nine_backward(uint32_t value, char *end) {
+  for (int i = 0; i < 4; i++) {
+    unsigned pair = value % 100;
+    value /= 100;
+    end -= 2;
+    format_pair(end, pair);
+  }
+  *--end = (char)('0' + value);
+  return end;
+}
+
+static char *format_u64_backward(uint64_t value, char *end) {
+  // 64 bit divisions are library calls on the 32 bit cores, so split off nine digits at a time
+  while (value > UINT32_MAX) {
+    uint64_t high = value / 1000000000;
+    end = format_u32_nine_backward((uint32_t)(value - high * 1000000000), end);
+    value = high;
+  }
+  return format_u32_backward((uint32_t)value, end);
+}
+
+static void format_integer(format_out_t *out, unsigned long long value, bool negative, char conv, int flags, int width, int precision) {
+  static const char lower[] = "0123456789abcdef";
+  static const char upper[] = "0123456789ABCDEF";
+  const char *digits = (conv == 'X') ? upper : lower;
+  unsigned base = (conv == 'o') ? 8 : ((conv == 'x' || conv == 'X' || conv == 'p') ? 16 : 10);
+
+  // digits are produced backwards, zero yields no digits and is covered by the precision
+  char tmp[24];  // 22 octal digits for 64 bits
+  char *end = tmp + sizeof(tmp);
+  char *p = end;
+  if (base == 10) {
+    if (value) {
+      p = format_u64_backward(value, end);
+    }
+  } else {
+    unsigned shift = (base == 8) ? 3 : 4;
+    while (value) {
+      *--p = digits[value & (base - 1)];
+      value >>= shift;
+    }
+  }
+  size_t len = end - p;
+
+  char prefix[2];
+  size_t prefix_len = 0;
+  if (negative) {
+    prefix[prefix_len++] = '-';
+  } else if (flags & FORMAT_FLAG_PLUS) {
+    prefix[prefix_len++] = '+';
+  } else if (flags & FORMAT_FLAG_SPACE) {
+    prefix[prefix_len++] = ' ';
+  }
+
+  int zeros = 0;
+  if (precision < 0) {
+    precision = 1;
+  } else {
+    // an explicit precision disables zero padding
+    flags &= ~FORMAT_FLAG_ZERO;
+  }
+  if ((int)len < precision) {
+    zeros = precision - (int)len;
+  }
+  if (flags & FORMAT_FLAG_ALT) {
+    if (base == 8 && zeros == 0 && (len == 0 || *p != '0')) {
+      zeros = 1;
+    } else if (base == 16 && (len != 0 || conv == 'p')) {
+      prefix[prefix_len++] = '0';
+      prefix[prefix_len++] = (conv == 'X') ? 'X' : 'x';
+    }
+  }
+  format_field(out, flags, width, prefix, prefix_len, zeros, p, len);
+}
+
+static void format_float(format_out_t *out, const char *spec, size_t spec_len, int width, int precision, format_len_t length, va_list *arg) {
+  char fmt[24];
+  char tmp[FORMAT_FLOAT_BUF_SIZE];
+  char *buf = tmp;
+  int len;
+
+  // rebuild the conversion with width and precision resolved, snprintf() does the rest
+  if (spec_len > sizeof(fmt) - 1) {
+    spec_len = sizeof(fmt) - 1;
+  }
+  memcpy(fmt, spec, spec_len);
+  fmt[spec_len] = '\0';
+  if (length == FORMAT_LEN_LD) {
+    long double value = va_arg(*arg, long double);
+    len = snprintf(tmp, sizeof(tmp), fmt, width, precision, value);
+    if (len >= (int)sizeof(tmp) && (buf = (char *)malloc(len + 1)) != NULL) {
+      snprintf(buf, len + 1, fmt, width, precision, value);
+    }
+  } else {
+    double value = va_arg(*arg, double);
+    len = snprintf(tmp, sizeof(tmp), fmt, width, precision, value);
+    if (len >= (int)sizeof(tmp) && (buf = (char *)malloc(len + 1)) != NULL) {
+      snprintf(buf, len + 1, fmt, width, precision, value);
+    }
+  }
+  if (len < 0) {
+    return;
+  }
+  if (buf == NULL) {
+    // out of memory, emit what fits
+    format_write(out, tmp, sizeof(tmp) - 1);
+    return;
+  }
+  format_write(out, buf, len);
+  if (buf != tmp) {
+    free(buf);
+  }
+}
+
+int format_vprintf(char *buf, size_t size, format_sink_t sink, void *ctx, const char *format, va_list arg) {
+  format_out_t out = {buf, size, 0, 0, sink, ctx};
+  va_list args;
+
+  if (buf == NULL || size < 2 || format == NULL) {
+    if (buf != NULL && size) {
+      buf[0] = '\0';
+    }
+    return 0;
+  }
+  va_copy(args, arg);
+
+  const char *p = format;
+  while (*p) {
+    // copy the literal run up to the next conversion in one go
+    const char *lit = p;
+    while (*p && *p != '%') {
+      p++;
+    }
+    if (p != lit) {
+      format_write(&out, lit, p - lit);
+    }
+    if (!*p) {
+      break;
+    }
+
+    const char *spec = p++;
+    int flags = 0;
+    for (;; p++) {
+      if (*p == '-') {
+        flags |= FORMAT_FLAG_LEFT;
+      } else if (*p == '+') {
+        flags |= FORMAT_FLAG_PLUS;
+      } else if (*p == ' ') {
+        flags |= FORMAT_FLAG_SPACE;
+      } else if (*p == '#') {
+        flags |= FORMAT_FLAG_ALT;
+      } else if (*p == '0') {
+        flags |= FORMAT_FLAG_ZERO;
+      } else {
+        break;
+      }
+    }
+
+    int width = 0;
+    if (*p == '*') {
+      width = va_arg(args, int);
+      if (width < 0) {
+        flags |= FORMAT_FLAG_LEFT;
+        width = -width;
+      }
+      p++;
+    } else {
+      while (*p >= '0' && *p <= '9') {
+        width = width * 10 + (*p++ - '0');
+      }
+    }
+
+    int precision = -1;
+    if (*p == '.') {
+      p++;
+      precision = 0;
+      if (*p == '*') {
+        precision = va_arg(args, int);
+        p++;
+      } else {
+        while (*p >= '0' && *p <= '9') {
+          precision = precision * 10 + (*p++ - '0');
+        }
+      }
+    }
+
+    format_len_t length = FORMAT_LEN_NONE;
+    switch (*p) {
+      case 'h':
+        p++;
+        length = FORMAT_LEN_H;
+        if (*p == 'h') {
+          p++;
+          length = FORMAT_LEN_HH;
+        }
+        break;
+      case 'l':
+        p++;
+        length = FORMAT_LEN_L;
+        if (*p == 'l') {
+          p++;
+          length = FORMAT_LEN_LL;
+        }
+        break;
+      case 'j': p++; length = FORMAT_LEN_J; break;
+      case 'z': p++; length = FORMAT_LEN_Z; break;
+      case 't': p++; length = FORMAT_LEN_T; break;
+      case 'L': p++; length = FORMAT_LEN_LD; break;
+      default:  break;
+    }
+    if (flags & FORMAT_FLAG_LEFT) {
+      flags &= ~FORMAT_FLAG_ZERO;
+    }
+
+    char conv = *p;
+    if (!conv) {
+      // dangling '%' at the end of the format
+      format_write(&out, spec, p - spec);
+      break;
+    }
+    p++;
+
+    switch (conv) {
+      case 'd':
+      case 'i':
+      {
+        long long value;
+        switch (length) {
+          case FORMAT_LEN_HH: value = (signed char)va_arg(args, int); break;
+          case FORMAT_LEN_H:  value = (short)va_arg(args, int); break;
+          case FORMAT_LEN_L:  value = va_arg(args, long); break;
+          case FORMAT_LEN_LL: value = va_arg(args, long long); break;
+          case FORMAT_LEN_J:  value = va_arg(args, intmax_t); break;
+          case FORMAT_LEN_Z:  value = va_arg(args, ssize_t); break;
+          case FORMAT_LEN_T:  value = va_arg(args, ptrdiff_t); break;
+          default:            value = va_arg(args, int); break;
+        }
+        unsigned long long magnitude = (value < 0) ? 0ULL - (unsigned long long)value : (unsigned long long)value;
+        format_integer(&out, magnitude, value < 0, 'd', flags & ~FORMAT_FLAG_ALT, width, precision);
+        break;
+      }
+      case 'u':
+      case 'o':
+      case 'x':
+      case 'X':
+      {
+        unsigned long long value;
+        switch (length) {
+          case FORMAT_LEN_HH: value = (unsigned char)va_arg(args, unsigned int); break;
+          case FORMAT_LEN_H:  value = (unsigned short)va_arg(args, unsigned int); break;
+          case FORMAT_LEN_L:  value = va_arg(args, unsigned long); break;
+          case FORMAT_LEN_LL: value = va_arg(args, unsigned long long); break;
+          case FORMAT_LEN_J:  value = va_arg(args, uintmax_t); break;
+          case FORMAT_LEN_Z:  value = va_arg(args, size_t); break;
+          case FORMAT_LEN_T:  value = (size_t)va_arg(args, ptrdiff_t); break;
+          default:            value = va_arg(args, unsigned int); break;
+        }
+        format_integer(&out, value, false, conv, (conv == 'u') ? (flags & ~FORMAT_FLAG_ALT) : flags, width, precision);
+        break;
+      }
+      case 'p':
+      {
+        uintptr_t value = (uintptr_t)va_arg(args, void *);
+        format_integer(&out, value, false, 'p', flags | FORMAT_FLAG_ALT, width, precision);
+        break;
+      }
+      case 'c':
+      {
+        char c = (char)va_arg(args, int);
+        format_field(&out, flags & ~FORMAT_FLAG_ZERO, width, NULL, 0, 0, &c, 1);
+        break;
+      }
+      case 's':
+      {
+        const char *s = va_arg(args, const char *);
+        if (s == NULL) {
+          s = "(null)";
+        }
+        size_t len = 0;
+        if (precision >= 0) {
+          // the string does not need to be terminated within the precision
+          while (len < (size_t)precision && s[len]) {
+            len++;
+          }
+        } else {
+          len = strlen(s);
+        }
+        format_field(&out, flags & ~FORMAT_FLAG_ZERO, width, NULL, 0, 0, s, len);
+        break;
+      }
+      case 'f':
+      case 'F':
+      case 'e':
+      case 'E':
+      case 'g':
+      case 'G':
+      case 'a':
+      case 'A':
+      {
+        // "%<flags>*.*<L><conv>"
+        char fspec[16];
+        size_t n = 0;
+        fspec[n++] = '%';
+        if (flags & FORMAT_FLAG_LEFT) {
+          fspec[n++] = '-';
+        }
+        if (flags & FORMAT_FLAG_PLUS) {
+          fspec[n++] = '+';
+        }
+        if (flags & FORMAT_FLAG_SPACE) {
+          fspec[n++] = ' ';
+        }
+        if (flags & FORMAT_FLAG_ALT) {
+          fspec[n++] = '#';
+        }
+        if (flags & FORMAT_FLAG_ZERO) {
+          fspec[n++] = '0';
+        }
+        fspec[n++] = '*';
+        fspec[n++] = '.';
+        fspec[n++] = '*';
+        if (length == FORMAT_LEN_LD) {
+          fspec[n++] = 'L';
+        }
+        fspec[n++] = conv;
+        format_float(&out, fspec, n, width, (precision < 0) ? ((conv == 'a' || conv == 'A') ? -1 : 6) : precision, length, &args);
+        break;
+      }
+      case 'n':
+        // writing through format arguments is not supported, consume the pointer
+        (void)va_arg(args, void *);
+        break;
+      case '%': format_write(&out, "%", 1); break;
+      default:
+        // unknown conversion, emit it verbatim
+        format_write(&out, spec, p - spec);
+        break;
+    }
+  }
+  va_end(args);
+
+  format_flush(&out);
+  return (int)out.total;
+}
+
+int format_printf(char *buf, size_t size, format_sink_t sink, void *ctx, const char *format, ...) {
+  va_list arg;
+  va_start(arg, format);
+  int len = format_vprintf(buf, size, sink, ctx, format, arg);
+  va_end(arg);
+  return len;
+}
+
+unsigned format_u64_len(uint64_t value) {
+  // bit length * log10(2) is at most one below the digit count
+  unsigned guess = ((64 - __builtin_clzll(value | 1)) * 1233) >> 12;
+  return guess + (value >= format_pow10[guess]);
+}
+
+size_t format_u32(uint32_t value, char *buf) {
+  unsigned len = format_u64_len(value);
+  format_u32_backward(value, buf + len);
+  buf[len] = '\0';
+  return len;
+}
+
+size_t format_u64(uint64_t value, char *buf) {
+  unsigned len = format_u64_len(value);
+  format_u64_backward(value, buf + len);
+  buf[len] = '\0';
+  return len;
+}
+
+size_t format_i64(int64_t value, char *buf) {
+  if (value < 0) {
+    *buf = '-';
+    return 1 + format_u64(0ULL - (uint64_t)value, buf + 1);
+  }
+  return format_u64(value, buf);
+}
+
+size_t format_radix(uint64_t value, unsigned base, bool upper, char *buf) {
+  const char letter = upper ? 'A' : 'a';
+  if (base < 2 || base > 36) {
+    base = 10;
+  }
+  if (base == 10) {
+    return format_u64(value, buf);
+  }
+  size_t len;
+  if ((base & (base - 1)) == 0) {
+    // power of two, the length follows from the bit length
+    unsigned shift = __builtin_ctz(base);
+    unsigned bits = 64 - __builtin_clzll(value | 1);
+    len = (bits + shift - 1) / shift;
+    for (char *p = buf + len; p != buf; value >>= shift) {
+      unsigned digit = value & (base - 1);
+      *--p = (char)((digit < 10) ? '0' + digit : letter + digit - 10);
+    }
+  } else {
+    char tmp[FORMAT_RADIX_SIZE];
+    char *p = tmp + sizeof(tmp);
+    do {
+      unsigned digit = value % base;
+      value /= base;
+      *--p = (char)((digit < 10) ? '0' + digit : letter + digit - 10);
+    } while (value);
+    len = tmp + sizeof(tmp) - p;
+    memcpy(buf, p, len);
+  }
+  buf[len] = '\0';
+  return len;
+}
+
+// Full 128 bit product of two 64 bit values, from 32 bit multiplications
+static void format_mul64(uint64_t a, uint64_t b, uint64_t *hi, uint64_t *lo) {
+  uint64_t a0 = (uint32_t)a, a1 = a >> 32;
+  uint64_t b0 = (uint32_t)b, b1 = b >> 32;
+  uint64_t p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+  uint64_t mid = (p00 >> 32) + (uint32_t)p01 + (uint32_t)p10;
+  *lo = (mid << 32) | (uint32_t)p00;
+  *hi = p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32);
+}
+
+// Digits of the 128 bit value hi:lo, the last one just before `end`
+static char *format_u128_backward(uint64_t hi, uint64_t lo, char *end) {
+  while (hi) {
+    // long division by 10^9 over 32 bit limbs
+    uint32_t limbs[4] = {(uint32_t)(hi >> 32), (uint32_t)hi, (uint32_t)(lo >> 32), (uint32_t)lo};
+    uint64_t rem = 0;
+    for (int i = 0; i < 4; i++) {
+      uint64_t cur = (rem << 32) | limbs[i];
+      limbs[i] = (uint32_t)(cur / 1000000000);
+      rem = cur % 1000000000;
+    }
+    hi = ((uint64_t)limbs[0] << 32) | limbs[1];
+    lo = ((uint64_t)limbs[2] << 32) | limbs[3];
+    end = format_u32_nine_backward((uint32_t)rem, end);
+  }
+  return format_u64_backward(lo, end);
+}
+
+#define FORMAT_FIXED_EXACT_DECIMALS 27  // 5^27 still fits into 64 bits, and m * 5^4 as well
+
+static const uint64_t format_pow5[FORMAT_FIXED_EXACT_DECIMALS + 1] = {
+  1ULL,
+  5ULL,
+  25ULL,
+  125ULL,
+  625ULL,
+  3125ULL,
+  15625ULL,
+  78125ULL,
+  390625ULL,
+  1953125ULL,
+  9765625ULL,
+  48828125ULL,
+  244140625ULL,
+  1220703125ULL,
+  6103515625ULL,
+  30517578125ULL,
+  152587890625ULL,
+  762939453125ULL,
+  3814697265625ULL,
+  19073486328125ULL,
+  95367431640625ULL,
+  476837158203125ULL,
+  2384185791015625ULL,
+  11920928955078125ULL,
+  59604644775390625ULL,
+  298023223876953125ULL,
+  1490116119384765625ULL,
+  7450580596923828125ULL,
+};
+
+static size_t format_copy(char *buf, size_t size, const char *text, size_t len) {
+  if (len < size) {
+    memcpy(buf, text, len + 1);
+  } else if (size) {
+    buf[0] = '\0';
+  }
+  return len;
+}
+
+size_t format_fixed(double value, unsigned decimals, char *buf, size_t size) {
+  uint64_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  int biased = (int)(bits >> 52) & 0x7FF;
+  uint64_t m = bits & ((1ULL << 52) - 1);
+  if (biased == 0x7FF) {
+    return format_copy(buf, size, m ? "nan" : "inf", 3);
+  }
+  if (decimals > FORMAT_FIXED_EXACT_DECIMALS) {
+    // no sign for negative zero
+    int len = snprintf(buf, size, "%.*f", (int)decimals, (value == 0) ? 0.0 : value);
+    return (len < 0) ? 0 : len;
+  }
+  int e = -1074;
+  if (biased) {
+    m |= 1ULL << 52;
+    e = biased - 1075;
+  }
+
+  // value * 10^decimals == m * 5^decimals * 2^(e + decimals), exactly, in 128 bits
+  uint64_t hi = 0, lo = m * format_pow5[decimals];
+  if (decimals > 4) {
+    format_mul64(m, format_pow5[decimals], &hi, &lo);
+  }
+  int shift = e + (int)decimals;
+  if (shift > 0) {
+    unsigned bits_used = hi ? 128 - __builtin_clzll(hi) : (lo ? 64 - __builtin_clzll(lo) : 0);
+    if (bits_used + shift > 128) {
+      // too many digits for 128 bits, but then there is no halfway case to round either
+      int len = snprintf(buf, size, "%.*f", (int)decimals, value);
+      return (len < 0) ? 0 : len;
+    }
+    if (shift >= 64) {
+      hi = lo << (shift - 64);
+      lo = 0;
+    } else {
+      hi = (hi << shift) | (lo >> (64 - shift));
+      lo <<= shift;
+    }
+  } else if (shift < 0) {
+    unsigned r = -shift;
+    if (r >= 128) {
+      // the product is below 2^116, it rounds to zero
+      hi = lo = 0;
+    } else {
+      // add one half and truncate: rounds halfway cases up
+      if (r > 64) {
+        hi += 1ULL << (r - 65);
+      } else {
+        uint64_t half = lo + (1ULL << (r - 1));
+        hi += half < lo;
+        lo = half;
+      }
+      if (r >= 64) {
+        lo = hi >> (r - 64);
+        hi = 0;
+      } else {
+        lo = (lo >> r) | (hi << (64 - r));
+        hi >>= r;
+      }
+    }
+  }
+
+  char digits[40];  // 2^128 has 39 digits
+  char *end = digits + sizeof(digits);
+  char *p = format_u128_backward(hi, lo, end);
+  size_t count = end - p;
+  bool negative = value < 0;
+  size_t int_digits = (count > decimals) ? count - decimals : 1;
+  size_t len = negative + int_digits + (decimals ? 1 + decimals : 0);
+  if (len >= size) {
+    if (size) {
+      buf[0] = '\0';
+    }
+    return len;
+  }
+
+  char *out = buf;
+  if (negative) {
+    *out++ = '-';
+  }
+  if (count > decimals) {
+    memcpy(out, p, int_digits);
+    out += int_digits;
+    p += int_digits;
+    count = decimals;
+  } else {
+    *out++ = '0';
+  }
+  if (decimals) {
+    *out++ = '.';
+    memset(out, '0', decimals - count);
+    out += decimals - count;
+    memcpy(out, p, count);
+    out += count;
+  }
+  *out = '\0';
+  return len;
+}
+
+// Grisu2, after "Printing Floating-Point Numbers Quickly and Accurately with Integers" (Loitsch, 2010)
+
+typedef struct {
+  uint64_t f;
+  int e;
+} format_fp_t;
+
+// Normalized 64 bit approximations of 10^-348, 10^-340, ..., 10^340
+static const uint64_t format_cached_f[] = {
+  0xfa8fd5a0081c0288ULL, 0xbaaee17fa23ebf76ULL, 0x8b16fb203055ac76ULL, 0xcf42894a5dce35eaULL, 0x9a6bb0aa55653b2dULL, 0xe61acf033d1a45dfULL,
+  0xab70fe17c79ac6caULL, 0xff77b1fcbebcdc4fULL, 0xbe5691ef416bd60cULL, 0x8dd01fad907ffc3cULL, 0xd3515c2831559a83ULL, 0x9d71ac8fada6c9b5ULL,
+  0xea9c227723ee8bcbULL, 0xaecc49914078536dULL, 0x823c12795db6ce57ULL, 0xc21094364dfb5637ULL, 0x9096ea6f3848984fULL, 0xd77485cb25823ac7ULL,
+  0xa086cfcd97bf97f4ULL, 0xef340a98172aace5ULL, 0xb23867fb2a35b28eULL, 0x84c8d4dfd2c63f3bULL, 0xc5dd44271ad3cdbaULL, 0x936b9fcebb25c996ULL,
+  0xdbac6c247d62a584ULL, 0xa3ab66580d5fdaf6ULL, 0xf3e2f893dec3f126ULL, 0xb5b5ada8aaff80b8ULL, 0x87625f056c7c4a8bULL, 0xc9bcff6034c13053ULL,
+  0x964e858c91ba2655ULL, 0xdff9772470297ebdULL, 0xa6dfbd9fb8e5b88fULL, 0xf8a95fcf88747d94ULL, 0xb94470938fa89bcfULL, 0x8a08f0f8bf0f156bULL,
+  0xcdb02555653131b6ULL, 0x993fe2c6d07b7facULL, 0xe45c10c42a2b3b06ULL, 0xaa242499697392d3ULL, 0xfd87b5f28300ca0eULL, 0xbce5086492111aebULL,
+  0x8cbccc096f5088ccULL, 0xd1b71758e219652cULL, 0x9c40000000000000ULL, 0xe8d4a51000000000ULL, 0xad78ebc5ac620000ULL, 0x813f3978f8940984ULL,
+  0xc097ce7bc90715b3ULL, 0x8f7e32ce7bea5c70ULL, 0xd5d238a4abe98068ULL, 0x9f4f2726179a2245ULL, 0xed63a231d4c4fb27ULL, 0xb0de65388cc8ada8ULL,
+  0x83c7088e1aab65dbULL, 0xc45d1df942711d9aULL, 0x924d692ca61be758ULL, 0xda01ee641a708deaULL, 0xa26da3999aef774aULL, 0xf209787bb47d6b85ULL,
+  0xb454e4a179dd1877ULL, 0x865b86925b9bc5c2ULL, 0xc83553c5c8965d3dULL, 0x952ab45cfa97a0b3ULL, 0xde469fbd99a05fe3ULL, 0xa59bc234db398c25ULL,
+  0xf6c69a72a3989f5cULL, 0xb7dcbf5354e9beceULL, 0x88fcf317f22241e2ULL, 0xcc20ce9bd35c78a5ULL, 0x98165af37b2153dfULL, 0xe2a0b5dc971f303aULL,
+  0xa8d9d1535ce3b396ULL, 0xfb9b7cd9a4a7443cULL, 0xbb764c4ca7a44410ULL, 0x8bab8eefb6409c1aULL, 0xd01fef10a657842cULL, 0x9b10a4e5e9913129ULL,
+  0xe7109bfba19c0c9dULL, 0xac2820d9623bf429ULL, 0x80444b5e7aa7cf85ULL, 0xbf21e44003acdd2dULL, 0x8e679c2f5e44ff8fULL, 0xd433179d9c8cb841ULL,
+  0x9e19db92b4e31ba9ULL, 0xeb96bf6ebadf77d9ULL, 0xaf87023b9bf0ee6bULL,
+};
+
+static const int16_t format_cached_e[] = {
+  -1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980, -954, -927, -901, -874, -847, -821, -794, -768, -741, -715, -688, -661, -635, -608,
+  -582,  -555,  -529,  -502,  -475,  -449,  -422,  -396,  -369,  -343, -316, -289, -263, -236, -210, -183, -157, -130, -103, -77,  -50,  -24,  3,    30,
+  56,    83,    109,   136,   162,   189,   216,   242,   269,   295,   322,  348,  375,  402,  428,  455,  481,  508,  534,  561,  588,  614,  641,  667,
+  694,   720,   747,   774,   800,   827,   853,   880,   907,   933,   960,  986,  1013, 1039, 1066,
+};
+
+static format_fp_t format_fp_mul(format_fp_t a, format_fp_t b) {
+  uint64_t hi, lo;
+  format_mul64(a.f, b.f, &hi, &lo);
+  format_fp_t r = {hi + (lo >> 63), a.e + b.e + 64};
+  return r;
+}
+
+static format_fp_t format_fp_normalize(format_fp_t v) {
+  int shift = __builtin_clzll(v.f);
+  v.f <<= shift;
+  v.e -= shift;
+  return v;
+}
+
+// Cached power c ~ 10^-k such that the exponent of w * c lands in [-60, -32]
+static format_fp_t format_cached_power(int e, int *k) {
+  double dk = (-61 - e) * 0.30102999566398114 + 347;
+  int ik = (int)dk;
+  if (dk - ik > 0.0) {
+    ik++;
+  }
+  unsigned index = (ik >> 3) + 1;
+  *k = -(-348 + (int)index * 8);
+  format_fp_t c = {format_cached_f[index], format_cached_e[index]};
+  return c;
+}
+
+static void format_grisu_round(char *digits, int len, uint64_t delta, uint64_t rest, uint64_t ten_kappa, uint64_t wp_w) {
+  // move the last digit towards w while that stays inside the rounding interval
+  while (rest < wp_w && delta - rest >= ten_kappa && (rest + ten_kappa < wp_w || wp_w - rest > rest + ten_kappa - wp_w)) {
+    digits[len - 1]--;
+    rest += ten_kappa;
+  }
+}
+
+static int format_grisu_digits(format_fp_t w, format_fp_t mp, uint64_t delta, char *digits, int *k) {
+  format_fp_t one = {1ULL << -mp.e, mp.e};
+  uint64_t wp_w = mp.f - w.f;
+  uint32_t p1 = (uint32_t)(mp.f >> -one.e);
+  uint64_t p2 = mp.f & (one.f - 1);
+  int kappa = (int)format_u64_len(p1);
+  int len = 0;
+
+  while (kappa > 0) {
+    uint32_t div = (uint32_t)format_pow10[kappa - 1] | (kappa == 1);
+    uint32_t d = p1 / div;
+    p1 %= div;
+    if (d || len) {
+      digits[len++] = (char)('0' + d);
+    }
+    kappa--;
+    uint64_t rest = ((uint64_t)p1 << -one.e) + p2;
+    if (rest <= delta) {
+      *k += kappa;
+      format_grisu_round(digits, len, delta, rest, (uint64_t)(uint32_t)(format_pow10[kappa] | (kappa == 0)) << -one.e, wp_w);
+      return len;
+    }
+  }
+
+  for (;;) {
+    p2 *= 10;
+    delta *= 10;
+    char d = (char)(p2 >> -one.e);
+    if (d || len) {
+      digits[len++] = (char)('0' + d);
+    }
+    p2 &= one.f - 1;
+    kappa--;
+    if (p2 < delta) {
+      *k += kappa;
+      int index = -kappa;
+      format_grisu_round(digits, len, delta, p2, one.f, wp_w * ((index < 20) ? (format_pow10[index] | (index == 0)) : 0));
+      return len;
+    }
+  }
+}
+
+// Shortest digits of a finite value > 0, value ~ digits * 10^k
+static int format_grisu2(double value, char *digits, int *k) {
+  uint64_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  int biased = (int)(bits >> 52) & 0x7FF;
+  format_fp_t v = {bits & ((1ULL << 52) - 1), -1074};
+  if (biased) {
+    v.f |= 1ULL << 52;
+    v.e = biased - 1075;
+  }
+
+  // boundaries halfway to the neighbouring doubles, the lower one is closer at powers of two
+  format_fp_t plus = {(v.f << 1) + 1, v.e - 1};
+  plus = format_fp_normalize(plus);
+  format_fp_t minus = {(v.f << 1) - 1, v.e - 1};
+  if (v.f == (1ULL << 52)) {
+    minus.f = (v.f << 2) - 1;
+    minus.e = v.e - 2;
+  }
+  minus.f <<= minus.e - plus.e;
+  minus.e = plus.e;
+
+  format_fp_t c = format_cached_power(plus.e, k);
+  format_fp_t w = format_fp_mul(format_fp_normalize(v), c);
+  format_fp_t wp = format_fp_mul(plus, c);
+  format_fp_t wm = format_fp_mul(minus, c);
+  wm.f++;
+  wp.f--;
+  return format_grisu_digits(w, wp, wp.f - wm.f, digits, k);
+}
+
+size_t format_shortest(double value, char *buf) {
+  char *out = buf;
+  if (signbit(value)) {
+    *out++ = '-';
+    value = -value;
+  }
+  if (isnan(value)) {
+    return format_copy(buf, FORMAT_SHORTEST_SIZE, "nan", 3);
+  }
+  if (isinf(value)) {
+    memcpy(out, "inf", 4);
+    return out + 3 - buf;
+  }
+  if (value == 0) {
+    memcpy(out, "0", 2);
+    return out + 1 - buf;
+  }
+
+  char digits[24];
+  int k;
+  int len = format_grisu2(value, digits, &k);
+  // the value is 0.<digits> * 10^point
+  int point = len + k;
+  if (len <= point && point <= 21) {
+    // 1234e5 -> 123400000
+    memcpy(out, digits, len);
+    memset(out + len, '0', point - len);
+    out += point;
+  } else if (0 < point && point <= 21) {
+    // 1234e-2 -> 12.34
+    memcpy(out, digits, point);
+    out[point] = '.';
+    memcpy(out + point + 1, digits + point, len - point);
+    out += len + 1;
+  } else if (-6 < point && point <= 0) {
+    // 1234e-6 -> 0.001234
+    out[0] = '0';
+    out[1] = '.';
+    memset(out + 2, '0', -point);
+    memcpy(out + 2 - point, digits, len);
+    out += 2 - point + len;
+  } else {
+    // 1234e30 -> 1.234e+33
+    *out++ = digits[0];
+    if (len > 1) {
+      *out++ = '.';
+      memcpy(out, digits + 1, len - 1);
+      out += len - 1;
+    }
+    int exp10 = point - 1;
+    *out++ = 'e';
+    *out++ = (exp10 < 0) ? '-' : '+';
+    out += format_u32(abs(exp10), out);
+  }
+  *out = '\0';
+  return out - buf;
+}
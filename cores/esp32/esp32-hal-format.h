@@ -0,0 +1,105 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Receives formatted output. `data` is NUL terminated at `data[len]` and is
+ * only valid for the duration of the call.
+ */
+typedef void (*format_sink_t)(void *ctx, const char *data, size_t len);
+
+/**
+ * Single pass printf formatter.
+ *
+ * The output is produced into `buf` and handed to `sink` every time `size - 1`
+ * characters are ready, so arbitrarily long output needs no heap and no second
+ * formatting pass. With `sink == NULL` it behaves like vsnprintf(): the output
+ * is truncated to fit into `buf`.
+ *
+ * Supports the flags `-+ #0`, `*` width and precision, the length modifiers
+ * `hh h l ll j z t L` and the conversions `d i u o x X c s p % f F e E g G a A`.
+ * Floating point conversions are delegated to snprintf() through a small stack
+ * buffer; only those wider than 64 characters fall back to the heap.
+ *
+ * @param buf    Chunk buffer, at least 2 bytes.
+ * @param size   Size of `buf`.
+ * @param sink   Output callback, or NULL to format into `buf` only.
+ * @param ctx    Passed through to `sink`.
+ * @return       Number of characters produced, excluding the terminating NUL.
+ */
+int format_vprintf(char *buf, size_t size, format_sink_t sink, void *ctx, const char *format, va_list arg);
+int format_printf(char *buf, size_t size, format_sink_t sink, void *ctx, const char *format, ...) __attribute__((format(printf, 5, 6)));
+
+/** Buffer size for any format_u32(), format_u64() or format_i64() output, including the NUL */
+#define FORMAT_INT_SIZE 21
+
+/** Buffer size for any format_radix() output, including the NUL */
+#define FORMAT_RADIX_SIZE 65
+
+/** Buffer size for any format_shortest() output, including the NUL */
+#define FORMAT_SHORTEST_SIZE 26
+
+/**
+ * Number of decimal digits of `value`, so that callers can reserve the exact
+ * room for format_u64() in their destination.
+ */
+unsigned format_u64_len(uint64_t value);
+
+/**
+ * Decimal text of `value`, written directly at `buf` two digits at a time and
+ * NUL terminated. Returns the number of characters written, excluding the NUL.
+ */
+size_t format_u32(uint32_t value, char *buf);
+size_t format_u64(uint64_t value, char *buf);
+size_t format_i64(int64_t value, char *buf);
+
+/**
+ * Text of `value` in `base` (2 to 36; other bases are treated as 10), with
+ * `upper` or lower case letters for the digits above 9. Returns the number of
+ * characters written, excluding the NUL.
+ */
+size_t format_radix(uint64_t value, unsigned base, bool upper, char *buf);
+
+/**
+ * `value` with `decimals` digits after the point, like "%.*f" but rounding
+ * halfway cases away from zero, as Print and String always did. The sign is
+ * only written for values below zero and NaN and infinities are written as
+ * "nan" and "inf".
+ *
+ * Up to 27 decimals the digits are computed exactly in integer arithmetic,
+ * beyond that they come from snprintf().
+ *
+ * @return Length of the text, excluding the NUL. When it is not less than
+ *         `size` the output did not fit and `buf` holds no usable text.
+ */
+size_t format_fixed(double value, unsigned decimals, char *buf, size_t size);
+
+/**
+ * Shortest text that reads back as `value`, like JavaScript prints numbers:
+ * "0.1", "123", "1.5e+300", "-2e-7". NaN and infinities are written as "nan",
+ * "inf" and "-inf". `buf` must hold FORMAT_SHORTEST_SIZE bytes.
+ *
+ * The digits come from Grisu2, which always round trips and is the shortest
+ * possible for nearly all values; the rare remaining ones (under 1 in 1000)
+ * get up to 17 digits.
+ *
+ * @return Number of characters written, excluding the NUL.
+ */
+size_t format_shortest(double value, char *buf);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,288 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Queued GPIO edge events, see esp32-hal-gpio-events.h.
+ *
+ * The pins are attached through attachInterruptArg() on both edges. All the
+ * pin interrupts are dispatched by the GPIO ISR service on the core that
+ * installed it, one after the other, so the interrupt side is a single
+ * producer of the ring. The edge task is its only consumer.
+ *
+ * The filter and mode of a pin belong to the edge task. Attaching and
+ * detaching publish new settings under a sequence count, and the task takes
+ * them over before it handles the pin again, dropping the edges stored
+ * before the settings were made.
+ */
+
+#include "esp32-hal-gpio-events.h"
+#include "esp32-hal-gpio.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include "hal/gpio_hal.h"
+#include "soc/soc_caps.h"
+
+#ifndef CONFIG_ARDUINO_GPIO_EVENTS_TASK_STACK_SIZE
+#define CONFIG_ARDUINO_GPIO_EVENTS_TASK_STACK_SIZE 2560
+#endif
+
+#ifndef CONFIG_ARDUINO_GPIO_EVENTS_TASK_PRIORITY
+#define CONFIG_ARDUINO_GPIO_EVENTS_TASK_PRIORITY 10
+#endif
+
+#define GPIO_EDGE_MIN_DEPTH 16
+#define GPIO_EDGE_BATCH     32
+
+typedef struct {
+  uint32_t time;  // esp_timer_get_time() when made
+  uint32_t head;  // ring position when made, the edges before it are dropped
+  uint32_t glitch_us;
+  uint32_t debounce_us;
+  uint8_t level;  // pin level at that time
+  uint8_t mode;   // edges handed to the handler, 0 when detached
+} gpio_edge_settings_t;
+
+typedef struct {
+  // written by attach and detach
+  gpio_edge_settings_t settings;
+  uint32_t sequence;  // odd while the settings change
+  // the edge task's own
+  uint32_t applied;  // sequence the settings were taken over at
+  bool stale;        // the ring may still hold edges from before current
+  gpio_edge_settings_t current;
+  gpio_edge_filter_t filter;
+} gpio_edge_pin_t;
+
+typedef struct {
+  gpio_edge_ring_t ring;
+  gpio_edge_pin_t pins[SOC_GPIO_PIN_COUNT];
+  gpio_edge_handler_t handler;
+  void *arg;
+  volatile bool running;
+  TaskHandle_t task;
+  uint32_t delivered;
+} gpio_edge_t;
+
+static gpio_edge_t s_gpio_edge;
+
+static void ARDUINO_ISR_ATTR gpio_edge_isr(void *arg) {
+  gpio_edge_t *ge = &s_gpio_edge;
+  gpio_hal_context_t gpiohal;
+  gpiohal.dev = GPIO_LL_GET_HW(GPIO_PORT_0);
+  gpio_edge_event_t event;
+  event.time = (uint32_t)esp_timer_get_time();
+  event.pin = (uint8_t)((gpio_edge_pin_t *)arg - ge->pins);
+  event.level = gpio_hal_get_level(&gpiohal, event.pin);
+  bool was_empty;
+  // only the first event after the task went idle needs to wake it up
+  if (gpio_edge_ring_push(&ge->ring, &event, &was_empty) && was_empty) {
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(ge->task, &woken);
+    portYIELD_FROM_ISR(woken);
+  }
+}
+
+static bool gpio_edge_wanted(const gpio_edge_pin_t *p, uint8_t level) {
+  uint8_t mode = p->current.mode;
+  return mode == CHANGE || (mode == RISING && level) || (mode == FALLING && !level);
+}
+
+// Edge task side: takes over the settings of the pin if they changed, with
+// the ring read up to position. False while they are being changed, the pin
+// is skipped until then.
+static bool gpio_edge_update(gpio_edge_pin_t *p, uint32_t position) {
+  uint32_t sequence = __atomic_load_n(&p->sequence, __ATOMIC_ACQUIRE);
+  if (sequence != p->applied) {
+    if (sequence & 1) {
+      return false;
+    }
+    gpio_edge_settings_t settings = p->settings;
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (__atomic_load_n(&p->sequence, __ATOMIC_RELAXED) != sequence) {
+      return false;
+    }
+    p->current = settings;
+    p->applied = sequence;
+    p->stale = true;
+    gpio_edge_filter_init(&p->filter, settings.level, settings.time, settings.glitch_us, settings.debounce_us);
+  }
+  // positions are only compared until the task has read past the settings, so
+  // neither the clock nor the position can wrap in between
+  if (p->stale && (int32_t)(position - p->current.head) >= 0) {
+    p->stale = false;
+  }
+  return true;
+}
+
+// Attach and detach side, with the pin interrupt detached
+static void gpio_edge_publish(gpio_edge_pin_t *p, const gpio_edge_settings_t *settings) {
+  __atomic_fetch_add(&p->sequence, 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  p->settings = *settings;
+  __atomic_fetch_add(&p->sequence, 1, __ATOMIC_RELEASE);
+}
+
+static void gpio_edge_task(void *arg) {
+  gpio_edge_t *ge = &s_gpio_edge;
+  gpio_edge_event_t in[GPIO_EDGE_BATCH];
+  gpio_edge_event_t out[GPIO_EDGE_BATCH + SOC_GPIO_PIN_COUNT];
+  TickType_t wait = portMAX_DELAY;
+  while (ge->running) {
+    ulTaskNotifyTake(pdTRUE, wait);
+    size_t count;
+    do {
+      // the task is the only one to move the tail
+      uint32_t position = ge->ring.tail;
+      count = gpio_edge_ring_pop(&ge->ring, in, GPIO_EDGE_BATCH);
+      size_t passed = 0;
+      for (size_t i = 0; i < count; i++) {
+        gpio_edge_pin_t *p = &ge->pins[in[i].pin];
+        // an edge stored before the pin was last attached or detached is dropped
+        if (!gpio_edge_update(p, position + i) || !p->current.mode || p->stale) {
+          continue;
+        }
+        if (gpio_edge_filter_feed(&p->filter, &in[i], &out[passed]) && gpio_edge_wanted(p, out[passed].level)) {
+          passed++;
+        }
+      }
+      // the edges that were held back long enough by now
+      uint32_t now = (uint32_t)esp_timer_get_time();
+      uint32_t next = UINT32_MAX;
+      for (uint8_t pin = 0; pin < SOC_GPIO_PIN_COUNT; pin++) {
+        gpio_edge_pin_t *p = &ge->pins[pin];
+        uint32_t delay;
+        if (!gpio_edge_update(p, position + count) || !p->current.mode) {
+          continue;
+        }
+        if (gpio_edge_filter_poll(&p->filter, pin, now, &out[passed]) && gpio_edge_wanted(p, out[passed].level)) {
+          passed++;
+        }
+        if (gpio_edge_filter_pending(&p->filter, now, &delay) && delay < next) {
+          next = delay;
+        }
+      }
+      if (passed) {
+        ge->handler(out, passed, ge->arg);
+        ge->delivered += passed;
+      }
+      wait = next == UINT32_MAX ? portMAX_DELAY : pdMS_TO_TICKS((next + 999) / 1000) + 1;
+    } while (count == GPIO_EDGE_BATCH);
+  }
+  ge->task = NULL;
+  vTaskDelete(NULL);
+}
+
+bool gpio_edge_begin(size_t depth, gpio_edge_handler_t handler, void *arg) {
+  gpio_edge_t *ge = &s_gpio_edge;
+  if (handler == NULL) {
+    log_e("No handler given");
+    return false;
+  }
+  if (ge->task != NULL) {
+    return true;
+  }
+  uint32_t size = GPIO_EDGE_MIN_DEPTH;
+  while (size < depth) {
+    size <<= 1;
+  }
+  gpio_edge_event_t *buf = (gpio_edge_event_t *)calloc(size, sizeof(gpio_edge_event_t));
+  if (buf == NULL) {
+    log_e("No memory for %u edge events", size);
+    return false;
+  }
+  gpio_edge_ring_init(&ge->ring, buf, size);
+  memset(ge->pins, 0, sizeof(ge->pins));
+  ge->handler = handler;
+  ge->arg = arg;
+  ge->delivered = 0;
+  ge->running = true;
+  if (xTaskCreateUniversal(
+        gpio_edge_task, "gpio_edge", CONFIG_ARDUINO_GPIO_EVENTS_TASK_STACK_SIZE, NULL, CONFIG_ARDUINO_GPIO_EVENTS_TASK_PRIORITY, &ge->task, -1
+      )
+      != pdPASS) {
+    log_e("Edge task could not be created");
+    ge->running = false;
+    ge->task = NULL;
+    free(buf);
+    ge->ring.buf = NULL;
+    return false;
+  }
+  return true;
+}
+
+void gpio_edge_end(void) {
+  gpio_edge_t *ge = &s_gpio_edge;
+  if (ge->task == NULL) {
+    return;
+  }
+  for (uint8_t pin = 0; pin < SOC_GPIO_PIN_COUNT; pin++) {
+    if (ge->pins[pin].settings.mode) {
+      gpio_edge_detach(pin);
+    }
+  }
+  ge->running = false;
+  xTaskNotifyGive(ge->task);
+  while (ge->task != NULL) {
+    vTaskDelay(1);
+  }
+  free(ge->ring.buf);
+  ge->ring.buf = NULL;
+}
+
+bool(gpio_edge_attach)(uint8_t pin, int mode, uint32_t glitch_us, uint32_t debounce_us) {
+  gpio_edge_t *ge = &s_gpio_edge;
+  if (ge->task == NULL) {
+    log_e("gpio_edge_begin() has to be called first");
+    return false;
+  }
+  if (pin >= SOC_GPIO_PIN_COUNT) {
+    log_e("Invalid IO %u selected", pin);
+    return false;
+  }
+  if (mode != RISING && mode != FALLING && mode != CHANGE) {
+    log_e("IO %u: mode has to be RISING, FALLING or CHANGE", pin);
+    return false;
+  }
+  gpio_edge_pin_t *p = &ge->pins[pin];
+  // no edge is stored while the settings change, and the ones stored before
+  // are before the ring head
+  detachInterrupt(pin);
+  gpio_edge_settings_t settings = {
+    .time = (uint32_t)esp_timer_get_time(),
+    .head = __atomic_load_n(&ge->ring.head, __ATOMIC_ACQUIRE),
+    .glitch_us = glitch_us,
+    .debounce_us = debounce_us,
+    .level = (uint8_t)digitalRead(pin),
+    .mode = (uint8_t)mode,
+  };
+  gpio_edge_publish(p, &settings);
+  // the pin entry as argument, a NULL one would not be passed to the ISR
+  attachInterruptArg(pin, gpio_edge_isr, p, CHANGE);
+  return true;
+}
+
+void(gpio_edge_detach)(uint8_t pin) {
+  if (pin >= SOC_GPIO_PIN_COUNT) {
+    return;
+  }
+  detachInterrupt(pin);
+  gpio_edge_settings_t settings = {0};
+  settings.head = __atomic_load_n(&s_gpio_edge.ring.head, __ATOMIC_ACQUIRE);
+  gpio_edge_publish(&s_gpio_edge.pins[pin], &settings);
+}
+
+void gpio_edge_stats(gpio_edge_stats_t *stats) {
+  gpio_edge_t *ge = &s_gpio_edge;
+  stats->received = __atomic_load_n(&ge->ring.received, __ATOMIC_RELAXED);
+  stats->dropped = __atomic_load_n(&ge->ring.dropped, __ATOMIC_RELAXED);
+  stats->delivered = ge->delivered;
+  stats->high_water = ge->ring.high_water;
+}
@@ -0,0 +1,109 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Queued GPIO edge events.
+ *
+ * An alternative to attachInterrupt() for inputs with many or fast edges
+ * (meters, encoders, buttons): the interrupt of a pin attached with
+ * gpio_edge_attach() only stores {pin, level, time} in a lock-free ring, and
+ * a task takes the events out in batches, runs them through the glitch and
+ * debounce filter of their pin and hands the edges that pass to the handler
+ * given to gpio_edge_begin(), in task context. When the ring is full, edges
+ * are dropped and counted.
+ *
+ * Filters, per pin, on the level changes of the pin:
+ *  - glitch_us: a level has to be held that long to count, shorter pulses
+ *    disappear. Edges are reported glitch_us late.
+ *  - debounce_us: after a reported edge, the level changes within
+ *    debounce_us are held back, and only the level the pin settled on is
+ *    reported once that time is over. The first edge is reported at once.
+ * Reported edges carry the time the level changed. Times are the low 32 bits
+ * of esp_timer_get_time(), in microseconds, and wrap after 71 minutes.
+ *
+ * The ring and the filters below are plain code used by the task, they are
+ * built and tested on the host too.
+ */
+
+typedef struct {
+  uint32_t time;  // microseconds, low 32 bits of esp_timer_get_time()
+  uint8_t pin;    // GPIO number
+  uint8_t level;  // level after the edge
+} gpio_edge_event_t;
+
+// Called from the edge task with the edges of a batch, in order for each pin
+typedef void (*gpio_edge_handler_t)(const gpio_edge_event_t *events, size_t count, void *arg);
+
+typedef struct {
+  uint32_t received;    // edges stored by the interrupt
+  uint32_t dropped;     // edges lost because the ring was full
+  uint32_t delivered;   // edges handed to the handler
+  uint32_t high_water;  // most edges waiting in the ring
+} gpio_edge_stats_t;
+
+// Starts the edge task with a ring of depth events (rounded up to a power of two)
+bool gpio_edge_begin(size_t depth, gpio_edge_handler_t handler, void *arg);
+// Detaches all the pins and stops the task
+void gpio_edge_end(void);
+// mode is RISING, FALLING or CHANGE: the filtered edges handed to the handler.
+// The extra set of parentheses here prevents macros defined
+// in io_pin_remap.h from applying to these declarations.
+bool(gpio_edge_attach)(uint8_t pin, int mode, uint32_t glitch_us, uint32_t debounce_us);
+void(gpio_edge_detach)(uint8_t pin);
+void gpio_edge_stats(gpio_edge_stats_t *stats);
+
+// Single producer, single consumer ring of events. The counters are updated
+// with the __atomic builtins, the struct is shared with C++.
+typedef struct {
+  gpio_edge_event_t *buf;
+  uint32_t mask;        // size - 1, size a power of two
+  uint32_t head;        // next slot the producer writes
+  uint32_t tail;        // next slot the consumer reads
+  uint32_t received;
+  uint32_t dropped;
+  uint32_t high_water;  // consumer side
+} gpio_edge_ring_t;
+
+void gpio_edge_ring_init(gpio_edge_ring_t *ring, gpio_edge_event_t *buf, uint32_t size);
+// Producer side. Returns false when the event is dropped; *was_empty tells
+// whether the consumer may be waiting for it.
+bool gpio_edge_ring_push(gpio_edge_ring_t *ring, const gpio_edge_event_t *event, bool *was_empty);
+// Consumer side, takes up to max events out
+size_t gpio_edge_ring_pop(gpio_edge_ring_t *ring, gpio_edge_event_t *out, size_t max);
+
+typedef struct {
+  uint32_t glitch_us;
+  uint32_t debounce_us;
+  uint32_t raw_time;     // when the pin took the raw level
+  uint32_t report_time;  // time of the last reported edge
+  uint8_t raw;           // level of the last event
+  uint8_t level;         // last level reported
+} gpio_edge_filter_t;
+
+// level is the pin level now, at time now
+void gpio_edge_filter_init(gpio_edge_filter_t *filter, uint8_t level, uint32_t now, uint32_t glitch_us, uint32_t debounce_us);
+// Feeds an event of the pin. Returns true with the edge in out when one
+// passed the filter before that event.
+bool gpio_edge_filter_feed(gpio_edge_filter_t *filter, const gpio_edge_event_t *event, gpio_edge_event_t *out);
+// Returns true with the edge in out when one passed the filter by now
+bool gpio_edge_filter_poll(gpio_edge_filter_t *filter, uint8_t pin, uint32_t now, gpio_edge_event_t *out);
+// Returns true when an edge is held back, with the time from now until it
+// passes in delay_us
+bool gpio_edge_filter_pending(const gpio_edge_filter_t *filter, uint32_t now, uint32_t *delay_us);
+
+#ifdef __cplusplus
+}
+#endif
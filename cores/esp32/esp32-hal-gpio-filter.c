@@ -0,0 +1,114 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Edge event ring and per pin edge filters of esp32-hal-gpio-events.c, kept
+ * apart from the interrupt and task code so that the host tests build them.
+ *
+ * Time differences are taken modulo 2^32, so the filters keep working across
+ * the wrap of the 32 bit microsecond clock as long as the pin is polled at
+ * least once every 35 minutes while an edge is held back.
+ */
+
+#include "esp32-hal-gpio-events.h"
+
+#include "sdkconfig.h"
+
+#ifndef ARDUINO_ISR_ATTR
+#if CONFIG_ARDUINO_ISR_IRAM
+#include "esp_attr.h"
+#define ARDUINO_ISR_ATTR IRAM_ATTR
+#else
+#define ARDUINO_ISR_ATTR
+#endif
+#endif
+
+void gpio_edge_ring_init(gpio_edge_ring_t *ring, gpio_edge_event_t *buf, uint32_t size) {
+  ring->buf = buf;
+  ring->mask = size - 1;
+  ring->head = 0;
+  ring->tail = 0;
+  ring->received = 0;
+  ring->dropped = 0;
+  ring->high_water = 0;
+}
+
+bool ARDUINO_ISR_ATTR gpio_edge_ring_push(gpio_edge_ring_t *ring, const gpio_edge_event_t *event, bool *was_empty) {
+  uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+  uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+  if (head - tail > ring->mask) {
+    __atomic_store_n(&ring->dropped, ring->dropped + 1, __ATOMIC_RELAXED);
+    *was_empty = false;
+    return false;
+  }
+  ring->buf[head & ring->mask] = *event;
+  __atomic_store_n(&ring->head, head + 1, __ATOMIC_RELEASE);
+  __atomic_store_n(&ring->received, ring->received + 1, __ATOMIC_RELAXED);
+  *was_empty = head == tail;
+  return true;
+}
+
+size_t gpio_edge_ring_pop(gpio_edge_ring_t *ring, gpio_edge_event_t *out, size_t max) {
+  uint32_t tail = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+  uint32_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+  uint32_t count = head - tail;
+  if (count > ring->high_water) {
+    ring->high_water = count;
+  }
+  if (count > max) {
+    count = max;
+  }
+  for (uint32_t i = 0; i < count; i++) {
+    out[i] = ring->buf[(tail + i) & ring->mask];
+  }
+  __atomic_store_n(&ring->tail, tail + count, __ATOMIC_RELEASE);
+  return count;
+}
+
+void gpio_edge_filter_init(gpio_edge_filter_t *filter, uint8_t level, uint32_t now, uint32_t glitch_us, uint32_t debounce_us) {
+  filter->glitch_us = glitch_us;
+  filter->debounce_us = debounce_us;
+  filter->raw = level;
+  filter->level = level;
+  filter->raw_time = now - glitch_us;
+  // no edge reported yet, the first one is not held back
+  filter->report_time = now - debounce_us;
+}
+
+bool gpio_edge_filter_pending(const gpio_edge_filter_t *filter, uint32_t now, uint32_t *delay_us) {
+  if (filter->raw == filter->level) {
+    return false;
+  }
+  uint32_t held = now - filter->raw_time;
+  uint32_t since = now - filter->report_time;
+  uint32_t glitch = held < filter->glitch_us ? filter->glitch_us - held : 0;
+  uint32_t debounce = since < filter->debounce_us ? filter->debounce_us - since : 0;
+  *delay_us = glitch > debounce ? glitch : debounce;
+  return true;
+}
+
+bool gpio_edge_filter_poll(gpio_edge_filter_t *filter, uint8_t pin, uint32_t now, gpio_edge_event_t *out) {
+  uint32_t delay;
+  if (!gpio_edge_filter_pending(filter, now, &delay) || delay) {
+    return false;
+  }
+  filter->level = filter->raw;
+  filter->report_time = filter->raw_time;
+  out->time = filter->raw_time;
+  out->pin = pin;
+  out->level = filter->level;
+  return true;
+}
+
+bool gpio_edge_filter_feed(gpio_edge_filter_t *filter, const gpio_edge_event_t *event, gpio_edge_event_t *out) {
+  // the level held until this event may have passed in the meantime
+  bool passed = gpio_edge_filter_poll(filter, event->pin, event->time, out);
+  if (event->level != filter->raw) {
+    filter->raw = event->level;
+    filter->raw_time = event->time;
+  }
+  return passed;
+}
@@ -59,18 +59,14 @@ ledc_periph_t ledc_handle = {0};
 static bool find_matching_timer(uint8_t speed_mode, uint32_t freq, uint8_t resolution, uint8_t *timer_num) {
   log_d("Searching for timer with freq=%" PRIu32 ", resolution=%u", freq, resolution);
   // Check all channels to find one with matching frequency and resolution
-  for (uint8_t i = 0; i < SOC_GPIO_PIN_COUNT; i++) {
-    if (!perimanPinIsValid(i)) {
-      continue;
-    }
-    peripheral_bus_type_t type = perimanGetPinBusType(i);
-    if (type == ESP32_BUS_TYPE_LEDC) {
-      ledc_channel_handle_t *bus = (ledc_channel_handle_t *)perimanGetPinBus(i, ESP32_BUS_TYPE_LEDC);
-      if (bus != NULL && (bus->channel / SOC_LEDC_CHANNEL_NUM) == speed_mode && bus->freq_hz == freq && bus->channel_resolution == resolution) {
-        log_d("Found matching timer %u for freq=%" PRIu32 ", resolution=%u", bus->timer_num, freq, resolution);
-        *timer_num = bus->timer_num;
-        return true;
-      }
+  uint64_t ledc_pins = perimanGetTypePins(ESP32_BUS_TYPE_LEDC);
+  int8_t i;
+  while ((i = perimanNextPin(&ledc_pins)) >= 0) {
+    ledc_channel_handle_t *bus = (ledc_channel_handle_t *)perimanGetPinBus(i, ESP32_BUS_TYPE_LEDC);
+    if (bus != NULL && (bus->channel / SOC_LEDC_CHANNEL_NUM) == speed_mode && bus->freq_hz == freq && bus->channel_resolution == resolution) {
+      log_d("Found matching timer %u for freq=%" PRIu32 ", resolution=%u", bus->timer_num, freq, resolution);
+      *timer_num = bus->timer_num;
+      return true;
     }
   }
   log_d("No matching timer found for freq=%" PRIu32 ", resolution=%u", freq, resolution);
@@ -81,17 +77,13 @@ static bool find_matching_timer(uint8_t speed_mode, uint32_t freq, uint8_t resol
 static bool find_free_timer(uint8_t speed_mode, uint8_t *timer_num) {
   // Check which timers are in use
   uint8_t used_timers = 0;
-  for (uint8_t i = 0; i < SOC_GPIO_PIN_COUNT; i++) {
-    if (!perimanPinIsValid(i)) {
-      continue;
-    }
-    peripheral_bus_type_t type = perimanGetPinBusType(i);
-    if (type == ESP32_BUS_TYPE_LEDC) {
-      ledc_channel_handle_t *bus = (ledc_channel_handle_t *)perimanGetPinBus(i, ESP32_BUS_TYPE_LEDC);
-      if (bus != NULL && (bus->channel / SOC_LEDC_CHANNEL_NUM) == speed_mode) {
-        log_d("Timer %u is in use by channel %u", bus->timer_num, bus->channel);
-        used_timers |= (1 << bus->timer_num);
-      }
+  uint64_t ledc_pins = perimanGetTypePins(ESP32_BUS_TYPE_LEDC);
+  int8_t i;
+  while ((i = perimanNextPin(&ledc_pins)) >= 0) {
+    ledc_channel_handle_t *bus = (ledc_channel_handle_t *)perimanGetPinBus(i, ESP32_BUS_TYPE_LEDC);
+    if (bus != NULL && (bus->channel / SOC_LEDC_CHANNEL_NUM) == speed_mode) {
+      log_d("Timer %u is in use by channel %u", bus->timer_num, bus->channel);
+      used_timers |= (1 << bus->timer_num);
     }
   }
 
@@ -116,18 +108,14 @@ static void remove_channel_from_timer(uint8_t speed_mode, uint8_t timer_num, uin
 
   // Check if any other channels are using this timer
   bool timer_in_use = false;
-  for (uint8_t i = 0; i < SOC_GPIO_PIN_COUNT; i++) {
-    if (!perimanPinIsValid(i)) {
-      continue;
-    }
-    peripheral_bus_type_t type = perimanGetPinBusType(i);
-    if (type == ESP32_BUS_TYPE_LEDC) {
-      ledc_channel_handle_t *bus = (ledc_channel_handle_t *)perimanGetPinBus(i, ESP32_BUS_TYPE_LEDC);
-      if (bus != NULL && (bus->channel / SOC_LEDC_CHANNEL_NUM) == speed_mode && bus->timer_num == timer_num && bus->channel != channel) {
-        log_d("Timer %u is still in use by channel %u", timer_num, bus->channel);
-        timer_in_use = true;
-        break;
-      }
+  uint64_t ledc_pins = perimanGetTypePins(ESP32_BUS_TYPE_LEDC);
+  int8_t i;
+  while ((i = perimanNextPin(&ledc_pins)) >= 0) {
+    ledc_channel_handle_t *bus = (ledc_channel_handle_t *)perimanGetPinBus(i, ESP32_BUS_TYPE_LEDC);
+    if (bus != NULL && (bus->channel / SOC_LEDC_CHANNEL_NUM) == speed_mode && bus->timer_num == timer_num && bus->channel != channel) {
+      log_d("Timer %u is still in use by channel %u", timer_num, bus->channel);
+      timer_in_use = true;
+      break;
     }
   }
 
@@ -166,17 +154,13 @@ static bool ledcDetachBus(void *bus) {
   ledc_channel_handle_t *handle = (ledc_channel_handle_t *)bus;
   bool channel_found = false;
   // Check if more pins are attached to the same ledc channel
-  for (uint8_t i = 0; i < SOC_GPIO_PIN_COUNT; i++) {
-    if (!perimanPinIsValid(i) || i == handle->pin) {
-      continue;  //invalid pin or same pin
-    }
-    peripheral_bus_type_t type = perimanGetPinBusType(i);
-    if (type == ESP32_BUS_TYPE_LEDC) {
-      ledc_channel_handle_t *bus_check = (ledc_channel_handle_t *)perimanGetPinBus(i, ESP32_BUS_TYPE_LEDC);
-      if (bus_check->channel == handle->channel) {
-        channel_found = true;
-        break;
-      }
+  uint64_t ledc_pins = perimanGetTypePins(ESP32_BUS_TYPE_LEDC) & ~PERIMAN_PIN_MASK(handle->pin);
+  int8_t i;
+  while ((i = perimanNextPin(&ledc_pins)) >= 0) {
+    ledc_channel_handle_t *bus_check = (ledc_channel_handle_t *)perimanGetPinBus(i, ESP32_BUS_TYPE_LEDC);
+    if (bus_check->channel == handle->channel) {
+      channel_found = true;
+      break;
     }
   }
   pinMatrixOutDetach(handle->pin, false, false);
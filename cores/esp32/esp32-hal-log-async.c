@@ -0,0 +1,475 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Deferred log output.
+ *
+ * When enabled with log_async_begin(), log_printf() and the log_x() macros copy
+ * each formatted record into a ring buffer and return immediately. A low priority
+ * task drains the ring to the configured output, so the callers never wait for
+ * the UART. When the ring is full the record is dropped and counted instead of
+ * blocking.
+ *
+ * The ring is lock-free for any number of producers (tasks and ISRs): a writer
+ * reserves space by advancing `head` with a compare-and-swap, copies its record
+ * and then publishes it by setting the committed bit in the record header. The
+ * drain consumes committed records in order, zeroes them and advances `tail`.
+ * Records that would cross the end of the buffer are preceded by a padding
+ * record so that every record is contiguous.
+ */
+
+#include "esp32-hal-log.h"
+#include "esp32-hal-format.h"
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_system.h"
+
+#ifndef CONFIG_ARDUHAL_LOG_ASYNC_TASK_STACK_SIZE
+#define CONFIG_ARDUHAL_LOG_ASYNC_TASK_STACK_SIZE 2560
+#endif
+
+#ifndef CONFIG_ARDUHAL_LOG_ASYNC_TASK_PRIORITY
+#define CONFIG_ARDUHAL_LOG_ASYNC_TASK_PRIORITY 1
+#endif
+
+#define LOG_ASYNC_HDR_COMMITTED 0x80000000UL
+#define LOG_ASYNC_HDR_PADDING   0x40000000UL
+#define LOG_ASYNC_HDR_BINARY    0x20000000UL
+#define LOG_ASYNC_HDR_LEN_MASK  0x0000FFFFUL
+#define LOG_ASYNC_HDR_SIZE      sizeof(uint32_t)
+#define LOG_ASYNC_MIN_SIZE      256
+#define LOG_ASYNC_IDLE_MS       100
+#define LOG_ASYNC_CHUNK_SIZE    128
+
+#define LOG_ASYNC_ALIGN(n) (((n) + 3) & ~3UL)
+
+typedef _Atomic uint32_t log_async_atomic_t;
+
+typedef struct {
+  uint8_t *buf;
+  uint32_t size;  // power of two
+  log_async_atomic_t head;
+  log_async_atomic_t tail;
+  log_async_atomic_t writers;  // producers between the enabled check and their commit
+  atomic_bool enabled;
+  atomic_bool draining;
+  volatile bool running;
+  TaskHandle_t task;
+  log_async_output_t output;
+  void *output_arg;
+  log_async_atomic_t queued_bytes;
+  log_async_atomic_t written_bytes;
+  log_async_atomic_t dropped_bytes;
+  log_async_atomic_t dropped_records;
+  log_async_atomic_t high_water;
+} log_async_t;
+
+static log_async_t s_log_async;
+
+// Default output: the same console as the synchronous log_printf()
+static void log_async_console_output(void *arg, const char *data, size_t len) {
+  (void)arg;
+  log_write(data, len);
+}
+
+static void log_async_update_high_water(uint32_t used) {
+  uint32_t high = atomic_load_explicit(&s_log_async.high_water, memory_order_relaxed);
+  while (used > high && !atomic_compare_exchange_weak_explicit(&s_log_async.high_water, &high, used, memory_order_relaxed, memory_order_relaxed)) {}
+}
+
+static void log_async_wake_drain(void) {
+  TaskHandle_t task = s_log_async.task;
+  if (task == NULL) {
+    return;
+  }
+  if (xPortInIsrContext()) {
+    vTaskNotifyGiveFromISR(task, NULL);
+  } else {
+    xTaskNotifyGive(task);
+  }
+}
+
+// Space reserved in the ring for one record
+typedef struct {
+  uint8_t *data;  // the payload, NULL when the record was dropped
+  uint32_t offset;
+  uint32_t len;
+  uint32_t head;
+  uint32_t tail;
+  uint32_t total;
+} log_async_slot_t;
+
+static void log_async_count_dropped(size_t len) {
+  atomic_fetch_add_explicit(&s_log_async.dropped_bytes, len, memory_order_relaxed);
+  atomic_fetch_add_explicit(&s_log_async.dropped_records, 1, memory_order_relaxed);
+}
+
+// Reserves room for a record of at least min_len and at most max_len bytes,
+// taking as much as is free. False when async logging is not enabled, otherwise
+// the slot must be given to log_async_commit() unless its data is NULL (not even
+// min_len bytes were free and the record was counted as dropped).
+static bool log_async_reserve(size_t min_len, size_t max_len, log_async_slot_t *slot) {
+  log_async_t *la = &s_log_async;
+  if (!atomic_load_explicit(&la->enabled, memory_order_acquire)) {
+    return false;
+  }
+  atomic_fetch_add_explicit(&la->writers, 1, memory_order_acq_rel);
+  // re-check, log_async_end() may have started in between
+  if (!atomic_load_explicit(&la->enabled, memory_order_acquire)) {
+    atomic_fetch_sub_explicit(&la->writers, 1, memory_order_release);
+    return false;
+  }
+
+  uint32_t min_need = LOG_ASYNC_ALIGN(LOG_ASYNC_HDR_SIZE + min_len);
+  uint32_t max_need = LOG_ASYNC_ALIGN(LOG_ASYNC_HDR_SIZE + max_len);
+  uint32_t head = atomic_load_explicit(&la->head, memory_order_relaxed);
+  uint32_t tail, offset, pad, need;
+  bool fits = (min_len <= LOG_ASYNC_HDR_LEN_MASK) && (min_need <= la->size / 2);
+  while (fits) {
+    tail = atomic_load_explicit(&la->tail, memory_order_acquire);
+    offset = head & (la->size - 1);
+    // free space, and how much of it is contiguous from where the record starts
+    uint32_t room = la->size - (head - tail);
+    pad = (min_need > la->size - offset) ? la->size - offset : 0;
+    uint32_t avail = pad ? ((room > pad) ? room - pad : 0) : ((room < la->size - offset) ? room : la->size - offset);
+    if (avail < min_need) {
+      fits = false;
+      break;
+    }
+    need = (max_need < avail) ? max_need : avail;
+    if (atomic_compare_exchange_weak_explicit(&la->head, &head, head + pad + need, memory_order_acq_rel, memory_order_relaxed)) {
+      break;
+    }
+  }
+  if (!fits) {
+    log_async_count_dropped(min_len);
+    atomic_fetch_sub_explicit(&la->writers, 1, memory_order_release);
+    // dropped records are still "handled", the caller must not block on the console
+    slot->data = NULL;
+    return true;
+  }
+
+  if (pad) {
+    atomic_store_explicit((log_async_atomic_t *)(la->buf + offset), LOG_ASYNC_HDR_COMMITTED | LOG_ASYNC_HDR_PADDING | pad, memory_order_release);
+    offset = 0;
+  }
+  slot->data = la->buf + offset + LOG_ASYNC_HDR_SIZE;
+  slot->offset = offset;
+  slot->len = (need - LOG_ASYNC_HDR_SIZE < max_len) ? need - LOG_ASYNC_HDR_SIZE : max_len;
+  slot->head = head;
+  slot->tail = tail;
+  slot->total = pad + need;
+  return true;
+}
+
+// Publishes the first len bytes (at most the reserved length) of a slot
+static void log_async_commit(log_async_slot_t *slot, size_t len, uint32_t flags) {
+  log_async_t *la = &s_log_async;
+  uint32_t used = LOG_ASYNC_ALIGN(LOG_ASYNC_HDR_SIZE + len);
+  uint32_t rest = LOG_ASYNC_ALIGN(LOG_ASYNC_HDR_SIZE + slot->len) - used;
+  if (rest) {
+    // the record came out shorter than reserved: give the rest back if nobody
+    // has reserved after it, otherwise skip it as padding
+    uint32_t end = slot->head + slot->total;
+    if (atomic_compare_exchange_strong_explicit(&la->head, &end, end - rest, memory_order_acq_rel, memory_order_relaxed)) {
+      slot->total -= rest;
+    } else {
+      atomic_store_explicit(
+        (log_async_atomic_t *)(la->buf + slot->offset + used), LOG_ASYNC_HDR_COMMITTED | LOG_ASYNC_HDR_PADDING | rest, memory_order_release
+      );
+    }
+  }
+  atomic_store_explicit((log_async_atomic_t *)(la->buf + slot->offset), LOG_ASYNC_HDR_COMMITTED | flags | len, memory_order_release);
+  atomic_fetch_add_explicit(&la->queued_bytes, len, memory_order_relaxed);
+  log_async_update_high_water(slot->head + slot->total - slot->tail);
+  atomic_fetch_sub_explicit(&la->writers, 1, memory_order_release);
+
+  // the drain may be waiting on this record even when others are queued before
+  // it, as it stops at the first one that is not committed yet
+  log_async_wake_drain();
+}
+
+// Gives up a reserved slot, the drain skips it as padding
+static void log_async_commit_dropped(log_async_slot_t *slot) {
+  log_async_t *la = &s_log_async;
+  uint32_t step = LOG_ASYNC_ALIGN(LOG_ASYNC_HDR_SIZE + slot->len);
+  atomic_store_explicit((log_async_atomic_t *)(la->buf + slot->offset), LOG_ASYNC_HDR_COMMITTED | LOG_ASYNC_HDR_PADDING | step, memory_order_release);
+  atomic_fetch_sub_explicit(&la->writers, 1, memory_order_release);
+  log_async_wake_drain();
+}
+
+static bool log_async_push(const void *data, size_t len, uint32_t flags) {
+  log_async_slot_t slot;
+  if (!log_async_reserve(len, len, &slot)) {
+    return false;
+  }
+  if (slot.data != NULL) {
+    memcpy(slot.data, data, len);
+    log_async_commit(&slot, len, flags);
+  }
+  return true;
+}
+
+bool log_async_write(const char *data, size_t len) {
+  return log_async_push(data, len, 0);
+}
+
+bool log_async_write_binary(const void *record, size_t len) {
+  return log_async_push(record, len, LOG_ASYNC_HDR_BINARY);
+}
+
+// A record being formatted: the first chunk is kept aside, and only when more
+// follows is the record formatted straight into a slot of the ring
+typedef struct {
+  char first[LOG_ASYNC_CHUNK_SIZE];
+  size_t len;      // characters produced so far
+  size_t dropped;  // characters counted as dropped when the slot was reserved
+  bool reserved;
+  bool enabled;
+  log_async_slot_t slot;
+} log_async_record_t;
+
+static void log_async_record_sink(void *ctx, const char *data, size_t len) {
+  log_async_record_t *rec = (log_async_record_t *)ctx;
+  if (!rec->reserved && rec->len == 0) {
+    memcpy(rec->first, data, len);
+    rec->len = len;
+    return;
+  }
+  if (!rec->reserved) {
+    // too long for one chunk: take whatever is free, up to the largest record
+    // the ring accepts, and shrink the slot on commit
+    rec->reserved = true;
+    size_t max_len = s_log_async.size / 2 - LOG_ASYNC_HDR_SIZE;
+    if (max_len > LOG_ASYNC_HDR_LEN_MASK) {
+      max_len = LOG_ASYNC_HDR_LEN_MASK;
+    }
+    rec->enabled = log_async_reserve(rec->len + len, max_len, &rec->slot);
+    if (rec->enabled && rec->slot.data == NULL) {
+      rec->dropped = rec->len + len;
+    } else if (rec->enabled) {
+      memcpy(rec->slot.data, rec->first, rec->len);
+    }
+  }
+  if (rec->enabled && rec->slot.data != NULL && rec->len + len <= rec->slot.len) {
+    memcpy(rec->slot.data + rec->len, data, len);
+  }
+  rec->len += len;
+}
+
+int log_async_vprintf(const char *format, va_list arg) {
+  char chunk[LOG_ASYNC_CHUNK_SIZE];
+  log_async_record_t rec = {.len = 0, .dropped = 0, .reserved = false, .enabled = true};
+  va_list copy;
+  va_copy(copy, arg);
+  int len = format_vprintf(chunk, sizeof(chunk), log_async_record_sink, &rec, format, copy);
+  va_end(copy);
+  if (!rec.reserved) {
+    return log_async_push(rec.first, rec.len, 0) ? len : -1;
+  }
+  if (!rec.enabled) {
+    return -1;
+  }
+  if (rec.slot.data == NULL) {
+    // counted when the reservation failed, with the length known at that time
+    atomic_fetch_add_explicit(&s_log_async.dropped_bytes, rec.len - rec.dropped, memory_order_relaxed);
+  } else if (rec.len > rec.slot.len) {
+    // longer than the free space: drop it whole, a record is never split
+    log_async_commit_dropped(&rec.slot);
+    log_async_count_dropped(rec.len);
+  } else {
+    log_async_commit(&rec.slot, rec.len, 0);
+  }
+  return len;
+}
+
+// Single consumer, the caller must own `draining` unless the system is halted
+static void log_async_drain(log_async_output_t output, void *arg) {
+  log_async_t *la = &s_log_async;
+  uint32_t tail = atomic_load_explicit(&la->tail, memory_order_relaxed);
+  while (tail != atomic_load_explicit(&la->head, memory_order_acquire)) {
+    uint32_t offset = tail & (la->size - 1);
+    uint32_t hdr = atomic_load_explicit((log_async_atomic_t *)(la->buf + offset), memory_order_acquire);
+    if (!(hdr & LOG_ASYNC_HDR_COMMITTED)) {
+      // reserved but still being written
+      break;
+    }
+    uint32_t len = hdr & LOG_ASYNC_HDR_LEN_MASK;
+    uint32_t step = len;
+    if (!(hdr & LOG_ASYNC_HDR_PADDING)) {
+      if (hdr & LOG_ASYNC_HDR_BINARY) {
+        // deferred formatting, see log_binary_set_mode()
+        log_binary_render(la->buf + offset + LOG_ASYNC_HDR_SIZE, len, output, arg);
+      } else {
+        output(arg, (const char *)la->buf + offset + LOG_ASYNC_HDR_SIZE, len);
+      }
+      atomic_fetch_add_explicit(&la->written_bytes, len, memory_order_relaxed);
+      step = LOG_ASYNC_ALIGN(LOG_ASYNC_HDR_SIZE + len);
+    }
+    // a stale header must never look committed when the space is reused
+    memset(la->buf + offset, 0, step);
+    tail += step;
+    atomic_store_explicit(&la->tail, tail, memory_order_release);
+  }
+}
+
+static bool log_async_try_drain(void) {
+  log_async_t *la = &s_log_async;
+  if (atomic_exchange_explicit(&la->draining, true, memory_order_acquire)) {
+    return false;
+  }
+  log_async_drain(la->output, la->output_arg);
+  atomic_store_explicit(&la->draining, false, memory_order_release);
+  return true;
+}
+
+static void log_async_task(void *arg) {
+  (void)arg;
+  while (s_log_async.running) {
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(LOG_ASYNC_IDLE_MS));
+    log_async_try_drain();
+  }
+  log_async_try_drain();
+  s_log_async.task = NULL;
+  vTaskDelete(NULL);
+}
+
+static void log_async_shutdown_handler(void) {
+  log_async_panic_flush();
+}
+
+bool log_async_begin(size_t buffer_size) {
+  log_async_t *la = &s_log_async;
+  if (atomic_load(&la->enabled) || la->task != NULL) {
+    return true;
+  }
+  uint32_t size = LOG_ASYNC_MIN_SIZE;
+  while (size < buffer_size) {
+    size <<= 1;
+  }
+  la->buf = (uint8_t *)calloc(1, size);
+  if (la->buf == NULL) {
+    return false;
+  }
+  la->size = size;
+  if (la->output == NULL) {
+    la->output = log_async_console_output;
+    la->output_arg = NULL;
+  }
+  atomic_store(&la->head, 0);
+  atomic_store(&la->tail, 0);
+  atomic_store(&la->writers, 0);
+  atomic_store(&la->draining, false);
+  atomic_store(&la->queued_bytes, 0);
+  atomic_store(&la->written_bytes, 0);
+  atomic_store(&la->dropped_bytes, 0);
+  atomic_store(&la->dropped_records, 0);
+  atomic_store(&la->high_water, 0);
+  la->running = true;
+  if (xTaskCreateUniversal(
+        log_async_task, "log_async", CONFIG_ARDUHAL_LOG_ASYNC_TASK_STACK_SIZE, NULL, CONFIG_ARDUHAL_LOG_ASYNC_TASK_PRIORITY, &la->task, -1
+      )
+      != pdPASS) {
+    la->running = false;
+    la->task = NULL;
+    free(la->buf);
+    la->buf = NULL;
+    return false;
+  }
+  esp_register_shutdown_handler(log_async_shutdown_handler);
+  atomic_store_explicit(&la->enabled, true, memory_order_release);
+  return true;
+}
+
+void log_async_end(void) {
+  log_async_t *la = &s_log_async;
+  if (!atomic_exchange(&la->enabled, false)) {
+    return;
+  }
+  // let the writers that got past the enabled check finish their record
+  while (atomic_load_explicit(&la->writers, memory_order_acquire)) {
+    vTaskDelay(1);
+  }
+  la->running = false;
+  xTaskNotifyGive(la->task);
+  while (la->task != NULL) {
+    vTaskDelay(1);
+  }
+  esp_unregister_shutdown_handler(log_async_shutdown_handler);
+  free(la->buf);
+  la->buf = NULL;
+  la->size = 0;
+}
+
+bool log_async_enabled(void) {
+  return atomic_load_explicit(&s_log_async.enabled, memory_order_acquire);
+}
+
+void log_async_set_output(log_async_output_t output, void *arg) {
+  log_async_t *la = &s_log_async;
+  // swap outside of a drain pass, so a record is never split between outputs
+  while (atomic_exchange_explicit(&la->draining, true, memory_order_acquire)) {
+    vTaskDelay(1);
+  }
+  la->output = (output != NULL) ? output : log_async_console_output;
+  la->output_arg = (output != NULL) ? arg : NULL;
+  atomic_store_explicit(&la->draining, false, memory_order_release);
+}
+
+// Whether the records reserved before head was at target are not all drained yet.
+// A slot that was shrunk on commit moves head back, so target may never be reached.
+static bool log_async_pending(uint32_t target) {
+  uint32_t tail = atomic_load_explicit(&s_log_async.tail, memory_order_acquire);
+  return (int32_t)(target - tail) > 0 && tail != atomic_load_explicit(&s_log_async.head, memory_order_acquire);
+}
+
+void log_async_flush(void) {
+  log_async_t *la = &s_log_async;
+  if (la->buf == NULL) {
+    return;
+  }
+  uint32_t target = atomic_load_explicit(&la->head, memory_order_acquire);
+  while (log_async_pending(target)) {
+    if (!log_async_try_drain()) {
+      // the drain task is busy, let it finish
+      vTaskDelay(1);
+    } else if (log_async_pending(target)) {
+      // a producer has reserved but not committed yet
+      vTaskDelay(1);
+    }
+  }
+}
+
+void log_async_panic_flush(void) {
+  log_async_t *la = &s_log_async;
+  if (la->buf == NULL) {
+    return;
+  }
+  // the other tasks are halted: ignore the drain lock and the configured output,
+  // which may need locks or the scheduler, and print what was committed
+  atomic_store_explicit(&la->enabled, false, memory_order_release);
+  log_async_drain(log_async_console_output, NULL);
+}
+
+void log_async_get_stats(log_async_stats_t *stats) {
+  log_async_t *la = &s_log_async;
+  if (stats == NULL) {
+    return;
+  }
+  stats->buffer_size = la->size;
+  stats->pending_bytes = (uint32_t)(atomic_load(&la->head) - atomic_load(&la->tail));
+  stats->high_water = atomic_load(&la->high_water);
+  stats->queued_bytes = atomic_load(&la->queued_bytes);
+  stats->written_bytes = atomic_load(&la->written_bytes);
+  stats->dropped_bytes = atomic_load(&la->dropped_bytes);
+  stats->dropped_records = atomic_load(&la->dropped_records);
+}
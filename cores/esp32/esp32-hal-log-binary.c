@@ -0,0 +1,595 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Binary log records.
+ *
+ * In binary mode a log call is not formatted. The record only stores the
+ * timestamp, the level, the address of the format string and the raw
+ * arguments, which is a fraction of the text and of the CPU time needed to
+ * produce it. The text is produced later: off-device by
+ * tools/decode_binary_log.py, which reads the format strings from the ELF, or
+ * on-device by the async log task (LOG_BINARY_DEFERRED).
+ *
+ * Stream layout, all fields little endian:
+ *
+ *   record  := sync:u8 info:u8 length:u16 payload[length]
+ *   info    := level (bits 0-3) | type (bits 4-6) | truncated (bit 7)
+ *   header  := version:u8 ptr_size:u8 reserved:u16 anchor:ptr      (type 1)
+ *   log     := timestamp_ms:u32 format:ptr args...                 (type 0)
+ *
+ * The arguments follow the conversions of the format string: `*` width and
+ * precision as i32, integers as 4 bytes, 8 bytes for `ll`/`j` and pointer size
+ * for `l`/`z`/`t`/`p`, floating point as a double. A `%s` argument is a kind
+ * byte followed by nothing (NULL), the string address (strings in flash) or a
+ * length byte and the characters (anything else, truncated to the record).
+ * A record that could not hold all of its arguments has the truncated bit set.
+ *
+ * The header carries the address of a known string so that the decoder can
+ * match addresses against the ELF even when the image is relocated.
+ */
+
+#include "esp32-hal-log.h"
+#include "esp32-hal-format.h"
+
+#include <stdatomic.h>
+#include <string.h>
+
+#include "esp_log.h"
+#include "esp_memory_utils.h"
+
+#define LOG_BINARY_SYNC           0xB5
+#define LOG_BINARY_VERSION        1
+#define LOG_BINARY_PREFIX_SIZE    4
+#define LOG_BINARY_INFO_LEVEL     0x0F
+#define LOG_BINARY_INFO_TYPE      0x70
+#define LOG_BINARY_INFO_TRUNCATED 0x80
+#define LOG_BINARY_TYPE_LOG       0x00
+#define LOG_BINARY_TYPE_HEADER    0x10
+#define LOG_BINARY_STR_NULL       0
+#define LOG_BINARY_STR_REF        1
+#define LOG_BINARY_STR_INLINE     2
+#define LOG_BINARY_RECORD_SIZE    160
+#define LOG_BINARY_RENDER_CHUNK   64
+
+// located by the decoder in the ELF, see the stream header
+static const char log_binary_anchor[] = "arduhal-binary-log-anchor-v1";
+
+typedef enum {
+  LOG_BINARY_LEN_NONE,
+  LOG_BINARY_LEN_HH,
+  LOG_BINARY_LEN_H,
+  LOG_BINARY_LEN_L,
+  LOG_BINARY_LEN_LL,
+  LOG_BINARY_LEN_J,
+  LOG_BINARY_LEN_Z,
+  LOG_BINARY_LEN_T,
+  LOG_BINARY_LEN_LD,
+} log_binary_len_t;
+
+// one conversion of a format string, as parsed by log_binary_parse_spec()
+typedef struct {
+  const char *start;  // the '%'
+  const char *flags;
+  size_t flags_len;
+  bool width_arg;     // '*'
+  int width;
+  bool precision_arg;
+  int precision;      // -1 when not given
+  log_binary_len_t length;
+  char conv;          // '\0' for a dangling '%'
+} log_binary_spec_t;
+
+typedef struct {
+  uint8_t *buf;
+  size_t size;
+  size_t len;
+  bool truncated;
+} log_binary_writer_t;
+
+typedef struct {
+  const uint8_t *p;
+  const uint8_t *end;
+} log_binary_reader_t;
+
+static _Atomic int s_log_binary_mode = LOG_BINARY_OFF;
+static log_async_output_t s_log_binary_output = NULL;
+static void *s_log_binary_output_arg = NULL;
+
+// parses the conversion following the '%' at *format and advances past it
+static void log_binary_parse_spec(const char **format, log_binary_spec_t *spec) {
+  const char *p = *format;
+  spec->start = p++;
+  spec->flags = p;
+  while (*p == '-' || *p == '+' || *p == ' ' || *p == '#' || *p == '0') {
+    p++;
+  }
+  spec->flags_len = p - spec->flags;
+
+  spec->width_arg = false;
+  spec->width = 0;
+  if (*p == '*') {
+    spec->width_arg = true;
+    p++;
+  } else {
+    while (*p >= '0' && *p <= '9') {
+      spec->width = spec->width * 10 + (*p++ - '0');
+    }
+  }
+
+  spec->precision_arg = false;
+  spec->precision = -1;
+  if (*p == '.') {
+    p++;
+    spec->precision = 0;
+    if (*p == '*') {
+      spec->precision_arg = true;
+      p++;
+    } else {
+      while (*p >= '0' && *p <= '9') {
+        spec->precision = spec->precision * 10 + (*p++ - '0');
+      }
+    }
+  }
+
+  spec->length = LOG_BINARY_LEN_NONE;
+  switch (*p) {
+    case 'h':
+      p++;
+      spec->length = LOG_BINARY_LEN_H;
+      if (*p == 'h') {
+        p++;
+        spec->length = LOG_BINARY_LEN_HH;
+      }
+      break;
+    case 'l':
+      p++;
+      spec->length = LOG_BINARY_LEN_L;
+      if (*p == 'l') {
+        p++;
+        spec->length = LOG_BINARY_LEN_LL;
+      }
+      break;
+    case 'j': p++; spec->length = LOG_BINARY_LEN_J; break;
+    case 'z': p++; spec->length = LOG_BINARY_LEN_Z; break;
+    case 't': p++; spec->length = LOG_BINARY_LEN_T; break;
+    case 'L': p++; spec->length = LOG_BINARY_LEN_LD; break;
+    default:  break;
+  }
+
+  spec->conv = *p;
+  if (*p) {
+    p++;
+  }
+  *format = p;
+}
+
+// encoded size of an integer argument
+static size_t log_binary_int_size(log_binary_len_t length) {
+  switch (length) {
+    case LOG_BINARY_LEN_L: return sizeof(long);
+    case LOG_BINARY_LEN_LL:
+    case LOG_BINARY_LEN_J: return sizeof(long long);
+    case LOG_BINARY_LEN_Z: return sizeof(size_t);
+    case LOG_BINARY_LEN_T: return sizeof(ptrdiff_t);
+    default:               return sizeof(int);
+  }
+}
+
+static bool log_binary_put(log_binary_writer_t *w, const void *data, size_t len) {
+  if (w->truncated || len > w->size - w->len) {
+    w->truncated = true;
+    return false;
+  }
+  memcpy(w->buf + w->len, data, len);
+  w->len += len;
+  return true;
+}
+
+static bool log_binary_put_u8(log_binary_writer_t *w, uint8_t value) {
+  return log_binary_put(w, &value, 1);
+}
+
+static void log_binary_put_string(log_binary_writer_t *w, const char *s, int precision) {
+  if (s == NULL) {
+    log_binary_put_u8(w, LOG_BINARY_STR_NULL);
+    return;
+  }
+  if (esp_ptr_in_drom(s)) {
+    // constant strings (__FILE__, __func__, tags) are resolved by the decoder
+    if (log_binary_put_u8(w, LOG_BINARY_STR_REF)) {
+      log_binary_put(w, &s, sizeof(s));
+    }
+    return;
+  }
+  size_t len = 0;
+  size_t max = (precision >= 0 && precision < 255) ? (size_t)precision : 255;
+  while (len < max && s[len]) {
+    len++;
+  }
+  if (w->truncated || w->size - w->len < 2) {
+    w->truncated = true;
+    return;
+  }
+  if (len > w->size - w->len - 2) {
+    len = w->size - w->len - 2;
+  }
+  log_binary_put_u8(w, LOG_BINARY_STR_INLINE);
+  log_binary_put_u8(w, (uint8_t)len);
+  log_binary_put(w, s, len);
+}
+
+// encodes a log record into buf, returns its size
+static size_t log_binary_encode(uint8_t *buf, size_t size, uint8_t level, const char *format, va_list arg) {
+  log_binary_writer_t w = {buf, size, LOG_BINARY_PREFIX_SIZE, false};
+  uint32_t timestamp = esp_log_timestamp();
+  log_binary_put(&w, &timestamp, sizeof(timestamp));
+  log_binary_put(&w, &format, sizeof(format));
+
+  va_list args;
+  va_copy(args, arg);
+  const char *p = format;
+  while (*p) {
+    if (*p != '%') {
+      p++;
+      continue;
+    }
+    log_binary_spec_t spec;
+    log_binary_parse_spec(&p, &spec);
+    // arguments are always consumed, even once the record is full, so that
+    // the va_list stays in step with the format
+    if (spec.width_arg) {
+      int32_t width = va_arg(args, int);
+      log_binary_put(&w, &width, sizeof(width));
+    }
+    if (spec.precision_arg) {
+      int32_t precision = va_arg(args, int);
+      log_binary_put(&w, &precision, sizeof(precision));
+      spec.precision = precision;
+    }
+    switch (spec.conv) {
+      case 'd':
+      case 'i':
+      case 'u':
+      case 'o':
+      case 'x':
+      case 'X':
+      case 'c':
+        switch (spec.length) {
+          case LOG_BINARY_LEN_L:
+          {
+            long value = va_arg(args, long);
+            log_binary_put(&w, &value, sizeof(value));
+            break;
+          }
+          case LOG_BINARY_LEN_LL:
+          case LOG_BINARY_LEN_J:
+          {
+            long long value = va_arg(args, long long);
+            log_binary_put(&w, &value, sizeof(value));
+            break;
+          }
+          case LOG_BINARY_LEN_Z:
+          {
+            size_t value = va_arg(args, size_t);
+            log_binary_put(&w, &value, sizeof(value));
+            break;
+          }
+          case LOG_BINARY_LEN_T:
+          {
+            ptrdiff_t value = va_arg(args, ptrdiff_t);
+            log_binary_put(&w, &value, sizeof(value));
+            break;
+          }
+          default:
+          {
+            int value = va_arg(args, int);
+            log_binary_put(&w, &value, sizeof(value));
+            break;
+          }
+        }
+        break;
+      case 'p':
+      {
+        void *value = va_arg(args, void *);
+        log_binary_put(&w, &value, sizeof(value));
+        break;
+      }
+      case 's': log_binary_put_string(&w, va_arg(args, const char *), spec.precision); break;
+      case 'f':
+      case 'F':
+      case 'e':
+      case 'E':
+      case 'g':
+      case 'G':
+      case 'a':
+      case 'A':
+      {
+        double value = (spec.length == LOG_BINARY_LEN_LD) ? (double)va_arg(args, long double) : va_arg(args, double);
+        log_binary_put(&w, &value, sizeof(value));
+        break;
+      }
+      case 'n': (void)va_arg(args, void *); break;
+      default:  break;
+    }
+  }
+  va_end(args);
+
+  uint16_t length = w.len - LOG_BINARY_PREFIX_SIZE;
+  buf[0] = LOG_BINARY_SYNC;
+  buf[1] = LOG_BINARY_TYPE_LOG | (level & LOG_BINARY_INFO_LEVEL) | (w.truncated ? LOG_BINARY_INFO_TRUNCATED : 0);
+  memcpy(buf + 2, &length, sizeof(length));
+  return w.len;
+}
+
+static void log_binary_emit(const uint8_t *data, size_t len) {
+  if (s_log_binary_output != NULL) {
+    s_log_binary_output(s_log_binary_output_arg, (const char *)data, len);
+  } else if (!log_async_write((const char *)data, len)) {
+    log_write((const char *)data, len);
+  }
+}
+
+static void log_binary_emit_header(void) {
+  uint8_t buf[LOG_BINARY_PREFIX_SIZE + 4 + sizeof(void *)];
+  const char *anchor = log_binary_anchor;
+  uint16_t length = sizeof(buf) - LOG_BINARY_PREFIX_SIZE;
+  buf[0] = LOG_BINARY_SYNC;
+  buf[1] = LOG_BINARY_TYPE_HEADER;
+  memcpy(buf + 2, &length, sizeof(length));
+  buf[4] = LOG_BINARY_VERSION;
+  buf[5] = sizeof(void *);
+  buf[6] = 0;
+  buf[7] = 0;
+  memcpy(buf + 8, &anchor, sizeof(anchor));
+  log_binary_emit(buf, sizeof(buf));
+}
+
+void log_binary_set_mode(log_binary_mode_t mode) {
+  atomic_store(&s_log_binary_mode, (int)mode);
+  if (mode == LOG_BINARY_RAW) {
+    log_binary_emit_header();
+  }
+}
+
+log_binary_mode_t log_binary_get_mode(void) {
+  return (log_binary_mode_t)atomic_load_explicit(&s_log_binary_mode, memory_order_relaxed);
+}
+
+void log_binary_set_output(log_async_output_t output, void *arg) {
+  s_log_binary_output = output;
+  s_log_binary_output_arg = arg;
+  if (log_binary_get_mode() == LOG_BINARY_RAW) {
+    log_binary_emit_header();
+  }
+}
+
+bool log_binary_writev(uint8_t level, const char *format, va_list arg) {
+  log_binary_mode_t mode = log_binary_get_mode();
+  if (mode == LOG_BINARY_OFF || format == NULL || !esp_ptr_in_drom(format)) {
+    // a format string built at runtime can not be looked up later
+    return false;
+  }
+  if (mode == LOG_BINARY_DEFERRED && !log_async_enabled()) {
+    return false;
+  }
+  uint8_t record[LOG_BINARY_RECORD_SIZE];
+  size_t len = log_binary_encode(record, sizeof(record), level, format, arg);
+  if (mode == LOG_BINARY_DEFERRED) {
+    log_async_write_binary(record, len);
+  } else {
+    log_binary_emit(record, len);
+  }
+  return true;
+}
+
+bool log_binary_write(uint8_t level, const char *format, ...) {
+  va_list arg;
+  va_start(arg, format);
+  bool written = log_binary_writev(level, format, arg);
+  va_end(arg);
+  return written;
+}
+
+static const void *log_binary_get(log_binary_reader_t *r, size_t len) {
+  if ((size_t)(r->end - r->p) < len) {
+    r->p = r->end;
+    return NULL;
+  }
+  const void *data = r->p;
+  r->p += len;
+  return data;
+}
+
+static bool log_binary_get_i32(log_binary_reader_t *r, int *value) {
+  int32_t v;
+  const void *data = log_binary_get(r, sizeof(v));
+  if (data == NULL) {
+    return false;
+  }
+  memcpy(&v, data, sizeof(v));
+  *value = v;
+  return true;
+}
+
+// "%<flags>*.*<length><conv>", the length modifier is chosen by the caller
+static void log_binary_render_spec(char *out, const log_binary_spec_t *spec, const char *length, char conv) {
+  size_t n = 0;
+  out[n++] = '%';
+  for (size_t i = 0; i < spec->flags_len && i < 5; i++) {
+    out[n++] = spec->flags[i];
+  }
+  out[n++] = '*';
+  out[n++] = '.';
+  out[n++] = '*';
+  while (*length) {
+    out[n++] = *length++;
+  }
+  out[n++] = conv;
+  out[n] = '\0';
+}
+
+int log_binary_render(const void *record, size_t len, log_async_output_t output, void *arg) {
+  log_binary_reader_t r = {(const uint8_t *)record, (const uint8_t *)record + len};
+  const uint8_t *prefix = (const uint8_t *)log_binary_get(&r, LOG_BINARY_PREFIX_SIZE);
+  if (prefix == NULL || prefix[0] != LOG_BINARY_SYNC || (prefix[1] & LOG_BINARY_INFO_TYPE) != LOG_BINARY_TYPE_LOG) {
+    return -1;
+  }
+  uint16_t length;
+  memcpy(&length, prefix + 2, sizeof(length));
+  if (length > len - LOG_BINARY_PREFIX_SIZE) {
+    return -1;
+  }
+  r.end = r.p + length;
+  const char *format;
+  if (log_binary_get(&r, sizeof(uint32_t)) == NULL || log_binary_get(&r, sizeof(format)) == NULL) {
+    return -1;
+  }
+  memcpy(&format, r.p - sizeof(format), sizeof(format));
+
+  char chunk[LOG_BINARY_RENDER_CHUNK];
+  char fspec[16];
+  int total = 0;
+  bool missing = false;
+  const char *p = format;
+  while (*p) {
+    const char *text = p;
+    while (*p && *p != '%') {
+      p++;
+    }
+    if (p != text) {
+      total += format_printf(chunk, sizeof(chunk), output, arg, "%.*s", (int)(p - text), text);
+      continue;
+    }
+    log_binary_spec_t spec;
+    log_binary_parse_spec(&p, &spec);
+    int width = spec.width;
+    int precision = spec.precision;
+    if ((spec.width_arg && !log_binary_get_i32(&r, &width)) || (spec.precision_arg && !log_binary_get_i32(&r, &precision))) {
+      missing = true;
+      break;
+    }
+    switch (spec.conv) {
+      case 'd':
+      case 'i':
+      case 'u':
+      case 'o':
+      case 'x':
+      case 'X':
+      case 'c':
+      {
+        size_t size = log_binary_int_size(spec.length);
+        const void *data = log_binary_get(&r, size);
+        if (data == NULL) {
+          missing = true;
+          break;
+        }
+        unsigned long long raw = 0;
+        memcpy(&raw, data, size);  // little endian
+        long long value;
+        bool is_signed = (spec.conv == 'd' || spec.conv == 'i');
+        switch (spec.length) {
+          case LOG_BINARY_LEN_HH: value = is_signed ? (long long)(signed char)raw : (long long)(unsigned char)raw; break;
+          case LOG_BINARY_LEN_H:  value = is_signed ? (long long)(short)raw : (long long)(unsigned short)raw; break;
+          default:
+            if (is_signed && size < sizeof(raw) && (raw >> (size * 8 - 1))) {
+              raw |= ~0ULL << (size * 8);
+            }
+            value = (long long)raw;
+            break;
+        }
+        if (spec.conv == 'c') {
+          log_binary_render_spec(fspec, &spec, "", 'c');
+          total += format_printf(chunk, sizeof(chunk), output, arg, fspec, width, -1, (int)value);
+        } else {
+          log_binary_render_spec(fspec, &spec, "ll", spec.conv);
+          total += format_printf(chunk, sizeof(chunk), output, arg, fspec, width, precision, value);
+        }
+        break;
+      }
+      case 'p':
+      {
+        uintptr_t value;
+        const void *data = log_binary_get(&r, sizeof(value));
+        if (data == NULL) {
+          missing = true;
+          break;
+        }
+        memcpy(&value, data, sizeof(value));
+        log_binary_render_spec(fspec, &spec, "", 'p');
+        total += format_printf(chunk, sizeof(chunk), output, arg, fspec, width, precision, (void *)value);
+        break;
+      }
+      case 's':
+      {
+        const uint8_t *kind = (const uint8_t *)log_binary_get(&r, 1);
+        const char *s = NULL;
+        if (kind == NULL) {
+          missing = true;
+          break;
+        }
+        if (*kind == LOG_BINARY_STR_REF) {
+          const void *data = log_binary_get(&r, sizeof(s));
+          if (data == NULL) {
+            missing = true;
+            break;
+          }
+          memcpy(&s, data, sizeof(s));
+        } else if (*kind == LOG_BINARY_STR_INLINE) {
+          const uint8_t *n = (const uint8_t *)log_binary_get(&r, 1);
+          if (n == NULL || (s = (const char *)log_binary_get(&r, *n)) == NULL) {
+            missing = true;
+            break;
+          }
+          // the copy is not terminated, bound it with the precision
+          if (precision < 0 || precision > *n) {
+            precision = *n;
+          }
+        }
+        log_binary_render_spec(fspec, &spec, "", 's');
+        total += format_printf(chunk, sizeof(chunk), output, arg, fspec, width, precision, s);
+        break;
+      }
+      case 'f':
+      case 'F':
+      case 'e':
+      case 'E':
+      case 'g':
+      case 'G':
+      case 'a':
+      case 'A':
+      {
+        double value;
+        const void *data = log_binary_get(&r, sizeof(value));
+        if (data == NULL) {
+          missing = true;
+          break;
+        }
+        memcpy(&value, data, sizeof(value));
+        if (precision < 0 && spec.conv != 'a' && spec.conv != 'A') {
+          precision = 6;
+        }
+        log_binary_render_spec(fspec, &spec, "", spec.conv);
+        total += format_printf(chunk, sizeof(chunk), output, arg, fspec, width, precision, value);
+        break;
+      }
+      case 'n': break;
+      case '%': total += format_printf(chunk, sizeof(chunk), output, arg, "%%"); break;
+      default:
+        // unknown conversion or a dangling '%', emitted verbatim
+        total += format_printf(chunk, sizeof(chunk), output, arg, "%.*s", (int)(p - spec.start), spec.start);
+        break;
+    }
+    if (missing) {
+      break;
+    }
+  }
+  if (missing) {
+    // the rest of the arguments did not fit into the record
+    total += format_printf(chunk, sizeof(chunk), output, arg, "...\r\n");
+  }
+  return total;
+}
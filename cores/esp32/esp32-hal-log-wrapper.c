@@ -16,26 +16,33 @@
  *
  * This implementation provides simple pass-through wrappers that call the real
  * ESP-IDF logging functions, ensuring compatibility without requiring esp_diagnostics.
+ * In binary log mode (see log_binary_set_mode()) the calls are recorded unformatted.
  */
 
 #ifndef CONFIG_DIAG_USE_EXTERNAL_LOG_WRAP
 
 #include <stdarg.h>
 #include "esp_log.h"
+#include "esp32-hal-log.h"
 
 // Declare the real functions that will be wrapped by the linker
 void __real_esp_log_write(esp_log_level_t level, const char *tag, const char *format, ...);
 void __real_esp_log_writev(esp_log_level_t level, const char *tag, const char *format, va_list args);
+void __wrap_esp_log_writev(esp_log_level_t level, const char *tag, const char *format, va_list args);
 
 // Wrapper implementations that simply call through to the real functions
 void __wrap_esp_log_write(esp_log_level_t level, const char *tag, const char *format, ...) {
   va_list args;
   va_start(args, format);
-  __real_esp_log_writev(level, tag, format, args);
+  __wrap_esp_log_writev(level, tag, format, args);
   va_end(args);
 }
 
 void __wrap_esp_log_writev(esp_log_level_t level, const char *tag, const char *format, va_list args) {
+  // in binary mode the record replaces the text, the level filter still applies
+  if (log_binary_get_mode() != LOG_BINARY_OFF && level <= esp_log_level_get(tag) && log_binary_writev(level, format, args)) {
+    return;
+  }
   __real_esp_log_writev(level, tag, format, args);
 }
 
@@ -18,6 +18,10 @@
 extern "C" {
 #endif
 
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 #include "sdkconfig.h"
 #include "esp_timer.h"
 #include "rom/ets_sys.h"
@@ -89,7 +93,80 @@ extern "C" {
 
 const char *pathToFileName(const char *path);
 int log_printf(const char *fmt, ...);
+// log_printf() of a record at level, the level the log_x() macros give to binary records
+int log_level_printf(uint8_t level, const char *fmt, ...);
 void log_print_buf(const uint8_t *b, size_t len);
+// writes raw bytes, which may include '\0', to the log console
+void log_write(const char *data, size_t len);
+
+/*
+ * Deferred (async) log output.
+ *
+ * Once log_async_begin() is called, log_printf() and the log_x() macros queue
+ * their output in a lock-free ring buffer instead of waiting for the console,
+ * and a low priority task writes it out. Output that does not fit in the ring
+ * is dropped and counted. isr_log_x() and ets_printf() stay synchronous.
+ */
+typedef void (*log_async_output_t)(void *arg, const char *data, size_t len);
+
+typedef struct {
+  uint32_t buffer_size;      // ring buffer size in bytes
+  uint32_t pending_bytes;    // bytes (including record headers) waiting in the ring
+  uint32_t high_water;       // maximum of pending_bytes since log_async_begin()
+  uint32_t queued_bytes;     // log bytes accepted since log_async_begin()
+  uint32_t written_bytes;    // log bytes handed to the output since log_async_begin()
+  uint32_t dropped_bytes;    // log bytes dropped because the ring was full
+  uint32_t dropped_records;  // number of writes dropped because the ring was full
+} log_async_stats_t;
+
+// buffer_size is rounded up to a power of two, 256 bytes minimum
+bool log_async_begin(size_t buffer_size);
+// drains what is queued and returns to synchronous output
+void log_async_end(void);
+bool log_async_enabled(void);
+// output is called from the async log task only, NULL restores the default console output
+void log_async_set_output(log_async_output_t output, void *arg);
+// queues raw log data, returns false when async logging is not enabled
+bool log_async_write(const char *data, size_t len);
+// queues the formatted text as a single record, returns its length or -1 when
+// async logging is not enabled
+int log_async_vprintf(const char *format, va_list arg);
+// waits until everything queued before the call has been written out
+void log_async_flush(void);
+// writes out the queued records from the calling context, without locks or the
+// scheduler, to the console. Used on panic and restart.
+void log_async_panic_flush(void);
+void log_async_get_stats(log_async_stats_t *stats);
+// queues an encoded binary log record, rendered as text by the async log task
+bool log_async_write_binary(const void *record, size_t len);
+
+/*
+ * Binary log records.
+ *
+ * In binary mode log_printf(), the log_x() macros and ESP_LOGx() store the
+ * timestamp, level, format string address and raw arguments of each call
+ * instead of formatting it. LOG_BINARY_RAW writes the records out as they are,
+ * to be decoded off-device against the ELF with tools/decode_binary_log.py.
+ * LOG_BINARY_DEFERRED queues them in the async log ring (see log_async_begin())
+ * and formats them in the async log task. Calls whose format string is not in
+ * flash are still printed as text.
+ */
+typedef enum {
+  LOG_BINARY_OFF,
+  LOG_BINARY_RAW,
+  LOG_BINARY_DEFERRED,
+} log_binary_mode_t;
+
+// LOG_BINARY_RAW starts the stream with a header record
+void log_binary_set_mode(log_binary_mode_t mode);
+log_binary_mode_t log_binary_get_mode(void);
+// raw records go to output, or to the async log ring or the console when NULL
+void log_binary_set_output(log_async_output_t output, void *arg);
+// encodes one record, returns false when the call has to be printed as text
+bool log_binary_writev(uint8_t level, const char *format, va_list arg);
+bool log_binary_write(uint8_t level, const char *format, ...) __attribute__((format(printf, 2, 3)));
+// formats an encoded record to output, its strings must be in memory. Returns the text length or -1
+int log_binary_render(const void *record, size_t len, log_async_output_t output, void *arg);
 
 #define ARDUHAL_SHORT_LOG_FORMAT(letter, format) ARDUHAL_LOG_COLOR_##letter format ARDUHAL_LOG_RESET_COLOR "\r\n"
 #define ARDUHAL_LOG_FORMAT(letter, format)                                                                                                              \
@@ -100,7 +177,7 @@ void log_print_buf(const uint8_t *b, size_t len);
 
 #if ARDUHAL_LOG_LEVEL >= ARDUHAL_LOG_LEVEL_VERBOSE
 #ifndef USE_ESP_IDF_LOG
-#define log_v(format, ...)     log_printf(ARDUHAL_LOG_FORMAT(V, format), ##__VA_ARGS__)
+#define log_v(format, ...)     log_level_printf(ARDUHAL_LOG_LEVEL_VERBOSE, ARDUHAL_LOG_FORMAT(V, format), ##__VA_ARGS__)
 #define isr_log_v(format, ...) ets_printf(ARDUHAL_LOG_FORMAT(V, format), ##__VA_ARGS__)
 #define log_buf_v(b, l)          \
   do {                           \
@@ -136,7 +213,7 @@ void log_print_buf(const uint8_t *b, size_t len);
 
 #if ARDUHAL_LOG_LEVEL >= ARDUHAL_LOG_LEVEL_DEBUG
 #ifndef USE_ESP_IDF_LOG
-#define log_d(format, ...)     log_printf(ARDUHAL_LOG_FORMAT(D, format), ##__VA_ARGS__)
+#define log_d(format, ...)     log_level_printf(ARDUHAL_LOG_LEVEL_DEBUG, ARDUHAL_LOG_FORMAT(D, format), ##__VA_ARGS__)
 #define isr_log_d(format, ...) ets_printf(ARDUHAL_LOG_FORMAT(D, format), ##__VA_ARGS__)
 #define log_buf_d(b, l)          \
   do {                           \
@@ -172,7 +249,7 @@ void log_print_buf(const uint8_t *b, size_t len);
 
 #if ARDUHAL_LOG_LEVEL >= ARDUHAL_LOG_LEVEL_INFO
 #ifndef USE_ESP_IDF_LOG
-#define log_i(format, ...)     log_printf(ARDUHAL_LOG_FORMAT(I, format), ##__VA_ARGS__)
+#define log_i(format, ...)     log_level_printf(ARDUHAL_LOG_LEVEL_INFO, ARDUHAL_LOG_FORMAT(I, format), ##__VA_ARGS__)
 #define isr_log_i(format, ...) ets_printf(ARDUHAL_LOG_FORMAT(I, format), ##__VA_ARGS__)
 #define log_buf_i(b, l)          \
   do {                           \
@@ -208,7 +285,7 @@ void log_print_buf(const uint8_t *b, size_t len);
 
 #if ARDUHAL_LOG_LEVEL >= ARDUHAL_LOG_LEVEL_WARN
 #ifndef USE_ESP_IDF_LOG
-#define log_w(format, ...)     log_printf(ARDUHAL_LOG_FORMAT(W, format), ##__VA_ARGS__)
+#define log_w(format, ...)     log_level_printf(ARDUHAL_LOG_LEVEL_WARN, ARDUHAL_LOG_FORMAT(W, format), ##__VA_ARGS__)
 #define isr_log_w(format, ...) ets_printf(ARDUHAL_LOG_FORMAT(W, format), ##__VA_ARGS__)
 #define log_buf_w(b, l)          \
   do {                           \
@@ -244,7 +321,7 @@ void log_print_buf(const uint8_t *b, size_t len);
 
 #if ARDUHAL_LOG_LEVEL >= ARDUHAL_LOG_LEVEL_ERROR
 #ifndef USE_ESP_IDF_LOG
-#define log_e(format, ...)     log_printf(ARDUHAL_LOG_FORMAT(E, format), ##__VA_ARGS__)
+#define log_e(format, ...)     log_level_printf(ARDUHAL_LOG_LEVEL_ERROR, ARDUHAL_LOG_FORMAT(E, format), ##__VA_ARGS__)
 #define isr_log_e(format, ...) ets_printf(ARDUHAL_LOG_FORMAT(E, format), ##__VA_ARGS__)
 #define log_buf_e(b, l)          \
   do {                           \
@@ -280,7 +357,7 @@ void log_print_buf(const uint8_t *b, size_t len);
 
 #if ARDUHAL_LOG_LEVEL >= ARDUHAL_LOG_LEVEL_NONE
 #ifndef USE_ESP_IDF_LOG
-#define log_n(format, ...)     log_printf(ARDUHAL_LOG_FORMAT(E, format), ##__VA_ARGS__)
+#define log_n(format, ...)     log_level_printf(ARDUHAL_LOG_LEVEL_ERROR, ARDUHAL_LOG_FORMAT(E, format), ##__VA_ARGS__)
 #define isr_log_n(format, ...) ets_printf(ARDUHAL_LOG_FORMAT(E, format), ##__VA_ARGS__)
 #define log_buf_n(b, l)          \
   do {                           \
@@ -21,6 +21,8 @@
 #include "esp_partition.h"
 #include "esp_log.h"
 #include "esp_timer.h"
+#include "esp_vfs_eventfd.h"
+#include <pthread.h>
 #ifdef CONFIG_APP_ROLLBACK_ENABLE
 #include "esp_ota_ops.h"
 #endif  //CONFIG_APP_ROLLBACK_ENABLE
@@ -114,6 +116,29 @@ float temperatureRead() {
 }
 #endif
 
+#ifndef CONFIG_ARDUINO_EVENTFD_MAX_FDS
+#define CONFIG_ARDUINO_EVENTFD_MAX_FDS 8
+#endif
+
+static pthread_once_t _eventfd_once = PTHREAD_ONCE_INIT;
+static esp_err_t _eventfd_err = ESP_OK;
+
+static void eventfd_register_once(void) {
+  esp_vfs_eventfd_config_t config = {
+    .max_fds = CONFIG_ARDUINO_EVENTFD_MAX_FDS,
+  };
+  _eventfd_err = esp_vfs_eventfd_register(&config);
+  // already registered by the application, which owns its size then
+  if (_eventfd_err == ESP_ERR_INVALID_STATE) {
+    _eventfd_err = ESP_OK;
+  }
+}
+
+esp_err_t arduino_eventfd_register(void) {
+  pthread_once(&_eventfd_once, eventfd_register_once);
+  return _eventfd_err;
+}
+
 void __yield() {
   vPortYield();
 }
@@ -457,6 +482,8 @@ static void handle_custom_backtrace(panic_info_t *info) {
 
 void __real_esp_panic_handler(panic_info_t *);
 void __wrap_esp_panic_handler(panic_info_t *info) {
+  // print the deferred log output before the panic report
+  log_async_panic_flush();
   if (_panic_handler != NULL) {
     handle_custom_backtrace(info);
   }
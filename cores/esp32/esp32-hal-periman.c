@@ -17,8 +17,14 @@ typedef struct ATTR_PACKED {
   int8_t bus_channel;
 } peripheral_pin_item_t;
 
+#if SOC_GPIO_PIN_COUNT > 64
+#error "Pin masks hold up to 64 GPIOs"
+#endif
+
 static peripheral_bus_deinit_cb_t deinit_functions[ESP32_BUS_TYPE_MAX] = {NULL};
 static peripheral_pin_item_t pins[SOC_GPIO_PIN_COUNT];
+// Pins of each type, kept in step with pins[] by perimanSetPinItem()
+static uint64_t type_pins[ESP32_BUS_TYPE_MAX] = {[ESP32_BUS_TYPE_INIT] = SOC_GPIO_VALID_GPIO_MASK};
 
 #define GPIO_NOT_VALID(p) ((p >= SOC_GPIO_PIN_COUNT) || ((SOC_GPIO_VALID_GPIO_MASK & (1ULL << p)) == 0))
 
@@ -143,6 +149,20 @@ const char *perimanGetTypeName(peripheral_bus_type_t type) {
   }
 }
 
+static void perimanSetPinItem(uint8_t pin, peripheral_bus_type_t type, void *bus, int8_t bus_num, int8_t bus_channel) {
+  peripheral_bus_type_t otype = pins[pin].type;
+  pins[pin].type = type;
+  pins[pin].bus = bus;
+  pins[pin].bus_num = bus_num;
+  pins[pin].bus_channel = bus_channel;
+  pins[pin].extra_type = NULL;
+  type_pins[otype] &= ~PERIMAN_PIN_MASK(pin);
+  type_pins[type] |= PERIMAN_PIN_MASK(pin);
+#if defined(SOC_GP_LDO_SUPPORTED) && SOC_GP_LDO_SUPPORTED
+  ldoPerimanPinBusSet(pin, otype, type);
+#endif
+}
+
 bool perimanSetPinBus(uint8_t pin, peripheral_bus_type_t type, void *bus, int8_t bus_num, int8_t bus_channel) {
   peripheral_bus_type_t otype = ESP32_BUS_TYPE_INIT;
   void *obus = NULL;
@@ -180,18 +200,81 @@ bool perimanSetPinBus(uint8_t pin, peripheral_bus_type_t type, void *bus, int8_t
       return false;
     }
   }
-  pins[pin].type = type;
-  pins[pin].bus = bus;
-  pins[pin].bus_num = bus_num;
-  pins[pin].bus_channel = bus_channel;
-  pins[pin].extra_type = NULL;
-#if defined(SOC_GP_LDO_SUPPORTED) && SOC_GP_LDO_SUPPORTED
-  ldoPerimanPinBusSet(pin, otype, type);
-#endif
+  perimanSetPinItem(pin, type, bus, bus_num, bus_channel);
   log_v("Pin %u successfully set to type %s (%u) with bus %p", pin, perimanGetTypeName(type), (unsigned int)type, bus);
   return true;
 }
 
+bool perimanClearPins(uint64_t mask) {
+  bool ok = true;
+  mask &= SOC_GPIO_VALID_GPIO_MASK & ~type_pins[ESP32_BUS_TYPE_INIT];
+  int8_t pin;
+  while ((pin = perimanNextPin(&mask)) >= 0) {
+    peripheral_bus_type_t type = pins[pin].type;
+    void *bus = pins[pin].bus;
+    if (type == ESP32_BUS_TYPE_INIT) {
+      continue;  // detached by an earlier deinit callback
+    }
+    // the other pins of the mask on the same bus
+    uint64_t same = PERIMAN_PIN_MASK(pin);
+    uint64_t rest = mask & type_pins[type];
+    int8_t other;
+    while ((other = perimanNextPin(&rest)) >= 0) {
+      if (pins[other].bus == bus) {
+        same |= PERIMAN_PIN_MASK(other);
+      }
+    }
+    mask &= ~same;
+    if (bus != NULL) {
+      if (deinit_functions[type] == NULL) {
+        log_e("No deinit function for type %s (%u) (pin %u)", perimanGetTypeName(type), (unsigned int)type, pin);
+        ok = false;
+        continue;
+      }
+      if (!deinit_functions[type](bus)) {
+        log_e("Deinit function for bus type %s (%u) failed (pin %u)", perimanGetTypeName(type), (unsigned int)type, pin);
+        ok = false;
+        continue;
+      }
+    }
+    // the callback may have moved some of them already
+    same &= type_pins[type];
+    while ((other = perimanNextPin(&same)) >= 0) {
+      if (pins[other].bus == bus) {
+        perimanSetPinItem(other, ESP32_BUS_TYPE_INIT, NULL, -1, -1);
+      }
+    }
+  }
+  return ok;
+}
+
+uint64_t perimanGetTypePins(peripheral_bus_type_t type) {
+  if (type >= ESP32_BUS_TYPE_MAX) {
+    log_e("Invalid type: %s (%u)", perimanGetTypeName(type), (unsigned int)type);
+    return 0;
+  }
+  return type_pins[type];
+}
+
+uint64_t perimanGetUsedPins(void) {
+  return SOC_GPIO_VALID_GPIO_MASK & ~type_pins[ESP32_BUS_TYPE_INIT];
+}
+
+size_t perimanGetPinsInfo(periman_pin_info_t *info, size_t max) {
+  uint64_t used = perimanGetUsedPins();
+  size_t count = 0;
+  int8_t pin;
+  while (count < max && (pin = perimanNextPin(&used)) >= 0) {
+    info[count].pin = pin;
+    info[count].type = pins[pin].type;
+    info[count].bus_num = pins[pin].bus_num;
+    info[count].bus_channel = pins[pin].bus_channel;
+    info[count].extra_type = pins[pin].extra_type;
+    count++;
+  }
+  return count;
+}
+
 bool perimanSetPinBusExtraType(uint8_t pin, const char *extra_type) {
   if (GPIO_NOT_VALID(pin)) {
     log_e("Invalid pin: %u", pin);
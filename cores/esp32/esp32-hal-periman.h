@@ -177,6 +177,43 @@ bool perimanSetPinBusExtraType(uint8_t pin, const char *extra_type);
 // Returns the extra type of the bus for given pin if set. NULL otherwise
 const char *perimanGetPinBusExtraType(uint8_t pin);
 
+// Pin masks have bit n set for GPIO n
+#define PERIMAN_PIN_MASK(p) (1ULL << (p))
+
+// Returns the mask of the pins attached as the given type, the free pins for ESP32_BUS_TYPE_INIT. 0 for an invalid type
+uint64_t perimanGetTypePins(peripheral_bus_type_t type);
+
+// Returns the mask of the pins attached to any bus
+uint64_t perimanGetUsedPins(void);
+
+// Removes the lowest pin from a pin mask and returns it. -1 when the mask is empty
+static inline int8_t perimanNextPin(uint64_t *mask) {
+  if (*mask == 0) {
+    return -1;
+  }
+  int8_t pin = (int8_t)__builtin_ctzll(*mask);
+  *mask &= *mask - 1;
+  return pin;
+}
+
+// Detaches all the pins in the mask. The deinit callback runs once for the pins sharing a bus.
+// Returns false if a deinit callback was missing or failed, those pins stay attached
+bool perimanClearPins(uint64_t mask);
+
+// Detaches all the pins attached as the given type
+#define perimanClearBusType(t) perimanClearPins(perimanGetTypePins(t))
+
+typedef struct {
+  uint8_t pin;
+  uint8_t type;  // peripheral_bus_type_t
+  int8_t bus_num;
+  int8_t bus_channel;
+  const char *extra_type;
+} periman_pin_info_t;
+
+// Fills info with the pins attached to a bus, in pin order. Returns the number of entries written, at most max
+size_t perimanGetPinsInfo(periman_pin_info_t *info, size_t max);
+
 #ifdef __cplusplus
 }
 #endif
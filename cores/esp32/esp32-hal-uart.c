@@ -17,6 +17,7 @@
 #if SOC_UART_SUPPORTED
 #include "esp32-hal.h"
 #include "esp32-hal-periman.h"
+#include "esp32-hal-format.h"
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/semphr.h"
@@ -1736,20 +1737,26 @@ int uartGetDebug() {
   return s_uart_debug_nr;
 }
 
-int log_printfv(const char *format, va_list arg) {
-  static char loc_buf[64];
-  char *temp = loc_buf;
-  uint32_t len;
-  va_list copy;
-  va_copy(copy, arg);
-  len = vsnprintf(NULL, 0, format, copy);
-  va_end(copy);
-  if (len >= sizeof(loc_buf)) {
-    temp = (char *)malloc(len + 1);
-    if (temp == NULL) {
-      return 0;
+static void log_format_sink(void *ctx, const char *data, size_t len) {
+  (void)ctx;
+  (void)len;
+  ets_printf("%s", data);
+}
+
+static int log_level_printfv(uint8_t level, const char *format, va_list arg) {
+  if (log_binary_writev(level, format, arg)) {
+    // recorded unformatted, the length of the text is not known
+    return 0;
+  }
+  if (log_async_enabled()) {
+    // queued records are written out by the async log task, no need to wait for the UART
+    int len = log_async_vprintf(format, arg);
+    if (len >= 0) {
+      return len;
     }
   }
+  // formatted in a single pass and printed in chunks, no heap and no shared buffer
+  char buf[64];
   /*
 // This causes dead locks with logging in specific cases and also with C++ constructors that may send logs
 #if !CONFIG_DISABLE_HAL_LOCKS
@@ -1758,8 +1765,7 @@ int log_printfv(const char *format, va_list arg) {
     }
 #endif
 */
-  vsnprintf(temp, len + 1, format, arg);
-  ets_printf("%s", temp);
+  int len = format_vprintf(buf, sizeof(buf), log_format_sink, NULL, format, arg);
   /*
 // This causes dead locks with logging and also with constructors that may send logs
 #if !CONFIG_DISABLE_HAL_LOCKS
@@ -1768,9 +1774,6 @@ int log_printfv(const char *format, va_list arg) {
     }
 #endif
 */
-  if (len >= sizeof(loc_buf)) {
-    free(temp);
-  }
   // flushes TX - make sure that the log message is completely sent.
   if (s_uart_debug_nr != -1) {
     while (!uart_ll_is_tx_idle(UART_LL_GET_HW(s_uart_debug_nr)));
@@ -1778,6 +1781,35 @@ int log_printfv(const char *format, va_list arg) {
   return len;
 }
 
+int log_printfv(const char *format, va_list arg) {
+  return log_level_printfv(ARDUHAL_LOG_LEVEL_NONE, format, arg);
+}
+
+void log_write(const char *data, size_t len) {
+  char chunk[65];
+  while (len) {
+    if (*data == '\0') {
+      // ets_printf("%s") would stop here
+      ets_printf("%c", 0);
+      data++;
+      len--;
+      continue;
+    }
+    size_t n = 0;
+    while (n < len && n < sizeof(chunk) - 1 && data[n] != '\0') {
+      chunk[n] = data[n];
+      n++;
+    }
+    chunk[n] = '\0';
+    ets_printf("%s", chunk);
+    data += n;
+    len -= n;
+  }
+  if (s_uart_debug_nr != -1) {
+    while (!uart_ll_is_tx_idle(UART_LL_GET_HW(s_uart_debug_nr)));
+  }
+}
+
 int log_printf(const char *format, ...) {
   int len;
   va_list arg;
@@ -1787,6 +1819,15 @@ int log_printf(const char *format, ...) {
   return len;
 }
 
+int log_level_printf(uint8_t level, const char *format, ...) {
+  int len;
+  va_list arg;
+  va_start(arg, format);
+  len = log_level_printfv(level, format, arg);
+  va_end(arg);
+  return len;
+}
+
 static void log_print_buf_line(const uint8_t *b, size_t len, size_t total_len) {
   for (size_t i = 0; i < len; i++) {
     log_printf("%s0x%02x,", i ? " " : "", b[i]);
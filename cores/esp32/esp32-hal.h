@@ -113,6 +113,7 @@ void yield(void);
 #include "esp32-hal-matrix.h"
 #include "esp32-hal-uart.h"
 #include "esp32-hal-gpio.h"
+#include "esp32-hal-gpio-events.h"
 #include "esp32-hal-ldo.h"
 #include "esp32-hal-touch.h"
 #include "esp32-hal-touch-ng.h"
@@ -164,6 +165,10 @@ BaseType_t xTaskCreateUniversal(
   TaskHandle_t *const pxCreatedTask, const BaseType_t xCoreID
 );
 
+//registers the eventfd VFS with CONFIG_ARDUINO_EVENTFD_MAX_FDS descriptors, once
+//for all its users; it stays registered, so eventfds in use are never pulled away
+esp_err_t arduino_eventfd_register(void);
+
 unsigned long micros();
 unsigned long millis();
 void delay(uint32_t);
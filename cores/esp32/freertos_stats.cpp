@@ -15,6 +15,10 @@
 #include "freertos_stats.h"
 #include "sdkconfig.h"
 
+#include <algorithm>
+#include "esp_timer.h"
+#include "esp32-hal-log.h"
+
 #if CONFIG_FREERTOS_USE_TRACE_FACILITY
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
@@ -110,3 +114,442 @@ void printRunningTasks(Print &printer) {
   printer.println("FreeRTOS trace facility is not enabled.");
 #endif /* CONFIG_FREERTOS_USE_TRACE_FACILITY */
 }
+
+// TaskLoadSampler
+
+#ifndef CONFIG_ARDUINO_TASK_STATS_STACK_SIZE
+#define CONFIG_ARDUINO_TASK_STATS_STACK_SIZE 2560
+#endif
+
+#ifndef CONFIG_ARDUINO_TASK_STATS_PRIORITY
+#define CONFIG_ARDUINO_TASK_STATS_PRIORITY 1
+#endif
+
+// Room in the status array for tasks created after begin(), they are not tracked
+#define TASK_STATS_SPARE 8
+
+#define TASK_STATS_BINARY_VERSION 2
+
+#define TASK_STATS_MAX_COST_SHARE 100
+
+struct TaskLoadSampler::Slot {
+  uint32_t number;
+  char name[TASK_STATS_NAME_SIZE];
+  uint64_t lastRunTime;
+  uint32_t first;  // first sample with a load for the task
+  uint32_t stackFree;
+  int16_t core;
+  uint8_t priority;
+  bool used;
+  bool seen;
+};
+
+TaskLoadSampler::TaskLoadSampler()
+  : _source(schedulerSource), _sourceArg(nullptr), _period(0), _depth(0), _maxTasks(0), _memory(nullptr), _slots(nullptr), _loads(nullptr),
+    _scratch(nullptr), _raw(nullptr), _status(nullptr), _taken(0), _started(false), _lastTotal(0), _cost(), _lock(nullptr), _task(nullptr),
+    _running(false) {}
+
+TaskLoadSampler::~TaskLoadSampler() {
+  end();
+}
+
+void TaskLoadSampler::setSource(task_stats_source_t source, void *arg) {
+  if (_memory != nullptr) {
+    log_e("The source is set before begin()");
+    return;
+  }
+  _source = (source != nullptr) ? source : schedulerSource;
+  _sourceArg = (source != nullptr) ? arg : nullptr;
+}
+
+size_t TaskLoadSampler::schedulerSource(task_stats_raw_t *tasks, size_t max, uint64_t *totalRunTime, void *arg) {
+#if CONFIG_FREERTOS_USE_TRACE_FACILITY && CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+  TaskLoadSampler *sampler = (TaskLoadSampler *)arg;
+  TaskStatus_t *status = (TaskStatus_t *)sampler->_status;
+  configRUN_TIME_COUNTER_TYPE total = 0;
+  // 0 when there are more tasks than the array holds
+  UBaseType_t count = uxTaskGetSystemState(status, sampler->_maxTasks + TASK_STATS_SPARE, &total);
+  if (count > max) {
+    count = max;
+  }
+  for (UBaseType_t i = 0; i < count; i++) {
+    tasks[i].number = status[i].xTaskNumber;
+    strncpy(tasks[i].name, status[i].pcTaskName, TASK_STATS_NAME_SIZE - 1);
+    tasks[i].name[TASK_STATS_NAME_SIZE - 1] = '\0';
+    tasks[i].runTime = status[i].ulRunTimeCounter;
+    tasks[i].stackFree = status[i].usStackHighWaterMark;
+#if CONFIG_FREERTOS_VTASKLIST_INCLUDE_COREID
+    tasks[i].core = (status[i].xCoreID == tskNO_AFFINITY) ? -1 : (int16_t)status[i].xCoreID;
+#else
+    tasks[i].core = -1;
+#endif
+    tasks[i].priority = (uint8_t)status[i].uxCurrentPriority;
+  }
+  *totalRunTime = total;
+  return count;
+#else
+  (void)tasks;
+  (void)max;
+  (void)totalRunTime;
+  (void)arg;
+  return 0;
+#endif
+}
+
+bool TaskLoadSampler::begin(uint32_t periodMs, uint16_t depth, uint16_t maxTasks) {
+  if (_memory != nullptr) {
+    return true;
+  }
+  if (depth < 2 || maxTasks == 0) {
+    log_e("Invalid depth %u or task count %u", depth, maxTasks);
+    return false;
+  }
+#if !(CONFIG_FREERTOS_USE_TRACE_FACILITY && CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS)
+  if (_source == schedulerSource) {
+    log_e("FreeRTOS run time stats are not enabled.");
+    return false;
+  }
+#endif
+
+  size_t slotsSize = (sizeof(Slot) * maxTasks + 7) & ~(size_t)7;
+  size_t rawSize = (sizeof(task_stats_raw_t) * maxTasks + 7) & ~(size_t)7;
+  size_t loadsSize = (sizeof(uint16_t) * ((size_t)maxTasks + 1) * depth + 7) & ~(size_t)7;
+  size_t statusSize = 0;
+#if CONFIG_FREERTOS_USE_TRACE_FACILITY && CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+  if (_source == schedulerSource) {
+    statusSize = sizeof(TaskStatus_t) * (maxTasks + TASK_STATS_SPARE);
+  }
+#endif
+  _memory = (uint8_t *)calloc(1, slotsSize + rawSize + loadsSize + statusSize);
+  _lock = xSemaphoreCreateMutex();
+  if (_memory == nullptr || _lock == nullptr) {
+    log_e("Not enough memory for %u tasks of %u samples", maxTasks, depth);
+    end();
+    return false;
+  }
+  _slots = (Slot *)_memory;
+  _raw = (task_stats_raw_t *)(_memory + slotsSize);
+  _loads = (uint16_t *)(_memory + slotsSize + rawSize);
+  _scratch = _loads + (size_t)maxTasks * depth;
+  _status = statusSize ? (void *)(_memory + slotsSize + rawSize + loadsSize) : nullptr;
+  if (_source == schedulerSource) {
+    _sourceArg = this;
+  }
+  _depth = depth;
+  _maxTasks = maxTasks;
+  _period = periodMs;
+  _taken = 0;
+  _started = false;
+  _lastTotal = 0;
+  _cost = task_stats_cost_t();
+
+  if (periodMs > 0) {
+    _running = true;
+    if (xTaskCreateUniversal(samplerTask, "task_stats", CONFIG_ARDUINO_TASK_STATS_STACK_SIZE, this, CONFIG_ARDUINO_TASK_STATS_PRIORITY, &_task, -1)
+        != pdPASS) {
+      _running = false;
+      _task = nullptr;
+      end();
+      return false;
+    }
+  }
+  return true;
+}
+
+void TaskLoadSampler::end() {
+  if (_task != nullptr) {
+    _running = false;
+    xTaskNotifyGive(_task);
+    while (_task != nullptr) {
+      vTaskDelay(1);
+    }
+  }
+  if (_lock != nullptr) {
+    vSemaphoreDelete(_lock);
+    _lock = nullptr;
+  }
+  free(_memory);
+  _memory = nullptr;
+  _slots = nullptr;
+  _loads = nullptr;
+  _scratch = nullptr;
+  _raw = nullptr;
+  _status = nullptr;
+  _depth = 0;
+  _maxTasks = 0;
+}
+
+void TaskLoadSampler::samplerTask(void *arg) {
+  TaskLoadSampler *sampler = (TaskLoadSampler *)arg;
+  TickType_t ticks = pdMS_TO_TICKS(sampler->_period);
+  if (ticks == 0) {
+    ticks = 1;
+  }
+  while (sampler->_running) {
+    sampler->sample();
+    // the sampling takes no more than 1/TASK_STATS_MAX_COST_SHARE of a core,
+    // the period stretches when a sample costs more (the loads stay exact)
+    TickType_t wait = ticks;
+    TickType_t bound = pdMS_TO_TICKS((uint64_t)sampler->_cost.lastUs * TASK_STATS_MAX_COST_SHARE / 1000);
+    if (bound > wait) {
+      wait = bound;
+    }
+    ulTaskNotifyTake(pdTRUE, wait);
+  }
+  sampler->_task = nullptr;
+  vTaskDelete(NULL);
+}
+
+bool TaskLoadSampler::sample() {
+  if (_memory == nullptr) {
+    return false;
+  }
+  int64_t start = esp_timer_get_time();
+  uint64_t total = 0;
+  size_t count = _source(_raw, _maxTasks, &total, _sourceArg);
+  if (count == 0) {
+    return false;
+  }
+
+  xSemaphoreTake(_lock, portMAX_DELAY);
+  uint64_t elapsed = total - _lastTotal;
+  bool record = _started && elapsed > 0;
+  uint32_t index = _taken % _depth;
+  for (uint16_t s = 0; s < _maxTasks; s++) {
+    _slots[s].seen = false;
+  }
+  for (size_t i = 0; i < count; i++) {
+    const task_stats_raw_t &task = _raw[i];
+    Slot *slot = nullptr;
+    Slot *empty = nullptr;
+    for (uint16_t s = 0; s < _maxTasks; s++) {
+      if (_slots[s].used && _slots[s].number == task.number) {
+        slot = &_slots[s];
+        break;
+      }
+      if (!_slots[s].used && empty == nullptr) {
+        empty = &_slots[s];
+      }
+    }
+    if (slot == nullptr) {
+      if (empty == nullptr) {
+        continue;  // more tasks than maxTasks
+      }
+      // a new task, its load starts with the next sample
+      slot = empty;
+      slot->used = true;
+      slot->number = task.number;
+      slot->first = record ? _taken + 1 : _taken;
+    } else if (record) {
+      uint64_t ran = task.runTime - slot->lastRunTime;
+      uint64_t load = ran * 10000 / elapsed;
+      _loads[(size_t)(slot - _slots) * _depth + index] = (uint16_t)std::min<uint64_t>(load, 10000);
+    }
+    memcpy(slot->name, task.name, TASK_STATS_NAME_SIZE);
+    slot->lastRunTime = task.runTime;
+    slot->stackFree = task.stackFree;
+    slot->core = task.core;
+    slot->priority = task.priority;
+    slot->seen = true;
+  }
+  // the tasks that are gone free their slot
+  for (uint16_t s = 0; s < _maxTasks; s++) {
+    if (!_slots[s].seen) {
+      _slots[s].used = false;
+    }
+  }
+  if (record) {
+    _taken++;
+  }
+  _started = true;
+  _lastTotal = total;
+
+  uint32_t us = (uint32_t)(esp_timer_get_time() - start);
+  _cost.samples++;
+  _cost.lastUs = us;
+  _cost.maxUs = std::max(_cost.maxUs, us);
+  _cost.totalUs += us;
+  xSemaphoreGive(_lock);
+  return true;
+}
+
+// Called with the lock held
+bool TaskLoadSampler::fill(const Slot &slot, task_load_t &out, uint16_t window) {
+  uint32_t kept = std::min<uint32_t>(_taken - slot.first, _depth);
+  uint32_t n = (window == 0) ? kept : std::min<uint32_t>(window, kept);
+  out.number = slot.number;
+  memcpy(out.name, slot.name, TASK_STATS_NAME_SIZE);
+  out.core = slot.core;
+  out.priority = slot.priority;
+  out.stackFree = slot.stackFree;
+  out.samples = (uint16_t)n;
+  out.average = out.p50 = out.p90 = out.p99 = out.max = 0;
+  if (n == 0) {
+    return true;
+  }
+  const uint16_t *loads = _loads + (size_t)(&slot - _slots) * _depth;
+  uint32_t sum = 0;
+  for (uint32_t i = 0; i < n; i++) {
+    uint16_t load = loads[(_taken - 1 - i) % _depth];
+    _scratch[i] = load;
+    sum += load;
+  }
+  std::sort(_scratch, _scratch + n);
+  // nearest rank
+  auto percentile = [&](uint32_t p) {
+    uint32_t rank = (p * n + 99) / 100;
+    return _scratch[rank > 0 ? rank - 1 : 0] / 100.0f;
+  };
+  out.average = (float)sum / n / 100.0f;
+  out.p50 = percentile(50);
+  out.p90 = percentile(90);
+  out.p99 = percentile(99);
+  out.max = _scratch[n - 1] / 100.0f;
+  return true;
+}
+
+size_t TaskLoadSampler::query(task_load_t *out, size_t max, uint16_t window) {
+  if (_memory == nullptr) {
+    return 0;
+  }
+  size_t count = 0;
+  xSemaphoreTake(_lock, portMAX_DELAY);
+  for (uint16_t s = 0; s < _maxTasks && count < max; s++) {
+    if (_slots[s].used) {
+      fill(_slots[s], out[count++], window);
+    }
+  }
+  xSemaphoreGive(_lock);
+  return count;
+}
+
+bool TaskLoadSampler::query(uint32_t number, task_load_t &out, uint16_t window) {
+  if (_memory == nullptr) {
+    return false;
+  }
+  bool found = false;
+  xSemaphoreTake(_lock, portMAX_DELAY);
+  for (uint16_t s = 0; s < _maxTasks; s++) {
+    if (_slots[s].used && _slots[s].number == number) {
+      found = fill(_slots[s], out, window);
+      break;
+    }
+  }
+  xSemaphoreGive(_lock);
+  return found;
+}
+
+task_stats_cost_t TaskLoadSampler::cost() {
+  if (_lock == nullptr) {
+    return _cost;
+  }
+  xSemaphoreTake(_lock, portMAX_DELAY);
+  task_stats_cost_t cost = _cost;
+  xSemaphoreGive(_lock);
+  return cost;
+}
+
+// Escapes what a task name may hold that JSON does not allow in a string
+static size_t printJSONString(Print &out, const char *s) {
+  size_t n = out.write('"');
+  for (; *s; s++) {
+    if (*s == '"' || *s == '\\') {
+      n += out.write('\\');
+      n += out.write(*s);
+    } else if ((uint8_t)*s < 0x20) {
+      n += out.printf("\\u%04x", (uint8_t)*s);
+    } else {
+      n += out.write(*s);
+    }
+  }
+  return n + out.write('"');
+}
+
+size_t TaskLoadSampler::printJSON(Print &out, uint16_t window) {
+  task_stats_cost_t taken = cost();
+  size_t n = out.printf("{\"period\":%" PRIu32 ",\"depth\":%u,\"samples\":%" PRIu32 ",\"tasks\":[", _period, _depth, taken.samples);
+  bool first = true;
+  // one task at a time, the lock is not held while printing
+  for (uint16_t s = 0; s < _maxTasks; s++) {
+    task_load_t load;
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    bool used = _slots[s].used && fill(_slots[s], load, window);
+    xSemaphoreGive(_lock);
+    if (!used) {
+      continue;
+    }
+    n += out.printf("%s{\"number\":%" PRIu32 ",\"name\":", first ? "" : ",", load.number);
+    n += printJSONString(out, load.name);
+    n += out.printf(
+      ",\"core\":%d,\"priority\":%u,\"samples\":%u,\"average\":%.2f,\"p50\":%.2f,\"p90\":%.2f,\"p99\":%.2f,\"max\":%.2f,\"stackFree\":%" PRIu32 "}",
+      load.core, load.priority, load.samples, load.average, load.p50, load.p90, load.p99, load.max, load.stackFree
+    );
+    first = false;
+  }
+  return n + out.print("]}");
+}
+
+static uint8_t *put16(uint8_t *p, uint16_t v) {
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+  return p + 2;
+}
+
+static uint8_t *put32(uint8_t *p, uint32_t v) {
+  p = put16(p, (uint16_t)v);
+  return put16(p, (uint16_t)(v >> 16));
+}
+
+static uint16_t hundredths(float percent) {
+  return (uint16_t)(percent * 100.0f + 0.5f);
+}
+
+size_t TaskLoadSampler::writeBinary(Print &out, uint16_t window) {
+  if (_memory == nullptr) {
+    return 0;
+  }
+  uint16_t count = 0;
+  xSemaphoreTake(_lock, portMAX_DELAY);
+  for (uint16_t s = 0; s < _maxTasks; s++) {
+    count += _slots[s].used ? 1 : 0;
+  }
+  xSemaphoreGive(_lock);
+
+  uint8_t record[38];
+  uint8_t *p = record;
+  *p++ = 'T';
+  *p++ = 'L';
+  *p++ = TASK_STATS_BINARY_VERSION;
+  p = put16(p, count);
+  p = put16(p, window);
+  size_t n = out.write(record, p - record);
+  // exactly count records, a task that ended meanwhile is written empty
+  for (uint16_t s = 0; s < _maxTasks && count > 0; s++) {
+    task_load_t load;
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    bool used = _slots[s].used && fill(_slots[s], load, window);
+    xSemaphoreGive(_lock);
+    if (!used) {
+      continue;
+    }
+    p = put32(record, load.number);
+    memcpy(p, load.name, TASK_STATS_NAME_SIZE);
+    p += TASK_STATS_NAME_SIZE;
+    *p++ = (uint8_t)(int8_t)load.core;
+    *p++ = load.priority;
+    p = put16(p, load.samples);
+    p = put16(p, hundredths(load.average));
+    p = put16(p, hundredths(load.p50));
+    p = put16(p, hundredths(load.p90));
+    p = put16(p, hundredths(load.p99));
+    p = put16(p, hundredths(load.max));
+    p = put32(p, load.stackFree);
+    n += out.write(record, p - record);
+    count--;
+  }
+  while (count-- > 0) {
+    memset(record, 0, sizeof(record));
+    n += out.write(record, sizeof(record));
+  }
+  return n;
+}
@@ -17,6 +17,9 @@
 #ifdef __cplusplus
 
 #include "Print.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
 
 /*
  * Executing this function will cause interrupts and
@@ -25,4 +28,122 @@
  */
 void printRunningTasks(Print &printer);
 
+/*
+ * Background CPU load sampler.
+ *
+ * Every period a low priority task reads the run time counter of each task
+ * (uxTaskGetSystemState(), which needs CONFIG_FREERTOS_USE_TRACE_FACILITY and
+ * CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS) and keeps the load of each task
+ * over the period in a ring of the last `depth` samples. query() gives the
+ * average, percentiles and maximum of the load over a window of the most
+ * recent samples, with the task's stack high water mark, priority and core.
+ *
+ * All the memory is allocated by begin(), sampling and queries allocate
+ * nothing. cost() reports what the sampling takes; the background task
+ * stretches its period if needed to keep that under 1% of a core. A load is
+ * the share of one core the task used, in percent: the loads of all the
+ * tasks add up to 100 times the number of cores.
+ */
+
+#define TASK_STATS_NAME_SIZE 16
+
+// One task as read from the scheduler
+typedef struct {
+  uint32_t number;                  // FreeRTOS task number
+  char name[TASK_STATS_NAME_SIZE];  // task name, truncated
+  uint64_t runTime;                 // run time counter, same unit as the total
+  uint32_t stackFree;               // stack high water mark
+  int16_t core;                     // core the task is pinned to, -1 for any
+  uint8_t priority;                 // current priority
+} task_stats_raw_t;
+
+// Reads up to max tasks and the total run time, returns the number of tasks
+typedef size_t (*task_stats_source_t)(task_stats_raw_t *tasks, size_t max, uint64_t *totalRunTime, void *arg);
+
+// Load of one task over a window of samples, in percent of one core
+typedef struct {
+  uint32_t number;
+  char name[TASK_STATS_NAME_SIZE];
+  int16_t core;
+  uint8_t priority;
+  uint16_t samples;  // samples in the window, fewer for a task that just started
+  float average;
+  float p50;
+  float p90;
+  float p99;
+  float max;
+  uint32_t stackFree;
+} task_load_t;
+
+// What the sampling itself costs, measured around each sample
+typedef struct {
+  uint32_t samples;  // samples taken
+  uint32_t lastUs;   // duration of the last one
+  uint32_t maxUs;    // longest one
+  uint64_t totalUs;  // all of them
+} task_stats_cost_t;
+
+class TaskLoadSampler {
+public:
+  TaskLoadSampler();
+  ~TaskLoadSampler();
+
+  // Replaces the scheduler as the source of the samples, before begin()
+  void setSource(task_stats_source_t source, void *arg = nullptr);
+
+  // Allocates a ring of depth samples for up to maxTasks tasks and, with a
+  // period, starts taking a sample every periodMs. With a period of 0 the
+  // samples are taken by calling sample().
+  bool begin(uint32_t periodMs = 1000, uint16_t depth = 60, uint16_t maxTasks = 24);
+  void end();
+
+  // Takes a sample now; the first one only sets the starting counters
+  bool sample();
+
+  // Loads over the last window samples (0 for all those kept) of up to max
+  // tasks, returns how many were written to out
+  size_t query(task_load_t *out, size_t max, uint16_t window = 0);
+  // Load of one task by its FreeRTOS task number
+  bool query(uint32_t number, task_load_t &out, uint16_t window = 0);
+
+  // The query() results as a JSON object, or in the compact binary format:
+  // "TL", version 2, the task count and the window (uint16_t), then per task
+  // number (uint32_t), name (16 bytes, zero padded), core (int8_t), priority
+  // (uint8_t), samples (uint16_t), average, p50, p90, p99 and max (uint16_t,
+  // hundredths of a percent) and stackFree (uint32_t), all little endian
+  size_t printJSON(Print &out, uint16_t window = 0);
+  size_t writeBinary(Print &out, uint16_t window = 0);
+
+  task_stats_cost_t cost();
+  uint16_t depth() const {
+    return _depth;
+  }
+
+private:
+  struct Slot;
+
+  task_stats_source_t _source;
+  void *_sourceArg;
+  uint32_t _period;
+  uint16_t _depth;
+  uint16_t _maxTasks;
+  uint8_t *_memory;  // all the buffers below, one allocation
+  Slot *_slots;
+  uint16_t *_loads;        // _depth hundredths of a percent per slot
+  uint16_t *_scratch;      // _depth values sorted for the percentiles
+  task_stats_raw_t *_raw;  // _maxTasks tasks read by the source
+  void *_status;           // TaskStatus_t array of the default source
+  uint32_t _taken;         // samples with loads, the next one goes to _taken % _depth
+  bool _started;           // the starting counters are set
+  uint64_t _lastTotal;
+  task_stats_cost_t _cost;
+  SemaphoreHandle_t _lock;
+  TaskHandle_t _task;
+  volatile bool _running;
+
+  static void samplerTask(void *arg);
+  static size_t schedulerSource(task_stats_raw_t *tasks, size_t max, uint64_t *totalRunTime, void *arg);
+  bool fill(const Slot &slot, task_load_t &out, uint16_t window);
+};
+
 #endif
@@ -46,6 +46,10 @@ int8_t gpioNumberToDigitalPin(int8_t gpioNumber);
 #define digitalWrite(pin, val)                  digitalWrite(digitalPinToGPIONumber(pin), val)
 #define pinMode(pin, mode)                      pinMode(digitalPinToGPIONumber(pin), mode)
 
+// cores/esp32/esp32-hal-gpio-events.h
+#define gpio_edge_attach(pin, mode, glitch_us, debounce_us) gpio_edge_attach(digitalPinToGPIONumber(pin), mode, glitch_us, debounce_us)
+#define gpio_edge_detach(pin)                               gpio_edge_detach(digitalPinToGPIONumber(pin))
+
 // cores/esp32/esp32-hal-i2c.h
 #define i2cInit(i2c_num, sda, scl, clk_speed) i2cInit(i2c_num, digitalPinToGPIONumber(sda), digitalPinToGPIONumber(scl), clk_speed)
 
@@ -38,6 +38,13 @@ void yieldIfNecessary(void) {
 
 bool loopTaskWDTEnabled;
 
+// the event loop wakes up in time to feed the loop task watchdog
+#ifdef CONFIG_ESP_TASK_WDT_TIMEOUT_S
+#define LOOP_TASK_WDT_IDLE_MS (CONFIG_ESP_TASK_WDT_TIMEOUT_S * 500)
+#else
+#define LOOP_TASK_WDT_IDLE_MS 1000
+#endif
+
 __attribute__((weak)) size_t getArduinoLoopTaskStackSize(void) {
   return ARDUINO_LOOP_STACK_SIZE;
 }
@@ -89,6 +96,12 @@ void loopTask(void *pvParameters) {
     if (serialEventRun) {
       serialEventRun();
     }
+#if !defined(NO_GLOBAL_INSTANCES) && !defined(NO_GLOBAL_EVENTLOOP)
+    // opted in with LoopEvents.begin(): sleep until there is work for loop()
+    if (LoopEvents.running()) {
+      LoopEvents.runOnce(loopTaskWDTEnabled ? LOOP_TASK_WDT_IDLE_MS : EVENT_LOOP_FOREVER);
+    }
+#endif
   }
 }
 
@@ -28,20 +28,9 @@
 #include <stdint.h>
 #include <math.h>
 #include "stdlib_noniso.h"
+#include "esp32-hal-format.h"
 #include "esp_system.h"
 
-static void reverse(char *begin, char *end) {
-  char *is = begin;
-  char *ie = end - 1;
-  while (is < ie) {
-    char tmp = *ie;
-    *ie = *is;
-    *is = tmp;
-    ++is;
-    --ie;
-  }
-}
-
 char *ltoa(long value, char *result, int base) {
   if (base < 2 || base > 16) {
     *result = 0;
@@ -49,22 +38,10 @@ char *ltoa(long value, char *result, int base) {
   }
 
   char *out = result;
-  long quotient = labs(value);
-
-  do {
-    const long tmp = quotient / base;
-    *out = "0123456789abcdef"[quotient - (tmp * base)];
-    ++out;
-    quotient = tmp;
-  } while (quotient);
-
-  // Apply negative sign
   if (value < 0) {
     *out++ = '-';
   }
-
-  reverse(result, out);
-  *out = 0;
+  format_radix((value < 0) ? 0UL - (unsigned long)value : (unsigned long)value, base, false, out);
   return result;
 }
 
@@ -75,22 +52,10 @@ char *lltoa(long long val, char *result, int base) {
   }
 
   char *out = result;
-  long long quotient = val > 0 ? val : -val;
-
-  do {
-    const long long tmp = quotient / base;
-    *out = "0123456789abcdef"[quotient - (tmp * base)];
-    ++out;
-    quotient = tmp;
-  } while (quotient);
-
-  // Apply negative sign
   if (val < 0) {
     *out++ = '-';
   }
-
-  reverse(result, out);
-  *out = 0;
+  format_radix((val < 0) ? 0ULL - (unsigned long long)val : (unsigned long long)val, base, false, out);
   return result;
 }
 
@@ -100,18 +65,7 @@ char *ultoa(unsigned long value, char *result, int base) {
     return result;
   }
 
-  char *out = result;
-  unsigned long quotient = value;
-
-  do {
-    const unsigned long tmp = quotient / base;
-    *out = "0123456789abcdef"[quotient - (tmp * base)];
-    ++out;
-    quotient = tmp;
-  } while (quotient);
-
-  reverse(result, out);
-  *out = 0;
+  format_radix(value, base, false, result);
   return result;
 }
 
@@ -121,24 +75,11 @@ char *ulltoa(unsigned long long val, char *result, int base) {
     return result;
   }
 
-  char *out = result;
-  unsigned long long quotient = val;
-
-  do {
-    const unsigned long long tmp = quotient / base;
-    *out = "0123456789abcdef"[quotient - (tmp * base)];
-    ++out;
-    quotient = tmp;
-  } while (quotient);
-
-  reverse(result, out);
-  *out = 0;
+  format_radix(val, base, false, result);
   return result;
 }
 
 char *dtostrf(double number, signed int width, unsigned int prec, char *s) {
-  bool negative = false;
-
   if (isnan(number)) {
     memcpy(s, "nan", sizeof("nan"));
     return s;
@@ -148,68 +89,13 @@ char *dtostrf(double number, signed int width, unsigned int prec, char *s) {
     return s;
   }
 
-  char *out = s;
-
-  int fillme = width;  // how many cells to fill for the integer part
-  if (prec > 0) {
-    fillme -= (prec + 1);
-  }
-
-  // Handle negative numbers
-  if (number < 0.0) {
-    negative = true;
-    fillme--;
-    number = -number;
-  }
-
-  // Round correctly so that print(1.999, 2) prints as "2.00"
-  // I optimized out most of the divisions
-  double rounding = 2.0;
-  for (unsigned int i = 0; i < prec; ++i) {
-    rounding *= 10.0;
-  }
-  rounding = 1.0 / rounding;
-
-  number += rounding;
-
-  // Figure out how big our number really is
-  double tenpow = 1.0;
-  unsigned int digitcount = 1;
-  while (number >= 10.0 * tenpow) {
-    tenpow *= 10.0;
-    digitcount++;
-  }
-
-  number /= tenpow;
-  fillme -= digitcount;
+  // `s` is assumed to hold any double with `prec` decimals: up to 309 integer digits, sign, point and NUL
+  size_t len = format_fixed(number, prec, s, prec + 312);
 
   // Pad unused cells with spaces
-  while (fillme-- > 0) {
-    *out++ = ' ';
-  }
-
-  // Handle negative sign
-  if (negative) {
-    *out++ = '-';
-  }
-
-  // Print the digits, and if necessary, the decimal point
-  digitcount += prec;
-  int8_t digit = 0;
-  while (digitcount-- > 0) {
-    digit = (int8_t)number;
-    if (digit > 9) {
-      digit = 9;  // insurance
-    }
-    *out++ = (char)('0' | digit);
-    if ((digitcount == prec) && (prec > 0)) {
-      *out++ = '.';
-    }
-    number -= digit;
-    number *= 10.0;
+  if (width > 0 && len < (size_t)width) {
+    memmove(s + width - len, s, len + 1);
+    memset(s, ' ', width - len);
   }
-
-  // make sure the string is terminated
-  *out = 0;
   return s;
 }
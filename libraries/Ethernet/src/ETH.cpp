@@ -1057,12 +1057,8 @@ void ETHClass::end(void) {
     perimanClearPinBus(_pin_mcd);
     perimanClearPinBus(_pin_mdio);
 
-    perimanClearPinBus(ETH_RMII_TX_EN);
-    perimanClearPinBus(ETH_RMII_TX0);
-    perimanClearPinBus(ETH_RMII_TX1);
-    perimanClearPinBus(ETH_RMII_RX0);
-    perimanClearPinBus(ETH_RMII_RX1_EN);
-    perimanClearPinBus(ETH_RMII_CRS_DV);
+    // the fixed RMII data pins, only the EMAC uses that type
+    perimanClearBusType(ESP32_BUS_TYPE_ETHERNET_RMII);
 
     _pin_rmii_clock = -1;
     _pin_mcd = -1;
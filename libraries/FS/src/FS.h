@@ -59,6 +59,10 @@ public:
   size_t readBytes(char *buffer, size_t length) {
     return read((uint8_t *)buffer, length);
   }
+  // available() == 0 is the end of the file
+  bool inputCanTimeout() override {
+    return false;
+  }
 
   bool seek(uint32_t pos, SeekMode mode);
   bool seek(uint32_t pos) {
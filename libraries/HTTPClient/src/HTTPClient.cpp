@@ -710,111 +710,24 @@ int HTTPClient::sendRequest(const char *type, Stream *stream, size_t size) {
     return returnError(HTTPC_ERROR_SEND_HEADER_FAILED);
   }
 
-  int buff_size = HTTP_TCP_TX_BUFFER_SIZE;
-
-  int len = size;
-  int bytesWritten = 0;
-
-  if (len == 0) {
-    len = -1;
+  // without a size, everything up to the end of the stream (or until nothing
+  // more arrives for the TCP timeout)
+  size_t bytesWritten;
+  if (size > 0) {
+    bytesWritten = stream->sendSize(*_client, size, _tcpTimeout);
+  } else {
+    bytesWritten = stream->sendAll(*_client, _tcpTimeout);
   }
 
-  // if possible create smaller buffer then HTTP_TCP_TX_BUFFER_SIZE
-  if ((len > 0) && (len < buff_size)) {
-    buff_size = len;
+  if (stream->getLastSendReport() == Stream::SendReport::OutOfMemory) {
+    return returnError(HTTPC_ERROR_TOO_LESS_RAM);
   }
-
-  // create buffer for read
-  uint8_t *buff = (uint8_t *)malloc(buff_size);
-
-  if (buff) {
-    // read all data from stream and send it to server
-    while (connected() && (stream->available() > -1) && (len > 0 || len == -1)) {
-
-      // get available data size
-      int sizeAvailable = stream->available();
-
-      if (sizeAvailable) {
-
-        int readBytes = sizeAvailable;
-
-        // read only the asked bytes
-        if (len > 0 && readBytes > len) {
-          readBytes = len;
-        }
-
-        // not read more the buffer can handle
-        if (readBytes > buff_size) {
-          readBytes = buff_size;
-        }
-
-        // read data
-        int bytesRead = stream->readBytes(buff, readBytes);
-
-        // write it to Stream
-        int bytesWrite = _client->write((const uint8_t *)buff, bytesRead);
-        bytesWritten += bytesWrite;
-
-        // are all Bytes a written to stream ?
-        if (bytesWrite != bytesRead) {
-          log_d("short write, asked for %d but got %d retry...", bytesRead, bytesWrite);
-
-          // check for write error
-          if (_client->getWriteError()) {
-            log_d("stream write error %d", _client->getWriteError());
-
-            //reset write error for retry
-            _client->clearWriteError();
-          }
-
-          // some time for the stream
-          delay(1);
-
-          int leftBytes = (readBytes - bytesWrite);
-
-          // retry to send the missed bytes
-          bytesWrite = _client->write((const uint8_t *)(buff + bytesWrite), leftBytes);
-          bytesWritten += bytesWrite;
-
-          if (bytesWrite != leftBytes) {
-            // failed again
-            log_d("short write, asked for %d but got %d failed.", leftBytes, bytesWrite);
-            free(buff);
-            return returnError(HTTPC_ERROR_SEND_PAYLOAD_FAILED);
-          }
-        }
-
-        // check for write error
-        if (_client->getWriteError()) {
-          log_d("stream write error %d", _client->getWriteError());
-          free(buff);
-          return returnError(HTTPC_ERROR_SEND_PAYLOAD_FAILED);
-        }
-
-        // count bytes to read left
-        if (len > 0) {
-          len -= readBytes;
-        }
-
-        delay(0);
-      } else {
-        delay(1);
-      }
-    }
-
-    free(buff);
-
-    if (size && (int)size != bytesWritten) {
-      log_d("Stream payload bytesWritten %d and size %lu mismatch!.", bytesWritten, (unsigned long)size);
-      log_d("ERROR SEND PAYLOAD FAILED!");
-      return returnError(HTTPC_ERROR_SEND_PAYLOAD_FAILED);
-    } else {
-      log_d("Stream payload written: %d", bytesWritten);
-    }
-
+  if ((size && size != bytesWritten) || stream->getLastSendReport() == Stream::SendReport::WriteError) {
+    log_d("Stream payload bytesWritten %u and size %lu mismatch!.", (unsigned)bytesWritten, (unsigned long)size);
+    log_d("ERROR SEND PAYLOAD FAILED!");
+    return returnError(HTTPC_ERROR_SEND_PAYLOAD_FAILED);
   } else {
-    log_d("too less ram! need %d", buff_size);
-    return returnError(HTTPC_ERROR_TOO_LESS_RAM);
+    log_d("Stream payload written: %u", (unsigned)bytesWritten);
   }
 
   // handle Server Response (Header)
@@ -1301,113 +1214,36 @@ int HTTPClient::handleHeaderResponse() {
  * @return < 0 = error >= 0 = size written
  */
 int HTTPClient::writeToStreamDataBlock(Stream *stream, int size) {
-  int buff_size = HTTP_TCP_RX_BUFFER_SIZE;
-  int len = size;
-  int bytesWritten = 0;
-
-  // if possible create smaller buffer then HTTP_TCP_RX_BUFFER_SIZE
-  if ((len > 0) && (len < buff_size)) {
-    buff_size = len;
-  }
+  size_t bytesWritten = 0;
 
-  // create buffer for read
-  uint8_t *buff = (uint8_t *)malloc(buff_size);
-
-  if (buff) {
-    // read all data from server
-    while (connected() && (len > 0 || len == -1)) {
-
-      // get available data size
-      size_t sizeAvailable = buff_size;
-      if (len < 0) {
-        sizeAvailable = _client->available();
-      }
-
-      if (sizeAvailable) {
-
-        int readBytes = sizeAvailable;
-
-        // read only the asked bytes
-        if (len > 0 && readBytes > len) {
-          readBytes = len;
-        }
-
-        // not read more the buffer can handle
-        if (readBytes > buff_size) {
-          readBytes = buff_size;
-        }
-
-        // stop if no more reading
-        if (readBytes == 0) {
-          break;
-        }
-
-        // read data
-        int bytesRead = _client->readBytes(buff, readBytes);
-
-        // write it to Stream
-        int bytesWrite = stream->write(buff, bytesRead);
-        bytesWritten += bytesWrite;
-
-        // are all Bytes a written to stream ?
-        if (bytesWrite != bytesRead) {
-          log_d("short write asked for %d but got %d retry...", bytesRead, bytesWrite);
-
-          // check for write error
-          if (stream->getWriteError()) {
-            log_d("stream write error %d", stream->getWriteError());
-
-            //reset write error for retry
-            stream->clearWriteError();
-          }
-
-          // some time for the stream
-          delay(1);
-
-          int leftBytes = (bytesRead - bytesWrite);
-
-          // retry to send the missed bytes
-          bytesWrite = stream->write((buff + bytesWrite), leftBytes);
-          bytesWritten += bytesWrite;
-
-          if (bytesWrite != leftBytes) {
-            // failed again
-            log_w("short write asked for %d but got %d failed.", leftBytes, bytesWrite);
-            free(buff);
-            return HTTPC_ERROR_STREAM_WRITE;
-          }
-        }
-
-        // check for write error
-        if (stream->getWriteError()) {
-          log_w("stream write error %d", stream->getWriteError());
-          free(buff);
-          return HTTPC_ERROR_STREAM_WRITE;
-        }
-
-        // count bytes to read left
-        if (len > 0) {
-          len -= bytesRead;
-        }
-
-        delay(0);
-      } else {
-        delay(1);
+  if (size > 0) {
+    bytesWritten = _client->sendSize(*stream, size, _tcpTimeout);
+  } else {
+    // no length known, everything until the server closes the connection
+    while (connected()) {
+      bytesWritten += _client->sendAvailable(*stream);
+      Stream::SendReport report = _client->getLastSendReport();
+      if (report == Stream::SendReport::WriteError || report == Stream::SendReport::OutOfMemory) {
+        break;
       }
+      delay(1);
     }
+  }
 
-    free(buff);
-
-    log_v("connection closed or file end (written: %d).", bytesWritten);
+  if (_client->getLastSendReport() == Stream::SendReport::OutOfMemory) {
+    log_w("too less ram for the transfer buffer");
+    return HTTPC_ERROR_TOO_LESS_RAM;
+  }
+  if (_client->getLastSendReport() == Stream::SendReport::WriteError) {
+    log_w("stream write error %d", stream->getWriteError());
+    return HTTPC_ERROR_STREAM_WRITE;
+  }
 
-    if ((size > 0) && (size != bytesWritten)) {
-      log_d("bytesWritten %d and size %d mismatch!.", bytesWritten, size);
-      return HTTPC_ERROR_STREAM_WRITE;
-    }
+  log_v("connection closed or file end (written: %u).", (unsigned)bytesWritten);
 
-  } else {
-    log_w("too less ram! need %d", buff_size);
-    return HTTPC_ERROR_TOO_LESS_RAM;
+  if ((size > 0) && (size != (int)bytesWritten)) {
+    log_d("bytesWritten %u and size %d mismatch!.", (unsigned)bytesWritten, size);
+    return HTTPC_ERROR_STREAM_WRITE;
   }
 
   return bytesWritten;
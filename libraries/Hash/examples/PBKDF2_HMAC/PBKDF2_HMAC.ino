@@ -9,6 +9,9 @@
   - A password string (default: empty)
   - A salt string (default: empty)
   - The number of iterations (default: 1000)
+
+  calculate() runs all the iterations at once. With many iterations, step(n) runs up to n of them
+  per call and returns true once the key is ready, so the derivation can be spread over loop().
 */
 
 #include <Arduino.h>
@@ -10,6 +10,9 @@
   - SHA3_384Builder(): 384-bit hash output
   - SHA3_512Builder(): 512-bit hash output
   - SHA3Builder(size_t hash_size): Generic class that can be used to create any SHA3 variant implemented
+
+  The SHAKE128Builder and SHAKE256Builder extendable output functions give a digest of the
+  length passed to their constructor, and squeeze() then reads as much more output as needed.
 */
 
 #include <Arduino.h>
@@ -21,6 +24,7 @@ const char *EXPECTED_HELLO_WORLD_SHA3_512 =
   "3d58a719c6866b0214f96b0a67b37e51a91e233ce0be126a08f35fdf4c043c6126f40139bfbc338d44eb2a03de9f7bb8eff0ac260b3629811e389a5fbee8a894";
 const char *EXPECTED_TEST_MESSAGE_SHA3_224 = "27af391bcb3b86f21b73c42c4abbde4791c395dc650243eede85de0c";
 const char *EXPECTED_TEST_MESSAGE_SHA3_384 = "adb18f6b164672c566950bfefa48c5a851d48ee184f249a19e723d753b7536fcd048c3443aff7ebe433fce63c81726ea";
+const char *EXPECTED_TEST_MESSAGE_SHAKE128 = "b641e3902596237265117314039986204f428df01b461e79559482978743ef0d";
 
 // Validation function
 bool validateHash(const String &calculated, const char *expected, const String &test_name) {
@@ -90,6 +94,19 @@ void setup() {
     validateHash(hash_384, EXPECTED_TEST_MESSAGE_SHA3_384, "SHA3_384Builder validation");
   }
 
+  // Example using SHAKE128Builder, a 16 byte digest followed by 16 more bytes of output
+  {
+    String test_data = "Test message";
+    SHAKE128Builder shake128(16);
+    shake128.begin();
+    shake128.add(test_data);
+    shake128.calculate();
+    uint8_t more[16];
+    shake128.squeeze(more, sizeof(more));
+    String output = shake128.toString() + HEXBuilder::bytes2hex(more, sizeof(more));
+    validateHash(output, EXPECTED_TEST_MESSAGE_SHAKE128, "SHAKE128Builder validation");
+  }
+
   Serial.println("Done.");
 }
 
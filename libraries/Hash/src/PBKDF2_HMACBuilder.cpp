@@ -15,9 +15,6 @@
 #include <Arduino.h>
 #include "PBKDF2_HMACBuilder.h"
 
-// Block size for HMAC (64 bytes for SHA-1, SHA-256, SHA-512)
-#define HMAC_BLOCK_SIZE 64
-
 PBKDF2_HMACBuilder::PBKDF2_HMACBuilder(HashBuilder *hash, String password, String salt, uint32_t iterations) {
   this->hashBuilder = hash;
   if (hash) {
@@ -36,6 +33,12 @@ PBKDF2_HMACBuilder::PBKDF2_HMACBuilder(HashBuilder *hash, String password, Strin
   this->derivedKey = nullptr;
   this->derivedKeyLen = 0;
   this->calculated = false;
+  this->keyPads = nullptr;
+  this->hmacStates = nullptr;
+  this->blockSize = 0;
+  this->stateSize = 0;
+  this->blockIndex = 0;
+  this->iteration = 0;
 
   if (password.length() > 0) {
     setPassword(password);
@@ -48,9 +51,17 @@ PBKDF2_HMACBuilder::PBKDF2_HMACBuilder(HashBuilder *hash, String password, Strin
 
 PBKDF2_HMACBuilder::~PBKDF2_HMACBuilder() {
   clearData();
+  if (password != nullptr) {
+    forced_memzero(password, passwordLen);
+    delete[] password;
+  }
+  if (salt != nullptr) {
+    delete[] salt;
+  }
 }
 
 void PBKDF2_HMACBuilder::clearData() {
+  endDerivation();
   if (derivedKey != nullptr) {
     forced_memzero(derivedKey, derivedKeyLen);
     delete[] derivedKey;
@@ -60,50 +71,177 @@ void PBKDF2_HMACBuilder::clearData() {
   calculated = false;
 }
 
-void PBKDF2_HMACBuilder::hmac(const uint8_t *key, size_t keyLen, const uint8_t *data, size_t dataLen, uint8_t *output) {
-  uint8_t keyPad[HMAC_BLOCK_SIZE];
-  uint8_t outerPad[HMAC_BLOCK_SIZE];
-  uint8_t innerHash[64];  // Large enough for any hash
+// Keys the HMAC once for the whole derivation: the password padded to a block
+// and, when the hash can save its state, the state after each padded block,
+// so that every iteration compresses the pads no more
+bool PBKDF2_HMACBuilder::startDerivation() {
+  if (password == nullptr || salt == nullptr) {
+    log_e("Error: Password or salt not set.");
+    return false;
+  }
+  if (hashBuilder == nullptr || hashSize == 0 || hashSize > sizeof(u)) {
+    log_e("Error: No usable hash algorithm set.");
+    return false;
+  }
+  blockSize = hashBuilder->getBlockSize();
+  if (blockSize == 0 || blockSize > HMAC_MAX_BLOCK_SIZE || blockSize < hashSize) {
+    log_e("Error: Unsupported hash block size: %lu", (unsigned long)blockSize);
+    return false;
+  }
+
+  // Set default output size to hash size if not specified
+  if (derivedKeyLen == 0) {
+    derivedKeyLen = hashSize;
+  }
+
+  // Allocate output buffer
+  if (derivedKey != nullptr) {
+    forced_memzero(derivedKey, derivedKeyLen);
+    delete[] derivedKey;
+  }
+  derivedKey = new uint8_t[derivedKeyLen];
+  keyPads = new uint8_t[blockSize * 2];
 
   // Prepare key
-  if (keyLen > HMAC_BLOCK_SIZE) {
+  uint8_t *innerPad = keyPads;
+  uint8_t *outerPad = keyPads + blockSize;
+  size_t keyLen = passwordLen;
+  if (keyLen > blockSize) {
     // Key is longer than block size, hash it
     hashBuilder->begin();
-    hashBuilder->add(key, keyLen);
+    hashBuilder->add(password, passwordLen);
     hashBuilder->calculate();
-    hashBuilder->getBytes(keyPad);
+    hashBuilder->getBytes(innerPad);
     keyLen = hashSize;
   } else {
-    // Copy key to keyPad
-    memcpy(keyPad, key, keyLen);
+    memcpy(innerPad, password, keyLen);
   }
+  memset(innerPad + keyLen, 0, blockSize - keyLen);
 
-  // Pad key with zeros if necessary
-  if (keyLen < HMAC_BLOCK_SIZE) {
-    memset(keyPad + keyLen, 0, HMAC_BLOCK_SIZE - keyLen);
+  // Create outer and inner pads
+  for (size_t i = 0; i < blockSize; i++) {
+    outerPad[i] = innerPad[i] ^ 0x5c;
+    innerPad[i] ^= 0x36;
   }
 
-  // Create outer and inner pads
-  for (int i = 0; i < HMAC_BLOCK_SIZE; i++) {
-    outerPad[i] = keyPad[i] ^ 0x5c;
-    keyPad[i] = keyPad[i] ^ 0x36;
+  stateSize = hashBuilder->getStateSize();
+  if (stateSize > 0) {
+    hmacStates = new uint8_t[stateSize * 2];
+    if (!hashPad(innerPad, hmacStates) || !hashPad(outerPad, hmacStates + stateSize)) {
+      forced_memzero(hmacStates, stateSize * 2);
+      delete[] hmacStates;
+      hmacStates = nullptr;
+    }
+  }
+
+  blockIndex = 1;
+  iteration = 0;
+  return true;
+}
+
+void PBKDF2_HMACBuilder::endDerivation() {
+  if (keyPads != nullptr) {
+    forced_memzero(keyPads, blockSize * 2);
+    delete[] keyPads;
+    keyPads = nullptr;
   }
+  if (hmacStates != nullptr) {
+    forced_memzero(hmacStates, stateSize * 2);
+    delete[] hmacStates;
+    hmacStates = nullptr;
+  }
+  forced_memzero(u, sizeof(u));
+  forced_memzero(t, sizeof(t));
+  blockIndex = 0;
+  iteration = 0;
+}
 
-  // Inner hash: H(K XOR ipad, text)
+// The hash state once the padded key block has been compressed. The initial
+// state is saved and restored first, which moves a digest the SHA peripheral
+// would hold into memory, where it can be saved.
+bool PBKDF2_HMACBuilder::hashPad(const uint8_t *pad, uint8_t *state) {
   hashBuilder->begin();
-  hashBuilder->add(keyPad, HMAC_BLOCK_SIZE);
-  hashBuilder->add(data, dataLen);
+  if (!hashBuilder->saveState(state) || !hashBuilder->restoreState(state)) {
+    return false;
+  }
+  hashBuilder->add(pad, blockSize);
+  return hashBuilder->saveState(state);
+}
+
+// Starts the inner (pad 0) or outer (pad 1) hash of an HMAC with the password.
+// A restored state goes on in software, also on chips with a SHA peripheral:
+// the peripheral cannot be loaded with it through mbedTLS, and an iteration
+// then compresses two blocks in software where the peripheral would take four
+// blocks and two lock and start cycles, which is not faster for blocks this few.
+void PBKDF2_HMACBuilder::hmacStart(int pad) {
+  if (hmacStates == nullptr || !hashBuilder->restoreState(hmacStates + pad * stateSize)) {
+    hashBuilder->begin();
+    hashBuilder->add(keyPads + pad * blockSize, blockSize);
+  }
+}
+
+// Ends the inner hash started with hmacStart(0), output gets the HMAC
+void PBKDF2_HMACBuilder::hmacFinish(uint8_t *output) {
+  uint8_t innerHash[64];  // Large enough for any hash
+
   hashBuilder->calculate();
   hashBuilder->getBytes(innerHash);
 
   // Outer hash: H(K XOR opad, inner_hash)
-  hashBuilder->begin();
-  hashBuilder->add(outerPad, HMAC_BLOCK_SIZE);
+  hmacStart(1);
   hashBuilder->add(innerHash, hashSize);
   hashBuilder->calculate();
   hashBuilder->getBytes(output);
 }
 
+bool PBKDF2_HMACBuilder::step(uint32_t n) {
+  if (calculated) {
+    return true;
+  }
+  if (blockIndex == 0 && !startDerivation()) {
+    return false;
+  }
+
+  size_t blocks = (derivedKeyLen + hashSize - 1) / hashSize;
+  uint32_t rounds = iterations > 0 ? iterations : 1;
+
+  for (; n > 0; n--) {
+    hmacStart(0);
+    if (iteration == 0) {
+      // U1 = HMAC(password, salt || INT(i))
+      uint8_t index[4] = {(uint8_t)(blockIndex >> 24), (uint8_t)(blockIndex >> 16), (uint8_t)(blockIndex >> 8), (uint8_t)blockIndex};
+      hashBuilder->add(salt, saltLen);
+      hashBuilder->add(index, sizeof(index));
+      hmacFinish(u);
+      memcpy(t, u, hashSize);
+    } else {
+      // Uj = HMAC(password, Uj-1), XOR with previous result
+      hashBuilder->add(u, hashSize);
+      hmacFinish(u);
+      for (size_t k = 0; k < hashSize; k++) {
+        t[k] ^= u[k];
+      }
+    }
+
+    if (++iteration < rounds) {
+      continue;
+    }
+
+    // Copy block to output
+    size_t offset = (blockIndex - 1) * hashSize;
+    size_t copyLen = (blockIndex == blocks) ? (derivedKeyLen - offset) : hashSize;
+    memcpy(derivedKey + offset, t, copyLen);
+    if (blockIndex == blocks) {
+      endDerivation();
+      calculated = true;
+      return true;
+    }
+    blockIndex++;
+    iteration = 0;
+  }
+  return false;
+}
+
 // HashBuilder interface methods
 void PBKDF2_HMACBuilder::begin() {
   clearData();
@@ -122,26 +260,13 @@ bool PBKDF2_HMACBuilder::addStream(Stream &stream, const size_t maxLen) {
 }
 
 void PBKDF2_HMACBuilder::calculate() {
-  if (password == nullptr || salt == nullptr) {
-    log_e("Error: Password or salt not set.");
+  if (calculated) {
     return;
   }
-
-  // Set default output size to hash size if not specified
-  if (derivedKeyLen == 0) {
-    derivedKeyLen = hashSize;
-  }
-
-  // Allocate output buffer
-  if (derivedKey != nullptr) {
-    forced_memzero(derivedKey, derivedKeyLen);
-    delete[] derivedKey;
+  if (blockIndex == 0 && !startDerivation()) {
+    return;
   }
-  derivedKey = new uint8_t[derivedKeyLen];
-
-  // Perform PBKDF2-HMAC
-  pbkdf2_hmac(password, passwordLen, salt, saltLen, iterations, derivedKey, derivedKeyLen);
-  calculated = true;
+  while (!step(UINT32_MAX)) {}
 }
 
 void PBKDF2_HMACBuilder::getBytes(uint8_t *output) {
@@ -174,8 +299,9 @@ String PBKDF2_HMACBuilder::toString() {
 
 // PBKDF2 specific methods
 void PBKDF2_HMACBuilder::setPassword(const uint8_t *password, size_t len) {
+  endDerivation();
   if (this->password != nullptr) {
-    forced_memzero(this->password, len);
+    forced_memzero(this->password, passwordLen);
     delete[] this->password;
   }
   this->password = new uint8_t[len];
@@ -193,8 +319,9 @@ void PBKDF2_HMACBuilder::setPassword(String password) {
 }
 
 void PBKDF2_HMACBuilder::setSalt(const uint8_t *salt, size_t len) {
+  endDerivation();
   if (this->salt != nullptr) {
-    forced_memzero(this->salt, len);
+    forced_memzero(this->salt, saltLen);
     delete[] this->salt;
   }
   this->salt = new uint8_t[len];
@@ -212,10 +339,14 @@ void PBKDF2_HMACBuilder::setSalt(String salt) {
 }
 
 void PBKDF2_HMACBuilder::setIterations(uint32_t iterations) {
+  endDerivation();
   this->iterations = iterations;
+  calculated = false;
 }
 
 void PBKDF2_HMACBuilder::setHashAlgorithm(HashBuilder *hash) {
+  endDerivation();
+  calculated = false;
   hashBuilder = hash;
   if (hash) {
     hashSize = hash->getHashSize();
@@ -224,42 +355,3 @@ void PBKDF2_HMACBuilder::setHashAlgorithm(HashBuilder *hash) {
     log_e("PBKDF2_HMACBuilder: Hash algorithm set to null.");
   }
 }
-
-void PBKDF2_HMACBuilder::pbkdf2_hmac(
-  const uint8_t *password, size_t passwordLen, const uint8_t *salt, size_t saltLen, uint32_t iterations, uint8_t *output, size_t outputLen
-) {
-  uint8_t u1[64];  // Large enough for any hash
-  uint8_t u2[64];
-  uint8_t saltWithBlock[256];  // Salt + block number
-  uint8_t block[64];
-
-  size_t blocks = (outputLen + hashSize - 1) / hashSize;
-
-  for (size_t i = 1; i <= blocks; i++) {
-    // Prepare salt || INT(i)
-    memcpy(saltWithBlock, salt, saltLen);
-    saltWithBlock[saltLen] = (i >> 24) & 0xFF;
-    saltWithBlock[saltLen + 1] = (i >> 16) & 0xFF;
-    saltWithBlock[saltLen + 2] = (i >> 8) & 0xFF;
-    saltWithBlock[saltLen + 3] = i & 0xFF;
-
-    // U1 = HMAC(password, salt || INT(i))
-    hmac(password, passwordLen, saltWithBlock, saltLen + 4, u1);
-    memcpy(block, u1, hashSize);
-
-    // U2 = HMAC(password, U1)
-    for (uint32_t j = 1; j < iterations; j++) {
-      hmac(password, passwordLen, u1, hashSize, u2);
-      memcpy(u1, u2, hashSize);
-
-      // XOR with previous result
-      for (size_t k = 0; k < hashSize; k++) {
-        block[k] ^= u1[k];
-      }
-    }
-
-    // Copy block to output
-    size_t copyLen = (i == blocks) ? (outputLen - (i - 1) * hashSize) : hashSize;
-    memcpy(output + (i - 1) * hashSize, block, copyLen);
-  }
-}
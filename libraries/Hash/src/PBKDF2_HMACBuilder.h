@@ -19,6 +19,9 @@
 #include <Stream.h>
 #include "HashBuilder.h"
 
+// Largest block size of the hash functions HMAC is used with (SHAKE128)
+#define HMAC_MAX_BLOCK_SIZE 168
+
 class PBKDF2_HMACBuilder : public HashBuilder {
 private:
   HashBuilder *hashBuilder;
@@ -36,8 +39,21 @@ private:
   size_t derivedKeyLen;
   bool calculated;
 
-  void hmac(const uint8_t *key, size_t keyLen, const uint8_t *data, size_t dataLen, uint8_t *output);
-  void pbkdf2_hmac(const uint8_t *password, size_t passwordLen, const uint8_t *salt, size_t saltLen, uint32_t iterations, uint8_t *output, size_t outputLen);
+  // Derivation in progress, advanced by step()
+  uint8_t *keyPads;     // Key XOR ipad, then key XOR opad, blockSize bytes each
+  uint8_t *hmacStates;  // Hash states after each of the pads, if the hash can save them
+  size_t blockSize;     // Block size of the hash function
+  size_t stateSize;     // Size of one saved hash state
+  uint32_t blockIndex;  // Output block being derived, from 1, 0 when not started
+  uint32_t iteration;   // Iterations done for that block
+  uint8_t u[64];        // Last PRF output
+  uint8_t t[64];        // XOR of the PRF outputs of the block
+
+  bool startDerivation();
+  void endDerivation();
+  bool hashPad(const uint8_t *pad, uint8_t *state);
+  void hmacStart(int pad);
+  void hmacFinish(uint8_t *output);
   void clearData();
 
 public:
@@ -68,6 +84,11 @@ public:
   void setSalt(String salt);
   void setIterations(uint32_t iterations);
   void setHashAlgorithm(HashBuilder *hash);
+
+  // Runs up to n more iterations of the derivation, so that it can be spread
+  // over several calls of loop(). Returns true once the key is ready, then
+  // getBytes() and the others can be used as after calculate().
+  bool step(uint32_t n);
 };
 
 #endif
@@ -208,6 +208,11 @@ void SHA1Builder::begin(void) {
 
   memset(buffer, 0x00, sizeof(buffer));
   memset(hash, 0x00, sizeof(hash));
+
+#if SHA_HW_SHA1
+  // The software state above stays unused while the peripheral has the digest
+  hw.begin(SHA_HW_ALG_SHA1);
+#endif
 }
 
 void SHA1Builder::add(const uint8_t *data, size_t len) {
@@ -228,6 +233,13 @@ void SHA1Builder::add(const uint8_t *data, size_t len) {
     total[1]++;
   }
 
+#if SHA_HW_SUPPORTED
+  if (hw.running()) {
+    hw.add(data, len);
+    return;
+  }
+#endif
+
   if (left && len >= fill) {
     memcpy((void *)(buffer + left), data, fill);
     process(buffer);
@@ -247,45 +259,6 @@ void SHA1Builder::add(const uint8_t *data, size_t len) {
   }
 }
 
-bool SHA1Builder::addStream(Stream &stream, const size_t maxLen) {
-  const int buf_size = 512;
-  int maxLengthLeft = maxLen;
-  uint8_t *buf = (uint8_t *)malloc(buf_size);
-
-  if (!buf) {
-    return false;
-  }
-
-  int bytesAvailable = stream.available();
-  while ((bytesAvailable > 0) && (maxLengthLeft > 0)) {
-
-    // determine number of bytes to read
-    int readBytes = bytesAvailable;
-    if (readBytes > maxLengthLeft) {
-      readBytes = maxLengthLeft;  // read only until max_len
-    }
-    if (readBytes > buf_size) {
-      readBytes = buf_size;  // not read more the buffer can handle
-    }
-
-    // read data and check if we got something
-    int numBytesRead = stream.readBytes(buf, readBytes);
-    if (numBytesRead < 1) {
-      free(buf);
-      return false;
-    }
-
-    // Update SHA1 with buffer payload
-    add(buf, numBytesRead);
-
-    // update available number of bytes
-    maxLengthLeft -= numBytesRead;
-    bytesAvailable = stream.available();
-  }
-  free(buf);
-  return true;
-}
-
 void SHA1Builder::calculate(void) {
   uint32_t last, padn;
   uint32_t high, low;
@@ -295,6 +268,14 @@ void SHA1Builder::calculate(void) {
     return;
   }
 
+#if SHA_HW_SUPPORTED
+  if (hw.running()) {
+    hw.calculate(hash, SHA1_HASH_SIZE);
+    finalized = true;
+    return;
+  }
+#endif
+
   high = (total[0] >> 29) | (total[1] << 3);
   low = (total[0] << 3);
 
@@ -316,6 +297,32 @@ void SHA1Builder::calculate(void) {
   finalized = true;
 }
 
+// The chaining values and the length, valid at a block boundary only
+bool SHA1Builder::saveState(uint8_t *state) {
+  if (finalized || (total[0] & 0x3F) != 0) {
+    return false;
+  }
+#if SHA_HW_SUPPORTED
+  // The software state is only current until the peripheral is given data
+  if (hw.running() && (total[0] != 0 || total[1] != 0)) {
+    return false;
+  }
+#endif
+  memcpy(state, this->state, sizeof(this->state));
+  memcpy(state + sizeof(this->state), total, sizeof(total));
+  return true;
+}
+
+bool SHA1Builder::restoreState(const uint8_t *state) {
+#if SHA_HW_SUPPORTED
+  hw.end();
+#endif
+  memcpy(this->state, state, sizeof(this->state));
+  memcpy(total, state + sizeof(this->state), sizeof(total));
+  finalized = false;
+  return true;
+}
+
 void SHA1Builder::getBytes(uint8_t *output) {
   memcpy(output, hash, SHA1_HASH_SIZE);
 }
@@ -19,6 +19,7 @@
 #include <Stream.h>
 
 #include "HashBuilder.h"
+#include "SHAHardware.h"
 
 #define SHA1_HASH_SIZE 20
 
@@ -29,6 +30,9 @@ private:
   unsigned char buffer[64];     /* data block being processed */
   uint8_t hash[SHA1_HASH_SIZE]; /* SHA-1 result               */
   bool finalized;               /* Whether hash has been finalized */
+#if SHA_HW_SUPPORTED
+  SHAHardware hw; /* digest in progress on the SHA peripheral, copied with the builder */
+#endif
 
   void process(const uint8_t *data);
 
@@ -38,7 +42,6 @@ public:
   SHA1Builder() : finalized(false) {}
   void begin() override;
   void add(const uint8_t *data, size_t len) override;
-  bool addStream(Stream &stream, const size_t maxLen) override;
   void calculate() override;
   void getBytes(uint8_t *output) override;
   void getChars(char *output) override;
@@ -46,6 +49,12 @@ public:
   size_t getHashSize() const override {
     return SHA1_HASH_SIZE;
   }
+
+  size_t getStateSize() const override {
+    return sizeof(state) + sizeof(total);
+  }
+  bool saveState(uint8_t *state) override;
+  bool restoreState(const uint8_t *state) override;
 };
 
 #endif
@@ -61,10 +61,6 @@ static const uint64_t sha512_k[80] = {0x428a2f98d728ae22ULL, 0x7137449123ef65cdU
 #define SIG1_32(x)     (ROTR32(x, 17) ^ ROTR32(x, 19) ^ ((x) >> 10))
 #define SIG1_64(x)     (ROTR64(x, 19) ^ ROTR64(x, 61) ^ ((x) >> 6))
 
-// Byte order conversion
-#define BYTESWAP32(x) ((((x) & 0xFF000000) >> 24) | (((x) & 0x00FF0000) >> 8) | (((x) & 0x0000FF00) << 8) | (((x) & 0x000000FF) << 24))
-#define BYTESWAP64(x) (((uint64_t)BYTESWAP32((uint32_t)((x) >> 32))) | (((uint64_t)BYTESWAP32((uint32_t)(x))) << 32))
-
 // Constructor
 SHA2Builder::SHA2Builder(size_t hash_size) : hash_size(hash_size), buffer_size(0), finalized(false), total_length(0) {
   // Determine block size and algorithm family
@@ -79,6 +75,24 @@ SHA2Builder::SHA2Builder(size_t hash_size) : hash_size(hash_size), buffer_size(0
     block_size = 0;
     is_sha512 = false;
   }
+
+#if SHA_HW_SUPPORTED
+  hw_alg = SHA_HW_NONE;
+#if SHA_HW_SHA256
+  if (hash_size == SHA2_224_HASH_SIZE) {
+    hw_alg = SHA_HW_ALG_SHA224;
+  } else if (hash_size == SHA2_256_HASH_SIZE) {
+    hw_alg = SHA_HW_ALG_SHA256;
+  }
+#endif
+#if SHA_HW_SHA512
+  if (hash_size == SHA2_384_HASH_SIZE) {
+    hw_alg = SHA_HW_ALG_SHA384;
+  } else if (hash_size == SHA2_512_HASH_SIZE) {
+    hw_alg = SHA_HW_ALG_SHA512;
+  }
+#endif
+#endif /* SHA_HW_SUPPORTED */
 }
 
 // Initialize the hash computation
@@ -139,45 +153,101 @@ void SHA2Builder::begin() {
       state_64[7] = 0x5be0cd19137e2179ULL;
     }
   }
+
+#if SHA_HW_SUPPORTED
+  // The software state above stays unused while the peripheral has the digest
+  if (hw_alg != SHA_HW_NONE) {
+    hw.begin(hw_alg);
+  }
+#endif
+}
+
+// Big endian loads, the input is not necessarily aligned
+static inline uint32_t load32_be(const uint8_t *p) {
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  v = __builtin_bswap32(v);
+#endif
+  return v;
+}
+
+static inline uint64_t load64_be(const uint8_t *p) {
+  uint64_t v;
+  memcpy(&v, p, sizeof(v));
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  v = __builtin_bswap64(v);
+#endif
+  return v;
 }
 
+// The message schedule is kept in a 16 word ring, word i is computed in the
+// round that uses it
+#define SHA256_SCHEDULE(i) (w[(i) & 15] += SIG1_32(w[((i) - 2) & 15]) + w[((i) - 7) & 15] + SIG0_32(w[((i) - 15) & 15]))
+#define SHA512_SCHEDULE(i) (w[(i) & 15] += SIG1_64(w[((i) - 2) & 15]) + w[((i) - 7) & 15] + SIG0_64(w[((i) - 15) & 15]))
+
+// One round, with the working variables renamed by the caller instead of moved
+#define SHA256_ROUND(a, b, c, d, e, f, g, h, i, x)                 \
+  do {                                                             \
+    uint32_t t1 = h + EP1_32(e) + CH32(e, f, g) + sha256_k[i] + x; \
+    d += t1;                                                       \
+    h = t1 + EP0_32(a) + MAJ32(a, b, c);                           \
+  } while (0)
+
+#define SHA512_ROUND(a, b, c, d, e, f, g, h, i, x)                 \
+  do {                                                             \
+    uint64_t t1 = h + EP1_64(e) + CH64(e, f, g) + sha512_k[i] + x; \
+    d += t1;                                                       \
+    h = t1 + EP0_64(a) + MAJ64(a, b, c);                           \
+  } while (0)
+
+// Eight rounds, after which the variables are back in their places
+#define SHA256_EIGHT(i, X)                               \
+  SHA256_ROUND(a, b, c, d, e, f, g, h, i, X(i));         \
+  SHA256_ROUND(h, a, b, c, d, e, f, g, i + 1, X(i + 1)); \
+  SHA256_ROUND(g, h, a, b, c, d, e, f, i + 2, X(i + 2)); \
+  SHA256_ROUND(f, g, h, a, b, c, d, e, i + 3, X(i + 3)); \
+  SHA256_ROUND(e, f, g, h, a, b, c, d, i + 4, X(i + 4)); \
+  SHA256_ROUND(d, e, f, g, h, a, b, c, i + 5, X(i + 5)); \
+  SHA256_ROUND(c, d, e, f, g, h, a, b, i + 6, X(i + 6)); \
+  SHA256_ROUND(b, c, d, e, f, g, h, a, i + 7, X(i + 7))
+
+#define SHA512_EIGHT(i, X)                               \
+  SHA512_ROUND(a, b, c, d, e, f, g, h, i, X(i));         \
+  SHA512_ROUND(h, a, b, c, d, e, f, g, i + 1, X(i + 1)); \
+  SHA512_ROUND(g, h, a, b, c, d, e, f, i + 2, X(i + 2)); \
+  SHA512_ROUND(f, g, h, a, b, c, d, e, i + 3, X(i + 3)); \
+  SHA512_ROUND(e, f, g, h, a, b, c, d, i + 4, X(i + 4)); \
+  SHA512_ROUND(d, e, f, g, h, a, b, c, i + 5, X(i + 5)); \
+  SHA512_ROUND(c, d, e, f, g, h, a, b, i + 6, X(i + 6)); \
+  SHA512_ROUND(b, c, d, e, f, g, h, a, i + 7, X(i + 7))
+
+#define MESSAGE_WORD(i) w[i]
+
 // Process a block for SHA-256
 void SHA2Builder::process_block_sha256(const uint8_t *data) {
-  uint32_t w[64];
-  uint32_t a, b, c, d, e, f, g, h;
-  uint32_t t1, t2;
-
-  // Prepare message schedule
+  uint32_t w[16];
   for (int i = 0; i < 16; i++) {
-    w[i] = BYTESWAP32(((uint32_t *)data)[i]);
-  }
-  for (int i = 16; i < 64; i++) {
-    w[i] = SIG1_32(w[i - 2]) + w[i - 7] + SIG0_32(w[i - 15]) + w[i - 16];
+    w[i] = load32_be(data + i * 4);
   }
 
-  // Initialize working variables
-  a = state_32[0];
-  b = state_32[1];
-  c = state_32[2];
-  d = state_32[3];
-  e = state_32[4];
-  f = state_32[5];
-  g = state_32[6];
-  h = state_32[7];
-
-  // Main loop
-  for (int i = 0; i < 64; i++) {
-    t1 = h + EP1_32(e) + CH32(e, f, g) + sha256_k[i] + w[i];
-    t2 = EP0_32(a) + MAJ32(a, b, c);
-    h = g;
-    g = f;
-    f = e;
-    e = d + t1;
-    d = c;
-    c = b;
-    b = a;
-    a = t1 + t2;
-  }
+  uint32_t a = state_32[0];
+  uint32_t b = state_32[1];
+  uint32_t c = state_32[2];
+  uint32_t d = state_32[3];
+  uint32_t e = state_32[4];
+  uint32_t f = state_32[5];
+  uint32_t g = state_32[6];
+  uint32_t h = state_32[7];
+
+  SHA256_EIGHT(0, MESSAGE_WORD);
+  SHA256_EIGHT(8, MESSAGE_WORD);
+  SHA256_EIGHT(16, SHA256_SCHEDULE);
+  SHA256_EIGHT(24, SHA256_SCHEDULE);
+  SHA256_EIGHT(32, SHA256_SCHEDULE);
+  SHA256_EIGHT(40, SHA256_SCHEDULE);
+  SHA256_EIGHT(48, SHA256_SCHEDULE);
+  SHA256_EIGHT(56, SHA256_SCHEDULE);
 
   // Add the compressed chunk to the current hash value
   state_32[0] += a;
@@ -192,41 +262,30 @@ void SHA2Builder::process_block_sha256(const uint8_t *data) {
 
 // Process a block for SHA-512
 void SHA2Builder::process_block_sha512(const uint8_t *data) {
-  uint64_t w[80];
-  uint64_t a, b, c, d, e, f, g, h;
-  uint64_t t1, t2;
-
-  // Prepare message schedule
+  uint64_t w[16];
   for (int i = 0; i < 16; i++) {
-    w[i] = BYTESWAP64(((uint64_t *)data)[i]);
-  }
-  for (int i = 16; i < 80; i++) {
-    w[i] = SIG1_64(w[i - 2]) + w[i - 7] + SIG0_64(w[i - 15]) + w[i - 16];
+    w[i] = load64_be(data + i * 8);
   }
 
-  // Initialize working variables
-  a = state_64[0];
-  b = state_64[1];
-  c = state_64[2];
-  d = state_64[3];
-  e = state_64[4];
-  f = state_64[5];
-  g = state_64[6];
-  h = state_64[7];
-
-  // Main loop
-  for (int i = 0; i < 80; i++) {
-    t1 = h + EP1_64(e) + CH64(e, f, g) + sha512_k[i] + w[i];
-    t2 = EP0_64(a) + MAJ64(a, b, c);
-    h = g;
-    g = f;
-    f = e;
-    e = d + t1;
-    d = c;
-    c = b;
-    b = a;
-    a = t1 + t2;
-  }
+  uint64_t a = state_64[0];
+  uint64_t b = state_64[1];
+  uint64_t c = state_64[2];
+  uint64_t d = state_64[3];
+  uint64_t e = state_64[4];
+  uint64_t f = state_64[5];
+  uint64_t g = state_64[6];
+  uint64_t h = state_64[7];
+
+  SHA512_EIGHT(0, MESSAGE_WORD);
+  SHA512_EIGHT(8, MESSAGE_WORD);
+  SHA512_EIGHT(16, SHA512_SCHEDULE);
+  SHA512_EIGHT(24, SHA512_SCHEDULE);
+  SHA512_EIGHT(32, SHA512_SCHEDULE);
+  SHA512_EIGHT(40, SHA512_SCHEDULE);
+  SHA512_EIGHT(48, SHA512_SCHEDULE);
+  SHA512_EIGHT(56, SHA512_SCHEDULE);
+  SHA512_EIGHT(64, SHA512_SCHEDULE);
+  SHA512_EIGHT(72, SHA512_SCHEDULE);
 
   // Add the compressed chunk to the current hash value
   state_64[0] += a;
@@ -246,6 +305,12 @@ void SHA2Builder::add(const uint8_t *data, size_t len) {
   }
 
   total_length += len;
+#if SHA_HW_SUPPORTED
+  if (hw.running()) {
+    hw.add(data, len);
+    return;
+  }
+#endif
   size_t offset = 0;
 
   // Process any buffered data first
@@ -282,42 +347,36 @@ void SHA2Builder::add(const uint8_t *data, size_t len) {
   }
 }
 
-// Add data from a stream
-bool SHA2Builder::addStream(Stream &stream, const size_t maxLen) {
-  const int buf_size = 512;
-  int maxLengthLeft = maxLen;
-  uint8_t *buf = (uint8_t *)malloc(buf_size);
+// The chaining values and the length, valid at a block boundary only
+size_t SHA2Builder::getStateSize() const {
+  return (is_sha512 ? sizeof(state_64) : sizeof(state_32)) + sizeof(total_length);
+}
 
-  if (!buf) {
+bool SHA2Builder::saveState(uint8_t *state) {
+  if (finalized || buffer_size != 0) {
     return false;
   }
-
-  int bytesAvailable = stream.available();
-  while ((bytesAvailable > 0) && (maxLengthLeft > 0)) {
-    // Determine number of bytes to read
-    int readBytes = bytesAvailable;
-    if (readBytes > maxLengthLeft) {
-      readBytes = maxLengthLeft;
-    }
-    if (readBytes > buf_size) {
-      readBytes = buf_size;
-    }
-
-    // Read data and check if we got something
-    int numBytesRead = stream.readBytes(buf, readBytes);
-    if (numBytesRead < 1) {
-      free(buf);
-      return false;
-    }
-
-    // Update SHA2 with buffer payload
-    add(buf, numBytesRead);
-
-    // Update available number of bytes
-    maxLengthLeft -= numBytesRead;
-    bytesAvailable = stream.available();
+#if SHA_HW_SUPPORTED
+  // The software state is only current until the peripheral is given data
+  if (hw.running() && total_length != 0) {
+    return false;
   }
-  free(buf);
+#endif
+  size_t words = is_sha512 ? sizeof(state_64) : sizeof(state_32);
+  memcpy(state, is_sha512 ? (const void *)state_64 : (const void *)state_32, words);
+  memcpy(state + words, &total_length, sizeof(total_length));
+  return true;
+}
+
+bool SHA2Builder::restoreState(const uint8_t *state) {
+#if SHA_HW_SUPPORTED
+  hw.end();
+#endif
+  size_t words = is_sha512 ? sizeof(state_64) : sizeof(state_32);
+  memcpy(is_sha512 ? (void *)state_64 : (void *)state_32, state, words);
+  memcpy(&total_length, state + words, sizeof(total_length));
+  buffer_size = 0;
+  finalized = false;
   return true;
 }
 
@@ -374,6 +433,14 @@ void SHA2Builder::calculate() {
     return;
   }
 
+#if SHA_HW_SUPPORTED
+  if (hw.running()) {
+    hw.calculate(hash, hash_size);
+    finalized = true;
+    return;
+  }
+#endif
+
   // Pad the input
   pad();
 
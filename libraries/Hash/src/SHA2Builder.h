@@ -19,6 +19,7 @@
 #include <Stream.h>
 
 #include "HashBuilder.h"
+#include "SHAHardware.h"
 
 // SHA2 constants
 #define SHA2_224_HASH_SIZE 28
@@ -49,6 +50,10 @@ protected:
   bool is_sha512;         // Whether using SHA-512 family
   uint8_t hash[64];       // Hash result
   uint64_t total_length;  // Total length of input data
+#if SHA_HW_SUPPORTED
+  sha_hw_alg_t hw_alg;  // Algorithm to run on the SHA peripheral, if it has it
+  SHAHardware hw;       // Digest in progress on the SHA peripheral, copied with the builder
+#endif
 
   void process_block_sha256(const uint8_t *data);
   void process_block_sha512(const uint8_t *data);
@@ -62,7 +67,6 @@ public:
 
   void begin() override;
   void add(const uint8_t *data, size_t len) override;
-  bool addStream(Stream &stream, const size_t maxLen) override;
   void calculate() override;
   void getBytes(uint8_t *output) override;
   void getChars(char *output) override;
@@ -71,6 +75,13 @@ public:
   size_t getHashSize() const override {
     return hash_size;
   }
+  size_t getBlockSize() const override {
+    return block_size;
+  }
+
+  size_t getStateSize() const override;
+  bool saveState(uint8_t *state) override;
+  bool restoreState(const uint8_t *state) override;
 };
 
 class SHA224Builder : public SHA2Builder {
@@ -25,86 +25,140 @@ static const uint64_t keccak_round_constants[24] = {0x0000000000000001ULL, 0x000
                                                     0x8000000000008002ULL, 0x8000000000000080ULL, 0x000000000000800AULL, 0x800000008000000AULL,
                                                     0x8000000080008081ULL, 0x8000000000008080ULL, 0x0000000080000001ULL, 0x8000000080008008ULL};
 
-// Rho rotation constants
-static const uint32_t rho[6] = {0x3f022425, 0x1c143a09, 0x2c3d3615, 0x27191713, 0x312b382e, 0x3e030832};
-
-// Pi permutation constants
-static const uint32_t pi[6] = {0x110b070a, 0x10050312, 0x04181508, 0x0d13170f, 0x0e14020c, 0x01060916};
-
-// Macros for bit manipulation
-#define ROTR64(x, y) (((x) << (64U - (y))) | ((x) >> (y)))
+// Lanes kept complemented in the state, so that chi needs a single NOT per
+// plane: Abe, Abi, Ago, Aki, Ami and Asa (lane index x + 5 * y)
+#define KECCAK_COMPLEMENTED_LANES ((1UL << 1) | (1UL << 2) | (1UL << 8) | (1UL << 12) | (1UL << 17) | (1UL << 20))
+
+#define ROTL64(x, y) (((x) << (y)) | ((x) >> (64U - (y))))
+
+static inline uint64_t load64_le(const uint8_t *data) {
+  uint64_t v;
+  memcpy(&v, data, sizeof(v));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  v = __builtin_bswap64(v);
+#endif
+  return v;
+}
 
-// Keccak-f permutation
+// One round from the lanes A to the lanes E: theta, rho and pi as the lanes are
+// read, then chi on each plane with the complemented lanes and iota
+#define KECCAK_ROUND(A, E, rc)                \
+  Ca = A##ba ^ A##ga ^ A##ka ^ A##ma ^ A##sa; \
+  Ce = A##be ^ A##ge ^ A##ke ^ A##me ^ A##se; \
+  Ci = A##bi ^ A##gi ^ A##ki ^ A##mi ^ A##si; \
+  Co = A##bo ^ A##go ^ A##ko ^ A##mo ^ A##so; \
+  Cu = A##bu ^ A##gu ^ A##ku ^ A##mu ^ A##su; \
+  Da = Cu ^ ROTL64(Ce, 1);                    \
+  De = Ca ^ ROTL64(Ci, 1);                    \
+  Di = Ce ^ ROTL64(Co, 1);                    \
+  Do = Ci ^ ROTL64(Cu, 1);                    \
+  Du = Co ^ ROTL64(Ca, 1);                    \
+                                              \
+  Ba = A##ba ^ Da;                            \
+  Be = ROTL64(A##ge ^ De, 44);                \
+  Bi = ROTL64(A##ki ^ Di, 43);                \
+  Bo = ROTL64(A##mo ^ Do, 21);                \
+  Bu = ROTL64(A##su ^ Du, 14);                \
+  E##ba = Ba ^ (Be | Bi) ^ (rc);              \
+  E##be = Be ^ ((~Bi) | Bo);                  \
+  E##bi = Bi ^ (Bo & Bu);                     \
+  E##bo = Bo ^ (Bu | Ba);                     \
+  E##bu = Bu ^ (Ba & Be);                     \
+                                              \
+  Ba = ROTL64(A##bo ^ Do, 28);                \
+  Be = ROTL64(A##gu ^ Du, 20);                \
+  Bi = ROTL64(A##ka ^ Da, 3);                 \
+  Bo = ROTL64(A##me ^ De, 45);                \
+  Bu = ROTL64(A##si ^ Di, 61);                \
+  E##ga = Ba ^ (Be | Bi);                     \
+  E##ge = Be ^ (Bi & Bo);                     \
+  E##gi = Bi ^ (Bo | (~Bu));                  \
+  E##go = Bo ^ (Bu | Ba);                     \
+  E##gu = Bu ^ (Ba & Be);                     \
+                                              \
+  Ba = ROTL64(A##be ^ De, 1);                 \
+  Be = ROTL64(A##gi ^ Di, 6);                 \
+  Bi = ROTL64(A##ko ^ Do, 25);                \
+  Bo = ROTL64(A##mu ^ Du, 8);                 \
+  Bu = ROTL64(A##sa ^ Da, 18);                \
+  E##ka = Ba ^ (Be | Bi);                     \
+  E##ke = Be ^ (Bi & Bo);                     \
+  E##ki = Bi ^ ((~Bo) & Bu);                  \
+  E##ko = (~Bo) ^ (Bu | Ba);                  \
+  E##ku = Bu ^ (Ba & Be);                     \
+                                              \
+  Ba = ROTL64(A##bu ^ Du, 27);                \
+  Be = ROTL64(A##ga ^ Da, 36);                \
+  Bi = ROTL64(A##ke ^ De, 10);                \
+  Bo = ROTL64(A##mi ^ Di, 15);                \
+  Bu = ROTL64(A##so ^ Do, 56);                \
+  E##ma = Ba ^ (Be & Bi);                     \
+  E##me = Be ^ (Bi | Bo);                     \
+  E##mi = Bi ^ ((~Bo) | Bu);                  \
+  E##mo = (~Bo) ^ (Bu & Ba);                  \
+  E##mu = Bu ^ (Ba | Be);                     \
+                                              \
+  Ba = ROTL64(A##bi ^ Di, 62);                \
+  Be = ROTL64(A##go ^ Do, 55);                \
+  Bi = ROTL64(A##ku ^ Du, 39);                \
+  Bo = ROTL64(A##ma ^ Da, 41);                \
+  Bu = ROTL64(A##se ^ De, 2);                 \
+  E##sa = Ba ^ ((~Be) & Bi);                  \
+  E##se = (~Be) ^ (Bi | Bo);                  \
+  E##si = Bi ^ (Bo & Bu);                     \
+  E##so = Bo ^ (Bu | Ba);                     \
+  E##su = Bu ^ (Ba & Be)
+
+// Keccak-f permutation on a state with the lanes in KECCAK_COMPLEMENTED_LANES
+// complemented. The lanes live in locals and the rounds go two at a time,
+// from A to E and back, so that nothing is copied between them.
 void SHA3Builder::keccak_f(uint64_t state[25]) {
-  uint64_t lane[5];
-  uint64_t *s = state;
-  int i;
-
-  for (int round = 0; round < 24; round++) {
-    uint64_t t;
-
-    // Theta step
-    for (i = 0; i < 5; i++) {
-      lane[i] = s[i] ^ s[i + 5] ^ s[i + 10] ^ s[i + 15] ^ s[i + 20];
-    }
-    for (i = 0; i < 5; i++) {
-      t = lane[(i + 4) % 5] ^ ROTR64(lane[(i + 1) % 5], 63);
-      s[i] ^= t;
-      s[i + 5] ^= t;
-      s[i + 10] ^= t;
-      s[i + 15] ^= t;
-      s[i + 20] ^= t;
-    }
-
-    // Rho step
-    for (i = 1; i < 25; i += 4) {
-      uint32_t r = rho[(i - 1) >> 2];
-      for (int j = i; j < i + 4; j++) {
-        uint8_t r8 = (uint8_t)(r >> 24);
-        r <<= 8;
-        s[j] = ROTR64(s[j], r8);
-      }
-    }
-
-    // Pi step
-    t = s[1];
-    for (i = 0; i < 24; i += 4) {
-      uint32_t p = pi[i >> 2];
-      for (unsigned j = 0; j < 4; j++) {
-        uint64_t tmp = s[p & 0xff];
-        s[p & 0xff] = t;
-        t = tmp;
-        p >>= 8;
-      }
-    }
-
-    // Chi step
-    for (i = 0; i <= 20; i += 5) {
-      lane[0] = s[i];
-      lane[1] = s[i + 1];
-      lane[2] = s[i + 2];
-      lane[3] = s[i + 3];
-      lane[4] = s[i + 4];
-      s[i + 0] ^= (~lane[1]) & lane[2];
-      s[i + 1] ^= (~lane[2]) & lane[3];
-      s[i + 2] ^= (~lane[3]) & lane[4];
-      s[i + 3] ^= (~lane[4]) & lane[0];
-      s[i + 4] ^= (~lane[0]) & lane[1];
-    }
-
-    // Iota step
-    s[0] ^= keccak_round_constants[round];
+  uint64_t Aba = state[0], Abe = state[1], Abi = state[2], Abo = state[3], Abu = state[4];
+  uint64_t Aga = state[5], Age = state[6], Agi = state[7], Ago = state[8], Agu = state[9];
+  uint64_t Aka = state[10], Ake = state[11], Aki = state[12], Ako = state[13], Aku = state[14];
+  uint64_t Ama = state[15], Ame = state[16], Ami = state[17], Amo = state[18], Amu = state[19];
+  uint64_t Asa = state[20], Ase = state[21], Asi = state[22], Aso = state[23], Asu = state[24];
+  uint64_t Eba, Ebe, Ebi, Ebo, Ebu, Ega, Ege, Egi, Ego, Egu, Eka, Eke, Eki, Eko, Eku;
+  uint64_t Ema, Eme, Emi, Emo, Emu, Esa, Ese, Esi, Eso, Esu;
+  uint64_t Ca, Ce, Ci, Co, Cu, Da, De, Di, Do, Du, Ba, Be, Bi, Bo, Bu;
+
+  for (int round = 0; round < 24; round += 2) {
+    KECCAK_ROUND(A, E, keccak_round_constants[round]);
+    KECCAK_ROUND(E, A, keccak_round_constants[round + 1]);
   }
+
+  state[0] = Aba;
+  state[1] = Abe;
+  state[2] = Abi;
+  state[3] = Abo;
+  state[4] = Abu;
+  state[5] = Aga;
+  state[6] = Age;
+  state[7] = Agi;
+  state[8] = Ago;
+  state[9] = Agu;
+  state[10] = Aka;
+  state[11] = Ake;
+  state[12] = Aki;
+  state[13] = Ako;
+  state[14] = Aku;
+  state[15] = Ama;
+  state[16] = Ame;
+  state[17] = Ami;
+  state[18] = Amo;
+  state[19] = Amu;
+  state[20] = Asa;
+  state[21] = Ase;
+  state[22] = Asi;
+  state[23] = Aso;
+  state[24] = Asu;
 }
 
 // Process a block of data
 void SHA3Builder::process_block(const uint8_t *data) {
-  // XOR the data into the state using byte-level operations
-  for (size_t i = 0; i < rate; i++) {
-    size_t state_idx = i >> 3;           // i / 8
-    size_t bit_offset = (i & 0x7) << 3;  // (i % 8) * 8
-    uint64_t byte_val = (uint64_t)data[i] << bit_offset;
-    state[state_idx] ^= byte_val;
+  // XOR the data into the state a lane at a time, the complemented lanes stay so
+  for (size_t i = 0; i < rate / 8; i++) {
+    state[i] ^= load64_le(data + i * 8);
   }
 
   // Apply Keccak-f permutation
@@ -116,15 +170,15 @@ void SHA3Builder::pad() {
   // Clear the buffer first
   memset(buffer + buffer_size, 0, rate - buffer_size);
 
-  // Add the domain separator (0x06) at the current position
-  buffer[buffer_size] = 0x06;
+  // Add the domain separator (0x06 for SHA3, 0x1F for SHAKE) at the current position
+  buffer[buffer_size] = domain;
 
   // Set the last byte to indicate the end (0x80)
-  buffer[rate - 1] = 0x80;
+  buffer[rate - 1] |= 0x80;
 }
 
 // Constructor
-SHA3Builder::SHA3Builder(size_t hash_size) : hash_size(hash_size), buffer_size(0), finalized(false) {
+SHA3Builder::SHA3Builder(size_t hash_size) : hash_size(hash_size), buffer_size(0), finalized(false), domain(SHA3_DOMAIN), squeeze_offset(0) {
   // Calculate rate based on hash size
   if (hash_size == SHA3_224_HASH_SIZE) {
     rate = SHA3_224_RATE;
@@ -140,18 +194,33 @@ SHA3Builder::SHA3Builder(size_t hash_size) : hash_size(hash_size), buffer_size(0
   }
 }
 
+// Constructor for the extendable output functions
+SHA3Builder::SHA3Builder(size_t rate, size_t hash_size, uint8_t domain)
+  : rate(rate), hash_size(hash_size), buffer_size(0), finalized(false), domain(domain), squeeze_offset(0) {
+  if (hash_size > sizeof(hash)) {
+    log_e("Invalid hash size: %lu, use squeeze() for longer outputs", (unsigned long)hash_size);
+    this->hash_size = sizeof(hash);
+  }
+}
+
 // Initialize the hash computation
 void SHA3Builder::begin() {
   // Clear the state
   memset(state, 0, sizeof(state));
+  for (size_t i = 0; i < 25; i++) {
+    if (KECCAK_COMPLEMENTED_LANES & (1UL << i)) {
+      state[i] = ~0ULL;
+    }
+  }
   memset(buffer, 0, sizeof(buffer));
   buffer_size = 0;
   finalized = false;
+  squeeze_offset = 0;
 }
 
 // Add data to the hash computation
 void SHA3Builder::add(const uint8_t *data, size_t len) {
-  if (finalized || len == 0) {
+  if (finalized || len == 0 || rate == 0) {
     return;
   }
 
@@ -183,43 +252,56 @@ void SHA3Builder::add(const uint8_t *data, size_t len) {
   }
 }
 
-// Add data from a stream
-bool SHA3Builder::addStream(Stream &stream, const size_t maxLen) {
-  const int buf_size = 512;
-  int maxLengthLeft = maxLen;
-  uint8_t *buf = (uint8_t *)malloc(buf_size);
-
-  if (!buf) {
+// The lanes, valid at a block boundary only
+bool SHA3Builder::saveState(uint8_t *state) {
+  if (finalized || buffer_size != 0) {
     return false;
   }
+  memcpy(state, this->state, sizeof(this->state));
+  return true;
+}
 
-  int bytesAvailable = stream.available();
-  while ((bytesAvailable > 0) && (maxLengthLeft > 0)) {
-    // Determine number of bytes to read
-    int readBytes = bytesAvailable;
-    if (readBytes > maxLengthLeft) {
-      readBytes = maxLengthLeft;
-    }
-    if (readBytes > buf_size) {
-      readBytes = buf_size;
-    }
+bool SHA3Builder::restoreState(const uint8_t *state) {
+  memcpy(this->state, state, sizeof(this->state));
+  buffer_size = 0;
+  finalized = false;
+  squeeze_offset = 0;
+  return true;
+}
 
-    // Read data and check if we got something
-    int numBytesRead = stream.readBytes(buf, readBytes);
-    if (numBytesRead < 1) {
-      free(buf);
-      return false;
-    }
+// Read output from the sponge, permuting again whenever a rate worth is used up
+void SHA3Builder::squeeze(uint8_t *output, size_t len) {
+  if (rate == 0) {
+    return;
+  }
 
-    // Update SHA3 with buffer payload
-    add(buf, numBytesRead);
+  if (!finalized) {
+    // Pad the input and process the final block
+    pad();
+    process_block(buffer);
+    squeeze_offset = 0;
+    finalized = true;
+  }
 
-    // Update available number of bytes
-    maxLengthLeft -= numBytesRead;
-    bytesAvailable = stream.available();
+  while (len > 0) {
+    if (squeeze_offset == rate) {
+      keccak_f(state);
+      squeeze_offset = 0;
+    }
+    size_t n = std::min(len, rate - squeeze_offset);
+    // Extract bytes from the state, little endian, undoing the complement
+    for (size_t i = squeeze_offset; i < squeeze_offset + n; i++) {
+      size_t state_idx = i >> 3;           // i / 8
+      size_t bit_offset = (i & 0x7) << 3;  // (i % 8) * 8
+      uint64_t lane = state[state_idx];
+      if (KECCAK_COMPLEMENTED_LANES & (1UL << state_idx)) {
+        lane = ~lane;
+      }
+      *output++ = (uint8_t)(lane >> bit_offset);
+    }
+    squeeze_offset += n;
+    len -= n;
   }
-  free(buf);
-  return true;
 }
 
 // Finalize the hash computation
@@ -228,20 +310,7 @@ void SHA3Builder::calculate() {
     return;
   }
 
-  // Pad the input
-  pad();
-
-  // Process the final block
-  process_block(buffer);
-
-  // Extract bytes from the state
-  for (size_t i = 0; i < hash_size; i++) {
-    size_t state_idx = i >> 3;           // i / 8
-    size_t bit_offset = (i & 0x7) << 3;  // (i % 8) * 8
-    hash[i] = (uint8_t)(state[state_idx] >> bit_offset);
-  }
-
-  finalized = true;
+  squeeze(hash, hash_size);
 }
 
 // Get the hash as bytes
@@ -33,19 +33,35 @@
 
 #define SHA3_STATE_SIZE 200  // 1600 bits = 200 bytes
 
+// SHAKE constants, the hash size is the default output length
+#define SHAKE128_HASH_SIZE 32
+#define SHAKE256_HASH_SIZE 64
+
+#define SHAKE128_RATE 168
+#define SHAKE256_RATE 136
+
+// Domain separation bits, with the first padding bit
+#define SHA3_DOMAIN  0x06
+#define SHAKE_DOMAIN 0x1F
+
 class SHA3Builder : public HashBuilder {
 protected:
-  uint64_t state[25];   // SHA3 state (1600 bits)
-  uint8_t buffer[200];  // Input buffer
-  size_t rate;          // Rate (block size)
-  size_t hash_size;     // Output hash size
-  size_t buffer_size;   // Current buffer size
-  bool finalized;       // Whether hash has been finalized
-  uint8_t hash[64];     // Hash result
+  uint64_t state[25];     // SHA3 state (1600 bits)
+  uint8_t buffer[200];    // Input buffer
+  size_t rate;            // Rate (block size)
+  size_t hash_size;       // Output hash size
+  size_t buffer_size;     // Current buffer size
+  bool finalized;         // Whether hash has been finalized
+  uint8_t hash[64];       // Hash result
+  uint8_t domain;         // Domain separation byte
+  size_t squeeze_offset;  // Output bytes already read from the state
 
   void keccak_f(uint64_t state[25]);
   void process_block(const uint8_t *data);
   void pad();
+  void squeeze(uint8_t *output, size_t len);
+
+  SHA3Builder(size_t rate, size_t hash_size, uint8_t domain);
 
 public:
   using HashBuilder::add;
@@ -55,7 +71,6 @@ public:
 
   void begin() override;
   void add(const uint8_t *data, size_t len) override;
-  bool addStream(Stream &stream, const size_t maxLen) override;
   void calculate() override;
   void getBytes(uint8_t *output) override;
   void getChars(char *output) override;
@@ -64,6 +79,15 @@ public:
   size_t getHashSize() const override {
     return hash_size;
   }
+  size_t getBlockSize() const override {
+    return rate;
+  }
+
+  size_t getStateSize() const override {
+    return sizeof(state);
+  }
+  bool saveState(uint8_t *state) override;
+  bool restoreState(const uint8_t *state) override;
 };
 
 class SHA3_224Builder : public SHA3Builder {
@@ -86,4 +110,21 @@ public:
   SHA3_512Builder() : SHA3Builder(SHA3_512_HASH_SIZE) {}
 };
 
+// Extendable output functions. calculate() reads the first getHashSize() bytes
+// (64 at most) of the output and squeeze() streams the bytes that follow, as
+// many as needed. Called before calculate(), squeeze() starts at the first byte.
+class SHAKE128Builder : public SHA3Builder {
+public:
+  using SHA3Builder::squeeze;
+
+  SHAKE128Builder(size_t hash_size = SHAKE128_HASH_SIZE) : SHA3Builder(SHAKE128_RATE, hash_size, SHAKE_DOMAIN) {}
+};
+
+class SHAKE256Builder : public SHA3Builder {
+public:
+  using SHA3Builder::squeeze;
+
+  SHAKE256Builder(size_t hash_size = SHAKE256_HASH_SIZE) : SHA3Builder(SHAKE256_RATE, hash_size, SHAKE_DOMAIN) {}
+};
+
 #endif
@@ -0,0 +1,198 @@
+// Copyright 2026 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "esp32-hal-log.h"
+#include "SHAHardware.h"
+
+#if SHA_HW_SUPPORTED
+
+#if MBEDTLS_VERSION_MAJOR >= 4
+
+static psa_algorithm_t psa_alg(sha_hw_alg_t alg) {
+  switch (alg) {
+    case SHA_HW_ALG_SHA1:   return PSA_ALG_SHA_1;
+    case SHA_HW_ALG_SHA224: return PSA_ALG_SHA_224;
+    case SHA_HW_ALG_SHA256: return PSA_ALG_SHA_256;
+    case SHA_HW_ALG_SHA384: return PSA_ALG_SHA_384;
+    case SHA_HW_ALG_SHA512: return PSA_ALG_SHA_512;
+    default:                return PSA_ALG_NONE;
+  }
+}
+
+bool SHAHardware::begin(sha_hw_alg_t alg) {
+  end();
+  if (psa_crypto_init() != PSA_SUCCESS) {
+    log_e("PSA crypto init failed");
+    return false;
+  }
+  _op = psa_hash_operation_init();
+  psa_status_t status = psa_hash_setup(&_op, psa_alg(alg));
+  if (status != PSA_SUCCESS) {
+    log_w("Hardware hash setup failed: %d", (int)status);
+    psa_hash_abort(&_op);
+    return false;
+  }
+  _alg = alg;
+  return true;
+}
+
+void SHAHardware::add(const uint8_t *data, size_t len) {
+  if (running()) {
+    psa_hash_update(&_op, data, len);
+  }
+}
+
+void SHAHardware::calculate(uint8_t *output, size_t len) {
+  if (running()) {
+    size_t hashLen = 0;
+    psa_hash_finish(&_op, output, len, &hashLen);
+    _alg = SHA_HW_NONE;
+  }
+}
+
+void SHAHardware::end() {
+  if (running()) {
+    psa_hash_abort(&_op);
+    _alg = SHA_HW_NONE;
+  }
+}
+
+bool SHAHardware::clone(const SHAHardware &other) {
+  end();
+  if (!other.running()) {
+    return true;
+  }
+  _op = psa_hash_operation_init();
+  psa_status_t status = psa_hash_clone(&other._op, &_op);
+  if (status != PSA_SUCCESS) {
+    log_e("Hardware hash copy failed: %d", (int)status);
+    psa_hash_abort(&_op);
+    return false;
+  }
+  _alg = other._alg;
+  return true;
+}
+
+#else /* MBEDTLS_VERSION_MAJOR < 4 */
+
+bool SHAHardware::begin(sha_hw_alg_t alg) {
+  end();
+  int ret = -1;
+  switch (alg) {
+#if defined(MBEDTLS_SHA1_C)
+    case SHA_HW_ALG_SHA1:
+      mbedtls_sha1_init(&_ctx.sha1);
+      ret = mbedtls_sha1_starts(&_ctx.sha1);
+      break;
+#endif
+    case SHA_HW_ALG_SHA224:
+    case SHA_HW_ALG_SHA256:
+      mbedtls_sha256_init(&_ctx.sha256);
+      ret = mbedtls_sha256_starts(&_ctx.sha256, alg == SHA_HW_ALG_SHA224);
+      break;
+#if defined(MBEDTLS_SHA512_C)
+    case SHA_HW_ALG_SHA384:
+    case SHA_HW_ALG_SHA512:
+      mbedtls_sha512_init(&_ctx.sha512);
+      ret = mbedtls_sha512_starts(&_ctx.sha512, alg == SHA_HW_ALG_SHA384);
+      break;
+#endif
+    default: break;
+  }
+  if (ret != 0) {
+    log_w("Hardware hash setup failed: %d", ret);
+    return false;
+  }
+  _alg = alg;
+  return true;
+}
+
+void SHAHardware::add(const uint8_t *data, size_t len) {
+  switch (_alg) {
+#if defined(MBEDTLS_SHA1_C)
+    case SHA_HW_ALG_SHA1: mbedtls_sha1_update(&_ctx.sha1, data, len); break;
+#endif
+    case SHA_HW_ALG_SHA224:
+    case SHA_HW_ALG_SHA256: mbedtls_sha256_update(&_ctx.sha256, data, len); break;
+#if defined(MBEDTLS_SHA512_C)
+    case SHA_HW_ALG_SHA384:
+    case SHA_HW_ALG_SHA512: mbedtls_sha512_update(&_ctx.sha512, data, len); break;
+#endif
+    default: break;
+  }
+}
+
+void SHAHardware::calculate(uint8_t *output, size_t len) {
+  (void)len;
+  switch (_alg) {
+#if defined(MBEDTLS_SHA1_C)
+    case SHA_HW_ALG_SHA1: mbedtls_sha1_finish(&_ctx.sha1, output); break;
+#endif
+    case SHA_HW_ALG_SHA224:
+    case SHA_HW_ALG_SHA256: mbedtls_sha256_finish(&_ctx.sha256, output); break;
+#if defined(MBEDTLS_SHA512_C)
+    case SHA_HW_ALG_SHA384:
+    case SHA_HW_ALG_SHA512: mbedtls_sha512_finish(&_ctx.sha512, output); break;
+#endif
+    default: break;
+  }
+  end();
+}
+
+void SHAHardware::end() {
+  switch (_alg) {
+#if defined(MBEDTLS_SHA1_C)
+    case SHA_HW_ALG_SHA1: mbedtls_sha1_free(&_ctx.sha1); break;
+#endif
+    case SHA_HW_ALG_SHA224:
+    case SHA_HW_ALG_SHA256: mbedtls_sha256_free(&_ctx.sha256); break;
+#if defined(MBEDTLS_SHA512_C)
+    case SHA_HW_ALG_SHA384:
+    case SHA_HW_ALG_SHA512: mbedtls_sha512_free(&_ctx.sha512); break;
+#endif
+    default: break;
+  }
+  _alg = SHA_HW_NONE;
+}
+
+bool SHAHardware::clone(const SHAHardware &other) {
+  end();
+  switch (other._alg) {
+#if defined(MBEDTLS_SHA1_C)
+    case SHA_HW_ALG_SHA1:
+      mbedtls_sha1_init(&_ctx.sha1);
+      mbedtls_sha1_clone(&_ctx.sha1, &other._ctx.sha1);
+      break;
+#endif
+    case SHA_HW_ALG_SHA224:
+    case SHA_HW_ALG_SHA256:
+      mbedtls_sha256_init(&_ctx.sha256);
+      mbedtls_sha256_clone(&_ctx.sha256, &other._ctx.sha256);
+      break;
+#if defined(MBEDTLS_SHA512_C)
+    case SHA_HW_ALG_SHA384:
+    case SHA_HW_ALG_SHA512:
+      mbedtls_sha512_init(&_ctx.sha512);
+      mbedtls_sha512_clone(&_ctx.sha512, &other._ctx.sha512);
+      break;
+#endif
+    default: break;
+  }
+  _alg = other._alg;
+  return true;
+}
+
+#endif /* MBEDTLS_VERSION_MAJOR >= 4 */
+
+#endif /* SHA_HW_SUPPORTED */
@@ -0,0 +1,122 @@
+// Copyright 2026 Espressif Systems (Shanghai) PTE LTD
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef SHAHardware_h
+#define SHAHardware_h
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Backend selection for SHA1Builder and SHA2Builder, made at build time.
+//
+// When the chip has a SHA peripheral and mbedTLS is configured to use it
+// (CONFIG_MBEDTLS_HARDWARE_SHA), the algorithms the peripheral supports are
+// computed by it through the mbedTLS port that drives it. Everything else uses
+// the portable software implementation. Define HASH_SOFTWARE_SHA to always use
+// the software implementation.
+
+#if defined(ESP_PLATFORM) && !defined(HASH_SOFTWARE_SHA)
+#include "sdkconfig.h"
+#include "soc/soc_caps.h"
+#endif
+
+#if defined(CONFIG_MBEDTLS_HARDWARE_SHA) && defined(SOC_SHA_SUPPORTED) && SOC_SHA_SUPPORTED
+#include "mbedtls/build_info.h"
+#if MBEDTLS_VERSION_MAJOR >= 4
+#include "psa/crypto.h"
+#else
+#include "mbedtls/sha1.h"
+#include "mbedtls/sha256.h"
+#include "mbedtls/sha512.h"
+#endif
+#define SHA_HW_SUPPORTED 1
+#else
+#define SHA_HW_SUPPORTED 0
+#endif
+
+#if SHA_HW_SUPPORTED && defined(SOC_SHA_SUPPORT_SHA1)
+#define SHA_HW_SHA1 1
+#else
+#define SHA_HW_SHA1 0
+#endif
+
+#if SHA_HW_SUPPORTED && defined(SOC_SHA_SUPPORT_SHA256)
+#define SHA_HW_SHA256 1
+#else
+#define SHA_HW_SHA256 0
+#endif
+
+#if SHA_HW_SUPPORTED && defined(SOC_SHA_SUPPORT_SHA512)
+#define SHA_HW_SHA512 1
+#else
+#define SHA_HW_SHA512 0
+#endif
+
+enum sha_hw_alg_t {
+  SHA_HW_NONE,
+  SHA_HW_ALG_SHA1,
+  SHA_HW_ALG_SHA224,
+  SHA_HW_ALG_SHA256,
+  SHA_HW_ALG_SHA384,
+  SHA_HW_ALG_SHA512,
+};
+
+#if SHA_HW_SUPPORTED
+
+// One digest in progress on the SHA peripheral
+class SHAHardware {
+private:
+#if MBEDTLS_VERSION_MAJOR >= 4
+  psa_hash_operation_t _op;
+#else
+  union {
+    mbedtls_sha1_context sha1;
+    mbedtls_sha256_context sha256;
+    mbedtls_sha512_context sha512;
+  } _ctx;
+#endif
+  sha_hw_alg_t _alg;
+
+public:
+  SHAHardware() : _alg(SHA_HW_NONE) {}
+  ~SHAHardware() {
+    end();
+  }
+  // a copy goes on with the digest of other apart from it; the mbedTLS port
+  // reads the peripheral state out when the two cannot share it
+  SHAHardware(const SHAHardware &other) : _alg(SHA_HW_NONE) {
+    clone(other);
+  }
+  SHAHardware &operator=(const SHAHardware &other) {
+    if (this != &other) {
+      clone(other);
+    }
+    return *this;
+  }
+
+  // false when the algorithm cannot be started, the caller then uses software
+  bool begin(sha_hw_alg_t alg);
+  void add(const uint8_t *data, size_t len);
+  void calculate(uint8_t *output, size_t len);
+  void end();
+  // false when the digest of other could not be copied
+  bool clone(const SHAHardware &other);
+  bool running() const {
+    return _alg != SHA_HW_NONE;
+  }
+};
+
+#endif /* SHA_HW_SUPPORTED */
+
+#endif
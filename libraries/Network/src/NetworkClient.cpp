@@ -144,6 +144,22 @@ public:
     return _buffer[_pos];
   }
 
+  // the received bytes in the buffer, refilled from the socket when empty
+  size_t peekAvailable() {
+    if (_pos == _fill && !fillBuffer()) {
+      return 0;
+    }
+    return _fill - _pos;
+  }
+
+  const char *peekBuffer() {
+    return (const char *)_buffer + _pos;
+  }
+
+  void peekConsume(size_t consume) {
+    _pos += (consume < _fill - _pos) ? consume : _fill - _pos;
+  }
+
   size_t available() {
     return _fill - _pos + r_available();
   }
@@ -452,39 +468,11 @@ size_t NetworkClient::write_P(PGM_P buf, size_t size) {
 }
 
 size_t NetworkClient::write(Stream &stream) {
-  uint8_t *buf = (uint8_t *)malloc(1360);
-  if (!buf) {
-    return 0;
-  }
-  size_t toRead = 0, toWrite = 0, written = 0;
-  size_t available = stream.available();
-  while (available) {
-    toRead = (available > 1360) ? 1360 : available;
-    toWrite = stream.readBytes(buf, toRead);
-    written += write(buf, toWrite);
-    available = stream.available();
-  }
-  free(buf);
-  return written;
+  return stream.sendAvailable(*this);
 }
 
 size_t NetworkClient::write(Stream &stream, size_t length) {
-  uint8_t *buf = (uint8_t *)malloc(1360);
-  if (!buf) {
-    return 0;
-  }
-  size_t toRead = 0, toWrite = 0, written = 0;
-  while (length) {
-    toRead = (length > 1360) ? 1360 : length;
-    toWrite = stream.readBytes(buf, toRead);
-    if (!toWrite) {
-      break;
-    }
-    written += write(buf, toWrite);
-    length -= toWrite;
-  }
-  free(buf);
-  return written;
+  return stream.sendSize(*this, length);
 }
 
 int NetworkClient::read(uint8_t *buf, size_t size) {
@@ -550,6 +538,37 @@ int NetworkClient::peek() {
   return res;
 }
 
+bool NetworkClient::hasPeekBufferAPI() const {
+  return true;
+}
+
+size_t NetworkClient::peekAvailable() {
+  if (fd() < 0 || !_rxBuffer) {
+    return 0;
+  }
+  size_t res = _rxBuffer->peekAvailable();
+  if (_rxBuffer->failed()) {
+    log_e("fail on fd %d, errno: %d, \"%s\"", fd(), errno, strerror(errno));
+    stop();
+    return 0;
+  }
+  return res;
+}
+
+const char *NetworkClient::peekBuffer() {
+  return _rxBuffer ? _rxBuffer->peekBuffer() : nullptr;
+}
+
+void NetworkClient::peekConsume(size_t consume) {
+  if (_rxBuffer) {
+    _rxBuffer->peekConsume(consume);
+  }
+}
+
+bool NetworkClient::inputCanTimeout() {
+  return connected();
+}
+
 int NetworkClient::available() {
   if (fd() < 0 || !_rxBuffer) {
     return 0;
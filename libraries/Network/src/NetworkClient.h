@@ -67,9 +67,15 @@ public:
     return readBytes((char *)buffer, length);
   }
   int peek();
+  // the receive buffer is lent to Stream::sendAll() and friends
+  bool hasPeekBufferAPI() const override;
+  size_t peekAvailable() override;
+  const char *peekBuffer() override;
+  void peekConsume(size_t consume) override;
+  bool inputCanTimeout() override;
   void clear();  // clear rx
   void stop();
-  uint8_t connected();
+  uint8_t connected() override;
   void setSSE(bool sse);
   bool isSSE();
 
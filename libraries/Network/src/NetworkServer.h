@@ -54,6 +54,10 @@ public:
   void setNoDelay(bool nodelay);
   bool getNoDelay();
   bool hasClient();
+  // connections waiting to be accepted, the listen() backlog; set before begin()
+  void setMaxClients(uint8_t max_clients) {
+    _max_clients = max_clients;
+  }
 
   void end();
   void close();
@@ -61,5 +65,9 @@ public:
   operator bool() {
     return _listening;
   }
+  // the listening socket, to wait on with select(); -1 when not listening
+  int fd() const {
+    return _listening ? sockfd : -1;
+  }
   int setTimeout(uint32_t seconds);
 };
@@ -63,9 +63,14 @@ public:
   int available();
   int read();
   int read(uint8_t *buf, size_t size);
+  // the socket receive buffer holds TLS records, only read() has the plaintext
+  bool hasPeekBufferAPI() const override {
+    return false;
+  }
   void flush() {}
   void stop();
-  uint8_t connected();
+  // overrides NetworkClient's, so inputCanTimeout() asks the TLS session
+  uint8_t connected() override;
   int lastError(char *buf, const size_t size);
   void setInsecure();                                             // Don't validate the chain, just accept whatever is given.  VERY INSECURE!
   void setPreSharedKey(const char *pskIdent, const char *psKey);  // psKey in Hex
@@ -22,7 +22,6 @@
 #include "esp_event.h"
 #include "esp_netif.h"
 #include "esp_netif_types.h"
-#include "esp_vfs_eventfd.h"
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
@@ -228,9 +227,6 @@ extern "C" int lwip_hook_ip6_input(struct pbuf *p, struct netif *inp) {
 #endif
 
 static void ot_task_worker(void *aContext) {
-  esp_vfs_eventfd_config_t eventfd_config = {
-    .max_fds = 3,
-  };
   bool err = false;
   if (ESP_OK != esp_event_loop_create_default()) {
     log_e("Failed to create OpentThread event loop");
@@ -240,9 +236,12 @@ static void ot_task_worker(void *aContext) {
     log_e("Failed to initialize OpentThread netif");
     err = true;
   }
-  if (!err && ESP_OK != esp_vfs_eventfd_register(&eventfd_config)) {
-    log_e("Failed to register OpentThread eventfd");
-    err = true;
+  if (!err) {
+    // shared with the core event loop, registered once and never unregistered
+    if (ESP_OK != arduino_eventfd_register()) {
+      log_e("Failed to register OpentThread eventfd");
+      err = true;
+    }
   }
 
   // Initialize the OpenThread stack
@@ -633,7 +632,6 @@ void OpenThread::end() {
 
   esp_openthread_netif_glue_deinit();
   esp_openthread_deinit();
-  esp_vfs_eventfd_unregister();
   esp_event_loop_delete_default();
 
 #if CONFIG_LWIP_HOOK_IP6_INPUT_CUSTOM
@@ -23,45 +23,124 @@
 */
 
 #include "Ticker.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
 
-Ticker::Ticker() : _timer(nullptr) {}
+namespace {
+
+// The wheel of all the tickers and the esp_timer that runs it, in microseconds
+class TickerScheduler {
+public:
+  TickerScheduler() : _wheel(esp_timer_get_time()), _armed(TICKER_WHEEL_NEVER) {
+    _lock = xSemaphoreCreateMutex();
+    esp_timer_create_args_t config = {};
+    config.callback = _dispatch;
+    config.arg = this;
+    config.dispatch_method = ESP_TIMER_TASK;
+    config.name = "Ticker";
+    esp_timer_create(&config, &_timer);
+  }
+
+  void schedule(TickerWheelNode *node, uint64_t micros) {
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    _wheel.schedule(node, esp_timer_get_time() + micros);
+    _rearm();
+    xSemaphoreGive(_lock);
+  }
+
+  // Moves a scheduled node, with the period set to micros if it repeats
+  void restart(TickerWheelNode *node, uint64_t micros) {
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    if (TickerWheel::pending(node)) {
+      if (node->period) {
+        node->period = micros;
+      }
+      _wheel.schedule(node, esp_timer_get_time() + micros);
+      _rearm();
+    }
+    xSemaphoreGive(_lock);
+  }
+
+  void cancel(TickerWheelNode *node) {
+    xSemaphoreTake(_lock, portMAX_DELAY);
+    _wheel.cancel(node);
+    _rearm();
+    xSemaphoreGive(_lock);
+  }
+
+private:
+  TickerWheel _wheel;
+  uint64_t _armed;
+  SemaphoreHandle_t _lock;
+  esp_timer_handle_t _timer;
+
+  // Arms the esp_timer for the first node due, if that changed
+  void _rearm() {
+    uint64_t next = _wheel.nextExpiry();
+    if (next == _armed) {
+      return;
+    }
+    esp_timer_stop(_timer);
+    _armed = next;
+    if (next != TICKER_WHEEL_NEVER) {
+      int64_t now = esp_timer_get_time();
+      esp_timer_start_once(_timer, next > (uint64_t)now ? next - now : 0);
+    }
+  }
+
+  static void _dispatch(void *arg) {
+    TickerScheduler *self = reinterpret_cast<TickerScheduler *>(arg);
+    xSemaphoreTake(self->_lock, portMAX_DELAY);
+    self->_armed = TICKER_WHEEL_NEVER;
+    uint64_t now = esp_timer_get_time();
+    TickerWheelNode *node;
+    while ((node = self->_wheel.expire(now)) != nullptr) {
+      void (*callback)(void *) = node->callback;
+      void *callbackArg = node->arg;
+      // the callbacks may attach and detach tickers
+      xSemaphoreGive(self->_lock);
+      callback(callbackArg);
+      xSemaphoreTake(self->_lock, portMAX_DELAY);
+    }
+    self->_rearm();
+    xSemaphoreGive(self->_lock);
+  }
+};
+
+// Created on first use and never destroyed, so tickers with static storage
+// can still detach when they are destroyed
+TickerScheduler &scheduler() {
+  static TickerScheduler *instance = new TickerScheduler();
+  return *instance;
+}
+
+}  // namespace
+
+Ticker::Ticker() {}
 
 Ticker::~Ticker() {
   detach();
 }
 
 void Ticker::_attach_us(uint64_t micros, bool repeat, callback_with_arg_t callback, void *arg) {
-  esp_timer_create_args_t _timerConfig;
-  _timerConfig.arg = reinterpret_cast<void *>(arg);
-  _timerConfig.callback = callback;
-  _timerConfig.dispatch_method = ESP_TIMER_TASK;
-  _timerConfig.name = "Ticker";
-  if (_timer) {
-    esp_timer_stop(_timer);
-    esp_timer_delete(_timer);
-  }
-  esp_timer_create(&_timerConfig, &_timer);
-  if (repeat) {
-    esp_timer_start_periodic(_timer, micros);
-  } else {
-    esp_timer_start_once(_timer, micros);
-  }
+  _node.callback = callback;
+  _node.arg = arg;
+  _node.period = repeat ? micros : 0;
+  scheduler().schedule(&_node, micros);
 }
 
 void Ticker::detach() {
-  if (_timer) {
-    esp_timer_stop(_timer);
-    esp_timer_delete(_timer);
-    _timer = nullptr;
-    _callback_function = nullptr;
-  }
+  // under the lock, a periodic node is briefly out of the wheel while it is rescheduled
+  scheduler().cancel(&_node);
+  _callback_function = nullptr;
 }
 
 bool Ticker::active() const {
-  if (!_timer) {
-    return false;
-  }
-  return esp_timer_is_active(_timer);
+  return TickerWheel::pending(&_node);
+}
+
+void Ticker::coalesce_us(uint32_t micros) {
+  _node.slack = micros;
 }
 
 void Ticker::_static_callback(void *arg) {
@@ -72,19 +151,13 @@ void Ticker::_static_callback(void *arg) {
 }
 
 void Ticker::restart(float seconds) {
-  if (active()) {
-    esp_timer_restart(_timer, 1000000ULL * seconds);
-  }
+  scheduler().restart(&_node, 1000000ULL * seconds);
 }
 
 void Ticker::restart_ms(uint64_t milliseconds) {
-  if (active()) {
-    esp_timer_restart(_timer, 1000ULL * milliseconds);
-  }
+  scheduler().restart(&_node, 1000ULL * milliseconds);
 }
 
 void Ticker::restart_us(uint64_t micros) {
-  if (active()) {
-    esp_timer_restart(_timer, micros);
-  }
+  scheduler().restart(&_node, micros);
 }
@@ -29,6 +29,13 @@ extern "C" {
 #include "esp_timer.h"
 }
 #include <functional>
+#include "TickerWheel.h"
+
+/*
+ * All the tickers share one esp_timer: they are kept in a timer wheel (see
+ * TickerWheel.h) and the esp_timer is armed for the first one due. The
+ * callbacks run from the esp_timer task, one after the other.
+ */
 
 class Ticker {
 public:
@@ -130,6 +137,13 @@ public:
   void restart_ms(uint64_t milliseconds);
   void restart_us(uint64_t micros);
 
+  // Let the callback run up to this much late, so that tickers due close
+  // together share one wakeup. Applies from the next attach, once or restart.
+  void coalesce_ms(uint32_t milliseconds) {
+    coalesce_us(1000UL * milliseconds);
+  }
+  void coalesce_us(uint32_t micros);
+
   void detach();
   bool active() const;
 
@@ -138,7 +152,7 @@ protected:
 
   callback_function_t _callback_function = nullptr;
 
-  esp_timer_handle_t _timer;
+  TickerWheelNode _node;
 
 private:
   void _attach_us(uint64_t micros, bool repeat, callback_with_arg_t callback, void *arg);
@@ -0,0 +1,199 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "TickerWheel.h"
+
+#include <string.h>
+
+// marks a node that is on the due list instead of a slot
+#define DUE_LEVEL TICKER_WHEEL_LEVELS
+
+static inline uint64_t rotateRight(uint64_t bits, unsigned n) {
+  n &= 63;
+  return n ? (bits >> n) | (bits << (64 - n)) : bits;
+}
+
+// The tick in [deadline, deadline + slack] with the most trailing zero bits
+static uint64_t applySlack(uint64_t deadline, uint32_t slack) {
+  if (slack == 0 || deadline > UINT64_MAX - slack) {
+    return deadline;
+  }
+  uint64_t limit = deadline + slack;
+  // the highest bit that differs is set in limit and clear in deadline
+  unsigned bit = 63 - __builtin_clzll(deadline ^ limit);
+  return limit & ~((1ULL << bit) - 1);
+}
+
+TickerWheel::TickerWheel(uint64_t now) : _now(now), _count(0), _due(nullptr) {
+  memset(_occupied, 0, sizeof(_occupied));
+  memset(_slots, 0, sizeof(_slots));
+}
+
+void TickerWheel::push(TickerWheelNode **head, TickerWheelNode *node) {
+  node->next = *head;
+  if (*head) {
+    (*head)->pprev = &node->next;
+  }
+  *head = node;
+  node->pprev = head;
+}
+
+void TickerWheel::unlink(TickerWheelNode *node) {
+  *node->pprev = node->next;
+  if (node->next) {
+    node->next->pprev = node->pprev;
+  }
+  if (node->level < TICKER_WHEEL_LEVELS && _slots[node->level][node->slot] == nullptr) {
+    _occupied[node->level] &= ~(1ULL << node->slot);
+  }
+  node->next = nullptr;
+  node->pprev = nullptr;
+}
+
+void TickerWheel::place(TickerWheelNode *node) {
+  if (node->expires < _now) {
+    // the tick has been processed already
+    node->level = DUE_LEVEL;
+    push(&_due, node);
+    return;
+  }
+  uint64_t expires = node->expires;
+  uint64_t delta = expires - _now;
+  if (delta > TICKER_WHEEL_MAX_DELTA) {
+    delta = TICKER_WHEEL_MAX_DELTA;
+    expires = _now + delta;
+  }
+  uint8_t level = delta ? (63 - __builtin_clzll(delta)) / TICKER_WHEEL_SLOT_BITS : 0;
+  uint8_t slot = (expires >> (level * TICKER_WHEEL_SLOT_BITS)) & (TICKER_WHEEL_SLOTS - 1);
+  node->level = level;
+  node->slot = slot;
+  push(&_slots[level][slot], node);
+  _occupied[level] |= 1ULL << slot;
+}
+
+void TickerWheel::schedule(TickerWheelNode *node, uint64_t deadline) {
+  if (pending(node)) {
+    unlink(node);
+    _count--;
+  }
+  node->deadline = deadline;
+  node->expires = applySlack(deadline, node->slack);
+  place(node);
+  _count++;
+}
+
+void TickerWheel::cancel(TickerWheelNode *node) {
+  if (pending(node)) {
+    unlink(node);
+    _count--;
+  }
+}
+
+// Moves the slot of the level that comes up at _now down the wheel
+void TickerWheel::cascade(uint8_t level) {
+  uint8_t slot = (_now >> (level * TICKER_WHEEL_SLOT_BITS)) & (TICKER_WHEEL_SLOTS - 1);
+  TickerWheelNode *node = _slots[level][slot];
+  _slots[level][slot] = nullptr;
+  _occupied[level] &= ~(1ULL << slot);
+  while (node) {
+    TickerWheelNode *next = node->next;
+    place(node);
+    node = next;
+  }
+}
+
+// Turn of the level (time >> shift) at which its first occupied slot comes up
+uint64_t TickerWheel::firstTurn(uint8_t level) const {
+  unsigned shift = level * TICKER_WHEEL_SLOT_BITS;
+  uint64_t base = _now >> shift;
+  // bit k is the slot k turns after the current one
+  uint64_t bits = rotateRight(_occupied[level], base);
+  // past its tick the current slot of a higher level only holds the next turn
+  if (level && (_now & ((1ULL << shift) - 1)) && (bits & 1)) {
+    bits &= ~1ULL;
+    return base + (bits ? __builtin_ctzll(bits) : TICKER_WHEEL_SLOTS);
+  }
+  return base + __builtin_ctzll(bits);
+}
+
+// The next tick with a level 0 slot to run or a higher slot to cascade
+uint64_t TickerWheel::nextEvent() const {
+  uint64_t next = TICKER_WHEEL_NEVER;
+  for (uint8_t level = 0; level < TICKER_WHEEL_LEVELS; level++) {
+    if (_occupied[level]) {
+      uint64_t t = firstTurn(level) << (level * TICKER_WHEEL_SLOT_BITS);
+      if (t < next) {
+        next = t;
+      }
+    }
+  }
+  return next;
+}
+
+TickerWheelNode *TickerWheel::expire(uint64_t now) {
+  while (_due == nullptr && _now <= now) {
+    uint64_t t = nextEvent();
+    if (t > now) {
+      _now = now + 1;
+      break;
+    }
+    _now = t;
+    for (uint8_t level = 1; level < TICKER_WHEEL_LEVELS && (_now & ((1ULL << (level * TICKER_WHEEL_SLOT_BITS)) - 1)) == 0; level++) {
+      cascade(level);
+    }
+    uint8_t slot = _now & (TICKER_WHEEL_SLOTS - 1);
+    TickerWheelNode *node = _slots[0][slot];
+    _slots[0][slot] = nullptr;
+    _occupied[0] &= ~(1ULL << slot);
+    while (node) {
+      TickerWheelNode *next = node->next;
+      if (node->expires > _now) {
+        // parked beyond the reach of the wheel
+        place(node);
+      } else {
+        node->level = DUE_LEVEL;
+        push(&_due, node);
+      }
+      node = next;
+    }
+    _now++;
+  }
+  TickerWheelNode *node = _due;
+  if (node == nullptr) {
+    return nullptr;
+  }
+  unlink(node);
+  _count--;
+  if (node->period) {
+    schedule(node, node->deadline + node->period);
+  }
+  return node;
+}
+
+uint64_t TickerWheel::nextExpiry() const {
+  uint64_t next = TICKER_WHEEL_NEVER;
+  for (const TickerWheelNode *node = _due; node; node = node->next) {
+    if (node->expires < next) {
+      next = node->expires;
+    }
+  }
+  if (next != TICKER_WHEEL_NEVER) {
+    return next;
+  }
+  for (uint8_t level = 0; level < TICKER_WHEEL_LEVELS; level++) {
+    if (_occupied[level] == 0) {
+      continue;
+    }
+    // the first slot in turn holds the earliest nodes of the level
+    uint8_t slot = firstTurn(level) & (TICKER_WHEEL_SLOTS - 1);
+    for (const TickerWheelNode *node = _slots[level][slot]; node; node = node->next) {
+      if (node->expires < next) {
+        next = node->expires;
+      }
+    }
+  }
+  return next;
+}
@@ -0,0 +1,90 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * Hierarchical timer wheel.
+ *
+ * Timers are intrusive nodes kept in TICKER_WHEEL_LEVELS wheels of 64 slots,
+ * level n holding the timers due between 64^n and 64^(n+1) ticks from now.
+ * schedule() and cancel() are O(1); when the time reaches a slot of a higher
+ * level its timers are moved down (cascaded), so every timer still fires on
+ * its exact tick. The wheel keeps no clock of its own: expire() is given the
+ * current time and nextExpiry() tells when it has to be called next, so one
+ * hardware or esp_timer alarm can drive any number of timers, and the tests
+ * drive it with a simulated clock.
+ *
+ * A node may carry a slack: it can then fire anywhere up to slack ticks
+ * late, and is placed on the tick within that window with the most trailing
+ * zero bits, so timers with overlapping windows land on the same tick and
+ * fire in the same wakeup.
+ *
+ * The wheel does no locking.
+ */
+
+#define TICKER_WHEEL_LEVELS    8
+#define TICKER_WHEEL_SLOT_BITS 6
+#define TICKER_WHEEL_SLOTS     (1 << TICKER_WHEEL_SLOT_BITS)
+#define TICKER_WHEEL_NEVER     UINT64_MAX
+// timers further away are parked on the last level and placed again when they come up
+#define TICKER_WHEEL_MAX_DELTA ((1ULL << (TICKER_WHEEL_LEVELS * TICKER_WHEEL_SLOT_BITS)) - 1)
+
+struct TickerWheelNode {
+  TickerWheelNode *next = nullptr;
+  TickerWheelNode **pprev = nullptr;  // the pointer to this node, nullptr when not scheduled
+  uint64_t deadline = 0;              // requested tick, the next period counts from here
+  uint64_t expires = 0;               // tick it fires on, deadline plus the slack used
+  uint64_t period = 0;                // 0 for a one shot timer
+  uint32_t slack = 0;                 // ticks the timer may fire late
+  uint8_t level = 0;
+  uint8_t slot = 0;
+  void (*callback)(void *arg) = nullptr;
+  void *arg = nullptr;
+};
+
+class TickerWheel {
+public:
+  TickerWheel(uint64_t now = 0);
+
+  // Fires the node at the given tick (at once if that has passed), then every
+  // node->period ticks if that is set. A scheduled node is moved.
+  void schedule(TickerWheelNode *node, uint64_t deadline);
+  void cancel(TickerWheelNode *node);
+  static bool pending(const TickerWheelNode *node) {
+    return node->pprev != nullptr;
+  }
+
+  // Takes the next node due at or before now out of the wheel and returns it,
+  // periodic nodes are scheduled again first. nullptr when none is due.
+  TickerWheelNode *expire(uint64_t now);
+
+  // First tick a node is due on, TICKER_WHEEL_NEVER when there is none
+  uint64_t nextExpiry() const;
+
+  size_t size() const {
+    return _count;
+  }
+
+private:
+  // next tick expire() has not processed yet
+  uint64_t _now;
+  size_t _count;
+  uint64_t _occupied[TICKER_WHEEL_LEVELS];
+  TickerWheelNode *_slots[TICKER_WHEEL_LEVELS][TICKER_WHEEL_SLOTS];
+  // nodes taken from a slot and not returned by expire() yet
+  TickerWheelNode *_due;
+
+  void place(TickerWheelNode *node);
+  void unlink(TickerWheelNode *node);
+  void push(TickerWheelNode **head, TickerWheelNode *node);
+  void cascade(uint8_t level);
+  uint64_t firstTurn(uint8_t level) const;
+  uint64_t nextEvent() const;
+};
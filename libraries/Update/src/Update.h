@@ -16,6 +16,7 @@
 #include <functional>
 #include "esp_partition.h"
 #ifdef UPDATE_SIGN
+#include <MultiHashBuilder.h>
 #include "Updater_Signing.h"
 #endif /* UPDATE_SIGN */
 
@@ -119,8 +120,10 @@ public:
   /**
    * @brief Write remaining bytes from a `Stream` to the update target
    *
-   * Uses `readBytes()` and will set `UPDATE_ERROR_STREAM` on timeout.
-   * Suitable for slow sources such as `Serial`.
+   * Moves the data with `Stream::sendSize()`, straight into the sector
+   * buffer, and sets `UPDATE_ERROR_STREAM` when no data arrives for 30
+   * seconds or the stream ends early. Suitable for slow sources such as
+   * `Serial`.
    *
    * @param data Stream to read from
    * @return Number of bytes written
@@ -324,6 +327,8 @@ public:
   bool rollBack();
 
 private:
+  class StreamSink;
+
   void _reset();
   void _abort(uint8_t err);
 #ifndef UPDATE_NOCRYPT
@@ -367,6 +372,7 @@ private:
 
 #ifdef UPDATE_SIGN
   SHA2Builder *_hash;
+  MultiHashBuilder _digests;  // _md5 and _hash, fed together
   UpdaterVerifyClass *_sign;
   uint8_t *_signatureBuffer;
   size_t _signatureSize;
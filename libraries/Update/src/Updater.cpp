@@ -210,6 +210,9 @@ bool UpdateClass::begin(size_t size, int command, int ledPin, uint8_t ledOn, con
 
     if (_hash) {
       _hash->begin();
+      _digests.clear();
+      _digests.addBuilder(&_md5);
+      _digests.addBuilder(_hash);
       log_i("Signature hash initialized");
     } else {
       log_e("Failed to create hash builder");
@@ -681,29 +684,38 @@ bool UpdateClass::_writeBuffer() {
     _buffer[0] = ESP_IMAGE_HEADER_MAGIC;
   }
 #ifndef UPDATE_NOCRYPT
-  if (_target_md5_decrypted) {
-#endif /* UPDATE_NOCRYPT */
-    _md5.add(_buffer, _bufferLen);
-#ifndef UPDATE_NOCRYPT
-  }
+  bool addMd5 = _target_md5_decrypted;
+#else
+  bool addMd5 = true;
 #endif /* UPDATE_NOCRYPT */
 
 #ifdef UPDATE_SIGN
   // Add data to signature hash if signature verification is enabled
   // Only hash firmware bytes, not the signature bytes at the end
+  size_t bytesToHash = 0;
   if (_hash && _signatureSize > 0) {
     size_t firmwareSize = _size - _signatureSize;
     if (_progress < firmwareSize) {
       // Calculate how many bytes of this buffer are firmware (not signature)
-      size_t bytesToHash = _bufferLen;
+      bytesToHash = _bufferLen;
       if (_progress + _bufferLen > firmwareSize) {
         bytesToHash = firmwareSize - _progress;
       }
-      _hash->add(_buffer, bytesToHash);
     }
   }
+  if (addMd5 && bytesToHash == _bufferLen) {
+    // MD5 and signature hash in one pass over the buffer
+    _digests.add(_buffer, _bufferLen);
+    addMd5 = false;
+  } else if (bytesToHash) {
+    _hash->add(_buffer, bytesToHash);
+  }
 #endif /* UPDATE_SIGN */
 
+  if (addMd5) {
+    _md5.add(_buffer, _bufferLen);
+  }
+
   _progress += _bufferLen;
   _bufferLen = 0;
   if (_progress_callback) {
@@ -860,11 +872,61 @@ size_t UpdateClass::write(uint8_t *data, size_t len) {
   return len;
 }
 
-size_t UpdateClass::writeStream(Stream &data) {
-  size_t written = 0;
-  size_t toRead = 0;
-  int timeout_failures = 0;
+// Lends the free part of the sector buffer to Stream::sendSize(), so that the
+// source reads straight into it and every full sector is flashed right away
+class UpdateClass::StreamSink : public Print {
+public:
+  StreamSink(UpdateClass &update) : _update(update) {}
+
+  size_t write(uint8_t c) override {
+    return _update.write(&c, 1);
+  }
+  size_t write(const uint8_t *buffer, size_t size) override {
+    size_t written = _update.write((uint8_t *)buffer, size);
+    if (written < size) {
+      setWriteError();
+    }
+    _yield();
+    return written;
+  }
+  uint8_t *writeBuffer(size_t &room) override {
+    if (_update.hasError() || !_update.isRunning()) {
+      room = 0;
+      return nullptr;
+    }
+    room = SPI_FLASH_SEC_SIZE - _update._bufferLen;
+    if (room > _update.remaining() - _update._bufferLen) {
+      room = _update.remaining() - _update._bufferLen;
+    }
+    if (_update._ledPin != -1) {
+      digitalWrite(_update._ledPin, _update._ledOn);  // Switch LED on
+    }
+    return _update._buffer + _update._bufferLen;
+  }
+  bool writeCommit(size_t size) override {
+    if (_update._ledPin != -1) {
+      digitalWrite(_update._ledPin, !_update._ledOn);  // Switch LED off
+    }
+    _update._bufferLen += size;
+    if ((_update._bufferLen == _update.remaining() || _update._bufferLen == SPI_FLASH_SEC_SIZE) && !_update._writeBuffer()) {
+      setWriteError();
+      return false;
+    }
+    _yield();
+    return true;
+  }
+
+private:
+  void _yield() {
+#if CONFIG_FREERTOS_UNICORE
+    delay(1);  // Fix solo WDT
+#endif
+  }
 
+  UpdateClass &_update;
+};
+
+size_t UpdateClass::writeStream(Stream &data) {
   if (hasError() || !isRunning()) {
     return 0;
   }
@@ -884,45 +946,11 @@ size_t UpdateClass::writeStream(Stream &data) {
     pinMode(_ledPin, OUTPUT);
   }
 
-  while (remaining()) {
-    if (_ledPin != -1) {
-      digitalWrite(_ledPin, _ledOn);  // Switch LED on
-    }
-    size_t bytesToRead = SPI_FLASH_SEC_SIZE - _bufferLen;
-    if (bytesToRead > remaining()) {
-      bytesToRead = remaining();
-    }
-
-    /*
-        Init read&timeout counters and try to read, if read failed, increase counter,
-        wait 100ms and try to read again. If counter > 300 (30 sec), give up/abort
-        */
-    toRead = 0;
-    timeout_failures = 0;
-    while (!toRead) {
-      toRead = data.readBytes(_buffer + _bufferLen, bytesToRead);
-      if (toRead == 0) {
-        timeout_failures++;
-        if (timeout_failures >= 300) {
-          _abort(UPDATE_ERROR_STREAM);
-          return written;
-        }
-        delay(100);
-      }
-    }
-
-    if (_ledPin != -1) {
-      digitalWrite(_ledPin, !_ledOn);  // Switch LED off
-    }
-    _bufferLen += toRead;
-    if ((_bufferLen == remaining() || _bufferLen == SPI_FLASH_SEC_SIZE) && !_writeBuffer()) {
-      return written;
-    }
-    written += toRead;
-
-#if CONFIG_FREERTOS_UNICORE
-    delay(1);  // Fix solo WDT
-#endif
+  // give up after 30 seconds without any data, as before
+  StreamSink sink(*this);
+  size_t written = data.sendSize(sink, remaining() - _bufferLen, 30000);
+  if (!hasError() && data.getLastSendReport() != Stream::SendReport::Success) {
+    _abort(UPDATE_ERROR_STREAM);
   }
   return written;
 }
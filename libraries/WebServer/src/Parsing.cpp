@@ -41,10 +41,11 @@ static const char *_http_method_str[] = {
 static const char Content_Type[] PROGMEM = "Content-Type";
 static const char filename[] PROGMEM = "filename";
 
-static char *readBytesWithTimeout(NetworkClient &client, size_t maxLength, size_t &dataLength, int timeout_ms) {
-  char *buf = nullptr;
-  dataLength = 0;
-  while (dataLength < maxLength) {
+// Reads length bytes of a body into buf, waiting up to timeout_ms for each
+// part of it, and returns how many arrived
+static size_t readBytesWithTimeout(NetworkClient &client, char *buf, size_t length, int timeout_ms) {
+  size_t dataLength = 0;
+  while (dataLength < length) {
     int tries = timeout_ms;
     size_t newLength;
     while (!(newLength = client.available()) && tries--) {
@@ -53,316 +54,327 @@ static char *readBytesWithTimeout(NetworkClient &client, size_t maxLength, size_
     if (!newLength) {
       break;
     }
-    if (!buf) {
-      buf = (char *)malloc(newLength + 1);
-      if (!buf) {
-        return nullptr;
-      }
-    } else {
-      char *newBuf = (char *)realloc(buf, dataLength + newLength + 1);
-      if (!newBuf) {
-        free(buf);
-        return nullptr;
-      }
-      buf = newBuf;
-    }
-    client.readBytes(buf + dataLength, newLength);
-    dataLength += newLength;
-    buf[dataLength] = '\0';
+    // what follows belongs to the next request
+    newLength = std::min(newLength, length - dataLength);
+    dataLength += client.readBytes(buf + dataLength, newLength);
   }
-  return buf;
+  return dataLength;
 }
 
+// Single client mode: reads the head of the request into _head as it arrives,
+// and not a byte more, the body is read from the client. A client that does
+// not lend its buffer (TLS) is read byte by byte.
 bool WebServer::_parseRequest(NetworkClient &client) {
-  // Read the first line of HTTP request
-  String req = client.readStringUntil('\r');
-  client.readStringUntil('\n');
-  //reset header value
-  if (_collectAllHeaders) {
-    // clear previous headers
-    collectAllHeaders();
-  } else {
-    // clear previous headers
-    for (RequestArgument *header = _currentHeaders; header; header = header->next) {
-      header->value = String();
+  _parser.reset();
+  size_t length = 0;
+  unsigned long start = millis();
+  bool peek = client.hasPeekBufferAPI();
+  HTTPRequestParser::Result result = HTTPRequestParser::INCOMPLETE;
+  while (result == HTTPRequestParser::INCOMPLETE) {
+    int waiting = peek ? (int)client.peekAvailable() : client.available();
+    size_t available = waiting > 0 ? (size_t)waiting : 0;
+    if (!available) {
+      if (!client.connected() || millis() - start > (unsigned long)client.getTimeout()) {
+        log_e("Request head incomplete after %u bytes", (unsigned)length);
+        return false;
+      }
+      delay(1);
+      continue;
+    }
+    if (length == _headSize) {
+      if (_headSize == HTTP_MAX_REQUEST_WAIT_LEN) {
+        log_e("Request head over %u bytes", HTTP_MAX_REQUEST_WAIT_LEN);
+        return false;
+      }
+      size_t size = std::min(_headSize ? _headSize * 2 : 512, (size_t)HTTP_MAX_REQUEST_WAIT_LEN);
+      char *head = (char *)realloc(_head, size);
+      if (!head) {
+        log_e("No memory for the request head");
+        return false;
+      }
+      _head = head;
+      _headSize = size;
+    }
+    if (!peek) {
+      int c = client.read();
+      if (c >= 0) {
+        _head[length++] = (char)c;
+        result = _parser.parse(_head, length);
+      }
+      continue;
     }
+    size_t copied = std::min(available, _headSize - length);
+    memcpy(_head + length, client.peekBuffer(), copied);
+    result = _parser.parse(_head, length + copied);
+    client.peekConsume(result == HTTPRequestParser::COMPLETE ? _parser.headLength - length : copied);
+    length += copied;
   }
-
-  // First line of HTTP request looks like "GET /path HTTP/1.1"
-  // Retrieve the "/path" part by finding the spaces
-  int addr_start = req.indexOf(' ');
-  int addr_end = req.indexOf(' ', addr_start + 1);
-  if (addr_start == -1 || addr_end == -1) {
-    log_e("Invalid request: %s", req.c_str());
+  if (result != HTTPRequestParser::COMPLETE) {
+    log_e("Invalid request: %.*s", (int)std::min(length, (size_t)64), _head);
     return false;
   }
+  return _parseRequest(client, _head, _parser);
+}
 
-  String methodStr = req.substring(0, addr_start);
-  String url = req.substring(addr_start + 1, addr_end);
-  String versionEnd = req.substring(addr_end + 8);
-  _currentVersion = atoi(versionEnd.c_str());
-  String searchStr = "";
-  int hasSearch = url.indexOf('?');
-  if (hasSearch != -1) {
-    searchStr = url.substring(hasSearch + 1);
-    url = url.substring(0, hasSearch);
-  }
-  _currentUri = url;
+// Sets up the request from its parsed head, and reads the body from client
+bool WebServer::_parseRequest(NetworkClient &client, const char *head, const HTTPRequestParser &parser) {
+  _request.arena.reset();
+  _request.argumentCount = 0;
+  _request.arguments = nullptr;
+  _request.postArgumentCount = 0;
+  _request.postArguments = nullptr;
+  _request.head = head;
+  _request.parser = &parser;
+
+  const char *search = head + parser.query.offset;
+  size_t searchLength = parser.query.length;
+  _request.version = parser.versionMinor;
+  // HTTP/1.1 clients keep the connection unless they ask to close it,
+  // HTTP/1.0 ones have to ask to keep it
+  _request.keepAlive = _request.version > 0;
+  _request.uri = String(head + parser.path.offset, parser.path.length);
   _chunked = false;
-  _clientContentLength = 0;  // not known yet, or invalid
+  _request.clientContentLength = 0;  // not known yet, or invalid
 
   HTTPMethod method = HTTP_ANY;
   size_t num_methods = sizeof(_http_method_str) / sizeof(const char *);
   for (size_t i = 0; i < num_methods; i++) {
-    if (methodStr == _http_method_str[i]) {
+    if (strlen(_http_method_str[i]) == parser.method.length && strncmp(head + parser.method.offset, _http_method_str[i], parser.method.length) == 0) {
       method = (HTTPMethod)i;
       break;
     }
   }
   if (method == HTTP_ANY) {
-    log_e("Unknown HTTP Method: %s", methodStr.c_str());
+    log_e("Unknown HTTP Method: %.*s", parser.method.length, head + parser.method.offset);
     return false;
   }
-  _currentMethod = method;
+  _request.method = method;
 
-  log_v("method: %s url: %s search: %s", methodStr.c_str(), url.c_str(), searchStr.c_str());
+  log_v("method: %s url: %s search: %.*s", _http_method_str[method], _request.uri.c_str(), (int)searchLength, search);
+
+  _collectHeaders(head, parser);
 
   //attach handler
-  RequestHandler *handler;
-  for (handler = _firstHandler; handler; handler = handler->next()) {
-    if (handler->canHandle(*this, _currentMethod, _currentUri)) {
-      break;
+  _request.handler = _router.find(*this, _firstHandler, _request.method, _request.uri);
+
+  int connection = parser.find(head, "Connection");
+  if (connection >= 0) {
+    HTTPRequestParser::Span value = parser.headers[connection].value;
+    if (HTTPRequestParser::contains(head, value, "close")) {
+      _request.keepAlive = false;
+    } else if (HTTPRequestParser::contains(head, value, "keep-alive")) {
+      _request.keepAlive = true;
     }
   }
-  _currentHandler = handler;
+  if (parser.find(head, "Transfer-Encoding") >= 0) {
+    // a chunked body is not parsed, the next request could not be found
+    _request.keepAlive = false;
+  }
+  if (parser.contentLength > 0) {
+    _request.clientContentLength = parser.contentLength;
+  }
 
-  String formData;
   // below is needed only when POST type request
   if (method == HTTP_POST || method == HTTP_PUT || method == HTTP_PATCH || method == HTTP_DELETE) {
     String boundaryStr;
-    String headerName;
-    String headerValue;
     bool isForm = false;
     bool isEncoded = false;
-    //parse headers
-    while (1) {
-      req = client.readStringUntil('\r');
-      client.readStringUntil('\n');
-      if (req == "") {
-        break;  //no moar headers
-      }
-      int headerDiv = req.indexOf(':');
-      if (headerDiv == -1) {
-        break;
-      }
-      headerName = req.substring(0, headerDiv);
-      headerValue = req.substring(headerDiv + 1);
-      headerValue.trim();
-      _collectHeader(headerName.c_str(), headerValue.c_str());
-
-      if (headerName.equalsIgnoreCase(FPSTR(Content_Type))) {
-        using namespace mime;
-        if (headerValue.startsWith(FPSTR(mimeTable[txt].mimeType))) {
-          isForm = false;
-        } else if (headerValue.startsWith(F("application/x-www-form-urlencoded"))) {
-          isForm = false;
-          isEncoded = true;
-        } else if (headerValue.startsWith(F("multipart/"))) {
-          boundaryStr = headerValue.substring(headerValue.indexOf('=') + 1);
-          boundaryStr.replace("\"", "");
-          if (boundaryStr.length() > 70) {  // RFC 2046: max boundary length is 70
-            log_e("Invalid boundary length: %s", boundaryStr.c_str());
-            return false;
-          }
-          isForm = true;
+    int contentType = parser.find(head, Content_Type);
+    if (contentType >= 0) {
+      HTTPRequestParser::Span value = parser.headers[contentType].value;
+      using namespace mime;
+      if (HTTPRequestParser::startsWith(head, value, mimeTable[txt].mimeType)) {
+        isForm = false;
+      } else if (HTTPRequestParser::startsWith(head, value, "application/x-www-form-urlencoded")) {
+        isForm = false;
+        isEncoded = true;
+      } else if (HTTPRequestParser::startsWith(head, value, "multipart/")) {
+        String headerValue(head + value.offset, value.length);
+        boundaryStr = headerValue.substring(headerValue.indexOf('=') + 1);
+        boundaryStr.replace("\"", "");
+        if (boundaryStr.length() > 70) {  // RFC 2046: max boundary length is 70
+          log_e("Invalid boundary length: %s", boundaryStr.c_str());
+          return false;
         }
-      } else if (headerName.equalsIgnoreCase(F("Content-Length"))) {
-        _clientContentLength = headerValue.toInt();
-      } else if (headerName.equalsIgnoreCase(F("Host"))) {
-        _hostHeader = headerValue;
+        isForm = true;
       }
     }
 
-    if (!isForm && _currentHandler && _currentHandler->canRaw(*this, _currentUri)) {
+    if (!isForm && _request.handler && _request.handler->canRaw(*this, _request.uri)) {
       log_v("Parse raw");
-      _currentRaw.reset(new HTTPRaw());
-      _currentRaw->status = RAW_START;
-      _currentRaw->totalSize = 0;
-      _currentRaw->currentSize = 0;
+      _request.raw.reset(new HTTPRaw());
+      _request.raw->status = RAW_START;
+      _request.raw->totalSize = 0;
+      _request.raw->currentSize = 0;
       log_v("Start Raw");
-      _currentHandler->raw(*this, _currentUri, *_currentRaw);
-      _currentRaw->status = RAW_WRITE;
-
-      while (_currentRaw->totalSize < (size_t)_clientContentLength) {
-        size_t read_len = std::min((size_t)_clientContentLength - _currentRaw->totalSize, (size_t)HTTP_RAW_BUFLEN);
-        _currentRaw->currentSize = client.readBytes(_currentRaw->buf, read_len);
-        _currentRaw->totalSize += _currentRaw->currentSize;
-        if (_currentRaw->currentSize == 0) {
-          _currentRaw->status = RAW_ABORTED;
-          _currentHandler->raw(*this, _currentUri, *_currentRaw);
+      _request.handler->raw(*this, _request.uri, *_request.raw);
+      _request.raw->status = RAW_WRITE;
+
+      while (_request.raw->totalSize < (size_t)_request.clientContentLength) {
+        size_t read_len = std::min((size_t)_request.clientContentLength - _request.raw->totalSize, (size_t)HTTP_RAW_BUFLEN);
+        _request.raw->currentSize = client.readBytes(_request.raw->buf, read_len);
+        _request.raw->totalSize += _request.raw->currentSize;
+        if (_request.raw->currentSize == 0) {
+          _request.raw->status = RAW_ABORTED;
+          _request.handler->raw(*this, _request.uri, *_request.raw);
           return false;
         }
-        _currentHandler->raw(*this, _currentUri, *_currentRaw);
+        _request.handler->raw(*this, _request.uri, *_request.raw);
       }
-      _currentRaw->status = RAW_END;
-      _currentHandler->raw(*this, _currentUri, *_currentRaw);
+      _request.raw->status = RAW_END;
+      _request.handler->raw(*this, _request.uri, *_request.raw);
       log_v("Finish Raw");
     } else if (!isForm) {
-      size_t plainLength;
-      char *plainBuf = readBytesWithTimeout(client, _clientContentLength, plainLength, HTTP_MAX_POST_WAIT);
-      if (plainLength < (size_t)_clientContentLength) {
-        free(plainBuf);
-        return false;
-      }
-      if (_clientContentLength > 0) {
+      size_t plainLength = _request.clientContentLength;
+      if (plainLength > 0) {
+        // the arena holds the body, with the query in front of an encoded form
+        char *plainBuf = (char *)_request.arena.alloc(searchLength + 1 + plainLength + 1);
+        if (!plainBuf) {
+          log_e("No memory for a body of %u bytes", (unsigned)plainLength);
+          return false;
+        }
+        char *body = plainBuf + searchLength + 1;
+        // the multi client mode gives the client a shorter timeout
+        if (readBytesWithTimeout(client, body, plainLength, std::min((unsigned long)HTTP_MAX_POST_WAIT, client.getTimeout())) < plainLength) {
+          return false;
+        }
+        body[plainLength] = '\0';
         if (isEncoded) {
           //url encoded form
-          if (searchStr != "") {
-            searchStr += '&';
+          if (searchLength) {
+            memcpy(plainBuf, search, searchLength);
+            plainBuf[searchLength] = '&';
+            _parseArguments(plainBuf, searchLength + 1 + plainLength);
+          } else {
+            _parseArguments(body, plainLength);
           }
-          searchStr += plainBuf;
-        }
-        _parseArguments(searchStr);
-        if (!isEncoded) {
+        } else {
+          _parseArguments(search, searchLength);
           //plain post json or other data
-          RequestArgument &arg = _currentArgs[_currentArgCount++];
-          arg.key = F("plain");
-          arg.value = String(plainBuf);
+          if (_request.arguments) {
+            RequestContext::Argument &arg = _request.arguments[_request.argumentCount++];
+            arg.key = "plain";
+            arg.value = body;
+            arg.valueLength = plainLength;
+          }
         }
 
-        log_v("Plain: %s", plainBuf);
-        free(plainBuf);
+        log_v("Plain: %s", body);
       } else {
         // No content - but we can still have arguments in the URL.
-        _parseArguments(searchStr);
+        _parseArguments(search, searchLength);
       }
     } else {
       // it IS a form
-      _parseArguments(searchStr);
-      if (!_parseForm(client, boundaryStr, _clientContentLength)) {
+      _parseArguments(search, searchLength);
+      if (!_parseForm(client, boundaryStr, _request.clientContentLength)) {
         return false;
       }
     }
   } else {
-    String headerName;
-    String headerValue;
-    //parse headers
-    while (1) {
-      req = client.readStringUntil('\r');
-      client.readStringUntil('\n');
-      if (req == "") {
-        break;  //no moar headers
-      }
-      int headerDiv = req.indexOf(':');
-      if (headerDiv == -1) {
-        break;
-      }
-      headerName = req.substring(0, headerDiv);
-      headerValue = req.substring(headerDiv + 2);
-      _collectHeader(headerName.c_str(), headerValue.c_str());
-
-      if (headerName.equalsIgnoreCase("Host")) {
-        _hostHeader = headerValue;
-      }
+    if (parser.contentLength > 0) {
+      // a body is not read here, the next request would start in it
+      _request.keepAlive = false;
     }
-    _parseArguments(searchStr);
+    _parseArguments(search, searchLength);
   }
-  client.clear();
 
-  log_v("Request: %s", url.c_str());
-  log_v(" Arguments: %s", searchStr.c_str());
+  log_v("Request: %s", _request.uri.c_str());
+  log_v(" Arguments: %.*s", (int)searchLength, search);
 
   return true;
 }
 
-bool WebServer::_collectHeader(const char *headerName, const char *headerValue) {
-  RequestArgument *last = nullptr;
-  for (RequestArgument *header = _currentHeaders; header; header = header->next) {
-    if (header->next == nullptr) {
-      last = header;
+// Points the collected header names at the headers of the request
+void WebServer::_collectHeaders(const char *head, const HTTPRequestParser &parser) {
+  int count = _request.headerKeyCount + (_collectAllHeaders ? parser.headerCount : 0);
+  _request.headerCount = 0;
+  _request.headerIndex = (uint8_t *)_request.arena.alloc(count);
+  if (!_request.headerIndex) {
+    log_e("No memory for %d headers", count);
+    return;
+  }
+  for (int i = 0; i < _request.headerKeyCount; i++) {
+    int header = parser.find(head, _request.headerKeys[i].c_str());
+    _request.headerIndex[_request.headerCount++] = header < 0 ? 255 : header;
+  }
+  if (!_collectAllHeaders) {
+    return;
+  }
+  for (uint8_t i = 0; i < parser.headerCount; i++) {
+    HTTPRequestParser::Span name = parser.headers[i].name;
+    bool collected = false;
+    for (int j = 0; j < _request.headerKeyCount && !collected; j++) {
+      collected = HTTPRequestParser::equals(head, name, _request.headerKeys[j].c_str());
     }
-    if (header->key.equalsIgnoreCase(headerName)) {
-      header->value = headerValue;
-      log_v("header collected: %s: %s", headerName, headerValue);
-      return true;
+    // a repeated header is collected once, with its last value
+    for (uint8_t j = i + 1; j < parser.headerCount && !collected; j++) {
+      HTTPRequestParser::Span other = parser.headers[j].name;
+      collected = other.length == name.length && strncasecmp(head + other.offset, head + name.offset, name.length) == 0;
+    }
+    if (!collected) {
+      _request.headerIndex[_request.headerCount++] = i;
     }
   }
-  assert(last);
-  if (_collectAllHeaders) {
-    last->next = new RequestArgument();
-    last->next->key = headerName;
-    last->next->value = headerValue;
-    _headerKeysCount++;
-    log_v("header collected: %s: %s", headerName, headerValue);
-    return true;
-  }
-
-  log_v("header skipped: %s: %s", headerName, headerValue);
-
-  return false;
 }
 
-void WebServer::_parseArguments(const String &data) {
-  log_v("args: %s", data.c_str());
-  if (_currentArgs) {
-    delete[] _currentArgs;
+// Decodes the arguments of a query or of an encoded form into the arena
+void WebServer::_parseArguments(const char *data, size_t length) {
+  log_v("args: %.*s", (int)length, data);
+  _request.argumentCount = 0;
+  int count = length ? 1 : 0;
+  for (size_t i = 0; i < length; i++) {
+    if (data[i] == '&') {
+      count++;
+    }
   }
-  _currentArgs = 0;
-  if (data.length() == 0) {
-    _currentArgCount = 0;
-    _currentArgs = new RequestArgument[1];
+  log_v("args count: %d", count);
+
+  // one more for the "plain" argument of a body
+  _request.arguments = (RequestContext::Argument *)_request.arena.alloc((count + 1) * sizeof(RequestContext::Argument));
+  if (!_request.arguments) {
+    log_e("No memory for %d arguments", count);
     return;
   }
-  _currentArgCount = 1;
-
-  for (int i = 0; i < (int)data.length();) {
-    i = data.indexOf('&', i);
-    if (i == -1) {
-      break;
+  const char *end = data + length;
+  for (const char *pos = data; pos < end;) {
+    const char *next = (const char *)memchr(pos, '&', end - pos);
+    if (!next) {
+      next = end;
     }
-    ++i;
-    ++_currentArgCount;
-  }
-  log_v("args count: %d", _currentArgCount);
-
-  _currentArgs = new RequestArgument[_currentArgCount + 1];
-  int pos = 0;
-  int iarg;
-  for (iarg = 0; iarg < _currentArgCount;) {
-    int equal_sign_index = data.indexOf('=', pos);
-    int next_arg_index = data.indexOf('&', pos);
-    log_v("pos %d =@%d &@%d", pos, equal_sign_index, next_arg_index);
-    if ((equal_sign_index == -1) || ((equal_sign_index > next_arg_index) && (next_arg_index != -1))) {
-      log_e("arg missing value: %d", iarg);
-      if (next_arg_index == -1) {
-        break;
+    const char *equal = (const char *)memchr(pos, '=', next - pos);
+    if (!equal) {
+      log_e("arg missing value: %d", _request.argumentCount);
+    } else {
+      char *key = (char *)_request.arena.alloc(equal - pos + 1);
+      char *value = (char *)_request.arena.alloc(next - equal);
+      if (!key || !value) {
+        log_e("No memory for the arguments");
+        return;
       }
-      pos = next_arg_index + 1;
-      continue;
-    }
-    RequestArgument &arg = _currentArgs[iarg];
-    arg.key = urlDecode(data.substring(pos, equal_sign_index));
-    arg.value = urlDecode(data.substring(equal_sign_index + 1, next_arg_index));
-    log_v("arg %d key: %s value: %s", iarg, arg.key.c_str(), arg.value.c_str());
-    ++iarg;
-    if (next_arg_index == -1) {
-      break;
+      key[requestUrlDecode(key, pos, equal - pos)] = '\0';
+      size_t valueLength = requestUrlDecode(value, equal + 1, next - equal - 1);
+      value[valueLength] = '\0';
+      RequestContext::Argument &arg = _request.arguments[_request.argumentCount++];
+      arg.key = key;
+      arg.value = value;
+      arg.valueLength = valueLength;
+      log_v("arg %d key: %s value: %s", _request.argumentCount - 1, key, value);
     }
-    pos = next_arg_index + 1;
+    pos = next + 1;
   }
-  _currentArgCount = iarg;
-  log_v("args count: %d", _currentArgCount);
+  log_v("args count: %d", _request.argumentCount);
 }
 
 void WebServer::_uploadWriteByte(uint8_t b) {
-  if (_currentUpload->currentSize == HTTP_UPLOAD_BUFLEN) {
-    if (_currentHandler && _currentHandler->canUpload(*this, _currentUri)) {
-      _currentHandler->upload(*this, _currentUri, *_currentUpload);
+  if (_request.upload->currentSize == HTTP_UPLOAD_BUFLEN) {
+    if (_request.handler && _request.handler->canUpload(*this, _request.uri)) {
+      _request.handler->upload(*this, _request.uri, *_request.upload);
     }
-    _currentUpload->totalSize += _currentUpload->currentSize;
-    _currentUpload->currentSize = 0;
+    _request.upload->totalSize += _request.upload->currentSize;
+    _request.upload->currentSize = 0;
   }
-  _currentUpload->buf[_currentUpload->currentSize++] = b;
+  _request.upload->buf[_request.upload->currentSize++] = b;
 }
 
 int WebServer::_uploadReadByte(NetworkClient &client) {
@@ -422,11 +434,12 @@ bool WebServer::_parseForm(NetworkClient &client, const String &boundary, uint32
   client.readStringUntil('\n');
   //start reading the form
   if (line == ("--" + boundary)) {
-    if (_postArgs) {
-      delete[] _postArgs;
+    _request.postArguments = (RequestContext::Argument *)_request.arena.alloc(WEBSERVER_MAX_POST_ARGS * sizeof(RequestContext::Argument));
+    _request.postArgumentCount = 0;
+    if (!_request.postArguments) {
+      log_e("No memory for the PostArgs");
+      return false;
     }
-    _postArgs = new RequestArgument[WEBSERVER_MAX_POST_ARGS];
-    _postArgsLen = 0;
     while (1) {
       String argName;
       String argValue;
@@ -481,30 +494,35 @@ bool WebServer::_parseForm(NetworkClient &client, const String &boundary, uint32
             }
             log_v("PostArg Value: %s", argValue.c_str());
 
-            RequestArgument &arg = _postArgs[_postArgsLen++];
-            arg.key = argName;
-            arg.value = argValue;
+            RequestContext::Argument &arg = _request.postArguments[_request.postArgumentCount++];
+            arg.key = _request.arena.copy(argName.c_str(), argName.length());
+            arg.value = _request.arena.copy(argValue.c_str(), argValue.length());
+            arg.valueLength = argValue.length();
+            if (!arg.key || !arg.value) {
+              log_e("No memory for the PostArgs");
+              return false;
+            }
 
             if (line == ("--" + boundary + "--")) {
               log_v("Done Parsing POST");
               break;
-            } else if (_postArgsLen >= WEBSERVER_MAX_POST_ARGS) {
+            } else if (_request.postArgumentCount >= WEBSERVER_MAX_POST_ARGS) {
               log_e("Too many PostArgs (max: %u) in request.", WEBSERVER_MAX_POST_ARGS);
               return false;
             }
           } else {
-            _currentUpload.reset(new HTTPUpload());
-            _currentUpload->status = UPLOAD_FILE_START;
-            _currentUpload->name = argName;
-            _currentUpload->filename = argFilename;
-            _currentUpload->type = argType;
-            _currentUpload->totalSize = 0;
-            _currentUpload->currentSize = 0;
-            log_v("Start File: %s Type: %s", _currentUpload->filename.c_str(), _currentUpload->type.c_str());
-            if (_currentHandler && _currentHandler->canUpload(*this, _currentUri)) {
-              _currentHandler->upload(*this, _currentUri, *_currentUpload);
+            _request.upload.reset(new HTTPUpload());
+            _request.upload->status = UPLOAD_FILE_START;
+            _request.upload->name = argName;
+            _request.upload->filename = argFilename;
+            _request.upload->type = argType;
+            _request.upload->totalSize = 0;
+            _request.upload->currentSize = 0;
+            log_v("Start File: %s Type: %s", _request.upload->filename.c_str(), _request.upload->type.c_str());
+            if (_request.handler && _request.handler->canUpload(*this, _request.uri)) {
+              _request.handler->upload(*this, _request.uri, *_request.upload);
             }
-            _currentUpload->status = UPLOAD_FILE_WRITE;
+            _request.upload->status = UPLOAD_FILE_WRITE;
 
             int fastBoundaryLen = 4 /* \r\n-- */ + boundary.length() + 1 /* \0 */;
             char fastBoundary[fastBoundaryLen];
@@ -540,15 +558,15 @@ bool WebServer::_parseForm(NetworkClient &client, const String &boundary, uint32
               }
             }
             // Found the boundary string, finish processing this file upload
-            if (_currentHandler && _currentHandler->canUpload(*this, _currentUri)) {
-              _currentHandler->upload(*this, _currentUri, *_currentUpload);
+            if (_request.handler && _request.handler->canUpload(*this, _request.uri)) {
+              _request.handler->upload(*this, _request.uri, *_request.upload);
             }
-            _currentUpload->totalSize += _currentUpload->currentSize;
-            _currentUpload->status = UPLOAD_FILE_END;
-            if (_currentHandler && _currentHandler->canUpload(*this, _currentUri)) {
-              _currentHandler->upload(*this, _currentUri, *_currentUpload);
+            _request.upload->totalSize += _request.upload->currentSize;
+            _request.upload->status = UPLOAD_FILE_END;
+            if (_request.handler && _request.handler->canUpload(*this, _request.uri)) {
+              _request.handler->upload(*this, _request.uri, *_request.upload);
             }
-            log_v("End File: %s Type: %s Size: %lu", _currentUpload->filename.c_str(), _currentUpload->type.c_str(), (unsigned long)_currentUpload->totalSize);
+            log_v("End File: %s Type: %s Size: %lu", _request.upload->filename.c_str(), _request.upload->type.c_str(), (unsigned long)_request.upload->totalSize);
             if (!client.connected()) {
               return _parseFormUploadAborted();
             }
@@ -564,28 +582,15 @@ bool WebServer::_parseForm(NetworkClient &client, const String &boundary, uint32
       }
     }
 
-    int iarg;
-    int totalArgs = ((WEBSERVER_MAX_POST_ARGS - _postArgsLen) < _currentArgCount) ? (WEBSERVER_MAX_POST_ARGS - _postArgsLen) : _currentArgCount;
-    for (iarg = 0; iarg < totalArgs; iarg++) {
-      RequestArgument &arg = _postArgs[_postArgsLen++];
-      arg.key = _currentArgs[iarg].key;
-      arg.value = _currentArgs[iarg].value;
-    }
-    if (_currentArgs) {
-      delete[] _currentArgs;
-    }
-    _currentArgs = new RequestArgument[_postArgsLen];
-    for (iarg = 0; iarg < _postArgsLen; iarg++) {
-      RequestArgument &arg = _currentArgs[iarg];
-      arg.key = _postArgs[iarg].key;
-      arg.value = _postArgs[iarg].value;
-    }
-    _currentArgCount = iarg;
-    if (_postArgs) {
-      delete[] _postArgs;
-      _postArgs = nullptr;
-      _postArgsLen = 0;
+    int totalArgs = ((WEBSERVER_MAX_POST_ARGS - _request.postArgumentCount) < _request.argumentCount) ? (WEBSERVER_MAX_POST_ARGS - _request.postArgumentCount) : _request.argumentCount;
+    for (int iarg = 0; iarg < totalArgs; iarg++) {
+      _request.postArguments[_request.postArgumentCount++] = _request.arguments[iarg];
     }
+    // both point into the arena, nothing to free
+    _request.arguments = _request.postArguments;
+    _request.argumentCount = _request.postArgumentCount;
+    _request.postArguments = nullptr;
+    _request.postArgumentCount = 0;
     return true;
   }
   log_e("Error: line: %s", line.c_str());
@@ -618,9 +623,9 @@ String WebServer::urlDecode(const String &text) {
 }
 
 bool WebServer::_parseFormUploadAborted() {
-  _currentUpload->status = UPLOAD_FILE_ABORTED;
-  if (_currentHandler && _currentHandler->canUpload(*this, _currentUri)) {
-    _currentHandler->upload(*this, _currentUri, *_currentUpload);
+  _request.upload->status = UPLOAD_FILE_ABORTED;
+  if (_request.handler && _request.handler->canUpload(*this, _request.uri)) {
+    _request.handler->upload(*this, _request.uri, *_request.upload);
   }
   return false;
 }
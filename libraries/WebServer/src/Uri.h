@@ -6,8 +6,18 @@
 
 class Uri {
 
+public:
+  // How the router of the server indexes the routes of a Uri
+  enum Route {
+    ROUTE_NONE,    // not indexed, canHandle() is asked in turn
+    ROUTE_EXACT,   // the path as it is
+    ROUTE_BRACES,  // a path with "{}" arguments, as UriBraces matches them
+    ROUTE_PREFIX,  // the path up to a trailing '*', then anything
+  };
+
 protected:
   const String _uri;
+  Route _route = ROUTE_NONE;
 
 public:
   Uri(const char *uri) : _uri(uri) {}
@@ -16,9 +26,20 @@ public:
   virtual ~Uri() {}
 
   virtual Uri *clone() const {
-    return new Uri(_uri);
+    // a subclass clones into its own type and sets its own route: this is a
+    // plain Uri then, which matches the path exactly
+    Uri *uri = new Uri(_uri);
+    uri->_route = ROUTE_EXACT;
+    return uri;
   };
 
+  Route route() const {
+    return _route;
+  }
+  const String &pattern() const {
+    return _uri;
+  }
+
   virtual void initPathArgs(__attribute__((unused)) std::vector<String> &pathArgs) {}
 
   virtual bool canHandle(const String &requestUri, __attribute__((unused)) std::vector<String> &pathArgs) {
@@ -25,6 +25,7 @@
 #include <libb64/cdecode.h>
 #include <libb64/cencode.h>
 #include "esp_random.h"
+#include <lwip/sockets.h>
 #include "NetworkServer.h"
 #include "NetworkClient.h"
 #include "WebServer.h"
@@ -52,9 +53,9 @@ WebServer::WebServer(int port) : _server(port) {
 WebServer::~WebServer() {
   _server.close();
 
-  _clearRequestHeaders();
   _clearResponseHeaders();
   delete _chain;
+  free(_head);
 
   RequestHandler *handler = _firstHandler;
   while (handler) {
@@ -202,14 +203,14 @@ bool WebServer::authenticate(THandlerFunctionAuthCheck fn) {
     if (!_username.length()) {
       goto exf;
     }
-    // The digest "uri" parameter may include a query string, while _currentUri
+    // The digest "uri" parameter may include a query string, while _request.uri
     // is parsed without it. Normalize by comparing only the path portion.
     String _uriPath = _uri;
     int qmarkIndex = _uriPath.indexOf('?');
     if (qmarkIndex >= 0) {
       _uriPath = _uriPath.substring(0, qmarkIndex);
     }
-    if (_uriPath != _currentUri) {
+    if (_uriPath != _request.uri) {
       log_e("Authentication Failed: URI mismatch");
       goto exf;
     }
@@ -248,13 +249,13 @@ bool WebServer::authenticate(THandlerFunctionAuthCheck fn) {
 
     log_v("Hash of user:realm:pass=%s", _H1.c_str());
     String _H2 = "";
-    if (_currentMethod == HTTP_GET) {
+    if (_request.method == HTTP_GET) {
       _H2 = md5str(String(F("GET:")) + _uri);
-    } else if (_currentMethod == HTTP_POST) {
+    } else if (_request.method == HTTP_POST) {
       _H2 = md5str(String(F("POST:")) + _uri);
-    } else if (_currentMethod == HTTP_PUT) {
+    } else if (_request.method == HTTP_PUT) {
       _H2 = md5str(String(F("PUT:")) + _uri);
-    } else if (_currentMethod == HTTP_DELETE) {
+    } else if (_request.method == HTTP_DELETE) {
       _H2 = md5str(String(F("DELETE:")) + _uri);
     } else {
       _H2 = md5str(String(F("GET:")) + _uri);
@@ -377,6 +378,7 @@ bool WebServer::removeHandler(RequestHandler *handler) {
 }
 
 void WebServer::_addRequestHandler(RequestHandler *handler) {
+  _router.invalidate();
   if (!_lastHandler) {
     _firstHandler = handler;
     _lastHandler = handler;
@@ -387,6 +389,7 @@ void WebServer::_addRequestHandler(RequestHandler *handler) {
 }
 
 bool WebServer::_removeRequestHandler(RequestHandler *handler) {
+  _router.invalidate();
   RequestHandler *current = _firstHandler;
   RequestHandler *previous = nullptr;
 
@@ -417,6 +420,10 @@ void WebServer::serveStatic(const char *uri, FS &fs, const char *path, const cha
 }
 
 void WebServer::handleClient() {
+  if (_clients) {
+    _handleClients();
+    return;
+  }
   if (_currentStatus == HC_NONE) {
     _currentClient = _server.accept();
     if (!_currentClient) {
@@ -430,6 +437,7 @@ void WebServer::handleClient() {
 
     _currentStatus = HC_WAIT_READ;
     _statusChange = millis();
+    _currentRequests = 0;
   }
 
   bool keepCurrentClient = false;
@@ -445,23 +453,17 @@ void WebServer::handleClient() {
         if (_currentClient.available()) {
           _currentClient.setTimeout(HTTP_MAX_SEND_WAIT); /* / 1000 removed, WifiClient setTimeout changed to ms */
           if (_parseRequest(_currentClient)) {
-            _contentLength = CONTENT_LENGTH_NOT_SET;
-            _responseCode = 0;
-            _clearResponseHeaders();
-
-            // Run server-level middlewares
-            if (_chain) {
-              _chain->runChain(*this, [this]() {
-                return _handleRequest();
-              });
-            } else {
-              _handleRequest();
-            }
+            bool keepAlive = _serveRequest(_currentRequests);
 
             if (_currentClient.isSSE()) {
               _currentStatus = HC_WAIT_CLOSE;
               _statusChange = millis();
               keepCurrentClient = true;
+            } else if (keepAlive) {
+              // a pipelined request is read from the client on the next call
+              _statusChange = millis();
+              _currentRequests++;
+              keepCurrentClient = true;
             }
             // Fix for issue with Chrome based browsers: https://github.com/espressif/arduino-esp32/issues/3652
             //           if (_currentClient.connected()) {
@@ -470,6 +472,12 @@ void WebServer::handleClient() {
             //             keepCurrentClient = true;
             //           }
           }
+        } else if (_currentRequests) {
+          // kept alive, until it has been idle too long or another client waits
+          if (millis() - _statusChange <= _keepAliveTimeout && !_server.hasClient()) {
+            keepCurrentClient = true;
+          }
+          callYield = true;
         } else {  // !_currentClient.available()
           if (millis() - _statusChange <= HTTP_MAX_DATA_WAIT) {
             keepCurrentClient = true;
@@ -491,10 +499,12 @@ void WebServer::handleClient() {
   }
 
   if (!keepCurrentClient) {
+    // what the client sent unread would reset the connection on close
+    _currentClient.clear();
     _currentClient = NetworkClient();
     _currentStatus = HC_NONE;
-    _currentUpload.reset();
-    _currentRaw.reset();
+    _request.upload.reset();
+    _request.raw.reset();
   }
 
   if (callYield) {
@@ -502,10 +512,315 @@ void WebServer::handleClient() {
   }
 }
 
+// Returns whether the connection stays open for the next request, served is
+// the number of requests served on it before
+bool WebServer::_serveRequest(uint16_t served) {
+  _contentLength = CONTENT_LENGTH_NOT_SET;
+  _responseCode = 0;
+  _responseKeepAlive = false;
+  _clearResponseHeaders();
+  // the last request allowed on the connection is answered with "Connection: close"
+  _request.keepAlive = _request.keepAlive && _keepAliveEnabled && served + 1 < _keepAliveMaxRequests;
+
+  // Run server-level middlewares
+  if (_chain) {
+    _chain->runChain(*this, [this]() {
+      return _handleRequest();
+    });
+  } else {
+    _handleRequest();
+  }
+  // a handler that answered nothing or closed the client ends the connection
+  return _responseKeepAlive && _currentClient.connected();
+}
+
+void WebServer::setMaxClients(uint8_t maxClients) {
+  _clients.reset(maxClients > 1 ? new ClientConnection[maxClients] : nullptr);
+  _maxClients = _clients ? maxClients : 1;
+  if (_clients) {
+    // the clients connecting at once are not refused by the backlog meanwhile
+    _server.setMaxClients(maxClients);
+  }
+}
+
+void WebServer::_handleClients() {
+  fd_set readable;
+  FD_ZERO(&readable);
+  int maxFd = -1;
+  bool full = true;
+  for (uint8_t i = 0; i < _maxClients; i++) {
+    ClientConnection &conn = _clients[i];
+    if (conn.status == HC_WAIT_READ) {
+      FD_SET(conn.client.fd(), &readable);
+      maxFd = std::max(maxFd, conn.client.fd());
+    }
+    if (conn.status == HC_NONE || _keepAliveIdle(conn)) {
+      full = false;
+    }
+  }
+  // with all the connections busy, new ones wait in the backlog
+  int serverFd = full ? -1 : _server.fd();
+  if (serverFd >= 0) {
+    FD_SET(serverFd, &readable);
+    maxFd = std::max(maxFd, serverFd);
+  }
+  if (maxFd < 0) {
+    if (_nullDelay) {
+      delay(1);
+    }
+    return;
+  }
+  // the wait replaces the delay(1) of the single client mode
+  struct timeval tv = {0, _nullDelay ? 1000 : 0};
+  int ready = select(maxFd + 1, &readable, NULL, NULL, &tv);
+  if (ready < 0) {
+    log_e("select failed, errno: %d, \"%s\"", errno, strerror(errno));
+    return;
+  }
+
+  for (uint8_t i = 0; i < _maxClients; i++) {
+    ClientConnection &conn = _clients[i];
+    if (conn.status == HC_WAIT_READ && FD_ISSET(conn.client.fd(), &readable)) {
+      if (_requestArrived(conn)) {
+        _serveClient(conn);
+      }
+      continue;
+    }
+    unsigned long wait = _keepAliveIdle(conn) ? _keepAliveTimeout : conn.status == HC_WAIT_READ ? HTTP_MAX_DATA_WAIT : HTTP_MAX_CLOSE_WAIT;
+    if (conn.status != HC_NONE && millis() - conn.statusChange > wait) {
+      conn.reset();
+    }
+  }
+
+  // after the reads, so that a kept alive connection whose next request just
+  // arrived is not taken for idle
+  if (serverFd >= 0 && FD_ISSET(serverFd, &readable)) {
+    while (true) {
+      // a free connection, or else the one idle the longest
+      ClientConnection *conn = nullptr;
+      for (uint8_t i = 0; i < _maxClients; i++) {
+        ClientConnection &c = _clients[i];
+        if (c.status == HC_NONE) {
+          conn = &c;
+          break;
+        }
+        if (_keepAliveIdle(c) && (!conn || (long)(c.statusChange - conn->statusChange) < 0)) {
+          conn = &c;
+        }
+      }
+      if (!conn) {
+        break;
+      }
+      NetworkClient client = _server.accept();
+      if (!client) {
+        break;
+      }
+      conn->reset();
+      conn->client = client;
+      log_v("New client %u: client.localIP()=%s", (unsigned)(conn - _clients.get()), conn->client.localIP().toString().c_str());
+      conn->status = HC_WAIT_READ;
+      conn->statusChange = millis();
+    }
+  }
+}
+
+bool WebServer::_keepAliveIdle(const ClientConnection &conn) const {
+  return conn.status == HC_WAIT_READ && conn.requests && !conn.length;
+}
+
+void WebServer::ClientConnection::reset() {
+  client = NetworkClient();
+  status = HC_NONE;
+  free(buffer);
+  buffer = nullptr;
+  size = 0;
+  length = 0;
+  parser.reset();
+  requestLength = 0;
+  requests = 0;
+}
+
+// Goes on parsing the head at the start of the buffer, the request length is
+// known once it is complete. False when it is not a valid head, or does not fit.
+bool WebServer::ClientConnection::parse() {
+  HTTPRequestParser::Result result = parser.parse(buffer, length);
+  if (result == HTTPRequestParser::COMPLETE) {
+    requestLength = parser.headLength + std::max(parser.contentLength, 0L);
+    return true;
+  }
+  return result == HTTPRequestParser::INCOMPLETE && length < HTTP_MAX_REQUEST_WAIT_LEN;
+}
+
+// The bytes the buffer may hold: the head, then the whole request if it is not
+// too long, and what the client sent after it
+size_t WebServer::ClientConnection::limit() const {
+  if (!requestLength) {
+    return HTTP_MAX_REQUEST_WAIT_LEN;
+  }
+  return std::max(std::min(requestLength, (size_t)HTTP_MAX_BUFFERED_REQUEST_LEN), (size_t)HTTP_MAX_REQUEST_WAIT_LEN);
+}
+
+bool WebServer::_requestArrived(ClientConnection &conn) {
+  if (conn.length == conn.size) {
+    size_t size = std::min(conn.size ? conn.size * 2 : 512, conn.limit());
+    char *buffer = (char *)realloc(conn.buffer, size);
+    if (!buffer) {
+      log_e("No memory for the request of client %d", conn.client.fd());
+      conn.reset();
+      return false;
+    }
+    conn.buffer = buffer;
+    conn.size = size;
+  }
+  int received = recv(conn.client.fd(), conn.buffer + conn.length, conn.size - conn.length, MSG_DONTWAIT);
+  if (received <= 0) {
+    // readable with nothing to read: the client closed or failed
+    if (received == 0 || errno != EWOULDBLOCK) {
+      conn.reset();
+    }
+    return false;
+  }
+  conn.length += received;
+  if (!conn.requestLength && !conn.parse()) {
+    log_e("Invalid request from client %d", conn.client.fd());
+    conn.client.clear();
+    conn.reset();
+    return false;
+  }
+  // the body of a longer request is read by the handler as the rest of it arrives
+  return conn.requestLength && (conn.length >= conn.requestLength || conn.length == conn.limit());
+}
+
+// The client of a connection of the multi client mode for the parser: the
+// bytes already received are read first, then the socket
+class BufferedClient : public NetworkClient {
+public:
+  BufferedClient(const NetworkClient &client, const char *buffer, size_t length) : NetworkClient(client), _buffer(buffer), _length(length) {}
+
+  int available() override {
+    return _length - _pos + NetworkClient::available();
+  }
+  int read() override {
+    if (_pos < _length) {
+      return (uint8_t)_buffer[_pos++];
+    }
+    _pastBuffer = true;
+    return NetworkClient::read();
+  }
+  // NetworkClient::readBytes() reads the socket through this one
+  int read(uint8_t *buf, size_t size) override {
+    if (_pos < _length) {
+      size_t buffered = std::min(size, _length - _pos);
+      memcpy(buf, _buffer + _pos, buffered);
+      _pos += buffered;
+      return buffered;
+    }
+    _pastBuffer = true;
+    return NetworkClient::read(buf, size);
+  }
+  size_t readBytes(char *buffer, size_t length) override {
+    size_t buffered = std::min(length, _length - _pos);
+    memcpy(buffer, _buffer + _pos, buffered);
+    _pos += buffered;
+    if (buffered == length) {
+      return length;
+    }
+    _pastBuffer = true;
+    return buffered + NetworkClient::readBytes(buffer + buffered, length - buffered);
+  }
+  int peek() override {
+    return _pos < _length ? (uint8_t)_buffer[_pos] : NetworkClient::peek();
+  }
+  size_t peekAvailable() override {
+    return _pos < _length ? _length - _pos : NetworkClient::peekAvailable();
+  }
+  const char *peekBuffer() override {
+    return _pos < _length ? _buffer + _pos : NetworkClient::peekBuffer();
+  }
+  void peekConsume(size_t consume) override {
+    if (_pos < _length) {
+      _pos += std::min(consume, _length - _pos);
+    } else {
+      _pastBuffer = true;
+      NetworkClient::peekConsume(consume);
+    }
+  }
+  // whether the parser read from the socket, past the request in the buffer
+  bool pastBuffer() const {
+    return _pastBuffer;
+  }
+
+private:
+  const char *_buffer;
+  size_t _length;
+  size_t _pos = 0;
+  bool _pastBuffer = false;
+};
+
+void WebServer::_serveClient(ClientConnection &conn) {
+  _currentClient = conn.client;
+  _currentClient.setTimeout(HTTP_MAX_SEND_WAIT);
+  while (true) {
+    // the parser gets the body of the request and not the pipelined ones after it
+    bool whole = conn.requestLength <= conn.length;
+    size_t length = whole ? conn.requestLength : conn.length;
+    size_t headLength = conn.parser.headLength;
+    BufferedClient client(conn.client, conn.buffer + headLength, length - headLength);
+    // the other clients wait while a longer body is read from the socket
+    client.setTimeout(HTTP_MAX_BODY_WAIT);
+    bool keepAlive = _parseRequest(client, conn.buffer, conn.parser) && _serveRequest(conn.requests) && whole && !client.pastBuffer();
+    // the head is about to be overwritten
+    _request.head = nullptr;
+    _request.parser = nullptr;
+    if (_currentClient.isSSE()) {
+      conn.status = HC_WAIT_CLOSE;
+      conn.statusChange = millis();
+      break;
+    }
+    if (!keepAlive) {
+      // what the client sent unread would reset the connection on close
+      conn.client.clear();
+      conn.reset();
+      break;
+    }
+    conn.requests++;
+    conn.status = HC_WAIT_READ;
+    conn.statusChange = millis();
+    // what is left is the start of the next request, or all of it
+    conn.length -= length;
+    memmove(conn.buffer, conn.buffer + length, conn.length);
+    conn.parser.reset();
+    conn.requestLength = 0;
+    if (!conn.length) {
+      // idle connections do not hold on to a buffer
+      free(conn.buffer);
+      conn.buffer = nullptr;
+      conn.size = 0;
+    }
+    if (!conn.parse()) {
+      log_e("Invalid request from client %d", conn.client.fd());
+      conn.client.clear();
+      conn.reset();
+      break;
+    }
+    if (!conn.requestLength || (conn.requestLength > conn.length && conn.length < conn.limit())) {
+      break;
+    }
+    _request.upload.reset();
+    _request.raw.reset();
+  }
+  _currentClient = NetworkClient();
+  _request.upload.reset();
+  _request.raw.reset();
+}
+
 void WebServer::close() {
   _server.close();
   _currentStatus = HC_NONE;
-  if (!_headerKeysCount) {
+  for (uint8_t i = 0; _clients && i < _maxClients; i++) {
+    _clients[i].reset();
+  }
+  if (!_request.headerKeyCount) {
     collectHeaders(0, 0);
   }
 }
@@ -559,6 +874,12 @@ void WebServer::enableCrossOrigin(boolean value) {
   enableCORS(value);
 }
 
+void WebServer::enableKeepAlive(bool enable, unsigned long idleTimeout, uint16_t maxRequests) {
+  _keepAliveEnabled = enable;
+  _keepAliveTimeout = idleTimeout;
+  _keepAliveMaxRequests = maxRequests;
+}
+
 void WebServer::enableETag(bool enable, ETagFunction fn) {
   _eTagEnabled = enable;
   _eTagFunction = fn;
@@ -626,7 +947,9 @@ void WebServer::chunkResponseEnd() {
     log_e("Failed to write terminating chunk");
   }
 
-  _chunkedClient.clear();
+  if (!_responseKeepAlive) {
+    _chunkedClient.clear();
+  }
   _chunkedResponseActive = false;
   _chunked = false;
   _chunkedClient = NetworkClient();
@@ -654,7 +977,7 @@ void WebServer::_prepareHeader(String &response, int code, const char *content_t
     sendHeader(String(FPSTR(Content_Length)), String(contentLength));
   } else if (_contentLength != CONTENT_LENGTH_UNKNOWN) {
     sendHeader(String(FPSTR(Content_Length)), String(_contentLength));
-  } else if (_contentLength == CONTENT_LENGTH_UNKNOWN && _currentVersion) {  //HTTP/1.1 or above client
+  } else if (_contentLength == CONTENT_LENGTH_UNKNOWN && _request.version) {  //HTTP/1.1 or above client
     //let's do chunked
     _chunked = true;
     sendHeader(String(F("Accept-Ranges")), String(F("none")));
@@ -665,7 +988,14 @@ void WebServer::_prepareHeader(String &response, int code, const char *content_t
     sendHeader(String(FPSTR("Access-Control-Allow-Methods")), String("*"));
     sendHeader(String(FPSTR("Access-Control-Allow-Headers")), String("*"));
   }
-  sendHeader(String(F("Connection")), String(F("close")));
+  // a response without a length ends with the connection
+  _responseKeepAlive = _request.keepAlive && (_contentLength != CONTENT_LENGTH_UNKNOWN || _chunked);
+  if (_responseKeepAlive) {
+    sendHeader(String(F("Connection")), String(F("keep-alive")));
+    sendHeader(String(F("Keep-Alive")), String(F("timeout=")) + String(_keepAliveTimeout / 1000));
+  } else {
+    sendHeader(String(F("Connection")), String(F("close")));
+  }
 
   for (RequestArgument *header = _responseHeaders; header; header = header->next) {
     response.concat(header->key);
@@ -716,7 +1046,7 @@ void WebServer::send(int code, const char *content_type, Stream &stream, size_t
   String header;
   _prepareHeader(header, code, content_type, content_length);
   _currentClientWrite(header.c_str(), header.length());
-  _currentClient.write(stream, content_length);
+  stream.sendSize(_currentClient, content_length);
 }
 
 void WebServer::send_P(int code, PGM_P content_type, PGM_P content) {
@@ -800,109 +1130,171 @@ void WebServer::_streamFileCore(const size_t fileSize, const String &fileName, c
   setContentLength(CONTENT_LENGTH_NOT_SET);
 }
 
-String WebServer::pathArg(unsigned int i) const {
-  if (_currentHandler != nullptr) {
-    return _currentHandler->pathArg(i);
+String WebServer::RequestContext::pathArg(unsigned int i) const {
+  if (handler != nullptr) {
+    return handler->pathArg(i);
   }
   return "";
 }
 
-String WebServer::arg(const String &name) const {
-  for (int j = 0; j < _postArgsLen; ++j) {
-    if (_postArgs[j].key == name) {
-      return _postArgs[j].value;
+String WebServer::RequestContext::arg(const String &name) const {
+  for (int j = 0; j < postArgumentCount; ++j) {
+    if (strcmp(postArguments[j].key, name.c_str()) == 0) {
+      return String(postArguments[j].value, postArguments[j].valueLength);
     }
   }
-  for (int i = 0; i < _currentArgCount; ++i) {
-    if (_currentArgs[i].key == name) {
-      return _currentArgs[i].value;
+  for (int i = 0; i < argumentCount; ++i) {
+    if (strcmp(arguments[i].key, name.c_str()) == 0) {
+      return String(arguments[i].value, arguments[i].valueLength);
     }
   }
   return "";
 }
 
-String WebServer::arg(int i) const {
-  if (i < _currentArgCount) {
-    return _currentArgs[i].value;
+String WebServer::RequestContext::arg(int i) const {
+  if (i >= 0 && i < argumentCount) {
+    return String(arguments[i].value, arguments[i].valueLength);
   }
   return "";
 }
 
-String WebServer::argName(int i) const {
-  if (i < _currentArgCount) {
-    return _currentArgs[i].key;
+String WebServer::RequestContext::argName(int i) const {
+  if (i >= 0 && i < argumentCount) {
+    return arguments[i].key;
   }
   return "";
 }
 
-int WebServer::args() const {
-  return _currentArgCount;
+int WebServer::RequestContext::args() const {
+  return argumentCount;
 }
 
-bool WebServer::hasArg(const String &name) const {
-  for (int j = 0; j < _postArgsLen; ++j) {
-    if (_postArgs[j].key == name) {
+bool WebServer::RequestContext::hasArg(const String &name) const {
+  for (int j = 0; j < postArgumentCount; ++j) {
+    if (strcmp(postArguments[j].key, name.c_str()) == 0) {
       return true;
     }
   }
-  for (int i = 0; i < _currentArgCount; ++i) {
-    if (_currentArgs[i].key == name) {
+  for (int i = 0; i < argumentCount; ++i) {
+    if (strcmp(arguments[i].key, name.c_str()) == 0) {
       return true;
     }
   }
   return false;
 }
 
-String WebServer::header(const String &name) const {
-  for (RequestArgument *current = _currentHeaders; current; current = current->next) {
-    if (current->key.equalsIgnoreCase(name)) {
-      return current->value;
+String WebServer::RequestContext::_text(HTTPRequestParser::Span span) const {
+  return head ? String(head + span.offset, span.length) : emptyString;
+}
+
+String WebServer::RequestContext::header(const String &name) const {
+  if (!head || !headerIndex) {
+    return "";
+  }
+  for (int i = 0; i < headerKeyCount; i++) {
+    if (headerKeys[i].equalsIgnoreCase(name)) {
+      return headerIndex[i] == 255 ? emptyString : _text(parser->headers[headerIndex[i]].value);
+    }
+  }
+  for (int i = headerKeyCount; i < headerCount; i++) {
+    const HTTPRequestParser::Header &h = parser->headers[headerIndex[i]];
+    if (HTTPRequestParser::equals(head, h.name, name.c_str())) {
+      return _text(h.value);
     }
   }
   return "";
 }
 
-void WebServer::collectHeaders(const char *headerKeys[], const size_t headerKeysCount) {
-  collectAllHeaders();
-  _collectAllHeaders = false;
+String WebServer::RequestContext::header(int i) const {
+  if (!head || !headerIndex || i < 0 || i >= headerCount || headerIndex[i] == 255) {
+    return emptyString;
+  }
+  return _text(parser->headers[headerIndex[i]].value);
+}
+
+String WebServer::RequestContext::headerName(int i) const {
+  if (i >= 0 && i < headerKeyCount) {
+    return headerKeys[i];
+  }
+  if (!head || !headerIndex || i < 0 || i >= headerCount) {
+    return emptyString;
+  }
+  return _text(parser->headers[headerIndex[i]].name);
+}
+
+int WebServer::RequestContext::headers() const {
+  return headerCount;
+}
+
+bool WebServer::RequestContext::hasHeader(const String &name) const {
+  return header(name).length() > 0;
+}
 
-  _headerKeysCount += headerKeysCount;
+String WebServer::RequestContext::hostHeader() const {
+  int host = head ? parser->find(head, "Host") : -1;
+  return host < 0 ? emptyString : _text(parser->headers[host].value);
+}
 
-  RequestArgument *last = _currentHeaders->next;
+String WebServer::pathArg(unsigned int i) const {
+  return _request.pathArg(i);
+}
 
-  for (int i = 2; i < _headerKeysCount; i++) {
-    last->next = new RequestArgument();
-    last->next->key = headerKeys[i - 2];
-    last = last->next;
+String WebServer::arg(const String &name) const {
+  return _request.arg(name);
+}
+
+String WebServer::arg(int i) const {
+  return _request.arg(i);
+}
+
+String WebServer::argName(int i) const {
+  return _request.argName(i);
+}
+
+int WebServer::args() const {
+  return _request.args();
+}
+
+bool WebServer::hasArg(const String &name) const {
+  return _request.hasArg(name);
+}
+
+String WebServer::header(const String &name) const {
+  return _request.header(name);
+}
+
+void WebServer::collectHeaders(const char *headerKeys[], const size_t headerKeysCount) {
+  _collectAllHeaders = false;
+  _request.headerKeyCount = 2 + headerKeysCount;
+  _request.headerKeys.reset(new String[_request.headerKeyCount]);
+  _request.headerKeys[0] = FPSTR(AUTHORIZATION_HEADER);
+  _request.headerKeys[1] = FPSTR(ETAG_HEADER);
+  for (size_t i = 0; i < headerKeysCount; i++) {
+    _request.headerKeys[2 + i] = headerKeys[i];
   }
+  // the keys without values until the next request
+  _request.headerCount = _request.headerKeyCount;
+  _request.headerIndex = nullptr;
 }
 
 String WebServer::header(int i) const {
-  RequestArgument *current = _currentHeaders;
-  while (current && i--) {
-    current = current->next;
-  }
-  return current ? current->value : emptyString;
+  return _request.header(i);
 }
 
 String WebServer::headerName(int i) const {
-  RequestArgument *current = _currentHeaders;
-  while (current && i--) {
-    current = current->next;
-  }
-  return current ? current->key : emptyString;
+  return _request.headerName(i);
 }
 
 int WebServer::headers() const {
-  return _headerKeysCount;
+  return _request.headers();
 }
 
 bool WebServer::hasHeader(const String &name) const {
-  return header(name).length() > 0;
+  return _request.hasHeader(name);
 }
 
 String WebServer::hostHeader() const {
-  return _hostHeader;
+  return _request.hostHeader();
 }
 
 void WebServer::onFileUpload(THandlerFunction fn) {
@@ -915,13 +1307,13 @@ void WebServer::onNotFound(THandlerFunction fn) {
 
 bool WebServer::_handleRequest() {
   bool handled = false;
-  if (_currentHandler) {
-    handled = _currentHandler->process(*this, _currentMethod, _currentUri);
+  if (_request.handler) {
+    handled = _request.handler->process(*this, _request.method, _request.uri);
     if (!handled) {
       log_e("request handler failed to handle request");
     }
   }
-  // DO NOT LOG if _currentHandler == null !!
+  // DO NOT LOG if _request.handler == null !!
   // This is is valid use case to handle any other requests
   // Also, this is just causing log flooding
   if (!handled && _notFoundHandler) {
@@ -930,13 +1322,13 @@ bool WebServer::_handleRequest() {
   }
   if (!handled) {
     using namespace mime;
-    send(404, String(FPSTR(mimeTable[html].mimeType)), String(F("Not found: ")) + _currentUri);
+    send(404, String(FPSTR(mimeTable[html].mimeType)), String(F("Not found: ")) + _request.uri);
     handled = true;
   }
   if (handled) {
     _finalizeResponse();
   }
-  _currentUri = "";
+  _request.uri = "";
   return handled;
 }
 
@@ -1003,27 +1395,8 @@ void WebServer::_clearResponseHeaders() {
   _responseHeaders = nullptr;
 }
 
-void WebServer::_clearRequestHeaders() {
-  _headerKeysCount = 0;
-  RequestArgument *current = _currentHeaders;
-  while (current) {
-    RequestArgument *next = current->next;
-    delete current;
-    current = next;
-  }
-  _currentHeaders = nullptr;
-}
-
 void WebServer::collectAllHeaders() {
-  _clearRequestHeaders();
-
-  _currentHeaders = new RequestArgument();
-  _currentHeaders->key = FPSTR(AUTHORIZATION_HEADER);
-
-  _currentHeaders->next = new RequestArgument();
-  _currentHeaders->next->key = FPSTR(ETAG_HEADER);
-
-  _headerKeysCount = 2;
+  collectHeaders(nullptr, 0);
   _collectAllHeaders = true;
 }
 
@@ -1057,14 +1430,14 @@ bool WebServer::hasResponseHeader(const String &name) const {
 }
 
 int WebServer::clientContentLength() const {
-  return _clientContentLength;
+  return _request.clientContentLength;
 }
 
 const String WebServer::version() const {
   String v;
   v.reserve(8);
   v.concat(F("HTTP/1."));
-  v.concat(_currentVersion);
+  v.concat(_request.version);
   return v;
 }
 int WebServer::responseCode() const {
@@ -69,6 +69,21 @@ enum HTTPAuthMethod {
 #define HTTP_MAX_CLOSE_WAIT     5000  //ms to wait for the client to close the connection
 #define HTTP_MAX_BASIC_AUTH_LEN 256   // maximum length of a basic Auth base64 encoded username:password string
 
+#define HTTP_MAX_KEEPALIVE_WAIT     5000  //ms to wait for the next request on a kept alive connection
+#define HTTP_MAX_KEEPALIVE_REQUESTS 100   // requests served on one kept alive connection
+
+#ifndef HTTP_MAX_REQUEST_WAIT_LEN
+#define HTTP_MAX_REQUEST_WAIT_LEN 4096  // request bytes buffered before parsing, the head has to fit
+#endif
+
+#ifndef HTTP_MAX_BUFFERED_REQUEST_LEN
+#define HTTP_MAX_BUFFERED_REQUEST_LEN 8192  // multi client mode: requests up to this long are received whole before they are handled
+#endif
+
+#ifndef HTTP_MAX_BODY_WAIT
+#define HTTP_MAX_BODY_WAIT 1000  // multi client mode: ms to wait for more of a longer body, while the other clients wait
+#endif
+
 #define CONTENT_LENGTH_UNKNOWN ((size_t) - 1)
 #define CONTENT_LENGTH_NOT_SET ((size_t) - 2)
 
@@ -94,13 +109,84 @@ typedef struct {
 
 #include "middleware/Middleware.h"
 #include "detail/RequestHandler.h"
+#include "detail/RequestParser.h"
+#include "detail/RequestRouter.h"
 
 namespace fs {
 class FS;
 }
 
 class WebServer {
+protected:
+  struct RequestArgument {
+    String key;
+    String value;
+    RequestArgument *next;
+  };
+
 public:
+  // What was parsed from the request being handled, see request(). The
+  // request getters of the server read the same.
+  //
+  // The headers are not copied: they are read from the head of the request
+  // where it was received, through the spans of the parser. The decoded
+  // arguments are in the arena, freed at once when the next request comes.
+  struct RequestContext {
+    HTTPMethod method = HTTP_ANY;
+    String uri;
+    uint8_t version = 0;     // minor version, HTTP/1.x
+    bool keepAlive = false;  // the connection may stay open for the next request
+    int clientContentLength = 0;  // "Content-Length" from header of incoming POST or GET request
+    RequestHandler *handler = nullptr;
+
+    // the head and its parser, while the request is handled
+    const char *head = nullptr;
+    const HTTPRequestParser *parser = nullptr;
+
+    struct Argument {
+      const char *key;
+      const char *value;
+      size_t valueLength;
+    };
+    RequestArena arena;
+    int argumentCount = 0;
+    Argument *arguments = nullptr;
+    int postArgumentCount = 0;
+    Argument *postArguments = nullptr;
+
+    // the header names collected, Authorization and If-None-Match first, then
+    // those of collectHeaders()
+    std::unique_ptr<String[]> headerKeys;
+    int headerKeyCount = 0;
+    // the collected headers: the parser header of each key (255 when absent),
+    // then with collectAllHeaders() the other headers
+    int headerCount = 0;
+    uint8_t *headerIndex = nullptr;
+
+    std::unique_ptr<HTTPUpload> upload;
+    std::unique_ptr<HTTPRaw> raw;
+
+    RequestContext() = default;
+    RequestContext(const RequestContext &) = delete;
+    RequestContext &operator=(const RequestContext &) = delete;
+
+    String pathArg(unsigned int i) const;
+    String arg(const String &name) const;
+    String arg(int i) const;
+    String argName(int i) const;
+    int args() const;
+    bool hasArg(const String &name) const;
+    String header(const String &name) const;
+    String header(int i) const;
+    String headerName(int i) const;
+    int headers() const;
+    bool hasHeader(const String &name) const;
+    String hostHeader() const;
+
+  private:
+    String _text(HTTPRequestParser::Span span) const;
+  };
+
   WebServer(IPAddress addr, int port = 80);
   WebServer(int port = 80);
   virtual ~WebServer();
@@ -112,6 +198,27 @@ public:
   virtual void close();
   void stop();
 
+  // Up to maxClients connections are served at once instead of one after the
+  // other: handleClient() waits on all of them with select() and reads what
+  // arrives into a buffer per connection. A request of up to
+  // HTTP_MAX_BUFFERED_REQUEST_LEN bytes is handled once it is all there, so a
+  // slow client does not hold up the others. The body of a longer request
+  // (an upload) is read by the handler as it arrives, and the response is
+  // written in one go: the other clients wait meanwhile, and a body pausing
+  // for more than HTTP_MAX_BODY_WAIT ms is dropped.
+  // 1, the default, serves one client at a time. The listen backlog is set to
+  // maxClients as well, so call it before begin().
+  void setMaxClients(uint8_t maxClients);
+
+  // Persistent connections: the connection stays open for the next request
+  // when the client does not ask to close it (HTTP/1.0 clients have to ask for
+  // keep-alive) and the response has a length or is chunked. Requests the
+  // client sent without waiting for the responses (pipelined) are served in
+  // turn. A connection is closed after idleTimeout ms without a request and
+  // after maxRequests requests. An idle connection also gives way to a new
+  // client when no other one could be served.
+  void enableKeepAlive(bool enable = true, unsigned long idleTimeout = HTTP_MAX_KEEPALIVE_WAIT, uint16_t maxRequests = HTTP_MAX_KEEPALIVE_REQUESTS);
+
   const String AuthTypeDigest = F("Digest");
   const String AuthTypeBasic = F("Basic");
 
@@ -168,19 +275,22 @@ public:
   WebServer &removeMiddleware(Middleware *middleware);
 
   String uri() const {
-    return _currentUri;
+    return _request.uri;
   }
   HTTPMethod method() const {
-    return _currentMethod;
+    return _request.method;
+  }
+  const RequestContext &request() const {
+    return _request;
   }
   virtual NetworkClient &client() {
     return _currentClient;
   }
   HTTPUpload &upload() {
-    return *_currentUpload;
+    return *_request.upload;
   }
   HTTPRaw &raw() {
-    return *_currentRaw;
+    return *_request.raw;
   }
 
   String pathArg(unsigned int i) const;                                         // get request path argument by number
@@ -238,7 +348,7 @@ public:
 
   template<typename T> size_t streamFile(T &file, const String &contentType, const int code = 200) {
     _streamFileCore(file.size(), file.name(), contentType, code);
-    return _currentClient.write(file);
+    return file.sendSize(_currentClient, file.size());
   }
 
   bool _eTagEnabled = false;
@@ -262,13 +372,14 @@ protected:
   bool _handleRequest();
   void _finalizeResponse();
   bool _parseRequest(NetworkClient &client);
-  void _parseArguments(const String &data);
+  bool _parseRequest(NetworkClient &client, const char *head, const HTTPRequestParser &parser);
+  void _parseArguments(const char *data, size_t length);
   bool _parseForm(NetworkClient &client, const String &boundary, uint32_t len);
   bool _parseFormUploadAborted();
   void _uploadWriteByte(uint8_t b);
   int _uploadReadByte(NetworkClient &client);
   void _prepareHeader(String &response, int code, const char *content_type, size_t contentLength);
-  bool _collectHeader(const char *headerName, const char *headerValue);
+  void _collectHeaders(const char *head, const HTTPRequestParser &parser);
 
   void _streamFileCore(const size_t fileSize, const String &fileName, const String &contentType, const int code = 200);
 
@@ -277,47 +388,67 @@ protected:
   String _extractParam(String &authReq, const String &param, const char delimit = '"');
 
   void _clearResponseHeaders();
-  void _clearRequestHeaders();
 
-  struct RequestArgument {
-    String key;
-    String value;
-    RequestArgument *next;
+  // A connection of the multi client mode and what arrived of its request:
+  // the head is parsed as it arrives, the request is handled once all of it
+  // is in the buffer, or as much of it as the buffer may hold
+  struct ClientConnection {
+    NetworkClient client;
+    HTTPClientStatus status = HC_NONE;
+    unsigned long statusChange = 0;
+    char *buffer = nullptr;
+    size_t size = 0;           // of buffer, up to limit()
+    size_t length = 0;         // bytes received
+    HTTPRequestParser parser;  // of the head at the start of buffer
+    size_t requestLength = 0;  // head and body, 0 until the head is complete
+    uint16_t requests = 0;     // served on the connection
+
+    ClientConnection() = default;
+    ClientConnection(const ClientConnection &) = delete;
+    ClientConnection &operator=(const ClientConnection &) = delete;
+    ~ClientConnection() {
+      free(buffer);
+    }
+    void reset();
+    bool parse();
+    size_t limit() const;
   };
 
+  bool _serveRequest(uint16_t served);
+  bool _keepAliveIdle(const ClientConnection &conn) const;
+  void _handleClients();
+  bool _requestArrived(ClientConnection &conn);
+  void _serveClient(ClientConnection &conn);
+
   boolean _corsEnabled = false;
   NetworkServer _server;
 
   NetworkClient _currentClient;
-  HTTPMethod _currentMethod = HTTP_ANY;
-  String _currentUri;
-  uint8_t _currentVersion = 0;
+  RequestContext _request;
   HTTPClientStatus _currentStatus = HC_NONE;
   unsigned long _statusChange = 0;
+  uint16_t _currentRequests = 0;  // served on _currentClient
+  // single client mode: the head of the request, and its parser
+  char *_head = nullptr;
+  size_t _headSize = 0;
+  HTTPRequestParser _parser;
   boolean _nullDelay = true;
 
-  RequestHandler *_currentHandler = nullptr;
   RequestHandler *_firstHandler = nullptr;
   RequestHandler *_lastHandler = nullptr;
+  RequestRouter _router;  // index of the handlers
   THandlerFunction _notFoundHandler = nullptr;
   THandlerFunction _fileUploadHandler = nullptr;
 
-  int _currentArgCount = 0;
-  RequestArgument *_currentArgs = nullptr;
-  int _postArgsLen = 0;
-  RequestArgument *_postArgs = nullptr;
-
-  std::unique_ptr<HTTPUpload> _currentUpload;
-  std::unique_ptr<HTTPRaw> _currentRaw;
-
-  int _headerKeysCount = 0;
-  RequestArgument *_currentHeaders = nullptr;
   size_t _contentLength = 0;
-  int _clientContentLength = 0;  // "Content-Length" from header of incoming POST or GET request
   RequestArgument *_responseHeaders = nullptr;
 
-  String _hostHeader;
   bool _chunked = false;
+  bool _responseKeepAlive = false;  // "Connection: keep-alive" was sent
+
+  bool _keepAliveEnabled = false;
+  unsigned long _keepAliveTimeout = HTTP_MAX_KEEPALIVE_WAIT;
+  uint16_t _keepAliveMaxRequests = HTTP_MAX_KEEPALIVE_REQUESTS;
 
   String _snonce;  // Store noance and opaque for future comparison
   String _sopaque;
@@ -327,6 +458,9 @@ protected:
   int _responseCode = 0;
   bool _collectAllHeaders = false;
   MiddlewareChain *_chain = nullptr;
+
+  uint8_t _maxClients = 1;
+  std::unique_ptr<ClientConnection[]> _clients;
 };
 
 #endif  //ESP8266WEBSERVER_H
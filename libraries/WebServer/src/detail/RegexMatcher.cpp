@@ -0,0 +1,587 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "RegexMatcher.h"
+
+#define UNSET 0xFFFF  // a capture slot without a position
+
+static bool isWord(uint8_t c) {
+  return isalnum(c) || c == '_';
+}
+
+static int hexValue(char c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  c |= 0x20;
+  return c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1;
+}
+
+template<typename Code> static void append(Code &code, const Code &piece) {
+  code.insert(code.end(), piece.begin(), piece.end());
+}
+
+bool RegexMatcher::compile(const char *pattern) {
+  _program.clear();
+  _classes.clear();
+  _groups = 0;
+  Parser parser = {pattern};
+  Code code;
+  if (!_parseAlternatives(parser, code) || *parser.p) {
+    // a ')' without its '('
+    _program.clear();
+    return false;
+  }
+  code.push_back({OP_MATCH, 0, 0, 0});
+  if (code.size() > HTTP_REGEX_MAX_PROGRAM) {
+    return false;
+  }
+  _program.swap(code);
+  _program.shrink_to_fit();
+  _slots = _groups * 2;
+  _anchored = _program[0].op == OP_BEGIN;
+  _skips = _collectFirst();
+  size_t n = _program.size();
+  // the pcs of the two lists, their captures, then those a thread starts with
+  // and those of the best match
+  _threads.assign(2 * n + 2 * n * _slots + 2 * _slots, UNSET);
+  _marks.assign(n, 0);
+  _pending.resize(n + 1);
+  _generation = 0;
+  return true;
+}
+
+bool RegexMatcher::_parseAlternatives(Parser &parser, Code &code) {
+  Code first;
+  if (!_parseSequence(parser, first)) {
+    return false;
+  }
+  if (*parser.p != '|') {
+    append(code, first);
+    return true;
+  }
+  parser.p++;
+  Code rest;
+  if (!_parseAlternatives(parser, rest)) {
+    return false;
+  }
+  // the first alternative is preferred
+  code.push_back({OP_SPLIT, 0, 1, (int16_t)(first.size() + 2)});
+  append(code, first);
+  code.push_back({OP_JUMP, 0, (int16_t)(rest.size() + 1), 0});
+  append(code, rest);
+  return code.size() <= HTTP_REGEX_MAX_PROGRAM;
+}
+
+bool RegexMatcher::_parseSequence(Parser &parser, Code &code) {
+  while (*parser.p && *parser.p != '|' && *parser.p != ')') {
+    Code atom;
+    if (!_parseAtom(parser, atom)) {
+      return false;
+    }
+    const char *p = parser.p;
+    int min;
+    int max;
+    if (*p == '*') {
+      min = 0;
+      max = -1;
+    } else if (*p == '+') {
+      min = 1;
+      max = -1;
+    } else if (*p == '?') {
+      min = 0;
+      max = 1;
+    } else if (*p == '{') {
+      if (!isdigit((uint8_t)p[1])) {
+        return false;
+      }
+      char *end;
+      min = strtol(p + 1, &end, 10);
+      max = min;
+      if (*end == ',') {
+        max = isdigit((uint8_t)end[1]) ? strtol(end + 1, &end, 10) : (end++, -1);
+      }
+      if (*end != '}' || (max >= 0 && max < min) || min > HTTP_REGEX_MAX_PROGRAM || max > HTTP_REGEX_MAX_PROGRAM) {
+        return false;
+      }
+      p = end;
+    } else {
+      append(code, atom);
+      continue;
+    }
+    p++;
+    bool greedy = true;
+    if (*p == '?') {
+      greedy = false;
+      p++;
+    }
+    parser.p = p;
+    // nothing to repeat: a quantifier after a quantifier or an assertion
+    if (strchr("*+?{", *p) && *p) {
+      return false;
+    }
+    if (atom.size() == 1 && atom[0].op >= OP_BEGIN) {
+      return false;
+    }
+    if (!_repeat(atom, min, max, greedy, code)) {
+      return false;
+    }
+  }
+  return code.size() <= HTTP_REGEX_MAX_PROGRAM;
+}
+
+bool RegexMatcher::_repeat(Code &atom, int min, int max, bool greedy, Code &code) {
+  int16_t length = atom.size();
+  for (int i = 0; i < min; i++) {
+    if (code.size() + length > HTTP_REGEX_MAX_PROGRAM) {
+      return false;
+    }
+    append(code, atom);
+  }
+  if (max < 0) {
+    // a loop, its atom again or out
+    code.push_back({OP_SPLIT, 0, greedy ? (int16_t)1 : (int16_t)(length + 2), greedy ? (int16_t)(length + 2) : (int16_t)1});
+    append(code, atom);
+    code.push_back({OP_JUMP, 0, (int16_t)-(length + 1), 0});
+    return code.size() <= HTTP_REGEX_MAX_PROGRAM;
+  }
+  // the optional atoms nested, each only tried after the one before
+  Code optional;
+  for (int i = min; i < max; i++) {
+    Code inner = atom;
+    append(inner, optional);
+    int16_t size = inner.size();
+    optional.clear();
+    optional.push_back({OP_SPLIT, 0, greedy ? (int16_t)1 : (int16_t)(size + 1), greedy ? (int16_t)(size + 1) : (int16_t)1});
+    append(optional, inner);
+    if (code.size() + optional.size() > HTTP_REGEX_MAX_PROGRAM) {
+      return false;
+    }
+  }
+  append(code, optional);
+  return true;
+}
+
+bool RegexMatcher::_parseAtom(Parser &parser, Code &code) {
+  char c = *parser.p++;
+  switch (c) {
+    case '(':
+    {
+      bool capture = true;
+      if (*parser.p == '?') {
+        // (?: only, lookaheads need backtracking
+        if (parser.p[1] != ':') {
+          return false;
+        }
+        capture = false;
+        parser.p += 2;
+      }
+      uint8_t slot = _groups * 2;
+      if (capture) {
+        if (_groups >= 127) {
+          return false;
+        }
+        _groups++;
+        code.push_back({OP_SAVE, slot, 0, 0});
+      }
+      if (!_parseAlternatives(parser, code) || *parser.p != ')') {
+        return false;
+      }
+      parser.p++;
+      if (capture) {
+        code.push_back({OP_SAVE, (uint8_t)(slot + 1), 0, 0});
+      }
+      return true;
+    }
+    case '[': return _parseClass(parser, code);
+    case '.':
+    {
+      Class any;
+      memset(any.bits, 0xFF, sizeof(any.bits));
+      any.bits['\n' >> 5] &= ~(1UL << '\n');
+      any.bits['\r' >> 5] &= ~(1UL << '\r');
+      _emitClass(any, code);
+      return true;
+    }
+    case '^': code.push_back({OP_BEGIN, 0, 0, 0}); return true;
+    case '$': code.push_back({OP_END, 0, 0, 0}); return true;
+    case '\\':
+    {
+      if (*parser.p == 'b' || *parser.p == 'B') {
+        code.push_back({*parser.p++ == 'b' ? OP_WORD : OP_NOT_WORD, 0, 0, 0});
+        return true;
+      }
+      Class set = {};
+      int ch = -1;
+      if (!_parseEscape(parser, set, ch, false)) {
+        return false;
+      }
+      if (ch >= 0) {
+        code.push_back({OP_CHAR, (uint8_t)ch, 0, 0});
+      } else {
+        _emitClass(set, code);
+      }
+      return true;
+    }
+    // nothing to repeat
+    case '*':
+    case '+':
+    case '?':
+    case '{':  return false;
+    default:   code.push_back({OP_CHAR, (uint8_t)c, 0, 0}); return true;
+  }
+}
+
+// After the '\\': a character into c, or a class into set
+bool RegexMatcher::_parseEscape(Parser &parser, Class &set, int &c, bool inClass) {
+  char e = *parser.p++;
+  bool negate = false;
+  switch (e) {
+    case '\0': return false;
+    case 'D':  negate = true;
+    // fall through
+    case 'd':
+      for (int i = '0'; i <= '9'; i++) {
+        set.add(i);
+      }
+      break;
+    case 'W': negate = true;
+    // fall through
+    case 'w':
+      for (int i = 0; i < 256; i++) {
+        if (isWord(i)) {
+          set.add(i);
+        }
+      }
+      break;
+    case 'S': negate = true;
+    // fall through
+    case 's':
+      for (char space : {' ', '\t', '\n', '\v', '\f', '\r'}) {
+        set.add(space);
+      }
+      break;
+    case 'n': c = '\n'; return true;
+    case 'r': c = '\r'; return true;
+    case 't': c = '\t'; return true;
+    case 'f': c = '\f'; return true;
+    case 'v': c = '\v'; return true;
+    case 'b':
+      // a backspace in a class, a word boundary out of one
+      c = '\b';
+      return inClass;
+    case '0':
+      c = 0;
+      return !isdigit((uint8_t)*parser.p);
+    case 'x':
+    case 'u':
+    {
+      int digits = e == 'x' ? 2 : 4;
+      c = 0;
+      for (int i = 0; i < digits; i++) {
+        int value = hexValue(*parser.p);
+        if (value < 0) {
+          return false;
+        }
+        c = c * 16 + value;
+        parser.p++;
+      }
+      // bytes only
+      return c < 256;
+    }
+    case 'c':
+      if (!isalpha((uint8_t)*parser.p)) {
+        return false;
+      }
+      c = *parser.p++ % 32;
+      return true;
+    default:
+      // backreferences need backtracking
+      if (e >= '1' && e <= '9') {
+        return false;
+      }
+      c = (uint8_t)e;
+      return true;
+  }
+  if (negate) {
+    for (uint32_t &bits : set.bits) {
+      bits = ~bits;
+    }
+  }
+  return true;
+}
+
+bool RegexMatcher::_parseClass(Parser &parser, Code &code) {
+  Class set = {};
+  bool negate = *parser.p == '^';
+  if (negate) {
+    parser.p++;
+  }
+  while (*parser.p != ']') {
+    if (!*parser.p) {
+      return false;
+    }
+    int low = (uint8_t)*parser.p++;
+    if (low == '\\') {
+      Class escaped = {};
+      low = -1;
+      if (!_parseEscape(parser, escaped, low, true)) {
+        return false;
+      }
+      if (low < 0) {
+        for (int i = 0; i < 8; i++) {
+          set.bits[i] |= escaped.bits[i];
+        }
+        continue;
+      }
+    }
+    int high = low;
+    if (parser.p[0] == '-' && parser.p[1] && parser.p[1] != ']') {
+      parser.p++;
+      high = (uint8_t)*parser.p++;
+      if (high == '\\') {
+        Class escaped = {};
+        high = -1;
+        if (!_parseEscape(parser, escaped, high, true) || high < 0) {
+          return false;
+        }
+      }
+      if (high < low) {
+        return false;
+      }
+    }
+    for (int i = low; i <= high; i++) {
+      set.add(i);
+    }
+  }
+  parser.p++;
+  if (negate) {
+    for (uint32_t &bits : set.bits) {
+      bits = ~bits;
+    }
+  }
+  _emitClass(set, code);
+  return true;
+}
+
+void RegexMatcher::_emitClass(const Class &set, Code &code) {
+  size_t index = 0;
+  while (index < _classes.size() && memcmp(_classes[index].bits, set.bits, sizeof(set.bits)) != 0) {
+    index++;
+  }
+  if (index == _classes.size()) {
+    _classes.push_back(set);
+  }
+  code.push_back({OP_CLASS, 0, (int16_t)index, 0});
+}
+
+bool RegexMatcher::_collectFirst() {
+  memset(_first.bits, 0, sizeof(_first.bits));
+  std::vector<bool> visited(_program.size());
+  std::vector<int> stack(1, 0);
+  while (!stack.empty()) {
+    int pc = stack.back();
+    stack.pop_back();
+    if (visited[pc]) {
+      continue;
+    }
+    visited[pc] = true;
+    const Inst &inst = _program[pc];
+    switch (inst.op) {
+      case OP_CHAR:  _first.add(inst.c); break;
+      case OP_CLASS:
+        for (int i = 0; i < 8; i++) {
+          _first.bits[i] |= _classes[inst.x].bits[i];
+        }
+        break;
+      case OP_SPLIT:
+        stack.push_back(pc + inst.y);
+        stack.push_back(pc + inst.x);
+        break;
+      case OP_JUMP: stack.push_back(pc + inst.x); break;
+      case OP_SAVE: stack.push_back(pc + 1); break;
+      default:      return false;
+    }
+  }
+  _firstByte = -1;
+  for (int c = 0; c < 256; c++) {
+    if (_first.has(c)) {
+      if (_firstByte >= 0) {
+        _firstByte = -1;
+        break;
+      }
+      _firstByte = c;
+    }
+  }
+  return true;
+}
+
+// The first position from pos where a match may start
+size_t RegexMatcher::_skip(size_t pos) const {
+  if (_firstByte >= 0) {
+    const char *found = (const char *)memchr(_text + pos, _firstByte, _length - pos);
+    return found ? found - _text : _length;
+  }
+  while (pos < _length && !_first.has(_text[pos])) {
+    pos++;
+  }
+  return pos;
+}
+
+void RegexMatcher::_addThread(uint16_t list, int pc, uint16_t *caps, uint16_t pos) {
+  // in locals, the stores into the uint16_t buffers would reload the members
+  size_t n = _program.size();
+  size_t slots = _slots;
+  const Inst *program = _program.data();
+  uint16_t *marks = _marks.data();
+  Pending *pending = _pending.data();
+  uint16_t generation = _generation;
+  uint16_t count = _count[list];
+  uint16_t *pcs = _threads.data() + list * n;
+  uint16_t *store = _threads.data() + 2 * n + list * n * slots;
+  size_t top = 0;
+  pending[top++] = {(int16_t)pc, 0, 0};
+  while (top) {
+    Pending item = pending[--top];
+    if (item.pc < 0) {
+      caps[item.slot] = item.value;
+      continue;
+    }
+    int at = item.pc;
+    while (marks[at] != generation) {
+      marks[at] = generation;
+      const Inst &inst = program[at];
+      switch (inst.op) {
+        case OP_JUMP: at += inst.x; continue;
+        case OP_SPLIT:
+          // the second branch after the first and all it leads to
+          pending[top++] = {(int16_t)(at + inst.y), 0, 0};
+          at += inst.x;
+          continue;
+        case OP_SAVE:
+          pending[top++] = {-1, inst.c, caps[inst.c]};
+          caps[inst.c] = pos;
+          at++;
+          continue;
+        case OP_BEGIN:
+          if (pos != 0) {
+            break;
+          }
+          at++;
+          continue;
+        case OP_END:
+          if (pos != _length) {
+            break;
+          }
+          at++;
+          continue;
+        case OP_WORD:
+        case OP_NOT_WORD:
+        {
+          bool boundary = (pos > 0 && isWord(_text[pos - 1])) != (pos < _length && isWord(_text[pos]));
+          if (boundary != (inst.op == OP_WORD)) {
+            break;
+          }
+          at++;
+          continue;
+        }
+        default:
+          // reads a character or matches: a thread of the list
+          pcs[count] = at;
+          for (size_t i = 0; i < slots; i++) {
+            store[count * slots + i] = caps[i];
+          }
+          count++;
+          break;
+      }
+      break;
+    }
+  }
+  _count[list] = count;
+}
+
+bool RegexMatcher::search(const char *text, size_t length, std::vector<String> &captures) {
+  if (_program.empty() || length >= UNSET) {
+    return false;
+  }
+  _text = text;
+  _length = length;
+  size_t n = _program.size();
+  uint16_t *seed = &_threads[2 * n + 2 * n * _slots];  // all unset
+  uint16_t *best = seed + _slots;
+  bool matched = false;
+  uint16_t current = 0;
+  _count[0] = 0;
+  if (++_generation == 0) {
+    std::fill(_marks.begin(), _marks.end(), 0);
+    _generation = 1;
+  }
+  size_t pos = _skips ? _skip(0) : 0;
+  if (pos == length && _skips) {
+    return false;
+  }
+  _addThread(current, 0, seed, pos);
+  for (;; pos++) {
+    uint16_t next = current ^ 1;
+    _count[next] = 0;
+    if (++_generation == 0) {
+      std::fill(_marks.begin(), _marks.end(), 0);
+      _generation = 1;
+    }
+    const uint16_t *pcs = &_threads[current * n];
+    uint16_t *caps = &_threads[2 * n + current * n * _slots];
+    uint16_t count = _count[current];
+    // the threads in order of priority
+    for (uint16_t i = 0; i < count; i++) {
+      const Inst &inst = _program[pcs[i]];
+      uint16_t *threadCaps = caps + i * _slots;
+      if (inst.op == OP_MATCH) {
+        // the threads after this one would only match in place of it
+        matched = true;
+        memcpy(best, threadCaps, _slots * sizeof(uint16_t));
+        break;
+      }
+      if (pos == length) {
+        continue;
+      }
+      uint8_t c = text[pos];
+      if (inst.op == OP_CHAR ? inst.c == c : _classes[inst.x].has(c)) {
+        _addThread(next, pcs[i] + 1, threadCaps, pos + 1);
+      }
+    }
+    if (pos == length) {
+      break;
+    }
+    // a match may start at the next position, after those started before
+    if (!matched && !_anchored) {
+      if (_skips && !_count[next]) {
+        // none left: the next match starts at a byte a match can start with
+        size_t start = _skip(pos + 1);
+        if (start == length) {
+          return false;
+        }
+        pos = start - 1;
+      }
+      _addThread(next, 0, seed, pos + 1);
+    }
+    current = next;
+    if (!_count[current] && (matched || _anchored)) {
+      break;
+    }
+  }
+  if (!matched) {
+    return false;
+  }
+  for (size_t i = 0; i < _groups && i < captures.size(); i++) {
+    uint16_t start = best[2 * i];
+    uint16_t end = best[2 * i + 1];
+    captures[i].clear();
+    if (start != UNSET && end != UNSET) {
+      captures[i].concat(text + start, end - start);
+    }
+  }
+  return true;
+}
@@ -0,0 +1,130 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <vector>
+
+/*
+ * The regular expressions of UriRegex, compiled once into a small program
+ * and run without backtracking.
+ *
+ * The pattern is compiled when the Uri is made into instructions of a
+ * Thompson NFA, and search() runs them as a Pike VM: all the threads of the
+ * NFA advance over the text together, one character at a time, each with
+ * the positions of its capture groups. Time is linear in the text and the
+ * program, and the buffers the threads use are made when compiling, so a
+ * search does not allocate.
+ *
+ * The syntax is the ECMAScript one of std::regex, as UriRegex used, over
+ * bytes: literals and escapes, '.', classes with ranges, \d \w \s and their
+ * negations, ^ $ \b \B, capturing and (?: ) groups, '|', and the greedy and
+ * lazy * + ? {n} {n,} {n,m}. The match is the leftmost one with the group
+ * values of std::regex_search(), but for a loop whose body matches empty,
+ * which ends as ECMAScript has it where libstdc++ takes one more empty
+ * iteration. Backreferences and lookaheads cannot run without backtracking
+ * and are refused, compile() fails for them.
+ */
+
+#ifndef HTTP_REGEX_MAX_PROGRAM
+#define HTTP_REGEX_MAX_PROGRAM 2048  // instructions of a pattern, with the copies of {n,m} repeats
+#endif
+
+class RegexMatcher {
+public:
+  // Compiles pattern, false if it is not valid or uses syntax not supported
+  bool compile(const char *pattern);
+  bool valid() const {
+    return !_program.empty();
+  }
+  // The capturing groups of the pattern
+  size_t groups() const {
+    return _groups;
+  }
+  // Searches text for the pattern as std::regex_search() does. On a match,
+  // the first captures (as many as there are) get the values of the groups,
+  // empty for a group that did not take part in the match.
+  bool search(const char *text, size_t length, std::vector<String> &captures);
+
+private:
+  enum Op : uint8_t {
+    OP_CHAR,      // the character c
+    OP_CLASS,     // a character in the class x
+    OP_SPLIT,     // to pc + x first, then pc + y
+    OP_JUMP,      // to pc + x
+    OP_SAVE,      // the position into slot c
+    OP_BEGIN,     // ^
+    OP_END,       // $
+    OP_WORD,      // \b
+    OP_NOT_WORD,  // \B
+    OP_MATCH,
+  };
+
+  // Targets are relative, so a piece of program can be copied (for repeats)
+  struct Inst {
+    Op op;
+    uint8_t c;
+    int16_t x;
+    int16_t y;
+  };
+  typedef std::vector<Inst> Code;
+
+  // 256 bits, one per byte value
+  struct Class {
+    uint32_t bits[8];
+    void add(uint8_t c) {
+      bits[c >> 5] |= 1UL << (c & 31);
+    }
+    bool has(uint8_t c) const {
+      return bits[c >> 5] & (1UL << (c & 31));
+    }
+  };
+
+  // The pattern being compiled
+  struct Parser {
+    const char *p;
+  };
+
+  bool _parseAlternatives(Parser &parser, Code &code);
+  bool _parseSequence(Parser &parser, Code &code);
+  bool _parseAtom(Parser &parser, Code &code);
+  bool _parseClass(Parser &parser, Code &code);
+  bool _parseEscape(Parser &parser, Class &set, int &c, bool inClass);
+  bool _repeat(Code &atom, int min, int max, bool greedy, Code &code);
+  void _emitClass(const Class &set, Code &code);
+
+  bool _collectFirst();
+  size_t _skip(size_t pos) const;
+  // Adds the thread at pc to list, following the instructions that do not
+  // read a character with the captures in caps
+  void _addThread(uint16_t list, int pc, uint16_t *caps, uint16_t pos);
+
+  std::vector<Inst> _program;
+  std::vector<Class> _classes;
+  size_t _groups = 0;
+  size_t _slots = 0;       // two per group
+  bool _anchored = false;  // starts with ^, only tried at 0
+  // The bytes a match starts with, when it cannot be empty or start with an
+  // assertion: the search skips to the next of them when no thread is left
+  bool _skips = false;
+  int _firstByte = -1;  // the only one, found with memchr()
+  Class _first;
+
+  // Made by compile(), used by search()
+  struct Pending {
+    int16_t pc;  // -1 restores caps[slot] to value
+    uint16_t slot;
+    uint16_t value;
+  };
+  std::vector<uint16_t> _threads;  // two lists of pcs, then their captures
+  std::vector<uint16_t> _marks;    // the generation a pc was added to a list in
+  std::vector<Pending> _pending;
+  uint16_t _count[2];
+  uint16_t _generation = 0;
+  const char *_text;
+  size_t _length;
+};
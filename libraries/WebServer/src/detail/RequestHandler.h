@@ -4,6 +4,8 @@
 #include <vector>
 #include <assert.h>
 
+class Uri;
+
 class RequestHandler {
 public:
   virtual ~RequestHandler() {
@@ -65,6 +67,22 @@ public:
     (void)raw;
   }
 
+  /*
+    note: for the router of the server. A handler that matches requests by
+    method and Uri only returns them, and is found through the index of the
+    router instead of being asked canHandle() in turn.
+  */
+
+  virtual const Uri *route(HTTPMethod &method) {
+    (void)method;
+    return nullptr;
+  }
+  // The rest of canHandle() (a filter) once the router matched the route
+  virtual bool canHandleRoute(WebServer &server) {
+    (void)server;
+    return true;
+  }
+
   virtual RequestHandler &setFilter(std::function<bool(WebServer &)> filter) {
     (void)filter;
     return *this;
@@ -88,6 +106,11 @@ private:
 
 protected:
   std::vector<String> pathArgs;
+  // set by the router when it matched the route of the request, pathArgs
+  // hold its arguments then
+  bool routed = false;
+
+  friend class RequestRouter;
 
 public:
   const String &pathArg(unsigned int i) {
@@ -85,7 +85,7 @@ public:
       return false;
     }
 
-    return _uri->canHandle(requestUri, pathArgs) && (_filter != NULL ? _filter(server) : true);
+    return (routed || _uri->canHandle(requestUri, pathArgs)) && (_filter != NULL ? _filter(server) : true);
   }
 
   bool canUpload(WebServer &server, const String &requestUri) override {
@@ -128,6 +128,15 @@ public:
     }
   }
 
+  const Uri *route(HTTPMethod &method) override {
+    method = _method;
+    return _uri;
+  }
+
+  bool canHandleRoute(WebServer &server) override {
+    return _filter != NULL ? _filter(server) : true;
+  }
+
   FunctionRequestHandler &setFilter(WebServer::FilterFunction filter) {
     _filter = filter;
     return *this;
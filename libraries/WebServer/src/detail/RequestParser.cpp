@@ -0,0 +1,347 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "RequestParser.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+enum ParserState {
+  PS_METHOD,
+  PS_PATH,
+  PS_QUERY,
+  PS_VERSION,
+  PS_REQUEST_LINE_LF,
+  PS_LINE_START,
+  PS_HEADER_NAME,
+  PS_VALUE_START,
+  PS_VALUE,
+  PS_HEADER_LF,
+  PS_END_LF,
+  PS_DONE,
+};
+
+// RFC 9110 token characters, for the method and header names
+struct TokenTable {
+  bool token[256] = {};
+  constexpr TokenTable() {
+    for (int c = '0'; c <= '9'; c++) {
+      token[c] = true;
+    }
+    for (int c = 'a'; c <= 'z'; c++) {
+      token[c] = true;
+      token[c - 'a' + 'A'] = true;
+    }
+    for (const char *c = "!#$%&'*+-.^_`|~"; *c; c++) {
+      token[(uint8_t)*c] = true;
+    }
+  }
+};
+static constexpr TokenTable TOKENS;
+
+static bool isToken(uint8_t c) {
+  return TOKENS.token[c];
+}
+
+// Characters of a header value, obs-text included
+static bool isValue(uint8_t c) {
+  return c >= ' ' ? c != 0x7F : c == '\t';
+}
+
+// Visible characters of the request target
+static bool isTarget(uint8_t c) {
+  return c > ' ' && c != 0x7F;
+}
+
+void HTTPRequestParser::reset() {
+  method = {0, 0};
+  path = {0, 0};
+  query = {0, 0};
+  versionMinor = 0;
+  headerCount = 0;
+  contentLength = -1;
+  headLength = 0;
+  _state = PS_METHOD;
+  _pos = 0;
+  _mark = 0;
+  _name = {0, 0};
+}
+
+// A header line with its value from mark to end ended: store it and check
+// what the parser needs
+HTTPRequestParser::Result HTTPRequestParser::_headerEnd(const char *buffer, uint16_t mark, uint16_t end) {
+  if (headerCount == HTTP_MAX_HEADERS) {
+    return TOO_LARGE;
+  }
+  Header &header = headers[headerCount++];
+  header.name = _name;
+  header.value = {mark, (uint16_t)(end - mark)};
+  if (equals(buffer, _name, "Content-Length")) {
+    long value = 0;
+    if (!header.value.length) {
+      return BAD_REQUEST;
+    }
+    for (uint16_t i = 0; i < header.value.length; i++) {
+      char c = buffer[header.value.offset + i];
+      if (c < '0' || c > '9' || value > (0x7FFFFFFF - 9) / 10) {
+        return BAD_REQUEST;
+      }
+      value = value * 10 + (c - '0');
+    }
+    // repeated, it has to be the same
+    if (contentLength >= 0 && contentLength != value) {
+      return BAD_REQUEST;
+    }
+    contentLength = value;
+  }
+  return INCOMPLETE;
+}
+
+HTTPRequestParser::Result HTTPRequestParser::parse(const char *buffer, size_t length) {
+  if (length > UINT16_MAX) {
+    length = UINT16_MAX;
+  }
+  if (_state == PS_DONE) {
+    return COMPLETE;
+  }
+  // kept in locals in the loop, the buffer could alias the members; they are
+  // only stored back for the next call when more is needed
+  size_t pos = _pos;
+  uint16_t mark = _mark;
+  uint8_t state = _state;
+  for (; pos < length; pos++) {
+    uint8_t c = buffer[pos];
+    switch (state) {
+      case PS_METHOD:
+        if (c == ' ' && pos > mark) {
+          method = {mark, (uint16_t)(pos - mark)};
+          mark = pos + 1;
+          state = PS_PATH;
+        } else if ((c == '\r' || c == '\n') && pos == mark) {
+          // empty lines before the request line are ignored (RFC 9112 2.2),
+          // like the CRLF a client may send after a body
+          mark = pos + 1;
+        } else if (!isToken(c)) {
+          return BAD_REQUEST;
+        }
+        break;
+      case PS_PATH:
+        while (c != ' ' && c != '?' && pos + 1 < length) {
+          if (!isTarget(c)) {
+            return BAD_REQUEST;
+          }
+          c = buffer[++pos];
+        }
+        if (c == ' ' || c == '?') {
+          path = {mark, (uint16_t)(pos - mark)};
+          if (!path.length) {
+            return BAD_REQUEST;
+          }
+          query = {(uint16_t)(pos + 1), 0};
+          mark = pos + 1;
+          state = c == '?' ? PS_QUERY : PS_VERSION;
+        } else if (!isTarget(c)) {
+          return BAD_REQUEST;
+        }
+        break;
+      case PS_QUERY:
+        while (c != ' ' && pos + 1 < length) {
+          if (!isTarget(c)) {
+            return BAD_REQUEST;
+          }
+          c = buffer[++pos];
+        }
+        if (c == ' ') {
+          query = {mark, (uint16_t)(pos - mark)};
+          mark = pos + 1;
+          state = PS_VERSION;
+        } else if (!isTarget(c)) {
+          return BAD_REQUEST;
+        }
+        break;
+      case PS_VERSION:
+        if (c == '\r' || c == '\n') {
+          if (pos - mark != 8 || strncmp(buffer + mark, "HTTP/1.", 7) != 0 || (buffer[pos - 1] != '0' && buffer[pos - 1] != '1')) {
+            return BAD_REQUEST;
+          }
+          versionMinor = buffer[pos - 1] - '0';
+          state = c == '\r' ? PS_REQUEST_LINE_LF : PS_LINE_START;
+        } else if (pos - mark >= 8) {
+          return BAD_REQUEST;
+        }
+        break;
+      case PS_REQUEST_LINE_LF:
+      case PS_HEADER_LF:
+        if (c != '\n') {
+          return BAD_REQUEST;
+        }
+        state = PS_LINE_START;
+        break;
+      case PS_LINE_START:
+        if (c == '\r') {
+          state = PS_END_LF;
+        } else if (c == '\n') {
+          headLength = pos + 1;
+          _state = PS_DONE;
+          return COMPLETE;
+        } else if (isToken(c)) {
+          mark = pos;
+          state = PS_HEADER_NAME;
+        } else {
+          // folded lines start with whitespace
+          return BAD_REQUEST;
+        }
+        break;
+      case PS_HEADER_NAME:
+        while (c != ':' && pos + 1 < length) {
+          if (!isToken(c)) {
+            return BAD_REQUEST;
+          }
+          c = buffer[++pos];
+        }
+        if (c == ':') {
+          _name = {mark, (uint16_t)(pos - mark)};
+          state = PS_VALUE_START;
+        } else if (!isToken(c)) {
+          return BAD_REQUEST;
+        }
+        break;
+      case PS_VALUE_START:
+        if (c == ' ' || c == '\t') {
+          break;
+        }
+        mark = pos;
+        state = PS_VALUE;
+        // fall through
+      case PS_VALUE:
+        while (isValue(c) && pos + 1 < length) {
+          c = buffer[++pos];
+        }
+        if (c == '\r' || c == '\n') {
+          // without the whitespace before the line end
+          size_t end = pos;
+          while (end > mark && (buffer[end - 1] == ' ' || buffer[end - 1] == '\t')) {
+            end--;
+          }
+          Result result = _headerEnd(buffer, mark, end);
+          if (result != INCOMPLETE) {
+            return result;
+          }
+          state = c == '\r' ? PS_HEADER_LF : PS_LINE_START;
+        } else if (!isValue(c)) {
+          return BAD_REQUEST;
+        }
+        break;
+      case PS_END_LF:
+        if (c != '\n') {
+          return BAD_REQUEST;
+        }
+        headLength = pos + 1;
+        _state = PS_DONE;
+        return COMPLETE;
+    }
+  }
+  if (length == UINT16_MAX) {
+    return TOO_LARGE;
+  }
+  _pos = pos;
+  _mark = mark;
+  _state = state;
+  return INCOMPLETE;
+}
+
+int HTTPRequestParser::find(const char *buffer, const char *name) const {
+  for (int i = headerCount - 1; i >= 0; i--) {
+    if (equals(buffer, headers[i].name, name)) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+bool HTTPRequestParser::equals(const char *buffer, Span span, const char *text) {
+  return strlen(text) == span.length && strncasecmp(buffer + span.offset, text, span.length) == 0;
+}
+
+bool HTTPRequestParser::startsWith(const char *buffer, Span span, const char *text) {
+  size_t length = strlen(text);
+  return length <= span.length && strncasecmp(buffer + span.offset, text, length) == 0;
+}
+
+bool HTTPRequestParser::contains(const char *buffer, Span span, const char *text) {
+  size_t length = strlen(text);
+  for (size_t i = 0; i + length <= span.length; i++) {
+    if (strncasecmp(buffer + span.offset + i, text, length) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+RequestArena::~RequestArena() {
+  while (_blocks) {
+    Block *next = _blocks->next;
+    free(_blocks);
+    _blocks = next;
+  }
+}
+
+void *RequestArena::alloc(size_t size) {
+  size = (size + 7) & ~(size_t)7;
+  if (!_blocks || _blocks->size - _blocks->used < size) {
+    size_t blockSize = size > HTTP_ARENA_BLOCK_SIZE ? size : HTTP_ARENA_BLOCK_SIZE;
+    Block *block = (Block *)malloc(sizeof(Block) + blockSize);
+    if (!block) {
+      return nullptr;
+    }
+    block->size = blockSize;
+    block->used = 0;
+    block->next = _blocks;
+    _blocks = block;
+  }
+  void *p = (char *)(_blocks + 1) + _blocks->used;
+  _blocks->used += size;
+  return p;
+}
+
+char *RequestArena::copy(const char *text, size_t length) {
+  char *p = (char *)alloc(length + 1);
+  if (p) {
+    memcpy(p, text, length);
+    p[length] = '\0';
+  }
+  return p;
+}
+
+void RequestArena::reset() {
+  while (_blocks && (_blocks->next || _blocks->size != HTTP_ARENA_BLOCK_SIZE)) {
+    Block *next = _blocks->next;
+    free(_blocks);
+    _blocks = next;
+  }
+  if (_blocks) {
+    _blocks->used = 0;
+  }
+}
+
+size_t requestUrlDecode(char *out, const char *in, size_t length) {
+  // as WebServer::urlDecode(): "%" and the next two characters as hex
+  char hex[] = "0x00";
+  size_t decoded = 0;
+  for (size_t i = 0; i < length;) {
+    char c = in[i++];
+    if (c == '%' && i + 1 < length) {
+      hex[2] = in[i++];
+      hex[3] = in[i++];
+      c = (char)strtol(hex, NULL, 16);
+    } else if (c == '+') {
+      c = ' ';
+    }
+    out[decoded++] = c;
+  }
+  return decoded;
+}
@@ -0,0 +1,122 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * Incremental HTTP/1.x request head parser.
+ *
+ * The parser does not copy or keep the bytes: it is given the buffer the head
+ * is received into, each time more of it arrived, and goes on where it
+ * stopped. The buffer may move between calls (realloc) as long as the bytes
+ * keep their offsets. Once the head is complete, the method, path, query and
+ * headers are (offset, length) spans into that buffer, header values without
+ * the whitespace around them. Content-Length is checked and parsed on the way,
+ * as the end of the request depends on it.
+ *
+ * Bare LF line ends are accepted. Header lines folded over several lines,
+ * control characters and anything but HTTP/1.0 and HTTP/1.1 are rejected.
+ */
+
+#ifndef HTTP_MAX_HEADERS
+#define HTTP_MAX_HEADERS 32  // headers of a request, more are refused
+#endif
+
+static_assert(HTTP_MAX_HEADERS < 255, "header indexes are kept in a uint8_t");
+
+class HTTPRequestParser {
+public:
+  enum Result {
+    INCOMPLETE,   // more of the head is needed
+    COMPLETE,     // headLength bytes are the head
+    BAD_REQUEST,  // not a valid request head
+    TOO_LARGE,    // over 64 KB or over HTTP_MAX_HEADERS headers
+  };
+
+  struct Span {
+    uint16_t offset;
+    uint16_t length;
+  };
+
+  struct Header {
+    Span name;
+    Span value;
+  };
+
+  Span method;
+  Span path;
+  Span query;  // after the '?', empty without one
+  uint8_t versionMinor;
+  uint8_t headerCount;
+  Header headers[HTTP_MAX_HEADERS];
+  long contentLength;  // -1 without a Content-Length header
+  size_t headLength;   // including the empty line, once complete
+
+  HTTPRequestParser() {
+    reset();
+  }
+  // For a new request
+  void reset();
+  // Goes on parsing the head in the first length bytes of buffer. After
+  // BAD_REQUEST or TOO_LARGE, reset() before parsing again.
+  Result parse(const char *buffer, size_t length);
+
+  // Index of the last header called name (case insensitive), -1 if none
+  int find(const char *buffer, const char *name) const;
+
+  // Case insensitive comparisons of a span with text
+  static bool equals(const char *buffer, Span span, const char *text);
+  static bool startsWith(const char *buffer, Span span, const char *text);
+  static bool contains(const char *buffer, Span span, const char *text);
+
+private:
+  Result _headerEnd(const char *buffer, uint16_t mark, uint16_t end);
+
+  uint8_t _state;
+  uint16_t _pos;   // next byte to look at
+  uint16_t _mark;  // start of the current part
+  Span _name;      // of the current header
+};
+
+/*
+ * Bump allocator for what is decoded from a request (arguments, the body of a
+ * form), freed all at once by reset() for the next request. Allocations come
+ * from blocks of HTTP_ARENA_BLOCK_SIZE bytes, larger ones get a block of their
+ * own. The first block is kept across requests.
+ */
+
+#ifndef HTTP_ARENA_BLOCK_SIZE
+#define HTTP_ARENA_BLOCK_SIZE 512
+#endif
+
+class RequestArena {
+public:
+  RequestArena() = default;
+  RequestArena(const RequestArena &) = delete;
+  RequestArena &operator=(const RequestArena &) = delete;
+  ~RequestArena();
+
+  // 8 byte aligned, nullptr when out of memory
+  void *alloc(size_t size);
+  // A NUL terminated copy
+  char *copy(const char *text, size_t length);
+  void reset();
+
+private:
+  struct alignas(8) Block {
+    Block *next;
+    size_t size;
+    size_t used;
+  };
+  Block *_blocks = nullptr;  // the newest first
+};
+
+// Decodes the %XX escapes and the '+' of a query or form argument into out,
+// which may be in, and returns the decoded length
+size_t requestUrlDecode(char *out, const char *in, size_t length);
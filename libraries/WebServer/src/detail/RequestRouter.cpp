@@ -0,0 +1,261 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "RequestRouter.h"
+#include "WebServer.h"
+
+static uint64_t methodBit(HTTPMethod method) {
+  if (method == HTTP_ANY) {
+    return ~0ULL;
+  }
+  return method < 64 ? 1ULL << method : 0;
+}
+
+void RequestRouter::_build(RequestHandler *handlers) {
+  _nodes.clear();
+  _fallback.clear();
+  _nodes.emplace_back();
+  uint16_t order = 0;
+  for (RequestHandler *handler = handlers; handler; handler = handler->next(), order++) {
+    HTTPMethod method = HTTP_ANY;
+    const Uri *uri = handler->route(method);
+    Route route = {order, method, handler};
+    if (!uri || !_insert(*uri, route)) {
+      _fallback.push_back(route);
+    }
+  }
+  _collectMethods(0);
+  _valid = true;
+  log_v("Routes: %u nodes, %u handlers asked in turn", (unsigned)_nodes.size(), (unsigned)_fallback.size());
+}
+
+// Adds the static text below node, splitting the edge it shares a start with,
+// and returns the node at its end
+uint16_t RequestRouter::_insertStatic(uint16_t node, const char *text, size_t length) {
+  while (length) {
+    int16_t shared = -1;
+    size_t slot = 0;
+    for (; slot < _nodes[node].children.size(); slot++) {
+      uint16_t child = _nodes[node].children[slot];
+      if (_nodes[child].label[0] == text[0]) {
+        shared = child;
+        break;
+      }
+    }
+    if (shared < 0) {
+      Node leaf;
+      leaf.label = String(text, length);
+      _nodes.push_back(leaf);
+      uint16_t index = _nodes.size() - 1;
+      _nodes[node].children.push_back(index);
+      return index;
+    }
+    const String &label = _nodes[shared].label;
+    size_t common = 1;
+    while (common < length && common < label.length() && label[common] == text[common]) {
+      common++;
+    }
+    if (common < label.length()) {
+      // the edge splits where the text goes its own way
+      Node middle;
+      middle.label = label.substring(0, common);
+      middle.children.push_back(shared);
+      _nodes[shared].label = _nodes[shared].label.substring(common);
+      _nodes.push_back(middle);
+      shared = _nodes.size() - 1;
+      _nodes[node].children[slot] = shared;
+    }
+    node = shared;
+    text += common;
+    length -= common;
+  }
+  return node;
+}
+
+bool RequestRouter::_insert(const Uri &uri, const Route &route) {
+  const String &pattern = uri.pattern();
+  const char *text = pattern.c_str();
+  size_t length = pattern.length();
+  if (length > UINT16_MAX) {
+    return false;
+  }
+  switch (uri.route()) {
+    case Uri::ROUTE_EXACT:
+    {
+      uint16_t node = _insertStatic(0, text, length);
+      _nodes[node].routes.push_back(route);
+      return true;
+    }
+    case Uri::ROUTE_PREFIX:
+    {
+      uint16_t node = _insertStatic(0, text, length - 1);
+      _nodes[node].prefixes.push_back(route);
+      return true;
+    }
+    case Uri::ROUTE_BRACES:
+    {
+      // only "{}" pairs that UriBraces counts, with a character after each
+      // but the last to end the argument at
+      int args = 0;
+      for (size_t i = 0; i < length; i++) {
+        if (text[i] != '{') {
+          continue;
+        }
+        if (i == 0 || text[i + 1] != '}' || text[i + 2] == '{' || ++args > HTTP_ROUTER_MAX_ARGS) {
+          return false;
+        }
+      }
+      uint16_t node = 0;
+      while (true) {
+        const char *brace = strstr(text, "{}");
+        size_t staticLength = brace ? brace - text : strlen(text);
+        node = _insertStatic(node, text, staticLength);
+        if (!brace) {
+          break;
+        }
+        if (_nodes[node].argument < 0) {
+          _nodes.emplace_back();
+          _nodes[node].argument = _nodes.size() - 1;
+        }
+        node = _nodes[node].argument;
+        text = brace + 2;
+      }
+      _nodes[node].routes.push_back(route);
+      return true;
+    }
+    default: return false;
+  }
+}
+
+uint64_t RequestRouter::_collectMethods(uint16_t node) {
+  uint64_t methods = 0;
+  for (const Route &route : _nodes[node].routes) {
+    methods |= methodBit(route.method);
+  }
+  for (const Route &route : _nodes[node].prefixes) {
+    methods |= methodBit(route.method);
+  }
+  for (size_t i = 0; i < _nodes[node].children.size(); i++) {
+    methods |= _collectMethods(_nodes[node].children[i]);
+  }
+  if (_nodes[node].argument >= 0) {
+    methods |= _collectMethods(_nodes[node].argument);
+  }
+  _nodes[node].methods = methods;
+  return methods;
+}
+
+// Takes the first of routes (in order) for the method of the request if it
+// comes before the best one so far
+void RequestRouter::_take(const std::vector<Route> &routes, Lookup &lookup) const {
+  for (const Route &route : routes) {
+    if (route.order >= lookup.bestOrder) {
+      return;
+    }
+    if ((route.method == HTTP_ANY || route.method == lookup.method) && route.handler->canHandleRoute(lookup.server)) {
+      lookup.bestOrder = route.order;
+      lookup.best = route.handler;
+      lookup.bestArgCount = lookup.argCount;
+      memcpy(lookup.bestArgs, lookup.args, lookup.argCount * sizeof(Span));
+      return;
+    }
+  }
+}
+
+// The path up to pos led to node
+void RequestRouter::_match(uint16_t node, size_t pos, Lookup &lookup) const {
+  const Node &current = _nodes[node];
+  if (!(current.methods & lookup.methodBit)) {
+    return;
+  }
+  if (pos == lookup.length) {
+    _take(current.routes, lookup);
+  }
+  _take(current.prefixes, lookup);
+  if (pos < lookup.length) {
+    for (uint16_t child : current.children) {
+      const String &label = _nodes[child].label;
+      if (label[0] == lookup.uri[pos]) {
+        if (label.length() <= lookup.length - pos && memcmp(label.c_str(), lookup.uri + pos, label.length()) == 0) {
+          _match(child, pos + label.length(), lookup);
+        }
+        break;
+      }
+    }
+  }
+  if (current.argument >= 0) {
+    _matchArgument(current.argument, pos, lookup);
+  }
+}
+
+// An argument starts at pos: as with UriBraces, it ends at the first of the
+// character that follows it, or is the rest of the path without a '/'
+void RequestRouter::_matchArgument(uint16_t node, size_t pos, Lookup &lookup) const {
+  const Node &argument = _nodes[node];
+  if (!(argument.methods & lookup.methodBit)) {
+    return;
+  }
+  const char *start = lookup.uri + pos;
+  size_t rest = lookup.length - pos;
+  Span &span = lookup.args[lookup.argCount++];
+  if (!argument.routes.empty() && !memchr(start, '/', rest)) {
+    span = {(uint16_t)pos, (uint16_t)rest};
+    _take(argument.routes, lookup);
+  }
+  for (uint16_t child : argument.children) {
+    const String &label = _nodes[child].label;
+    const char *end = (const char *)memchr(start, label[0], rest);
+    if (end && label.length() <= (size_t)(lookup.uri + lookup.length - end) && memcmp(label.c_str(), end, label.length()) == 0) {
+      span = {(uint16_t)pos, (uint16_t)(end - start)};
+      _match(child, end - lookup.uri + label.length(), lookup);
+    }
+  }
+  lookup.argCount--;
+}
+
+void RequestRouter::invalidate() {
+  // before the handler routed last may be deleted
+  if (_routed) {
+    _routed->routed = false;
+    _routed = nullptr;
+  }
+  _valid = false;
+}
+
+RequestHandler *RequestRouter::find(WebServer &server, RequestHandler *handlers, HTTPMethod method, const String &uri) {
+  if (!_valid) {
+    _build(handlers);
+  }
+  if (_routed) {
+    _routed->routed = false;
+    _routed = nullptr;
+  }
+  Lookup lookup = {server, method, methodBit(method), uri.c_str(), uri.length(), 0, {}, UINT16_MAX, nullptr, 0, {}};
+  if (lookup.length <= UINT16_MAX) {
+    _match(0, 0, lookup);
+  }
+  // the handlers asked in turn that come before
+  for (const Route &route : _fallback) {
+    if (route.order >= lookup.bestOrder) {
+      break;
+    }
+    if (route.handler->canHandle(server, method, uri)) {
+      return route.handler;
+    }
+  }
+  RequestHandler *handler = lookup.best;
+  if (handler) {
+    // into the Strings the handler has, they keep their buffers
+    std::vector<String> &pathArgs = handler->pathArgs;
+    for (uint8_t i = 0; i < lookup.bestArgCount && i < pathArgs.size(); i++) {
+      pathArgs[i].clear();
+      pathArgs[i].concat(lookup.uri + lookup.bestArgs[i].offset, lookup.bestArgs[i].length);
+    }
+    handler->routed = true;
+    _routed = handler;
+  }
+  return handler;
+}
@@ -0,0 +1,100 @@
+/*
+ * SPDX-FileCopyrightText: 2026 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <vector>
+#include "HTTP_Method.h"
+
+/*
+ * Finds the handler of a request without asking each handler canHandle() in
+ * turn.
+ *
+ * The routes of the handlers that match by method and Uri only (those of
+ * WebServer::on() with a Uri, UriBraces or UriGlob with a trailing '*') are
+ * indexed in a radix tree of their paths: static parts are edges, a "{}"
+ * argument is a child of its own, and a glob tail matches anything below its
+ * node. Each node keeps the methods of the routes below it, so a request only
+ * walks the branches of its method. The other handlers (UriRegex, other
+ * globs, serveStatic() and RequestHandler subclasses) are asked canHandle()
+ * as before.
+ *
+ * A request gets the handler registered first among those that match it, as
+ * with the list of handlers: a route is only taken when no handler asked in
+ * turn and registered before it handles the request. The index is built
+ * again on the first request after handlers were added or removed.
+ */
+
+#ifndef HTTP_ROUTER_MAX_ARGS
+#define HTTP_ROUTER_MAX_ARGS 8  // path arguments of an indexed route, more are asked in turn
+#endif
+
+class Uri;
+class WebServer;
+class RequestHandler;
+
+class RequestRouter {
+public:
+  RequestRouter() = default;
+  RequestRouter(const RequestRouter &) = delete;
+  RequestRouter &operator=(const RequestRouter &) = delete;
+
+  // The handlers changed
+  void invalidate();
+  // The first of handlers (the list of the server) that handles the request,
+  // with its path arguments set, nullptr if none
+  RequestHandler *find(WebServer &server, RequestHandler *handlers, HTTPMethod method, const String &uri);
+
+private:
+  struct Route {
+    uint16_t order;  // in the list of handlers
+    HTTPMethod method;
+    RequestHandler *handler;
+  };
+
+  struct Node {
+    String label;                    // matched on the way to the node, empty for an argument
+    std::vector<uint16_t> children;  // static, each with another first character
+    int16_t argument = -1;           // the child for a "{}" argument
+    std::vector<Route> routes;       // ending at the node
+    std::vector<Route> prefixes;     // matching anything after the node
+    uint64_t methods = 0;            // of the routes at the node and below
+  };
+
+  struct Span {
+    uint16_t offset;
+    uint16_t length;
+  };
+
+  // A request being routed, and the route with the lowest order so far
+  struct Lookup {
+    WebServer &server;
+    HTTPMethod method;
+    uint64_t methodBit;
+    const char *uri;
+    size_t length;
+    uint8_t argCount;
+    Span args[HTTP_ROUTER_MAX_ARGS];
+    uint16_t bestOrder;
+    RequestHandler *best;
+    uint8_t bestArgCount;
+    Span bestArgs[HTTP_ROUTER_MAX_ARGS];
+  };
+
+  void _build(RequestHandler *handlers);
+  bool _insert(const Uri &uri, const Route &route);
+  uint16_t _insertStatic(uint16_t node, const char *text, size_t length);
+  uint64_t _collectMethods(uint16_t node);
+  void _match(uint16_t node, size_t pos, Lookup &lookup) const;
+  void _matchArgument(uint16_t node, size_t pos, Lookup &lookup) const;
+  void _take(const std::vector<Route> &routes, Lookup &lookup) const;
+
+  std::vector<Node> _nodes;     // the root first
+  std::vector<Route> _fallback;  // asked canHandle() in turn
+  bool _valid = false;
+  RequestHandler *_routed = nullptr;  // whose routed flag is set
+};
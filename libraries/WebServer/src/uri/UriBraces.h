@@ -6,8 +6,12 @@
 class UriBraces : public Uri {
 
 public:
-  explicit UriBraces(const char *uri) : Uri(uri){};
-  explicit UriBraces(const String &uri) : Uri(uri){};
+  explicit UriBraces(const char *uri) : Uri(uri) {
+    _route = ROUTE_BRACES;
+  };
+  explicit UriBraces(const String &uri) : Uri(uri) {
+    _route = ROUTE_BRACES;
+  };
 
   Uri *clone() const override final {
     return new UriBraces(_uri);
@@ -7,8 +7,12 @@
 class UriGlob : public Uri {
 
 public:
-  explicit UriGlob(const char *uri) : Uri(uri){};
-  explicit UriGlob(const String &uri) : Uri(uri){};
+  explicit UriGlob(const char *uri) : Uri(uri) {
+    _route = globRoute();
+  };
+  explicit UriGlob(const String &uri) : Uri(uri) {
+    _route = globRoute();
+  };
 
   Uri *clone() const override final {
     return new UriGlob(_uri);
@@ -17,6 +21,18 @@ public:
   bool canHandle(const String &requestUri, __attribute__((unused)) std::vector<String> &pathArgs) override final {
     return fnmatch(_uri.c_str(), requestUri.c_str(), 0) == 0;
   }
+
+private:
+  // Without wildcards or with a trailing '*' only (which matches '/' as
+  // well), the pattern is indexed by the router. Other wildcards are left to
+  // fnmatch().
+  Route globRoute() const {
+    size_t special = strcspn(_uri.c_str(), "*?[\\");
+    if (special == _uri.length()) {
+      return ROUTE_EXACT;
+    }
+    return special == _uri.length() - 1 && _uri[special] == '*' ? ROUTE_PREFIX : ROUTE_NONE;
+  }
 };
 
 #endif
@@ -2,44 +2,43 @@
 #define URI_REGEX_H
 
 #include "Uri.h"
-#include <regex>
+#include "detail/RegexMatcher.h"
 
+// A path matched by a regular expression, its groups as path arguments. The
+// pattern is compiled once, see detail/RegexMatcher.h for the syntax.
 class UriRegex : public Uri {
 
 public:
-  explicit UriRegex(const char *uri) : Uri(uri){};
-  explicit UriRegex(const String &uri) : Uri(uri){};
+  explicit UriRegex(const char *uri) : Uri(uri) {
+    compile();
+  };
+  explicit UriRegex(const String &uri) : Uri(uri) {
+    compile();
+  };
 
   Uri *clone() const override final {
-    return new UriRegex(_uri);
+    return new UriRegex(*this);
   };
 
   void initPathArgs(std::vector<String> &pathArgs) override final {
-    std::regex rgx((_uri + "|").c_str());
-    std::smatch matches;
-    std::string s{""};
-    std::regex_search(s, matches, rgx);
-    pathArgs.resize(matches.size() - 1);
+    pathArgs.resize(_matcher.groups());
   }
 
   bool canHandle(const String &requestUri, std::vector<String> &pathArgs) override final {
     if (Uri::canHandle(requestUri, pathArgs)) {
       return true;
     }
+    return _matcher.search(requestUri.c_str(), requestUri.length(), pathArgs);
+  }
 
-    unsigned int pathArgIndex = 0;
-    std::regex rgx(_uri.c_str());
-    std::smatch matches;
-    std::string s(requestUri.c_str());
-    if (std::regex_search(s, matches, rgx)) {
-      for (size_t i = 1; i < matches.size(); ++i) {  // skip first
-        pathArgs[pathArgIndex] = String(matches[i].str().c_str());
-        pathArgIndex++;
-      }
-      return true;
+private:
+  void compile() {
+    if (!_matcher.compile(_uri.c_str())) {
+      log_e("UriRegex: %s is not a valid pattern or needs backtracking", _uri.c_str());
     }
-    return false;
   }
+
+  RegexMatcher _matcher;
 };
 
 #endif
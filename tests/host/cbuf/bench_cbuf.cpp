@@ -0,0 +1,153 @@
+/*
+ * cbuf throughput: the lock-free ring against the previous FreeRTOS ringbuf
+ * plus recursive mutex implementation (legacy_cbuf, built on the host shims).
+ */
+
+#include <thread>
+#include <bench.h>
+#include "cbuf.h"
+#include "legacy_cbuf.h"
+
+static const size_t BUFFER_SIZE = 1024;
+
+template<typename Buffer> static void bytes_round_trip(BenchState &state) {
+  Buffer buf(BUFFER_SIZE);
+  const size_t batch = 256;
+  for (auto _ : state) {
+    for (size_t i = 0; i < batch; i++) {
+      buf.write((char)i);
+    }
+    int sum = 0;
+    for (size_t i = 0; i < batch; i++) {
+      sum += buf.read();
+    }
+    benchDoNotOptimize(sum);
+  }
+  state.setBytesProcessed(state.iterations() * batch);
+}
+
+template<typename Buffer> static void blocks_round_trip(BenchState &state) {
+  Buffer buf(BUFFER_SIZE);
+  const size_t block = state.range(0);
+  char in[BUFFER_SIZE];
+  char out[BUFFER_SIZE];
+  memset(in, 0x5a, sizeof(in));
+  for (auto _ : state) {
+    // an odd offset keeps the wrap point moving
+    buf.write(in, block);
+    buf.read(out, block);
+    buf.write(in, 1);
+    buf.read(out, 1);
+    benchDoNotOptimize(out[0]);
+  }
+  state.setBytesProcessed(state.iterations() * (block + 1));
+}
+
+template<typename Buffer> static void peek_then_read(BenchState &state) {
+  Buffer buf(BUFFER_SIZE);
+  const size_t batch = 256;
+  for (auto _ : state) {
+    for (size_t i = 0; i < batch; i++) {
+      buf.write((char)i);
+    }
+    int sum = 0;
+    while (buf.peek() >= 0) {
+      sum += buf.read();
+    }
+    benchDoNotOptimize(sum);
+  }
+  state.setBytesProcessed(state.iterations() * batch);
+}
+
+template<typename Buffer> static void two_threads(BenchState &state) {
+  const size_t chunk = state.range(0);
+  const size_t total = 1 << 18;
+  for (auto _ : state) {
+    Buffer buf(BUFFER_SIZE);
+    std::thread producer([&buf, chunk, total]() {
+      char in[BUFFER_SIZE];
+      memset(in, 0x5a, sizeof(in));
+      size_t sent = 0;
+      while (sent < total) {
+        size_t n = buf.write(in, chunk);
+        if (!n) {
+          std::this_thread::yield();
+        }
+        sent += n;
+      }
+    });
+    char out[BUFFER_SIZE];
+    size_t received = 0;
+    while (received < total) {
+      size_t n = buf.read(out, chunk);
+      if (!n) {
+        std::this_thread::yield();
+      }
+      received += n;
+    }
+    producer.join();
+  }
+  state.setBytesProcessed(state.iterations() * total);
+}
+
+static void BM_CbufBytes(BenchState &state) {
+  bytes_round_trip<cbuf>(state);
+}
+static void BM_LegacyCbufBytes(BenchState &state) {
+  bytes_round_trip<legacy_cbuf>(state);
+}
+static void BM_CbufBlocks(BenchState &state) {
+  blocks_round_trip<cbuf>(state);
+}
+static void BM_LegacyCbufBlocks(BenchState &state) {
+  blocks_round_trip<legacy_cbuf>(state);
+}
+static void BM_CbufPeek(BenchState &state) {
+  peek_then_read<cbuf>(state);
+}
+static void BM_LegacyCbufPeek(BenchState &state) {
+  peek_then_read<legacy_cbuf>(state);
+}
+static void BM_CbufTwoThreads(BenchState &state) {
+  two_threads<cbuf>(state);
+}
+static void BM_LegacyCbufTwoThreads(BenchState &state) {
+  two_threads<legacy_cbuf>(state);
+}
+
+// Fill and drain in place through the span API, no intermediate copies
+static void BM_CbufSpans(BenchState &state) {
+  cbuf buf(BUFFER_SIZE);
+  const size_t block = state.range(0);
+  for (auto _ : state) {
+    size_t left = block;
+    char *wr = NULL;
+    size_t n = 0;
+    while (left && (n = buf.reserveWrite(&wr)) > 0) {
+      n = n < left ? n : left;
+      memset(wr, 0x5a, n);
+      buf.commitWrite(n);
+      left -= n;
+    }
+    const char *rd = NULL;
+    unsigned sum = 0;
+    while ((n = buf.peekSpan(&rd)) > 0) {
+      sum += (uint8_t)rd[n - 1];
+      buf.commitRead(n);
+    }
+    benchDoNotOptimize(sum);
+  }
+  state.setBytesProcessed(state.iterations() * block);
+}
+
+BENCHMARK(BM_CbufBytes);
+BENCHMARK(BM_LegacyCbufBytes);
+BENCHMARK(BM_CbufPeek);
+BENCHMARK(BM_LegacyCbufPeek);
+BENCHMARK(BM_CbufBlocks)->Arg(16)->Arg(128)->Arg(512);
+BENCHMARK(BM_LegacyCbufBlocks)->Arg(16)->Arg(128)->Arg(512);
+BENCHMARK(BM_CbufSpans)->Arg(16)->Arg(128)->Arg(512);
+BENCHMARK(BM_CbufTwoThreads)->Arg(1)->Arg(64);
+BENCHMARK(BM_LegacyCbufTwoThreads)->Arg(1)->Arg(64);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,186 @@
+/*
+ * Host test for cbuf: byte and block transfers, wrap-around, the zero-copy span
+ * API, resizing with pending data and a two-thread producer/consumer run.
+ */
+
+#include <thread>
+#include <unity.h>
+#include "cbuf.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+void test_cbuf_empty(void) {
+  cbuf buf(16);
+  TEST_ASSERT_EQUAL(16, buf.size());
+  TEST_ASSERT_EQUAL(16, buf.room());
+  TEST_ASSERT_EQUAL(0, buf.available());
+  TEST_ASSERT_TRUE(buf.empty());
+  TEST_ASSERT_FALSE(buf.full());
+  TEST_ASSERT_EQUAL(-1, buf.peek());
+  TEST_ASSERT_EQUAL(-1, buf.read());
+}
+
+void test_cbuf_bytes(void) {
+  cbuf buf(4);
+  TEST_ASSERT_EQUAL(1, buf.write('a'));
+  TEST_ASSERT_EQUAL(1, buf.write((char)0xff));
+  TEST_ASSERT_EQUAL(2, buf.available());
+  TEST_ASSERT_EQUAL('a', buf.peek());
+  TEST_ASSERT_EQUAL('a', buf.read());
+  // bytes above 0x7f must not be confused with the -1 "no data" marker
+  TEST_ASSERT_EQUAL(0xff, buf.peek());
+  TEST_ASSERT_EQUAL(0xff, buf.read());
+  TEST_ASSERT_EQUAL(-1, buf.read());
+}
+
+void test_cbuf_non_power_of_two_size(void) {
+  cbuf buf(10);
+  char data[16];
+  memset(data, 'x', sizeof(data));
+  TEST_ASSERT_EQUAL(10, buf.size());
+  TEST_ASSERT_EQUAL(10, buf.write(data, sizeof(data)));
+  TEST_ASSERT_TRUE(buf.full());
+  TEST_ASSERT_EQUAL(0, buf.write('y'));
+}
+
+void test_cbuf_wrap_around(void) {
+  cbuf buf(8);
+  char out[8];
+  TEST_ASSERT_EQUAL(6, buf.write("abcdef", 6));
+  TEST_ASSERT_EQUAL(4, buf.read(out, 4));
+  TEST_ASSERT_EQUAL_MEMORY("abcd", out, 4);
+  TEST_ASSERT_EQUAL(6, buf.write("ghijkl", 6));
+  TEST_ASSERT_EQUAL(8, buf.available());
+  TEST_ASSERT_EQUAL(8, buf.read(out, sizeof(out)));
+  TEST_ASSERT_EQUAL_MEMORY("efghijkl", out, 8);
+}
+
+void test_cbuf_remove_and_flush(void) {
+  cbuf buf(8);
+  buf.write("abcdef", 6);
+  TEST_ASSERT_EQUAL(4, buf.remove(2));
+  TEST_ASSERT_EQUAL('c', buf.read());
+  buf.flush();
+  TEST_ASSERT_TRUE(buf.empty());
+  TEST_ASSERT_EQUAL(8, buf.room());
+}
+
+void test_cbuf_spans(void) {
+  cbuf buf(8);
+  char *wr = NULL;
+  const char *rd = NULL;
+
+  // fill in place, then drain in place across the wrap point
+  buf.write("123456", 6);
+  buf.remove(6);
+  size_t n = buf.reserveWrite(&wr);
+  TEST_ASSERT_EQUAL(2, n);
+  memcpy(wr, "ab", 2);
+  buf.commitWrite(2);
+  n = buf.reserveWrite(&wr);
+  TEST_ASSERT_EQUAL(6, n);
+  memcpy(wr, "cd", 2);
+  buf.commitWrite(2);
+
+  TEST_ASSERT_EQUAL(2, buf.peekSpan(&rd));
+  TEST_ASSERT_EQUAL_MEMORY("ab", rd, 2);
+  buf.commitRead(2);
+  TEST_ASSERT_EQUAL(2, buf.peekSpan(&rd));
+  TEST_ASSERT_EQUAL_MEMORY("cd", rd, 2);
+  buf.commitRead(2);
+  TEST_ASSERT_EQUAL(0, buf.peekSpan(&rd));
+}
+
+void test_cbuf_resize_keeps_data(void) {
+  cbuf buf(8);
+  char out[32];
+  buf.write("abcdef", 6);
+  buf.remove(4);
+  buf.write("ghijkl", 6);  // wraps around
+  TEST_ASSERT_EQUAL(24, buf.resizeAdd(16));
+  TEST_ASSERT_EQUAL(24, buf.size());
+  TEST_ASSERT_EQUAL(8, buf.available());
+  TEST_ASSERT_EQUAL(16, buf.room());
+  TEST_ASSERT_EQUAL(4, buf.write("mnop", 4));
+  TEST_ASSERT_EQUAL(12, buf.read(out, sizeof(out)));
+  TEST_ASSERT_EQUAL_MEMORY("efghijklmnop", out, 12);
+}
+
+void test_cbuf_resize_refuses_to_drop_data(void) {
+  cbuf buf(8);
+  buf.write("abcdef", 6);
+  TEST_ASSERT_EQUAL(8, buf.resize(4));
+  TEST_ASSERT_EQUAL(6, buf.available());
+  // shrinking within the same storage only changes the usable size
+  TEST_ASSERT_EQUAL(6, buf.resize(6));
+  TEST_ASSERT_TRUE(buf.full());
+  TEST_ASSERT_EQUAL('a', buf.read());
+}
+
+void test_cbuf_zero_size(void) {
+  cbuf buf(0);
+  TEST_ASSERT_EQUAL(0, buf.size());
+  TEST_ASSERT_EQUAL(0, buf.write('a'));
+  TEST_ASSERT_EQUAL(4, buf.resize(4));
+  TEST_ASSERT_EQUAL(1, buf.write('a'));
+  TEST_ASSERT_EQUAL('a', buf.read());
+}
+
+void test_cbuf_producer_consumer(void) {
+  const size_t total = 1 << 18;
+  cbuf buf(61);
+  std::thread producer([&buf, total]() {
+    size_t sent = 0;
+    char chunk[37];
+    while (sent < total) {
+      size_t len = 0;
+      while (len < sizeof(chunk) && sent + len < total) {
+        chunk[len] = (char)((sent + len) * 7);
+        len++;
+      }
+      size_t offset = 0;
+      while (offset < len) {
+        size_t n = buf.write(chunk + offset, len - offset);
+        if (!n) {
+          std::this_thread::yield();
+        }
+        offset += n;
+      }
+      sent += len;
+    }
+  });
+
+  size_t received = 0;
+  bool ok = true;
+  while (received < total) {
+    const char *data = NULL;
+    size_t n = buf.peekSpan(&data);
+    for (size_t i = 0; i < n; i++) {
+      ok &= data[i] == (char)((received + i) * 7);
+    }
+    buf.commitRead(n);
+    received += n;
+    if (!n) {
+      std::this_thread::yield();
+    }
+  }
+  producer.join();
+  TEST_ASSERT_TRUE(ok);
+  TEST_ASSERT_TRUE(buf.empty());
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_cbuf_empty);
+  RUN_TEST(test_cbuf_bytes);
+  RUN_TEST(test_cbuf_non_power_of_two_size);
+  RUN_TEST(test_cbuf_wrap_around);
+  RUN_TEST(test_cbuf_remove_and_flush);
+  RUN_TEST(test_cbuf_spans);
+  RUN_TEST(test_cbuf_resize_keeps_data);
+  RUN_TEST(test_cbuf_resize_refuses_to_drop_data);
+  RUN_TEST(test_cbuf_zero_size);
+  RUN_TEST(test_cbuf_producer_consumer);
+  return UNITY_END();
+}
@@ -0,0 +1,139 @@
+/*
+ * Chip report export cost: a full report (two heaps, a typical partition
+ * table and a dozen attached pins) as JSON and as CBOR, against the same JSON
+ * written with Print::printf() one field at a time.
+ */
+
+#include <bench.h>
+#include <string>
+#include "chip-debug-report.h"
+#include "Print.h"
+
+class NullPrint : public Print {
+public:
+  size_t bytes = 0;
+  size_t write(uint8_t c) override {
+    bytes++;
+    return 1;
+  }
+  size_t write(const uint8_t *buffer, size_t size) override {
+    bytes += size;
+    return size;
+  }
+};
+
+class CapturePrint : public Print {
+public:
+  std::string data;
+  size_t write(uint8_t c) override {
+    data += (char)c;
+    return 1;
+  }
+  size_t write(const uint8_t *buffer, size_t size) override {
+    data.append((const char *)buffer, size);
+    return size;
+  }
+};
+
+static chip_report_t s_report;
+
+static void init_report(void) {
+  static const char *names[] = {"GPIO", "UART_TX", "UART_RX", "I2C_MASTER_SDA", "I2C_MASTER_SCL", "LEDC"};
+  s_report.parts = CHIP_REPORT_ALL;
+  s_report.uptimeUs = 86400000000ULL;
+  s_report.chip = {9, 2, 2, 0x12, 240, 8388608, "v5.5", "3.3.0", "0123456789abcdef"};
+  s_report.heapCount = 2;
+  s_report.heap[0] = {"INTERNAL", 0x800, 380000, 300000, 80000, 250000, 120000, 12, 600};
+  s_report.heap[1] = {"SPIRAM", 0x400, 8388608, 8300000, 88608, 8200000, 8290000, 3, 1};
+  s_report.partitionCount = 6;
+  s_report.partitions[0] = {"nvs", 1, 2, 0x9000, 0x5000};
+  s_report.partitions[1] = {"otadata", 1, 0, 0xe000, 0x2000};
+  s_report.partitions[2] = {"app0", 0, 0x10, 0x10000, 0x140000};
+  s_report.partitions[3] = {"app1", 0, 0x11, 0x150000, 0x140000};
+  s_report.partitions[4] = {"spiffs", 1, 0x82, 0x290000, 0x160000};
+  s_report.partitions[5] = {"coredump", 1, 3, 0x3F0000, 0x10000};
+  s_report.pinCount = 12;
+  for (uint8_t i = 0; i < 12; i++) {
+    s_report.pins[i] = {(uint8_t)(i * 3 + 1), (uint8_t)(i % 6 + 1), (int8_t)(i % 2), (int8_t)(i % 4 == 0 ? -1 : i), names[i % 6]};
+  }
+}
+
+// The same JSON the way printJSON() of freertos_stats writes it
+static size_t printf_json(const chip_report_t *r, Print &out) {
+  const chip_report_chip_t &c = r->chip;
+  size_t n = out.printf("{\"version\":%u,\"uptime\":%llu", CHIP_REPORT_VERSION, (unsigned long long)r->uptimeUs);
+  n += out.printf(
+    ",\"chip\":{\"model\":%u,\"revision\":%u,\"cores\":%u,\"features\":%lu,\"cpuFreqMHz\":%lu,\"flashSize\":%lu,\"idf\":\"%s\",\"arduino\":\"%s\","
+    "\"elfSha256\":\"%s\"}",
+    c.model, c.revision, c.cores, (unsigned long)c.features, (unsigned long)c.cpuFreqMHz, (unsigned long)c.flashSize, c.idfVersion, c.arduinoVersion,
+    c.elfSha256
+  );
+  n += out.print(",\"heap\":[");
+  for (uint8_t i = 0; i < r->heapCount; i++) {
+    const chip_report_heap_t &h = r->heap[i];
+    n += out.printf(
+      "%s{\"name\":\"%s\",\"caps\":%lu,\"total\":%lu,\"free\":%lu,\"allocated\":%lu,\"minimumFree\":%lu,\"largestFree\":%lu,\"freeBlocks\":%lu,"
+      "\"fragmentation\":%u}",
+      i ? "," : "", h.name, (unsigned long)h.caps, (unsigned long)h.total, (unsigned long)h.free, (unsigned long)h.allocated,
+      (unsigned long)h.minimumFree, (unsigned long)h.largestFree, (unsigned long)h.freeBlocks, h.fragmentation
+    );
+  }
+  n += out.print("],\"partitions\":[");
+  for (uint8_t i = 0; i < r->partitionCount; i++) {
+    const chip_report_partition_t &p = r->partitions[i];
+    n += out.printf(
+      "%s{\"label\":\"%s\",\"type\":%u,\"subtype\":%u,\"address\":%lu,\"size\":%lu}", i ? "," : "", p.label, p.type, p.subtype, (unsigned long)p.address,
+      (unsigned long)p.size
+    );
+  }
+  n += out.print("],\"pins\":[");
+  for (uint8_t i = 0; i < r->pinCount; i++) {
+    const chip_report_pin_t &p = r->pins[i];
+    n += out.printf("%s{\"gpio\":%u,\"type\":%u,\"name\":\"%s\",\"bus\":%d,\"channel\":%d}", i ? "," : "", p.gpio, p.type, p.name, p.bus, p.channel);
+  }
+  return n + out.print("]}");
+}
+
+static void BM_PrintJSON(BenchState &state) {
+  NullPrint out;
+  for (auto _ : state) {
+    chipReportPrintJSON(&s_report, out);
+  }
+  state.setBytesProcessed(out.bytes);
+  state.setItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PrintJSON);
+
+static void BM_WriteCBOR(BenchState &state) {
+  NullPrint out;
+  for (auto _ : state) {
+    chipReportWriteCBOR(&s_report, out);
+  }
+  state.setBytesProcessed(out.bytes);
+  state.setItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_WriteCBOR);
+
+static void BM_PrintfJSON(BenchState &state) {
+  NullPrint out;
+  for (auto _ : state) {
+    printf_json(&s_report, out);
+  }
+  state.setBytesProcessed(out.bytes);
+  state.setItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PrintfJSON);
+
+int main(int argc, char **argv) {
+  init_report();
+  CapturePrint json, reference, cbor;
+  chipReportPrintJSON(&s_report, json);
+  printf_json(&s_report, reference);
+  chipReportWriteCBOR(&s_report, cbor);
+  if (json.data != reference.data) {
+    fprintf(stderr, "JSON differs from the printf() one\n");
+    return 1;
+  }
+  printf("report: %u bytes of JSON, %u bytes of CBOR\n", (unsigned)json.data.size(), (unsigned)cbor.data.size());
+  return benchMain(argc, argv);
+}
@@ -0,0 +1,210 @@
+/*
+ * Host tests for the chip report exports: the JSON text of a filled report,
+ * reports with only some parts collected, string escaping, and the CBOR
+ * encoding, decoded back and compared with the JSON.
+ */
+
+#include <unity.h>
+#include <string>
+#include "chip-debug-report.h"
+#include "Print.h"
+
+// Keeps every byte written, binary or not
+class CapturePrint : public Print {
+public:
+  std::string data;
+  size_t write(uint8_t c) override {
+    data += (char)c;
+    return 1;
+  }
+  size_t write(const uint8_t *buffer, size_t size) override {
+    data.append((const char *)buffer, size);
+    return size;
+  }
+};
+
+static chip_report_t report;
+
+static void fill_report(void) {
+  memset(&report, 0, sizeof(report));
+  report.parts = CHIP_REPORT_ALL;
+  report.uptimeUs = 5000000000ULL;
+  report.chip.model = 9;
+  report.chip.revision = 2;
+  report.chip.cores = 2;
+  report.chip.features = 0x12;
+  report.chip.cpuFreqMHz = 240;
+  report.chip.flashSize = 8388608;
+  report.chip.idfVersion = "v5.5";
+  report.chip.arduinoVersion = "3.3.0";
+  strcpy(report.chip.elfSha256, "0123456789abcdef");
+  report.heapCount = 2;
+  report.heap[0] = {"INTERNAL", 0x800, 380000, 300000, 80000, 250000, 120000, 12, 600};
+  report.heap[1] = {"SPIRAM", 0x400, 8388608, 8300000, 88608, 8200000, 8290000, 3, 1};
+  report.partitionCount = 3;
+  report.partitions[0] = {"nvs", 1, 2, 0x9000, 0x5000};
+  report.partitions[1] = {"app0", 0, 0x10, 0x10000, 0x140000};
+  report.partitions[2] = {"spiffs", 1, 0x82, 0x290000, 0x160000};
+  report.pinCount = 2;
+  report.pins[0] = {1, 3, 0, -1, "UART_TX"};
+  report.pins[1] = {21, 30, 0, 5, "LEDC"};
+}
+
+static std::string json(void) {
+  CapturePrint out;
+  size_t n = chipReportPrintJSON(&report, out);
+  TEST_ASSERT_EQUAL(out.data.size(), n);
+  return out.data;
+}
+
+static std::string cbor(void) {
+  CapturePrint out;
+  size_t n = chipReportWriteCBOR(&report, out);
+  TEST_ASSERT_EQUAL(out.data.size(), n);
+  return out.data;
+}
+
+// Decodes the CBOR subset the report uses back into the JSON text
+static std::string cbor_to_json(const std::string &in, size_t &pos) {
+  uint8_t initial = (uint8_t)in[pos++];
+  uint8_t major = initial >> 5;
+  uint8_t info = initial & 0x1F;
+  if (initial == 0xF6) {
+    return "null";
+  }
+  uint64_t value = info;
+  if (info >= 24) {
+    size_t size = (size_t)1 << (info - 24);
+    value = 0;
+    for (size_t i = 0; i < size; i++) {
+      value = (value << 8) | (uint8_t)in[pos++];
+    }
+  }
+  std::string out;
+  switch (major) {
+    case 0: return std::to_string(value);
+    case 1: return std::to_string(-1 - (int64_t)value);
+    case 3:
+    {
+      out = "\"";
+      for (size_t i = 0; i < value; i++) {
+        char c = in[pos++];
+        if (c == '"' || c == '\\') {
+          out += '\\';
+          out += c;
+        } else if ((uint8_t)c < 0x20) {
+          char esc[7];
+          snprintf(esc, sizeof(esc), "\\u%04x", (uint8_t)c);
+          out += esc;
+        } else {
+          out += c;
+        }
+      }
+      return out + "\"";
+    }
+    case 4:
+      out = "[";
+      for (uint64_t i = 0; i < value; i++) {
+        out += (i ? "," : "") + cbor_to_json(in, pos);
+      }
+      return out + "]";
+    case 5:
+      out = "{";
+      for (uint64_t i = 0; i < value; i++) {
+        out += (i ? "," : "") + cbor_to_json(in, pos);
+        out += ":" + cbor_to_json(in, pos);
+      }
+      return out + "}";
+    default: TEST_FAIL_MESSAGE("unexpected CBOR major type"); return "";
+  }
+}
+
+void setUp(void) {
+  fill_report();
+}
+
+void tearDown(void) {}
+
+void test_chip_report_json(void) {
+  TEST_ASSERT_EQUAL_STRING(
+    "{\"version\":1,\"uptime\":5000000000,"
+    "\"chip\":{\"model\":9,\"revision\":2,\"cores\":2,\"features\":18,\"cpuFreqMHz\":240,\"flashSize\":8388608,"
+    "\"idf\":\"v5.5\",\"arduino\":\"3.3.0\",\"elfSha256\":\"0123456789abcdef\"},"
+    "\"heap\":[{\"name\":\"INTERNAL\",\"caps\":2048,\"total\":380000,\"free\":300000,\"allocated\":80000,\"minimumFree\":250000,"
+    "\"largestFree\":120000,\"freeBlocks\":12,\"fragmentation\":600},"
+    "{\"name\":\"SPIRAM\",\"caps\":1024,\"total\":8388608,\"free\":8300000,\"allocated\":88608,\"minimumFree\":8200000,"
+    "\"largestFree\":8290000,\"freeBlocks\":3,\"fragmentation\":1}],"
+    "\"partitions\":[{\"label\":\"nvs\",\"type\":1,\"subtype\":2,\"address\":36864,\"size\":20480},"
+    "{\"label\":\"app0\",\"type\":0,\"subtype\":16,\"address\":65536,\"size\":1310720},"
+    "{\"label\":\"spiffs\",\"type\":1,\"subtype\":130,\"address\":2686976,\"size\":1441792}],"
+    "\"pins\":[{\"gpio\":1,\"type\":3,\"name\":\"UART_TX\",\"bus\":0,\"channel\":-1},"
+    "{\"gpio\":21,\"type\":30,\"name\":\"LEDC\",\"bus\":0,\"channel\":5}]}",
+    json().c_str()
+  );
+}
+
+void test_chip_report_parts(void) {
+  report.parts = CHIP_REPORT_HEAP | CHIP_REPORT_PINS;
+  report.heapCount = 1;
+  report.pinCount = 0;
+  TEST_ASSERT_EQUAL_STRING(
+    "{\"version\":1,\"uptime\":5000000000,"
+    "\"heap\":[{\"name\":\"INTERNAL\",\"caps\":2048,\"total\":380000,\"free\":300000,\"allocated\":80000,\"minimumFree\":250000,"
+    "\"largestFree\":120000,\"freeBlocks\":12,\"fragmentation\":600}],\"pins\":[]}",
+    json().c_str()
+  );
+  report.parts = 0;
+  report.uptimeUs = 0;
+  TEST_ASSERT_EQUAL_STRING("{\"version\":1,\"uptime\":0}", json().c_str());
+}
+
+void test_chip_report_json_escapes(void) {
+  report.parts = CHIP_REPORT_CHIP | CHIP_REPORT_PARTITIONS;
+  report.chip.idfVersion = nullptr;
+  report.chip.arduinoVersion = "say \"hi\"\\";
+  report.partitionCount = 1;
+  strcpy(report.partitions[0].label, "a\tb\x01");
+  std::string text = json();
+  TEST_ASSERT_TRUE(text.find("\"idf\":null,\"arduino\":\"say \\\"hi\\\"\\\\\",") != std::string::npos);
+  TEST_ASSERT_TRUE(text.find("\"label\":\"a\\u0009b\\u0001\"") != std::string::npos);
+}
+
+void test_chip_report_cbor_bytes(void) {
+  report.parts = 0;
+  report.uptimeUs = 0;
+  TEST_ASSERT_EQUAL_STRING("\xA2\x67version\x01\x66uptime", cbor().c_str());
+  TEST_ASSERT_EQUAL(18, cbor().size());
+  // argument sizes at each boundary
+  const uint64_t values[] = {23, 24, 255, 256, 65535, 65536, 0xFFFFFFFFULL, 0x100000000ULL};
+  const size_t sizes[] = {1, 2, 2, 3, 3, 5, 5, 9};
+  for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+    report.uptimeUs = values[i];
+    std::string data = cbor();
+    TEST_ASSERT_EQUAL(17 + sizes[i], data.size());
+    size_t pos = 0;
+    TEST_ASSERT_EQUAL_STRING(("{\"version\":1,\"uptime\":" + std::to_string(values[i]) + "}").c_str(), cbor_to_json(data, pos).c_str());
+  }
+}
+
+void test_chip_report_cbor_matches_json(void) {
+  std::string data = cbor();
+  size_t pos = 0;
+  TEST_ASSERT_EQUAL_STRING(json().c_str(), cbor_to_json(data, pos).c_str());
+  TEST_ASSERT_EQUAL(data.size(), pos);
+  TEST_ASSERT_LESS_THAN(json().size(), data.size());
+
+  test_chip_report_json_escapes();
+  data = cbor();
+  pos = 0;
+  TEST_ASSERT_EQUAL_STRING(json().c_str(), cbor_to_json(data, pos).c_str());
+}
+
+int main(void) {
+  UNITY_BEGIN();
+  RUN_TEST(test_chip_report_json);
+  RUN_TEST(test_chip_report_parts);
+  RUN_TEST(test_chip_report_json_escapes);
+  RUN_TEST(test_chip_report_cbor_bytes);
+  RUN_TEST(test_chip_report_cbor_matches_json);
+  return UNITY_END();
+}
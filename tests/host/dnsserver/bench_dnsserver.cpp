@@ -0,0 +1,59 @@
+/*
+ * DNSServer query handling cost, from the datagram handed in by the AsyncUDP
+ * stand-in to the reply it captures.
+ */
+
+#include <bench.h>
+#include <string>
+#include "DNSServer.h"
+
+static const uint16_t port = 5353;
+static size_t s_replied;
+
+static std::string query(const char *name) {
+  std::string packet("\x12\x34\x01\x00\x00\x01\x00\x00\x00\x00\x00\x00", 12);
+  const char *label = name;
+  while (*label) {
+    const char *dot = strchr(label, '.');
+    size_t len = dot ? dot - label : strlen(label);
+    packet += (char)len;
+    packet.append(label, len);
+    label += len + (dot ? 1 : 0);
+  }
+  packet.append("\0\0\1\0\1", 5);
+  return packet;
+}
+
+static void run_queries(BenchState &state, const char *domain, const char *name) {
+  DNSServer dns;
+  dns.start(port, domain, IPAddress(192, 168, 4, 1));
+  AsyncUDP::hostOnSend([](const uint8_t *data, size_t len, const IPAddress &, uint16_t) {
+    s_replied += len;
+  });
+  std::string packet = query(name);
+  IPAddress client(192, 168, 4, 2);
+  for (auto _ : state) {
+    AsyncUDP::hostDeliver(port, (const uint8_t *)packet.data(), packet.size(), client, 40000);
+  }
+  benchDoNotOptimize(s_replied);
+  dns.stop();
+  AsyncUDP::hostOnSend(nullptr);
+  state.setItemsProcessed(state.iterations());
+}
+
+static void BM_DNSServerWildcard(BenchState &state) {
+  run_queries(state, "*", "connectivitycheck.gstatic.com");
+}
+BENCHMARK(BM_DNSServerWildcard);
+
+static void BM_DNSServerDomainMatch(BenchState &state) {
+  run_queries(state, "captive.local", "www.captive.local");
+}
+BENCHMARK(BM_DNSServerDomainMatch);
+
+static void BM_DNSServerOtherDomain(BenchState &state) {
+  run_queries(state, "captive.local", "connectivitycheck.gstatic.com");
+}
+BENCHMARK(BM_DNSServerOtherDomain);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,135 @@
+/*
+ * Host tests for the DNSServer replies. Queries are handed to the server
+ * through the AsyncUDP stand-in, which also captures the replies.
+ */
+
+#include <unity.h>
+#include <string>
+#include "DNSServer.h"
+
+static const uint16_t port = 5353;
+static const IPAddress resolved(192, 168, 4, 1);
+static const IPAddress client(192, 168, 4, 2);
+
+static DNSServer *s_dns;
+static std::string s_reply;
+static int s_replies;
+
+// A query with one question, id 0x1234 and recursion desired
+static std::string query(const char *name, uint16_t type) {
+  std::string packet("\x12\x34\x01\x00\x00\x01\x00\x00\x00\x00\x00\x00", 12);
+  const char *label = name;
+  while (*label) {
+    const char *dot = strchr(label, '.');
+    size_t len = dot ? dot - label : strlen(label);
+    packet += (char)len;
+    packet.append(label, len);
+    label += len + (dot ? 1 : 0);
+  }
+  packet += '\0';
+  packet += (char)(type >> 8);
+  packet += (char)type;
+  packet += '\0';
+  packet += '\1';
+  return packet;
+}
+
+static bool ask(const std::string &packet) {
+  s_reply.clear();
+  s_replies = 0;
+  return AsyncUDP::hostDeliver(port, (const uint8_t *)packet.data(), packet.size(), client, 40000);
+}
+
+static uint16_t u16(size_t pos) {
+  return ((uint8_t)s_reply[pos] << 8) | (uint8_t)s_reply[pos + 1];
+}
+
+void setUp(void) {
+  AsyncUDP::hostOnSend([](const uint8_t *data, size_t len, const IPAddress &addr, uint16_t remotePort) {
+    TEST_ASSERT_TRUE(addr == client);
+    TEST_ASSERT_EQUAL(40000, remotePort);
+    s_reply.assign((const char *)data, len);
+    s_replies++;
+  });
+  s_dns = new DNSServer();
+}
+
+void tearDown(void) {
+  s_dns->stop();
+  delete s_dns;
+  AsyncUDP::hostOnSend(nullptr);
+}
+
+void test_dnsserver_wildcard_answer(void) {
+  TEST_ASSERT_TRUE(s_dns->start(port, "*", resolved));
+  std::string q = query("anything.example.com", DNS_TYPE_A);
+  TEST_ASSERT_TRUE(ask(q));
+  TEST_ASSERT_EQUAL(1, s_replies);
+  TEST_ASSERT_EQUAL(0x1234, u16(0));
+  TEST_ASSERT_EQUAL(0x81, (uint8_t)s_reply[2]);  // response, recursion desired
+  TEST_ASSERT_EQUAL(0, (uint8_t)s_reply[3] & 0x0F);
+  TEST_ASSERT_EQUAL(1, u16(4));  // questions
+  TEST_ASSERT_EQUAL(1, u16(6));  // answers
+  // the question is echoed, the answer points back at it
+  TEST_ASSERT_EQUAL_MEMORY(q.data() + 12, s_reply.data() + 12, q.size() - 12);
+  size_t answer = q.size();
+  TEST_ASSERT_EQUAL(0xC00C, u16(answer));
+  TEST_ASSERT_EQUAL(DNS_TYPE_A, u16(answer + 2));
+  TEST_ASSERT_EQUAL(DNS_CLASS_IN, u16(answer + 4));
+  TEST_ASSERT_EQUAL(DNS_DEFAULT_TTL, ((uint32_t)u16(answer + 6) << 16) | u16(answer + 8));
+  TEST_ASSERT_EQUAL(4, u16(answer + 10));
+  TEST_ASSERT_EQUAL_MEMORY("\xC0\xA8\x04\x01", s_reply.data() + answer + 12, 4);
+  TEST_ASSERT_EQUAL(answer + 16, s_reply.size());
+}
+
+void test_dnsserver_domain_match(void) {
+  TEST_ASSERT_TRUE(s_dns->start(port, "Captive.Local", resolved));
+  TEST_ASSERT_TRUE(ask(query("www.captive.local", DNS_TYPE_A)));
+  TEST_ASSERT_EQUAL(1, u16(6));
+  TEST_ASSERT_TRUE(ask(query("CAPTIVE.local", DNS_TYPE_A)));
+  TEST_ASSERT_EQUAL(1, u16(6));
+}
+
+void test_dnsserver_other_domain(void) {
+  TEST_ASSERT_TRUE(s_dns->start(port, "captive.local", resolved));
+  TEST_ASSERT_TRUE(ask(query("example.com", DNS_TYPE_A)));
+  TEST_ASSERT_EQUAL(1, s_replies);
+  TEST_ASSERT_EQUAL((int)DNSReplyCode::NonExistentDomain, (uint8_t)s_reply[3] & 0x0F);
+  TEST_ASSERT_EQUAL(0, u16(4));
+  TEST_ASSERT_EQUAL(DNS_HEADER_SIZE, s_reply.size());
+}
+
+void test_dnsserver_no_ipv6_answer(void) {
+  TEST_ASSERT_TRUE(s_dns->start(port, "*", resolved));
+  TEST_ASSERT_TRUE(ask(query("example.com", DNS_TYPE_AAAA)));
+  TEST_ASSERT_EQUAL(0, (uint8_t)s_reply[3] & 0x0F);
+  TEST_ASSERT_EQUAL(0, u16(6));  // no answer
+  TEST_ASSERT_EQUAL(1, u16(8));  // SOA in the authority section
+}
+
+void test_dnsserver_ignores_malformed(void) {
+  TEST_ASSERT_TRUE(s_dns->start(port, "*", resolved));
+  std::string q = query("example.com", DNS_TYPE_A);
+  TEST_ASSERT_TRUE(ask(q.substr(0, 16)));
+  TEST_ASSERT_EQUAL(0, s_replies);
+  q[2] |= 0x80;  // a response, not a query
+  TEST_ASSERT_TRUE(ask(q));
+  TEST_ASSERT_EQUAL(0, s_replies);
+}
+
+void test_dnsserver_stop(void) {
+  TEST_ASSERT_TRUE(s_dns->start(port, "*", resolved));
+  s_dns->stop();
+  TEST_ASSERT_FALSE(ask(query("example.com", DNS_TYPE_A)));
+}
+
+int main(void) {
+  UNITY_BEGIN();
+  RUN_TEST(test_dnsserver_wildcard_answer);
+  RUN_TEST(test_dnsserver_domain_match);
+  RUN_TEST(test_dnsserver_other_domain);
+  RUN_TEST(test_dnsserver_no_ipv6_answer);
+  RUN_TEST(test_dnsserver_ignores_malformed);
+  RUN_TEST(test_dnsserver_stop);
+  return UNITY_END();
+}
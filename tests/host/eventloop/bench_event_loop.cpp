@@ -0,0 +1,138 @@
+/*
+ * Event loop costs: posting and running deferred calls on one thread, and
+ * the round trip from another thread to the loop and back, with the CPU time
+ * the loop thread uses meanwhile. The baselines are the loop() polling a flag
+ * the way sketches poll handleClient() and friends: back to back, as loopTask
+ * runs it, and with a delay(1) between the polls.
+ */
+
+#include <bench.h>
+#include <time.h>
+#include <atomic>
+#include <thread>
+#include "EventLoop.h"
+
+static void noop(void *arg) {
+  benchDoNotOptimize(arg);
+}
+
+static void BM_PostRun(BenchState &state) {
+  size_t batch = state.range(0);
+  EventLoop loop;
+  loop.begin(batch);
+  for (auto _ : state) {
+    for (size_t i = 0; i < batch; i++) {
+      loop.post(noop, &loop);
+    }
+    loop.runOnce(0);
+  }
+  state.setItemsProcessed(state.iterations() * batch);
+}
+BENCHMARK(BM_PostRun)->Arg(1)->Arg(32);
+
+static std::atomic<bool> s_request;
+static std::atomic<bool> s_reply;
+static std::atomic<bool> s_stop;
+
+static uint64_t thread_cpu_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void reply(void *arg) {
+  s_reply.store(true, std::memory_order_release);
+}
+
+// Runs body on a loop thread while the iterations ask it for a reply, the
+// counter is the share of a core the loop thread used
+template<typename Body, typename Ask> static void round_trips(BenchState &state, Body body, Ask ask) {
+  std::atomic<bool> ready(false);
+  std::atomic<uint64_t> cpu(0);
+  s_stop = false;
+  std::thread thread([&]() {
+    uint64_t start = thread_cpu_ns();
+    body(ready);
+    cpu = thread_cpu_ns() - start;
+  });
+  while (!ready) {
+    std::this_thread::yield();
+  }
+  auto wallStart = std::chrono::steady_clock::now();
+  for (auto _ : state) {
+    s_reply.store(false, std::memory_order_relaxed);
+    ask();
+    while (!s_reply.load(std::memory_order_acquire)) {
+      std::this_thread::yield();
+    }
+  }
+  state.stop();
+  double wall = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - wallStart).count();
+  s_stop = true;
+  thread.join();
+  state.setItemsProcessed(state.iterations());
+  state.setCounter("loop cpu %", wall > 0 ? 100.0 * cpu / wall : 0);
+}
+
+static EventLoop *s_loop;
+
+static void BM_EventLoopRoundTrip(BenchState &state) {
+  EventLoop loop;
+  s_loop = &loop;
+  round_trips(
+    state,
+    [&loop](std::atomic<bool> &ready) {
+      loop.begin();
+      ready = true;
+      while (!s_stop) {
+        loop.runOnce(10);
+      }
+      loop.end();
+    },
+    []() {
+      s_loop->post(reply);
+    }
+  );
+}
+BENCHMARK(BM_EventLoopRoundTrip);
+
+// loop() checking for work back to back
+static void BM_PollRoundTrip(BenchState &state) {
+  round_trips(
+    state,
+    [](std::atomic<bool> &ready) {
+      ready = true;
+      while (!s_stop) {
+        if (s_request.exchange(false, std::memory_order_acquire)) {
+          reply(nullptr);
+        }
+      }
+    },
+    []() {
+      s_request.store(true, std::memory_order_release);
+    }
+  );
+}
+BENCHMARK(BM_PollRoundTrip);
+
+// loop() checking for work with a delay(1) after each check
+static void BM_PollDelayRoundTrip(BenchState &state) {
+  round_trips(
+    state,
+    [](std::atomic<bool> &ready) {
+      ready = true;
+      while (!s_stop) {
+        if (s_request.exchange(false, std::memory_order_acquire)) {
+          reply(nullptr);
+        }
+        vTaskDelay(1);
+      }
+    },
+    []() {
+      s_request.store(true, std::memory_order_release);
+    }
+  );
+}
+BENCHMARK(BM_PollDelayRoundTrip);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,341 @@
+/*
+ * Host tests for the loop task event loop, run on the test thread: deferred
+ * calls posted from several threads and from an "ISR", a full queue, timers
+ * (order, periods, cancelling and rescheduling from a callback), descriptor
+ * watches on a socket pair, waking a wait in select(), idle timeouts and the
+ * notification index the loop keeps to itself.
+ */
+
+#include <unity.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include <sys/socket.h>
+#include "EventLoop.h"
+#include "esp_timer.h"
+
+static EventLoop *loop;
+static std::vector<int> calls;
+
+static void record(void *arg) {
+  calls.push_back((int)(intptr_t)arg);
+}
+
+static uint64_t elapsed_since(uint64_t start) {
+  return esp_timer_get_time() - start;
+}
+
+void setUp(void) {
+  calls.clear();
+  loop = new EventLoop();
+  TEST_ASSERT_TRUE(loop->begin(64));
+}
+
+void tearDown(void) {
+  delete loop;
+}
+
+void test_event_loop_post_order(void) {
+  for (int i = 0; i < 10; i++) {
+    TEST_ASSERT_TRUE(loop->post(record, (void *)(intptr_t)i));
+  }
+  TEST_ASSERT_EQUAL(10, loop->runOnce(0));
+  TEST_ASSERT_EQUAL(10, calls.size());
+  for (int i = 0; i < 10; i++) {
+    TEST_ASSERT_EQUAL(i, calls[i]);
+  }
+  TEST_ASSERT_EQUAL(0, loop->runOnce(0));
+}
+
+void test_event_loop_queue_full(void) {
+  for (int i = 0; i < 64; i++) {
+    TEST_ASSERT_TRUE(loop->post(record, (void *)(intptr_t)i));
+  }
+  TEST_ASSERT_FALSE(loop->post(record, (void *)64));
+  TEST_ASSERT_EQUAL(1, loop->dropped());
+  TEST_ASSERT_EQUAL(64, loop->runOnce(0));
+  TEST_ASSERT_TRUE(loop->post(record, (void *)65));
+  TEST_ASSERT_EQUAL(1, loop->runOnce(0));
+  TEST_ASSERT_EQUAL(65, calls.back());
+  TEST_ASSERT_FALSE(EventLoop().post(record));
+}
+
+static void repost(void *arg) {
+  calls.push_back(0);
+  loop->post(repost, arg);
+}
+
+void test_event_loop_repost_bounded(void) {
+  // a call that posts itself runs once per round
+  loop->post(repost);
+  TEST_ASSERT_EQUAL(1, loop->runOnce(0));
+  TEST_ASSERT_EQUAL(1, loop->runOnce(0));
+  TEST_ASSERT_EQUAL(2, calls.size());
+}
+
+static std::atomic<uint32_t> s_sum;
+static std::vector<uint32_t> s_last;
+
+static void count_call(void *arg) {
+  uint32_t value = (uint32_t)(uintptr_t)arg;
+  uint32_t producer = value >> 24;
+  uint32_t seq = value & 0xFFFFFF;
+  // the calls of one producer run in the order it posted them
+  TEST_ASSERT_EQUAL(s_last[producer] + 1, seq);
+  s_last[producer] = seq;
+  s_sum++;
+}
+
+void test_event_loop_concurrent_producers(void) {
+  const uint32_t producers = 4;
+  const uint32_t perProducer = 20000;
+  s_sum = 0;
+  s_last.assign(producers, 0);
+  std::vector<std::thread> threads;
+  for (uint32_t p = 0; p < producers; p++) {
+    threads.emplace_back([p]() {
+      // half the producers post from "ISR" context
+      hostSetIsrContext(p & 1);
+      for (uint32_t i = 1; i <= perProducer; i++) {
+        while (!loop->post(count_call, (void *)(uintptr_t)((p << 24) | i))) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  uint64_t start = esp_timer_get_time();
+  while (s_sum < producers * perProducer && elapsed_since(start) < 10000000) {
+    loop->runOnce(100);
+  }
+  for (std::thread &t : threads) {
+    t.join();
+  }
+  TEST_ASSERT_EQUAL(producers * perProducer, s_sum.load());
+}
+
+void test_event_loop_post_wakes(void) {
+  // the wait ends on the post, not on the timeout
+  std::thread producer([]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    hostSetIsrContext(true);
+    loop->post(record, (void *)7);
+  });
+  uint64_t start = esp_timer_get_time();
+  TEST_ASSERT_EQUAL(1, loop->runOnce(5000));
+  uint64_t waited = elapsed_since(start);
+  producer.join();
+  TEST_ASSERT_GREATER_OR_EQUAL(15000, waited);
+  TEST_ASSERT_LESS_THAN(1000000, waited);
+  TEST_ASSERT_EQUAL(7, calls[0]);
+}
+
+void test_event_loop_idle_timeout(void) {
+  uint64_t start = esp_timer_get_time();
+  TEST_ASSERT_EQUAL(0, loop->runOnce(30));
+  uint64_t waited = elapsed_since(start);
+  TEST_ASSERT_GREATER_OR_EQUAL(30000, waited);
+  TEST_ASSERT_LESS_THAN(1000000, waited);
+  // the maximum idle time caps the timeout
+  loop->setMaxIdle(10);
+  start = esp_timer_get_time();
+  TEST_ASSERT_EQUAL(0, loop->runOnce());
+  waited = elapsed_since(start);
+  TEST_ASSERT_GREATER_OR_EQUAL(10000, waited);
+  TEST_ASSERT_LESS_THAN(1000000, waited);
+  // a wake() ends the wait without running anything
+  loop->setMaxIdle(EVENT_LOOP_FOREVER);
+  loop->wake();
+  TEST_ASSERT_EQUAL(0, loop->runOnce(0));
+}
+
+void test_event_loop_own_notification(void) {
+  // a notification given to the loop task at index 0 neither wakes the loop
+  // nor is taken by it, and a post does not notify index 0
+  xTaskNotifyGive(xTaskGetCurrentTaskHandle());
+  uint64_t start = esp_timer_get_time();
+  TEST_ASSERT_EQUAL(0, loop->runOnce(30));
+  TEST_ASSERT_GREATER_OR_EQUAL(30000, elapsed_since(start));
+  TEST_ASSERT_TRUE(loop->post(record, (void *)1));
+  TEST_ASSERT_EQUAL(1, loop->runOnce(0));
+  TEST_ASSERT_EQUAL(1, ulTaskNotifyTake(pdTRUE, 0));
+}
+
+static uint64_t s_fired_at[4];
+
+static void stamp(void *arg) {
+  int id = (int)(intptr_t)arg;
+  s_fired_at[id] = esp_timer_get_time();
+  calls.push_back(id);
+}
+
+void test_event_loop_timers(void) {
+  EventLoopTimer a(stamp, (void *)0), b(stamp, (void *)1), c(stamp, (void *)2);
+  uint64_t start = esp_timer_get_time();
+  loop->schedule(&a, 30);
+  loop->schedule(&b, 10);
+  loop->schedule(&c, 20);
+  loop->cancel(&c);
+  TEST_ASSERT_FALSE(EventLoop::scheduled(&c));
+  size_t runs = 0;
+  while (runs < 2) {
+    runs += loop->runOnce(1000);
+  }
+  TEST_ASSERT_EQUAL(2, calls.size());
+  TEST_ASSERT_EQUAL(1, calls[0]);
+  TEST_ASSERT_EQUAL(0, calls[1]);
+  // never early
+  TEST_ASSERT_GREATER_OR_EQUAL(start + 10000, s_fired_at[1]);
+  TEST_ASSERT_GREATER_OR_EQUAL(start + 30000, s_fired_at[0]);
+  TEST_ASSERT_FALSE(EventLoop::scheduled(&a));
+}
+
+static int s_ticks;
+static EventLoopTimer s_periodic;
+
+static void tick(void *arg) {
+  if (++s_ticks == 5) {
+    loop->cancel(&s_periodic);
+  }
+}
+
+void test_event_loop_periodic(void) {
+  s_ticks = 0;
+  s_periodic = EventLoopTimer(tick);
+  uint64_t start = esp_timer_get_time();
+  loop->schedule(&s_periodic, 10, 10);
+  while (EventLoop::scheduled(&s_periodic) && elapsed_since(start) < 2000000) {
+    loop->runOnce(1000);
+  }
+  TEST_ASSERT_EQUAL(5, s_ticks);
+  TEST_ASSERT_GREATER_OR_EQUAL(50000, elapsed_since(start));
+  // nothing left, the loop times out
+  TEST_ASSERT_EQUAL(0, loop->runOnce(5));
+}
+
+static EventLoopTimer s_again;
+
+static void reschedule(void *arg) {
+  calls.push_back(s_ticks);
+  if (++s_ticks < 3) {
+    loop->schedule(&s_again, 1);
+  }
+}
+
+void test_event_loop_reschedule_from_callback(void) {
+  s_ticks = 0;
+  s_again = EventLoopTimer(reschedule);
+  loop->schedule(&s_again, 0);
+  uint64_t start = esp_timer_get_time();
+  while (s_ticks < 3 && elapsed_since(start) < 2000000) {
+    loop->runOnce(100);
+  }
+  TEST_ASSERT_EQUAL(3, calls.size());
+  TEST_ASSERT_FALSE(EventLoop::scheduled(&s_again));
+}
+
+struct SocketPair {
+  int fd[2];
+  SocketPair() {
+    socketpair(AF_UNIX, SOCK_STREAM, 0, fd);
+  }
+  ~SocketPair() {
+    close(fd[0]);
+    close(fd[1]);
+  }
+};
+
+static EventLoopWatch s_watch;
+static uint8_t s_ready;
+static size_t s_received;
+
+static void on_readable(int fd, uint8_t ready, void *arg) {
+  char buffer[64];
+  s_ready |= ready;
+  ssize_t len = read(fd, buffer, sizeof(buffer));
+  if (len > 0) {
+    s_received += len;
+  }
+  if (s_received >= 10) {
+    loop->unwatch(&s_watch);
+  }
+}
+
+void test_event_loop_watch_readable(void) {
+  SocketPair pair;
+  s_ready = 0;
+  s_received = 0;
+  s_watch = EventLoopWatch(on_readable);
+  TEST_ASSERT_TRUE(loop->watch(&s_watch, pair.fd[0], EVENT_LOOP_READ));
+  // not readable yet
+  TEST_ASSERT_EQUAL(0, loop->runOnce(10));
+  int writer = pair.fd[1];
+  std::thread peer([writer]() {
+    for (int i = 0; i < 2; i++) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      ssize_t written = write(writer, "hello", 5);
+      (void)written;
+    }
+  });
+  uint64_t start = esp_timer_get_time();
+  while (s_received < 10 && elapsed_since(start) < 2000000) {
+    loop->runOnce(1000);
+  }
+  peer.join();
+  TEST_ASSERT_EQUAL(10, s_received);
+  TEST_ASSERT_EQUAL(EVENT_LOOP_READ, s_ready);
+  TEST_ASSERT_LESS_THAN(1000000, elapsed_since(start));
+  // unwatched from its callback
+  TEST_ASSERT_NULL(s_watch.pprev);
+}
+
+static int s_writable;
+
+static void on_writable(int fd, uint8_t ready, void *arg) {
+  if (ready & EVENT_LOOP_WRITE) {
+    s_writable++;
+  }
+}
+
+void test_event_loop_watch_writable_and_post(void) {
+  // a post wakes a wait in select(), with the watches and timers dispatched too
+  SocketPair pair;
+  EventLoopWatch idle(on_readable);
+  TEST_ASSERT_TRUE(loop->watch(&idle, pair.fd[0], EVENT_LOOP_READ));
+  std::thread producer([]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    loop->post(record, (void *)3);
+  });
+  uint64_t start = esp_timer_get_time();
+  TEST_ASSERT_EQUAL(1, loop->runOnce(5000));
+  producer.join();
+  TEST_ASSERT_LESS_THAN(1000000, elapsed_since(start));
+  TEST_ASSERT_EQUAL(3, calls[0]);
+
+  s_writable = 0;
+  EventLoopWatch out(on_writable);
+  TEST_ASSERT_TRUE(loop->watch(&out, pair.fd[1], EVENT_LOOP_WRITE));
+  TEST_ASSERT_EQUAL(1, loop->runOnce(0));
+  TEST_ASSERT_EQUAL(1, s_writable);
+  loop->unwatch(&out);
+  loop->unwatch(&idle);
+  TEST_ASSERT_FALSE(loop->watch(&out, -1, EVENT_LOOP_READ));
+}
+
+int main(void) {
+  UNITY_BEGIN();
+  RUN_TEST(test_event_loop_post_order);
+  RUN_TEST(test_event_loop_queue_full);
+  RUN_TEST(test_event_loop_repost_bounded);
+  RUN_TEST(test_event_loop_concurrent_producers);
+  RUN_TEST(test_event_loop_post_wakes);
+  RUN_TEST(test_event_loop_idle_timeout);
+  RUN_TEST(test_event_loop_own_notification);
+  RUN_TEST(test_event_loop_timers);
+  RUN_TEST(test_event_loop_periodic);
+  RUN_TEST(test_event_loop_reschedule_from_callback);
+  RUN_TEST(test_event_loop_watch_readable);
+  RUN_TEST(test_event_loop_watch_writable_and_post);
+  return UNITY_END();
+}
@@ -0,0 +1,156 @@
+/*
+ * Print::printf() and log_printf() formatting cost: the single pass streaming
+ * formatter against the previous vsnprintf() based paths, which format twice
+ * and allocate once the output exceeds the 64 byte stack buffer.
+ */
+
+#include <bench.h>
+#include "esp32-hal-format.h"
+#include "Print.h"
+
+// The legacy paths truncate on purpose before growing the buffer
+#pragma GCC diagnostic ignored "-Wformat-truncation"
+
+static size_t legacy_allocations;
+
+// Previous Print::vprintf(), as a free function
+static size_t legacy_print_vprintf(Print &p, const char *format, va_list arg) {
+  char loc_buf[64];
+  char *temp = loc_buf;
+  va_list copy;
+  va_copy(copy, arg);
+  int len = vsnprintf(temp, sizeof(loc_buf), format, copy);
+  va_end(copy);
+  if (len < 0) {
+    return 0;
+  }
+  if (len >= (int)sizeof(loc_buf)) {
+    temp = (char *)malloc(len + 1);
+    legacy_allocations++;
+    if (temp == NULL) {
+      return 0;
+    }
+    len = vsnprintf(temp, len + 1, format, arg);
+  }
+  len = p.write((uint8_t *)temp, len);
+  if (temp != loc_buf) {
+    free(temp);
+  }
+  return len;
+}
+
+static size_t legacy_print_printf(Print &p, const char *format, ...) {
+  va_list arg;
+  va_start(arg, format);
+  size_t ret = legacy_print_vprintf(p, format, arg);
+  va_end(arg);
+  return ret;
+}
+
+// Stands in for the UART, only counts bytes
+static size_t console_bytes;
+static void console_write(const char *data) {
+  console_bytes += strlen(data);
+}
+
+// Previous log_printfv(), with ets_printf("%s") replaced by console_write()
+static int legacy_log_printfv(const char *format, va_list arg) {
+  static char loc_buf[64];
+  char *temp = loc_buf;
+  uint32_t len;
+  va_list copy;
+  va_copy(copy, arg);
+  len = vsnprintf(NULL, 0, format, copy);
+  va_end(copy);
+  if (len >= sizeof(loc_buf)) {
+    temp = (char *)malloc(len + 1);
+    legacy_allocations++;
+    if (temp == NULL) {
+      return 0;
+    }
+  }
+  vsnprintf(temp, len + 1, format, arg);
+  console_write(temp);
+  if (len >= sizeof(loc_buf)) {
+    free(temp);
+  }
+  return len;
+}
+
+static int legacy_log_printf(const char *format, ...) {
+  va_list arg;
+  va_start(arg, format);
+  int len = legacy_log_printfv(format, arg);
+  va_end(arg);
+  return len;
+}
+
+static void console_sink(void *ctx, const char *data, size_t len) {
+  console_write(data);
+}
+
+// Current log_printfv() body, with the same console
+static int new_log_printf(const char *format, ...) {
+  char buf[64];
+  va_list arg;
+  va_start(arg, format);
+  int len = format_vprintf(buf, sizeof(buf), console_sink, NULL, format, arg);
+  va_end(arg);
+  return len;
+}
+
+class NullPrint : public Print {
+public:
+  size_t bytes = 0;
+  size_t write(uint8_t c) override {
+    bytes++;
+    return 1;
+  }
+  size_t write(const uint8_t *buffer, size_t size) override {
+    bytes += size;
+    return size;
+  }
+};
+
+#define SHORT_FORMAT  "%s=%d\r\n", "rssi", -67
+#define LOG_FORMAT    "[%6u][E][%s:%u] %s(): %s\r\n", 123456u, "NetworkClient.cpp", 412u, "write", "fail on fd 54, errno: 11, \"No more processes\""
+#define TELEMETRY_FMT "{\"id\":\"%s\",\"seq\":%lu,\"uptime\":%lu,\"heap\":%u,\"rssi\":%d,\"ip\":\"%u.%u.%u.%u\",\"fw\":\"%s\"}\r\n", \
+    "esp32-3c61054b2a80", 48213UL, 3600123UL, 182344u, -67, 192u, 168u, 1u, 42u, "3.3.0"
+
+#define PRINT_BENCH(name, printf_fn, ...)                   \
+  static void name(BenchState &state) {                     \
+    NullPrint p;                                            \
+    legacy_allocations = 0;                                 \
+    for (auto _ : state) {                                  \
+      printf_fn;                                            \
+    }                                                       \
+    state.setBytesProcessed(p.bytes);                       \
+    state.setCounter("allocs/op", (double)legacy_allocations / state.iterations()); \
+  }                                                         \
+  BENCHMARK(name)
+
+PRINT_BENCH(BM_PrintfShort, p.printf(SHORT_FORMAT));
+PRINT_BENCH(BM_LegacyPrintfShort, legacy_print_printf(p, SHORT_FORMAT));
+PRINT_BENCH(BM_PrintfLog, p.printf(LOG_FORMAT));
+PRINT_BENCH(BM_LegacyPrintfLog, legacy_print_printf(p, LOG_FORMAT));
+PRINT_BENCH(BM_PrintfTelemetry, p.printf(TELEMETRY_FMT));
+PRINT_BENCH(BM_LegacyPrintfTelemetry, legacy_print_printf(p, TELEMETRY_FMT));
+
+#define LOG_BENCH(name, call)                               \
+  static void name(BenchState &state) {                     \
+    console_bytes = 0;                                      \
+    legacy_allocations = 0;                                 \
+    for (auto _ : state) {                                  \
+      call;                                                 \
+    }                                                       \
+    state.setBytesProcessed(console_bytes);                 \
+    state.setCounter("allocs/op", (double)legacy_allocations / state.iterations()); \
+  }                                                         \
+  BENCHMARK(name)
+
+LOG_BENCH(BM_LogPrintfShort, new_log_printf(SHORT_FORMAT));
+LOG_BENCH(BM_LegacyLogPrintfShort, legacy_log_printf(SHORT_FORMAT));
+LOG_BENCH(BM_LogPrintfLong, new_log_printf(LOG_FORMAT));
+LOG_BENCH(BM_LegacyLogPrintfLong, legacy_log_printf(LOG_FORMAT));
+
+BENCHMARK_MAIN();
@@ -0,0 +1,270 @@
+/*
+ * Number to text conversion cost: the two digits per step integer conversion
+ * and the exact fixed point conversion against the previous digit loops
+ * (ltoa()/ultoa(), dtostrf() and Print::printFloat()), and the shortest
+ * round trip conversion against snprintf("%.17g").
+ */
+
+#include <bench.h>
+#include "esp32-hal-format.h"
+#include "Print.h"
+
+class NullPrint : public Print {
+public:
+  size_t bytes = 0;
+  size_t write(uint8_t c) override {
+    bytes++;
+    return 1;
+  }
+  size_t write(const uint8_t *buffer, size_t size) override {
+    bytes += size;
+    return size;
+  }
+};
+
+// Previous stdlib_noniso.c conversions
+static void legacy_reverse(char *begin, char *end) {
+  char *is = begin;
+  char *ie = end - 1;
+  while (is < ie) {
+    char tmp = *ie;
+    *ie = *is;
+    *is = tmp;
+    ++is;
+    --ie;
+  }
+}
+
+static char *legacy_lltoa(long long val, char *result, int base) {
+  char *out = result;
+  long long quotient = val > 0 ? val : -val;
+  do {
+    const long long tmp = quotient / base;
+    *out = "0123456789abcdef"[quotient - (tmp * base)];
+    ++out;
+    quotient = tmp;
+  } while (quotient);
+  if (val < 0) {
+    *out++ = '-';
+  }
+  legacy_reverse(result, out);
+  *out = 0;
+  return result;
+}
+
+static char *legacy_ultoa(unsigned long value, char *result, int base) {
+  char *out = result;
+  unsigned long quotient = value;
+  do {
+    const unsigned long tmp = quotient / base;
+    *out = "0123456789abcdef"[quotient - (tmp * base)];
+    ++out;
+    quotient = tmp;
+  } while (quotient);
+  legacy_reverse(result, out);
+  *out = 0;
+  return result;
+}
+
+static char *legacy_dtostrf(double number, signed int width, unsigned int prec, char *s) {
+  bool negative = false;
+  char *out = s;
+  int fillme = width;
+  if (prec > 0) {
+    fillme -= (prec + 1);
+  }
+  if (number < 0.0) {
+    negative = true;
+    fillme--;
+    number = -number;
+  }
+  double rounding = 2.0;
+  for (unsigned int i = 0; i < prec; ++i) {
+    rounding *= 10.0;
+  }
+  rounding = 1.0 / rounding;
+  number += rounding;
+  double tenpow = 1.0;
+  unsigned int digitcount = 1;
+  while (number >= 10.0 * tenpow) {
+    tenpow *= 10.0;
+    digitcount++;
+  }
+  number /= tenpow;
+  fillme -= digitcount;
+  while (fillme-- > 0) {
+    *out++ = ' ';
+  }
+  if (negative) {
+    *out++ = '-';
+  }
+  digitcount += prec;
+  int8_t digit = 0;
+  while (digitcount-- > 0) {
+    digit = (int8_t)number;
+    if (digit > 9) {
+      digit = 9;
+    }
+    *out++ = (char)('0' | digit);
+    if ((digitcount == prec) && (prec > 0)) {
+      *out++ = '.';
+    }
+    number -= digit;
+    number *= 10.0;
+  }
+  *out = 0;
+  return s;
+}
+
+// Previous Print::printNumber() and Print::printFloat(), as free functions
+static size_t legacy_print_number(Print &p, unsigned long n, uint8_t base) {
+  char buf[8 * sizeof(n) + 1];
+  char *str = &buf[sizeof(buf) - 1];
+  *str = '\0';
+  do {
+    char c = n % base;
+    n /= base;
+    *--str = c < 10 ? c + '0' : c + 'A' - 10;
+  } while (n);
+  return p.write(str);
+}
+
+static size_t legacy_print_float(Print &p, double number, uint8_t digits) {
+  size_t n = 0;
+  if (number < 0.0) {
+    n += p.print('-');
+    number = -number;
+  }
+  double rounding = 0.5;
+  for (uint8_t i = 0; i < digits; ++i) {
+    rounding /= 10.0;
+  }
+  number += rounding;
+  unsigned long int_part = (unsigned long)number;
+  double remainder = number - (double)int_part;
+  n += legacy_print_number(p, int_part, 10);
+  if (digits > 0) {
+    n += p.print(".");
+  }
+  while (digits-- > 0) {
+    remainder *= 10.0;
+    int toPrint = int(remainder);
+    n += legacy_print_number(p, toPrint, 10);
+    remainder -= toPrint;
+  }
+  return n;
+}
+
+// Values of every magnitude, as counters, sensor readings and timestamps give
+static uint64_t next_integer(uint64_t &state) {
+  state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+  return state >> (state % 56 + 8);
+}
+
+static double next_reading(uint64_t &state) {
+  return (double)(int64_t)(next_integer(state) % 2000000 - 1000000) / 1000.0;
+}
+
+static void BM_FormatU32(BenchState &state) {
+  char buf[FORMAT_INT_SIZE];
+  uint64_t seed = 1;
+  for (auto _ : state) {
+    benchDoNotOptimize(format_u32((uint32_t)next_integer(seed), buf));
+  }
+  state.setItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FormatU32);
+
+static void BM_LegacyUltoa(BenchState &state) {
+  char buf[FORMAT_INT_SIZE];
+  uint64_t seed = 1;
+  for (auto _ : state) {
+    benchDoNotOptimize(legacy_ultoa((uint32_t)next_integer(seed), buf, 10)[0]);
+  }
+  state.setItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LegacyUltoa);
+
+static void BM_FormatI64(BenchState &state) {
+  char buf[FORMAT_INT_SIZE];
+  uint64_t seed = 1;
+  for (auto _ : state) {
+    benchDoNotOptimize(format_i64(-(int64_t)next_integer(seed), buf));
+  }
+  state.setItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FormatI64);
+
+static void BM_LegacyLltoa(BenchState &state) {
+  char buf[FORMAT_INT_SIZE];
+  uint64_t seed = 1;
+  for (auto _ : state) {
+    benchDoNotOptimize(legacy_lltoa(-(int64_t)next_integer(seed), buf, 10)[0]);
+  }
+  state.setItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LegacyLltoa);
+
+static void BM_FormatFixed(BenchState &state) {
+  char buf[64];
+  uint64_t seed = 1;
+  for (auto _ : state) {
+    benchDoNotOptimize(format_fixed(next_reading(seed), state.range(0), buf, sizeof(buf)));
+  }
+  state.setItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FormatFixed)->Arg(2)->Arg(6);
+
+static void BM_LegacyDtostrf(BenchState &state) {
+  char buf[64];
+  uint64_t seed = 1;
+  for (auto _ : state) {
+    benchDoNotOptimize(legacy_dtostrf(next_reading(seed), 4, state.range(0), buf)[0]);
+  }
+  state.setItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LegacyDtostrf)->Arg(2)->Arg(6);
+
+static void BM_PrintFloat(BenchState &state) {
+  NullPrint p;
+  uint64_t seed = 1;
+  for (auto _ : state) {
+    p.print(next_reading(seed), (int)state.range(0));
+  }
+  state.setBytesProcessed(p.bytes);
+  state.setItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_PrintFloat)->Arg(2)->Arg(6);
+
+static void BM_LegacyPrintFloat(BenchState &state) {
+  NullPrint p;
+  uint64_t seed = 1;
+  for (auto _ : state) {
+    legacy_print_float(p, next_reading(seed), state.range(0));
+  }
+  state.setBytesProcessed(p.bytes);
+  state.setItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_LegacyPrintFloat)->Arg(2)->Arg(6);
+
+static void BM_FormatShortest(BenchState &state) {
+  char buf[FORMAT_SHORTEST_SIZE];
+  uint64_t seed = 1;
+  for (auto _ : state) {
+    benchDoNotOptimize(format_shortest(next_reading(seed), buf));
+  }
+  state.setItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_FormatShortest);
+
+static void BM_Snprintf17g(BenchState &state) {
+  char buf[32];
+  uint64_t seed = 1;
+  for (auto _ : state) {
+    benchDoNotOptimize(snprintf(buf, sizeof(buf), "%.17g", next_reading(seed)));
+  }
+  state.setItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_Snprintf17g);
+
+BENCHMARK_MAIN();
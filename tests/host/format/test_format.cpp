@@ -0,0 +1,186 @@
+/*
+ * Host test for the single pass formatter behind Print::vprintf() and
+ * log_printfv(): output is compared with the C library vsnprintf() for the
+ * supported printf subset, with chunk buffers small enough to split every field.
+ */
+
+#include <string>
+#include <unity.h>
+#include "esp32-hal-format.h"
+#include "Print.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static void append_sink(void *ctx, const char *data, size_t len) {
+  TEST_ASSERT_EQUAL('\0', data[len]);
+  ((std::string *)ctx)->append(data, len);
+}
+
+// Not declared as printf-like on purpose, the tests also cover flag combinations
+// the compiler warns about
+static void libc_format(char *buf, size_t size, const char *format, ...) {
+  va_list arg;
+  va_start(arg, format);
+  vsnprintf(buf, size, format, arg);
+  va_end(arg);
+}
+
+static std::string format_chunked(size_t chunk, const char *format, ...) {
+  std::string out;
+  char buf[256];
+  va_list arg;
+  va_start(arg, format);
+  int len = format_vprintf(buf, chunk, append_sink, &out, format, arg);
+  va_end(arg);
+  TEST_ASSERT_EQUAL(out.size(), len);
+  return out;
+}
+
+// Formats with the C library and with format_vprintf() using several chunk sizes
+#define CHECK_FORMAT(...)                                                  \
+  do {                                                                     \
+    char expected[512];                                                    \
+    libc_format(expected, sizeof(expected), __VA_ARGS__);                  \
+    static const size_t chunks[] = {2, 3, 7, 64, 256};                     \
+    for (size_t i = 0; i < sizeof(chunks) / sizeof(chunks[0]); i++) {     \
+      std::string actual = format_chunked(chunks[i], __VA_ARGS__);        \
+      TEST_ASSERT_EQUAL_STRING(expected, actual.c_str());                  \
+    }                                                                      \
+  } while (0)
+
+void test_format_literals(void) {
+  CHECK_FORMAT("");
+  CHECK_FORMAT("hello world");
+  CHECK_FORMAT("100%% done");
+  CHECK_FORMAT("[%6u][E][%s:%u] %s(): %s\r\n", 1234u, "WiFiGeneric.cpp", 1042u, "_eventCallback", "Reason: 201 - NO_AP_FOUND");
+}
+
+void test_format_signed(void) {
+  CHECK_FORMAT("%d %d %d", 0, -1, 42);
+  CHECK_FORMAT("%d %d", INT32_MIN, INT32_MAX);
+  CHECK_FORMAT("%lld %lld", (long long)INT64_MIN, (long long)INT64_MAX);
+  CHECK_FORMAT("%ld %li", -123456789L, 987654321L);
+  CHECK_FORMAT("%hd %hhd", (short)-300, (signed char)-5);
+  CHECK_FORMAT("%zd %jd %td", (ssize_t)-7, (intmax_t)-8, (ptrdiff_t)-9);
+  CHECK_FORMAT("[%5d][%-5d][%05d][%+d][% d][%+05d]", 42, 42, 42, 42, 42, -42);
+  CHECK_FORMAT("[%.3d][%8.3d][%-8.3d][%08.3d][%.0d][%.0d]", 7, -7, 7, 7, 0, 1);
+  CHECK_FORMAT("[%*d][%-*d][%.*d][%*.*d]", 6, 1, 6, 2, 4, 3, -8, 3, 4);
+}
+
+void test_format_unsigned(void) {
+  CHECK_FORMAT("%u %u", 0u, UINT32_MAX);
+  CHECK_FORMAT("%llu", (unsigned long long)UINT64_MAX);
+  CHECK_FORMAT("%x %X %o", 0xdeadbeefu, 0xdeadbeefu, 0777u);
+  CHECK_FORMAT("[%#x][%#X][%#o][%#x][%#o][%#.0o]", 255u, 255u, 8u, 0u, 0u, 0u);
+  CHECK_FORMAT("[%08x][%-8X][%#010x][%.6x][%#.6x]", 0xabcu, 0xabcu, 0xabcu, 0xabcu, 0xabcu);
+  CHECK_FORMAT("%02x:%02x:%02x:%02x:%02x:%02x", 0x24, 0x0a, 0xc4, 0x00, 0x01, 0xff);
+  CHECK_FORMAT("%hhu %hu %lu %zu %" PRIu32 " %" PRIx64, (unsigned char)250, (unsigned short)65000, 4000000000UL, (size_t)12345, (uint32_t)77, (uint64_t)0x123456789abULL);
+  CHECK_FORMAT("%p", (void *)0x3ffb1234);
+}
+
+void test_format_chars_and_strings(void) {
+  CHECK_FORMAT("%c%c%c", 'a', 'b', 'c');
+  CHECK_FORMAT("[%3c][%-3c]", 'x', 'y');
+  CHECK_FORMAT("[%s][%10s][%-10s][%.2s][%10.2s]", "abc", "abc", "abc", "abc", "abc");
+  CHECK_FORMAT("[%*s][%.*s]", -6, "ab", 3, "abcdef");
+  CHECK_FORMAT("%s", "a string that is definitely longer than every chunk size used by this test, so it is split");
+}
+
+void test_format_unterminated_precision_string(void) {
+  const char data[4] = {'a', 'b', 'c', 'd'};
+  std::string out = format_chunked(8, "%.3s", data);
+  TEST_ASSERT_EQUAL_STRING("abc", out.c_str());
+}
+
+void test_format_null_string(void) {
+  std::string out = format_chunked(8, "%s", (const char *)NULL);
+  TEST_ASSERT_EQUAL_STRING("(null)", out.c_str());
+}
+
+void test_format_floats(void) {
+  CHECK_FORMAT("%f %f %f", 0.0, -1.5, 3.14159265358979);
+  CHECK_FORMAT("[%.2f][%8.3f][%-8.1f][%08.2f][%+.1f][% .0f][%#.0f]", 1.005, -2.5, 3.25, -4.125, 5.0, 6.5, 7.0);
+  CHECK_FORMAT("%e %E %g %G", 12345.678, 0.000123, 0.0001, 1e20);
+  CHECK_FORMAT("%a", 1.0);
+  CHECK_FORMAT("%Lf", (long double)2.5);
+  CHECK_FORMAT("%f %f", INFINITY, -INFINITY);
+  CHECK_FORMAT("%*.*f", 12, 4, 2.0 / 3.0);
+  // wider than the float stack buffer
+  CHECK_FORMAT("%f", 1e80);
+  CHECK_FORMAT("%.70f", 0.1);
+}
+
+void test_format_unknown_and_dangling(void) {
+  std::string unknown = format_chunked(64, "a%yb");
+  std::string dangling = format_chunked(64, "end%");
+  TEST_ASSERT_EQUAL_STRING("a%yb", unknown.c_str());
+  TEST_ASSERT_EQUAL_STRING("end%", dangling.c_str());
+}
+
+static int format_truncated(char *buf, size_t size, const char *format, ...) {
+  va_list arg;
+  va_start(arg, format);
+  int len = format_vprintf(buf, size, NULL, NULL, format, arg);
+  va_end(arg);
+  return len;
+}
+
+void test_format_truncating_mode(void) {
+  char buf[8];
+  int len = format_truncated(buf, sizeof(buf), "%s %s", "hello", "world");
+  TEST_ASSERT_EQUAL(11, len);
+  TEST_ASSERT_EQUAL_STRING("hello w", buf);
+}
+
+class StringPrint : public Print {
+public:
+  std::string out;
+  size_t writes = 0;
+  size_t write(uint8_t c) override {
+    out.push_back((char)c);
+    writes++;
+    return 1;
+  }
+  size_t write(const uint8_t *buffer, size_t size) override {
+    out.append((const char *)buffer, size);
+    writes++;
+    return size;
+  }
+};
+
+void test_print_printf(void) {
+  StringPrint p;
+  TEST_ASSERT_EQUAL(18, p.printf("%s=%d (0x%04X)", "value", 255, 255));
+  TEST_ASSERT_EQUAL_STRING("value=255 (0x00FF)", p.out.c_str());
+  TEST_ASSERT_EQUAL(1, p.writes);
+}
+
+void test_print_printf_long(void) {
+  StringPrint p;
+  std::string expected;
+  for (int i = 0; i < 100; i++) {
+    expected += "item" + std::to_string(i) + ",";
+  }
+  size_t len = p.printf("%s", expected.c_str());
+  TEST_ASSERT_EQUAL(expected.size(), len);
+  TEST_ASSERT_EQUAL_STRING(expected.c_str(), p.out.c_str());
+  // streamed in chunks instead of one heap allocated block
+  TEST_ASSERT_GREATER_THAN(1, p.writes);
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_format_literals);
+  RUN_TEST(test_format_signed);
+  RUN_TEST(test_format_unsigned);
+  RUN_TEST(test_format_chars_and_strings);
+  RUN_TEST(test_format_unterminated_precision_string);
+  RUN_TEST(test_format_null_string);
+  RUN_TEST(test_format_floats);
+  RUN_TEST(test_format_unknown_and_dangling);
+  RUN_TEST(test_format_truncating_mode);
+  RUN_TEST(test_print_printf);
+  RUN_TEST(test_print_printf_long);
+  return UNITY_END();
+}
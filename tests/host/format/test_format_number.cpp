@@ -0,0 +1,427 @@
+/*
+ * Host test for the number conversions behind String and Print: integers are
+ * compared with the C library over every value up to 2^20, every power of ten
+ * and two neighbourhood and a million random ones. Fixed point output is
+ * compared with the exact decimal expansion of the double, shortest output is
+ * read back with strtod().
+ */
+
+#include <float.h>
+#include <limits.h>
+#include <random>
+#include <string>
+#include <unity.h>
+#include "esp32-hal-format.h"
+#include "WString.h"
+#include "Print.h"
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static std::mt19937_64 rng(12345);
+
+static void check_u64(uint64_t value) {
+  char expected[FORMAT_INT_SIZE];
+  char actual[FORMAT_INT_SIZE];
+  int len = snprintf(expected, sizeof(expected), "%" PRIu64, value);
+  if (format_u64(value, actual) != (size_t)len || strcmp(expected, actual) != 0 || format_u64_len(value) != (unsigned)len) {
+    TEST_ASSERT_EQUAL_STRING(expected, actual);
+    TEST_ASSERT_EQUAL(len, format_u64_len(value));
+  }
+  if (value <= UINT32_MAX && (format_u32((uint32_t)value, actual) != (size_t)len || strcmp(expected, actual) != 0)) {
+    TEST_ASSERT_EQUAL_STRING(expected, actual);
+  }
+}
+
+static void check_i64(int64_t value) {
+  char expected[FORMAT_INT_SIZE];
+  char actual[FORMAT_INT_SIZE];
+  int len = snprintf(expected, sizeof(expected), "%" PRId64, value);
+  if (format_i64(value, actual) != (size_t)len || strcmp(expected, actual) != 0) {
+    TEST_ASSERT_EQUAL_STRING(expected, actual);
+  }
+}
+
+void test_format_integers_small(void) {
+  for (uint64_t value = 0; value <= (1 << 20); value++) {
+    check_u64(value);
+    check_i64(-(int64_t)value);
+  }
+}
+
+void test_format_integers_boundaries(void) {
+  uint64_t pow10 = 1;
+  for (int i = 0; i < 20; i++, pow10 *= 10) {
+    for (uint64_t d = 0; d < 1000; d++) {
+      check_u64(pow10 + d);
+      check_u64(pow10 - d);
+      check_i64((int64_t)(pow10 + d));
+      check_i64(-(int64_t)(pow10 - d));
+    }
+  }
+  for (int bit = 0; bit < 64; bit++) {
+    for (uint64_t d = 0; d < 64; d++) {
+      check_u64((1ULL << bit) + d);
+      check_u64((1ULL << bit) - d);
+    }
+  }
+  check_u64(UINT64_MAX);
+  check_i64(INT64_MIN);
+  check_i64(INT64_MAX);
+}
+
+void test_format_integers_random(void) {
+  for (int i = 0; i < 1000000; i++) {
+    uint64_t value = rng() >> (rng() % 64);
+    check_u64(value);
+    check_i64((int64_t)value);
+    check_i64(-(int64_t)value);
+  }
+}
+
+static std::string reference_radix(uint64_t value, unsigned base, bool upper) {
+  std::string out;
+  do {
+    unsigned digit = value % base;
+    out.insert(out.begin(), (char)((digit < 10) ? '0' + digit : (upper ? 'A' : 'a') + digit - 10));
+    value /= base;
+  } while (value);
+  return out;
+}
+
+void test_format_radix(void) {
+  char actual[FORMAT_RADIX_SIZE];
+  for (unsigned base = 2; base <= 36; base++) {
+    for (int i = 0; i < 2000; i++) {
+      uint64_t value = (i < 2) ? i * UINT64_MAX : rng() >> (rng() % 64);
+      std::string expected = reference_radix(value, base, i & 1);
+      TEST_ASSERT_EQUAL(expected.size(), format_radix(value, base, i & 1, actual));
+      TEST_ASSERT_EQUAL_STRING(expected.c_str(), actual);
+    }
+  }
+  format_radix(UINT64_MAX, 2, false, actual);
+  TEST_ASSERT_EQUAL(64, strlen(actual));
+  // out of range bases are decimal
+  format_radix(1234, 1, false, actual);
+  TEST_ASSERT_EQUAL_STRING("1234", actual);
+  format_radix(1234, 37, false, actual);
+  TEST_ASSERT_EQUAL_STRING("1234", actual);
+}
+
+// `value` rounded to `decimals` places, halfway cases away from zero, from its exact decimal expansion
+static std::string exact_fixed(double value, unsigned decimals) {
+  static char exact[1200];
+  // the C library prints the exact binary value when asked for enough digits
+  snprintf(exact, sizeof(exact), "%.1100f", fabs(value));
+  std::string s = exact;
+  size_t point = s.find('.');
+  std::string digits = s.substr(0, point) + s.substr(point + 1, decimals);
+  if (s[point + 1 + decimals] >= '5') {
+    size_t i = digits.size();
+    while (i > 0 && digits[i - 1] == '9') {
+      digits[--i] = '0';
+    }
+    if (i == 0) {
+      digits.insert(digits.begin(), '1');
+    } else {
+      digits[i - 1]++;
+    }
+  }
+  std::string out = (value < 0) ? "-" : "";
+  out += digits.substr(0, digits.size() - decimals);
+  if (decimals) {
+    out += "." + digits.substr(digits.size() - decimals);
+  }
+  return out;
+}
+
+static void check_fixed(double value, unsigned decimals) {
+  char actual[400];
+  std::string expected = exact_fixed(value, decimals);
+  size_t len = format_fixed(value, decimals, actual, sizeof(actual));
+  if (len != expected.size() || expected != actual) {
+    TEST_ASSERT_EQUAL_STRING(expected.c_str(), actual);
+    TEST_ASSERT_EQUAL(expected.size(), len);
+  }
+}
+
+void test_format_fixed_cases(void) {
+  char buf[64];
+  TEST_ASSERT_EQUAL(4, format_fixed(3.14159, 2, buf, sizeof(buf)));
+  TEST_ASSERT_EQUAL_STRING("3.14", buf);
+  format_fixed(2.5, 0, buf, sizeof(buf));
+  TEST_ASSERT_EQUAL_STRING("3", buf);
+  format_fixed(-2.5, 0, buf, sizeof(buf));
+  TEST_ASSERT_EQUAL_STRING("-3", buf);
+  format_fixed(0.125, 2, buf, sizeof(buf));
+  TEST_ASSERT_EQUAL_STRING("0.13", buf);
+  // 1.005 is slightly below 1.005 in binary
+  format_fixed(1.005, 2, buf, sizeof(buf));
+  TEST_ASSERT_EQUAL_STRING("1.00", buf);
+  format_fixed(0.0, 3, buf, sizeof(buf));
+  TEST_ASSERT_EQUAL_STRING("0.000", buf);
+  format_fixed(-0.0, 1, buf, sizeof(buf));
+  TEST_ASSERT_EQUAL_STRING("0.0", buf);
+  format_fixed(-0.001, 2, buf, sizeof(buf));
+  TEST_ASSERT_EQUAL_STRING("-0.00", buf);
+  format_fixed(9.999, 2, buf, sizeof(buf));
+  TEST_ASSERT_EQUAL_STRING("10.00", buf);
+  format_fixed(NAN, 2, buf, sizeof(buf));
+  TEST_ASSERT_EQUAL_STRING("nan", buf);
+  format_fixed(-INFINITY, 2, buf, sizeof(buf));
+  TEST_ASSERT_EQUAL_STRING("inf", buf);
+  // too small a buffer reports the length and writes nothing
+  TEST_ASSERT_EQUAL(7, format_fixed(-123.456, 2, buf, 7));
+  TEST_ASSERT_EQUAL_STRING("", buf);
+  TEST_ASSERT_EQUAL(7, format_fixed(-123.456, 2, NULL, 0));
+}
+
+void test_format_fixed_halfway(void) {
+  // every multiple of 2^-(d + 1) is a halfway case at d decimals
+  for (unsigned d = 0; d <= 12; d++) {
+    double step = ldexp(1.0, -(int)d - 1);
+    for (int i = -2000; i <= 2000; i++) {
+      check_fixed(i * step, d);
+      check_fixed(12345 + i * step, d);
+    }
+  }
+}
+
+void test_format_fixed_random(void) {
+  std::uniform_real_distribution<double> exponent(-30, 30);
+  for (int i = 0; i < 50000; i++) {
+    double value = pow(10, exponent(rng)) * ((rng() & 1) ? -1 : 1);
+    check_fixed(value, rng() % 28);
+  }
+  // the digits beyond 2^53 and past the 128 bit intermediate
+  for (int i = 0; i < 2000; i++) {
+    double value = ldexp((double)(rng() >> 11), (int)(rng() % 200) - 40);
+    check_fixed(value, rng() % 10);
+  }
+  check_fixed(4294967040.0, 9);
+  check_fixed(DBL_MAX, 2);
+  check_fixed(DBL_MIN, 27);
+  check_fixed(5e-324, 27);
+}
+
+void test_format_fixed_many_decimals(void) {
+  // beyond 27 decimals the digits come from snprintf()
+  char expected[400];
+  char actual[400];
+  snprintf(expected, sizeof(expected), "%.40f", 0.1);
+  TEST_ASSERT_EQUAL(strlen(expected), format_fixed(0.1, 40, actual, sizeof(actual)));
+  TEST_ASSERT_EQUAL_STRING(expected, actual);
+  snprintf(expected, sizeof(expected), "%.30f", -1e20);
+  format_fixed(-1e20, 30, actual, sizeof(actual));
+  TEST_ASSERT_EQUAL_STRING(expected, actual);
+}
+
+// number of significant digits in shortest output
+static int significant_digits(const char *text) {
+  std::string digits;
+  for (const char *p = text; *p && *p != 'e'; p++) {
+    if (*p >= '0' && *p <= '9') {
+      digits += *p;
+    }
+  }
+  size_t first = digits.find_first_not_of('0');
+  size_t last = digits.find_last_not_of('0');
+  return (first == std::string::npos) ? 1 : (int)(last - first + 1);
+}
+
+static int min_roundtrip_digits(double value) {
+  char buf[40];
+  for (int precision = 1; precision < 17; precision++) {
+    snprintf(buf, sizeof(buf), "%.*e", precision - 1, value);
+    if (strtod(buf, NULL) == value) {
+      return precision;
+    }
+  }
+  return 17;
+}
+
+// 1 when the output is longer than the shortest that round trips
+static int check_shortest(double value) {
+  char buf[FORMAT_SHORTEST_SIZE + 8];
+  memset(buf, 'x', sizeof(buf));
+  size_t len = format_shortest(value, buf);
+  TEST_ASSERT_EQUAL(strlen(buf), len);
+  TEST_ASSERT_LESS_THAN(FORMAT_SHORTEST_SIZE, len);
+  double back = strtod(buf, NULL);
+  if (memcmp(&back, &value, sizeof(value)) != 0) {
+    char expected[40];
+    snprintf(expected, sizeof(expected), "%.17g", value);
+    TEST_ASSERT_EQUAL_STRING(expected, buf);
+  }
+  TEST_ASSERT_LESS_OR_EQUAL(17, significant_digits(buf));
+  return significant_digits(buf) > min_roundtrip_digits(value);
+}
+
+void test_format_shortest_cases(void) {
+  static const struct {
+    double value;
+    const char *text;
+  } cases[] = {
+    {0.0, "0"},
+    {-0.0, "-0"},
+    {1.0, "1"},
+    {-1.5, "-1.5"},
+    {0.1, "0.1"},
+    {0.3, "0.3"},
+    {0.1 + 0.2, "0.30000000000000004"},
+    {123.0, "123"},
+    {1e21, "1e+21"},
+    {1.5e21, "1.5e+21"},
+    {1e20, "100000000000000000000"},
+    {123456789012345680000.0, "123456789012345680000"},
+    {0.000001, "0.000001"},
+    {1.5e-7, "1.5e-7"},
+    {3.14159, "3.14159"},
+    {5e-324, "5e-324"},
+    {DBL_MAX, "1.7976931348623157e+308"},
+    {DBL_MIN, "2.2250738585072014e-308"},
+    {(double)3.14159f, "3.141590118408203"},
+    {NAN, "nan"},
+    {INFINITY, "inf"},
+    {-INFINITY, "-inf"},
+  };
+  for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+    char buf[FORMAT_SHORTEST_SIZE];
+    TEST_ASSERT_EQUAL(strlen(cases[i].text), format_shortest(cases[i].value, buf));
+    TEST_ASSERT_EQUAL_STRING(cases[i].text, buf);
+  }
+}
+
+void test_format_shortest_random(void) {
+  int longer = 0;
+  int total = 0;
+  for (int i = 0; i < 50000; i++, total++) {
+    uint64_t bits = rng();
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    if (!isfinite(value)) {
+      continue;
+    }
+    longer += check_shortest(value);
+  }
+  // floats, as doubles
+  for (uint32_t mantissa = 0; mantissa < (1 << 23); mantissa += 97, total++) {
+    longer += check_shortest(ldexp(1.0 + ldexp((double)mantissa, -23), (int)(mantissa % 64) - 32));
+  }
+  // small integers and decimals with few digits
+  for (int i = 0; i < 20000; i++, total++) {
+    longer += check_shortest(i);
+    longer += check_shortest(i / 1000.0);
+  }
+  // Grisu2 only rarely misses the shortest output
+  TEST_ASSERT_LESS_THAN(total / 1000, longer);
+}
+
+// A Print that keeps what it is given
+class StringPrint : public Print {
+public:
+  std::string text;
+  size_t write(uint8_t c) override {
+    text += (char)c;
+    return 1;
+  }
+  size_t write(const uint8_t *buffer, size_t size) override {
+    text.append((const char *)buffer, size);
+    return size;
+  }
+};
+
+void test_format_string_numbers(void) {
+  TEST_ASSERT_EQUAL_STRING("-2147483648", String((int)INT32_MIN).c_str());
+  TEST_ASSERT_EQUAL_STRING("18446744073709551615", String(UINT64_MAX).c_str());
+  TEST_ASSERT_EQUAL_STRING("-9223372036854775808", String((long long)INT64_MIN).c_str());
+  TEST_ASSERT_EQUAL_STRING("ff", String(255, HEX).c_str());
+  // int in two's complement in the other bases than 10 and up to base 36,
+  // as itoa(); long signed and up to base 16, as ltoa()
+  TEST_ASSERT_EQUAL_STRING("ffffffff", String(-1, HEX).c_str());
+  TEST_ASSERT_EQUAL_STRING("ffffff01", String(-255, HEX).c_str());
+  TEST_ASSERT_EQUAL_STRING("-ff", String(-255L, HEX).c_str());
+  TEST_ASSERT_EQUAL_STRING("-ff", String(-255LL, HEX).c_str());
+  TEST_ASSERT_EQUAL_STRING("11111111", String((unsigned char)255, BIN).c_str());
+  TEST_ASSERT_EQUAL_STRING("z", String(35, 36).c_str());
+  TEST_ASSERT_EQUAL_STRING("zik0zj", String(INT32_MAX, 36).c_str());
+  TEST_ASSERT_EQUAL_STRING("zik0zk", String(0x80000000U, 36).c_str());
+  TEST_ASSERT_EQUAL_STRING("73", String((unsigned char)255, 36).c_str());
+  TEST_ASSERT_EQUAL_STRING("cf", String(255, 20).c_str());
+  TEST_ASSERT_EQUAL_STRING("", String(255, 37).c_str());
+  TEST_ASSERT_EQUAL_STRING("", String(255L, 20).c_str());
+  char buf[40];
+  for (int value : {-1, -255, INT32_MIN, 0, 12345}) {
+    for (int base : {2, 8, 10, 16, 36}) {
+      TEST_ASSERT_EQUAL_STRING(itoa(value, buf, base), String(value, (unsigned char)base).c_str());
+    }
+  }
+  TEST_ASSERT_EQUAL_STRING("1.50", String(1.5).c_str());
+  TEST_ASSERT_EQUAL_STRING("5", String(5.0, 0).c_str());
+  TEST_ASSERT_EQUAL_STRING("-0.333", String(-1.0f / 3, 3).c_str());
+  TEST_ASSERT_EQUAL_STRING("nan", String(NAN).c_str());
+
+  String s;
+  s.reserve(64);
+  s += "t=";
+  s += 21.456;
+  s += ",n=";
+  s += -42;
+  s += ",u=";
+  s += 4000000000UL;
+  s += ",f=";
+  s += 0.5f;
+  TEST_ASSERT_EQUAL_STRING("t=21.46,n=-42,u=4000000000,f=0.50", s.c_str());
+
+  // longer than the spare capacity
+  String big("x");
+  big.concat(String(1e300, 3));
+  TEST_ASSERT_EQUAL(1 + 301 + 4, big.length());
+  TEST_ASSERT_EQUAL_STRING(exact_fixed(1e300, 3).c_str(), big.c_str() + 1);
+}
+
+void test_format_print_numbers(void) {
+  StringPrint p;
+  p.print(-123456789L);
+  p.print(' ');
+  p.print(LLONG_MIN);
+  p.print(' ');
+  p.print(255, HEX);
+  p.print(' ');
+  p.print(5u, BIN);
+  p.print(' ');
+  p.print(77, 1);
+  p.print(' ');
+  p.print(3.14159);
+  p.print(' ');
+  p.print(-2.5, 0);
+  p.print(' ');
+  p.print(0.1 + 0.2, -1);
+  p.print(' ');
+  p.print(5e9);
+  p.print(' ');
+  p.print(-INFINITY);
+  TEST_ASSERT_EQUAL_STRING("-123456789 -9223372036854775808 FF 101 77 3.14 -3 0.30000000000000004 ovf inf", p.text.c_str());
+
+  // more decimals than the stack buffer holds
+  p.text.clear();
+  p.print(1.0 / 3, 80);
+  TEST_ASSERT_EQUAL(82, p.text.size());
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_format_integers_small);
+  RUN_TEST(test_format_integers_boundaries);
+  RUN_TEST(test_format_integers_random);
+  RUN_TEST(test_format_radix);
+  RUN_TEST(test_format_fixed_cases);
+  RUN_TEST(test_format_fixed_halfway);
+  RUN_TEST(test_format_fixed_random);
+  RUN_TEST(test_format_fixed_many_decimals);
+  RUN_TEST(test_format_shortest_cases);
+  RUN_TEST(test_format_shortest_random);
+  RUN_TEST(test_format_string_numbers);
+  RUN_TEST(test_format_print_numbers);
+  return UNITY_END();
+}
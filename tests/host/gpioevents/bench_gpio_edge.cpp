@@ -0,0 +1,137 @@
+/*
+ * GPIO edge event costs. Interrupt side: pushing {pin, level, time} into the
+ * ring, against the usual sketch ISR that debounces in interrupt context
+ * (compare with the last edge time, count, remember the level). Task side:
+ * a batch of bouncing edges of several pins run through the filters and the
+ * pins polled afterwards, per event.
+ */
+
+#include <bench.h>
+#include <vector>
+#include "esp32-hal-gpio-events.h"
+
+#define PINS 8
+
+// Bouncing edges on PINS pins: every 2ms, a burst of 5 edges 50us apart on
+// each pin, interleaved
+static std::vector<gpio_edge_event_t> make_trace(size_t count) {
+  std::vector<gpio_edge_event_t> trace;
+  uint8_t level[PINS] = {0};
+  for (uint32_t burst = 0; trace.size() < count; burst++) {
+    for (uint32_t k = 0; k < 5; k++) {
+      for (uint8_t pin = 0; pin < PINS; pin++) {
+        level[pin] ^= 1;
+        trace.push_back({burst * 2000 + k * 50 + pin, pin, level[pin]});
+      }
+    }
+  }
+  trace.resize(count);
+  return trace;
+}
+
+struct IsrDebounce {
+  uint32_t last;
+  uint32_t count;
+  uint8_t level;
+};
+
+// The ISR of a sketch debouncing in interrupt context
+static void __attribute__((noinline)) isrDebounce(IsrDebounce *d, const gpio_edge_event_t *ev) {
+  if (ev->time - d->last >= 1000) {
+    d->last = ev->time;
+    d->level = ev->level;
+    d->count++;
+  }
+}
+
+static void __attribute__((noinline)) isrPush(gpio_edge_ring_t *ring, const gpio_edge_event_t *ev) {
+  bool was_empty;
+  gpio_edge_ring_push(ring, ev, &was_empty);
+  benchDoNotOptimize(was_empty);
+}
+
+static void BM_IsrDebounce(BenchState &state) {
+  std::vector<gpio_edge_event_t> trace = make_trace(1024);
+  IsrDebounce d[PINS] = {};
+  size_t i = 0;
+  for (auto _ : state) {
+    const gpio_edge_event_t *ev = &trace[i++ & 1023];
+    isrDebounce(&d[ev->pin], ev);
+  }
+  benchDoNotOptimize(d);
+  state.setItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_IsrDebounce);
+
+static void BM_IsrPush(BenchState &state) {
+  std::vector<gpio_edge_event_t> trace = make_trace(1024);
+  gpio_edge_event_t buf[64], out[64];
+  gpio_edge_ring_t ring;
+  gpio_edge_ring_init(&ring, buf, 64);
+  size_t i = 0;
+  for (auto _ : state) {
+    isrPush(&ring, &trace[i++ & 1023]);
+    // the task side, out of the measurement most of the time
+    if ((i & 63) == 0) {
+      gpio_edge_ring_pop(&ring, out, 64);
+    }
+  }
+  state.setItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_IsrPush);
+
+// One batch of the edge task: feed, then poll every pin
+static size_t run_batch(gpio_edge_filter_t *filters, const gpio_edge_event_t *in, size_t count, gpio_edge_event_t *out) {
+  size_t passed = 0;
+  for (size_t i = 0; i < count; i++) {
+    passed += gpio_edge_filter_feed(&filters[in[i].pin], &in[i], &out[passed]);
+  }
+  uint32_t now = in[count - 1].time;
+  for (uint8_t pin = 0; pin < PINS; pin++) {
+    passed += gpio_edge_filter_poll(&filters[pin], pin, now, &out[passed]);
+  }
+  return passed;
+}
+
+static void BM_TaskFilter(BenchState &state) {
+  size_t batch = state.range(0);
+  std::vector<gpio_edge_event_t> trace = make_trace(batch * 64);
+  std::vector<gpio_edge_event_t> out(batch + PINS);
+  gpio_edge_filter_t filters[PINS];
+  for (uint8_t pin = 0; pin < PINS; pin++) {
+    gpio_edge_filter_init(&filters[pin], 0, 0, 20, 1000);
+  }
+  size_t n = 0, passed = 0;
+  for (auto _ : state) {
+    passed += run_batch(filters, &trace[(n++ % 64) * batch], batch, out.data());
+  }
+  benchDoNotOptimize(passed);
+  state.setItemsProcessed(state.iterations() * batch);
+}
+BENCHMARK(BM_TaskFilter)->Arg(1)->Arg(32);
+
+int main(int argc, char **argv) {
+  // both debounce the trace down to the first edge of each burst
+  std::vector<gpio_edge_event_t> trace = make_trace(5 * PINS * 20);
+  IsrDebounce d[PINS] = {};
+  gpio_edge_filter_t filters[PINS];
+  for (uint8_t pin = 0; pin < PINS; pin++) {
+    d[pin].last = (uint32_t)-1000;
+    gpio_edge_filter_init(&filters[pin], 0, 0, 0, 1000);
+  }
+  std::vector<gpio_edge_event_t> out(trace.size() + PINS);
+  size_t passed = 0;
+  uint32_t counted = 0;
+  for (const gpio_edge_event_t &ev : trace) {
+    isrDebounce(&d[ev.pin], &ev);
+    passed += run_batch(filters, &ev, 1, &out[passed]);
+  }
+  for (uint8_t pin = 0; pin < PINS; pin++) {
+    counted += d[pin].count;
+  }
+  if (passed != counted || counted != PINS * 20) {
+    fprintf(stderr, "edges passed: %zu, ISR debounce counted %u\n", passed, counted);
+    return 1;
+  }
+  return benchMain(argc, argv);
+}
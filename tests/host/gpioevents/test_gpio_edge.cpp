@@ -0,0 +1,266 @@
+/*
+ * Host tests for the GPIO edge event ring and the per pin edge filters, with
+ * synthetic edge traces: unfiltered edges, contact bounce held back by the
+ * debounce time, glitches shorter than the glitch time, both together, the
+ * wrap of the 32 bit microsecond clock, and the ring filling up and being
+ * fed from another thread. Then the edge task, on simulated pins: edges keep
+ * being delivered however long a pin stays attached.
+ */
+
+#include <unity.h>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "esp32-hal-gpio-events.h"
+
+#define PIN 4
+
+struct Edge {
+  uint32_t time;
+  uint8_t level;
+};
+
+static gpio_edge_filter_t filter;
+static std::vector<gpio_edge_event_t> passed;
+
+// What the edge task does with a batch: feed the events, then poll at now
+static void run(const std::vector<Edge> &trace, uint32_t now) {
+  gpio_edge_event_t out;
+  for (const Edge &e : trace) {
+    gpio_edge_event_t ev = {e.time, PIN, e.level};
+    if (gpio_edge_filter_feed(&filter, &ev, &out)) {
+      passed.push_back(out);
+    }
+  }
+  if (gpio_edge_filter_poll(&filter, PIN, now, &out)) {
+    passed.push_back(out);
+  }
+}
+
+static void expect(const std::vector<Edge> &edges) {
+  TEST_ASSERT_EQUAL(edges.size(), passed.size());
+  for (size_t i = 0; i < edges.size(); i++) {
+    TEST_ASSERT_EQUAL(PIN, passed[i].pin);
+    TEST_ASSERT_EQUAL_UINT32(edges[i].time, passed[i].time);
+    TEST_ASSERT_EQUAL(edges[i].level, passed[i].level);
+  }
+}
+
+void setUp(void) {
+  passed.clear();
+}
+
+void tearDown(void) {}
+
+void test_gpio_edge_unfiltered(void) {
+  gpio_edge_filter_init(&filter, 0, 0, 0, 0);
+  run({{100, 1}, {101, 0}, {150, 1}, {150, 0}}, 200);
+  expect({{100, 1}, {101, 0}, {150, 1}, {150, 0}});
+  // an event repeating the level is not an edge
+  passed.clear();
+  run({{300, 0}, {400, 1}, {500, 1}}, 600);
+  expect({{400, 1}});
+  uint32_t delay;
+  TEST_ASSERT_FALSE(gpio_edge_filter_pending(&filter, 600, &delay));
+}
+
+void test_gpio_edge_debounce(void) {
+  gpio_edge_filter_init(&filter, 0, 0, 0, 5000);
+  // a press bouncing for 400us, the first edge passes at once
+  run({{1000, 1}, {1100, 0}, {1200, 1}, {1300, 0}, {1400, 1}}, 1500);
+  expect({{1000, 1}});
+  uint32_t delay;
+  TEST_ASSERT_FALSE(gpio_edge_filter_pending(&filter, 1500, &delay));
+  // the release bounces too
+  passed.clear();
+  run({{20000, 0}, {20050, 1}, {20100, 0}}, 20200);
+  expect({{20000, 0}});
+  // a press shorter than the debounce time: the release is held back until
+  // the debounce time is over, and reported with its own time
+  passed.clear();
+  run({{30000, 1}, {30100, 0}, {30200, 1}, {30300, 0}}, 31000);
+  expect({{30000, 1}});
+  TEST_ASSERT_TRUE(gpio_edge_filter_pending(&filter, 31000, &delay));
+  TEST_ASSERT_EQUAL(4000, delay);
+  run({}, 34999);
+  TEST_ASSERT_EQUAL(1, passed.size());
+  run({}, 35000);
+  expect({{30000, 1}, {30300, 0}});
+}
+
+void test_gpio_edge_glitch(void) {
+  gpio_edge_filter_init(&filter, 0, 0, 100, 0);
+  // 50us pulses disappear
+  run({{1000, 1}, {1050, 0}, {2000, 1}, {2099, 0}}, 3000);
+  expect({});
+  // a level held 100us passes, with the time it was taken
+  run({{4000, 1}}, 4030);
+  uint32_t delay;
+  TEST_ASSERT_TRUE(gpio_edge_filter_pending(&filter, 4030, &delay));
+  TEST_ASSERT_EQUAL(70, delay);
+  run({}, 4100);
+  expect({{4000, 1}});
+  // the next event shows the level was held long enough
+  passed.clear();
+  run({{5000, 0}, {5200, 1}, {5210, 0}}, 5250);
+  expect({{5000, 0}});
+}
+
+void test_gpio_edge_glitch_and_debounce(void) {
+  gpio_edge_filter_init(&filter, 1, 0, 20, 1000);
+  run({{100, 0}, {110, 1}, {200, 0}, {500, 1}, {510, 0}}, 600);
+  expect({{200, 0}});
+  // a release after the debounce time with a glitch on it
+  passed.clear();
+  run({{2000, 1}, {2005, 0}, {2010, 1}}, 2100);
+  expect({{2010, 1}});
+  uint32_t delay;
+  TEST_ASSERT_FALSE(gpio_edge_filter_pending(&filter, 2100, &delay));
+}
+
+void test_gpio_edge_time_wrap(void) {
+  uint32_t start = 0xFFFFF000;
+  gpio_edge_filter_init(&filter, 0, start, 10, 0x2000);
+  run({{start + 0x100, 1}, {start + 0x200, 0}, {start + 0x300, 1}}, start + 0x400);
+  expect({{start + 0x100, 1}});
+  // held back across the wrap, until 0x2000 after the first edge
+  uint32_t delay;
+  run({{start + 0x1000, 0}}, start + 0x1100);
+  TEST_ASSERT_TRUE(gpio_edge_filter_pending(&filter, start + 0x1100, &delay));
+  TEST_ASSERT_EQUAL(0x1000, delay);
+  run({}, 0x0FFF);
+  TEST_ASSERT_EQUAL(1, passed.size());
+  run({}, 0x1100);
+  expect({{start + 0x100, 1}, {start + 0x1000, 0}});
+  // the release was right at the wrap
+  TEST_ASSERT_EQUAL_UINT32(0, passed[1].time);
+}
+
+void test_gpio_edge_ring_overflow(void) {
+  gpio_edge_event_t buf[16];
+  gpio_edge_ring_t ring;
+  gpio_edge_ring_init(&ring, buf, 16);
+  bool was_empty;
+  for (uint32_t i = 0; i < 20; i++) {
+    gpio_edge_event_t ev = {i, PIN, (uint8_t)(i & 1)};
+    TEST_ASSERT_EQUAL(i < 16, gpio_edge_ring_push(&ring, &ev, &was_empty));
+    // only the first event finds the ring empty
+    TEST_ASSERT_EQUAL(i == 0, was_empty);
+  }
+  TEST_ASSERT_EQUAL(16, ring.received);
+  TEST_ASSERT_EQUAL(4, ring.dropped);
+  gpio_edge_event_t out[16];
+  TEST_ASSERT_EQUAL(10, gpio_edge_ring_pop(&ring, out, 10));
+  TEST_ASSERT_EQUAL(16, ring.high_water);
+  for (uint32_t i = 0; i < 10; i++) {
+    TEST_ASSERT_EQUAL_UINT32(i, out[i].time);
+  }
+  gpio_edge_event_t ev = {100, PIN, 1};
+  TEST_ASSERT_TRUE(gpio_edge_ring_push(&ring, &ev, &was_empty));
+  TEST_ASSERT_FALSE(was_empty);
+  TEST_ASSERT_EQUAL(7, gpio_edge_ring_pop(&ring, out, 16));
+  TEST_ASSERT_EQUAL_UINT32(10, out[0].time);
+  TEST_ASSERT_EQUAL_UINT32(100, out[6].time);
+  TEST_ASSERT_EQUAL(0, gpio_edge_ring_pop(&ring, out, 16));
+  TEST_ASSERT_TRUE(gpio_edge_ring_push(&ring, &ev, &was_empty));
+  TEST_ASSERT_TRUE(was_empty);
+}
+
+void test_gpio_edge_ring_threads(void) {
+  const uint32_t count = 200000;
+  gpio_edge_event_t buf[64];
+  gpio_edge_ring_t ring;
+  gpio_edge_ring_init(&ring, buf, 64);
+  // the "ISR" retries a dropped event, so every one arrives in order
+  std::thread producer([&ring, count]() {
+    bool was_empty;
+    for (uint32_t i = 0; i < count; i++) {
+      gpio_edge_event_t ev = {i, (uint8_t)(i % 40), (uint8_t)(i & 1)};
+      while (!gpio_edge_ring_push(&ring, &ev, &was_empty)) {
+        std::this_thread::yield();
+      }
+    }
+  });
+  uint32_t next = 0;
+  bool ordered = true;
+  gpio_edge_event_t out[16];
+  while (next < count) {
+    size_t n = gpio_edge_ring_pop(&ring, out, 16);
+    for (size_t i = 0; i < n; i++) {
+      ordered &= out[i].time == next && out[i].pin == next % 40 && out[i].level == (next & 1);
+      next++;
+    }
+    if (n == 0) {
+      std::this_thread::yield();
+    }
+  }
+  producer.join();
+  TEST_ASSERT_TRUE(ordered);
+  TEST_ASSERT_EQUAL(count, ring.received);
+  TEST_ASSERT_LESS_OR_EQUAL(64, ring.high_water);
+}
+
+static std::mutex s_delivered_lock;
+static std::vector<gpio_edge_event_t> s_delivered;
+
+static void deliver(const gpio_edge_event_t *events, size_t count, void *arg) {
+  std::lock_guard<std::mutex> guard(s_delivered_lock);
+  s_delivered.insert(s_delivered.end(), events, events + count);
+}
+
+// Waits up to a second for the edge task to deliver count edges in all
+static size_t delivered(size_t count) {
+  for (int i = 0; i < 1000; i++) {
+    {
+      std::lock_guard<std::mutex> guard(s_delivered_lock);
+      if (s_delivered.size() >= count) {
+        return s_delivered.size();
+      }
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  std::lock_guard<std::mutex> guard(s_delivered_lock);
+  return s_delivered.size();
+}
+
+void test_gpio_edge_attached_long(void) {
+  hostDigitalWrite(PIN, LOW);
+  TEST_ASSERT_TRUE(gpio_edge_begin(64, deliver, NULL));
+  TEST_ASSERT_TRUE(gpio_edge_attach(PIN, CHANGE, 0, 0));
+  hostDigitalWrite(PIN, HIGH);
+  TEST_ASSERT_EQUAL(1, delivered(1));
+  // attached for more than 2^31 us, then for more than the wrap of the clock
+  hostAdvanceTime((1LL << 31) + 1000);
+  hostDigitalWrite(PIN, LOW);
+  TEST_ASSERT_EQUAL(2, delivered(2));
+  hostAdvanceTime(1LL << 31);
+  hostDigitalWrite(PIN, HIGH);
+  TEST_ASSERT_EQUAL(3, delivered(3));
+  // the edge while detached is not stored, the next attach gets its own edges
+  gpio_edge_detach(PIN);
+  hostDigitalWrite(PIN, LOW);
+  TEST_ASSERT_TRUE(gpio_edge_attach(PIN, RISING, 0, 0));
+  hostDigitalWrite(PIN, HIGH);
+  TEST_ASSERT_EQUAL(4, delivered(4));
+  gpio_edge_end();
+  TEST_ASSERT_EQUAL(0, s_delivered[1].level);
+  TEST_ASSERT_EQUAL(1, s_delivered[3].level);
+  gpio_edge_stats_t stats;
+  gpio_edge_stats(&stats);
+  TEST_ASSERT_EQUAL(4, stats.received);
+  TEST_ASSERT_EQUAL(4, stats.delivered);
+}
+
+int main(void) {
+  UNITY_BEGIN();
+  RUN_TEST(test_gpio_edge_unfiltered);
+  RUN_TEST(test_gpio_edge_debounce);
+  RUN_TEST(test_gpio_edge_glitch);
+  RUN_TEST(test_gpio_edge_glitch_and_debounce);
+  RUN_TEST(test_gpio_edge_time_wrap);
+  RUN_TEST(test_gpio_edge_ring_overflow);
+  RUN_TEST(test_gpio_edge_ring_threads);
+  RUN_TEST(test_gpio_edge_attached_long);
+  return UNITY_END();
+}
@@ -0,0 +1,673 @@
+/*
+ * Hash builder throughput for the message sizes seen in practice: short
+ * authentication strings, HTTP bodies and OTA write chunks. MD5 plus SHA-256
+ * (as an OTA with a signature computes them) in one MultiHashBuilder pass
+ * against two passes, and addStream() against the previous 512 byte read
+ * loop of each builder, once per digest. The SHA-256/512 block functions are
+ * compared with the previous rolled ones, after checking that both give the
+ * same state, and so is the unrolled, lane complementing Keccak-f[1600] with
+ * the previous table driven one, in cycles per byte of absorbed SHA3-256 input
+ * where the host has a cycle counter. PBKDF2 with the HMAC key blocks
+ * compressed once against the previous derivation that hashed them again on
+ * every iteration.
+ */
+
+#include <bench.h>
+#include "HEXBuilder.h"
+#include "MD5Builder.h"
+#include "MultiHashBuilder.h"
+#include "PBKDF2_HMACBuilder.h"
+#include "SHA1Builder.h"
+#include "SHA2Builder.h"
+#include "SHA3Builder.h"
+
+static uint8_t s_data[16384];
+
+static void run_hash(BenchState &state, HashBuilder &hash) {
+  for (auto _ : state) {
+    hash.begin();
+    hash.add(s_data, state.range(0));
+    hash.calculate();
+    uint8_t out[64];
+    hash.getBytes(out);
+    benchDoNotOptimize(out[0]);
+  }
+  state.setBytesProcessed(state.iterations() * state.range(0));
+}
+
+#define HASH_BENCHMARK(name, type)      \
+  static void name(BenchState &state) { \
+    type hash;                          \
+    run_hash(state, hash);              \
+  }                                     \
+  BENCHMARK(name)->Arg(64)->Arg(1024)->Arg(16384)
+
+HASH_BENCHMARK(BM_MD5, MD5Builder);
+HASH_BENCHMARK(BM_SHA1, SHA1Builder);
+HASH_BENCHMARK(BM_SHA256, SHA256Builder);
+HASH_BENCHMARK(BM_SHA512, SHA512Builder);
+HASH_BENCHMARK(BM_SHA3_256, SHA3_256Builder);
+HASH_BENCHMARK(BM_SHAKE128, SHAKE128Builder);
+
+static void BM_MultiHashMD5SHA256(BenchState &state) {
+  MD5Builder md5;
+  SHA256Builder sha256;
+  MultiHashBuilder multi;
+  multi.addBuilder(&md5);
+  multi.addBuilder(&sha256);
+  run_hash(state, multi);
+}
+BENCHMARK(BM_MultiHashMD5SHA256)->Arg(1024)->Arg(16384);
+
+static void BM_SeparateMD5SHA256(BenchState &state) {
+  MD5Builder md5;
+  SHA256Builder sha256;
+  for (auto _ : state) {
+    uint8_t out[48];
+    md5.begin();
+    sha256.begin();
+    md5.add(s_data, state.range(0));
+    sha256.add(s_data, state.range(0));
+    md5.calculate();
+    sha256.calculate();
+    md5.getBytes(out);
+    sha256.getBytes(out + 16);
+    benchDoNotOptimize(out[0]);
+  }
+  state.setBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_SeparateMD5SHA256)->Arg(1024)->Arg(16384);
+
+// A file like stream: no peek buffer, every readBytes() costs a fixed call
+// overhead on top of the copy, as a filesystem read does
+class FileLikeStream : public Stream {
+public:
+  size_t pos = 0;
+  int available() override {
+    return sizeof(s_data) - pos;
+  }
+  int read() override {
+    return pos < sizeof(s_data) ? s_data[pos++] : -1;
+  }
+  int peek() override {
+    return pos < sizeof(s_data) ? s_data[pos] : -1;
+  }
+  size_t readBytes(char *buffer, size_t length) override {
+    size_t n = std::min(length, sizeof(s_data) - pos);
+    memcpy(buffer, s_data + pos, n);
+    pos += n;
+    for (volatile int i = 0; i < 200; i = i + 1) {
+    }
+    return n;
+  }
+  size_t write(uint8_t) override {
+    return 0;
+  }
+};
+
+// Previous MD5Builder::addStream()
+static bool legacy_add_stream(HashBuilder &hash, Stream &stream, const size_t maxLen) {
+  const int buf_size = 512;
+  int maxLengthLeft = maxLen;
+  uint8_t *buf = (uint8_t *)malloc(buf_size);
+  if (!buf) {
+    return false;
+  }
+  int bytesAvailable = stream.available();
+  while ((bytesAvailable > 0) && (maxLengthLeft > 0)) {
+    int readBytes = bytesAvailable;
+    if (readBytes > maxLengthLeft) {
+      readBytes = maxLengthLeft;
+    }
+    if (readBytes > buf_size) {
+      readBytes = buf_size;
+    }
+    int numBytesRead = stream.readBytes(buf, readBytes);
+    if (numBytesRead < 1) {
+      free(buf);
+      return false;
+    }
+    hash.add(buf, numBytesRead);
+    maxLengthLeft -= numBytesRead;
+    bytesAvailable = stream.available();
+  }
+  free(buf);
+  return true;
+}
+
+static void BM_MD5AddStream(BenchState &state) {
+  MD5Builder md5;
+  FileLikeStream file;
+  for (auto _ : state) {
+    file.pos = 0;
+    md5.begin();
+    md5.addStream(file, sizeof(s_data));
+    md5.calculate();
+  }
+  state.setBytesProcessed(state.iterations() * sizeof(s_data));
+}
+BENCHMARK(BM_MD5AddStream);
+
+static void BM_LegacyMD5AddStream(BenchState &state) {
+  MD5Builder md5;
+  FileLikeStream file;
+  for (auto _ : state) {
+    file.pos = 0;
+    md5.begin();
+    legacy_add_stream(md5, file, sizeof(s_data));
+    md5.calculate();
+  }
+  state.setBytesProcessed(state.iterations() * sizeof(s_data));
+}
+BENCHMARK(BM_LegacyMD5AddStream);
+
+// Both digests of one file: one read against a read per digest
+static void BM_MultiHashAddStream(BenchState &state) {
+  MD5Builder md5;
+  SHA256Builder sha256;
+  MultiHashBuilder multi;
+  multi.addBuilder(&md5);
+  multi.addBuilder(&sha256);
+  FileLikeStream file;
+  for (auto _ : state) {
+    file.pos = 0;
+    multi.begin();
+    multi.addStream(file, sizeof(s_data));
+    multi.calculate();
+  }
+  state.setBytesProcessed(state.iterations() * sizeof(s_data));
+}
+BENCHMARK(BM_MultiHashAddStream);
+
+static void BM_LegacyAddStreamTwice(BenchState &state) {
+  MD5Builder md5;
+  SHA256Builder sha256;
+  FileLikeStream file;
+  for (auto _ : state) {
+    md5.begin();
+    sha256.begin();
+    file.pos = 0;
+    legacy_add_stream(md5, file, sizeof(s_data));
+    file.pos = 0;
+    legacy_add_stream(sha256, file, sizeof(s_data));
+    md5.calculate();
+    sha256.calculate();
+  }
+  state.setBytesProcessed(state.iterations() * sizeof(s_data));
+}
+BENCHMARK(BM_LegacyAddStreamTwice);
+
+// Previous SHA2Builder block functions, rolled and with aligned loads
+static const uint32_t legacy_k256[64] = {
+  0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74,
+  0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da, 0x983e5152, 0xa831c66d,
+  0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e,
+  0x92722c85, 0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070, 0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5,
+  0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static const uint64_t legacy_k512[80] = {
+  0x428a2f98d728ae22ULL, 0x7137449123ef65cdULL, 0xb5c0fbcfec4d3b2fULL, 0xe9b5dba58189dbbcULL, 0x3956c25bf348b538ULL, 0x59f111f1b605d019ULL, 0x923f82a4af194f9bULL,
+  0xab1c5ed5da6d8118ULL, 0xd807aa98a3030242ULL, 0x12835b0145706fbeULL, 0x243185be4ee4b28cULL, 0x550c7dc3d5ffb4e2ULL, 0x72be5d74f27b896fULL, 0x80deb1fe3b1696b1ULL,
+  0x9bdc06a725c71235ULL, 0xc19bf174cf692694ULL, 0xe49b69c19ef14ad2ULL, 0xefbe4786384f25e3ULL, 0x0fc19dc68b8cd5b5ULL, 0x240ca1cc77ac9c65ULL, 0x2de92c6f592b0275ULL,
+  0x4a7484aa6ea6e483ULL, 0x5cb0a9dcbd41fbd4ULL, 0x76f988da831153b5ULL, 0x983e5152ee66dfabULL, 0xa831c66d2db43210ULL, 0xb00327c898fb213fULL, 0xbf597fc7beef0ee4ULL,
+  0xc6e00bf33da88fc2ULL, 0xd5a79147930aa725ULL, 0x06ca6351e003826fULL, 0x142929670a0e6e70ULL, 0x27b70a8546d22ffcULL, 0x2e1b21385c26c926ULL, 0x4d2c6dfc5ac42aedULL,
+  0x53380d139d95b3dfULL, 0x650a73548baf63deULL, 0x766a0abb3c77b2a8ULL, 0x81c2c92e47edaee6ULL, 0x92722c851482353bULL, 0xa2bfe8a14cf10364ULL, 0xa81a664bbc423001ULL,
+  0xc24b8b70d0f89791ULL, 0xc76c51a30654be30ULL, 0xd192e819d6ef5218ULL, 0xd69906245565a910ULL, 0xf40e35855771202aULL, 0x106aa07032bbd1b8ULL, 0x19a4c116b8d2d0c8ULL,
+  0x1e376c085141ab53ULL, 0x2748774cdf8eeb99ULL, 0x34b0bcb5e19b48a8ULL, 0x391c0cb3c5c95a63ULL, 0x4ed8aa4ae3418acbULL, 0x5b9cca4f7763e373ULL, 0x682e6ff3d6b2b8a3ULL,
+  0x748f82ee5defb2fcULL, 0x78a5636f43172f60ULL, 0x84c87814a1f0ab72ULL, 0x8cc702081a6439ecULL, 0x90befffa23631e28ULL, 0xa4506cebde82bde9ULL, 0xbef9a3f7b2c67915ULL,
+  0xc67178f2e372532bULL, 0xca273eceea26619cULL, 0xd186b8c721c0c207ULL, 0xeada7dd6cde0eb1eULL, 0xf57d4f7fee6ed178ULL, 0x06f067aa72176fbaULL, 0x0a637dc5a2c898a6ULL,
+  0x113f9804bef90daeULL, 0x1b710b35131c471bULL, 0x28db77f523047d84ULL, 0x32caab7b40c72493ULL, 0x3c9ebe0a15c9bebcULL, 0x431d67c49c100d4cULL, 0x4cc5d4becb3e42b6ULL,
+  0x597f299cfc657e2aULL, 0x5fcb6fab3ad6faecULL, 0x6c44198c4a475817ULL
+};
+
+#define L_ROTR32(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+#define L_ROTR64(x, n) (((x) >> (n)) | ((x) << (64 - (n))))
+
+static void legacy_block_sha256(uint32_t *state, const uint8_t *data) {
+  uint32_t w[64];
+  for (int i = 0; i < 16; i++) {
+    w[i] = __builtin_bswap32(((uint32_t *)data)[i]);
+  }
+  for (int i = 16; i < 64; i++) {
+    uint32_t s0 = L_ROTR32(w[i - 15], 7) ^ L_ROTR32(w[i - 15], 18) ^ (w[i - 15] >> 3);
+    uint32_t s1 = L_ROTR32(w[i - 2], 17) ^ L_ROTR32(w[i - 2], 19) ^ (w[i - 2] >> 10);
+    w[i] = s1 + w[i - 7] + s0 + w[i - 16];
+  }
+  uint32_t a = state[0], b = state[1], c = state[2], d = state[3], e = state[4], f = state[5], g = state[6], h = state[7];
+  for (int i = 0; i < 64; i++) {
+    uint32_t t1 = h + (L_ROTR32(e, 6) ^ L_ROTR32(e, 11) ^ L_ROTR32(e, 25)) + ((e & f) ^ (~e & g)) + legacy_k256[i] + w[i];
+    uint32_t t2 = (L_ROTR32(a, 2) ^ L_ROTR32(a, 13) ^ L_ROTR32(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+    h = g;
+    g = f;
+    f = e;
+    e = d + t1;
+    d = c;
+    c = b;
+    b = a;
+    a = t1 + t2;
+  }
+  state[0] += a;
+  state[1] += b;
+  state[2] += c;
+  state[3] += d;
+  state[4] += e;
+  state[5] += f;
+  state[6] += g;
+  state[7] += h;
+}
+
+static void legacy_block_sha512(uint64_t *state, const uint8_t *data) {
+  uint64_t w[80];
+  for (int i = 0; i < 16; i++) {
+    w[i] = __builtin_bswap64(((uint64_t *)data)[i]);
+  }
+  for (int i = 16; i < 80; i++) {
+    uint64_t s0 = L_ROTR64(w[i - 15], 1) ^ L_ROTR64(w[i - 15], 8) ^ (w[i - 15] >> 7);
+    uint64_t s1 = L_ROTR64(w[i - 2], 19) ^ L_ROTR64(w[i - 2], 61) ^ (w[i - 2] >> 6);
+    w[i] = s1 + w[i - 7] + s0 + w[i - 16];
+  }
+  uint64_t a = state[0], b = state[1], c = state[2], d = state[3], e = state[4], f = state[5], g = state[6], h = state[7];
+  for (int i = 0; i < 80; i++) {
+    uint64_t t1 = h + (L_ROTR64(e, 14) ^ L_ROTR64(e, 18) ^ L_ROTR64(e, 41)) + ((e & f) ^ (~e & g)) + legacy_k512[i] + w[i];
+    uint64_t t2 = (L_ROTR64(a, 28) ^ L_ROTR64(a, 34) ^ L_ROTR64(a, 39)) + ((a & b) ^ (a & c) ^ (b & c));
+    h = g;
+    g = f;
+    f = e;
+    e = d + t1;
+    d = c;
+    c = b;
+    b = a;
+    a = t1 + t2;
+  }
+  state[0] += a;
+  state[1] += b;
+  state[2] += c;
+  state[3] += d;
+  state[4] += e;
+  state[5] += f;
+  state[6] += g;
+  state[7] += h;
+}
+
+// Exposes the block functions and the state of the software backend
+class BlockSHA2 : public SHA2Builder {
+public:
+  explicit BlockSHA2(size_t hashSize) : SHA2Builder(hashSize) {
+    begin();
+  }
+  void block(const uint8_t *data) {
+    if (is_sha512) {
+      process_block_sha512(data);
+    } else {
+      process_block_sha256(data);
+    }
+  }
+  uint32_t *state32() {
+    return state_32;
+  }
+  uint64_t *state64() {
+    return state_64;
+  }
+};
+
+static bool sha2_blocks_match(void) {
+  BlockSHA2 sha256(SHA2_256_HASH_SIZE);
+  BlockSHA2 sha512(SHA2_512_HASH_SIZE);
+  uint32_t state32[8];
+  uint64_t state64[8];
+  memcpy(state32, sha256.state32(), sizeof(state32));
+  memcpy(state64, sha512.state64(), sizeof(state64));
+  for (size_t offset = 0; offset + 128 <= sizeof(s_data); offset += 128) {
+    sha256.block(s_data + offset);
+    legacy_block_sha256(state32, s_data + offset);
+    sha512.block(s_data + offset);
+    legacy_block_sha512(state64, s_data + offset);
+  }
+  return !memcmp(state32, sha256.state32(), sizeof(state32)) && !memcmp(state64, sha512.state64(), sizeof(state64));
+}
+
+static void BM_SHA256Block(BenchState &state) {
+  BlockSHA2 sha256(SHA2_256_HASH_SIZE);
+  for (auto _ : state) {
+    for (size_t offset = 0; offset < sizeof(s_data); offset += SHA2_256_BLOCK_SIZE) {
+      sha256.block(s_data + offset);
+    }
+  }
+  benchDoNotOptimize(sha256.state32()[0]);
+  state.setBytesProcessed(state.iterations() * sizeof(s_data));
+}
+BENCHMARK(BM_SHA256Block);
+
+static void BM_LegacySHA256Block(BenchState &state) {
+  uint32_t state32[8] = {};
+  for (auto _ : state) {
+    for (size_t offset = 0; offset < sizeof(s_data); offset += SHA2_256_BLOCK_SIZE) {
+      legacy_block_sha256(state32, s_data + offset);
+    }
+  }
+  benchDoNotOptimize(state32[0]);
+  state.setBytesProcessed(state.iterations() * sizeof(s_data));
+}
+BENCHMARK(BM_LegacySHA256Block);
+
+static void BM_SHA512Block(BenchState &state) {
+  BlockSHA2 sha512(SHA2_512_HASH_SIZE);
+  for (auto _ : state) {
+    for (size_t offset = 0; offset < sizeof(s_data); offset += SHA2_512_BLOCK_SIZE) {
+      sha512.block(s_data + offset);
+    }
+  }
+  benchDoNotOptimize(sha512.state64()[0]);
+  state.setBytesProcessed(state.iterations() * sizeof(s_data));
+}
+BENCHMARK(BM_SHA512Block);
+
+static void BM_LegacySHA512Block(BenchState &state) {
+  uint64_t state64[8] = {};
+  for (auto _ : state) {
+    for (size_t offset = 0; offset < sizeof(s_data); offset += SHA2_512_BLOCK_SIZE) {
+      legacy_block_sha512(state64, s_data + offset);
+    }
+  }
+  benchDoNotOptimize(state64[0]);
+  state.setBytesProcessed(state.iterations() * sizeof(s_data));
+}
+BENCHMARK(BM_LegacySHA512Block);
+
+// Previous SHA3Builder::keccak_f, with the rotation and lane tables decoded
+// every round
+static const uint64_t legacy_keccak_rc[24] = {0x0000000000000001ULL, 0x0000000000008082ULL, 0x800000000000808AULL, 0x8000000080008000ULL,
+                                              0x000000000000808BULL, 0x0000000080000001ULL, 0x8000000080008081ULL, 0x8000000000008009ULL,
+                                              0x000000000000008AULL, 0x0000000000000088ULL, 0x0000000080008009ULL, 0x000000008000000AULL,
+                                              0x000000008000808BULL, 0x800000000000008BULL, 0x8000000000008089ULL, 0x8000000000008003ULL,
+                                              0x8000000000008002ULL, 0x8000000000000080ULL, 0x000000000000800AULL, 0x800000008000000AULL,
+                                              0x8000000080008081ULL, 0x8000000000008080ULL, 0x0000000080000001ULL, 0x8000000080008008ULL};
+static const uint32_t legacy_rho[6] = {0x3f022425, 0x1c143a09, 0x2c3d3615, 0x27191713, 0x312b382e, 0x3e030832};
+static const uint32_t legacy_pi[6] = {0x110b070a, 0x10050312, 0x04181508, 0x0d13170f, 0x0e14020c, 0x01060916};
+
+#define LEGACY_ROTR64(x, y) (((x) << (64U - (y))) | ((x) >> (y)))
+
+static void legacy_keccak_f(uint64_t *s) {
+  uint64_t lane[5];
+  int i;
+  for (int round = 0; round < 24; round++) {
+    uint64_t t;
+    for (i = 0; i < 5; i++) {
+      lane[i] = s[i] ^ s[i + 5] ^ s[i + 10] ^ s[i + 15] ^ s[i + 20];
+    }
+    for (i = 0; i < 5; i++) {
+      t = lane[(i + 4) % 5] ^ LEGACY_ROTR64(lane[(i + 1) % 5], 63);
+      s[i] ^= t;
+      s[i + 5] ^= t;
+      s[i + 10] ^= t;
+      s[i + 15] ^= t;
+      s[i + 20] ^= t;
+    }
+    for (i = 1; i < 25; i += 4) {
+      uint32_t r = legacy_rho[(i - 1) >> 2];
+      for (int j = i; j < i + 4; j++) {
+        uint8_t r8 = (uint8_t)(r >> 24);
+        r <<= 8;
+        s[j] = LEGACY_ROTR64(s[j], r8);
+      }
+    }
+    t = s[1];
+    for (i = 0; i < 24; i += 4) {
+      uint32_t p = legacy_pi[i >> 2];
+      for (unsigned j = 0; j < 4; j++) {
+        uint64_t tmp = s[p & 0xff];
+        s[p & 0xff] = t;
+        t = tmp;
+        p >>= 8;
+      }
+    }
+    for (i = 0; i <= 20; i += 5) {
+      lane[0] = s[i];
+      lane[1] = s[i + 1];
+      lane[2] = s[i + 2];
+      lane[3] = s[i + 3];
+      lane[4] = s[i + 4];
+      s[i + 0] ^= (~lane[1]) & lane[2];
+      s[i + 1] ^= (~lane[2]) & lane[3];
+      s[i + 2] ^= (~lane[3]) & lane[4];
+      s[i + 3] ^= (~lane[4]) & lane[0];
+      s[i + 4] ^= (~lane[0]) & lane[1];
+    }
+    s[0] ^= legacy_keccak_rc[round];
+  }
+}
+
+// Exposes the permutation, the state is kept with the complemented lanes
+class PermutationSHA3 : public SHA3_256Builder {
+public:
+  PermutationSHA3() {
+    begin();
+  }
+  void permute() {
+    keccak_f(state);
+  }
+  uint64_t *lanes() {
+    return state;
+  }
+};
+
+static bool keccak_f_match(void) {
+  PermutationSHA3 sha3;
+  uint64_t lanes[25];
+  for (size_t i = 0; i < 25; i++) {
+    lanes[i] = 0;
+    for (size_t j = 0; j < 8; j++) {
+      lanes[i] |= (uint64_t)s_data[i * 8 + j] << (j * 8);
+    }
+    sha3.lanes()[i] ^= lanes[i];
+  }
+  PermutationSHA3 empty;
+  for (int round = 0; round < 4; round++) {
+    sha3.permute();
+    legacy_keccak_f(lanes);
+  }
+  for (size_t i = 0; i < 25; i++) {
+    // the complemented lanes start as all ones in a fresh state
+    if ((sha3.lanes()[i] ^ empty.lanes()[i]) != lanes[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_CYCLES() __rdtsc()
+#endif
+
+// One permutation per SHA3-256 block of 136 bytes
+static void run_keccak_f(BenchState &state, void (*permute)(uint64_t *lanes), uint64_t *lanes) {
+#ifdef BENCH_CYCLES
+  uint64_t start = BENCH_CYCLES();
+#endif
+  for (auto _ : state) {
+    permute(lanes);
+  }
+#ifdef BENCH_CYCLES
+  state.setCounter("cycles/byte", (double)(BENCH_CYCLES() - start) / ((double)state.iterations() * SHA3_256_RATE));
+#endif
+  benchDoNotOptimize(lanes[0]);
+  state.setBytesProcessed(state.iterations() * SHA3_256_RATE);
+}
+
+static PermutationSHA3 s_sha3;
+
+static void BM_KeccakF(BenchState &state) {
+  run_keccak_f(
+    state,
+    [](uint64_t *) {
+      s_sha3.permute();
+    },
+    s_sha3.lanes()
+  );
+}
+BENCHMARK(BM_KeccakF);
+
+static void BM_LegacyKeccakF(BenchState &state) {
+  uint64_t lanes[25] = {};
+  run_keccak_f(state, legacy_keccak_f, lanes);
+}
+BENCHMARK(BM_LegacyKeccakF);
+
+static void BM_MD5ToString(BenchState &state) {
+  MD5Builder md5;
+  for (auto _ : state) {
+    md5.begin();
+    md5.add("admin:realm:password");
+    md5.calculate();
+    benchDoNotOptimize(md5.toString().length());
+  }
+}
+BENCHMARK(BM_MD5ToString);
+
+// Previous PBKDF2_HMACBuilder derivation: every iteration prepares the key
+// and compresses both padded key blocks again, always 64 bytes long
+static void legacy_hmac(HashBuilder &hash, const uint8_t *key, size_t keyLen, const uint8_t *data, size_t dataLen, uint8_t *output) {
+  uint8_t keyPad[64];
+  uint8_t outerPad[64];
+  uint8_t innerHash[64];
+  size_t hashSize = hash.getHashSize();
+  if (keyLen > 64) {
+    hash.begin();
+    hash.add(key, keyLen);
+    hash.calculate();
+    hash.getBytes(keyPad);
+    keyLen = hashSize;
+  } else {
+    memcpy(keyPad, key, keyLen);
+  }
+  if (keyLen < 64) {
+    memset(keyPad + keyLen, 0, 64 - keyLen);
+  }
+  for (int i = 0; i < 64; i++) {
+    outerPad[i] = keyPad[i] ^ 0x5c;
+    keyPad[i] = keyPad[i] ^ 0x36;
+  }
+  hash.begin();
+  hash.add(keyPad, 64);
+  hash.add(data, dataLen);
+  hash.calculate();
+  hash.getBytes(innerHash);
+  hash.begin();
+  hash.add(outerPad, 64);
+  hash.add(innerHash, hashSize);
+  hash.calculate();
+  hash.getBytes(output);
+}
+
+static void legacy_pbkdf2(HashBuilder &hash, const char *password, const char *salt, uint32_t iterations, uint8_t *output) {
+  uint8_t u1[64];
+  uint8_t u2[64];
+  uint8_t saltWithBlock[256];
+  size_t hashSize = hash.getHashSize();
+  size_t saltLen = strlen(salt);
+  memcpy(saltWithBlock, salt, saltLen);
+  saltWithBlock[saltLen] = 0;
+  saltWithBlock[saltLen + 1] = 0;
+  saltWithBlock[saltLen + 2] = 0;
+  saltWithBlock[saltLen + 3] = 1;
+  legacy_hmac(hash, (const uint8_t *)password, strlen(password), saltWithBlock, saltLen + 4, u1);
+  memcpy(output, u1, hashSize);
+  for (uint32_t j = 1; j < iterations; j++) {
+    legacy_hmac(hash, (const uint8_t *)password, strlen(password), u1, hashSize, u2);
+    memcpy(u1, u2, hashSize);
+    for (size_t k = 0; k < hashSize; k++) {
+      output[k] ^= u1[k];
+    }
+  }
+}
+
+static void BM_PBKDF2_SHA256(BenchState &state) {
+  SHA256Builder sha256;
+  PBKDF2_HMACBuilder pbkdf2(&sha256, "password", "salt", state.range(0));
+  for (auto _ : state) {
+    pbkdf2.begin();
+    pbkdf2.calculate();
+    uint8_t out[32];
+    pbkdf2.getBytes(out);
+    benchDoNotOptimize(out[0]);
+  }
+  state.setItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_PBKDF2_SHA256)->Arg(10)->Arg(1000);
+
+static void BM_LegacyPBKDF2_SHA256(BenchState &state) {
+  SHA256Builder sha256;
+  for (auto _ : state) {
+    uint8_t out[64];
+    legacy_pbkdf2(sha256, "password", "salt", state.range(0), out);
+    benchDoNotOptimize(out[0]);
+  }
+  state.setItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_LegacyPBKDF2_SHA256)->Arg(10)->Arg(1000);
+
+// The same derivation spread over calls of 100 iterations, as from loop()
+static void BM_PBKDF2_SHA256Step(BenchState &state) {
+  SHA256Builder sha256;
+  PBKDF2_HMACBuilder pbkdf2(&sha256, "password", "salt", state.range(0));
+  for (auto _ : state) {
+    pbkdf2.begin();
+    while (!pbkdf2.step(100)) {}
+    uint8_t out[32];
+    pbkdf2.getBytes(out);
+    benchDoNotOptimize(out[0]);
+  }
+  state.setItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_PBKDF2_SHA256Step)->Arg(1000);
+
+static void BM_PBKDF2_SHA1(BenchState &state) {
+  SHA1Builder sha1;
+  PBKDF2_HMACBuilder pbkdf2(&sha1, "password", "salt", state.range(0));
+  for (auto _ : state) {
+    pbkdf2.begin();
+    pbkdf2.calculate();
+    uint8_t out[20];
+    pbkdf2.getBytes(out);
+    benchDoNotOptimize(out[0]);
+  }
+  state.setItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_PBKDF2_SHA1)->Arg(1000);
+
+static void BM_LegacyPBKDF2_SHA1(BenchState &state) {
+  SHA1Builder sha1;
+  for (auto _ : state) {
+    uint8_t out[64];
+    legacy_pbkdf2(sha1, "password", "salt", state.range(0), out);
+    benchDoNotOptimize(out[0]);
+  }
+  state.setItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_LegacyPBKDF2_SHA1)->Arg(1000);
+
+static void BM_HexEncode(BenchState &state) {
+  char out[2 * 64 + 1];
+  for (auto _ : state) {
+    benchDoNotOptimize(HEXBuilder::bytes2hex(out, sizeof(out), s_data, 64));
+  }
+  state.setBytesProcessed(state.iterations() * 64);
+}
+BENCHMARK(BM_HexEncode);
+
+int main(int argc, char **argv) {
+  for (size_t i = 0; i < sizeof(s_data); i++) {
+    s_data[i] = (uint8_t)(i * 131 + 7);
+  }
+  if (!sha2_blocks_match()) {
+    fprintf(stderr, "SHA-2 block functions differ from the previous ones\n");
+    return 1;
+  }
+  if (!keccak_f_match()) {
+    fprintf(stderr, "Keccak-f differs from the previous one\n");
+    return 1;
+  }
+  return benchMain(argc, argv);
+}
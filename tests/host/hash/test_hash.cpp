@@ -0,0 +1,437 @@
+/*
+ * Host tests for the hash builders (MD5Builder from the core, the Hash library)
+ * and the base64/hex helpers, against published test vectors (SHAKE outputs
+ * past the published lengths come from Python's hashlib). MultiHashBuilder
+ * and addStream() are checked against the single builders, copied builders
+ * against fresh ones.
+ */
+
+#include <unity.h>
+#include <string>
+#include "base64.h"
+#include "libb64/cdecode.h"
+#include "HEXBuilder.h"
+#include "MD5Builder.h"
+#include "MultiHashBuilder.h"
+#include "PBKDF2_HMACBuilder.h"
+#include "SHA1Builder.h"
+#include "SHA2Builder.h"
+#include "SHA3Builder.h"
+#include "StreamString.h"
+
+static const char abc[] = "abc";
+static const char two_blocks[] = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+
+static String digest(HashBuilder &hash, const char *text) {
+  hash.begin();
+  hash.add(text);
+  hash.calculate();
+  return hash.toString();
+}
+
+// a stream without a peek buffer, read in blocks
+class BlockStream : public Stream {
+public:
+  std::string data;
+  size_t pos = 0;
+  size_t reads = 0;
+  int available() override {
+    return data.size() - pos;
+  }
+  int read() override {
+    return pos < data.size() ? (uint8_t)data[pos++] : -1;
+  }
+  int peek() override {
+    return pos < data.size() ? (uint8_t)data[pos] : -1;
+  }
+  size_t readBytes(char *buffer, size_t length) override {
+    size_t n = std::min(length, data.size() - pos);
+    memcpy(buffer, data.data() + pos, n);
+    pos += n;
+    reads++;
+    return n;
+  }
+  size_t write(uint8_t) override {
+    return 0;
+  }
+};
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_hash_md5(void) {
+  MD5Builder md5;
+  TEST_ASSERT_EQUAL_STRING("d41d8cd98f00b204e9800998ecf8427e", digest(md5, "").c_str());
+  TEST_ASSERT_EQUAL_STRING("900150983cd24fb0d6963f7d28e17f72", digest(md5, abc).c_str());
+  // split across calls that do not line up with the 64 byte blocks
+  std::string million(1000000, 'a');
+  md5.begin();
+  for (size_t pos = 0; pos < million.size(); pos += 999) {
+    md5.add((const uint8_t *)million.data() + pos, std::min<size_t>(999, million.size() - pos));
+  }
+  md5.calculate();
+  TEST_ASSERT_EQUAL_STRING("7707d6ae4e027c70eea2a935c2296f21", md5.toString().c_str());
+}
+
+void test_hash_sha1(void) {
+  SHA1Builder sha1;
+  TEST_ASSERT_EQUAL_STRING("a9993e364706816aba3e25717850c26c9cd0d89d", digest(sha1, abc).c_str());
+  TEST_ASSERT_EQUAL_STRING("84983e441c3bd26ebaae4aa1f95129e5e54670f1", digest(sha1, two_blocks).c_str());
+}
+
+void test_hash_sha2(void) {
+  SHA224Builder sha224;
+  SHA256Builder sha256;
+  SHA384Builder sha384;
+  SHA512Builder sha512;
+  TEST_ASSERT_EQUAL_STRING("23097d223405d8228642a477bda255b32aadbce4bda0b3f7e36c9da7", digest(sha224, abc).c_str());
+  TEST_ASSERT_EQUAL_STRING("ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad", digest(sha256, abc).c_str());
+  TEST_ASSERT_EQUAL_STRING("248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1", digest(sha256, two_blocks).c_str());
+  TEST_ASSERT_EQUAL_STRING(
+    "cb00753f45a35e8bb5a03d699ac65007272c32ab0eded1631a8b605a43ff5bed8086072ba1e7cc2358baeca134c825a7", digest(sha384, abc).c_str()
+  );
+  TEST_ASSERT_EQUAL_STRING(
+    "ddaf35a193617abacc417349ae20413112e6fa4e89a97ea20a9eeee64b55d39a2192992a274fc1a836ba3c23a3feebbd454d4423643ce80e2a9ac94fa54ca49f",
+    digest(sha512, abc).c_str()
+  );
+}
+
+void test_hash_sha2_long_and_unaligned(void) {
+  SHA256Builder sha256;
+  SHA512Builder sha512;
+  std::string million(1000000, 'a');
+  sha256.begin();
+  sha512.begin();
+  // odd sized pieces at odd addresses
+  for (size_t pos = 0; pos < million.size(); pos += 997) {
+    size_t len = std::min<size_t>(997, million.size() - pos);
+    sha256.add((const uint8_t *)million.data() + pos, len);
+    sha512.add((const uint8_t *)million.data() + pos, len);
+  }
+  sha256.calculate();
+  sha512.calculate();
+  TEST_ASSERT_EQUAL_STRING("cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0", sha256.toString().c_str());
+  TEST_ASSERT_EQUAL_STRING(
+    "e718483d0ce769644e2e42c7bc15b4638e1f98b13b2044285632a803afa973ebde0ff244877ea60a4cb0432ce577c31beb009c5c2c49aa2e4eadb217ad8cc09b",
+    sha512.toString().c_str()
+  );
+
+  // every length and offset around the block and padding boundaries
+  uint8_t data[300];
+  for (size_t i = 0; i < sizeof(data); i++) {
+    data[i] = (uint8_t)(i * 7 + 3);
+  }
+  uint8_t shifted[sizeof(data) + 8];
+  uint8_t whole[64];
+  uint8_t split[64];
+  for (size_t len = 0; len < 260; len += 3) {
+    sha512.begin();
+    sha512.add(data, len);
+    sha512.calculate();
+    sha512.getBytes(whole);
+    for (size_t offset = 1; offset < 8; offset += 2) {
+      memcpy(shifted + offset, data, len);
+      sha512.begin();
+      sha512.add(shifted + offset, len / 2);
+      sha512.add(shifted + offset + len / 2, len - len / 2);
+      sha512.calculate();
+      sha512.getBytes(split);
+      TEST_ASSERT_EQUAL_MEMORY(whole, split, 64);
+    }
+  }
+}
+
+void test_hash_sha3(void) {
+  SHA3_256Builder sha3_256;
+  SHA3_512Builder sha3_512;
+  TEST_ASSERT_EQUAL_STRING("a7ffc6f8bf1ed76651c14756a061d662f580ff4de43b49fa82d80a4b80f8434a", digest(sha3_256, "").c_str());
+  TEST_ASSERT_EQUAL_STRING("3a985da74fe225b2045c172d6bd390bd855f086e3e9d525b46bfe24511431532", digest(sha3_256, abc).c_str());
+  TEST_ASSERT_EQUAL_STRING(
+    "b751850b1a57168a5693cd924b6b096e08f621827444f70d884f5d0240d2712e10e116e9192af3c91a7ec57647e3934057340b4cf408d5a56592f8274eec53f0",
+    digest(sha3_512, abc).c_str()
+  );
+  // the domain byte and the final padding bit in the same byte
+  TEST_ASSERT_EQUAL_STRING("8094bb53c44cfb1e67b7c30447f9a1c33696d2463ecc1d9c92538913392843c9", digest(sha3_256, std::string(135, 'a').c_str()).c_str());
+  TEST_ASSERT_EQUAL_STRING("3fc5559f14db8e453a0a3091edbd2bc25e11528d81c66fa570a4efdcc2695ee1", digest(sha3_256, std::string(136, 'a').c_str()).c_str());
+}
+
+void test_hash_shake(void) {
+  SHAKE128Builder shake128;
+  SHAKE256Builder shake256;
+  TEST_ASSERT_EQUAL(32, shake128.getHashSize());
+  TEST_ASSERT_EQUAL_STRING("7f9c2ba4e88f827d616045507605853ed73b8093f6efbc88eb1a6eacfa66ef26", digest(shake128, "").c_str());
+  TEST_ASSERT_EQUAL_STRING("5881092dd818bf5cf8a3ddb793fbcba74097d5c526a6d35f97b83351940f2cc8", digest(shake128, abc).c_str());
+  TEST_ASSERT_EQUAL_STRING(
+    "46b9dd2b0ba88d13233b3feb743eeb243fcd52ea62b81b82b50c27646ed5762fd75dc4ddd8c0f200cb05019d67b592f6fc821c49479ab48640292eacb3b7c4be",
+    digest(shake256, "").c_str()
+  );
+  TEST_ASSERT_EQUAL_STRING(
+    "483366601360a8771c6863080cc4114d8db44530f8f1e1ee4f94ea37e78b5739d5a15bef186a5386c75744c0527e1faa9f8726e462a12a4feb06bd8801e751e4",
+    digest(shake256, abc).c_str()
+  );
+
+  // the output that follows the digest, squeezed across several rates in
+  // pieces of every size
+  uint8_t out[500];
+  digest(shake128, abc);
+  for (size_t pos = 0, len = 1; pos < sizeof(out); pos += len, len++) {
+    shake128.squeeze(out + pos, std::min(len, sizeof(out) - pos));
+  }
+  TEST_ASSERT_EQUAL_STRING("44c50af32acd3f2cdd066568706f509b", HEXBuilder::bytes2hex(out, 16).c_str());
+  TEST_ASSERT_EQUAL_STRING("a99ced827052ae3921fd210d66ec315c", HEXBuilder::bytes2hex(out + sizeof(out) - 16, 16).c_str());
+
+  // squeezed without calculate(), from the first byte
+  std::string thousand(1000, 'a');
+  shake256.begin();
+  shake256.add((const uint8_t *)thousand.data(), thousand.size());
+  shake256.squeeze(out, 64 + 300);
+  TEST_ASSERT_EQUAL_STRING(
+    "e262331ad290c96ab1c0fa045470244b415ba6696a934d60f2999b8e92aaa24ee8eb039abd7af7d64fde39fa73267b02fdd3a50e1b8651b846a9bb2cc4f344c5",
+    HEXBuilder::bytes2hex(out, 64).c_str()
+  );
+  TEST_ASSERT_EQUAL_STRING("1f40baacb0d6b3750bbbba83e6646b94", HEXBuilder::bytes2hex(out + 64 + 300 - 16, 16).c_str());
+}
+
+void test_hash_pbkdf2(void) {
+  // RFC 6070
+  SHA1Builder sha1;
+  PBKDF2_HMACBuilder pbkdf2(&sha1, "password", "salt", 2);
+  pbkdf2.begin();
+  pbkdf2.calculate();
+  TEST_ASSERT_EQUAL_STRING("ea6c014dc72d6f8ccd1ed92ace1d41f0d8de8957", pbkdf2.toString().c_str());
+  pbkdf2.setIterations(4096);
+  pbkdf2.begin();
+  pbkdf2.calculate();
+  TEST_ASSERT_EQUAL_STRING("4b007901b765489abead49d926f721d065a429c1", pbkdf2.toString().c_str());
+
+  // the key is padded to the 128 byte block of SHA-384/512 and the rate of SHA-3
+  SHA384Builder sha384;
+  SHA512Builder sha512;
+  SHA3_256Builder sha3;
+  pbkdf2.setIterations(2);
+  pbkdf2.setHashAlgorithm(&sha384);
+  pbkdf2.begin();
+  pbkdf2.calculate();
+  TEST_ASSERT_EQUAL_STRING("54f775c6d790f21930459162fc535dbf04a939185127016a04176a0730c6f1f4fb48832ad1261baadd2cedd50814b1c8", pbkdf2.toString().c_str());
+  pbkdf2.setHashAlgorithm(&sha512);
+  pbkdf2.begin();
+  pbkdf2.calculate();
+  TEST_ASSERT_EQUAL_STRING(
+    "e1d9c16aa681708a45f5c7c4e215ceb66e011a2e9f0040713f18aefdb866d53cf76cab2868a39b9f7840edce4fef5a82be67335c77a6068e04112754f27ccf4e",
+    pbkdf2.toString().c_str()
+  );
+  pbkdf2.setIterations(3);
+  pbkdf2.setHashAlgorithm(&sha3);
+  pbkdf2.begin();
+  pbkdf2.calculate();
+  TEST_ASSERT_EQUAL_STRING("6677065466c97fdef1c15ae8d95020ca948334f53eceeafc6115ddf405f6d6a4", pbkdf2.toString().c_str());
+
+  // a password longer than the block is hashed first, a salt of any length
+  SHA256Builder sha256;
+  PBKDF2_HMACBuilder longer(&sha256, std::string(100, 'p').c_str(), std::string(300, 's').c_str(), 3);
+  longer.begin();
+  longer.calculate();
+  TEST_ASSERT_EQUAL_STRING("093e55d8d544fc23ec47a2aeee01c563cc6d2dbd9ae04c185c220639dc641ceb", longer.toString().c_str());
+}
+
+void test_hash_pbkdf2_step(void) {
+  SHA256Builder sha256;
+  PBKDF2_HMACBuilder pbkdf2(&sha256, "password", "salt", 4096);
+  pbkdf2.begin();
+  int calls = 0;
+  while (!pbkdf2.step(1000)) {
+    calls++;
+    TEST_ASSERT_LESS_THAN(10, calls);
+  }
+  TEST_ASSERT_EQUAL(4, calls);
+  TEST_ASSERT_TRUE(pbkdf2.step(1));
+  TEST_ASSERT_EQUAL_STRING("c5e478d59288c841aa530db6845c4c8d962893a001ce4e11a4963873aa98134a", pbkdf2.toString().c_str());
+
+  // changing the input part way starts over
+  pbkdf2.begin();
+  TEST_ASSERT_FALSE(pbkdf2.step(100));
+  pbkdf2.setSalt("pepper");
+  pbkdf2.setSalt("salt");
+  pbkdf2.calculate();
+  TEST_ASSERT_EQUAL_STRING("c5e478d59288c841aa530db6845c4c8d962893a001ce4e11a4963873aa98134a", pbkdf2.toString().c_str());
+
+  // without a salt nothing is derived
+  PBKDF2_HMACBuilder unsalted(&sha256, "password", "", 10);
+  TEST_ASSERT_FALSE(unsalted.step(100));
+}
+
+void test_hash_save_state(void) {
+  // a digest continued from a saved block boundary equals the whole one
+  SHA1Builder sha1;
+  SHA256Builder sha256;
+  SHA512Builder sha512;
+  SHA3_256Builder sha3;
+  HashBuilder *builders[] = {&sha1, &sha256, &sha512, &sha3};
+  std::string data(1000, 'x');
+  for (HashBuilder *hash : builders) {
+    String whole = digest(*hash, data.c_str());
+    uint8_t state[256];
+    uint8_t other[256];
+    TEST_ASSERT_LESS_OR_EQUAL(sizeof(state), hash->getStateSize());
+    size_t prefix = hash->getBlockSize() * 2;
+    hash->begin();
+    hash->add((const uint8_t *)data.data(), prefix);
+    TEST_ASSERT_TRUE(hash->saveState(state));
+    hash->add((const uint8_t *)data.data(), 1);
+    // not at a block boundary
+    TEST_ASSERT_FALSE(hash->saveState(other));
+    hash->begin();
+    TEST_ASSERT_TRUE(hash->restoreState(state));
+    hash->add((const uint8_t *)data.data() + prefix, data.size() - prefix);
+    hash->calculate();
+    TEST_ASSERT_EQUAL_STRING(whole.c_str(), hash->toString().c_str());
+  }
+  MD5Builder md5;
+  TEST_ASSERT_EQUAL(0, md5.getStateSize());
+}
+
+// A copy made in the middle of a stream goes on apart from the original
+template<typename Builder> static void copy_mid_stream(const char *first, const char *second) {
+  std::string data(300, 'y');
+  Builder original;
+  original.begin();
+  original.add((const uint8_t *)data.data(), 150);
+  Builder copy(original);
+  Builder assigned;
+  assigned = original;
+  original.add((const uint8_t *)data.data(), 150);
+  original.calculate();
+  TEST_ASSERT_EQUAL_STRING(first, original.toString().c_str());
+  copy.add((const uint8_t *)data.data(), 50);
+  copy.calculate();
+  TEST_ASSERT_EQUAL_STRING(second, copy.toString().c_str());
+  assigned.add((const uint8_t *)data.data(), 50);
+  assigned.calculate();
+  TEST_ASSERT_EQUAL_STRING(second, assigned.toString().c_str());
+}
+
+void test_hash_copy(void) {
+  std::string whole(300, 'y');
+  std::string part(200, 'y');
+  SHA1Builder sha1;
+  SHA256Builder sha256;
+  SHA512Builder sha512;
+  copy_mid_stream<SHA1Builder>(digest(sha1, whole.c_str()).c_str(), digest(sha1, part.c_str()).c_str());
+  copy_mid_stream<SHA256Builder>(digest(sha256, whole.c_str()).c_str(), digest(sha256, part.c_str()).c_str());
+  copy_mid_stream<SHA512Builder>(digest(sha512, whole.c_str()).c_str(), digest(sha512, part.c_str()).c_str());
+}
+
+void test_hash_multi(void) {
+  std::string data;
+  for (int i = 0; i < 5000; i++) {
+    data += (char)(i * 131 % 255 + 1);
+  }
+  MD5Builder md5;
+  SHA256Builder sha256;
+  SHA3_256Builder sha3;
+  String expected = digest(md5, data.c_str()) + digest(sha256, data.c_str()) + digest(sha3, data.c_str());
+
+  MultiHashBuilder multi;
+  TEST_ASSERT_TRUE(multi.addBuilder(&md5));
+  TEST_ASSERT_TRUE(multi.addBuilder(&sha256));
+  TEST_ASSERT_TRUE(multi.addBuilder(&sha3));
+  TEST_ASSERT_FALSE(multi.addBuilder(&multi));
+  TEST_ASSERT_EQUAL(3, multi.count());
+  TEST_ASSERT_EQUAL(16 + 32 + 32, multi.getHashSize());
+  TEST_ASSERT_EQUAL_STRING(expected.c_str(), digest(multi, data.c_str()).c_str());
+
+  char chars[2 * 80 + 1];
+  multi.getChars(chars);
+  TEST_ASSERT_EQUAL_STRING(expected.c_str(), chars);
+  uint8_t bytes[80];
+  uint8_t single[32];
+  multi.getBytes(bytes);
+  sha256.getBytes(single);
+  TEST_ASSERT_EQUAL_MEMORY(single, bytes + 16, 32);
+  TEST_ASSERT_TRUE(multi.builder(1) == &sha256);
+  TEST_ASSERT_NULL(multi.builder(3));
+}
+
+void test_hash_add_stream(void) {
+  std::string data;
+  for (int i = 0; i < 10000; i++) {
+    data += (char)('a' + i % 26);
+  }
+  MD5Builder md5;
+  SHA256Builder sha256;
+  String expected = digest(md5, data.c_str()) + digest(sha256, data.c_str());
+  MultiHashBuilder multi;
+  multi.addBuilder(&md5);
+  multi.addBuilder(&sha256);
+
+  // read in large blocks
+  BlockStream blocks;
+  blocks.data = data;
+  multi.begin();
+  TEST_ASSERT_TRUE(multi.addStream(blocks, SIZE_MAX));
+  multi.calculate();
+  TEST_ASSERT_EQUAL_STRING(expected.c_str(), multi.toString().c_str());
+  TEST_ASSERT_EQUAL(data.size(), blocks.pos);
+  TEST_ASSERT_LESS_OR_EQUAL(3, blocks.reads);
+
+  // straight from the stream buffer
+  StreamString peeked;
+  peeked.print(data.c_str());
+  multi.begin();
+  TEST_ASSERT_TRUE(multi.addStream(peeked, data.size()));
+  multi.calculate();
+  TEST_ASSERT_EQUAL_STRING(expected.c_str(), multi.toString().c_str());
+  TEST_ASSERT_EQUAL(0, peeked.available());
+
+  // stops at maxLen on both paths
+  blocks.pos = 0;
+  peeked.print(data.c_str());
+  TEST_ASSERT_TRUE(md5.addStream(blocks, 100));
+  TEST_ASSERT_TRUE(md5.addStream(peeked, 100));
+  TEST_ASSERT_EQUAL(100, blocks.pos);
+  TEST_ASSERT_EQUAL(data.size() - 100, peeked.available());
+}
+
+void test_hash_hex(void) {
+  const uint8_t bytes[] = {0x00, 0x7f, 0x80, 0xff};
+  TEST_ASSERT_EQUAL_STRING("007f80ff", HEXBuilder::bytes2hex(bytes, sizeof(bytes)).c_str());
+  uint8_t out[4];
+  TEST_ASSERT_EQUAL(4, HEXBuilder::hex2bytes(out, sizeof(out), "007F80ff"));
+  TEST_ASSERT_EQUAL_MEMORY(bytes, out, sizeof(bytes));
+  TEST_ASSERT_FALSE(HEXBuilder::isHexString("0g", 2));
+}
+
+void test_base64(void) {
+  TEST_ASSERT_EQUAL_STRING("", base64::encode("").c_str());
+  TEST_ASSERT_EQUAL_STRING("Zg==", base64::encode("f").c_str());
+  TEST_ASSERT_EQUAL_STRING("Zm8=", base64::encode("fo").c_str());
+  TEST_ASSERT_EQUAL_STRING("Zm9vYmFy", base64::encode("foobar").c_str());
+  uint8_t data[256];
+  for (int i = 0; i < 256; i++) {
+    data[i] = i;
+  }
+  String encoded = base64::encode(data, sizeof(data));
+  char decoded[256];
+  TEST_ASSERT_EQUAL(256, base64_decode_chars(encoded.c_str(), encoded.length(), decoded));
+  TEST_ASSERT_EQUAL_MEMORY(data, decoded, sizeof(data));
+}
+
+int main(void) {
+  UNITY_BEGIN();
+  RUN_TEST(test_hash_md5);
+  RUN_TEST(test_hash_sha1);
+  RUN_TEST(test_hash_sha2);
+  RUN_TEST(test_hash_sha2_long_and_unaligned);
+  RUN_TEST(test_hash_sha3);
+  RUN_TEST(test_hash_shake);
+  RUN_TEST(test_hash_pbkdf2);
+  RUN_TEST(test_hash_pbkdf2_step);
+  RUN_TEST(test_hash_save_state);
+  RUN_TEST(test_hash_copy);
+  RUN_TEST(test_hash_multi);
+  RUN_TEST(test_hash_add_stream);
+  RUN_TEST(test_hash_hex);
+  RUN_TEST(test_base64);
+  return UNITY_END();
+}
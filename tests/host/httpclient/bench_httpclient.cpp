@@ -0,0 +1,84 @@
+/*
+ * HTTPClient request/response cost against a loopback server thread that
+ * answers every request with the same canned response.
+ */
+
+#include <bench.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <loopback.h>
+#include "HTTPClient.h"
+
+static int s_listen_fd;
+static uint16_t s_port;
+static std::string s_response;
+static std::atomic<bool> s_stop(false);
+
+static void server_loop() {
+  while (!s_stop) {
+    int fd = accept(s_listen_fd, NULL, NULL);
+    if (fd < 0) {
+      continue;
+    }
+    loopback_receive_head(fd);
+    loopback_send(fd, s_response);
+    loopback_receive_all(fd);
+    close(fd);
+  }
+}
+
+static std::string canned_response(int64_t headers, const std::string &body) {
+  std::string response = "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nContent-Length: " + std::to_string(body.size()) + "\r\n";
+  for (int64_t i = 0; i < headers; i++) {
+    response += "X-Header-" + std::to_string(i) + ": some header value of typical length\r\n";
+  }
+  return response + "\r\n" + body;
+}
+
+static void run_gets(BenchState &state, bool collect_all) {
+  String url = String("http://127.0.0.1:") + s_port + "/";
+  for (auto _ : state) {
+    HTTPClient http;
+    http.setReuse(false);
+    if (collect_all) {
+      http.collectAllHeaders();
+    }
+    http.begin(url);
+    benchDoNotOptimize(http.GET());
+    benchDoNotOptimize(http.getString().length());
+    http.end();
+  }
+  state.setItemsProcessed(state.iterations());
+}
+
+static void BM_HTTPClientGet(BenchState &state) {
+  s_response = canned_response(state.range(0), "hello");
+  run_gets(state, false);
+}
+BENCHMARK(BM_HTTPClientGet)->Arg(2)->Arg(32);
+
+static void BM_HTTPClientCollectAllHeaders(BenchState &state) {
+  s_response = canned_response(state.range(0), "hello");
+  run_gets(state, true);
+}
+BENCHMARK(BM_HTTPClientCollectAllHeaders)->Arg(2)->Arg(32);
+
+static void BM_HTTPClientBody(BenchState &state) {
+  s_response = canned_response(2, std::string(state.range(0), 'x'));
+  run_gets(state, false);
+  state.setBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_HTTPClientBody)->Arg(16384);
+
+int main(int argc, char **argv) {
+  s_listen_fd = loopback_listen(&s_port);
+  std::thread server(server_loop);
+  int ret = benchMain(argc, argv);
+  // wake the server thread up with one last connection
+  s_stop = true;
+  close(loopback_connect(s_port));
+  server.join();
+  close(s_listen_fd);
+  return ret;
+}
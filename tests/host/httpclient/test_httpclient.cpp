@@ -0,0 +1,112 @@
+/*
+ * Host tests for HTTPClient response parsing, against canned responses served
+ * over loopback TCP by a server thread.
+ */
+
+#include <unity.h>
+#include <string>
+#include <thread>
+#include <loopback.h>
+#include "HTTPClient.h"
+
+static int s_listen_fd = -1;
+static uint16_t s_port;
+static std::string s_request;  // request head seen by the server
+static std::thread s_server;
+
+// Serves one connection: reads the request head, sends response and waits for
+// the client to close, the tests turn connection reuse off for that
+static void serve(const std::string &response) {
+  s_server = std::thread([response]() {
+    int fd = accept(s_listen_fd, NULL, NULL);
+    s_request = loopback_receive_head(fd);
+    loopback_send(fd, response);
+    loopback_receive_all(fd);
+    close(fd);
+  });
+}
+
+static String url(const char *path) {
+  return String("http://127.0.0.1:") + s_port + path;
+}
+
+void setUp(void) {
+  s_request.clear();
+  s_listen_fd = loopback_listen(&s_port);
+}
+
+void tearDown(void) {
+  if (s_server.joinable()) {
+    s_server.join();
+  }
+  close(s_listen_fd);
+}
+
+void test_httpclient_get(void) {
+  serve("HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\nContent-Length: 5\r\n\r\nhello");
+  HTTPClient http;
+  http.setReuse(false);
+  TEST_ASSERT_TRUE(http.begin(url("/path?q=1")));
+  TEST_ASSERT_EQUAL(200, http.GET());
+  TEST_ASSERT_EQUAL(5, http.getSize());
+  TEST_ASSERT_EQUAL_STRING("hello", http.getString().c_str());
+  http.end();
+  s_server.join();
+  TEST_ASSERT_EQUAL(0, s_request.find("GET /path?q=1 HTTP/1.1\r\n"));
+  TEST_ASSERT_TRUE(s_request.find("\r\nHost: 127.0.0.1:") != std::string::npos);
+}
+
+void test_httpclient_collect_headers(void) {
+  serve("HTTP/1.1 201 Created\r\nContent-Length: 0\r\nx-request-id:   abc123  \r\nLocation: /new\r\nServer: host\r\n\r\n");
+  HTTPClient http;
+  http.setReuse(false);
+  const char *keys[] = {"X-Request-Id", "Location"};
+  http.collectHeaders(keys, 2);
+  http.begin(url("/"));
+  TEST_ASSERT_EQUAL(201, http.POST(String("data")));
+  TEST_ASSERT_EQUAL(2, http.headers());
+  TEST_ASSERT_TRUE(http.hasHeader("X-Request-Id"));
+  TEST_ASSERT_EQUAL_STRING("abc123", http.header("X-Request-Id").c_str());
+  TEST_ASSERT_EQUAL_STRING("/new", http.header("Location").c_str());
+  TEST_ASSERT_FALSE(http.hasHeader("Server"));
+  http.end();
+}
+
+void test_httpclient_chunked_body(void) {
+  serve("HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n4\r\nWiki\r\n5\r\npedia\r\nE\r\n in\r\n\r\nchunks.\r\n0\r\n\r\n");
+  HTTPClient http;
+  http.setReuse(false);
+  http.begin(url("/"));
+  TEST_ASSERT_EQUAL(200, http.GET());
+  TEST_ASSERT_EQUAL(-1, http.getSize());
+  TEST_ASSERT_EQUAL_STRING("Wikipedia in\r\n\r\nchunks.", http.getString().c_str());
+  http.end();
+}
+
+void test_httpclient_error_status(void) {
+  serve("HTTP/1.1 404 Not Found\r\nContent-Length: 9\r\n\r\nnot found");
+  HTTPClient http;
+  http.setReuse(false);
+  http.begin(url("/missing"));
+  TEST_ASSERT_EQUAL(404, http.GET());
+  TEST_ASSERT_EQUAL_STRING("not found", http.getString().c_str());
+  http.end();
+}
+
+void test_httpclient_connection_refused(void) {
+  HTTPClient http;
+  http.setReuse(false);
+  http.begin(String("http://127.0.0.1:") + loopback_free_port() + "/");
+  TEST_ASSERT_EQUAL(HTTPC_ERROR_CONNECTION_REFUSED, http.GET());
+  http.end();
+}
+
+int main(void) {
+  UNITY_BEGIN();
+  RUN_TEST(test_httpclient_get);
+  RUN_TEST(test_httpclient_collect_headers);
+  RUN_TEST(test_httpclient_chunked_body);
+  RUN_TEST(test_httpclient_error_status);
+  RUN_TEST(test_httpclient_connection_refused);
+  return UNITY_END();
+}
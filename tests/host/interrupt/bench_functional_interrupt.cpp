@@ -0,0 +1,162 @@
+/*
+ * FunctionalInterrupt costs: attaching a capturing lambda (with the heap
+ * calls per attach) and dispatching it the way the GPIO ISR does, against
+ * the previous InterruptArgStructure holding a std::function allocated on
+ * each attach and called through interruptFunctional().
+ */
+
+#include <bench.h>
+#include <new>
+#include <stdlib.h>
+#include "FunctionalInterrupt.h"
+
+// every operator new, the std::function copies included
+static uint64_t s_allocations;
+
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+
+void *operator new(size_t size) {
+  s_allocations++;
+  void *p = malloc(size);
+  if (p == nullptr) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void operator delete(void *p) noexcept {
+  free(p);
+}
+
+void operator delete(void *p, size_t size) noexcept {
+  free(p);
+}
+
+typedef void (*voidFuncPtr)(void);
+typedef void (*voidFuncPtrArg)(void *);
+
+// __pinInterruptHandlers and __onPinInterrupt() of esp32-hal-gpio.c
+struct InterruptHandle {
+  voidFuncPtr fn;
+  void *arg;
+  bool functional;
+};
+
+static void __attribute__((noinline)) onPinInterrupt(void *arg) {
+  InterruptHandle *isr = (InterruptHandle *)arg;
+  if (isr->fn) {
+    if (isr->arg) {
+      ((voidFuncPtrArg)isr->fn)(isr->arg);
+    } else {
+      isr->fn();
+    }
+  }
+}
+
+// The previous FunctionalInterrupt.cpp
+struct InterruptArgStructure {
+  std::function<void(void)> interruptFunction;
+};
+
+static void interruptFunctional(void *arg) {
+  InterruptArgStructure *localArg = (InterruptArgStructure *)arg;
+  if (localArg->interruptFunction) {
+    localArg->interruptFunction();
+  }
+}
+
+static void legacyAttach(InterruptHandle &handle, std::function<void(void)> intRoutine) {
+  if (handle.functional && handle.arg) {
+    delete (InterruptArgStructure *)handle.arg;
+  }
+  handle.fn = (voidFuncPtr)interruptFunctional;
+  handle.arg = new InterruptArgStructure{intRoutine};
+  handle.functional = true;
+}
+
+static void inlineAttach(InterruptHandle &handle, InterruptFunction &slot, uint32_t *counter, uint32_t step) {
+  slot.assign([counter, step]() {
+    *counter += step;
+  });
+  handle.fn = (voidFuncPtr)slot.invoker();
+  handle.arg = &slot;
+  handle.functional = true;
+}
+
+static void BM_LegacyAttach(BenchState &state) {
+  InterruptHandle handle = {nullptr, nullptr, false};
+  uint32_t counter = 0;
+  uint64_t before = s_allocations;
+  for (auto _ : state) {
+    uint32_t step = 1;
+    legacyAttach(handle, [&counter, step]() {
+      counter += step;
+    });
+    benchDoNotOptimize(handle.arg);
+  }
+  state.setCounter("allocs/attach", (double)(s_allocations - before) / state.iterations());
+  delete (InterruptArgStructure *)handle.arg;
+}
+BENCHMARK(BM_LegacyAttach);
+
+static void BM_InlineAttach(BenchState &state) {
+  InterruptHandle handle = {nullptr, nullptr, false};
+  InterruptFunction slot;
+  uint32_t counter = 0;
+  uint64_t before = s_allocations;
+  for (auto _ : state) {
+    inlineAttach(handle, slot, &counter, 1);
+    benchDoNotOptimize(handle.arg);
+  }
+  state.setCounter("allocs/attach", (double)(s_allocations - before) / state.iterations());
+}
+BENCHMARK(BM_InlineAttach);
+
+static void BM_LegacyDispatch(BenchState &state) {
+  InterruptHandle handle = {nullptr, nullptr, false};
+  uint32_t counter = 0;
+  uint32_t step = 1;
+  legacyAttach(handle, [&counter, step]() {
+    counter += step;
+  });
+  for (auto _ : state) {
+    onPinInterrupt(&handle);
+  }
+  benchDoNotOptimize(counter);
+  state.setItemsProcessed(state.iterations());
+  delete (InterruptArgStructure *)handle.arg;
+}
+BENCHMARK(BM_LegacyDispatch);
+
+static void BM_InlineDispatch(BenchState &state) {
+  InterruptHandle handle = {nullptr, nullptr, false};
+  InterruptFunction slot;
+  uint32_t counter = 0;
+  inlineAttach(handle, slot, &counter, 1);
+  for (auto _ : state) {
+    onPinInterrupt(&handle);
+  }
+  benchDoNotOptimize(counter);
+  state.setItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_InlineDispatch);
+
+int main(int argc, char **argv) {
+  InterruptHandle legacy = {nullptr, nullptr, false}, inline_ = {nullptr, nullptr, false};
+  InterruptFunction slot;
+  uint32_t a = 0, b = 0;
+  legacyAttach(legacy, [&a]() {
+    a += 3;
+  });
+  inlineAttach(inline_, slot, &b, 3);
+  for (int i = 0; i < 10; i++) {
+    onPinInterrupt(&legacy);
+    onPinInterrupt(&inline_);
+  }
+  delete (InterruptArgStructure *)legacy.arg;
+  if (a != b || a != 30) {
+    fprintf(stderr, "dispatch results differ: %u and %u\n", a, b);
+    return 1;
+  }
+  return benchMain(argc, argv);
+}
@@ -0,0 +1,130 @@
+/*
+ * Host tests for InterruptFunction, the inline callable FunctionalInterrupt
+ * keeps per pin: lambdas with captures, std::function and std::bind objects,
+ * calls through invoker() the way the GPIO ISR makes them, and destruction
+ * on reset and reassignment.
+ */
+
+#include <unity.h>
+#include <functional>
+#include "FunctionalInterrupt.h"
+
+static int counter;
+
+struct Tracked {
+  static int alive;
+  int *target;
+  explicit Tracked(int *t) : target(t) {
+    alive++;
+  }
+  Tracked(const Tracked &other) : target(other.target) {
+    alive++;
+  }
+  ~Tracked() {
+    alive--;
+  }
+  void operator()() {
+    (*target)++;
+  }
+};
+int Tracked::alive = 0;
+
+class Button {
+public:
+  int presses = 0;
+  void onPress() {
+    presses++;
+  }
+};
+
+// The GPIO ISR: the registered function with the InterruptFunction as argument
+static void isr(InterruptFunction &slot) {
+  slot.invoker()(&slot);
+}
+
+void setUp(void) {
+  counter = 0;
+}
+
+void tearDown(void) {}
+
+void test_interrupt_function_lambda(void) {
+  InterruptFunction f;
+  TEST_ASSERT_FALSE(f);
+  int step = 3;
+  f.assign([step]() {
+    counter += step;
+  });
+  TEST_ASSERT_TRUE(f);
+  isr(f);
+  f();
+  TEST_ASSERT_EQUAL(6, counter);
+  // as large as the storage allows
+  uint32_t a = 1, b = 2, c = 3;
+  int *target = &counter;
+  f.assign([a, b, c, target]() {
+    *target += a + b + c;
+  });
+  isr(f);
+  TEST_ASSERT_EQUAL(12, counter);
+  f.reset();
+  TEST_ASSERT_FALSE(f);
+}
+
+void test_interrupt_function_std_function(void) {
+  InterruptFunction f;
+  std::function<void(void)> fn = []() {
+    counter++;
+  };
+  f.assign(fn);
+  isr(f);
+  TEST_ASSERT_EQUAL(1, counter);
+  // a member function bound to its object
+  Button button;
+  f.assign(std::bind(&Button::onPress, &button));
+  isr(f);
+  isr(f);
+  TEST_ASSERT_EQUAL(2, button.presses);
+}
+
+void test_interrupt_function_destroy(void) {
+  int hits = 0;
+  {
+    InterruptFunction f;
+    f.assign(Tracked(&hits));
+    TEST_ASSERT_EQUAL(1, Tracked::alive);
+    isr(f);
+    // reassigning destroys the previous callable
+    f.assign(Tracked(&hits));
+    TEST_ASSERT_EQUAL(1, Tracked::alive);
+    isr(f);
+    f.reset();
+    TEST_ASSERT_EQUAL(0, Tracked::alive);
+    f.assign(Tracked(&hits));
+  }
+  // and so does the destructor
+  TEST_ASSERT_EQUAL(0, Tracked::alive);
+  TEST_ASSERT_EQUAL(2, hits);
+}
+
+void test_interrupt_function_self_is_storage(void) {
+  // the ISR argument is the InterruptFunction itself, no wrapper around it
+  InterruptFunction f;
+  f.assign([]() {
+    counter++;
+  });
+  InterruptFunction::invoke_t fn = f.invoker();
+  void *arg = &f;
+  fn(arg);
+  TEST_ASSERT_EQUAL(1, counter);
+  TEST_ASSERT_LESS_OR_EQUAL(FUNCTIONAL_INTERRUPT_STORAGE + 2 * sizeof(void *), sizeof(InterruptFunction));
+}
+
+int main(void) {
+  UNITY_BEGIN();
+  RUN_TEST(test_interrupt_function_lambda);
+  RUN_TEST(test_interrupt_function_std_function);
+  RUN_TEST(test_interrupt_function_destroy);
+  RUN_TEST(test_interrupt_function_self_is_storage);
+  return UNITY_END();
+}
@@ -0,0 +1,72 @@
+/*
+ * Host tests for IPAddress parsing, printing and the lwIP conversions.
+ */
+
+#include <unity.h>
+#include "IPAddress.h"
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_ipaddress_v4(void) {
+  IPAddress ip;
+  TEST_ASSERT_TRUE(ip.fromString("192.168.4.1"));
+  TEST_ASSERT_EQUAL(IPv4, ip.type());
+  TEST_ASSERT_TRUE(ip == IPAddress(192, 168, 4, 1));
+  TEST_ASSERT_EQUAL(192, ip[0]);
+  TEST_ASSERT_EQUAL(1, ip[3]);
+  TEST_ASSERT_EQUAL_STRING("192.168.4.1", ip.toString().c_str());
+  TEST_ASSERT_EQUAL_HEX32(0x0104A8C0, (uint32_t)ip);
+}
+
+void test_ipaddress_v4_invalid(void) {
+  IPAddress ip;
+  TEST_ASSERT_FALSE(ip.fromString("256.1.1.1"));
+  TEST_ASSERT_FALSE(ip.fromString("1.2.3"));
+  TEST_ASSERT_FALSE(ip.fromString("1.2.3.4.5"));
+  TEST_ASSERT_FALSE(ip.fromString("a.b.c.d"));
+}
+
+void test_ipaddress_v6(void) {
+  IPAddress ip;
+  TEST_ASSERT_TRUE(ip.fromString("2001:db8::ff00:42:8329"));
+  TEST_ASSERT_EQUAL(IPv6, ip.type());
+  TEST_ASSERT_EQUAL(0x20, ip[0]);
+  TEST_ASSERT_EQUAL(0x29, ip[15]);
+  TEST_ASSERT_EQUAL_STRING("2001:db8::ff00:42:8329", ip.toString().c_str());
+  TEST_ASSERT_TRUE(ip.fromString("::1"));
+  TEST_ASSERT_EQUAL_STRING("::1", ip.toString().c_str());
+  TEST_ASSERT_FALSE(ip.fromString("1::2::3"));
+}
+
+void test_ipaddress_v6_zone(void) {
+  IPAddress ip;
+  TEST_ASSERT_TRUE(ip.fromString("fe80::1%2"));
+  TEST_ASSERT_EQUAL(IPv6, ip.type());
+  TEST_ASSERT_EQUAL(ESP_IP6_ADDR_IS_LINK_LOCAL, ip.addr_type());
+}
+
+void test_ipaddress_lwip_round_trip(void) {
+  IPAddress v4(10, 0, 0, 7);
+  ip_addr_t addr;
+  v4.to_ip_addr_t(&addr);
+  TEST_ASSERT_EQUAL(IPADDR_TYPE_V4, addr.type);
+  TEST_ASSERT_TRUE(IPAddress(&addr) == v4);
+
+  IPAddress v6("2001:db8::1");
+  v6.to_ip_addr_t(&addr);
+  TEST_ASSERT_EQUAL(IPADDR_TYPE_V6, addr.type);
+  TEST_ASSERT_TRUE(IPAddress(&addr) == v6);
+  TEST_ASSERT_TRUE(IPAddress(&addr) != v4);
+}
+
+int main(void) {
+  UNITY_BEGIN();
+  RUN_TEST(test_ipaddress_v4);
+  RUN_TEST(test_ipaddress_v4_invalid);
+  RUN_TEST(test_ipaddress_v6);
+  RUN_TEST(test_ipaddress_v6_zone);
+  RUN_TEST(test_ipaddress_lwip_round_trip);
+  return UNITY_END();
+}
@@ -0,0 +1,50 @@
+/*
+ * Cost of a log call on the caller's side: formatting the text, as the
+ * synchronous and async text paths do, against encoding a binary record.
+ * bytes/op is what has to be stored or sent per call.
+ */
+
+#include <bench.h>
+#include "esp32-hal-format.h"
+#include "esp32-hal-log.h"
+
+static size_t output_bytes;
+
+static void count_output(void *arg, const char *data, size_t len) {
+  output_bytes += len;
+}
+
+static int text_log_printf(const char *format, ...) {
+  char buf[128];
+  va_list arg;
+  va_start(arg, format);
+  int len = format_vprintf(buf, sizeof(buf), count_output, NULL, format, arg);
+  va_end(arg);
+  return len;
+}
+
+#define SHORT_FORMAT  "%s=%d\r\n", "rssi", -67
+#define LOG_FORMAT    "[%6u][E][%s:%u] %s(): %s\r\n", 123456u, "NetworkClient.cpp", 412u, "write", "fail on fd 54, errno: 11, \"No more processes\""
+#define FLOAT_FORMAT  "[%6u][I][%s:%u] %s(): t=%.2f h=%.1f p=%.3f\r\n", 123456u, "sensor.cpp", 88u, "poll", 21.37, 48.5, 1013.250
+
+#define LOG_BENCH(name, mode, call)                                                \
+  static void name(BenchState &state) {                                            \
+    log_binary_set_output(count_output, NULL);                                     \
+    log_binary_set_mode(mode);                                                     \
+    output_bytes = 0;                                                              \
+    for (auto _ : state) {                                                         \
+      call;                                                                        \
+    }                                                                              \
+    state.setCounter("bytes/op", (double)output_bytes / state.iterations());       \
+    log_binary_set_mode(LOG_BINARY_OFF);                                           \
+  }                                                                                \
+  BENCHMARK(name)
+
+LOG_BENCH(BM_TextShort, LOG_BINARY_OFF, text_log_printf(SHORT_FORMAT));
+LOG_BENCH(BM_BinaryShort, LOG_BINARY_RAW, log_binary_write(ARDUHAL_LOG_LEVEL_INFO, SHORT_FORMAT));
+LOG_BENCH(BM_TextLog, LOG_BINARY_OFF, text_log_printf(LOG_FORMAT));
+LOG_BENCH(BM_BinaryLog, LOG_BINARY_RAW, log_binary_write(ARDUHAL_LOG_LEVEL_ERROR, LOG_FORMAT));
+LOG_BENCH(BM_TextFloat, LOG_BINARY_OFF, text_log_printf(FLOAT_FORMAT));
+LOG_BENCH(BM_BinaryFloat, LOG_BINARY_RAW, log_binary_write(ARDUHAL_LOG_LEVEL_INFO, FLOAT_FORMAT));
+
+BENCHMARK_MAIN();
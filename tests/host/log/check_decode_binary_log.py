@@ -0,0 +1,39 @@
+#!/usr/bin/env python3
+"""
+Round trip of tools/decode_binary_log.py: test_log_binary dumps the binary
+records it wrote and their on-device rendering, the decoder must produce the
+same text from the stream and the test executable. The records are all at
+info level, so with --level warn nothing is left.
+"""
+
+import os
+import subprocess
+import sys
+import tempfile
+
+
+def main():
+    test, decoder = sys.argv[1], sys.argv[2]
+    with tempfile.TemporaryDirectory() as tmp:
+        stream = os.path.join(tmp, "stream.bin")
+        expected = os.path.join(tmp, "expected.txt")
+        subprocess.run([test, "--dump", stream, expected], check=True, stdout=subprocess.DEVNULL)
+        decoded = subprocess.run([sys.executable, decoder, test, stream], check=True, stdout=subprocess.PIPE).stdout
+        filtered = subprocess.run([sys.executable, decoder, "--level", "warn", test, stream], check=True, stdout=subprocess.PIPE).stdout
+        with open(expected, "rb") as f:
+            wanted = f.read()
+    if decoded != wanted:
+        for a, b in zip(decoded.splitlines(), wanted.splitlines()):
+            if a != b:
+                print(f"decoded:  {a!r}\nexpected: {b!r}")
+        print("FAIL")
+        return 1
+    if filtered:
+        print(f"--level warn kept: {filtered[:80]!r}\nFAIL")
+        return 1
+    print(f"{len(wanted.splitlines())} lines decoded\nOK")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,226 @@
+/*
+ * Host test for the deferred log ring: several producers (one of them flagged
+ * as an ISR) race through log_async_write() while the drain task writes out,
+ * every record must arrive intact and in per-producer order, and overflow must
+ * be counted instead of blocking. Formatted records longer than a format chunk
+ * must not be interleaved with the records of other producers, and give back
+ * the part of their slot they did not use.
+ */
+
+#include <stdarg.h>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unity.h>
+#include "esp32-hal-log.h"
+#include "freertos/task.h"
+
+static std::mutex s_out_lock;
+static std::string s_out;
+
+static void capture_output(void *arg, const char *data, size_t len) {
+  std::lock_guard<std::mutex> guard(s_out_lock);
+  s_out.append(data, len);
+}
+
+void setUp(void) {
+  s_out.clear();
+}
+
+void tearDown(void) {
+  log_async_end();
+}
+
+void test_log_async_disabled_by_default(void) {
+  TEST_ASSERT_FALSE(log_async_enabled());
+  TEST_ASSERT_FALSE(log_async_write("x", 1));
+}
+
+void test_log_async_write_and_flush(void) {
+  TEST_ASSERT_TRUE(log_async_begin(1024));
+  log_async_set_output(capture_output, NULL);
+  TEST_ASSERT_TRUE(log_async_enabled());
+  TEST_ASSERT_TRUE(log_async_write("hello ", 6));
+  TEST_ASSERT_TRUE(log_async_write("world\n", 6));
+  log_async_flush();
+  TEST_ASSERT_EQUAL_STRING("hello world\n", s_out.c_str());
+
+  log_async_stats_t stats;
+  log_async_get_stats(&stats);
+  TEST_ASSERT_EQUAL(1024, stats.buffer_size);
+  TEST_ASSERT_EQUAL(0, stats.pending_bytes);
+  TEST_ASSERT_EQUAL(12, stats.queued_bytes);
+  TEST_ASSERT_EQUAL(12, stats.written_bytes);
+  TEST_ASSERT_EQUAL(0, stats.dropped_records);
+}
+
+void test_log_async_overflow_is_counted(void) {
+  TEST_ASSERT_TRUE(log_async_begin(256));
+  // keep the drain busy so that the ring fills up
+  log_async_set_output(
+    [](void *arg, const char *data, size_t len) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      capture_output(arg, data, len);
+    },
+    NULL
+  );
+  char record[60];
+  memset(record, 'a', sizeof(record));
+  for (int i = 0; i < 20; i++) {
+    TEST_ASSERT_TRUE(log_async_write(record, sizeof(record)));
+  }
+  log_async_flush();
+  log_async_stats_t stats;
+  log_async_get_stats(&stats);
+  TEST_ASSERT_GREATER_THAN(0, stats.dropped_records);
+  TEST_ASSERT_EQUAL(20 * sizeof(record), stats.queued_bytes + stats.dropped_bytes);
+  TEST_ASSERT_EQUAL(stats.queued_bytes, stats.written_bytes);
+  TEST_ASSERT_EQUAL(stats.written_bytes, s_out.size());
+  TEST_ASSERT_LESS_OR_EQUAL(256, stats.high_water);
+}
+
+void test_log_async_oversized_record_is_dropped(void) {
+  TEST_ASSERT_TRUE(log_async_begin(256));
+  log_async_set_output(capture_output, NULL);
+  char record[200];
+  memset(record, 'b', sizeof(record));
+  TEST_ASSERT_TRUE(log_async_write(record, sizeof(record)));
+  log_async_flush();
+  log_async_stats_t stats;
+  log_async_get_stats(&stats);
+  TEST_ASSERT_EQUAL(1, stats.dropped_records);
+  TEST_ASSERT_EQUAL(0, s_out.size());
+}
+
+void test_log_async_many_producers(void) {
+  const int producers = 4;
+  const int records = 5000;
+  TEST_ASSERT_TRUE(log_async_begin(4096));
+  log_async_set_output(capture_output, NULL);
+
+  std::vector<std::thread> threads;
+  for (int p = 0; p < producers; p++) {
+    threads.emplace_back([p, records]() {
+      hostSetIsrContext(p == 0);
+      char line[48];
+      for (int i = 0; i < records; i++) {
+        int len = snprintf(line, sizeof(line), "<%d:%d:%s>", p, i, (i % 3) ? "abcdefghijklmnop" : "x");
+        log_async_write(line, len);
+        if ((i & 63) == 0) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  for (std::thread &t : threads) {
+    t.join();
+  }
+  log_async_end();
+
+  // every record must be complete and in order per producer
+  std::vector<int> next(producers, 0);
+  size_t pos = 0;
+  int complete = 0;
+  bool ordered = true;
+  while ((pos = s_out.find('<', pos)) != std::string::npos) {
+    size_t end = s_out.find('>', pos);
+    TEST_ASSERT_TRUE(end != std::string::npos);
+    int p = -1, i = -1;
+    char tail[32];
+    TEST_ASSERT_EQUAL(3, sscanf(s_out.c_str() + pos, "<%d:%d:%31[^>]>", &p, &i, tail));
+    TEST_ASSERT_TRUE(p >= 0 && p < producers);
+    TEST_ASSERT_EQUAL_STRING((i % 3) ? "abcdefghijklmnop" : "x", tail);
+    ordered &= i >= next[p];
+    next[p] = i + 1;
+    complete++;
+    pos = end;
+  }
+  TEST_ASSERT_TRUE(ordered);
+  log_async_stats_t stats;
+  log_async_get_stats(&stats);
+  TEST_ASSERT_EQUAL(stats.written_bytes, s_out.size());
+  TEST_ASSERT_EQUAL(complete, producers * records - (int)stats.dropped_records);
+}
+
+static int queue_printf(const char *format, ...) {
+  va_list arg;
+  va_start(arg, format);
+  int len = log_async_vprintf(format, arg);
+  va_end(arg);
+  return len;
+}
+
+void test_log_async_long_records_are_whole(void) {
+  const int producers = 3;
+  const int records = 1000;
+  TEST_ASSERT_EQUAL(-1, queue_printf("%d", 1));
+  TEST_ASSERT_TRUE(log_async_begin(8192));
+  log_async_set_output(capture_output, NULL);
+  std::string body(300, 'y');
+
+  std::vector<std::thread> threads;
+  for (int p = 0; p < producers; p++) {
+    threads.emplace_back([p, records, &body]() {
+      for (int i = 0; i < records; i++) {
+        int len = queue_printf("<%d:%d:%s>", p, i, body.c_str());
+        TEST_ASSERT_EQUAL(snprintf(NULL, 0, "<%d:%d:%s>", p, i, body.c_str()), len);
+      }
+    });
+  }
+  for (std::thread &t : threads) {
+    t.join();
+  }
+  log_async_end();
+
+  // the output is made of complete records only
+  size_t pos = 0;
+  int complete = 0;
+  while (pos < s_out.size()) {
+    TEST_ASSERT_EQUAL('<', s_out[pos]);
+    size_t end = s_out.find('>', pos);
+    TEST_ASSERT_TRUE(end != std::string::npos);
+    int p = -1, i = -1, tail = 0;
+    TEST_ASSERT_EQUAL(2, sscanf(s_out.c_str() + pos, "<%d:%d:%n", &p, &i, &tail));
+    TEST_ASSERT_TRUE(p >= 0 && p < producers);
+    TEST_ASSERT_TRUE(s_out.compare(pos + tail, end - pos - tail, body) == 0);
+    complete++;
+    pos = end + 1;
+  }
+  log_async_stats_t stats;
+  log_async_get_stats(&stats);
+  TEST_ASSERT_EQUAL(complete, producers * records - (int)stats.dropped_records);
+}
+
+void test_log_async_long_record_space(void) {
+  TEST_ASSERT_TRUE(log_async_begin(512));
+  log_async_set_output(capture_output, NULL);
+  std::string body(200, 'z');
+  // formatted into a slot as large as a record may be, then shrunk to fit
+  TEST_ASSERT_EQUAL(202, queue_printf("<%s>", body.c_str()));
+  log_async_stats_t stats;
+  log_async_get_stats(&stats);
+  TEST_ASSERT_EQUAL(4 + 204, stats.high_water);
+  TEST_ASSERT_EQUAL(202, stats.queued_bytes);
+  // longer than the ring takes: dropped whole and counted with its full length
+  body.assign(400, 'z');
+  TEST_ASSERT_EQUAL(402, queue_printf("<%s>", body.c_str()));
+  log_async_flush();
+  log_async_get_stats(&stats);
+  TEST_ASSERT_EQUAL(0, stats.pending_bytes);
+  TEST_ASSERT_EQUAL(1, stats.dropped_records);
+  TEST_ASSERT_EQUAL(402, stats.dropped_bytes);
+  TEST_ASSERT_EQUAL(202, s_out.size());
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_log_async_disabled_by_default);
+  RUN_TEST(test_log_async_write_and_flush);
+  RUN_TEST(test_log_async_overflow_is_counted);
+  RUN_TEST(test_log_async_oversized_record_is_dropped);
+  RUN_TEST(test_log_async_many_producers);
+  RUN_TEST(test_log_async_long_records_are_whole);
+  RUN_TEST(test_log_async_long_record_space);
+  return UNITY_END();
+}
@@ -0,0 +1,212 @@
+/*
+ * Host test for binary log records: every record is rendered back to text and
+ * compared with the C library printf(). With `--dump <stream> <text>` the raw
+ * stream and its rendering are also written out, for check_decode_binary_log.py
+ * to compare against tools/decode_binary_log.py.
+ */
+
+#include <stdio.h>
+#include <string>
+#include <unity.h>
+#include "esp32-hal-log.h"
+
+static std::string s_capture;  // raw output of the current test
+static std::string s_stream;   // everything written in RAW mode
+static std::string s_rendered;
+
+static void capture_output(void *arg, const char *data, size_t len) {
+  static_cast<std::string *>(arg)->append(data, len);
+}
+
+// splits the next record off a captured stream
+static bool next_record(const std::string &stream, size_t &pos, std::string &record) {
+  if (pos + 4 > stream.size() || (uint8_t)stream[pos] != 0xB5) {
+    return false;
+  }
+  size_t len = 4 + ((uint8_t)stream[pos + 2] | ((uint8_t)stream[pos + 3] << 8));
+  record = stream.substr(pos, len);
+  pos += len;
+  return record.size() == len;
+}
+
+static std::string render(const std::string &record) {
+  std::string text;
+  TEST_ASSERT_GREATER_OR_EQUAL(0, log_binary_render(record.data(), record.size(), capture_output, &text));
+  return text;
+}
+
+static std::string __attribute__((format(printf, 1, 2))) libc_printf(const char *format, ...) {
+  char buf[512];
+  va_list arg;
+  va_start(arg, format);
+  vsnprintf(buf, sizeof(buf), format, arg);
+  va_end(arg);
+  return buf;
+}
+
+// logs one record in RAW mode and checks that it renders like printf()
+#define CHECK_BINARY(format, ...)                                                     \
+  do {                                                                                \
+    s_capture.clear();                                                                \
+    TEST_ASSERT_TRUE(log_binary_write(ARDUHAL_LOG_LEVEL_INFO, format, ##__VA_ARGS__)); \
+    size_t pos = 0;                                                                   \
+    std::string record;                                                               \
+    TEST_ASSERT_TRUE(next_record(s_capture, pos, record));                            \
+    TEST_ASSERT_EQUAL(s_capture.size(), pos);                                         \
+    std::string text = render(record);                                                \
+    std::string expected = libc_printf(format, ##__VA_ARGS__);                        \
+    TEST_ASSERT_EQUAL_STRING(expected.c_str(), text.c_str());                         \
+    s_stream += record;                                                               \
+    s_rendered += text;                                                               \
+  } while (0)
+
+void setUp(void) {
+  s_capture.clear();
+  log_binary_set_output(capture_output, &s_capture);
+  log_binary_set_mode(LOG_BINARY_RAW);
+}
+
+void tearDown(void) {
+  log_binary_set_mode(LOG_BINARY_OFF);
+  log_binary_set_output(NULL, NULL);
+}
+
+void test_log_binary_off_by_default(void) {
+  log_binary_set_mode(LOG_BINARY_OFF);
+  TEST_ASSERT_EQUAL(LOG_BINARY_OFF, log_binary_get_mode());
+  TEST_ASSERT_FALSE(log_binary_write(ARDUHAL_LOG_LEVEL_ERROR, "%d", 1));
+}
+
+void test_log_binary_stream_header(void) {
+  size_t pos = 0;
+  std::string header;
+  TEST_ASSERT_TRUE(next_record(s_capture, pos, header));
+  TEST_ASSERT_EQUAL(0x10, (uint8_t)header[1]);
+  TEST_ASSERT_EQUAL(1, header[4]);
+  TEST_ASSERT_EQUAL(sizeof(void *), header[5]);
+  s_stream += header;
+}
+
+void test_log_binary_record_layout(void) {
+  s_capture.clear();
+  TEST_ASSERT_TRUE(log_binary_write(ARDUHAL_LOG_LEVEL_WARN, "plain %d\n", 42));
+  size_t pos = 0;
+  std::string record;
+  TEST_ASSERT_TRUE(next_record(s_capture, pos, record));
+  TEST_ASSERT_EQUAL(ARDUHAL_LOG_LEVEL_WARN, record[1] & 0x0F);
+  // prefix, timestamp, format address and one int
+  TEST_ASSERT_EQUAL(4 + 4 + sizeof(void *) + 4, record.size());
+  TEST_ASSERT_EQUAL_STRING("plain 42\n", render(record).c_str());
+}
+
+void test_log_binary_integers(void) {
+  CHECK_BINARY("%d %i %u %d\n", 0, -42, 3000000000U, -2147483647 - 1);
+  CHECK_BINARY("%hhd %hhu %hd %hu\n", -5, 250, -1234, 65000);
+  CHECK_BINARY("%ld %lu %lld %llu\n", -123456789L, 123456789UL, -1234567890123LL, 18446744073709551615ULL);
+  CHECK_BINARY("%zu %zd %td %jd\n", (size_t)12345, (ssize_t)-6, (ptrdiff_t)-7, (intmax_t)-8);
+  CHECK_BINARY("%x %X %#x %o %#o\n", 0xdeadbeefU, 0xabcU, 0x1fU, 8U, 8U);
+  CHECK_BINARY("[%5d|%-5d|%05d|%+d|% d|%.3d]\n", 42, 42, 42, 42, 42, 7);
+  CHECK_BINARY("[%*d|%-*d|%.*d]\n", 6, 1, 4, 2, 3, 5);
+  CHECK_BINARY("%c%c%3c|%-3c|\n", 'o', 'k', 'x', 'y');
+  CHECK_BINARY("100%% %p\n", (void *)0x1234);
+}
+
+void test_log_binary_floats(void) {
+  CHECK_BINARY("%f %e %g %G\n", 3.14159, -0.000123, 1e20, 1e-20);
+  CHECK_BINARY("[%.2f|%10.3f|%-10.1f|%+.0f|%E]\n", 2.5, -1.0 / 3, 9.95, 0.5, 6.02e23);
+  CHECK_BINARY("[%*.*f]\n", 12, 4, 1234.56789);
+}
+
+void test_log_binary_strings(void) {
+  static const char literal[] = "in flash";
+  char stack[] = "on the stack";
+  const char *volatile none = NULL;  // hidden from -Wformat-overflow
+  CHECK_BINARY("%s|%s|%s\n", literal, stack, none);
+  CHECK_BINARY("[%.3s|%.5s|%10s|%-10s]\n", literal, stack, "right", "left");
+  CHECK_BINARY("[%.*s]\n", 4, stack);
+  // the layout of ARDUHAL_LOG_FORMAT()
+  CHECK_BINARY("[%6u][I][%s:%u] %s(): %s\r\n", 1234U, pathToFileName(__FILE__), __LINE__, __FUNCTION__, stack);
+}
+
+void test_log_binary_strings_by_reference(void) {
+  static const char literal[] = "a string that is not copied into the record";
+  s_capture.clear();
+  TEST_ASSERT_TRUE(log_binary_write(ARDUHAL_LOG_LEVEL_INFO, "%s", literal));
+  // prefix, timestamp, format address, kind and string address
+  TEST_ASSERT_EQUAL(4 + 4 + sizeof(void *) + 1 + sizeof(void *), s_capture.size());
+}
+
+void test_log_binary_truncated_record(void) {
+  char first[150];
+  char second[150];
+  memset(first, 'a', sizeof(first) - 1);
+  first[sizeof(first) - 1] = '\0';
+  memset(second, 'b', sizeof(second) - 1);
+  second[sizeof(second) - 1] = '\0';
+  s_capture.clear();
+  TEST_ASSERT_TRUE(log_binary_write(ARDUHAL_LOG_LEVEL_INFO, "<%s><%s><%d>\r\n", first, second, 5));
+  size_t pos = 0;
+  std::string record;
+  TEST_ASSERT_TRUE(next_record(s_capture, pos, record));
+  TEST_ASSERT_TRUE((uint8_t)record[1] & 0x80);
+  std::string text = render(record);
+  // the first string is cut to fit the record, the second one does not fit at all
+  std::string expected = "<" + std::string(text.size() - 8, 'a') + "><...\r\n";
+  TEST_ASSERT_EQUAL_STRING(expected.c_str(), text.c_str());
+  s_stream += record;
+  s_rendered += text;
+}
+
+void test_log_binary_runtime_format_is_text(void) {
+  char format[] = "built at %s\n";
+  s_capture.clear();
+  TEST_ASSERT_FALSE(log_binary_write(ARDUHAL_LOG_LEVEL_INFO, format, "runtime"));
+  TEST_ASSERT_EQUAL(0, s_capture.size());
+}
+
+void test_log_binary_deferred(void) {
+  std::string text;
+  log_binary_set_mode(LOG_BINARY_DEFERRED);
+  // without the async ring the call is printed as text
+  TEST_ASSERT_FALSE(log_binary_write(ARDUHAL_LOG_LEVEL_INFO, "%d", 1));
+
+  TEST_ASSERT_TRUE(log_async_begin(1024));
+  log_async_set_output(capture_output, &text);
+  for (int i = 0; i < 20; i++) {
+    TEST_ASSERT_TRUE(log_binary_write(ARDUHAL_LOG_LEVEL_DEBUG, "[%s] %d %.1f\n", __FUNCTION__, i, i / 2.0));
+  }
+  log_async_flush();
+  std::string expected;
+  for (int i = 0; i < 20; i++) {
+    expected += libc_printf("[%s] %d %.1f\n", __FUNCTION__, i, i / 2.0);
+  }
+  TEST_ASSERT_EQUAL_STRING(expected.c_str(), text.c_str());
+  log_async_end();
+  log_async_set_output(NULL, NULL);
+}
+
+static void dump(const char *path, const std::string &data) {
+  FILE *f = fopen(path, "wb");
+  TEST_ASSERT_TRUE(f != NULL);
+  fwrite(data.data(), 1, data.size(), f);
+  fclose(f);
+}
+
+int main(int argc, char **argv) {
+  UNITY_BEGIN();
+  RUN_TEST(test_log_binary_off_by_default);
+  RUN_TEST(test_log_binary_stream_header);
+  RUN_TEST(test_log_binary_record_layout);
+  RUN_TEST(test_log_binary_integers);
+  RUN_TEST(test_log_binary_floats);
+  RUN_TEST(test_log_binary_strings);
+  RUN_TEST(test_log_binary_strings_by_reference);
+  RUN_TEST(test_log_binary_truncated_record);
+  RUN_TEST(test_log_binary_runtime_format_is_text);
+  RUN_TEST(test_log_binary_deferred);
+  if (argc == 4 && strcmp(argv[1], "--dump") == 0) {
+    dump(argv[2], s_stream);
+    dump(argv[3], s_rendered);
+  }
+  return UNITY_END();
+}
@@ -0,0 +1,118 @@
+/*
+ * Peripheral manager pin queries on the 55 GPIOs of the ESP32-P4: finding
+ * the pins of one bus type the way the LEDC timer lookups did (every pin
+ * checked with perimanPinIsValid() and perimanGetPinBusType()) against
+ * iterating the type mask, and collecting the attached pins for
+ * printPerimanInfo() with the per pin getters against the snapshot.
+ */
+
+#include <bench.h>
+#include "esp32-hal-periman.h"
+
+static int buses[SOC_GPIO_PIN_COUNT];
+
+static bool detach(void *bus) {
+  return true;
+}
+
+// 4 pins of the type looked for, among 16 attached pins
+static void attach_pins(void) {
+  perimanSetBusDeinit(ESP32_BUS_TYPE_UART_TX, detach);
+  perimanSetBusDeinit(ESP32_BUS_TYPE_GPIO, detach);
+  for (uint8_t pin = 0; pin < SOC_GPIO_PIN_COUNT; pin += 3) {
+    bool tx = pin % 4 == 0 && pin < 40;
+    perimanSetPinBus(pin, tx ? ESP32_BUS_TYPE_UART_TX : ESP32_BUS_TYPE_GPIO, &buses[pin], -1, -1);
+  }
+}
+
+static uintptr_t scan_pins(void) {
+  uintptr_t sum = 0;
+  for (uint8_t i = 0; i < SOC_GPIO_PIN_COUNT; i++) {
+    if (!perimanPinIsValid(i)) {
+      continue;
+    }
+    if (perimanGetPinBusType(i) == ESP32_BUS_TYPE_UART_TX) {
+      sum += (uintptr_t)perimanGetPinBus(i, ESP32_BUS_TYPE_UART_TX);
+    }
+  }
+  return sum;
+}
+
+static uintptr_t mask_pins(void) {
+  uintptr_t sum = 0;
+  uint64_t mask = perimanGetTypePins(ESP32_BUS_TYPE_UART_TX);
+  int8_t i;
+  while ((i = perimanNextPin(&mask)) >= 0) {
+    sum += (uintptr_t)perimanGetPinBus(i, ESP32_BUS_TYPE_UART_TX);
+  }
+  return sum;
+}
+
+static void BM_TypeScan(BenchState &state) {
+  for (auto _ : state) {
+    benchDoNotOptimize(scan_pins());
+  }
+  state.setItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TypeScan);
+
+static void BM_TypeMask(BenchState &state) {
+  for (auto _ : state) {
+    benchDoNotOptimize(mask_pins());
+  }
+  state.setItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TypeMask);
+
+static size_t collect_getters(periman_pin_info_t *info) {
+  size_t count = 0;
+  for (uint8_t i = 0; i < SOC_GPIO_PIN_COUNT; i++) {
+    if (!perimanPinIsValid(i)) {
+      continue;
+    }
+    peripheral_bus_type_t type = perimanGetPinBusType(i);
+    if (type == ESP32_BUS_TYPE_INIT) {
+      continue;
+    }
+    info[count].pin = i;
+    info[count].type = type;
+    info[count].bus_num = perimanGetPinBusNum(i);
+    info[count].bus_channel = perimanGetPinBusChannel(i);
+    info[count].extra_type = perimanGetPinBusExtraType(i);
+    count++;
+  }
+  return count;
+}
+
+static void BM_InfoGetters(BenchState &state) {
+  periman_pin_info_t info[SOC_GPIO_PIN_COUNT];
+  for (auto _ : state) {
+    benchDoNotOptimize(collect_getters(info));
+  }
+  state.setItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_InfoGetters);
+
+static void BM_InfoSnapshot(BenchState &state) {
+  periman_pin_info_t info[SOC_GPIO_PIN_COUNT];
+  for (auto _ : state) {
+    benchDoNotOptimize(perimanGetPinsInfo(info, SOC_GPIO_PIN_COUNT));
+  }
+  state.setItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_InfoSnapshot);
+
+int main(int argc, char **argv) {
+  attach_pins();
+  periman_pin_info_t a[SOC_GPIO_PIN_COUNT], b[SOC_GPIO_PIN_COUNT];
+  size_t na = collect_getters(a), nb = perimanGetPinsInfo(b, SOC_GPIO_PIN_COUNT);
+  bool same = na == nb && scan_pins() == mask_pins() && scan_pins() != 0;
+  for (size_t i = 0; same && i < na; i++) {
+    same = a[i].pin == b[i].pin && a[i].type == b[i].type && a[i].bus_num == b[i].bus_num && a[i].bus_channel == b[i].bus_channel;
+  }
+  if (!same) {
+    fprintf(stderr, "pin queries differ\n");
+    return 1;
+  }
+  return benchMain(argc, argv);
+}
@@ -0,0 +1,179 @@
+/*
+ * Host tests for the peripheral manager pin masks: the per type masks
+ * following attach and detach, iterating a mask, bulk detach with one
+ * deinit callback per bus (failing and re-entrant callbacks included) and
+ * the pin info snapshot printPerimanInfo() uses.
+ */
+
+#include <unity.h>
+#include <vector>
+#include "esp32-hal-periman.h"
+
+static int bus_a, bus_b;
+static std::vector<void *> deinits;
+static bool deinit_result;
+
+static bool record_deinit(void *bus) {
+  deinits.push_back(bus);
+  return deinit_result;
+}
+
+// Like the drivers whose deinit detaches the other pins of the bus itself
+static bool clear_all_deinit(void *bus) {
+  deinits.push_back(bus);
+  uint64_t mask = perimanGetTypePins(ESP32_BUS_TYPE_UART_RX);
+  int8_t pin;
+  while ((pin = perimanNextPin(&mask)) >= 0) {
+    perimanSetBusDeinit(ESP32_BUS_TYPE_UART_RX, record_deinit);
+    perimanClearPinBus(pin);
+  }
+  return true;
+}
+
+void setUp(void) {
+  deinits.clear();
+  deinit_result = true;
+  perimanSetBusDeinit(ESP32_BUS_TYPE_GPIO, record_deinit);
+  perimanSetBusDeinit(ESP32_BUS_TYPE_UART_RX, record_deinit);
+  perimanSetBusDeinit(ESP32_BUS_TYPE_UART_TX, record_deinit);
+}
+
+void tearDown(void) {
+  deinit_result = true;
+  perimanSetBusDeinit(ESP32_BUS_TYPE_UART_RX, record_deinit);
+  perimanClearPins(perimanGetUsedPins());
+}
+
+void test_periman_type_masks(void) {
+  TEST_ASSERT_EQUAL_UINT64(0, perimanGetUsedPins());
+  TEST_ASSERT_EQUAL_UINT64(SOC_GPIO_VALID_GPIO_MASK, perimanGetTypePins(ESP32_BUS_TYPE_INIT));
+  TEST_ASSERT_TRUE(perimanSetPinBus(3, ESP32_BUS_TYPE_UART_RX, &bus_a, 0, -1));
+  TEST_ASSERT_TRUE(perimanSetPinBus(54, ESP32_BUS_TYPE_UART_RX, &bus_a, 0, -1));
+  TEST_ASSERT_TRUE(perimanSetPinBus(7, ESP32_BUS_TYPE_UART_TX, &bus_a, 0, -1));
+  TEST_ASSERT_EQUAL_UINT64(PERIMAN_PIN_MASK(3) | PERIMAN_PIN_MASK(54), perimanGetTypePins(ESP32_BUS_TYPE_UART_RX));
+  TEST_ASSERT_EQUAL_UINT64(PERIMAN_PIN_MASK(7), perimanGetTypePins(ESP32_BUS_TYPE_UART_TX));
+  TEST_ASSERT_EQUAL_UINT64(PERIMAN_PIN_MASK(3) | PERIMAN_PIN_MASK(7) | PERIMAN_PIN_MASK(54), perimanGetUsedPins());
+  // moving a pin to another type moves it between the masks
+  TEST_ASSERT_TRUE(perimanSetPinBus(3, ESP32_BUS_TYPE_UART_TX, &bus_b, 1, -1));
+  TEST_ASSERT_EQUAL(1, deinits.size());
+  TEST_ASSERT_EQUAL_UINT64(PERIMAN_PIN_MASK(54), perimanGetTypePins(ESP32_BUS_TYPE_UART_RX));
+  TEST_ASSERT_EQUAL_UINT64(PERIMAN_PIN_MASK(3) | PERIMAN_PIN_MASK(7), perimanGetTypePins(ESP32_BUS_TYPE_UART_TX));
+  TEST_ASSERT_TRUE(perimanClearPinBus(54));
+  TEST_ASSERT_EQUAL_UINT64(0, perimanGetTypePins(ESP32_BUS_TYPE_UART_RX));
+  TEST_ASSERT_EQUAL_UINT64(SOC_GPIO_VALID_GPIO_MASK & ~(PERIMAN_PIN_MASK(3) | PERIMAN_PIN_MASK(7)), perimanGetTypePins(ESP32_BUS_TYPE_INIT));
+  // a failed deinit leaves the pin where it was
+  deinit_result = false;
+  TEST_ASSERT_FALSE(perimanClearPinBus(7));
+  TEST_ASSERT_EQUAL_UINT64(PERIMAN_PIN_MASK(3) | PERIMAN_PIN_MASK(7), perimanGetTypePins(ESP32_BUS_TYPE_UART_TX));
+  // invalid pins and types
+  TEST_ASSERT_FALSE(perimanSetPinBus(SOC_GPIO_PIN_COUNT, ESP32_BUS_TYPE_GPIO, &bus_a, -1, -1));
+  TEST_ASSERT_EQUAL_UINT64(0, perimanGetTypePins(ESP32_BUS_TYPE_MAX));
+}
+
+void test_periman_next_pin(void) {
+  uint64_t mask = PERIMAN_PIN_MASK(0) | PERIMAN_PIN_MASK(9) | PERIMAN_PIN_MASK(40) | PERIMAN_PIN_MASK(54);
+  std::vector<int> seen;
+  int8_t pin;
+  while ((pin = perimanNextPin(&mask)) >= 0) {
+    seen.push_back(pin);
+  }
+  TEST_ASSERT_EQUAL(4, seen.size());
+  TEST_ASSERT_EQUAL(0, seen[0]);
+  TEST_ASSERT_EQUAL(9, seen[1]);
+  TEST_ASSERT_EQUAL(40, seen[2]);
+  TEST_ASSERT_EQUAL(54, seen[3]);
+  TEST_ASSERT_EQUAL_UINT64(0, mask);
+  TEST_ASSERT_EQUAL(-1, perimanNextPin(&mask));
+}
+
+void test_periman_clear_pins_batches_deinit(void) {
+  // three pins of one bus, two of another, and a GPIO
+  for (uint8_t pin : {10, 11, 12}) {
+    TEST_ASSERT_TRUE(perimanSetPinBus(pin, ESP32_BUS_TYPE_UART_RX, &bus_a, 0, -1));
+  }
+  for (uint8_t pin : {20, 21}) {
+    TEST_ASSERT_TRUE(perimanSetPinBus(pin, ESP32_BUS_TYPE_UART_RX, &bus_b, 1, -1));
+  }
+  TEST_ASSERT_TRUE(perimanSetPinBus(30, ESP32_BUS_TYPE_GPIO, (void *)31, -1, -1));
+  TEST_ASSERT_TRUE(perimanClearBusType(ESP32_BUS_TYPE_UART_RX));
+  TEST_ASSERT_EQUAL(2, deinits.size());
+  TEST_ASSERT_TRUE(deinits[0] == &bus_a);
+  TEST_ASSERT_TRUE(deinits[1] == &bus_b);
+  TEST_ASSERT_EQUAL_UINT64(0, perimanGetTypePins(ESP32_BUS_TYPE_UART_RX));
+  TEST_ASSERT_EQUAL_UINT64(PERIMAN_PIN_MASK(30), perimanGetUsedPins());
+  // only the pins of the mask are detached, the bus keeps its other pins
+  deinits.clear();
+  for (uint8_t pin : {10, 11, 12}) {
+    TEST_ASSERT_TRUE(perimanSetPinBus(pin, ESP32_BUS_TYPE_UART_RX, &bus_a, 0, -1));
+  }
+  TEST_ASSERT_TRUE(perimanClearPins(PERIMAN_PIN_MASK(10) | PERIMAN_PIN_MASK(12) | PERIMAN_PIN_MASK(30)));
+  TEST_ASSERT_EQUAL(2, deinits.size());
+  TEST_ASSERT_EQUAL_UINT64(PERIMAN_PIN_MASK(11), perimanGetUsedPins());
+  TEST_ASSERT_TRUE(perimanGetPinBus(11, ESP32_BUS_TYPE_UART_RX) == &bus_a);
+}
+
+void test_periman_clear_pins_failures(void) {
+  TEST_ASSERT_TRUE(perimanSetPinBus(1, ESP32_BUS_TYPE_UART_RX, &bus_a, 0, -1));
+  TEST_ASSERT_TRUE(perimanSetPinBus(2, ESP32_BUS_TYPE_UART_RX, &bus_a, 0, -1));
+  TEST_ASSERT_TRUE(perimanSetPinBus(5, ESP32_BUS_TYPE_UART_TX, &bus_b, 0, -1));
+  deinit_result = false;
+  TEST_ASSERT_FALSE(perimanClearPins(perimanGetUsedPins()));
+  // one callback per bus, and all the pins stay attached
+  TEST_ASSERT_EQUAL(2, deinits.size());
+  TEST_ASSERT_EQUAL_UINT64(PERIMAN_PIN_MASK(1) | PERIMAN_PIN_MASK(2) | PERIMAN_PIN_MASK(5), perimanGetUsedPins());
+  // invalid and free pins are left out
+  deinits.clear();
+  deinit_result = true;
+  TEST_ASSERT_TRUE(perimanClearPins(~0ULL));
+  TEST_ASSERT_EQUAL(2, deinits.size());
+  TEST_ASSERT_EQUAL_UINT64(0, perimanGetUsedPins());
+}
+
+void test_periman_clear_pins_reentrant(void) {
+  TEST_ASSERT_TRUE(perimanSetPinBus(4, ESP32_BUS_TYPE_UART_RX, &bus_a, 0, -1));
+  TEST_ASSERT_TRUE(perimanSetPinBus(8, ESP32_BUS_TYPE_UART_RX, &bus_b, 1, -1));
+  TEST_ASSERT_TRUE(perimanSetPinBus(9, ESP32_BUS_TYPE_UART_TX, &bus_b, 1, -1));
+  perimanSetBusDeinit(ESP32_BUS_TYPE_UART_RX, clear_all_deinit);
+  TEST_ASSERT_TRUE(perimanClearPins(perimanGetUsedPins()));
+  // the first callback detached pin 8 (through record_deinit), no second one for it
+  TEST_ASSERT_EQUAL(4, deinits.size());
+  TEST_ASSERT_TRUE(deinits[0] == &bus_a);
+  TEST_ASSERT_TRUE(deinits[1] == &bus_a);
+  TEST_ASSERT_TRUE(deinits[2] == &bus_b);
+  TEST_ASSERT_TRUE(deinits[3] == &bus_b);
+  TEST_ASSERT_EQUAL_UINT64(0, perimanGetUsedPins());
+}
+
+void test_periman_pins_info(void) {
+  TEST_ASSERT_TRUE(perimanSetPinBus(33, ESP32_BUS_TYPE_UART_TX, &bus_a, 2, -1));
+  TEST_ASSERT_TRUE(perimanSetPinBus(6, ESP32_BUS_TYPE_GPIO, (void *)7, -1, -1));
+  TEST_ASSERT_TRUE(perimanSetPinBus(50, ESP32_BUS_TYPE_UART_RX, &bus_b, 1, 3));
+  TEST_ASSERT_TRUE(perimanSetPinBusExtraType(33, "MODEM_TX"));
+  periman_pin_info_t info[SOC_GPIO_PIN_COUNT];
+  TEST_ASSERT_EQUAL(3, perimanGetPinsInfo(info, SOC_GPIO_PIN_COUNT));
+  TEST_ASSERT_EQUAL(6, info[0].pin);
+  TEST_ASSERT_EQUAL(ESP32_BUS_TYPE_GPIO, info[0].type);
+  TEST_ASSERT_NULL(info[0].extra_type);
+  TEST_ASSERT_EQUAL(33, info[1].pin);
+  TEST_ASSERT_EQUAL(ESP32_BUS_TYPE_UART_TX, info[1].type);
+  TEST_ASSERT_EQUAL(2, info[1].bus_num);
+  TEST_ASSERT_EQUAL(-1, info[1].bus_channel);
+  TEST_ASSERT_EQUAL_STRING("MODEM_TX", info[1].extra_type);
+  TEST_ASSERT_EQUAL(50, info[2].pin);
+  TEST_ASSERT_EQUAL(1, info[2].bus_num);
+  TEST_ASSERT_EQUAL(3, info[2].bus_channel);
+  // truncated to the room given
+  TEST_ASSERT_EQUAL(2, perimanGetPinsInfo(info, 2));
+  TEST_ASSERT_EQUAL(33, info[1].pin);
+}
+
+int main(void) {
+  UNITY_BEGIN();
+  RUN_TEST(test_periman_type_masks);
+  RUN_TEST(test_periman_next_pin);
+  RUN_TEST(test_periman_clear_pins_batches_deinit);
+  RUN_TEST(test_periman_clear_pins_failures);
+  RUN_TEST(test_periman_clear_pins_reentrant);
+  RUN_TEST(test_periman_pins_info);
+  return UNITY_END();
+}
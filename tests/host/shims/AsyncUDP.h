@@ -0,0 +1,103 @@
+/*
+ * Host build stand-in for AsyncUDP.h. There is no socket behind it: tests
+ * hand datagrams to the listeners with AsyncUDP::hostDeliver() and see what
+ * they send through the AsyncUDP::hostOnSend() callback, so that the protocol
+ * code on top can be tested and benchmarked without the network stack.
+ */
+
+#pragma once
+
+#include <functional>
+#include "IPAddress.h"
+#include "Print.h"
+#include "Stream.h"
+
+class AsyncUDP;
+class AsyncUDPPacket;
+class AsyncUDPMessage;
+
+typedef std::function<void(AsyncUDPPacket &packet)> AuPacketHandlerFunction;
+typedef std::function<void(void *arg, AsyncUDPPacket &packet)> AuPacketHandlerFunctionWithArg;
+typedef std::function<void(const uint8_t *data, size_t len, const IPAddress &addr, uint16_t port)> AuHostSendFunction;
+
+class AsyncUDPMessage : public Print {
+protected:
+  uint8_t *_buffer;
+  size_t _index;
+  size_t _size;
+
+public:
+  AsyncUDPMessage(size_t size = CONFIG_TCP_MSS);
+  virtual ~AsyncUDPMessage();
+  size_t write(const uint8_t *data, size_t len);
+  size_t write(uint8_t data);
+  size_t space();
+  uint8_t *data();
+  size_t length();
+  void flush();
+  operator bool() {
+    return _buffer != NULL;
+  }
+};
+
+class AsyncUDPPacket : public Stream {
+protected:
+  AsyncUDP *_udp;
+  const uint8_t *_data;
+  size_t _len;
+  size_t _index;
+  IPAddress _remoteIp;
+  uint16_t _remotePort;
+  uint16_t _localPort;
+
+public:
+  AsyncUDPPacket(AsyncUDP *udp, const uint8_t *data, size_t len, const IPAddress &remoteIp, uint16_t remotePort, uint16_t localPort);
+
+  uint8_t *data();
+  size_t length();
+  IPAddress remoteIP();
+  uint16_t remotePort();
+  uint16_t localPort();
+
+  size_t send(AsyncUDPMessage &message);
+
+  int available();
+  size_t read(uint8_t *data, size_t len);
+  int read();
+  int peek();
+  void flush();
+
+  size_t write(const uint8_t *data, size_t len);
+  size_t write(uint8_t data);
+};
+
+class AsyncUDP : public Print {
+protected:
+  uint16_t _port;
+  bool _connected;
+  AuPacketHandlerFunction _handler;
+
+public:
+  AsyncUDP();
+  virtual ~AsyncUDP();
+
+  void onPacket(AuPacketHandlerFunctionWithArg cb, void *arg = NULL);
+  void onPacket(AuPacketHandlerFunction cb);
+
+  bool listen(uint16_t port);
+  void close();
+
+  size_t writeTo(const uint8_t *data, size_t len, const IPAddress addr, uint16_t port);
+  size_t sendTo(AsyncUDPMessage &message, const IPAddress addr, uint16_t port);
+
+  size_t write(const uint8_t *data, size_t len);
+  size_t write(uint8_t data);
+
+  bool connected();
+  operator bool();
+
+  // Host only: passes a datagram to the listener on port, returns false if there is none
+  static bool hostDeliver(uint16_t port, const uint8_t *data, size_t len, const IPAddress &remoteIp, uint16_t remotePort);
+  // Host only: receives everything sent by any AsyncUDP instance
+  static void hostOnSend(AuHostSendFunction cb);
+};
@@ -0,0 +1,26 @@
+/*
+ * Host build stand-in for HardwareSerial.h: Serial reads stdin and writes
+ * stdout.
+ */
+
+#pragma once
+
+#include "Stream.h"
+
+class HardwareSerial : public Stream {
+public:
+  void begin(unsigned long baud) {}
+  void end() {}
+  int available() override;
+  int peek() override;
+  int read() override;
+  void flush() override;
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t *buffer, size_t size) override;
+  using Print::write;
+  operator bool() const {
+    return true;
+  }
+};
+
+extern HardwareSerial Serial;
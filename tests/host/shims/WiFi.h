@@ -0,0 +1,8 @@
+/*
+ * Host build stand-in for WiFi.h. The host has no WiFi, SOC_WIFI_SUPPORTED is
+ * not defined and none of the WiFi classes are used.
+ */
+
+#pragma once
+
+#include "Network.h"
@@ -0,0 +1,114 @@
+/*
+ * Host implementations of the Arduino API functions declared by host_arduino.h.
+ */
+
+#include <poll.h>
+#include <unistd.h>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include "soc/soc_caps.h"
+
+static const auto s_boot = std::chrono::steady_clock::now();
+
+unsigned long micros(void) {
+  return (unsigned long)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - s_boot).count();
+}
+
+unsigned long millis(void) {
+  return (unsigned long)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - s_boot).count();
+}
+
+void delay(uint32_t ms) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void delayMicroseconds(uint32_t us) {
+  std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+void yield(void) {
+  std::this_thread::yield();
+}
+
+esp_err_t arduino_eventfd_register(void) {
+  return ESP_OK;
+}
+
+struct HostPin {
+  uint8_t level;
+  int mode;
+  void (*isr)(void *);
+  void *arg;
+};
+
+static HostPin s_pins[SOC_GPIO_PIN_COUNT];
+static std::recursive_mutex s_pins_lock;
+
+int digitalRead(uint8_t pin) {
+  std::lock_guard<std::recursive_mutex> guard(s_pins_lock);
+  return pin < SOC_GPIO_PIN_COUNT ? s_pins[pin].level : 0;
+}
+
+void attachInterruptArg(uint8_t pin, void (*isr)(void *), void *arg, int mode) {
+  std::lock_guard<std::recursive_mutex> guard(s_pins_lock);
+  if (pin < SOC_GPIO_PIN_COUNT) {
+    s_pins[pin].mode = mode;
+    s_pins[pin].isr = isr;
+    s_pins[pin].arg = arg;
+  }
+}
+
+void detachInterrupt(uint8_t pin) {
+  std::lock_guard<std::recursive_mutex> guard(s_pins_lock);
+  if (pin < SOC_GPIO_PIN_COUNT) {
+    s_pins[pin].isr = nullptr;
+  }
+}
+
+void hostDigitalWrite(uint8_t pin, uint8_t level) {
+  // the lock stands for the ISR service, which runs one pin interrupt at a time,
+  // the ISR reads the level again
+  std::lock_guard<std::recursive_mutex> guard(s_pins_lock);
+  HostPin &p = s_pins[pin];
+  uint8_t previous = p.level;
+  p.level = level;
+  bool fire = p.mode == CHANGE ? previous != level : p.mode == RISING ? !previous && level : p.mode == FALLING ? previous && !level : false;
+  if (p.isr && fire) {
+    hostSetIsrContext(true);
+    p.isr(p.arg);
+    hostSetIsrContext(false);
+  }
+}
+
+HardwareSerial Serial;
+
+int HardwareSerial::available() {
+  struct pollfd fd = {STDIN_FILENO, POLLIN, 0};
+  return poll(&fd, 1, 0) > 0 ? 1 : 0;
+}
+
+int HardwareSerial::peek() {
+  int c = getchar();
+  if (c != EOF) {
+    ungetc(c, stdin);
+  }
+  return c == EOF ? -1 : c;
+}
+
+int HardwareSerial::read() {
+  int c = getchar();
+  return c == EOF ? -1 : c;
+}
+
+void HardwareSerial::flush() {
+  fflush(stdout);
+}
+
+size_t HardwareSerial::write(uint8_t c) {
+  return fputc(c, stdout) == EOF ? 0 : 1;
+}
+
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size) {
+  return fwrite(buffer, 1, size, stdout);
+}
@@ -0,0 +1,185 @@
+/*
+ * Host implementation of the AsyncUDP stand-in, see AsyncUDP.h.
+ */
+
+#include <algorithm>
+#include <vector>
+#include "AsyncUDP.h"
+
+static std::vector<AsyncUDP *> s_listeners;
+static AuHostSendFunction s_send;
+
+AsyncUDPMessage::AsyncUDPMessage(size_t size) : _index(0), _size(size) {
+  _buffer = (uint8_t *)malloc(size);
+  if (!_buffer) {
+    _size = 0;
+  }
+}
+
+AsyncUDPMessage::~AsyncUDPMessage() {
+  free(_buffer);
+}
+
+size_t AsyncUDPMessage::write(const uint8_t *data, size_t len) {
+  if (!_buffer) {
+    return 0;
+  }
+  len = std::min(len, space());
+  memcpy(_buffer + _index, data, len);
+  _index += len;
+  return len;
+}
+
+size_t AsyncUDPMessage::write(uint8_t data) {
+  return write(&data, 1);
+}
+
+size_t AsyncUDPMessage::space() {
+  return _size - _index;
+}
+
+uint8_t *AsyncUDPMessage::data() {
+  return _buffer;
+}
+
+size_t AsyncUDPMessage::length() {
+  return _index;
+}
+
+void AsyncUDPMessage::flush() {
+  _index = 0;
+}
+
+AsyncUDPPacket::AsyncUDPPacket(AsyncUDP *udp, const uint8_t *data, size_t len, const IPAddress &remoteIp, uint16_t remotePort, uint16_t localPort)
+  : _udp(udp), _data(data), _len(len), _index(0), _remoteIp(remoteIp), _remotePort(remotePort), _localPort(localPort) {}
+
+uint8_t *AsyncUDPPacket::data() {
+  return (uint8_t *)_data;
+}
+
+size_t AsyncUDPPacket::length() {
+  return _len;
+}
+
+IPAddress AsyncUDPPacket::remoteIP() {
+  return _remoteIp;
+}
+
+uint16_t AsyncUDPPacket::remotePort() {
+  return _remotePort;
+}
+
+uint16_t AsyncUDPPacket::localPort() {
+  return _localPort;
+}
+
+size_t AsyncUDPPacket::send(AsyncUDPMessage &message) {
+  return _udp->sendTo(message, _remoteIp, _remotePort);
+}
+
+int AsyncUDPPacket::available() {
+  return _len - _index;
+}
+
+size_t AsyncUDPPacket::read(uint8_t *data, size_t len) {
+  len = std::min(len, _len - _index);
+  memcpy(data, _data + _index, len);
+  _index += len;
+  return len;
+}
+
+int AsyncUDPPacket::read() {
+  return _index < _len ? _data[_index++] : -1;
+}
+
+int AsyncUDPPacket::peek() {
+  return _index < _len ? _data[_index] : -1;
+}
+
+void AsyncUDPPacket::flush() {
+  _index = _len;
+}
+
+size_t AsyncUDPPacket::write(const uint8_t *data, size_t len) {
+  return _udp->writeTo(data, len, _remoteIp, _remotePort);
+}
+
+size_t AsyncUDPPacket::write(uint8_t data) {
+  return write(&data, 1);
+}
+
+AsyncUDP::AsyncUDP() : _port(0), _connected(false) {}
+
+AsyncUDP::~AsyncUDP() {
+  close();
+}
+
+void AsyncUDP::onPacket(AuPacketHandlerFunctionWithArg cb, void *arg) {
+  onPacket(std::bind(cb, arg, std::placeholders::_1));
+}
+
+void AsyncUDP::onPacket(AuPacketHandlerFunction cb) {
+  _handler = cb;
+}
+
+bool AsyncUDP::listen(uint16_t port) {
+  close();
+  _port = port;
+  _connected = true;
+  s_listeners.push_back(this);
+  return true;
+}
+
+void AsyncUDP::close() {
+  if (_connected) {
+    s_listeners.erase(std::remove(s_listeners.begin(), s_listeners.end(), this), s_listeners.end());
+    _connected = false;
+  }
+}
+
+size_t AsyncUDP::writeTo(const uint8_t *data, size_t len, const IPAddress addr, uint16_t port) {
+  if (s_send) {
+    s_send(data, len, addr, port);
+  }
+  return len;
+}
+
+size_t AsyncUDP::sendTo(AsyncUDPMessage &message, const IPAddress addr, uint16_t port) {
+  if (!message) {
+    return 0;
+  }
+  return writeTo(message.data(), message.length(), addr, port);
+}
+
+size_t AsyncUDP::write(const uint8_t *data, size_t len) {
+  return 0;
+}
+
+size_t AsyncUDP::write(uint8_t data) {
+  return write(&data, 1);
+}
+
+bool AsyncUDP::connected() {
+  return _connected;
+}
+
+AsyncUDP::operator bool() {
+  return _connected;
+}
+
+bool AsyncUDP::hostDeliver(uint16_t port, const uint8_t *data, size_t len, const IPAddress &remoteIp, uint16_t remotePort) {
+  for (AsyncUDP *udp : s_listeners) {
+    if (udp->_port == port) {
+      if (udp->_handler) {
+        AsyncUDPPacket packet(udp, data, len, remoteIp, remotePort, port);
+        udp->_handler(packet);
+      }
+      return true;
+    }
+  }
+  return false;
+}
+
+void AsyncUDP::hostOnSend(AuHostSendFunction cb) {
+  s_send = cb;
+}
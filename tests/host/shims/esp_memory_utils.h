@@ -0,0 +1,18 @@
+/*
+ * Host build stand-in for esp_memory_utils.h.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// true for addresses in the read-only data of the executable (string literals)
+bool esp_ptr_in_drom(const void *p);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,43 @@
+/*
+ * Host build stand-in for esp_netif_types.h: only the types the Network
+ * library headers need.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "esp_netif_ip_addr.h"
+
+typedef struct esp_netif_obj esp_netif_t;
+
+typedef struct {
+  uint32_t addr;
+} esp_ip4_addr_t;
+
+typedef struct {
+  esp_ip4_addr_t ip;
+  esp_ip4_addr_t netmask;
+  esp_ip4_addr_t gw;
+} esp_netif_ip_info_t;
+
+typedef struct {
+  esp_ip6_addr_t ip;
+} esp_netif_ip6_info_t;
+
+typedef struct {
+  esp_netif_t *esp_netif;
+  esp_netif_ip_info_t ip_info;
+  bool ip_changed;
+} ip_event_got_ip_t;
+
+typedef struct {
+  esp_netif_t *esp_netif;
+  esp_netif_ip6_info_t ip6_info;
+  int ip_index;
+} ip_event_got_ip6_t;
+
+typedef struct {
+  esp_netif_t *esp_netif;
+  esp_ip4_addr_t ip;
+  uint8_t mac[6];
+} ip_event_ap_staipassigned_t;
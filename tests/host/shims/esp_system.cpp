@@ -0,0 +1,95 @@
+/*
+ * Host implementations of the ESP-IDF and HAL helpers used by the core sources.
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include "esp_timer.h"
+#include "esp_log.h"
+#include "esp_system.h"
+#include "esp_memory_utils.h"
+#include "esp_random.h"
+#include "esp32-hal-log.h"
+
+static std::atomic<int64_t> s_time_offset;
+
+int64_t esp_timer_get_time(void) {
+  static const auto boot = std::chrono::steady_clock::now();
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - boot).count() + s_time_offset.load();
+}
+
+void hostAdvanceTime(int64_t us) {
+  s_time_offset += us;
+}
+
+uint32_t esp_log_timestamp(void) {
+  return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+const char *pathToFileName(const char *path) {
+  const char *slash = strrchr(path, '/');
+  return slash ? slash + 1 : path;
+}
+
+int log_printf(const char *format, ...) {
+  va_list arg;
+  va_start(arg, format);
+  int len = vfprintf(stderr, format, arg);
+  va_end(arg);
+  return len;
+}
+
+int log_level_printf(uint8_t level, const char *format, ...) {
+  (void)level;
+  va_list arg;
+  va_start(arg, format);
+  int len = vfprintf(stderr, format, arg);
+  va_end(arg);
+  return len;
+}
+
+void log_print_buf(const uint8_t *b, size_t len) {
+  for (size_t i = 0; i < len; i++) {
+    fprintf(stderr, "%02x%s", b[i], ((i + 1) % 16) ? " " : "\n");
+  }
+  fprintf(stderr, "\n");
+}
+
+void log_write(const char *data, size_t len) {
+  fwrite(data, 1, len, stderr);
+}
+
+// GNU ld places .rodata between the end of .text and the start of .data
+extern "C" const char etext[], __data_start[];
+
+bool esp_ptr_in_drom(const void *p) {
+  return (const char *)p >= etext && (const char *)p < __data_start;
+}
+
+esp_err_t esp_register_shutdown_handler(shutdown_handler_t handle) {
+  return ESP_OK;
+}
+
+esp_err_t esp_unregister_shutdown_handler(shutdown_handler_t handle) {
+  return ESP_OK;
+}
+
+uint32_t esp_random(void) {
+  static std::mt19937 generator(std::random_device{}());
+  return generator();
+}
+
+void esp_fill_random(void *buf, size_t len) {
+  uint8_t *out = (uint8_t *)buf;
+  while (len) {
+    uint32_t word = esp_random();
+    size_t n = len < sizeof(word) ? len : sizeof(word);
+    memcpy(out, &word, n);
+    out += n;
+    len -= n;
+  }
+}
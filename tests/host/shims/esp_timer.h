@@ -0,0 +1,20 @@
+/*
+ * Host build stand-in for esp_timer.h, backed by the monotonic clock.
+ * Tests can move it forward with hostAdvanceTime().
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int64_t esp_timer_get_time(void);
+// Host only: adds us to the time esp_timer_get_time() returns from now on
+void hostAdvanceTime(int64_t us);
+
+#ifdef __cplusplus
+}
+#endif
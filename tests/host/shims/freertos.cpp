@@ -0,0 +1,270 @@
+/*
+ * Host implementations of the FreeRTOS primitives declared by the shims.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "freertos/FreeRTOS.h"
+#include "freertos/ringbuf.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+struct HostSemaphore {
+  std::recursive_mutex mutex;
+};
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void) {
+  return new HostSemaphore();
+}
+
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex(void) {
+  return new HostSemaphore();
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks) {
+  if (ticks == 0) {
+    return sem->mutex.try_lock() ? pdTRUE : pdFALSE;
+  }
+  sem->mutex.lock();
+  return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem) {
+  sem->mutex.unlock();
+  return pdTRUE;
+}
+
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t sem, TickType_t ticks) {
+  return xSemaphoreTake(sem, ticks);
+}
+
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t sem) {
+  return xSemaphoreGive(sem);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t sem) {
+  delete sem;
+}
+
+struct HostRingbuffer {
+  std::mutex lock;
+  uint8_t *data;
+  size_t size;
+  size_t read;      // offset of the oldest byte
+  size_t used;      // bytes stored, including the ones lent out
+  size_t acquired;  // bytes lent out by xRingbufferReceiveUpTo()
+};
+
+RingbufHandle_t xRingbufferCreate(size_t xBufferSize, RingbufferType_t xBufferType) {
+  if (xBufferType != RINGBUF_TYPE_BYTEBUF || xBufferSize == 0) {
+    return NULL;
+  }
+  HostRingbuffer *rb = new HostRingbuffer();
+  rb->data = (uint8_t *)malloc(xBufferSize);
+  if (rb->data == NULL) {
+    delete rb;
+    return NULL;
+  }
+  rb->size = xBufferSize;
+  rb->read = 0;
+  rb->used = 0;
+  rb->acquired = 0;
+  return rb;
+}
+
+void vRingbufferDelete(RingbufHandle_t xRingbuffer) {
+  free(xRingbuffer->data);
+  delete xRingbuffer;
+}
+
+BaseType_t xRingbufferSend(RingbufHandle_t xRingbuffer, const void *pvItem, size_t xItemSize, TickType_t xTicksToWait) {
+  (void)xTicksToWait;
+  std::lock_guard<std::mutex> guard(xRingbuffer->lock);
+  if (xItemSize > xRingbuffer->size - xRingbuffer->used) {
+    return pdFALSE;
+  }
+  size_t write = (xRingbuffer->read + xRingbuffer->used) % xRingbuffer->size;
+  size_t first = xRingbuffer->size - write;
+  if (first > xItemSize) {
+    first = xItemSize;
+  }
+  memcpy(xRingbuffer->data + write, pvItem, first);
+  memcpy(xRingbuffer->data, (const uint8_t *)pvItem + first, xItemSize - first);
+  xRingbuffer->used += xItemSize;
+  return pdTRUE;
+}
+
+void *xRingbufferReceiveUpTo(RingbufHandle_t xRingbuffer, size_t *pxItemSize, TickType_t xTicksToWait, size_t xMaxSize) {
+  (void)xTicksToWait;
+  std::lock_guard<std::mutex> guard(xRingbuffer->lock);
+  size_t pending = xRingbuffer->used - xRingbuffer->acquired;
+  if (!pending || xRingbuffer->acquired) {
+    return NULL;
+  }
+  size_t contiguous = xRingbuffer->size - xRingbuffer->read;
+  size_t len = pending < contiguous ? pending : contiguous;
+  if (len > xMaxSize) {
+    len = xMaxSize;
+  }
+  xRingbuffer->acquired = len;
+  *pxItemSize = len;
+  return xRingbuffer->data + xRingbuffer->read;
+}
+
+void vRingbufferReturnItem(RingbufHandle_t xRingbuffer, void *pvItem) {
+  (void)pvItem;
+  std::lock_guard<std::mutex> guard(xRingbuffer->lock);
+  xRingbuffer->read = (xRingbuffer->read + xRingbuffer->acquired) % xRingbuffer->size;
+  xRingbuffer->used -= xRingbuffer->acquired;
+  xRingbuffer->acquired = 0;
+}
+
+size_t xRingbufferGetMaxItemSize(RingbufHandle_t xRingbuffer) {
+  return xRingbuffer->size;
+}
+
+size_t xRingbufferGetCurFreeSize(RingbufHandle_t xRingbuffer) {
+  std::lock_guard<std::mutex> guard(xRingbuffer->lock);
+  return xRingbuffer->size - xRingbuffer->used;
+}
+
+void vRingbufferGetInfo(
+  RingbufHandle_t xRingbuffer, UBaseType_t *uxFree, UBaseType_t *uxRead, UBaseType_t *uxWrite, UBaseType_t *uxAcquire, UBaseType_t *uxItemsWaiting
+) {
+  std::lock_guard<std::mutex> guard(xRingbuffer->lock);
+  size_t write = (xRingbuffer->read + xRingbuffer->used) % xRingbuffer->size;
+  if (uxFree) {
+    *uxFree = xRingbuffer->size - xRingbuffer->used;
+  }
+  if (uxRead) {
+    *uxRead = xRingbuffer->read;
+  }
+  if (uxWrite) {
+    *uxWrite = write;
+  }
+  if (uxAcquire) {
+    *uxAcquire = write;
+  }
+  if (uxItemsWaiting) {
+    *uxItemsWaiting = xRingbuffer->used - xRingbuffer->acquired;
+  }
+}
+
+struct HostTask {
+  std::mutex lock;
+  std::condition_variable cond;
+  uint32_t notifications[configTASK_NOTIFICATION_ARRAY_ENTRIES] = {};
+};
+
+static thread_local HostTask *s_current_task = NULL;
+static thread_local bool s_in_isr = false;
+
+BaseType_t xTaskCreateUniversal(
+  TaskFunction_t pxTaskCode, const char *const pcName, const uint32_t usStackDepth, void *const pvParameters, UBaseType_t uxPriority,
+  TaskHandle_t *const pxCreatedTask, const BaseType_t xCoreID
+) {
+  HostTask *task = new HostTask();
+  if (pxCreatedTask) {
+    *pxCreatedTask = task;
+  }
+  std::thread([task, pxTaskCode, pvParameters]() {
+    s_current_task = task;
+    pxTaskCode(pvParameters);
+  }).detach();
+  return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t xTaskToDelete) {
+  // the handle is leaked on purpose, other threads may still notify it
+  if (xTaskToDelete == NULL || xTaskToDelete == s_current_task) {
+    // returning from the thread function ends the std::thread; FreeRTOS tasks
+    // never return from vTaskDelete(NULL), so park the thread instead
+    while (true) {
+      std::this_thread::sleep_for(std::chrono::hours(1));
+    }
+  }
+}
+
+void vTaskDelay(const TickType_t xTicksToDelay) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(xTicksToDelay * portTICK_PERIOD_MS));
+}
+
+TickType_t xTaskGetTickCount(void) {
+  static const auto boot = std::chrono::steady_clock::now();
+  return (TickType_t)(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - boot).count() / portTICK_PERIOD_MS);
+}
+
+// Threads not started by xTaskCreateUniversal(), like the one running main(),
+// get a task on first use
+static HostTask *current_task(void) {
+  if (s_current_task == NULL) {
+    s_current_task = new HostTask();
+  }
+  return s_current_task;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+  return current_task();
+}
+
+uint32_t ulTaskNotifyTakeIndexed(UBaseType_t uxIndexToWaitOn, BaseType_t xClearCountOnExit, TickType_t xTicksToWait) {
+  HostTask *task = current_task();
+  uint32_t &notifications = task->notifications[uxIndexToWaitOn];
+  std::unique_lock<std::mutex> guard(task->lock);
+  if (xTicksToWait == portMAX_DELAY) {
+    task->cond.wait(guard, [&notifications]() {
+      return notifications != 0;
+    });
+  } else {
+    task->cond.wait_for(guard, std::chrono::milliseconds(xTicksToWait * portTICK_PERIOD_MS), [&notifications]() {
+      return notifications != 0;
+    });
+  }
+  uint32_t value = notifications;
+  if (xClearCountOnExit) {
+    notifications = 0;
+  } else if (value) {
+    notifications--;
+  }
+  return value;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t xClearCountOnExit, TickType_t xTicksToWait) {
+  return ulTaskNotifyTakeIndexed(0, xClearCountOnExit, xTicksToWait);
+}
+
+BaseType_t xTaskNotifyGiveIndexed(TaskHandle_t xTaskToNotify, UBaseType_t uxIndexToNotify) {
+  {
+    std::lock_guard<std::mutex> guard(xTaskToNotify->lock);
+    xTaskToNotify->notifications[uxIndexToNotify]++;
+  }
+  xTaskToNotify->cond.notify_one();
+  return pdPASS;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t xTaskToNotify) {
+  return xTaskNotifyGiveIndexed(xTaskToNotify, 0);
+}
+
+void vTaskNotifyGiveIndexedFromISR(TaskHandle_t xTaskToNotify, UBaseType_t uxIndexToNotify, BaseType_t *pxHigherPriorityTaskWoken) {
+  xTaskNotifyGiveIndexed(xTaskToNotify, uxIndexToNotify);
+  if (pxHigherPriorityTaskWoken) {
+    *pxHigherPriorityTaskWoken = pdFALSE;
+  }
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t xTaskToNotify, BaseType_t *pxHigherPriorityTaskWoken) {
+  vTaskNotifyGiveIndexedFromISR(xTaskToNotify, 0, pxHigherPriorityTaskWoken);
+}
+
+BaseType_t xPortInIsrContext(void) {
+  return s_in_isr ? pdTRUE : pdFALSE;
+}
+
+void hostSetIsrContext(bool in_isr) {
+  s_in_isr = in_isr;
+}
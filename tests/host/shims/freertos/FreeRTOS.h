@@ -0,0 +1,25 @@
+/*
+ * Host build stand-in for freertos/FreeRTOS.h.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include "sdkconfig.h"
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE        ((BaseType_t)0)
+#define pdTRUE         ((BaseType_t)1)
+#define pdPASS         pdTRUE
+#define pdFAIL         pdFALSE
+#define portMAX_DELAY  ((TickType_t)0xffffffffUL)
+#define portTICK_PERIOD_MS ((TickType_t)(1000 / CONFIG_FREERTOS_HZ))
+#define configTASK_NOTIFICATION_ARRAY_ENTRIES CONFIG_FREERTOS_TASK_NOTIFICATION_ARRAY_ENTRIES
+#define pdMS_TO_TICKS(ms)  ((TickType_t)(((uint64_t)(ms) * CONFIG_FREERTOS_HZ) / 1000))
+// host threads are preempted by the OS, there is nothing to switch to
+#define portYIELD_FROM_ISR(...)
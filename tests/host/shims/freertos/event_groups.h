@@ -0,0 +1,10 @@
+/*
+ * Host build stand-in for freertos/event_groups.h: the handle type only.
+ */
+
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct HostEventGroup *EventGroupHandle_t;
+typedef uint32_t EventBits_t;
@@ -0,0 +1,9 @@
+/*
+ * Host build stand-in for freertos/queue.h: the handle type only.
+ */
+
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct HostQueue *QueueHandle_t;
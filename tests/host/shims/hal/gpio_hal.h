@@ -0,0 +1,16 @@
+/*
+ * Host build stand-in for hal/gpio_hal.h, reading the simulated pins of
+ * shims/arduino.cpp.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+typedef struct {
+  void *dev;
+} gpio_hal_context_t;
+
+#define GPIO_PORT_0                       0
+#define GPIO_LL_GET_HW(num)               ((void *)0)
+#define gpio_hal_get_level(hal, gpio_num) ((void)(hal), digitalRead(gpio_num))
@@ -0,0 +1,109 @@
+/*
+ * Host build stand-in for Arduino.h.
+ *
+ * Force-included into every host-compiled core and library source. It claims
+ * the Arduino.h, esp32-hal.h and esp32-hal-gpio.h include guards so that
+ * including any of them in those sources resolves to the small set of
+ * declarations below instead of pulling in the whole HAL.
+ */
+
+#pragma once
+
+#define Arduino_h
+#define HAL_ESP32_HAL_H_
+#define MAIN_ESP32_HAL_GPIO_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <math.h>
+
+#include "sdkconfig.h"
+#include "esp_arduino_version.h"
+#include "esp_system.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/event_groups.h"
+#include "esp8266-compat.h"
+#include "extra_attr.h"
+#include "esp_bit_defs.h"  // Arduino.h gets these through soc/gpio_reg.h
+#include "stdlib_noniso.h"
+#include "binary.h"
+#include "pgmspace.h"
+#include "esp32-hal-log.h"
+
+#define _min(a, b)                ((a) < (b) ? (a) : (b))
+#define _max(a, b)                ((a) > (b) ? (a) : (b))
+#define _abs(x)                   ((x) > 0 ? (x) : -(x))
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#define lowByte(w)                ((uint8_t)((w) & 0xff))
+#define highByte(w)               ((uint8_t)((w) >> 8))
+#define bit(b)                    (1UL << (b))
+#define _BV(b)                    (1UL << (b))
+#define bitRead(value, bit)       (((value) >> (bit)) & 0x01)
+#define bitSet(value, bit)        ((value) |= (1UL << (bit)))
+#define bitClear(value, bit)      ((value) &= ~(1UL << (bit)))
+
+// from esp32-hal.h, without CONFIG_ARDUINO_ISR_IRAM
+#define ARDUINO_ISR_ATTR
+
+// from esp32-hal-gpio.h
+#define LOW     0x0
+#define HIGH    0x1
+#define RISING  0x01
+#define FALLING 0x02
+#define CHANGE  0x03
+
+typedef bool boolean;
+typedef uint8_t byte;
+typedef unsigned int word;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// implemented in shims/arduino.cpp on top of std::chrono and std::this_thread
+unsigned long micros(void);
+unsigned long millis(void);
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield(void);
+// the Linux eventfd needs no registration
+esp_err_t arduino_eventfd_register(void);
+// simulated pins, their interrupt runs in the thread that changes the level
+int digitalRead(uint8_t pin);
+void attachInterruptArg(uint8_t pin, void (*)(void *), void *arg, int mode);
+void detachInterrupt(uint8_t pin);
+// Host only: sets the level of a pin, calling its interrupt as an ISR
+void hostDigitalWrite(uint8_t pin, uint8_t level);
+
+#ifdef __cplusplus
+}
+
+#include <algorithm>
+#include <cmath>
+
+long random(long);
+long random(long, long);
+void randomSeed(unsigned long);
+void useRealRandomGenerator(bool useRandomHW);
+long map(long, long, long, long, long);
+
+#include "WCharacter.h"
+#include "WString.h"
+#include "Stream.h"
+#include "Printable.h"
+#include "Print.h"
+#include "IPAddress.h"
+#include "Client.h"
+#include "Server.h"
+#include "Udp.h"
+#include "HardwareSerial.h"
+#endif
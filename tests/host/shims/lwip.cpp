@@ -0,0 +1,29 @@
+/*
+ * Host implementations of the lwIP and esp_netif symbols used by the core.
+ */
+
+#include <arpa/inet.h>
+#include "esp_netif_ip_addr.h"
+#include "lwip/netif.h"
+
+struct netif *netif_list = nullptr;
+
+esp_ip6_addr_type_t esp_netif_ip6_get_addr_type(esp_ip6_addr_t *ip6_addr) {
+  const uint8_t *bytes = (const uint8_t *)ip6_addr->addr;
+  if (bytes[0] == 0xfe && (bytes[1] & 0xc0) == 0x80) {
+    return ESP_IP6_ADDR_IS_LINK_LOCAL;
+  }
+  if (bytes[0] == 0xfe && (bytes[1] & 0xc0) == 0xc0) {
+    return ESP_IP6_ADDR_IS_SITE_LOCAL;
+  }
+  if ((bytes[0] & 0xfe) == 0xfc) {
+    return ESP_IP6_ADDR_IS_UNIQUE_LOCAL;
+  }
+  if (ip6_addr->addr[0] == 0 && ip6_addr->addr[1] == 0 && ip6_addr->addr[2] == htonl(0xffff)) {
+    return ESP_IP6_ADDR_IS_IPV4_MAPPED_IPV6;
+  }
+  if ((bytes[0] & 0xe0) == 0x20) {
+    return ESP_IP6_ADDR_IS_GLOBAL;
+  }
+  return ESP_IP6_ADDR_IS_UNKNOWN;
+}
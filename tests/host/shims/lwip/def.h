@@ -0,0 +1,7 @@
+/*
+ * Host build stand-in for lwip/def.h: byte order helpers.
+ */
+
+#pragma once
+
+#include <arpa/inet.h>
@@ -0,0 +1,31 @@
+/*
+ * Host build stand-in for lwip/ip_addr.h, with the dual stack layout of
+ * ip_addr_t that IPAddress converts from and to.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#define LWIP_IPV6_SCOPES 1
+#define IP6_NO_ZONE      0
+
+#define IPADDR_TYPE_V4 0U
+#define IPADDR_TYPE_V6 6U
+
+typedef struct ip4_addr {
+  uint32_t addr;
+} ip4_addr_t;
+
+typedef struct ip6_addr {
+  uint32_t addr[4];
+  uint8_t zone;
+} ip6_addr_t;
+
+typedef struct ip_addr {
+  union {
+    ip6_addr_t ip6;
+    ip4_addr_t ip4;
+  } u_addr;
+  uint8_t type;
+} ip_addr_t;
@@ -0,0 +1,7 @@
+/*
+ * Host build stand-in for lwip/netdb.h.
+ */
+
+#pragma once
+
+#include <netdb.h>
@@ -0,0 +1,25 @@
+/*
+ * Host build stand-in for lwip/netif.h. The host has no lwIP interfaces, so
+ * netif_list is always empty.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "lwip/ip_addr.h"
+
+struct netif {
+  struct netif *next;
+  char name[2];
+  uint8_t num;
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+extern struct netif *netif_list;
+
+#ifdef __cplusplus
+}
+#endif
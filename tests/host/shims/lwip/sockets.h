@@ -0,0 +1,43 @@
+/*
+ * Host build stand-in for lwip/sockets.h: the BSD socket API of the host,
+ * with the lwip_* names and the lwIP in6_addr layout mapped onto it.
+ */
+
+#pragma once
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/ioctl.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+
+// functions rather than macros: the callers are members of classes that have
+// methods with the plain names
+static inline int lwip_accept(int s, struct sockaddr *addr, socklen_t *addrlen) {
+  return accept(s, addr, addrlen);
+}
+
+static inline int lwip_close(int s) {
+  return close(s);
+}
+
+static inline int lwip_connect(int s, const struct sockaddr *name, socklen_t namelen) {
+  return connect(s, name, namelen);
+}
+
+static inline int lwip_ioctl(int s, long cmd, void *argp) {
+  return ioctl(s, cmd, argp);
+}
+
+// lwIP names the in6_addr union `un`, glibc names it `__in6_u`
+#define un        __in6_u
+#define u8_addr   __u6_addr8
+#define u32_addr  __u6_addr32
+
+// <netinet/in.h> defines INADDR_NONE as a macro, the core declares an IPAddress of that name
+#undef INADDR_NONE
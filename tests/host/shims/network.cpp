@@ -0,0 +1,54 @@
+/*
+ * Host implementations of the parts of the Network library that the compiled
+ * NetworkClient, WebServer and HTTPClient sources call. Name lookups go to the
+ * host resolver, there are no interfaces and no events.
+ */
+
+#include <netdb.h>
+#include "Network.h"
+#include "http_parser.h"
+
+const char *http_method_str(enum http_method m) {
+  static const char *const names[] = {
+#define XX(num, name, string) #string,
+    HTTP_METHOD_MAP(XX)
+#undef XX
+  };
+  return (unsigned)m < sizeof(names) / sizeof(names[0]) ? names[m] : "<unknown>";
+}
+
+NetworkEvents::NetworkEvents() : _arduino_event_group(NULL), _arduino_event_queue(NULL), _arduino_event_task_handle(NULL) {}
+
+NetworkEvents::~NetworkEvents() {}
+
+NetworkManager::NetworkManager() {}
+
+bool NetworkManager::begin() {
+  return true;
+}
+
+int NetworkManager::hostByName(const char *aHostname, IPAddress &aResult) {
+  if (aResult.fromString(aHostname)) {
+    return 1;
+  }
+  struct addrinfo hints = {};
+  struct addrinfo *res = NULL;
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  if (getaddrinfo(aHostname, NULL, &hints, &res) != 0 || res == NULL) {
+    return 0;
+  }
+  if (res->ai_family == AF_INET6) {
+    aResult = IPAddress(IPv6, ((struct sockaddr_in6 *)res->ai_addr)->sin6_addr.s6_addr);
+  } else {
+    aResult = IPAddress(((struct sockaddr_in *)res->ai_addr)->sin_addr.s_addr);
+  }
+  freeaddrinfo(res);
+  return 1;
+}
+
+size_t NetworkManager::printTo(Print &out) const {
+  return out.print("host network");
+}
+
+NetworkManager Network;
@@ -0,0 +1,36 @@
+/*
+ * Host implementations of the newlib extensions the core relies on that glibc
+ * does not have.
+ */
+
+#include "stdlib_noniso.h"
+
+// As newlib: bases 2 to 36, a negative value is signed in base 10 only and
+// in two's complement in the others
+char *utoa(unsigned int val, char *s, int radix) {
+  if (radix < 2 || radix > 36) {
+    *s = 0;
+    return NULL;
+  }
+  char digits[8 * sizeof(unsigned int)];
+  int n = 0;
+  do {
+    unsigned int digit = val % radix;
+    digits[n++] = (char)(digit < 10 ? '0' + digit : 'a' + digit - 10);
+    val /= radix;
+  } while (val);
+  for (int i = 0; i < n; i++) {
+    s[i] = digits[n - 1 - i];
+  }
+  s[n] = 0;
+  return s;
+}
+
+char *itoa(int val, char *s, int radix) {
+  if (val < 0 && radix == 10) {
+    *s = '-';
+    utoa(0U - (unsigned int)val, s + 1, radix);
+    return s;
+  }
+  return utoa((unsigned int)val, s, radix);
+}
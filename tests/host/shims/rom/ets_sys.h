@@ -0,0 +1,9 @@
+/*
+ * Host build stand-in for rom/ets_sys.h.
+ */
+
+#pragma once
+
+#include <stdio.h>
+
+#define ets_printf printf
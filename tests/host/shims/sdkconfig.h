@@ -0,0 +1,12 @@
+/*
+ * Host build stand-in for the ESP-IDF generated sdkconfig.h.
+ * Only the options the host-compiled sources test for are defined here.
+ */
+
+#pragma once
+
+#define CONFIG_FREERTOS_HZ                                 1000
+#define CONFIG_FREERTOS_TASK_NOTIFICATION_ARRAY_ENTRIES    2
+#define CONFIG_ARDUHAL_LOG_DEFAULT_LEVEL                   0
+#define CONFIG_LWIP_IPV6                                   1
+#define CONFIG_TCP_MSS                                     1436
@@ -0,0 +1,10 @@
+/*
+ * Host build stand-in for soc/soc_caps.h. The host has none of the SoC
+ * peripherals, so no SOC_*_SUPPORTED capability is defined. The GPIO count
+ * and valid pin mask are those of the ESP32-P4, the largest GPIO matrix.
+ */
+
+#pragma once
+
+#define SOC_GPIO_PIN_COUNT       55
+#define SOC_GPIO_VALID_GPIO_MASK ((1ULL << SOC_GPIO_PIN_COUNT) - 1)
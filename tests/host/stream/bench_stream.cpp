@@ -0,0 +1,380 @@
+/*
+ * Stream parsing helpers over StreamString, and the IPAddress and base64
+ * conversions that sit next to them in request handling. findMulti() is also
+ * measured over long streams with many targets against the previous
+ * per-target backtracking search (legacyFindMulti()). The sendAvailable() transfer
+ * is measured over its peek, lending and bounce buffer paths against the
+ * previous NetworkClient::write(Stream &) loop.
+ */
+
+#include <string>
+#include <vector>
+#include <bench.h>
+#include "base64.h"
+#include "IPAddress.h"
+#include "StreamString.h"
+
+static void refill(StreamString &stream, const String &text) {
+  stream.clear();
+  stream.concat(text);
+}
+
+// An HTTP request head with range(0) headers before the one that is searched for
+static String request_head(int64_t headers) {
+  String head = "GET /index.html HTTP/1.1\r\n";
+  for (int64_t i = 0; i < headers; i++) {
+    head += "X-Header-";
+    head += (int)i;
+    head += ": some value that does not matter\r\n";
+  }
+  head += "Content-Length: 1234\r\n\r\n";
+  return head;
+}
+
+static void BM_StreamFind(BenchState &state) {
+  String head = request_head(state.range(0));
+  StreamString stream;
+  stream.setTimeout(0);
+  for (auto _ : state) {
+    refill(stream, head);
+    benchDoNotOptimize(stream.find("Content-Length: "));
+  }
+  state.setBytesProcessed(state.iterations() * head.length());
+}
+BENCHMARK(BM_StreamFind)->Arg(4)->Arg(32);
+
+static void BM_StreamFindUntil(BenchState &state) {
+  String head = request_head(state.range(0));
+  StreamString stream;
+  stream.setTimeout(0);
+  for (auto _ : state) {
+    refill(stream, head);
+    benchDoNotOptimize(stream.findUntil("Missing: ", "\r\n\r\n"));
+  }
+  state.setBytesProcessed(state.iterations() * head.length());
+}
+BENCHMARK(BM_StreamFindUntil)->Arg(4)->Arg(32);
+
+static void BM_StreamReadStringUntil(BenchState &state) {
+  String head = request_head(state.range(0));
+  StreamString stream;
+  stream.setTimeout(0);
+  for (auto _ : state) {
+    refill(stream, head);
+    while (stream.available()) {
+      benchDoNotOptimize(stream.readStringUntil('\n').length());
+    }
+  }
+  state.setBytesProcessed(state.iterations() * head.length());
+}
+BENCHMARK(BM_StreamReadStringUntil)->Arg(4)->Arg(32);
+
+static void BM_StreamReadBytes(BenchState &state) {
+  String data;
+  while (data.length() < (unsigned)state.range(0)) {
+    data += "0123456789abcdef";
+  }
+  char buf[512];
+  StreamString stream;
+  stream.setTimeout(0);
+  for (auto _ : state) {
+    refill(stream, data);
+    while (stream.available()) {
+      benchDoNotOptimize(stream.readBytes(buf, sizeof(buf)));
+    }
+  }
+  state.setBytesProcessed(state.iterations() * data.length());
+}
+BENCHMARK(BM_StreamReadBytes)->Arg(1024)->Arg(16384);
+
+static void BM_StreamParseInt(BenchState &state) {
+  StreamString stream;
+  stream.setTimeout(0);
+  for (auto _ : state) {
+    refill(stream, "value=-123456, next=789");
+    benchDoNotOptimize(stream.parseInt());
+    benchDoNotOptimize(stream.parseInt());
+  }
+}
+BENCHMARK(BM_StreamParseInt);
+
+// A stream over memory with constant time reads and a bulk readBytes(), like
+// the receive buffers of NetworkClient and HardwareSerial
+class MemoryStream : public Stream {
+public:
+  std::string data;
+  size_t pos = 0;
+  using Stream::findMulti;
+  using Stream::MultiTarget;
+
+  int available() override {
+    return data.size() - pos;
+  }
+  int read() override {
+    return pos < data.size() ? (uint8_t)data[pos++] : -1;
+  }
+  int peek() override {
+    return pos < data.size() ? (uint8_t)data[pos] : -1;
+  }
+  size_t readBytes(char *buffer, size_t length) override {
+    size_t n = std::min(length, data.size() - pos);
+    memcpy(buffer, data.data() + pos, n);
+    pos += n;
+    return n;
+  }
+  size_t write(uint8_t) override {
+    return 0;
+  }
+
+  // Previous Stream::findMulti()
+  int legacyFindMulti(struct MultiTarget *targets, int tCount) {
+    for (struct MultiTarget *t = targets; t < targets + tCount; ++t) {
+      if (t->len <= 0) {
+        return t - targets;
+      }
+    }
+    while (1) {
+      int c = timedRead();
+      if (c < 0) {
+        return -1;
+      }
+      for (struct MultiTarget *t = targets; t < targets + tCount; ++t) {
+        if ((char)c == t->str[t->index]) {
+          if (++t->index == t->len) {
+            return t - targets;
+          } else {
+            continue;
+          }
+        }
+        if (t->index == 0) {
+          continue;
+        }
+        int origIndex = t->index;
+        do {
+          --t->index;
+          if ((char)c != t->str[t->index]) {
+            continue;
+          }
+          if (t->index == 0) {
+            t->index++;
+            break;
+          }
+          int diff = origIndex - t->index;
+          size_t i;
+          for (i = 0; i < t->index; ++i) {
+            if (t->str[i] != t->str[i + diff]) {
+              break;
+            }
+          }
+          if (i == t->index) {
+            t->index++;
+            break;
+          }
+        } while (t->index);
+      }
+    }
+  }
+};
+
+// range(0) modem responses to wait for, and 16 KiB of traffic before the one
+// that arrives. Some of the traffic shares prefixes with the targets.
+struct ModemTraffic {
+  std::vector<std::string> targets;
+  std::vector<MemoryStream::MultiTarget> multi;
+  std::string data;
+
+  explicit ModemTraffic(int64_t count) {
+    static const char *const responses[] = {"OK\r\n", "ERROR\r\n", "NO CARRIER\r\n", "BUSY\r\n", "NO ANSWER\r\n", "+CME ERROR: ", "+CMS ERROR: ", "CONNECT "};
+    for (int64_t i = 0; i < count; i++) {
+      targets.push_back(std::string(responses[i % 8]) + (i >= 8 ? std::to_string(i) : std::string()));
+    }
+    while (data.size() < 16384) {
+      data += "+CSQ: 23,99\r\n+CREG: 0,5\r\nNO DIALTONE\r\n+CMTI: \"SM\",3\r\nCONNECTING\r\n";
+    }
+    data += targets.back();
+    for (std::string &target : targets) {
+      multi.push_back({target.c_str(), target.size(), 0});
+    }
+  }
+
+  void reset() {
+    for (MemoryStream::MultiTarget &t : multi) {
+      t.index = 0;
+    }
+  }
+};
+
+static void BM_StreamFindMulti(BenchState &state) {
+  ModemTraffic traffic(state.range(0));
+  MemoryStream stream;
+  stream.setTimeout(0);
+  stream.data = traffic.data;
+  for (auto _ : state) {
+    stream.pos = 0;
+    benchDoNotOptimize(stream.findMulti(traffic.multi.data(), traffic.multi.size()));
+  }
+  state.setBytesProcessed(state.iterations() * traffic.data.size());
+}
+BENCHMARK(BM_StreamFindMulti)->Arg(1)->Arg(8)->Arg(32);
+
+static void BM_LegacyFindMulti(BenchState &state) {
+  ModemTraffic traffic(state.range(0));
+  MemoryStream stream;
+  stream.setTimeout(0);
+  stream.data = traffic.data;
+  for (auto _ : state) {
+    stream.pos = 0;
+    traffic.reset();
+    benchDoNotOptimize(stream.legacyFindMulti(traffic.multi.data(), traffic.multi.size()));
+  }
+  state.setBytesProcessed(state.iterations() * traffic.data.size());
+}
+BENCHMARK(BM_LegacyFindMulti)->Arg(1)->Arg(8)->Arg(32);
+
+// A MemoryStream that also shows its data, like NetworkClient and StreamString
+class PeekMemoryStream : public MemoryStream {
+public:
+  bool hasPeekBufferAPI() const override {
+    return true;
+  }
+  size_t peekAvailable() override {
+    return data.size() - pos;
+  }
+  const char *peekBuffer() override {
+    return data.data() + pos;
+  }
+  void peekConsume(size_t consume) override {
+    pos += consume;
+  }
+  bool inputCanTimeout() override {
+    return false;
+  }
+};
+
+// A sink copying into a segment sized transmit buffer, like a socket send
+// buffer. With lend set it also hands that buffer out.
+class SegmentPrint : public Print {
+public:
+  uint8_t segment[1460];
+  size_t used = 0;
+  bool lend;
+  explicit SegmentPrint(bool lend) : lend(lend) {}
+
+  size_t write(uint8_t c) override {
+    return write(&c, 1);
+  }
+  size_t write(const uint8_t *buffer, size_t size) override {
+    size_t done = 0;
+    while (done < size) {
+      size_t n = std::min(size - done, sizeof(segment) - used);
+      memcpy(segment + used, buffer + done, n);
+      commit(n);
+      done += n;
+    }
+    return size;
+  }
+  uint8_t *writeBuffer(size_t &room) override {
+    room = lend ? sizeof(segment) - used : 0;
+    return lend ? segment + used : nullptr;
+  }
+  bool writeCommit(size_t size) override {
+    commit(size);
+    return true;
+  }
+
+private:
+  void commit(size_t size) {
+    used += size;
+    if (used == sizeof(segment)) {
+      benchDoNotOptimize(segment[0]);
+      used = 0;
+    }
+  }
+};
+
+// Previous NetworkClient::write(Stream &)
+static size_t legacy_write_stream(Print &to, Stream &stream) {
+  uint8_t *buf = (uint8_t *)malloc(1360);
+  if (!buf) {
+    return 0;
+  }
+  size_t toRead = 0, toWrite = 0, written = 0;
+  size_t available = stream.available();
+  while (available) {
+    toRead = (available > 1360) ? 1360 : available;
+    toWrite = stream.readBytes(buf, toRead);
+    written += to.write(buf, toWrite);
+    available = stream.available();
+  }
+  free(buf);
+  return written;
+}
+
+template<typename Source> static void send_available(BenchState &state, bool lend) {
+  Source stream;
+  stream.data.assign(state.range(0), 'x');
+  SegmentPrint to(lend);
+  for (auto _ : state) {
+    stream.pos = 0;
+    benchDoNotOptimize(stream.sendAvailable(to));
+  }
+  state.setBytesProcessed(state.iterations() * stream.data.size());
+}
+
+static void BM_StreamSendAvailablePeek(BenchState &state) {
+  send_available<PeekMemoryStream>(state, false);
+}
+BENCHMARK(BM_StreamSendAvailablePeek)->Arg(1024)->Arg(65536);
+
+static void BM_StreamSendAvailableLend(BenchState &state) {
+  send_available<MemoryStream>(state, true);
+}
+BENCHMARK(BM_StreamSendAvailableLend)->Arg(1024)->Arg(65536);
+
+static void BM_StreamSendAvailableBounce(BenchState &state) {
+  send_available<MemoryStream>(state, false);
+}
+BENCHMARK(BM_StreamSendAvailableBounce)->Arg(1024)->Arg(65536);
+
+static void BM_LegacyWriteStream(BenchState &state) {
+  MemoryStream stream;
+  stream.data.assign(state.range(0), 'x');
+  SegmentPrint to(false);
+  for (auto _ : state) {
+    stream.pos = 0;
+    benchDoNotOptimize(legacy_write_stream(to, stream));
+  }
+  state.setBytesProcessed(state.iterations() * stream.data.size());
+}
+BENCHMARK(BM_LegacyWriteStream)->Arg(1024)->Arg(65536);
+
+static void BM_IPAddressFromString(BenchState &state) {
+  const char *text = state.range(0) == 4 ? "192.168.100.254" : "2001:db8:85a3::8a2e:370:7334";
+  IPAddress ip;
+  for (auto _ : state) {
+    benchDoNotOptimize(ip.fromString(text));
+  }
+}
+BENCHMARK(BM_IPAddressFromString)->Arg(4)->Arg(6);
+
+static void BM_IPAddressToString(BenchState &state) {
+  IPAddress ip(state.range(0) == 4 ? "192.168.100.254" : "2001:db8:85a3::8a2e:370:7334");
+  for (auto _ : state) {
+    benchDoNotOptimize(ip.toString().length());
+  }
+}
+BENCHMARK(BM_IPAddressToString)->Arg(4)->Arg(6);
+
+static void BM_Base64Encode(BenchState &state) {
+  uint8_t data[4096];
+  for (size_t i = 0; i < sizeof(data); i++) {
+    data[i] = (uint8_t)(i * 31);
+  }
+  for (auto _ : state) {
+    benchDoNotOptimize(base64::encode(data, state.range(0)).length());
+  }
+  state.setBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Base64Encode)->Arg(24)->Arg(4096);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,369 @@
+/*
+ * Host tests for the Stream parsing helpers, run over StreamString, for
+ * findMulti() against a brute force search, and for the sendAll()/sendSize()
+ * transfers over each of their paths.
+ */
+
+#include <string>
+#include <vector>
+#include <unity.h>
+#include "StreamString.h"
+
+static StreamString s_stream;
+
+// exposes findMulti()
+class MultiStream : public StreamString {
+public:
+  using Stream::MultiTarget;
+  using Stream::findMulti;
+};
+
+// a stream without its own readBytes(), so blocks are read byte by byte
+class ByteStream : public Stream {
+public:
+  std::string data;
+  size_t pos = 0;
+  bool open = true;
+  using Stream::MultiTarget;
+  using Stream::findMulti;
+  bool inputCanTimeout() override {
+    return open;
+  }
+  int available() override {
+    return data.size() - pos;
+  }
+  int read() override {
+    return pos < data.size() ? (uint8_t)data[pos++] : -1;
+  }
+  int peek() override {
+    return pos < data.size() ? (uint8_t)data[pos] : -1;
+  }
+  size_t write(uint8_t) override {
+    return 0;
+  }
+};
+
+// a sink that lends its buffer a few bytes at a time
+class LendingPrint : public Print {
+public:
+  std::string data;
+  char lent[7];
+  size_t commits = 0;
+  size_t write(uint8_t c) override {
+    data += (char)c;
+    return 1;
+  }
+  size_t write(const uint8_t *buffer, size_t size) override {
+    data.append((const char *)buffer, size);
+    return size;
+  }
+  uint8_t *writeBuffer(size_t &room) override {
+    room = sizeof(lent);
+    return (uint8_t *)lent;
+  }
+  bool writeCommit(size_t size) override {
+    TEST_ASSERT_LESS_OR_EQUAL(sizeof(lent), size);
+    data.append(lent, size);
+    commits++;
+    return true;
+  }
+};
+
+// a sink that takes limit bytes and then fails
+class FailingPrint : public Print {
+public:
+  size_t limit;
+  size_t taken = 0;
+  FailingPrint(size_t limit) : limit(limit) {}
+  size_t write(uint8_t c) override {
+    return write(&c, 1);
+  }
+  size_t write(const uint8_t *buffer, size_t size) override {
+    size_t n = (size < limit - taken) ? size : limit - taken;
+    taken += n;
+    if (n < size) {
+      setWriteError();
+    }
+    return n;
+  }
+};
+
+// the first target to end in data, the lowest index on a tie, and where it ends
+static int reference_find(const std::string &data, const std::vector<std::string> &targets, size_t &end) {
+  for (end = 1; end <= data.size(); end++) {
+    for (size_t t = 0; t < targets.size(); t++) {
+      const std::string &target = targets[t];
+      if (target.size() <= end && data.compare(end - target.size(), target.size(), target) == 0) {
+        return t;
+      }
+    }
+  }
+  end = data.size();
+  return -1;
+}
+
+void setUp(void) {
+  s_stream.clear();
+  // every test ends with the stream drained, keep the timeout waits short
+  s_stream.setTimeout(5);
+}
+
+void tearDown(void) {}
+
+void test_stream_string_write_read(void) {
+  TEST_ASSERT_EQUAL(5, s_stream.print("hello"));
+  TEST_ASSERT_EQUAL(5, s_stream.available());
+  TEST_ASSERT_EQUAL('h', s_stream.peek());
+  TEST_ASSERT_EQUAL('h', s_stream.read());
+  char buf[8] = {};
+  TEST_ASSERT_EQUAL(4, s_stream.readBytes(buf, sizeof(buf)));
+  TEST_ASSERT_EQUAL_STRING("ello", buf);
+  TEST_ASSERT_EQUAL(0, s_stream.available());
+  TEST_ASSERT_EQUAL(-1, s_stream.read());
+}
+
+void test_stream_find(void) {
+  s_stream.print("GET /index.html HTTP/1.1\r\nHost: example\r\n\r\nbody");
+  TEST_ASSERT_TRUE(s_stream.find("HTTP/"));
+  TEST_ASSERT_EQUAL('1', s_stream.read());
+  // restarts correctly after a partial match
+  TEST_ASSERT_TRUE(s_stream.find("\r\n\r\n"));
+  TEST_ASSERT_EQUAL_STRING("body", s_stream.readString().c_str());
+  TEST_ASSERT_FALSE(s_stream.find("missing"));
+}
+
+void test_stream_find_overlapping_prefix(void) {
+  s_stream.print("aaab");
+  TEST_ASSERT_TRUE(s_stream.find("aab"));
+  s_stream.clear();
+  s_stream.print("abcabcabd!");
+  TEST_ASSERT_TRUE(s_stream.find("abcabd"));
+  TEST_ASSERT_EQUAL('!', s_stream.read());
+}
+
+void test_stream_find_until(void) {
+  s_stream.print("key=1;other=2\nnext=3");
+  TEST_ASSERT_TRUE(s_stream.findUntil("other=", "\n"));
+  TEST_ASSERT_EQUAL(2, s_stream.parseInt());
+  TEST_ASSERT_FALSE(s_stream.findUntil("other=", "\n"));
+  TEST_ASSERT_EQUAL_STRING("next=3", s_stream.readString().c_str());
+}
+
+void test_stream_find_multi(void) {
+  MultiStream stream;
+  stream.setTimeout(0);
+  stream.print("+CREG: 0,1\r\nNO CARRIER\r\nOK\r\n");
+  MultiStream::MultiTarget at[] = {{"OK\r\n", 4, 0}, {"ERROR\r\n", 7, 0}, {"NO CARRIER\r\n", 12, 0}, {"BUSY\r\n", 6, 0}};
+  TEST_ASSERT_EQUAL(2, stream.findMulti(at, 4));
+  TEST_ASSERT_EQUAL_STRING("OK\r\n", stream.c_str());
+  TEST_ASSERT_EQUAL(0, stream.findMulti(at, 4));
+  TEST_ASSERT_EQUAL(-1, stream.findMulti(at, 4));
+
+  // targets ending at the same byte report the lowest index
+  stream.print("xxabcxx");
+  MultiStream::MultiTarget tie[] = {{"bc", 2, 0}, {"abc", 3, 0}};
+  TEST_ASSERT_EQUAL(0, stream.findMulti(tie, 2));
+  stream.print("abc");
+  MultiStream::MultiTarget tie2[] = {{"abc", 3, 0}, {"bc", 2, 0}, {"abc", 3, 0}};
+  TEST_ASSERT_EQUAL(0, stream.findMulti(tie2, 3));
+  stream.clear();
+
+  // an empty target matches without reading
+  stream.print("abc");
+  MultiStream::MultiTarget empty[] = {{"abc", 3, 0}, {"", 0, 0}};
+  TEST_ASSERT_EQUAL(1, stream.findMulti(empty, 2));
+  TEST_ASSERT_EQUAL(3, stream.available());
+}
+
+// target sets too large for the automaton are searched the way they were before it
+void test_stream_find_multi_large(void) {
+  std::string large(70000, 'a');
+  large.back() = 'b';
+  ByteStream stream;
+  stream.setTimeout(0);
+  stream.data = "xx" + large.substr(0, 100) + large + "ab";
+  ByteStream::MultiTarget targets[] = {{large.c_str(), large.size(), 5}, {"ab", 2, 0}};
+  TEST_ASSERT_EQUAL(0, stream.findMulti(targets, 2));
+  TEST_ASSERT_EQUAL(2, stream.available());
+  TEST_ASSERT_EQUAL(1, stream.findMulti(targets, 2));
+  TEST_ASSERT_EQUAL(-1, stream.findMulti(targets, 2));
+}
+
+// random streams over a small alphabet, so that targets overlap a lot, against
+// a brute force search; both streams must stop right after the match
+void test_stream_find_multi_random(void) {
+  uint32_t seed = 7;
+  auto next = [&seed](uint32_t range) {
+    seed = seed * 1103515245 + 12345;
+    return (seed >> 8) % range;
+  };
+  for (int round = 0; round < 2000; round++) {
+    std::vector<std::string> targets(1 + next(round % 10 == 0 ? 40 : 5));
+    for (std::string &target : targets) {
+      target.resize(1 + next(round % 3 == 0 ? 24 : 6));
+      for (char &c : target) {
+        c = 'a' + next(3);
+      }
+    }
+    std::string data(next(300), 0);
+    for (char &c : data) {
+      c = 'a' + next(3);
+    }
+    std::vector<MultiStream::MultiTarget> multi;
+    for (const std::string &target : targets) {
+      multi.push_back({target.c_str(), target.size(), 0});
+    }
+    size_t end;
+    int expected = reference_find(data, targets, end);
+
+    MultiStream bulk;
+    bulk.setTimeout(0);
+    bulk.write((const uint8_t *)data.data(), data.size());
+    TEST_ASSERT_EQUAL(expected, bulk.findMulti(multi.data(), multi.size()));
+    TEST_ASSERT_EQUAL(data.size() - end, bulk.length());
+
+    ByteStream bytes;
+    bytes.setTimeout(0);
+    bytes.data = data;
+    TEST_ASSERT_EQUAL(expected, bytes.findMulti(multi.data(), multi.size()));
+    TEST_ASSERT_EQUAL(end, bytes.pos);
+  }
+}
+
+void test_stream_read_bytes_bulk(void) {
+  s_stream.print("0123456789");
+  char buf[16] = {};
+  TEST_ASSERT_EQUAL(4, s_stream.readBytes(buf, 4));
+  TEST_ASSERT_EQUAL_STRING("0123", buf);
+  // asks for more than there is, gets what there is after the timeout
+  TEST_ASSERT_EQUAL(6, s_stream.readBytes((uint8_t *)buf, sizeof(buf)));
+  TEST_ASSERT_EQUAL_MEMORY("456789", buf, 6);
+  TEST_ASSERT_EQUAL(0, s_stream.available());
+}
+
+void test_stream_read_until(void) {
+  s_stream.print("first line\nsecond\n");
+  char buf[32] = {};
+  TEST_ASSERT_EQUAL(10, s_stream.readBytesUntil('\n', buf, sizeof(buf)));
+  TEST_ASSERT_EQUAL_STRING("first line", buf);
+  TEST_ASSERT_EQUAL_STRING("second", s_stream.readStringUntil('\n').c_str());
+  TEST_ASSERT_EQUAL(0, s_stream.available());
+}
+
+void test_stream_parse_numbers(void) {
+  s_stream.print("x=-1234, y=56.25 z=1,000");
+  TEST_ASSERT_EQUAL(-1234, s_stream.parseInt());
+  TEST_ASSERT_EQUAL_DOUBLE(56.25, s_stream.parseFloat());
+  TEST_ASSERT_EQUAL(1000, s_stream.parseInt(SKIP_ALL, ','));
+  TEST_ASSERT_EQUAL(0, s_stream.parseInt());
+}
+
+static std::string pattern(size_t size) {
+  std::string data;
+  for (size_t i = 0; i < size; i++) {
+    data += (char)('a' + i % 23);
+  }
+  return data;
+}
+
+void test_stream_send_peek_buffer(void) {
+  std::string data = pattern(5000);
+  s_stream.print(data.c_str());
+  StreamString to;
+  TEST_ASSERT_EQUAL(1000, s_stream.sendSize(to, 1000));
+  TEST_ASSERT_TRUE(s_stream.getLastSendReport() == Stream::SendReport::Success);
+  TEST_ASSERT_EQUAL(4000, s_stream.sendAll(to));
+  TEST_ASSERT_TRUE(s_stream.getLastSendReport() == Stream::SendReport::Success);
+  TEST_ASSERT_EQUAL(0, s_stream.available());
+  TEST_ASSERT_TRUE(data == to.c_str());
+}
+
+void test_stream_send_bounce_buffer(void) {
+  ByteStream from;
+  from.data = pattern(5000);
+  from.open = false;
+  StreamString to;
+  TEST_ASSERT_EQUAL(3000, from.sendSize(to, 3000));
+  TEST_ASSERT_EQUAL(3000, from.pos);
+  TEST_ASSERT_EQUAL(2000, from.sendAvailable(to));
+  TEST_ASSERT_TRUE(from.data == to.c_str());
+  TEST_ASSERT_TRUE(from.getLastSendReport() == Stream::SendReport::Success);
+}
+
+void test_stream_send_lent_buffer(void) {
+  ByteStream from;
+  from.data = pattern(100);
+  from.open = false;
+  LendingPrint to;
+  TEST_ASSERT_EQUAL(100, from.sendAll(to));
+  TEST_ASSERT_TRUE(from.data == to.data);
+  TEST_ASSERT_EQUAL(15, to.commits);
+  // the peek path writes instead
+  LendingPrint peeked;
+  s_stream.print(from.data.c_str());
+  TEST_ASSERT_EQUAL(100, s_stream.sendAll(peeked));
+  TEST_ASSERT_TRUE(from.data == peeked.data);
+  TEST_ASSERT_EQUAL(0, peeked.commits);
+}
+
+void test_stream_send_until(void) {
+  s_stream.print("first line\nsecond\n");
+  StreamString to;
+  TEST_ASSERT_EQUAL(10, s_stream.sendUntil(to, '\n'));
+  TEST_ASSERT_EQUAL_STRING("first line", to.c_str());
+  TEST_ASSERT_EQUAL('s', s_stream.peek());
+  s_stream.clear();
+
+  ByteStream from;
+  from.data = "first line\nsecond";
+  from.open = false;
+  StreamString bytes;
+  TEST_ASSERT_EQUAL(10, from.sendUntil(bytes, '\n'));
+  TEST_ASSERT_EQUAL_STRING("first line", bytes.c_str());
+  TEST_ASSERT_EQUAL(11, from.pos);
+  TEST_ASSERT_EQUAL(6, from.sendUntil(bytes, '\n'));
+  TEST_ASSERT_TRUE(from.getLastSendReport() == Stream::SendReport::ShortOperation);
+}
+
+void test_stream_send_reports(void) {
+  StreamString to;
+  s_stream.print("short");
+  TEST_ASSERT_EQUAL(5, s_stream.sendSize(to, 100));
+  TEST_ASSERT_TRUE(s_stream.getLastSendReport() == Stream::SendReport::ShortOperation);
+
+  // a source that may still get data waits for the timeout
+  ByteStream from;
+  from.data = "waiting";
+  from.setTimeout(20);
+  unsigned long start = millis();
+  TEST_ASSERT_EQUAL(7, from.sendAll(to));
+  TEST_ASSERT_TRUE(from.getLastSendReport() == Stream::SendReport::TimedOut);
+  TEST_ASSERT_GREATER_OR_EQUAL(20, millis() - start);
+
+  FailingPrint failing(10);
+  s_stream.print(pattern(100).c_str());
+  TEST_ASSERT_EQUAL(10, s_stream.sendAll(failing));
+  TEST_ASSERT_TRUE(s_stream.getLastSendReport() == Stream::SendReport::WriteError);
+  TEST_ASSERT_EQUAL(90, s_stream.available());
+  s_stream.clear();
+}
+
+int main(void) {
+  UNITY_BEGIN();
+  RUN_TEST(test_stream_string_write_read);
+  RUN_TEST(test_stream_find);
+  RUN_TEST(test_stream_find_overlapping_prefix);
+  RUN_TEST(test_stream_find_until);
+  RUN_TEST(test_stream_find_multi);
+  RUN_TEST(test_stream_find_multi_random);
+  RUN_TEST(test_stream_find_multi_large);
+  RUN_TEST(test_stream_read_bytes_bulk);
+  RUN_TEST(test_stream_read_until);
+  RUN_TEST(test_stream_parse_numbers);
+  RUN_TEST(test_stream_send_peek_buffer);
+  RUN_TEST(test_stream_send_bounce_buffer);
+  RUN_TEST(test_stream_send_lent_buffer);
+  RUN_TEST(test_stream_send_until);
+  RUN_TEST(test_stream_send_reports);
+  return UNITY_END();
+}
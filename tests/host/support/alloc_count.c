@@ -0,0 +1,31 @@
+/*
+ * Counting wrappers installed with -Wl,--wrap, see alloc_count.h.
+ */
+
+#include <stddef.h>
+#include "alloc_count.h"
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+
+static uint64_t s_calls;
+
+uint64_t alloc_count(void) {
+  return __atomic_load_n(&s_calls, __ATOMIC_RELAXED);
+}
+
+void *__wrap_malloc(size_t size) {
+  __atomic_fetch_add(&s_calls, 1, __ATOMIC_RELAXED);
+  return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size) {
+  __atomic_fetch_add(&s_calls, 1, __ATOMIC_RELAXED);
+  return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size) {
+  __atomic_fetch_add(&s_calls, 1, __ATOMIC_RELAXED);
+  return __real_realloc(ptr, size);
+}
@@ -0,0 +1,21 @@
+/*
+ * Heap call counting for host benchmarks: executables built with
+ * `host_bench(... ALLOC_COUNT)` link malloc(), calloc() and realloc() through
+ * the counting wrappers in alloc_count.c, so allocations made by the core
+ * sources under test are seen too.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// malloc(), calloc() and realloc() calls made so far, from any thread
+uint64_t alloc_count(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,231 @@
+/*
+ * Minimal microbenchmark harness for the host build.
+ *
+ * Follows the Google Benchmark shape (a State object iterated with a range-for
+ * loop, optional bytes/items counters) without the external dependency:
+ *
+ *   static void BM_Something(BenchState &state) {
+ *     for (auto _ : state) {
+ *       doSomething(state.range(0));
+ *     }
+ *     state.setBytesProcessed(state.iterations() * state.range(0));
+ *   }
+ *   BENCHMARK(BM_Something)->Arg(64)->Arg(1024);
+ *   BENCHMARK_MAIN();
+ *
+ * Pass --quick to run every benchmark for a few iterations only (used by ctest
+ * as a smoke test), or --filter=<substring> to select benchmarks.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+
+class BenchState {
+public:
+  // Marked unused so that `for (auto _ : state)` does not warn about `_`
+  struct __attribute__((unused)) Value {};
+
+  struct Iterator {
+    BenchState *state;
+    uint64_t left;
+    bool operator!=(const Iterator &) const {
+      return left != 0;
+    }
+    void operator++() {
+      left--;
+    }
+    Value operator*() const {
+      return Value();
+    }
+  };
+
+  BenchState(uint64_t iterations, int64_t arg) : _iterations(iterations), _arg(arg) {}
+
+  Iterator begin() {
+    _start = std::chrono::steady_clock::now();
+    return Iterator{this, _iterations};
+  }
+  Iterator end() {
+    return Iterator{this, 0};
+  }
+
+  uint64_t iterations() const {
+    return _iterations;
+  }
+  int64_t range(int index = 0) const {
+    (void)index;
+    return _arg;
+  }
+  void setBytesProcessed(uint64_t bytes) {
+    _bytes = bytes;
+  }
+  void setItemsProcessed(uint64_t items) {
+    _items = items;
+  }
+  void setLabel(const char *label) {
+    _label = label;
+  }
+  // Custom counters, reported per iteration (e.g. allocations per call)
+  void setCounter(const char *name, double value) {
+    _counter_name = name;
+    _counter = value;
+  }
+
+  // Must be called once the loop is finished when the body needs the clock to
+  // stop before some teardown work; otherwise the harness stops it.
+  void stop() {
+    if (!_stopped) {
+      _elapsed = std::chrono::steady_clock::now() - _start;
+      _stopped = true;
+    }
+  }
+
+  double seconds() {
+    stop();
+    return std::chrono::duration<double>(_elapsed).count();
+  }
+
+  uint64_t bytes() const {
+    return _bytes;
+  }
+  uint64_t items() const {
+    return _items;
+  }
+  const char *label() const {
+    return _label;
+  }
+  const char *counterName() const {
+    return _counter_name;
+  }
+  double counter() const {
+    return _counter;
+  }
+
+private:
+  uint64_t _iterations;
+  int64_t _arg;
+  uint64_t _bytes = 0;
+  uint64_t _items = 0;
+  const char *_label = NULL;
+  const char *_counter_name = NULL;
+  double _counter = 0;
+  bool _stopped = false;
+  std::chrono::steady_clock::time_point _start;
+  std::chrono::steady_clock::duration _elapsed{};
+};
+
+typedef void (*BenchFunction)(BenchState &state);
+
+struct BenchEntry {
+  const char *name;
+  BenchFunction fn;
+  std::vector<int64_t> args;
+};
+
+inline std::vector<BenchEntry> &benchRegistry() {
+  static std::vector<BenchEntry> registry;
+  return registry;
+}
+
+class BenchRegistrar {
+public:
+  BenchRegistrar(const char *name, BenchFunction fn) : _index(benchRegistry().size()) {
+    benchRegistry().push_back({name, fn, {}});
+  }
+  BenchRegistrar *Arg(int64_t arg) {
+    benchRegistry()[_index].args.push_back(arg);
+    return this;
+  }
+
+private:
+  size_t _index;
+};
+
+#define BENCH_CONCAT2(a, b) a##b
+#define BENCH_CONCAT(a, b)  BENCH_CONCAT2(a, b)
+#define BENCHMARK(fn)       static BenchRegistrar *BENCH_CONCAT(bench_reg_, __LINE__) __attribute__((unused)) = (new BenchRegistrar(#fn, fn))
+
+inline void benchRunOne(const BenchEntry &entry, int64_t arg, bool has_arg, bool quick) {
+  char name[128];
+  if (has_arg) {
+    snprintf(name, sizeof(name), "%s/%lld", entry.name, (long long)arg);
+  } else {
+    snprintf(name, sizeof(name), "%s", entry.name);
+  }
+
+  // grow the iteration count until a run takes long enough to be meaningful
+  const double min_time = quick ? 0.0 : 0.2;
+  uint64_t iterations = 1;
+  while (true) {
+    BenchState state(iterations, arg);
+    entry.fn(state);
+    double secs = state.seconds();
+    if (secs >= min_time || iterations >= (1ULL << 40) || (quick && iterations >= 4)) {
+      double ns = secs * 1e9 / (double)iterations;
+      printf("%-48s %14.1f ns %12llu", name, ns, (unsigned long long)iterations);
+      if (state.bytes() && secs > 0) {
+        printf(" %10.2f MB/s", (double)state.bytes() / secs / 1e6);
+      }
+      if (state.items() && secs > 0) {
+        printf(" %10.2f M items/s", (double)state.items() / secs / 1e6);
+      }
+      if (state.counterName()) {
+        printf(" %s=%.2f", state.counterName(), state.counter());
+      }
+      if (state.label()) {
+        printf(" %s", state.label());
+      }
+      printf("\n");
+      return;
+    }
+    uint64_t next = (secs > 0) ? (uint64_t)((double)iterations * (min_time * 1.4) / secs) : iterations * 100;
+    if (next <= iterations) {
+      next = iterations * 2;
+    }
+    if (next > iterations * 100) {
+      next = iterations * 100;
+    }
+    iterations = next;
+  }
+}
+
+inline int benchMain(int argc, char **argv) {
+  bool quick = false;
+  const char *filter = NULL;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--quick") == 0) {
+      quick = true;
+    } else if (strncmp(argv[i], "--filter=", 9) == 0) {
+      filter = argv[i] + 9;
+    }
+  }
+  printf("%-48s %17s %12s\n", "Benchmark", "Time", "Iterations");
+  for (const BenchEntry &entry : benchRegistry()) {
+    if (filter && !strstr(entry.name, filter)) {
+      continue;
+    }
+    if (entry.args.empty()) {
+      benchRunOne(entry, 0, false, quick);
+    } else {
+      for (int64_t arg : entry.args) {
+        benchRunOne(entry, arg, true, quick);
+      }
+    }
+  }
+  return 0;
+}
+
+#define BENCHMARK_MAIN()            \
+  int main(int argc, char **argv) { \
+    return benchMain(argc, argv);   \
+  }
+
+// Keeps the compiler from optimizing away a value computed in a benchmark
+template<typename T> inline void benchDoNotOptimize(T const &value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
@@ -0,0 +1,139 @@
+/*
+ * Loopback TCP helpers for the host tests and benchmarks of the network
+ * libraries: a free port to start a server on, and a plain BSD socket peer for
+ * the library under test to talk to.
+ */
+
+#pragma once
+
+#include <errno.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <algorithm>
+#include <string>
+
+// A port nothing listens on right now
+static inline uint16_t loopback_free_port(void) {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  struct sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t len = sizeof(addr);
+  bind(fd, (struct sockaddr *)&addr, sizeof(addr));
+  getsockname(fd, (struct sockaddr *)&addr, &len);
+  close(fd);
+  return ntohs(addr.sin_port);
+}
+
+static inline int loopback_connect(uint16_t port) {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  struct sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = htons(port);
+  if (fd >= 0 && connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+// Listening socket on 127.0.0.1, *port is set to the port it was given
+static inline int loopback_listen(uint16_t *port) {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  struct sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t len = sizeof(addr);
+  if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 || listen(fd, 8) < 0) {
+    close(fd);
+    return -1;
+  }
+  getsockname(fd, (struct sockaddr *)&addr, &len);
+  *port = ntohs(addr.sin_port);
+  return fd;
+}
+
+static inline bool loopback_send(int fd, const std::string &data) {
+  size_t sent = 0;
+  while (sent < data.size()) {
+    ssize_t n = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return false;
+    }
+    sent += n;
+  }
+  return true;
+}
+
+// Everything the peer sends until it closes the connection
+static inline std::string loopback_receive_all(int fd) {
+  std::string data;
+  char buf[4096];
+  for (;;) {
+    ssize_t n = recv(fd, buf, sizeof(buf), 0);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return data;
+    }
+    data.append(buf, n);
+  }
+}
+
+// Reads one request or response head, up to and including the empty line
+static inline std::string loopback_receive_head(int fd) {
+  std::string data;
+  char c;
+  while (data.size() < 4 || data.compare(data.size() - 4, 4, "\r\n\r\n") != 0) {
+    ssize_t n = recv(fd, &c, 1, 0);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      break;
+    }
+    data += c;
+  }
+  return data;
+}
+
+// Reads one response with a Content-Length, what follows it is left unread
+static inline std::string loopback_receive_response(int fd) {
+  std::string data;
+  char buf[4096];
+  size_t end = std::string::npos;  // of the whole response, once the head is in
+  while (data.size() != end) {
+    ssize_t n = recv(fd, buf, sizeof(buf), MSG_PEEK);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      break;
+    }
+    size_t take = n;
+    if (end == std::string::npos) {
+      std::string seen = data + std::string(buf, n);
+      size_t head = seen.find("\r\n\r\n");
+      if (head != std::string::npos) {
+        size_t pos = seen.find("\r\nContent-Length: ");
+        end = head + 4 + (pos < head ? strtoul(seen.c_str() + pos + 18, NULL, 10) : 0);
+      }
+    }
+    if (end != std::string::npos) {
+      take = std::min(take, end - data.size());
+    }
+    n = recv(fd, buf, take, 0);
+    if (n <= 0) {
+      break;
+    }
+    data.append(buf, n);
+  }
+  return data;
+}
@@ -0,0 +1,123 @@
+/*
+ * Minimal subset of the Unity test framework for the host build.
+ *
+ * Only the macros used by the host tests are provided, with the same names and
+ * semantics as the Unity bundled with ESP-IDF, so the tests read like the ones
+ * under tests/validation.
+ */
+
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <setjmp.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void setUp(void);
+void tearDown(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+struct UnityHostState {
+  int tests;
+  int failures;
+  const char *current;
+  jmp_buf abort_frame;
+};
+
+static UnityHostState Unity;
+
+static inline void UNITY_BEGIN_impl(void) {
+  Unity.tests = 0;
+  Unity.failures = 0;
+}
+
+static inline void UnityHostFail(const char *file, int line, const char *msg) {
+  printf("%s:%d:%s:FAIL: %s\n", file, line, Unity.current, msg);
+  Unity.failures++;
+  longjmp(Unity.abort_frame, 1);
+}
+
+static inline void UnityHostRun(void (*fn)(void), const char *name) {
+  Unity.current = name;
+  Unity.tests++;
+  int failures = Unity.failures;
+  if (setjmp(Unity.abort_frame) == 0) {
+    setUp();
+    fn();
+  }
+  tearDown();
+  if (failures == Unity.failures) {
+    printf("%s:PASS\n", name);
+  }
+}
+
+static inline int UNITY_END_impl(void) {
+  printf("\n-----------------------\n%d Tests %d Failures 0 Ignored\n%s\n", Unity.tests, Unity.failures, Unity.failures ? "FAIL" : "OK");
+  return Unity.failures;
+}
+
+#define UNITY_BEGIN()    UNITY_BEGIN_impl()
+#define UNITY_END()      UNITY_END_impl()
+#define RUN_TEST(fn)     UnityHostRun(fn, #fn)
+#define TEST_FAIL_MESSAGE(msg) UnityHostFail(__FILE__, __LINE__, msg)
+
+#define TEST_ASSERT_MESSAGE(cond, msg) \
+  do {                                 \
+    if (!(cond)) {                     \
+      TEST_FAIL_MESSAGE(msg);          \
+    }                                  \
+  } while (0)
+#define TEST_ASSERT(cond)       TEST_ASSERT_MESSAGE((cond), #cond)
+#define TEST_ASSERT_TRUE(cond)  TEST_ASSERT_MESSAGE((cond), "Expected TRUE: " #cond)
+#define TEST_ASSERT_FALSE(cond) TEST_ASSERT_MESSAGE(!(cond), "Expected FALSE: " #cond)
+#define TEST_ASSERT_NULL(ptr)     TEST_ASSERT_MESSAGE((ptr) == NULL, "Expected NULL: " #ptr)
+#define TEST_ASSERT_NOT_NULL(ptr) TEST_ASSERT_MESSAGE((ptr) != NULL, "Expected not NULL: " #ptr)
+
+#define TEST_ASSERT_EQUAL_INT64(expected, actual)                                                               \
+  do {                                                                                                          \
+    long long _e = (long long)(expected), _a = (long long)(actual);                                             \
+    if (_e != _a) {                                                                                             \
+      char _m[128];                                                                                             \
+      snprintf(_m, sizeof(_m), "Expected %lld Was %lld (%s)", _e, _a, #actual);                                 \
+      TEST_FAIL_MESSAGE(_m);                                                                                    \
+    }                                                                                                           \
+  } while (0)
+#define TEST_ASSERT_EQUAL(expected, actual)        TEST_ASSERT_EQUAL_INT64(expected, actual)
+#define TEST_ASSERT_EQUAL_INT(expected, actual)    TEST_ASSERT_EQUAL_INT64(expected, actual)
+#define TEST_ASSERT_EQUAL_UINT(expected, actual)   TEST_ASSERT_EQUAL_INT64(expected, actual)
+#define TEST_ASSERT_EQUAL_UINT8(expected, actual)  TEST_ASSERT_EQUAL_INT64((uint8_t)(expected), (uint8_t)(actual))
+#define TEST_ASSERT_EQUAL_UINT32(expected, actual) TEST_ASSERT_EQUAL_INT64((uint32_t)(expected), (uint32_t)(actual))
+#define TEST_ASSERT_EQUAL_UINT64(expected, actual) TEST_ASSERT_EQUAL_INT64((uint64_t)(expected), (uint64_t)(actual))
+#define TEST_ASSERT_EQUAL_HEX8(expected, actual)   TEST_ASSERT_EQUAL_INT64((uint8_t)(expected), (uint8_t)(actual))
+#define TEST_ASSERT_EQUAL_HEX32(expected, actual)  TEST_ASSERT_EQUAL_INT64((uint32_t)(expected), (uint32_t)(actual))
+#define TEST_ASSERT_GREATER_THAN(threshold, actual) TEST_ASSERT_MESSAGE((actual) > (threshold), "Expected " #actual " > " #threshold)
+#define TEST_ASSERT_LESS_THAN(threshold, actual)    TEST_ASSERT_MESSAGE((actual) < (threshold), "Expected " #actual " < " #threshold)
+#define TEST_ASSERT_LESS_OR_EQUAL(threshold, actual) TEST_ASSERT_MESSAGE((actual) <= (threshold), "Expected " #actual " <= " #threshold)
+#define TEST_ASSERT_GREATER_OR_EQUAL(threshold, actual) TEST_ASSERT_MESSAGE((actual) >= (threshold), "Expected " #actual " >= " #threshold)
+
+// A function rather than a block with locals, so that temporaries such as
+// String(...).c_str() stay alive until the comparison is done, as with Unity
+static inline void UnityHostAssertEqualString(const char *_e, const char *_a, const char *file, int line) {
+  if (_e == NULL || _a == NULL || strcmp(_e, _a) != 0) {
+    char _m[1100];
+    snprintf(_m, sizeof(_m), "Expected \"%s\" Was \"%s\"", _e ? _e : "(null)", _a ? _a : "(null)");
+    UnityHostFail(file, line, _m);
+  }
+}
+#define TEST_ASSERT_EQUAL_STRING(expected, actual) UnityHostAssertEqualString((expected), (actual), __FILE__, __LINE__)
+
+#define TEST_ASSERT_EQUAL_MEMORY(expected, actual, len) \
+  TEST_ASSERT_MESSAGE(memcmp((expected), (actual), (len)) == 0, "Memory mismatch: " #actual)
+
+#define TEST_ASSERT_EQUAL_FLOAT(expected, actual) \
+  TEST_ASSERT_MESSAGE(fabsf((float)(expected) - (float)(actual)) <= 1e-5f * fmaxf(1.0f, fabsf((float)(expected))), "Expected " #expected " Was " #actual)
+#define TEST_ASSERT_EQUAL_DOUBLE(expected, actual) \
+  TEST_ASSERT_MESSAGE(fabs((double)(expected) - (double)(actual)) <= 1e-12 * fmax(1.0, fabs((double)(expected))), "Expected " #expected " Was " #actual)
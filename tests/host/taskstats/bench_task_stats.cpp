@@ -0,0 +1,95 @@
+/*
+ * What TaskLoadSampler costs: one sample of a typical task list (the loads
+ * are taken from a scripted source, so this is the sampler's own share,
+ * without uxTaskGetSystemState()), a query of every task over the whole ring
+ * and the JSON export.
+ */
+
+#include <bench.h>
+#include "freertos_stats.h"
+
+class NullPrint : public Print {
+public:
+  size_t bytes = 0;
+  size_t write(uint8_t c) override {
+    bytes++;
+    return 1;
+  }
+  size_t write(const uint8_t *buffer, size_t size) override {
+    bytes += size;
+    return size;
+  }
+};
+
+static task_stats_raw_t s_tasks[32];
+static uint64_t s_total;
+
+static size_t bench_source(task_stats_raw_t *out, size_t max, uint64_t *totalRunTime, void *arg) {
+  size_t count = (size_t)(intptr_t)arg;
+  s_total += 1000000;
+  for (size_t i = 0; i < count; i++) {
+    s_tasks[i].runTime += (i * 7919) % 50000;
+  }
+  count = count < max ? count : max;
+  memcpy(out, s_tasks, count * sizeof(task_stats_raw_t));
+  *totalRunTime = s_total;
+  return count;
+}
+
+static void init_tasks(void) {
+  for (size_t i = 0; i < 32; i++) {
+    s_tasks[i].number = i + 1;
+    snprintf(s_tasks[i].name, TASK_STATS_NAME_SIZE, "task%u", (unsigned)i);
+    s_tasks[i].stackFree = 1024;
+    s_tasks[i].core = i % 3 - 1;
+  }
+}
+
+static void BM_Sample(BenchState &state) {
+  TaskLoadSampler sampler;
+  sampler.setSource(bench_source, (void *)(intptr_t)state.range(0));
+  sampler.begin(0, 60, 32);
+  for (auto _ : state) {
+    sampler.sample();
+  }
+  state.stop();
+  task_stats_cost_t cost = sampler.cost();
+  state.setCounter("max_us", cost.maxUs);
+  state.setItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Sample)->Arg(8)->Arg(24)->Arg(32);
+
+static void BM_QueryAll(BenchState &state) {
+  TaskLoadSampler sampler;
+  sampler.setSource(bench_source, (void *)(intptr_t)24);
+  sampler.begin(0, state.range(0), 24);
+  for (int i = 0; i <= state.range(0); i++) {
+    sampler.sample();
+  }
+  task_load_t loads[24];
+  for (auto _ : state) {
+    benchDoNotOptimize(sampler.query(loads, 24));
+  }
+  state.setItemsProcessed(state.iterations() * 24);
+}
+BENCHMARK(BM_QueryAll)->Arg(10)->Arg(60)->Arg(240);
+
+static void BM_PrintJSON(BenchState &state) {
+  TaskLoadSampler sampler;
+  sampler.setSource(bench_source, (void *)(intptr_t)24);
+  sampler.begin(0, 60, 24);
+  for (int i = 0; i <= 60; i++) {
+    sampler.sample();
+  }
+  NullPrint out;
+  for (auto _ : state) {
+    sampler.printJSON(out);
+  }
+  state.setBytesProcessed(out.bytes);
+}
+BENCHMARK(BM_PrintJSON);
+
+int main(int argc, char **argv) {
+  init_tasks();
+  return benchMain(argc, argv);
+}
@@ -0,0 +1,271 @@
+/*
+ * Host tests for TaskLoadSampler, fed from a scripted source instead of the
+ * scheduler: loads per window, percentiles, tasks that come and go, the JSON
+ * and binary exports, and the background sampling task.
+ */
+
+#include <unity.h>
+#include <string>
+#include "freertos_stats.h"
+#include "StreamString.h"
+
+// Tasks whose run time grows by a set share of each period
+struct FakeScheduler {
+  task_stats_raw_t tasks[32];
+  uint32_t share[32];  // hundredths of a percent per period
+  size_t count = 0;
+  uint64_t total = 0;
+  size_t reads = 0;
+
+  void add(uint32_t number, const char *name, uint32_t load, int16_t core = -1) {
+    task_stats_raw_t &t = tasks[count];
+    memset(&t, 0, sizeof(t));
+    t.number = number;
+    strncpy(t.name, name, TASK_STATS_NAME_SIZE - 1);
+    t.stackFree = 1000 + number;
+    t.core = core;
+    t.priority = (uint8_t)number;
+    share[count++] = load;
+  }
+  void remove(uint32_t number) {
+    for (size_t i = 0; i < count; i++) {
+      if (tasks[i].number == number) {
+        tasks[i] = tasks[count - 1];
+        share[i] = share[count - 1];
+        count--;
+        return;
+      }
+    }
+  }
+  void set(uint32_t number, uint32_t load) {
+    for (size_t i = 0; i < count; i++) {
+      if (tasks[i].number == number) {
+        share[i] = load;
+      }
+    }
+  }
+  // one period of 1000 counter ticks
+  void advance() {
+    total += 1000000;
+    for (size_t i = 0; i < count; i++) {
+      tasks[i].runTime += (uint64_t)share[i] * 100;
+    }
+  }
+
+  static size_t source(task_stats_raw_t *out, size_t max, uint64_t *totalRunTime, void *arg) {
+    FakeScheduler *s = (FakeScheduler *)arg;
+    s->reads++;
+    size_t n = s->count < max ? s->count : max;
+    memcpy(out, s->tasks, n * sizeof(task_stats_raw_t));
+    *totalRunTime = s->total;
+    return n;
+  }
+};
+
+static const task_load_t *find(const task_load_t *loads, size_t count, uint32_t number) {
+  for (size_t i = 0; i < count; i++) {
+    if (loads[i].number == number) {
+      return &loads[i];
+    }
+  }
+  return nullptr;
+}
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_task_stats_loads_and_window(void) {
+  FakeScheduler sched;
+  sched.add(1, "loopTask", 2500, 1);
+  sched.add(2, "IDLE0", 7500, 0);
+  TaskLoadSampler sampler;
+  sampler.setSource(FakeScheduler::source, &sched);
+  TEST_ASSERT_TRUE(sampler.begin(0, 10, 8));
+
+  // the first sample only sets the starting counters
+  TEST_ASSERT_TRUE(sampler.sample());
+  task_load_t loads[8];
+  TEST_ASSERT_EQUAL(2, sampler.query(loads, 8));
+  TEST_ASSERT_EQUAL(0, loads[0].samples);
+
+  for (int i = 0; i < 15; i++) {
+    sched.advance();
+    TEST_ASSERT_TRUE(sampler.sample());
+  }
+  TEST_ASSERT_EQUAL(2, sampler.query(loads, 8));
+  const task_load_t *loop = find(loads, 2, 1);
+  TEST_ASSERT_NOT_NULL(loop);
+  TEST_ASSERT_EQUAL_STRING("loopTask", loop->name);
+  TEST_ASSERT_EQUAL(10, loop->samples);  // the ring keeps 10
+  TEST_ASSERT_EQUAL_FLOAT(25.0f, loop->average);
+  TEST_ASSERT_EQUAL_FLOAT(25.0f, loop->max);
+  TEST_ASSERT_EQUAL(1, loop->core);
+  TEST_ASSERT_EQUAL(1001, loop->stackFree);
+  TEST_ASSERT_EQUAL_FLOAT(75.0f, find(loads, 2, 2)->p99);
+
+  // a burst shows in the short window and the upper percentiles
+  sched.set(1, 9000);
+  sched.advance();
+  sampler.sample();
+  task_load_t one;
+  TEST_ASSERT_TRUE(sampler.query(1, one, 1));
+  TEST_ASSERT_EQUAL(1, one.samples);
+  TEST_ASSERT_EQUAL_FLOAT(90.0f, one.average);
+  TEST_ASSERT_TRUE(sampler.query(1, one));
+  TEST_ASSERT_EQUAL(10, one.samples);
+  TEST_ASSERT_EQUAL_FLOAT(31.5f, one.average);
+  TEST_ASSERT_EQUAL_FLOAT(25.0f, one.p50);
+  TEST_ASSERT_EQUAL_FLOAT(25.0f, one.p90);
+  TEST_ASSERT_EQUAL_FLOAT(90.0f, one.p99);
+  TEST_ASSERT_EQUAL_FLOAT(90.0f, one.max);
+  TEST_ASSERT_FALSE(sampler.query(99, one));
+  sampler.end();
+}
+
+void test_task_stats_tasks_come_and_go(void) {
+  FakeScheduler sched;
+  sched.add(1, "main", 1000);
+  TaskLoadSampler sampler;
+  sampler.setSource(FakeScheduler::source, &sched);
+  TEST_ASSERT_TRUE(sampler.begin(0, 8, 2));
+  sampler.sample();
+  sched.advance();
+  sampler.sample();
+
+  // a new task starts counting from the next sample, past maxTasks are not tracked
+  sched.add(7, "worker", 5000);
+  sched.add(8, "extra", 100);
+  sched.advance();
+  sampler.sample();
+  task_load_t loads[4];
+  TEST_ASSERT_EQUAL(2, sampler.query(loads, 4));
+  TEST_ASSERT_EQUAL(0, find(loads, 2, 7)->samples);
+  TEST_ASSERT_EQUAL(2, find(loads, 2, 1)->samples);
+  sched.advance();
+  sampler.sample();
+  task_load_t worker;
+  TEST_ASSERT_TRUE(sampler.query(7, worker));
+  TEST_ASSERT_EQUAL(1, worker.samples);
+  TEST_ASSERT_EQUAL_FLOAT(50.0f, worker.average);
+
+  // an ended task frees its slot for the next one, which starts empty
+  sched.remove(7);
+  sched.advance();
+  sampler.sample();
+  TEST_ASSERT_FALSE(sampler.query(7, worker));
+  sched.advance();
+  sampler.sample();
+  task_load_t extra;
+  TEST_ASSERT_TRUE(sampler.query(8, extra));
+  TEST_ASSERT_EQUAL(0, extra.samples);
+  sched.advance();
+  sampler.sample();
+  TEST_ASSERT_TRUE(sampler.query(8, extra));
+  TEST_ASSERT_EQUAL(1, extra.samples);
+  TEST_ASSERT_EQUAL_FLOAT(1.0f, extra.average);
+}
+
+void test_task_stats_exports(void) {
+  FakeScheduler sched;
+  sched.add(3, "we\"b", 1234);
+  TaskLoadSampler sampler;
+  sampler.setSource(FakeScheduler::source, &sched);
+  TEST_ASSERT_TRUE(sampler.begin(0, 4, 4));
+  for (int i = 0; i < 3; i++) {
+    sampler.sample();
+    sched.advance();
+  }
+  StreamString json;
+  size_t len = sampler.printJSON(json);
+  TEST_ASSERT_EQUAL(json.length(), len);
+  TEST_ASSERT_EQUAL_STRING(
+    "{\"period\":0,\"depth\":4,\"samples\":3,\"tasks\":[{\"number\":3,\"name\":\"we\\\"b\",\"core\":-1,\"priority\":3,\"samples\":2,"
+    "\"average\":12.34,\"p50\":12.34,\"p90\":12.34,\"p99\":12.34,\"max\":12.34,\"stackFree\":1003}]}",
+    json.c_str()
+  );
+
+  StreamString bin;
+  TEST_ASSERT_EQUAL(7 + 38, sampler.writeBinary(bin, 2));
+  const uint8_t *b = (const uint8_t *)bin.c_str();
+  TEST_ASSERT_EQUAL('T', b[0]);
+  TEST_ASSERT_EQUAL('L', b[1]);
+  TEST_ASSERT_EQUAL(2, b[2]);
+  TEST_ASSERT_EQUAL(1, b[3] | b[4] << 8);
+  TEST_ASSERT_EQUAL(2, b[5] | b[6] << 8);
+  const uint8_t *r = b + 7;
+  TEST_ASSERT_EQUAL(3, r[0] | r[1] << 8 | r[2] << 16 | r[3] << 24);
+  TEST_ASSERT_EQUAL_STRING("we\"b", (const char *)r + 4);
+  TEST_ASSERT_EQUAL(0xff, r[20]);  // no affinity
+  TEST_ASSERT_EQUAL(3, r[21]);
+  TEST_ASSERT_EQUAL(2, r[22] | r[23] << 8);
+  TEST_ASSERT_EQUAL(1234, r[24] | r[25] << 8);
+  TEST_ASSERT_EQUAL(1003, r[34] | r[35] << 8 | r[36] << 16 | r[37] << 24);
+}
+
+// 300 tasks, more than a byte counts
+static size_t many_tasks(task_stats_raw_t *out, size_t max, uint64_t *totalRunTime, void *arg) {
+  uint32_t *reads = (uint32_t *)arg;
+  (*reads)++;
+  size_t n = max < 300 ? max : 300;
+  for (size_t i = 0; i < n; i++) {
+    memset(&out[i], 0, sizeof(out[i]));
+    out[i].number = i + 1;
+    out[i].runTime = (uint64_t)*reads * (i + 1);
+    out[i].core = -1;
+  }
+  *totalRunTime = (uint64_t)*reads * 1000000;
+  return n;
+}
+
+void test_task_stats_binary_many_tasks(void) {
+  uint32_t reads = 0;
+  TaskLoadSampler sampler;
+  sampler.setSource(many_tasks, &reads);
+  TEST_ASSERT_TRUE(sampler.begin(0, 4, 300));
+  sampler.sample();
+  sampler.sample();
+  StreamString bin;
+  TEST_ASSERT_EQUAL(7 + 300 * 38, sampler.writeBinary(bin));
+  const uint8_t *b = (const uint8_t *)bin.c_str();
+  TEST_ASSERT_EQUAL(300, b[3] | b[4] << 8);
+  sampler.end();
+}
+
+void test_task_stats_background_and_cost(void) {
+  FakeScheduler sched;
+  sched.add(1, "main", 1000);
+  TaskLoadSampler sampler;
+  sampler.setSource(FakeScheduler::source, &sched);
+  TEST_ASSERT_TRUE(sampler.begin(5, 16, 4));
+  for (int i = 0; i < 100 && sched.reads < 3; i++) {
+    delay(5);
+  }
+  sampler.end();
+  TEST_ASSERT_GREATER_OR_EQUAL(3, sched.reads);
+  task_stats_cost_t cost = sampler.cost();
+  TEST_ASSERT_EQUAL(sched.reads, cost.samples);
+  TEST_ASSERT_LESS_OR_EQUAL(cost.maxUs * cost.samples, cost.totalUs);
+  // stopped: nothing kept, nothing sampled
+  TEST_ASSERT_FALSE(sampler.sample());
+  task_load_t loads[4];
+  TEST_ASSERT_EQUAL(0, sampler.query(loads, 4));
+}
+
+void test_task_stats_scheduler_source(void) {
+  // the host has no run time stats, begin() says so
+  TaskLoadSampler sampler;
+  TEST_ASSERT_FALSE(sampler.begin(0));
+  TEST_ASSERT_FALSE(sampler.begin(0, 1));
+}
+
+int main(void) {
+  UNITY_BEGIN();
+  RUN_TEST(test_task_stats_loads_and_window);
+  RUN_TEST(test_task_stats_tasks_come_and_go);
+  RUN_TEST(test_task_stats_exports);
+  RUN_TEST(test_task_stats_binary_many_tasks);
+  RUN_TEST(test_task_stats_background_and_cost);
+  RUN_TEST(test_task_stats_scheduler_source);
+  return UNITY_END();
+}
@@ -0,0 +1,166 @@
+/*
+ * Ticker timer wheel cost on a simulated clock: moving one timer among N
+ * armed ones, against the sorted list esp_timer keeps its timers in (one
+ * esp_timer per Ticker before), and running N periodic tickers for ten
+ * seconds with and without a coalescing slack, counting the wakeups.
+ */
+
+#include <bench.h>
+#include "TickerWheel.h"
+
+// The esp_timer list: sorted by alarm time, inserting walks the list
+struct LegacyTimer {
+  LegacyTimer *next = nullptr;
+  LegacyTimer **pprev = nullptr;
+  uint64_t alarm = 0;
+  uint64_t period = 0;
+};
+
+class LegacyTimerList {
+public:
+  void start(LegacyTimer *timer, uint64_t alarm) {
+    stop(timer);
+    timer->alarm = alarm;
+    LegacyTimer **link = &_head;
+    while (*link && (*link)->alarm <= alarm) {
+      link = &(*link)->next;
+    }
+    timer->next = *link;
+    if (*link) {
+      (*link)->pprev = &timer->next;
+    }
+    *link = timer;
+    timer->pprev = link;
+  }
+  void stop(LegacyTimer *timer) {
+    if (timer->pprev) {
+      *timer->pprev = timer->next;
+      if (timer->next) {
+        timer->next->pprev = timer->pprev;
+      }
+      timer->pprev = nullptr;
+    }
+  }
+  LegacyTimer *expire(uint64_t now) {
+    LegacyTimer *timer = _head;
+    if (timer == nullptr || timer->alarm > now) {
+      return nullptr;
+    }
+    stop(timer);
+    if (timer->period) {
+      start(timer, timer->alarm + timer->period);
+    }
+    return timer;
+  }
+  uint64_t nextExpiry() const {
+    return _head ? _head->alarm : TICKER_WHEEL_NEVER;
+  }
+
+private:
+  LegacyTimer *_head = nullptr;
+};
+
+static uint64_t s_seed = 1;
+
+static uint64_t next_random(void) {
+  s_seed = s_seed * 6364136223846793005ULL + 1442695040888963407ULL;
+  return s_seed >> 33;
+}
+
+static void noop(void *arg) {
+  benchDoNotOptimize(arg);
+}
+
+static void BM_WheelReschedule(BenchState &state) {
+  size_t count = state.range(0);
+  TickerWheel wheel(0);
+  TickerWheelNode *nodes = new TickerWheelNode[count];
+  for (size_t i = 0; i < count; i++) {
+    nodes[i].callback = noop;
+    wheel.schedule(&nodes[i], 1000 + next_random() % 10000000);
+  }
+  for (auto _ : state) {
+    TickerWheelNode *node = &nodes[next_random() % count];
+    wheel.cancel(node);
+    wheel.schedule(node, 1000 + next_random() % 10000000);
+  }
+  state.setItemsProcessed(state.iterations());
+  delete[] nodes;
+}
+BENCHMARK(BM_WheelReschedule)->Arg(40)->Arg(400);
+
+static void BM_LegacyReschedule(BenchState &state) {
+  size_t count = state.range(0);
+  LegacyTimerList list;
+  LegacyTimer *timers = new LegacyTimer[count];
+  for (size_t i = 0; i < count; i++) {
+    list.start(&timers[i], 1000 + next_random() % 10000000);
+  }
+  for (auto _ : state) {
+    LegacyTimer *timer = &timers[next_random() % count];
+    list.stop(timer);
+    list.start(timer, 1000 + next_random() % 10000000);
+  }
+  state.setItemsProcessed(state.iterations());
+  delete[] timers;
+}
+BENCHMARK(BM_LegacyReschedule)->Arg(40)->Arg(400);
+
+// 40 tickers with periods from 10 ms to 1 s, arg is the slack in microseconds
+static void BM_WheelRun(BenchState &state) {
+  const size_t count = 40;
+  const uint64_t seconds = 10;
+  size_t runs = 0;
+  size_t wakeups = 0;
+  for (auto _ : state) {
+    TickerWheel wheel(0);
+    TickerWheelNode nodes[count];
+    for (size_t i = 0; i < count; i++) {
+      nodes[i].callback = noop;
+      nodes[i].period = 10000 + i * 24000 + i;
+      nodes[i].slack = state.range(0);
+      wheel.schedule(&nodes[i], nodes[i].period);
+    }
+    uint64_t next;
+    while ((next = wheel.nextExpiry()) <= seconds * 1000000) {
+      TickerWheelNode *node;
+      while ((node = wheel.expire(next)) != nullptr) {
+        node->callback(node->arg);
+        runs++;
+      }
+      wakeups++;
+    }
+  }
+  state.setItemsProcessed(runs);
+  state.setCounter("wakeups/s", (double)wakeups / state.iterations() / seconds);
+}
+BENCHMARK(BM_WheelRun)->Arg(0)->Arg(1000)->Arg(10000);
+
+static void BM_LegacyRun(BenchState &state) {
+  const size_t count = 40;
+  const uint64_t seconds = 10;
+  size_t runs = 0;
+  size_t wakeups = 0;
+  for (auto _ : state) {
+    LegacyTimerList list;
+    LegacyTimer timers[count];
+    for (size_t i = 0; i < count; i++) {
+      timers[i].period = 10000 + i * 24000 + i;
+      list.start(&timers[i], timers[i].period);
+    }
+    uint64_t next;
+    while ((next = list.nextExpiry()) <= seconds * 1000000) {
+      LegacyTimer *timer;
+      while ((timer = list.expire(next)) != nullptr) {
+        noop(timer);
+        runs++;
+      }
+      wakeups++;
+    }
+  }
+  state.setItemsProcessed(runs);
+  state.setCounter("wakeups/s", (double)wakeups / state.iterations() / seconds);
+}
+BENCHMARK(BM_LegacyRun);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,315 @@
+/*
+ * Host tests for the Ticker timer wheel on a simulated clock: exact firing
+ * ticks at every level, periodic timers, cancelling due and running timers,
+ * timers beyond the reach of the wheel, coalescing with slack, and random
+ * schedules against a sorted reference.
+ */
+
+#include <unity.h>
+#include <map>
+#include <set>
+#include <vector>
+#include "TickerWheel.h"
+
+struct Fired {
+  int id;
+  uint64_t at;
+};
+
+static std::vector<Fired> fired;
+
+static void record(void *arg) {
+  fired.push_back({(int)(intptr_t)arg, 0});
+}
+
+static void init_node(TickerWheelNode &node, int id, uint64_t period = 0, uint32_t slack = 0) {
+  node = TickerWheelNode();
+  node.callback = record;
+  node.arg = (void *)(intptr_t)id;
+  node.period = period;
+  node.slack = slack;
+}
+
+// Runs everything due at now, stamping the firings with the time
+static size_t run(TickerWheel &wheel, uint64_t now) {
+  size_t count = 0;
+  TickerWheelNode *node;
+  while ((node = wheel.expire(now)) != nullptr) {
+    node->callback(node->arg);
+    fired.back().at = now;
+    count++;
+  }
+  return count;
+}
+
+// Steps the clock from one expiry to the next until until
+static size_t run_until(TickerWheel &wheel, uint64_t until, size_t *wakeups = nullptr) {
+  size_t count = 0;
+  for (;;) {
+    uint64_t next = wheel.nextExpiry();
+    if (next > until) {
+      break;
+    }
+    count += run(wheel, next);
+    if (wakeups) {
+      (*wakeups)++;
+    }
+  }
+  return count;
+}
+
+void setUp(void) {
+  fired.clear();
+}
+
+void tearDown(void) {}
+
+void test_ticker_wheel_exact_ticks(void) {
+  const uint64_t start = 1234567;
+  const uint64_t deltas[] = {0, 1, 63, 64, 65, 4095, 4096, 4097, 262143, 262144, 1000000, 16777217, 3600000000ULL, 86400000000ULL};
+  const size_t count = sizeof(deltas) / sizeof(deltas[0]);
+  TickerWheel wheel(start);
+  TickerWheelNode nodes[count];
+  for (size_t i = 0; i < count; i++) {
+    init_node(nodes[i], (int)i);
+    wheel.schedule(&nodes[i], start + deltas[i]);
+  }
+  TEST_ASSERT_EQUAL(count, wheel.size());
+  TEST_ASSERT_EQUAL(start, wheel.nextExpiry());
+  TEST_ASSERT_EQUAL(count, run_until(wheel, start + deltas[count - 1]));
+  for (size_t i = 0; i < count; i++) {
+    TEST_ASSERT_EQUAL(i, fired[i].id);
+    TEST_ASSERT_EQUAL(start + deltas[i], fired[i].at);
+    TEST_ASSERT_FALSE(TickerWheel::pending(&nodes[i]));
+  }
+  TEST_ASSERT_EQUAL(0, wheel.size());
+  TEST_ASSERT_EQUAL(TICKER_WHEEL_NEVER, wheel.nextExpiry());
+}
+
+void test_ticker_wheel_not_early(void) {
+  // the clock moves one tick at a time across cascades of every level
+  TickerWheel wheel(0);
+  TickerWheelNode node;
+  const uint64_t deadlines[] = {64, 4096, 4100, 262144, 300000};
+  for (uint64_t deadline : deadlines) {
+    init_node(node, 1);
+    wheel.schedule(&node, deadline);
+    for (uint64_t t = deadline - 70; t < deadline; t++) {
+      TEST_ASSERT_EQUAL(0, run(wheel, t));
+    }
+    TEST_ASSERT_EQUAL(1, run(wheel, deadline));
+  }
+}
+
+void test_ticker_wheel_periodic(void) {
+  TickerWheel wheel(100);
+  TickerWheelNode fast, slow;
+  init_node(fast, 1, 1000);
+  init_node(slow, 2, 250000);
+  wheel.schedule(&fast, 100 + 1000);
+  wheel.schedule(&slow, 100 + 250000);
+  TEST_ASSERT_EQUAL(1000 + 4, run_until(wheel, 100 + 1000000));
+  int fastCount = 0;
+  int slowCount = 0;
+  for (const Fired &f : fired) {
+    if (f.id == 1) {
+      fastCount++;
+      TEST_ASSERT_EQUAL(100 + fastCount * 1000ULL, f.at);
+    } else {
+      slowCount++;
+      TEST_ASSERT_EQUAL(100 + slowCount * 250000ULL, f.at);
+    }
+  }
+  TEST_ASSERT_EQUAL(1000, fastCount);
+  TEST_ASSERT_EQUAL(4, slowCount);
+  TEST_ASSERT_TRUE(TickerWheel::pending(&fast));
+  TEST_ASSERT_EQUAL(100 + 1001000, wheel.nextExpiry());
+}
+
+void test_ticker_wheel_late_clock(void) {
+  // a clock that jumps past several periods fires each one
+  TickerWheel wheel(0);
+  TickerWheelNode node, once;
+  init_node(node, 1, 100);
+  init_node(once, 2);
+  wheel.schedule(&node, 100);
+  wheel.schedule(&once, 5000);
+  TEST_ASSERT_EQUAL(10, run(wheel, 1000));
+  TEST_ASSERT_EQUAL(1100, wheel.nextExpiry());
+  TEST_ASSERT_EQUAL(41, run(wheel, 5000));
+  TEST_ASSERT_EQUAL(5100, wheel.nextExpiry());
+  TEST_ASSERT_FALSE(TickerWheel::pending(&once));
+}
+
+void test_ticker_wheel_cancel(void) {
+  TickerWheel wheel(0);
+  TickerWheelNode a, b, c;
+  init_node(a, 1);
+  init_node(b, 2);
+  init_node(c, 3, 10);
+  wheel.schedule(&a, 500);
+  wheel.schedule(&b, 500);
+  wheel.schedule(&c, 10);
+  wheel.cancel(&a);
+  wheel.cancel(&a);
+  TEST_ASSERT_FALSE(TickerWheel::pending(&a));
+  TEST_ASSERT_EQUAL(2, wheel.size());
+  // the periodic one cancelled from its own callback
+  TickerWheelNode *node = wheel.expire(10);
+  TEST_ASSERT_TRUE(node == &c);
+  TEST_ASSERT_TRUE(TickerWheel::pending(&c));
+  wheel.cancel(&c);
+  TEST_ASSERT_NULL(wheel.expire(10));
+  TEST_ASSERT_EQUAL(500, wheel.nextExpiry());
+  // rescheduling moves the node
+  wheel.schedule(&b, 700);
+  TEST_ASSERT_EQUAL(0, run(wheel, 699));
+  TEST_ASSERT_EQUAL(1, run(wheel, 700));
+}
+
+void test_ticker_wheel_cancel_due(void) {
+  // two nodes on one tick, the first one run cancels the other
+  TickerWheel wheel(0);
+  TickerWheelNode a, b;
+  init_node(a, 1);
+  init_node(b, 2);
+  wheel.schedule(&a, 50);
+  wheel.schedule(&b, 50);
+  TickerWheelNode *first = wheel.expire(50);
+  TEST_ASSERT_NOT_NULL(first);
+  TickerWheelNode *other = first == &a ? &b : &a;
+  TEST_ASSERT_TRUE(TickerWheel::pending(other));
+  TEST_ASSERT_EQUAL(50, wheel.nextExpiry());
+  wheel.cancel(other);
+  TEST_ASSERT_NULL(wheel.expire(50));
+  TEST_ASSERT_EQUAL(0, wheel.size());
+}
+
+void test_ticker_wheel_beyond_reach(void) {
+  const uint64_t start = 5;
+  const uint64_t far = start + TICKER_WHEEL_MAX_DELTA * 2 + 12345;
+  TickerWheel wheel(start);
+  TickerWheelNode node, near;
+  init_node(node, 1);
+  init_node(near, 2);
+  wheel.schedule(&node, far);
+  wheel.schedule(&near, start + 10);
+  TEST_ASSERT_EQUAL(start + 10, wheel.nextExpiry());
+  TEST_ASSERT_EQUAL(1, run(wheel, start + 10));
+  TEST_ASSERT_EQUAL(far, wheel.nextExpiry());
+  TEST_ASSERT_EQUAL(0, run(wheel, start + TICKER_WHEEL_MAX_DELTA + 100));
+  TEST_ASSERT_EQUAL(0, run(wheel, far - 1));
+  TEST_ASSERT_EQUAL(1, run(wheel, far));
+  TEST_ASSERT_EQUAL(1, fired.back().id);
+}
+
+void test_ticker_wheel_slack(void) {
+  // 40 periodic jobs with periods from 1 s to 1.039 s over one minute, run
+  // on time and then with a slack of a tenth of the period
+  const int jobs = 40;
+  const uint64_t minute = 60000000;
+  size_t wakeups[2] = {0, 0};
+  size_t runs[2] = {0, 0};
+  for (int pass = 0; pass < 2; pass++) {
+    uint32_t slack = pass ? 100000 : 0;
+    TickerWheel wheel(0);
+    TickerWheelNode nodes[jobs];
+    for (int i = 0; i < jobs; i++) {
+      init_node(nodes[i], i, 1000000 + i * 1000, slack);
+      wheel.schedule(&nodes[i], nodes[i].period);
+    }
+    fired.clear();
+    runs[pass] = run_until(wheel, minute, &wakeups[pass]);
+    // every run within its window
+    std::vector<int> count(jobs, 0);
+    for (const Fired &f : fired) {
+      count[f.id]++;
+      uint64_t deadline = count[f.id] * (1000000ULL + f.id * 1000);
+      TEST_ASSERT_GREATER_OR_EQUAL(deadline, f.at);
+      TEST_ASSERT_LESS_OR_EQUAL(deadline + slack, f.at);
+    }
+  }
+  // the slack may take the last runs of some past the minute
+  TEST_ASSERT_GREATER_OR_EQUAL(runs[0] - jobs, runs[1]);
+  TEST_ASSERT_LESS_THAN(wakeups[0] / 3, wakeups[1]);
+}
+
+void test_ticker_wheel_random(void) {
+  // random schedules, cancels and clock steps against a sorted reference
+  const int count = 64;
+  TickerWheel wheel(1000);
+  TickerWheelNode nodes[count];
+  std::map<int, uint64_t> expected;  // id -> deadline
+  uint64_t now = 1000;
+  uint64_t seed = 42;
+  auto random = [&seed]() {
+    seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    return seed >> 33;
+  };
+  for (int i = 0; i < count; i++) {
+    init_node(nodes[i], i);
+  }
+  for (int step = 0; step < 20000; step++) {
+    int id = random() % count;
+    switch (random() % 4) {
+      case 0:
+      case 1:
+      {
+        // spread over every level
+        uint64_t delta = random() >> (random() % 31);
+        wheel.schedule(&nodes[id], now + delta);
+        expected[id] = now + delta;
+        break;
+      }
+      case 2:
+        wheel.cancel(&nodes[id]);
+        expected.erase(id);
+        break;
+      default:
+      {
+        uint64_t next = wheel.nextExpiry();
+        uint64_t reference = TICKER_WHEEL_NEVER;
+        for (auto &e : expected) {
+          reference = e.second < reference ? e.second : reference;
+        }
+        TEST_ASSERT_EQUAL(reference, next);
+        if (next == TICKER_WHEEL_NEVER) {
+          break;
+        }
+        // either to the next expiry or a random distance, which may skip several
+        now = (random() & 1) ? next : now + (random() >> (random() % 31));
+        fired.clear();
+        run(wheel, now);
+        std::set<int> due;
+        for (auto it = expected.begin(); it != expected.end();) {
+          if (it->second <= now) {
+            due.insert(it->first);
+            it = expected.erase(it);
+          } else {
+            ++it;
+          }
+        }
+        TEST_ASSERT_EQUAL(due.size(), fired.size());
+        for (const Fired &f : fired) {
+          TEST_ASSERT_TRUE(due.count(f.id) == 1);
+        }
+        break;
+      }
+    }
+    TEST_ASSERT_EQUAL(expected.size(), wheel.size());
+  }
+}
+
+int main(void) {
+  UNITY_BEGIN();
+  RUN_TEST(test_ticker_wheel_exact_ticks);
+  RUN_TEST(test_ticker_wheel_not_early);
+  RUN_TEST(test_ticker_wheel_periodic);
+  RUN_TEST(test_ticker_wheel_late_clock);
+  RUN_TEST(test_ticker_wheel_cancel);
+  RUN_TEST(test_ticker_wheel_cancel_due);
+  RUN_TEST(test_ticker_wheel_beyond_reach);
+  RUN_TEST(test_ticker_wheel_slack);
+  RUN_TEST(test_ticker_wheel_random);
+  return UNITY_END();
+}
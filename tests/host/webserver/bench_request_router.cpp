@@ -0,0 +1,172 @@
+/*
+ * WebServer request routing: the router against asking each handler
+ * canHandle() in turn, as the server did before, for REST APIs of 20 and 68
+ * routes (static paths, "{}" arguments and a glob tail) and requests spread
+ * over all of them. Both report the heap calls made per request.
+ */
+
+#include <stdlib.h>
+#include <new>
+#include <string>
+#include <vector>
+#include <bench.h>
+#include <alloc_count.h>
+#include "WebServer.h"
+#include "uri/UriBraces.h"
+#include "uri/UriGlob.h"
+
+// heap calls per iteration since `before`
+#define REPORT_ALLOCS(state, before) (state).setCounter("allocs/op", (double)(alloc_count() - (before)) / (state).iterations())
+
+// new goes through the counted malloc(), as on the target. GCC takes free()
+// in the replaced delete for a mismatch with new.
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+void *operator new(size_t size) {
+  void *p = malloc(size ? size : 1);
+  if (!p) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+void *operator new[](size_t size) {
+  return operator new(size);
+}
+void operator delete(void *p) noexcept {
+  free(p);
+}
+void operator delete[](void *p) noexcept {
+  free(p);
+}
+void operator delete(void *p, size_t) noexcept {
+  free(p);
+}
+void operator delete[](void *p, size_t) noexcept {
+  free(p);
+}
+
+static const char *RESOURCES[] = {"users",   "groups",  "devices", "sensors", "readings", "alarms",  "schedules", "scenes",
+                                  "rooms",   "zones",   "rules",   "logs",    "updates",  "backups", "tokens",    "networks"};
+
+// Routes with the router, or with the handlers asked in turn
+class RoutingServer : public WebServer {
+public:
+  RoutingServer(int resources) : WebServer(0) {
+    for (int i = 0; i < resources; i++) {
+      String base = String("/api/v1/") + RESOURCES[i];
+      on(base, HTTP_GET, nothing);
+      on(base, HTTP_POST, nothing);
+      on(UriBraces(base + "/{}"), HTTP_GET, nothing);
+      on(UriBraces(base + "/{}"), HTTP_DELETE, nothing);
+    }
+    on("/", nothing);
+    on("/api/v1/status", nothing);
+    on(UriBraces("/api/v1/{}/{}/history"), HTTP_GET, nothing);
+    on(UriGlob("/static/*"), nothing);
+  }
+  RequestHandler *route(HTTPMethod method, const String &uri) {
+    return _router.find(*this, _firstHandler, method, uri);
+  }
+  RequestHandler *first() {
+    return _firstHandler;
+  }
+  RequestHandler *scan(HTTPMethod method, const String &uri) {
+    for (RequestHandler *handler = _firstHandler; handler; handler = handler->next()) {
+      if (handler->canHandle(*this, method, uri)) {
+        return handler;
+      }
+    }
+    return nullptr;
+  }
+
+private:
+  static void nothing() {}
+};
+
+struct Request {
+  HTTPMethod method;
+  String uri;
+  int args;  // path arguments of its route
+};
+
+static std::vector<Request> make_requests(int resources) {
+  std::vector<Request> requests;
+  for (int i = 0; i < resources; i++) {
+    String base = String("/api/v1/") + RESOURCES[i];
+    requests.push_back({HTTP_GET, base, 0});
+    requests.push_back({HTTP_POST, base, 0});
+    requests.push_back({HTTP_GET, base + "/" + String(1000 + i), 1});
+    requests.push_back({HTTP_DELETE, base + "/" + String(i), 1});
+    requests.push_back({HTTP_GET, base + "/" + String(i) + "/history", 2});
+  }
+  requests.push_back({HTTP_GET, "/", 0});
+  requests.push_back({HTTP_GET, "/static/css/site.css", 0});
+  requests.push_back({HTTP_GET, "/api/v2/missing", 0});
+  return requests;
+}
+
+static void BM_Route(BenchState &state) {
+  RoutingServer server(state.range(0));
+  std::vector<Request> requests = make_requests(state.range(0));
+  for (const Request &request : requests) {
+    server.route(request.method, request.uri);
+  }
+  size_t next = 0;
+  uint64_t before = alloc_count();
+  for (auto _ : state) {
+    const Request &request = requests[next];
+    next = next + 1 == requests.size() ? 0 : next + 1;
+    benchDoNotOptimize(server.route(request.method, request.uri));
+  }
+  REPORT_ALLOCS(state, before);
+}
+BENCHMARK(BM_Route)->Arg(4)->Arg(16);
+
+static void BM_RouteLinear(BenchState &state) {
+  RoutingServer server(state.range(0));
+  std::vector<Request> requests = make_requests(state.range(0));
+  for (const Request &request : requests) {
+    server.scan(request.method, request.uri);
+  }
+  size_t next = 0;
+  uint64_t before = alloc_count();
+  for (auto _ : state) {
+    const Request &request = requests[next];
+    next = next + 1 == requests.size() ? 0 : next + 1;
+    benchDoNotOptimize(server.scan(request.method, request.uri));
+  }
+  REPORT_ALLOCS(state, before);
+}
+BENCHMARK(BM_RouteLinear)->Arg(4)->Arg(16);
+
+// Both find the same handler with the same path arguments
+static bool same_handlers() {
+  RoutingServer routed(16);
+  RoutingServer scanned(16);
+  for (const Request &request : make_requests(16)) {
+    RequestHandler *found = routed.route(request.method, request.uri);
+    RequestHandler *expected = scanned.scan(request.method, request.uri);
+    RequestHandler *a = routed.first();
+    RequestHandler *b = scanned.first();
+    while (a && a != found) {
+      a = a->next();
+      b = b->next();
+    }
+    if (b != expected) {
+      return false;
+    }
+    for (int i = 0; found && i < request.args; i++) {
+      if (found->pathArg(i) != expected->pathArg(i)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+int main(int argc, char **argv) {
+  if (!same_handlers()) {
+    fprintf(stderr, "the router and the handlers asked in turn do not agree\n");
+    return 1;
+  }
+  return benchMain(argc, argv);
+}
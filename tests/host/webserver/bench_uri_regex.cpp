@@ -0,0 +1,134 @@
+/*
+ * UriRegex matching with the pattern compiled once into a RegexMatcher
+ * program, against the previous UriRegex building a std::regex on each call,
+ * for a match with two path arguments, a miss and a match of a long tail.
+ * Both report the heap calls per request. Before running, the code size of
+ * a UriRegex compiled and matched is printed for each, from the read only
+ * sections of uri_regex_size_0 and uri_regex_size_1.
+ */
+
+#include <elf.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <new>
+#include <string>
+#include <vector>
+#include <bench.h>
+#include <alloc_count.h>
+#include "WebServer.h"
+#include "uri/UriRegex.h"
+#include "legacy_uri_regex.h"
+
+// heap calls per iteration since `before`
+#define REPORT_ALLOCS(state, before) (state).setCounter("allocs/op", (double)(alloc_count() - (before)) / (state).iterations())
+
+// new goes through the counted malloc(), as on the target. GCC takes free()
+// in the replaced delete for a mismatch with new.
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+void *operator new(size_t size) {
+  void *p = malloc(size ? size : 1);
+  if (!p) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+void *operator new[](size_t size) {
+  return operator new(size);
+}
+void operator delete(void *p) noexcept {
+  free(p);
+}
+void operator delete[](void *p) noexcept {
+  free(p);
+}
+void operator delete(void *p, size_t) noexcept {
+  free(p);
+}
+void operator delete[](void *p, size_t) noexcept {
+  free(p);
+}
+
+static const char *CASES[][2] = {
+  {"^\\/users\\/([0-9]+)\\/devices\\/([0-9]+)$", "/users/1234/devices/56"},
+  {"^\\/users\\/([0-9]+)\\/devices\\/([0-9]+)$", "/api/v1/status"},
+  {"/upload/(.*)", "/upload/firmware/esp32s3/release-2026-10/image.bin"},
+};
+
+template<typename T> static void run(BenchState &state) {
+  const char **test = CASES[state.range(0)];
+  T uri(test[0]);
+  std::vector<String> args;
+  uri.initPathArgs(args);
+  String path(test[1]);
+  uri.canHandle(path, args);
+  uint64_t before = alloc_count();
+  for (auto _ : state) {
+    benchDoNotOptimize(uri.canHandle(path, args));
+  }
+  REPORT_ALLOCS(state, before);
+  state.setBytesProcessed(state.iterations() * path.length());
+}
+
+static void BM_UriRegex(BenchState &state) {
+  run<UriRegex>(state);
+}
+BENCHMARK(BM_UriRegex)->Arg(0)->Arg(1)->Arg(2);
+
+static void BM_UriRegexLegacy(BenchState &state) {
+  run<LegacyUriRegex>(state);
+}
+BENCHMARK(BM_UriRegexLegacy)->Arg(0)->Arg(1)->Arg(2);
+
+// The bytes of the executable (text) and read only (flash) sections of an
+// ELF file, false if it cannot be read
+static bool code_size(const char *path, size_t &text, size_t &flash) {
+  FILE *file = fopen(path, "rb");
+  if (!file) {
+    return false;
+  }
+  Elf64_Ehdr header;
+  bool read = fread(&header, sizeof(header), 1, file) == 1 && memcmp(header.e_ident, ELFMAG, SELFMAG) == 0 && header.e_ident[EI_CLASS] == ELFCLASS64;
+  text = 0;
+  flash = 0;
+  for (int i = 0; read && i < header.e_shnum; i++) {
+    Elf64_Shdr section;
+    read = fseek(file, header.e_shoff + i * header.e_shentsize, SEEK_SET) == 0 && fread(&section, sizeof(section), 1, file) == 1;
+    if (read && (section.sh_flags & SHF_ALLOC) && !(section.sh_flags & SHF_WRITE) && section.sh_type != SHT_NOBITS) {
+      flash += section.sh_size;
+      if (section.sh_flags & SHF_EXECINSTR) {
+        text += section.sh_size;
+      }
+    }
+  }
+  fclose(file);
+  return read;
+}
+
+// Both match the cases alike
+static bool same_matches() {
+  for (auto &test : CASES) {
+    UriRegex compiled(test[0]);
+    LegacyUriRegex legacy(test[0]);
+    std::vector<String> compiledArgs;
+    std::vector<String> legacyArgs;
+    compiled.initPathArgs(compiledArgs);
+    legacy.initPathArgs(legacyArgs);
+    if (compiled.canHandle(test[1], compiledArgs) != legacy.canHandle(test[1], legacyArgs) || compiledArgs != legacyArgs) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int main(int argc, char **argv) {
+  if (!same_matches()) {
+    fprintf(stderr, "the matchers do not agree\n");
+    return 1;
+  }
+  size_t text[2];
+  size_t flash[2];
+  if (code_size(URI_REGEX_SIZE_COMPILED, text[0], flash[0]) && code_size(URI_REGEX_SIZE_LEGACY, text[1], flash[1])) {
+    printf("UriRegex code size: %zu B text, %zu B read only; with std::regex: %zu B text, %zu B read only\n", text[0], flash[0], text[1], flash[1]);
+  }
+  return benchMain(argc, argv);
+}
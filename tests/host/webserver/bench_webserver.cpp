@@ -0,0 +1,271 @@
+/*
+ * WebServer request handling cost over loopback TCP, one connection per
+ * request as the server closes it after the response. The request is queued
+ * in the socket before handleClient() runs, so a single thread drives both
+ * ends and the numbers include the accept/read/write/close system calls.
+ *
+ * The load benchmarks run 8 or 32 client threads sending requests back to
+ * back, each on a new connection, against the server in single and in multi
+ * client mode. The counter is the 99th percentile of the request latencies,
+ * connecting included.
+ *
+ * The page benchmarks load the 20 assets of a page (1 KB each) from one
+ * client: on a new connection each, one after the other on a kept alive
+ * connection, and pipelined on it. Time is per page.
+ */
+
+#include <bench.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <loopback.h>
+#include "WebServer.h"
+
+static uint16_t s_port;
+static WebServer *s_server;
+
+static size_t exchange(const std::string &request) {
+  int fd = loopback_connect(s_port);
+  loopback_send(fd, request);
+  s_server->handleClient();
+  size_t len = loopback_receive_all(fd).size();
+  close(fd);
+  return len;
+}
+
+static void run_requests(BenchState &state, const std::string &request) {
+  for (auto _ : state) {
+    benchDoNotOptimize(exchange(request));
+  }
+  state.setItemsProcessed(state.iterations());
+  state.setBytesProcessed(state.iterations() * request.size());
+}
+
+static void BM_WebServerGet(BenchState &state) {
+  run_requests(state, "GET / HTTP/1.1\r\nHost: localhost\r\nUser-Agent: bench\r\nAccept: */*\r\n\r\n");
+}
+BENCHMARK(BM_WebServerGet);
+
+static void BM_WebServerHeaders(BenchState &state) {
+  std::string request = "GET / HTTP/1.1\r\nHost: localhost\r\n";
+  for (int64_t i = 0; i < state.range(0); i++) {
+    request += "X-Header-" + std::to_string(i) + ": some header value of typical length\r\n";
+  }
+  request += "\r\n";
+  run_requests(state, request);
+}
+BENCHMARK(BM_WebServerHeaders)->Arg(4)->Arg(32);
+
+static void BM_WebServerQueryArgs(BenchState &state) {
+  std::string request = "GET /args?";
+  for (int64_t i = 0; i < state.range(0); i++) {
+    request += (i ? "&" : "") + std::string("key") + std::to_string(i) + "=value%20" + std::to_string(i);
+  }
+  request += " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+  run_requests(state, request);
+}
+BENCHMARK(BM_WebServerQueryArgs)->Arg(4)->Arg(32);
+
+static void BM_WebServerFormPost(BenchState &state) {
+  std::string form;
+  while (form.size() < (size_t)state.range(0)) {
+    form += (form.empty() ? "" : "&") + std::string("field") + std::to_string(form.size()) + "=some+value%21";
+  }
+  run_requests(
+    state, "POST /args HTTP/1.1\r\nHost: localhost\r\nContent-Type: application/x-www-form-urlencoded\r\nContent-Length: " + std::to_string(form.size())
+             + "\r\n\r\n" + form
+  );
+}
+BENCHMARK(BM_WebServerFormPost)->Arg(256)->Arg(4096);
+
+static void BM_WebServerRoutes(BenchState &state) {
+  // the matched route is registered last
+  WebServer *server = s_server;
+  WebServer routed(s_port + 1);
+  for (int64_t i = 0; i < state.range(0); i++) {
+    routed.on(String("/api/route") + (int)i, HTTP_GET, [&routed]() {
+      routed.send(200, "text/plain", "ok");
+    });
+  }
+  routed.begin();
+  s_server = &routed;
+  uint16_t port = s_port;
+  s_port = s_port + 1;
+  run_requests(state, "GET /api/route" + std::to_string(state.range(0) - 1) + " HTTP/1.1\r\nHost: localhost\r\n\r\n");
+  s_port = port;
+  s_server = server;
+  routed.close();
+}
+BENCHMARK(BM_WebServerRoutes)->Arg(1)->Arg(64);
+
+static void BM_WebServerUrlDecode(BenchState &state) {
+  String text = "name=John+Smith&city=S%C3%A3o+Paulo&note=100%25+sure%21&path=%2Fhome%2Fuser";
+  for (auto _ : state) {
+    benchDoNotOptimize(WebServer::urlDecode(text).length());
+  }
+  state.setBytesProcessed(state.iterations() * text.length());
+}
+BENCHMARK(BM_WebServerUrlDecode);
+
+static void run_load(BenchState &state, uint8_t maxClients) {
+  const std::string request = "GET / HTTP/1.1\r\nHost: localhost\r\nUser-Agent: bench\r\nAccept: */*\r\n\r\n";
+  uint16_t port = loopback_free_port();
+  WebServer server(port);
+  server.on("/", HTTP_GET, [&server]() {
+    server.send(200, "text/plain", "hello");
+  });
+  server.setMaxClients(maxClients);
+  server.begin();
+
+  std::atomic<uint64_t> done(0);
+  std::atomic<bool> stop(false);
+  std::atomic<int> running(0);
+  std::mutex lock;
+  std::vector<double> latencies;
+  std::vector<std::thread> threads;
+  for (int64_t i = 0; i < state.range(0); i++) {
+    running++;
+    threads.emplace_back([&]() {
+      std::vector<double> mine;
+      while (!stop) {
+        auto start = std::chrono::steady_clock::now();
+        int fd = loopback_connect(port);
+        loopback_send(fd, request);
+        loopback_receive_all(fd);
+        close(fd);
+        mine.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+        done++;
+      }
+      std::lock_guard<std::mutex> guard(lock);
+      latencies.insert(latencies.end(), mine.begin(), mine.end());
+      running--;
+    });
+  }
+
+  uint64_t served = 0;
+  for (auto _ : state) {
+    served++;
+    while (done < served) {
+      server.handleClient();
+    }
+  }
+  state.stop();
+  stop = true;
+  while (running) {
+    server.handleClient();
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  server.close();
+
+  std::sort(latencies.begin(), latencies.end());
+  state.setItemsProcessed(state.iterations());
+  state.setCounter("p99 us", latencies.empty() ? 0 : latencies[latencies.size() * 99 / 100]);
+}
+
+static void BM_WebServerLoad(BenchState &state) {
+  run_load(state, 1);
+}
+BENCHMARK(BM_WebServerLoad)->Arg(8)->Arg(32);
+
+static void BM_WebServerLoadMulti(BenchState &state) {
+  run_load(state, state.range(0));
+}
+BENCHMARK(BM_WebServerLoadMulti)->Arg(8)->Arg(32);
+
+#define PAGE_ASSETS 20
+
+enum PageLoad {
+  PAGE_CLOSE,
+  PAGE_KEEP_ALIVE,
+  PAGE_PIPELINED,
+};
+
+static void run_page(BenchState &state, PageLoad load) {
+  uint16_t port = loopback_free_port();
+  WebServer server(port);
+  String asset = std::string(1024, 'x').c_str();
+  server.on("/asset", HTTP_GET, [&server, &asset]() {
+    server.send(200, "text/css", asset);
+  });
+  server.enableKeepAlive(load != PAGE_CLOSE);
+  server.begin();
+  std::vector<std::string> requests;
+  for (int i = 0; i < PAGE_ASSETS; i++) {
+    requests.push_back(
+      "GET /asset?n=" + std::to_string(i) + " HTTP/1.1\r\nHost: localhost\r\nAccept: text/css,*/*\r\n"
+      + (i == PAGE_ASSETS - 1 ? "Connection: close\r\n\r\n" : "\r\n")
+    );
+  }
+  std::string pipelined;
+  for (const std::string &request : requests) {
+    pipelined += request;
+  }
+
+  size_t received = 0;
+  for (auto _ : state) {
+    int fd = -1;
+    if (load == PAGE_PIPELINED) {
+      fd = loopback_connect(port);
+      loopback_send(fd, pipelined);
+      for (int i = 0; i < PAGE_ASSETS; i++) {
+        server.handleClient();
+      }
+    }
+    for (const std::string &request : requests) {
+      if (load == PAGE_CLOSE || fd < 0) {
+        fd = loopback_connect(port);
+      }
+      if (load != PAGE_PIPELINED) {
+        loopback_send(fd, request);
+        server.handleClient();
+      }
+      received += loopback_receive_response(fd).size();
+      if (load == PAGE_CLOSE) {
+        close(fd);
+      }
+    }
+    if (load != PAGE_CLOSE) {
+      close(fd);
+    }
+  }
+  server.close();
+  benchDoNotOptimize(received);
+  state.setItemsProcessed(state.iterations() * PAGE_ASSETS);
+}
+
+static void BM_WebServerPageClose(BenchState &state) {
+  run_page(state, PAGE_CLOSE);
+}
+BENCHMARK(BM_WebServerPageClose);
+
+static void BM_WebServerPageKeepAlive(BenchState &state) {
+  run_page(state, PAGE_KEEP_ALIVE);
+}
+BENCHMARK(BM_WebServerPageKeepAlive);
+
+static void BM_WebServerPagePipelined(BenchState &state) {
+  run_page(state, PAGE_PIPELINED);
+}
+BENCHMARK(BM_WebServerPagePipelined);
+
+int main(int argc, char **argv) {
+  s_port = loopback_free_port();
+  WebServer server(s_port);
+  server.on("/", HTTP_GET, [&server]() {
+    server.send(200, "text/plain", "hello");
+  });
+  server.on("/args", [&server]() {
+    server.send(200, "text/plain", String(server.args()));
+  });
+  server.begin();
+  s_server = &server;
+  int ret = benchMain(argc, argv);
+  server.close();
+  return ret;
+}
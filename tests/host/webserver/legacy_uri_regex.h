@@ -0,0 +1,47 @@
+/*
+ * The previous UriRegex, which builds a std::regex from the pattern on each
+ * call, kept as the test reference and the benchmark baseline.
+ */
+
+#pragma once
+
+#include "Uri.h"
+#include <regex>
+
+class LegacyUriRegex : public Uri {
+
+public:
+  explicit LegacyUriRegex(const char *uri) : Uri(uri){};
+  explicit LegacyUriRegex(const String &uri) : Uri(uri){};
+
+  Uri *clone() const override final {
+    return new LegacyUriRegex(_uri);
+  };
+
+  void initPathArgs(std::vector<String> &pathArgs) override final {
+    std::regex rgx((_uri + "|").c_str());
+    std::smatch matches;
+    std::string s{""};
+    std::regex_search(s, matches, rgx);
+    pathArgs.resize(matches.size() - 1);
+  }
+
+  bool canHandle(const String &requestUri, std::vector<String> &pathArgs) override final {
+    if (Uri::canHandle(requestUri, pathArgs)) {
+      return true;
+    }
+
+    unsigned int pathArgIndex = 0;
+    std::regex rgx(_uri.c_str());
+    std::smatch matches;
+    std::string s(requestUri.c_str());
+    if (std::regex_search(s, matches, rgx)) {
+      for (size_t i = 1; i < matches.size(); ++i) {  // skip first
+        pathArgs[pathArgIndex] = String(matches[i].str().c_str());
+        pathArgIndex++;
+      }
+      return true;
+    }
+    return false;
+  }
+};
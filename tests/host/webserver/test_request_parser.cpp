@@ -0,0 +1,274 @@
+/*
+ * Host tests for the incremental HTTP request head parser of WebServer and
+ * the request arena. Generated requests are fed in pieces split at random
+ * points and their parts checked; mutated requests must parse the same fed
+ * in pieces as in one go, with the spans inside the head.
+ */
+
+#include <unity.h>
+#include <string>
+#include <vector>
+#include "detail/RequestParser.h"
+
+static uint64_t s_seed;
+
+static uint32_t random32() {
+  s_seed = s_seed * 6364136223846793005ULL + 1442695040888963407ULL;
+  return s_seed >> 33;
+}
+
+static std::string text(const std::string &buffer, HTTPRequestParser::Span span) {
+  return buffer.substr(span.offset, span.length);
+}
+
+static HTTPRequestParser::Result parse(HTTPRequestParser &parser, const std::string &request) {
+  parser.reset();
+  return parser.parse(request.data(), request.size());
+}
+
+// Feeds request to the parser in pieces of random length
+static HTTPRequestParser::Result parse_split(HTTPRequestParser &parser, const std::string &request) {
+  parser.reset();
+  HTTPRequestParser::Result result = HTTPRequestParser::INCOMPLETE;
+  size_t length = 0;
+  while (result == HTTPRequestParser::INCOMPLETE && length < request.size()) {
+    length = std::min(request.size(), length + 1 + random32() % 16);
+    // the buffer is only valid up to length, as one being received into
+    std::string received = request.substr(0, length);
+    result = parser.parse(received.data(), received.size());
+  }
+  return result;
+}
+
+void setUp(void) {
+  s_seed = 42;
+}
+
+void tearDown(void) {}
+
+void test_request_parser_get(void) {
+  HTTPRequestParser parser;
+  std::string request = "GET /path/to?a=1&b=2 HTTP/1.1\r\nHost: example.com\r\nX-Spaced: \t value with  spaces \t\r\nEmpty:\r\n\r\nbody";
+  TEST_ASSERT_EQUAL(HTTPRequestParser::COMPLETE, parse(parser, request));
+  TEST_ASSERT_EQUAL_STRING("GET", text(request, parser.method).c_str());
+  TEST_ASSERT_EQUAL_STRING("/path/to", text(request, parser.path).c_str());
+  TEST_ASSERT_EQUAL_STRING("a=1&b=2", text(request, parser.query).c_str());
+  TEST_ASSERT_EQUAL(1, parser.versionMinor);
+  TEST_ASSERT_EQUAL(3, parser.headerCount);
+  TEST_ASSERT_EQUAL_STRING("Host", text(request, parser.headers[0].name).c_str());
+  TEST_ASSERT_EQUAL_STRING("example.com", text(request, parser.headers[0].value).c_str());
+  TEST_ASSERT_EQUAL_STRING("value with  spaces", text(request, parser.headers[1].value).c_str());
+  TEST_ASSERT_EQUAL_STRING("", text(request, parser.headers[2].value).c_str());
+  TEST_ASSERT_EQUAL(-1, parser.contentLength);
+  TEST_ASSERT_EQUAL(request.size() - 4, parser.headLength);
+  TEST_ASSERT_EQUAL(1, parser.find(request.data(), "x-spaced"));
+  TEST_ASSERT_EQUAL(-1, parser.find(request.data(), "X-Missing"));
+  TEST_ASSERT_TRUE(HTTPRequestParser::startsWith(request.data(), parser.headers[1].value, "VALUE"));
+  TEST_ASSERT_TRUE(HTTPRequestParser::contains(request.data(), parser.headers[1].value, "With"));
+  TEST_ASSERT_FALSE(HTTPRequestParser::equals(request.data(), parser.headers[1].value, "value"));
+}
+
+void test_request_parser_incomplete(void) {
+  HTTPRequestParser parser;
+  TEST_ASSERT_EQUAL(HTTPRequestParser::INCOMPLETE, parse(parser, ""));
+  TEST_ASSERT_EQUAL(HTTPRequestParser::INCOMPLETE, parse(parser, "GET / HTTP/1.0\r\nHost: a\r\n\r"));
+  // bare LF line ends, no query, HTTP/1.0
+  std::string request = "POST /form HTTP/1.0\nContent-Length: 12\n\n";
+  TEST_ASSERT_EQUAL(HTTPRequestParser::COMPLETE, parse(parser, request));
+  TEST_ASSERT_EQUAL(0, parser.versionMinor);
+  TEST_ASSERT_EQUAL(0, parser.query.length);
+  TEST_ASSERT_EQUAL(12, parser.contentLength);
+  TEST_ASSERT_EQUAL(request.size(), parser.headLength);
+  // a complete parser stays complete
+  TEST_ASSERT_EQUAL(HTTPRequestParser::COMPLETE, parser.parse(request.data(), request.size()));
+  // empty lines before the request line are skipped
+  TEST_ASSERT_EQUAL(HTTPRequestParser::INCOMPLETE, parse(parser, "\r\n\n"));
+  request = "\r\n\r\nGET /next HTTP/1.1\r\n\r\n";
+  TEST_ASSERT_EQUAL(HTTPRequestParser::COMPLETE, parse_split(parser, request));
+  TEST_ASSERT_EQUAL_STRING("GET", text(request, parser.method).c_str());
+  TEST_ASSERT_EQUAL_STRING("/next", text(request, parser.path).c_str());
+  TEST_ASSERT_EQUAL(request.size(), parser.headLength);
+}
+
+void test_request_parser_errors(void) {
+  const char *bad[] = {
+    " / HTTP/1.1\r\n\r\n",
+    "GET  HTTP/1.1\r\n\r\n",
+    "GET /?a HTTP/1.1 \r\n\r\n",
+    "GET / HTTP/2.0\r\n\r\n",
+    "GET / HTTP/1.10\r\n\r\n",
+    "GET / http/1.1\r\n\r\n",
+    "G(T / HTTP/1.1\r\n\r\n",
+    "GET /\x01 HTTP/1.1\r\n\r\n",
+    "GET / HTTP/1.1\r\nHost: a\r\n folded\r\n\r\n",
+    "GET / HTTP/1.1\r\nNo colon\r\n\r\n",
+    "GET / HTTP/1.1\r\nHost: a\rb\r\n\r\n",
+    "GET / HTTP/1.1\r\nHost: a\x7F\r\n\r\n",
+    "GET / HTTP/1.1\r\n\rx",
+    "GET / HTTP/1.1\r\nContent-Length: 1x\r\n\r\n",
+    "GET / HTTP/1.1\r\nContent-Length: -1\r\n\r\n",
+    "GET / HTTP/1.1\r\nContent-Length:\r\n\r\n",
+    "GET / HTTP/1.1\r\nContent-Length: 99999999999\r\n\r\n",
+    "GET / HTTP/1.1\r\nContent-Length: 1\r\ncontent-length: 2\r\n\r\n",
+  };
+  HTTPRequestParser parser;
+  for (const char *request : bad) {
+    TEST_ASSERT_MESSAGE(parse(parser, request) == HTTPRequestParser::BAD_REQUEST, request);
+  }
+  // repeated with the same value
+  TEST_ASSERT_EQUAL(HTTPRequestParser::COMPLETE, parse(parser, "GET / HTTP/1.1\r\nContent-Length: 3\r\nContent-Length: 3\r\n\r\n"));
+  TEST_ASSERT_EQUAL(3, parser.contentLength);
+
+  std::string many = "GET / HTTP/1.1\r\n";
+  for (int i = 0; i <= HTTP_MAX_HEADERS; i++) {
+    many += "X-" + std::to_string(i) + ": " + std::to_string(i) + "\r\n";
+  }
+  TEST_ASSERT_EQUAL(HTTPRequestParser::TOO_LARGE, parse(parser, many + "\r\n"));
+  std::string large = "GET / HTTP/1.1\r\nX-Large: " + std::string(70000, 'x');
+  TEST_ASSERT_EQUAL(HTTPRequestParser::TOO_LARGE, parse(parser, large));
+}
+
+struct Generated {
+  std::string request;
+  std::string method;
+  std::string path;
+  std::string query;
+  std::vector<std::pair<std::string, std::string>> headers;
+  long contentLength = -1;
+};
+
+static std::string random_text(const char *alphabet, size_t min, size_t max) {
+  std::string text;
+  size_t length = min + random32() % (max - min + 1);
+  for (size_t i = 0; i < length; i++) {
+    text += alphabet[random32() % strlen(alphabet)];
+  }
+  return text;
+}
+
+static Generated generate() {
+  static const char *methods[] = {"GET", "POST", "PUT", "DELETE", "OPTIONS", "M-SEARCH"};
+  Generated g;
+  const char *eol = random32() % 4 ? "\r\n" : "\n";
+  g.method = methods[random32() % 6];
+  g.path = "/" + random_text("abcxyz019-._~%/", 0, 40);
+  if (random32() % 2) {
+    g.query = random_text("abc123=&%+?/", 0, 60);
+  }
+  g.request = g.method + " " + g.path + (random32() % 2 || g.query.size() ? "?" + g.query : "") + " HTTP/1." + (random32() % 2 ? "1" : "0") + eol;
+  int count = random32() % (HTTP_MAX_HEADERS + 1);
+  for (int i = 0; i < count; i++) {
+    std::string name = random_text("abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789-_", 1, 20);
+    std::string value = random_text("abc 123\t;,=\"/\x80\xff", 0, 80);
+    if (random32() % 8 == 0 && g.contentLength < 0) {
+      name = random32() % 2 ? "Content-Length" : "content-length";
+      g.contentLength = random32() % 100000;
+      value = std::to_string(g.contentLength);
+    }
+    // the value without the whitespace around it
+    size_t start = value.find_first_not_of(" \t");
+    value = start == std::string::npos ? "" : value.substr(start, value.find_last_not_of(" \t") - start + 1);
+    g.headers.push_back({name, value});
+    g.request += name + ":" + random_text(" \t", 0, 3) + value + random_text(" \t", 0, 3) + eol;
+  }
+  g.request += eol;
+  return g;
+}
+
+void test_request_parser_split(void) {
+  HTTPRequestParser parser;
+  for (int i = 0; i < 5000; i++) {
+    Generated g = generate();
+    std::string request = g.request + "NEXT";
+    TEST_ASSERT_MESSAGE(parse_split(parser, request) == HTTPRequestParser::COMPLETE, g.request.c_str());
+    TEST_ASSERT_EQUAL(g.request.size(), parser.headLength);
+    TEST_ASSERT_EQUAL_STRING(g.method.c_str(), text(request, parser.method).c_str());
+    TEST_ASSERT_EQUAL_STRING(g.path.c_str(), text(request, parser.path).c_str());
+    TEST_ASSERT_EQUAL_STRING(g.query.c_str(), text(request, parser.query).c_str());
+    TEST_ASSERT_EQUAL(g.headers.size(), parser.headerCount);
+    for (size_t h = 0; h < g.headers.size(); h++) {
+      TEST_ASSERT_EQUAL_STRING(g.headers[h].first.c_str(), text(request, parser.headers[h].name).c_str());
+      TEST_ASSERT_EQUAL_STRING(g.headers[h].second.c_str(), text(request, parser.headers[h].value).c_str());
+    }
+    TEST_ASSERT_EQUAL(g.contentLength, parser.contentLength);
+  }
+}
+
+void test_request_parser_mutations(void) {
+  static const char bytes[] = " \t\r\n:?/%\x00\x7F\x80" "Aa0";
+  HTTPRequestParser split;
+  HTTPRequestParser whole;
+  int complete = 0;
+  for (int i = 0; i < 20000; i++) {
+    std::string request = generate().request;
+    for (int m = 1 + random32() % 4; m > 0; m--) {
+      size_t pos = random32() % request.size();
+      switch (random32() % 3) {
+        case 0:  request[pos] = bytes[random32() % (sizeof(bytes) - 1)]; break;
+        case 1:  request.insert(pos, 1, bytes[random32() % (sizeof(bytes) - 1)]); break;
+        default: request.erase(pos, 1); break;
+      }
+    }
+    HTTPRequestParser::Result result = parse(whole, request);
+    TEST_ASSERT_EQUAL(result, parse_split(split, request));
+    if (result != HTTPRequestParser::COMPLETE) {
+      continue;
+    }
+    complete++;
+    TEST_ASSERT_EQUAL(whole.headLength, split.headLength);
+    TEST_ASSERT_EQUAL(whole.headerCount, split.headerCount);
+    TEST_ASSERT_EQUAL(whole.contentLength, split.contentLength);
+    TEST_ASSERT_TRUE(whole.path.offset + whole.path.length <= whole.headLength);
+    TEST_ASSERT_TRUE(whole.query.offset + whole.query.length <= whole.headLength);
+    for (int h = 0; h < whole.headerCount; h++) {
+      TEST_ASSERT_EQUAL(whole.headers[h].name.offset, split.headers[h].name.offset);
+      TEST_ASSERT_EQUAL(whole.headers[h].value.length, split.headers[h].value.length);
+      TEST_ASSERT_TRUE(whole.headers[h].value.offset + whole.headers[h].value.length <= whole.headLength);
+    }
+  }
+  // the mutations leave some requests valid
+  TEST_ASSERT_TRUE(complete > 100);
+}
+
+void test_request_arena(void) {
+  RequestArena arena;
+  char *a = (char *)arena.alloc(3);
+  char *b = (char *)arena.alloc(5);
+  TEST_ASSERT_NOT_NULL(a);
+  TEST_ASSERT_EQUAL(0, (uintptr_t)a % 8);
+  TEST_ASSERT_EQUAL(8, b - a);
+  char *large = (char *)arena.alloc(HTTP_ARENA_BLOCK_SIZE * 3);
+  TEST_ASSERT_NOT_NULL(large);
+  memset(large, 'x', HTTP_ARENA_BLOCK_SIZE * 3);
+  char *copy = arena.copy("hello", 3);
+  TEST_ASSERT_EQUAL_STRING("hel", copy);
+  for (int i = 0; i < 100; i++) {
+    TEST_ASSERT_NOT_NULL(arena.alloc(100));
+  }
+  // the first block is used again
+  arena.reset();
+  TEST_ASSERT_TRUE(arena.alloc(1) == a);
+}
+
+void test_request_url_decode(void) {
+  char out[32];
+  const char *in = "a+b%2Fc%2bd%4";
+  out[requestUrlDecode(out, in, strlen(in))] = '\0';
+  TEST_ASSERT_EQUAL_STRING("a b/c+d%4", out);
+  // in place
+  char buffer[] = "%41%42+c";
+  buffer[requestUrlDecode(buffer, buffer, strlen(buffer))] = '\0';
+  TEST_ASSERT_EQUAL_STRING("AB c", buffer);
+}
+
+int main(void) {
+  UNITY_BEGIN();
+  RUN_TEST(test_request_parser_get);
+  RUN_TEST(test_request_parser_incomplete);
+  RUN_TEST(test_request_parser_errors);
+  RUN_TEST(test_request_parser_split);
+  RUN_TEST(test_request_parser_mutations);
+  RUN_TEST(test_request_arena);
+  RUN_TEST(test_request_url_decode);
+  return UNITY_END();
+}
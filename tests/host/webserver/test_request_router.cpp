@@ -0,0 +1,227 @@
+/*
+ * Host tests for the request router of WebServer: the handler it finds and
+ * its path arguments against asking each handler canHandle() in turn, as
+ * the server did before, over random route tables mixing indexed routes,
+ * routes asked in turn and filters. Registration order, removed routes and
+ * the path arguments keeping their Strings are tested on their own.
+ */
+
+#include <unity.h>
+#include <string>
+#include <vector>
+#include "WebServer.h"
+#include "uri/UriBraces.h"
+#include "uri/UriGlob.h"
+#include "uri/UriRegex.h"
+
+static uint64_t s_seed;
+
+static uint32_t random32() {
+  s_seed = s_seed * 6364136223846793005ULL + 1442695040888963407ULL;
+  return s_seed >> 33;
+}
+
+static bool s_filter;
+
+// Routes with the router, or with the handlers asked in turn
+class RoutingServer : public WebServer {
+public:
+  RoutingServer() : WebServer(0) {}
+  RequestHandler *route(HTTPMethod method, const String &uri) {
+    return _router.find(*this, _firstHandler, method, uri);
+  }
+  RequestHandler *scan(HTTPMethod method, const String &uri) {
+    for (RequestHandler *handler = _firstHandler; handler; handler = handler->next()) {
+      if (handler->canHandle(*this, method, uri)) {
+        return handler;
+      }
+    }
+    return nullptr;
+  }
+  int indexOf(RequestHandler *handler) {
+    int index = 0;
+    for (RequestHandler *h = _firstHandler; h; h = h->next(), index++) {
+      if (h == handler) {
+        return index;
+      }
+    }
+    return -1;
+  }
+};
+
+// A handler of its own, asked in turn: any path under a prefix
+class PrefixHandler : public RequestHandler {
+public:
+  PrefixHandler(const char *prefix) : _prefix(prefix) {}
+  bool canHandle(WebServer &server, HTTPMethod method, const String &uri) override {
+    (void)server;
+    (void)method;
+    return uri.startsWith(_prefix);
+  }
+
+private:
+  String _prefix;
+};
+
+static void nothing() {}
+
+void setUp(void) {
+  s_seed = 42;
+  s_filter = true;
+}
+
+void tearDown(void) {}
+
+void test_request_router_order(void) {
+  RoutingServer server;
+  RequestHandler &braces = server.on(UriBraces("/users/{}"), HTTP_GET, nothing);
+  RequestHandler &exact = server.on("/users/me", nothing);
+  RequestHandler &post = server.on("/users/me", HTTP_POST, nothing);
+  RequestHandler &glob = server.on(UriGlob("/files/*"), nothing);
+  RequestHandler &regex = server.on(UriRegex("^/files/(\\d+)$"), nothing);
+  // registered first, the braces route wins over the exact one
+  TEST_ASSERT_TRUE(server.route(HTTP_GET, "/users/me") == &braces);
+  TEST_ASSERT_EQUAL_STRING("me", braces.pathArg(0).c_str());
+  TEST_ASSERT_TRUE(server.route(HTTP_PUT, "/users/me") == &exact);
+  TEST_ASSERT_TRUE(server.route(HTTP_POST, "/users/me") == &exact);
+  TEST_ASSERT_TRUE(server.route(HTTP_GET, "/users/me/more") == nullptr);
+  TEST_ASSERT_TRUE(server.route(HTTP_GET, "/files/12") == &glob);
+  TEST_ASSERT_TRUE(server.route(HTTP_GET, "/files/") == &glob);
+  TEST_ASSERT_TRUE(server.route(HTTP_GET, "/files") == nullptr);
+  // without the glob, the regex asked in turn
+  TEST_ASSERT_TRUE(server.removeRoute("/files/*"));
+  TEST_ASSERT_TRUE(server.route(HTTP_GET, "/files/12") == &regex);
+  TEST_ASSERT_EQUAL_STRING("12", regex.pathArg(0).c_str());
+  // a handler asked in turn that comes first wins
+  TEST_ASSERT_TRUE(server.removeRoute("/users/{}", HTTP_GET));
+  server.addHandler(new PrefixHandler("/users/"));
+  TEST_ASSERT_TRUE(server.route(HTTP_GET, "/users/me") == &exact);
+  TEST_ASSERT_EQUAL(3, server.indexOf(server.route(HTTP_GET, "/users/you")));
+  (void)post;
+}
+
+void test_request_router_arguments(void) {
+  RoutingServer server;
+  RequestHandler &posts = server.on(UriBraces("/users/{}/posts/{}"), nothing);
+  RequestHandler &file = server.on(UriBraces("/file/{}.json"), nothing);
+  RequestHandler &user = server.on(UriBraces("/users/{}"), nothing);
+  TEST_ASSERT_TRUE(server.route(HTTP_GET, "/users/42/posts/7") == &posts);
+  TEST_ASSERT_EQUAL_STRING("42", posts.pathArg(0).c_str());
+  TEST_ASSERT_EQUAL_STRING("7", posts.pathArg(1).c_str());
+  const char *buffer = posts.pathArg(0).c_str();
+  TEST_ASSERT_TRUE(server.route(HTTP_GET, "/users/43/posts/8") == &posts);
+  // the argument is copied into the String it had
+  TEST_ASSERT_TRUE(posts.pathArg(0).c_str() == buffer);
+  TEST_ASSERT_EQUAL_STRING("43", posts.pathArg(0).c_str());
+  // a middle argument may hold a '/', the last one not
+  TEST_ASSERT_TRUE(server.route(HTTP_GET, "/file/a/b.json") == &file);
+  TEST_ASSERT_EQUAL_STRING("a/b", file.pathArg(0).c_str());
+  TEST_ASSERT_TRUE(server.route(HTTP_GET, "/users/") == &user);
+  TEST_ASSERT_EQUAL_STRING("", user.pathArg(0).c_str());
+  TEST_ASSERT_TRUE(server.route(HTTP_GET, "/users/a/b") == nullptr);
+}
+
+void test_request_router_filter(void) {
+  RoutingServer server;
+  server.on("/page", nothing).setFilter([](WebServer &) {
+    return s_filter;
+  });
+  RequestHandler &fallback = server.on("/page", nothing);
+  TEST_ASSERT_EQUAL(0, server.indexOf(server.route(HTTP_GET, "/page")));
+  s_filter = false;
+  TEST_ASSERT_TRUE(server.route(HTTP_GET, "/page") == &fallback);
+}
+
+static const char *SEGMENTS[] = {"a", "b", "api", "v1", "x.json", "users", "", "ab"};
+
+static String random_path(int segments, bool braces) {
+  String path;
+  for (int i = 0; i < segments; i++) {
+    path += "/";
+    if (braces && random32() % 3 == 0) {
+      path += random32() % 4 ? "{}" : "{}.json";
+    } else {
+      path += SEGMENTS[random32() % 8];
+    }
+  }
+  return path;
+}
+
+static HTTPMethod random_method() {
+  static const HTTPMethod methods[] = {HTTP_GET, HTTP_POST, HTTP_PUT, HTTP_ANY};
+  return methods[random32() % 4];
+}
+
+void test_request_router_random(void) {
+  int routed = 0;
+  for (int table = 0; table < 200; table++) {
+    // the same routes on both
+    RoutingServer servers[2];
+    std::vector<int> argCounts;
+    int count = 1 + random32() % 40;
+    for (int i = 0; i < count; i++) {
+      int kind = random32() % 10;
+      HTTPMethod method = random_method();
+      String path = random_path(1 + random32() % 4, kind < 5);
+      bool filtered = random32() % 8 == 0;
+      const char *wildcard = random32() % 2 ? "*" : "?";
+      int args = 0;
+      for (int at = path.indexOf("{}"); at >= 0; at = path.indexOf("{}", at + 2)) {
+        args++;
+      }
+      argCounts.push_back(kind < 5 ? args : 0);
+      for (RoutingServer &server : servers) {
+        RequestHandler *handler;
+        if (kind < 5) {
+          handler = &server.on(UriBraces(path), method, nothing);
+        } else if (kind < 7) {
+          handler = &server.on(path, method, nothing);
+        } else if (kind == 7) {
+          handler = &server.on(UriGlob(path + wildcard), method, nothing);
+        } else if (kind == 8) {
+          handler = new PrefixHandler(path.c_str());
+          server.addHandler(handler);
+        } else {
+          handler = &server.on(UriGlob(path.substring(0, path.length() / 2) + "*"), method, nothing);
+        }
+        if (filtered) {
+          handler->setFilter([](WebServer &) {
+            return s_filter;
+          });
+        }
+      }
+    }
+    for (int request = 0; request < 100; request++) {
+      String path = random_path(random32() % 5, false);
+      if (random32() % 4 == 0) {
+        path += SEGMENTS[random32() % 8];
+      }
+      HTTPMethod method = random_method();
+      if (method == HTTP_ANY) {
+        method = HTTP_DELETE;
+      }
+      s_filter = random32() % 2;
+      RequestHandler *expected = servers[1].scan(method, path);
+      RequestHandler *found = servers[0].route(method, path);
+      int index = servers[0].indexOf(found);
+      TEST_ASSERT_MESSAGE(servers[1].indexOf(expected) == index, path.c_str());
+      if (index < 0) {
+        continue;
+      }
+      routed++;
+      for (int i = 0; i < argCounts[index]; i++) {
+        TEST_ASSERT_EQUAL_STRING(expected->pathArg(i).c_str(), found->pathArg(i).c_str());
+      }
+    }
+  }
+  TEST_ASSERT_TRUE(routed > 1000);
+}
+
+int main(void) {
+  UNITY_BEGIN();
+  RUN_TEST(test_request_router_order);
+  RUN_TEST(test_request_router_arguments);
+  RUN_TEST(test_request_router_filter);
+  RUN_TEST(test_request_router_random);
+  return UNITY_END();
+}
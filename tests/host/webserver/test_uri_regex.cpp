@@ -0,0 +1,169 @@
+/*
+ * Host tests for UriRegex compiled into a RegexMatcher program: matches and
+ * path arguments against the previous std::regex based UriRegex, over the
+ * patterns of the examples and over random patterns and paths. Patterns
+ * that would need backtracking are refused. libstdc++ takes one more empty
+ * iteration of a loop whose body can match empty, which ECMAScript and the
+ * matcher do not, so random patterns do not repeat such a body.
+ */
+
+#include <unity.h>
+#include <string>
+#include <vector>
+#include "WebServer.h"
+#include "uri/UriRegex.h"
+#include "legacy_uri_regex.h"
+
+static uint64_t s_seed;
+
+static uint32_t random32() {
+  s_seed = s_seed * 6364136223846793005ULL + 1442695040888963407ULL;
+  return s_seed >> 33;
+}
+
+void setUp(void) {
+  s_seed = 42;
+}
+
+void tearDown(void) {}
+
+// Both match path alike, with the same path arguments
+static bool same_match(const char *pattern, const char *path) {
+  UriRegex compiled(pattern);
+  LegacyUriRegex legacy(pattern);
+  std::vector<String> compiledArgs;
+  std::vector<String> legacyArgs;
+  compiled.initPathArgs(compiledArgs);
+  legacy.initPathArgs(legacyArgs);
+  if (compiledArgs.size() != legacyArgs.size()) {
+    return false;
+  }
+  if (compiled.canHandle(path, compiledArgs) != legacy.canHandle(path, legacyArgs)) {
+    return false;
+  }
+  return compiledArgs == legacyArgs;
+}
+
+void test_uri_regex_examples(void) {
+  const char *users = "^\\/users\\/([0-9]+)\\/devices\\/([0-9]+)$";
+  UriRegex uri(users);
+  std::vector<String> args;
+  uri.initPathArgs(args);
+  TEST_ASSERT_EQUAL(2, args.size());
+  TEST_ASSERT_TRUE(uri.canHandle("/users/12/devices/345", args));
+  TEST_ASSERT_EQUAL_STRING("12", args[0].c_str());
+  TEST_ASSERT_EQUAL_STRING("345", args[1].c_str());
+  TEST_ASSERT_FALSE(uri.canHandle("/users/12/devices/x", args));
+  TEST_ASSERT_FALSE(uri.canHandle("/users/12/devices/345/", args));
+  const char *paths[] = {"/users/1/devices/2", "/users//devices/2", "x/users/1/devices/2", "/upload/a/b.bin", "/upload/", "/upload", "/files/12"};
+  const char *patterns[] = {users, "/upload/(.*)", "^/files/(\\d+)$", "^/(\\w+)/(?:(\\d+)|(.*))$", "(a|ab)(c|bcd)(d*)"};
+  for (const char *pattern : patterns) {
+    for (const char *path : paths) {
+      TEST_ASSERT_MESSAGE(same_match(pattern, path), pattern);
+    }
+  }
+  TEST_ASSERT_TRUE(same_match("(a|ab)(c|bcd)(d*)", "abcd"));
+}
+
+void test_uri_regex_refused(void) {
+  // backreferences and lookaheads, and syntax errors
+  const char *patterns[] = {"(a)\\1", "a(?=b)", "a(?!b)", "(a", "a)", "[ab", "*a", "a**", "a{2,1}", "\\", "a{x}"};
+  for (const char *pattern : patterns) {
+    RegexMatcher matcher;
+    TEST_ASSERT_MESSAGE(!matcher.compile(pattern), pattern);
+    std::vector<String> args;
+    TEST_ASSERT_FALSE(matcher.search("ab", 2, args));
+  }
+  // too large once the repeats are copied
+  RegexMatcher matcher;
+  TEST_ASSERT_FALSE(matcher.compile("(a{100}){100}"));
+  TEST_ASSERT_TRUE(matcher.compile("(a{10}){10}"));
+}
+
+void test_uri_regex_syntax(void) {
+  const char *cases[][2] = {
+    {"^[a-c\\-]+$", "a-b"},     {"^[^/]*$", "ab"},          {"[\\d.]+", "v1.25"},       {"\\bb", "a b"},           {"\\Bb", "ab"},
+    {"a{2,}", "caaaa"},         {"(a+?)(a*)", "aaa"},       {"(a|b)*?c", "abc"},        {"\\x41\\u0042", "xAB"},   {"[\\]]", "]"},
+    {"(?:ab)+(c)?", "ababd"},   {"^$", ""},                 {"a|^b", "cb"},             {"\\s\\S", "a b"},         {"\\/\\.", "/."},
+    {"[\\w-]+", "%a-b%"},       {"(.)\\.(.)", "a.b"},       {".", "\n"},                {"\\t\\n", "\t\n"},       {"a?", ""},
+  };
+  for (auto &test : cases) {
+    TEST_ASSERT_MESSAGE(same_match(test[0], test[1]), test[0]);
+  }
+}
+
+static bool random_pattern(std::string &pattern, int depth);
+
+// True if the atom can match empty
+static bool random_atom(std::string &pattern, int depth) {
+  static const char *atoms[] = {"a", "b", "/", "\\.", ".", "[ab]", "[^/]", "\\d", "\\w", "1", "[a-c1]", "\\/"};
+  int choice = random32() % (depth > 0 ? 16 : 12);
+  if (choice < 12) {
+    pattern += atoms[choice];
+    return false;
+  }
+  pattern += choice < 14 ? "(" : "(?:";
+  bool empty = random_pattern(pattern, depth - 1);
+  if (random32() % 3 == 0) {
+    pattern += "|";
+    empty |= random_pattern(pattern, depth - 1);
+  }
+  pattern += ")";
+  return empty;
+}
+
+// True if the pattern can match empty
+static bool random_pattern(std::string &pattern, int depth) {
+  static const char *quantifiers[] = {"+", "{1,2}", "{2}", "+?", "*", "?", "*?", "{0,1}?"};
+  int items = 1 + random32() % 3;
+  bool empty = true;
+  for (int i = 0; i < items; i++) {
+    bool atomEmpty = random_atom(pattern, depth);
+    if (!atomEmpty && random32() % 3 == 0) {
+      int quantifier = random32() % 8;
+      pattern += quantifiers[quantifier];
+      // the last four can repeat 0 times
+      atomEmpty = quantifier >= 4;
+    }
+    empty &= atomEmpty;
+  }
+  return empty;
+}
+
+void test_uri_regex_random(void) {
+  static const char alphabet[] = "ab/.1x";
+  int matched = 0;
+  for (int i = 0; i < 2000; i++) {
+    std::string pattern;
+    if (random32() % 4 == 0) {
+      pattern += "^";
+    }
+    random_pattern(pattern, 2);
+    if (random32() % 4 == 0) {
+      pattern += "$";
+    }
+    for (int j = 0; j < 20; j++) {
+      std::string path;
+      int length = random32() % 9;
+      for (int k = 0; k < length; k++) {
+        path += alphabet[random32() % 6];
+      }
+      UriRegex compiled(pattern.c_str());
+      std::vector<String> args;
+      compiled.initPathArgs(args);
+      matched += compiled.canHandle(path.c_str(), args);
+      std::string message = pattern + " on " + path;
+      TEST_ASSERT_MESSAGE(same_match(pattern.c_str(), path.c_str()), message.c_str());
+    }
+  }
+  TEST_ASSERT_TRUE(matched > 4000);
+}
+
+int main(void) {
+  UNITY_BEGIN();
+  RUN_TEST(test_uri_regex_examples);
+  RUN_TEST(test_uri_regex_refused);
+  RUN_TEST(test_uri_regex_syntax);
+  RUN_TEST(test_uri_regex_random);
+  return UNITY_END();
+}
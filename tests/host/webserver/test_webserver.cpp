@@ -0,0 +1,405 @@
+/*
+ * Host tests for WebServer request parsing and responses, over loopback TCP:
+ * a client thread sends a raw request while the test thread runs
+ * handleClient(). The multi client mode is tested with requests that arrive
+ * in pieces on several connections, with bodies buffered whole and longer
+ * ones that stall, and with more connections than its limit.
+ * Kept alive connections are tested in both modes, with requests sent one
+ * after the other and pipelined, and with their limits.
+ */
+
+#include <unity.h>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <loopback.h>
+#include "WebServer.h"
+#include "uri/UriBraces.h"
+
+static uint16_t s_port;
+static WebServer *s_server;
+
+// Sends a raw request and returns the raw response
+static std::string exchange(const std::string &request) {
+  std::string response;
+  std::atomic<bool> done(false);
+  std::thread client([&]() {
+    int fd = loopback_connect(s_port);
+    if (fd >= 0) {
+      loopback_send(fd, request);
+      response = loopback_receive_all(fd);
+      close(fd);
+    }
+    done = true;
+  });
+  while (!done) {
+    s_server->handleClient();
+  }
+  client.join();
+  return response;
+}
+
+static std::string body(const std::string &response) {
+  size_t pos = response.find("\r\n\r\n");
+  return pos == std::string::npos ? "" : response.substr(pos + 4);
+}
+
+static bool starts_with(const std::string &text, const char *prefix) {
+  return text.compare(0, strlen(prefix), prefix) == 0;
+}
+
+// Whether the server sent something on fd, without waiting
+static bool has_data(int fd) {
+  char c;
+  return recv(fd, &c, 1, MSG_PEEK | MSG_DONTWAIT) > 0;
+}
+
+// Runs handleClient() until the server answered on fd, at most a second
+static bool serve_until_answered(int fd) {
+  for (int i = 0; i < 1000 && !has_data(fd); i++) {
+    s_server->handleClient();
+  }
+  return has_data(fd);
+}
+
+static void serve(int calls) {
+  for (int i = 0; i < calls; i++) {
+    s_server->handleClient();
+  }
+}
+
+// Sends a request on a kept alive connection and returns the response
+static std::string request(int fd, const std::string &request) {
+  loopback_send(fd, request);
+  serve_until_answered(fd);
+  return loopback_receive_response(fd);
+}
+
+static bool has_header(const std::string &response, const char *header) {
+  return response.find(std::string("\r\n") + header + "\r\n") != std::string::npos;
+}
+
+void setUp(void) {
+  s_port = loopback_free_port();
+  s_server = new WebServer(s_port);
+  s_server->on("/", HTTP_GET, []() {
+    s_server->send(200, "text/plain", "root");
+  });
+  s_server->on("/args", []() {
+    String text;
+    for (int i = 0; i < s_server->args(); i++) {
+      text += s_server->argName(i) + "=" + s_server->arg(i) + ";";
+    }
+    s_server->send(200, "text/plain", text);
+  });
+  s_server->on(UriBraces("/users/{}/posts/{}"), HTTP_GET, []() {
+    s_server->send(200, "text/plain", s_server->pathArg(0) + "/" + s_server->pathArg(1));
+  });
+  s_server->on("/header", HTTP_GET, []() {
+    s_server->send(200, "text/plain", s_server->header("X-Test"));
+  });
+  s_server->on("/context", []() {
+    const WebServer::RequestContext &request = s_server->request();
+    s_server->send(200, "text/plain", request.uri + " " + request.arg("a") + " " + request.header("X-Test") + " " + request.version);
+  });
+  s_server->onNotFound([]() {
+    s_server->send(404, "text/plain", "not found: " + s_server->uri());
+  });
+  const char *keys[] = {"X-Test"};
+  s_server->collectHeaders(keys, 1);
+  s_server->begin();
+}
+
+void tearDown(void) {
+  s_server->close();
+  delete s_server;
+}
+
+void test_webserver_get(void) {
+  std::string response = exchange("GET / HTTP/1.1\r\nHost: localhost\r\n\r\n");
+  TEST_ASSERT_TRUE(starts_with(response, "HTTP/1.1 200 OK\r\n"));
+  TEST_ASSERT_TRUE(response.find("Content-Type: text/plain\r\n") != std::string::npos);
+  TEST_ASSERT_TRUE(response.find("Content-Length: 4\r\n") != std::string::npos);
+  TEST_ASSERT_EQUAL_STRING("root", body(response).c_str());
+}
+
+void test_webserver_query_args(void) {
+  std::string response = exchange("GET /args?a=1&b=hello%20world HTTP/1.1\r\nHost: localhost\r\n\r\n");
+  TEST_ASSERT_EQUAL_STRING("a=1;b=hello world;", body(response).c_str());
+}
+
+void test_webserver_form_post(void) {
+  std::string form = "x=1&y=two+words&z=%26";
+  std::string response = exchange(
+    "POST /args HTTP/1.1\r\nHost: localhost\r\nContent-Type: application/x-www-form-urlencoded\r\nContent-Length: " + std::to_string(form.size())
+    + "\r\n\r\n" + form
+  );
+  TEST_ASSERT_EQUAL_STRING("x=1;y=two words;z=&;", body(response).c_str());
+}
+
+void test_webserver_plain_body(void) {
+  std::string response = exchange("POST /args?a=1 HTTP/1.1\r\nHost: localhost\r\nContent-Type: text/plain\r\nContent-Length: 8\r\n\r\n{\"b\": 2}");
+  TEST_ASSERT_EQUAL_STRING("a=1;plain={\"b\": 2};", body(response).c_str());
+}
+
+void test_webserver_path_args(void) {
+  std::string response = exchange("GET /users/42/posts/7 HTTP/1.1\r\nHost: localhost\r\n\r\n");
+  TEST_ASSERT_EQUAL_STRING("42/7", body(response).c_str());
+}
+
+void test_webserver_collected_header(void) {
+  std::string response = exchange("GET /header HTTP/1.1\r\nHost: localhost\r\nX-Other: no\r\nX-Test: yes please\r\n\r\n");
+  TEST_ASSERT_EQUAL_STRING("yes please", body(response).c_str());
+}
+
+void test_webserver_all_headers(void) {
+  s_server->collectAllHeaders();
+  s_server->on("/headers", HTTP_GET, []() {
+    String text;
+    for (int i = 0; i < s_server->headers(); i++) {
+      text += s_server->headerName(i) + "=" + s_server->header(i) + ";";
+    }
+    s_server->send(200, "text/plain", text + s_server->header("x-other") + " " + s_server->hostHeader());
+  });
+  std::string response = exchange("GET /headers HTTP/1.1\r\nHost: localhost\r\nX-Other: no\r\nX-Other:  yes \r\nIf-None-Match: \"1\"\r\n\r\n");
+  TEST_ASSERT_EQUAL_STRING("Authorization=;If-None-Match=\"1\";Host=localhost;X-Other=yes;yes localhost", body(response).c_str());
+}
+
+void test_webserver_bad_request(void) {
+  // not answered, the connection is closed
+  TEST_ASSERT_EQUAL_STRING("", exchange("GET / HTTP/2.0\r\nHost: localhost\r\n\r\n").c_str());
+  s_server->setMaxClients(4);
+  s_server->begin();
+  TEST_ASSERT_EQUAL_STRING("", exchange("GET / HTTP/1.1\r\n Host: localhost\r\n\r\n").c_str());
+  TEST_ASSERT_EQUAL_STRING("root", body(exchange("GET / HTTP/1.1\r\nHost: localhost\r\n\r\n")).c_str());
+}
+
+void test_webserver_not_found(void) {
+  std::string response = exchange("GET /missing HTTP/1.1\r\nHost: localhost\r\n\r\n");
+  TEST_ASSERT_TRUE(starts_with(response, "HTTP/1.1 404 Not Found\r\n"));
+  TEST_ASSERT_EQUAL_STRING("not found: /missing", body(response).c_str());
+}
+
+void test_webserver_url_decode(void) {
+  TEST_ASSERT_EQUAL_STRING("a b/c+d", WebServer::urlDecode("a+b%2Fc%2bd").c_str());
+}
+
+void test_webserver_request_context(void) {
+  const char *request = "GET /context?a=1 HTTP/1.1\r\nHost: localhost\r\nX-Test: yes\r\n\r\n";
+  TEST_ASSERT_EQUAL_STRING("/context 1 yes 1", body(exchange(request)).c_str());
+  s_server->setMaxClients(4);
+  s_server->begin();
+  TEST_ASSERT_EQUAL_STRING("/context 1 yes 1", body(exchange(request)).c_str());
+}
+
+void test_webserver_clients_slow_client(void) {
+  s_server->setMaxClients(4);
+  s_server->begin();
+  int slow = loopback_connect(s_port);
+  loopback_send(slow, "GET /args?who=slow HTTP/1.1\r\nHost: loc");
+  serve(10);
+  // the others are served while the slow request is not complete
+  std::string response = exchange("GET / HTTP/1.1\r\nHost: localhost\r\n\r\n");
+  TEST_ASSERT_EQUAL_STRING("root", body(response).c_str());
+  response = exchange("GET /args?who=fast HTTP/1.1\r\nHost: localhost\r\n\r\n");
+  TEST_ASSERT_EQUAL_STRING("who=fast;", body(response).c_str());
+  TEST_ASSERT_FALSE(has_data(slow));
+  loopback_send(slow, "alhost\r\n\r\n");
+  TEST_ASSERT_TRUE(serve_until_answered(slow));
+  TEST_ASSERT_EQUAL_STRING("who=slow;", body(loopback_receive_all(slow)).c_str());
+  close(slow);
+}
+
+void test_webserver_clients_slow_body(void) {
+  s_server->setMaxClients(4);
+  s_server->begin();
+  // longer than HTTP_MAX_REQUEST_WAIT_LEN, received whole before it is handled
+  std::string text(6000, 'x');
+  int slow = loopback_connect(s_port);
+  loopback_send(slow, "POST /args HTTP/1.1\r\nHost: localhost\r\nContent-Type: text/plain\r\nContent-Length: 6000\r\n\r\n" + text.substr(0, 5000));
+  serve(10);
+  auto start = std::chrono::steady_clock::now();
+  std::string response = exchange("GET / HTTP/1.1\r\nHost: localhost\r\n\r\n");
+  TEST_ASSERT_EQUAL_STRING("root", body(response).c_str());
+  TEST_ASSERT_TRUE(std::chrono::steady_clock::now() - start < std::chrono::milliseconds(500));
+  TEST_ASSERT_FALSE(has_data(slow));
+  loopback_send(slow, text.substr(5000));
+  TEST_ASSERT_TRUE(serve_until_answered(slow));
+  TEST_ASSERT_EQUAL_STRING(("plain=" + text + ";").c_str(), body(loopback_receive_all(slow)).c_str());
+  close(slow);
+}
+
+void test_webserver_clients_stalled_body(void) {
+  s_server->setMaxClients(4);
+  s_server->begin();
+  // too long to be buffered, the handler reads it and gives up after HTTP_MAX_BODY_WAIT
+  int stalled = loopback_connect(s_port);
+  loopback_send(stalled, "POST /args HTTP/1.1\r\nHost: localhost\r\nContent-Type: text/plain\r\nContent-Length: 20000\r\n\r\n" + std::string(10000, 'x'));
+  auto start = std::chrono::steady_clock::now();
+  std::string response = exchange("GET / HTTP/1.1\r\nHost: localhost\r\n\r\n");
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  TEST_ASSERT_EQUAL_STRING("root", body(response).c_str());
+  TEST_ASSERT_TRUE(elapsed < std::chrono::milliseconds(HTTP_MAX_BODY_WAIT + 1000));
+  // dropped without an answer
+  TEST_ASSERT_EQUAL_STRING("", loopback_receive_all(stalled).c_str());
+  close(stalled);
+}
+
+void test_webserver_clients_limit(void) {
+  s_server->setMaxClients(2);
+  s_server->begin();
+  int first = loopback_connect(s_port);
+  int second = loopback_connect(s_port);
+  loopback_send(first, "POST /args HTTP/1.1\r\nHost: localhost\r\nContent-Type: application/x-www-form-urlencoded\r\nContent-Length: 3\r\n\r\n");
+  loopback_send(second, "GET / HTTP/1.1\r\n");
+  serve(10);
+  // no connection left, the third one waits in the backlog
+  int third = loopback_connect(s_port);
+  loopback_send(third, "GET /args?n=3 HTTP/1.1\r\nHost: localhost\r\n\r\n");
+  serve(20);
+  TEST_ASSERT_FALSE(has_data(first));
+  TEST_ASSERT_FALSE(has_data(third));
+  // the body of the first request arrives, its connection is then free
+  loopback_send(first, "a=1");
+  TEST_ASSERT_TRUE(serve_until_answered(first));
+  TEST_ASSERT_EQUAL_STRING("a=1;", body(loopback_receive_all(first)).c_str());
+  TEST_ASSERT_TRUE(serve_until_answered(third));
+  TEST_ASSERT_EQUAL_STRING("n=3;", body(loopback_receive_all(third)).c_str());
+  // a client leaving in the middle of a request frees its connection too
+  close(second);
+  int fourth = loopback_connect(s_port);
+  loopback_send(fourth, "GET / HTTP/1.1\r\nHost: localhost\r\n\r\n");
+  serve(10);
+  int fifth = loopback_connect(s_port);
+  loopback_send(fifth, "GET /args?n=5 HTTP/1.1\r\nHost: localhost\r\n\r\n");
+  TEST_ASSERT_TRUE(serve_until_answered(fifth));
+  TEST_ASSERT_EQUAL_STRING("n=5;", body(loopback_receive_all(fifth)).c_str());
+  TEST_ASSERT_EQUAL_STRING("root", body(loopback_receive_all(fourth)).c_str());
+  close(first);
+  close(third);
+  close(fourth);
+  close(fifth);
+}
+
+static void keep_alive_requests(void) {
+  int fd = loopback_connect(s_port);
+  std::string response = request(fd, "GET / HTTP/1.1\r\nHost: localhost\r\n\r\n");
+  TEST_ASSERT_TRUE(has_header(response, "Connection: keep-alive"));
+  TEST_ASSERT_EQUAL_STRING("root", body(response).c_str());
+  response = request(fd, "GET /args?n=2 HTTP/1.1\r\nHost: localhost\r\n\r\n");
+  TEST_ASSERT_EQUAL_STRING("n=2;", body(response).c_str());
+  response = request(fd, "GET /args?n=3 HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n\r\n");
+  TEST_ASSERT_TRUE(has_header(response, "Connection: close"));
+  TEST_ASSERT_EQUAL_STRING("n=3;", body(response).c_str());
+  serve(10);
+  TEST_ASSERT_EQUAL_STRING("", loopback_receive_all(fd).c_str());
+  close(fd);
+}
+
+void test_webserver_keep_alive(void) {
+  // off by default
+  std::string response = exchange("GET / HTTP/1.1\r\nHost: localhost\r\n\r\n");
+  TEST_ASSERT_TRUE(has_header(response, "Connection: close"));
+  s_server->enableKeepAlive();
+  keep_alive_requests();
+  s_server->setMaxClients(4);
+  s_server->begin();
+  keep_alive_requests();
+}
+
+static void keep_alive_pipelined(void) {
+  int fd = loopback_connect(s_port);
+  loopback_send(
+    fd, "GET /args?n=1 HTTP/1.1\r\nHost: localhost\r\n\r\n"
+        "POST /args HTTP/1.1\r\nHost: localhost\r\nContent-Type: application/x-www-form-urlencoded\r\nContent-Length: 3\r\n\r\nn=2\r\n"
+        "GET /args?n=3 HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n\r\n"
+  );
+  serve(20);
+  TEST_ASSERT_EQUAL_STRING("n=1;", body(loopback_receive_response(fd)).c_str());
+  TEST_ASSERT_EQUAL_STRING("n=2;", body(loopback_receive_response(fd)).c_str());
+  std::string response = loopback_receive_response(fd);
+  TEST_ASSERT_TRUE(has_header(response, "Connection: close"));
+  TEST_ASSERT_EQUAL_STRING("n=3;", body(response).c_str());
+  TEST_ASSERT_EQUAL_STRING("", loopback_receive_all(fd).c_str());
+  close(fd);
+}
+
+void test_webserver_keep_alive_pipelined(void) {
+  s_server->enableKeepAlive();
+  keep_alive_pipelined();
+  s_server->setMaxClients(4);
+  s_server->begin();
+  keep_alive_pipelined();
+}
+
+void test_webserver_keep_alive_limits(void) {
+  s_server->enableKeepAlive(true, 100, 2);
+  int fd = loopback_connect(s_port);
+  TEST_ASSERT_TRUE(has_header(request(fd, "GET / HTTP/1.1\r\nHost: localhost\r\n\r\n"), "Connection: keep-alive"));
+  // the last request allowed
+  TEST_ASSERT_TRUE(has_header(request(fd, "GET / HTTP/1.1\r\nHost: localhost\r\n\r\n"), "Connection: close"));
+  TEST_ASSERT_EQUAL_STRING("", loopback_receive_all(fd).c_str());
+  close(fd);
+  // HTTP/1.0 clients have to ask for it
+  std::string response = exchange("GET / HTTP/1.0\r\nHost: localhost\r\n\r\n");
+  TEST_ASSERT_TRUE(has_header(response, "Connection: close"));
+  fd = loopback_connect(s_port);
+  TEST_ASSERT_TRUE(has_header(request(fd, "GET / HTTP/1.0\r\nConnection: Keep-Alive\r\n\r\n"), "Connection: keep-alive"));
+  // idle for longer than the timeout
+  usleep(150000);
+  serve(10);
+  TEST_ASSERT_EQUAL_STRING("", loopback_receive_all(fd).c_str());
+  close(fd);
+}
+
+void test_webserver_keep_alive_gives_way(void) {
+  s_server->enableKeepAlive();
+  // one client at a time: an idle connection is closed for the next client
+  int idle = loopback_connect(s_port);
+  TEST_ASSERT_EQUAL_STRING("root", body(request(idle, "GET / HTTP/1.1\r\nHost: localhost\r\n\r\n")).c_str());
+  int next = loopback_connect(s_port);
+  TEST_ASSERT_EQUAL_STRING("n=2;", body(request(next, "GET /args?n=2 HTTP/1.1\r\nHost: localhost\r\n\r\n")).c_str());
+  TEST_ASSERT_EQUAL_STRING("", loopback_receive_all(idle).c_str());
+  close(idle);
+  close(next);
+  // all the connections taken: the one idle the longest is closed
+  s_server->setMaxClients(2);
+  s_server->begin();
+  int first = loopback_connect(s_port);
+  TEST_ASSERT_EQUAL_STRING("root", body(request(first, "GET / HTTP/1.1\r\nHost: localhost\r\n\r\n")).c_str());
+  usleep(2000);
+  int second = loopback_connect(s_port);
+  TEST_ASSERT_EQUAL_STRING("root", body(request(second, "GET / HTTP/1.1\r\nHost: localhost\r\n\r\n")).c_str());
+  int third = loopback_connect(s_port);
+  TEST_ASSERT_EQUAL_STRING("n=3;", body(request(third, "GET /args?n=3 HTTP/1.1\r\nHost: localhost\r\n\r\n")).c_str());
+  TEST_ASSERT_EQUAL_STRING("", loopback_receive_all(first).c_str());
+  TEST_ASSERT_EQUAL_STRING("n=2;", body(request(second, "GET /args?n=2 HTTP/1.1\r\nHost: localhost\r\n\r\n")).c_str());
+  close(first);
+  close(second);
+  close(third);
+}
+
+int main(void) {
+  UNITY_BEGIN();
+  RUN_TEST(test_webserver_get);
+  RUN_TEST(test_webserver_query_args);
+  RUN_TEST(test_webserver_form_post);
+  RUN_TEST(test_webserver_plain_body);
+  RUN_TEST(test_webserver_path_args);
+  RUN_TEST(test_webserver_collected_header);
+  RUN_TEST(test_webserver_all_headers);
+  RUN_TEST(test_webserver_bad_request);
+  RUN_TEST(test_webserver_not_found);
+  RUN_TEST(test_webserver_url_decode);
+  RUN_TEST(test_webserver_request_context);
+  RUN_TEST(test_webserver_clients_slow_client);
+  RUN_TEST(test_webserver_clients_slow_body);
+  RUN_TEST(test_webserver_clients_stalled_body);
+  RUN_TEST(test_webserver_clients_limit);
+  RUN_TEST(test_webserver_keep_alive);
+  RUN_TEST(test_webserver_keep_alive_pipelined);
+  RUN_TEST(test_webserver_keep_alive_limits);
+  RUN_TEST(test_webserver_keep_alive_gives_way);
+  return UNITY_END();
+}
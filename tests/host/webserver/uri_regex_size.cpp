@@ -0,0 +1,30 @@
+/*
+ * One UriRegex compiled and matched, built with the previous std::regex
+ * based UriRegex (URI_REGEX_LEGACY) and without, for the code size
+ * bench_uri_regex reports.
+ */
+
+#include <stdio.h>
+#include <vector>
+#include "WebServer.h"
+#if URI_REGEX_LEGACY
+#include "legacy_uri_regex.h"
+typedef LegacyUriRegex SizedUriRegex;
+#else
+#include "uri/UriRegex.h"
+typedef UriRegex SizedUriRegex;
+#endif
+
+int main(int argc, char **argv) {
+  if (argc < 3) {
+    return 2;
+  }
+  SizedUriRegex uri(argv[1]);
+  std::vector<String> args;
+  uri.initPathArgs(args);
+  bool matched = uri.canHandle(argv[2], args);
+  for (const String &arg : args) {
+    printf("%s\n", arg.c_str());
+  }
+  return matched ? 0 : 1;
+}
@@ -0,0 +1,252 @@
+/*
+ * String and Print number formatting costs: building strings from literals and
+ * numbers, the operator+ chains sketches use, and the search/replace helpers.
+ * The JSON and HTML builders also report the heap calls made per string.
+ */
+
+#include <bench.h>
+#include <alloc_count.h>
+#include "WString.h"
+#include "Print.h"
+
+// A Print that only counts what it is given
+class NullPrint : public Print {
+public:
+  size_t written = 0;
+  size_t write(uint8_t) override {
+    written++;
+    return 1;
+  }
+  size_t write(const uint8_t *buffer, size_t size) override {
+    written += size;
+    return size;
+  }
+};
+
+// heap calls per iteration since `before`
+#define REPORT_ALLOCS(state, before) (state).setCounter("allocs/op", (double)(alloc_count() - (before)) / (state).iterations())
+
+static void BM_StringAppendChar(BenchState &state) {
+  for (auto _ : state) {
+    String s;
+    for (int64_t i = 0; i < state.range(0); i++) {
+      s += 'x';
+    }
+    benchDoNotOptimize(s.length());
+  }
+  state.setItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_StringAppendChar)->Arg(16)->Arg(256)->Arg(4096);
+
+static void BM_StringAppendLiteral(BenchState &state) {
+  for (auto _ : state) {
+    String s;
+    for (int64_t i = 0; i < state.range(0); i++) {
+      s += "header: value\r\n";
+    }
+    benchDoNotOptimize(s.length());
+  }
+  state.setItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_StringAppendLiteral)->Arg(4)->Arg(64);
+
+static void BM_StringConcatInt(BenchState &state) {
+  int value = 0;
+  for (auto _ : state) {
+    String s;
+    s += value++;
+    s += -1234567;
+    s += 42UL;
+    benchDoNotOptimize(s.length());
+  }
+  state.setItemsProcessed(state.iterations() * 3);
+}
+BENCHMARK(BM_StringConcatInt);
+
+static void BM_StringConcatFloat(BenchState &state) {
+  double value = 0.1;
+  for (auto _ : state) {
+    String s;
+    s += value;
+    s += 3.14159f;
+    value += 1.25;
+    benchDoNotOptimize(s.length());
+  }
+  state.setItemsProcessed(state.iterations() * 2);
+}
+BENCHMARK(BM_StringConcatFloat);
+
+static void BM_StringPlusChain(BenchState &state) {
+  String host = "192.168.4.1";
+  int port = 8080;
+  uint64_t before = alloc_count();
+  for (auto _ : state) {
+    String url = "http://" + host + ":" + port + "/api/v1/items?id=" + 12345 + "&name=" + "sensor";
+    benchDoNotOptimize(url.length());
+  }
+  REPORT_ALLOCS(state, before);
+}
+BENCHMARK(BM_StringPlusChain);
+
+// A sensor report as a JSON object, the way sketches put one together
+struct Reading {
+  String name = "living-room";
+  unsigned long uptime = 123456789;
+  float temperature = 21.5f;
+  int rssi = -67;
+};
+
+static void BM_StringJsonPlus(BenchState &state) {
+  Reading r;
+  uint64_t before = alloc_count();
+  for (auto _ : state) {
+    String json = "{\"name\":\"" + r.name + "\",\"uptime\":" + r.uptime + ",\"temperature\":" + r.temperature + ",\"rssi\":" + r.rssi + "}";
+    benchDoNotOptimize(json.length());
+  }
+  REPORT_ALLOCS(state, before);
+}
+BENCHMARK(BM_StringJsonPlus);
+
+static void BM_StringJsonAppend(BenchState &state) {
+  Reading r;
+  uint64_t before = alloc_count();
+  for (auto _ : state) {
+    String json;
+    json += "{\"name\":\"";
+    json += r.name;
+    json += "\",\"uptime\":";
+    json += r.uptime;
+    json += ",\"temperature\":";
+    json += r.temperature;
+    json += ",\"rssi\":";
+    json += r.rssi;
+    json += "}";
+    benchDoNotOptimize(json.length());
+  }
+  REPORT_ALLOCS(state, before);
+}
+BENCHMARK(BM_StringJsonAppend);
+
+static void BM_StringJsonBuilder(BenchState &state) {
+  Reading r;
+  uint64_t before = alloc_count();
+  for (auto _ : state) {
+    String json = StringBuilder("{\"name\":\"", r.name, "\",\"uptime\":", r.uptime, ",\"temperature\":", r.temperature, ",\"rssi\":", r.rssi, '}');
+    benchDoNotOptimize(json.length());
+  }
+  REPORT_ALLOCS(state, before);
+}
+BENCHMARK(BM_StringJsonBuilder);
+
+// A status page with one table row per entry, as WebServer handlers send them
+static void BM_StringHtmlTable(BenchState &state) {
+  uint64_t before = alloc_count();
+  for (auto _ : state) {
+    String html = "<html><body><table>";
+    for (int64_t i = 0; i < state.range(0); i++) {
+      html += "<tr><td>";
+      html += (int)i;
+      html += "</td><td>sensor-";
+      html += (int)i;
+      html += "</td><td>";
+      html += 20.0f + i / 8.0f;
+      html += "</td></tr>\n";
+    }
+    html += "</table></body></html>";
+    benchDoNotOptimize(html.length());
+  }
+  REPORT_ALLOCS(state, before);
+  state.setItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_StringHtmlTable)->Arg(8)->Arg(64);
+
+static void BM_StringHtmlTableConcatAll(BenchState &state) {
+  uint64_t before = alloc_count();
+  for (auto _ : state) {
+    String html = "<html><body><table>";
+    for (int64_t i = 0; i < state.range(0); i++) {
+      html.concatAll("<tr><td>", (int)i, "</td><td>sensor-", (int)i, "</td><td>", 20.0f + i / 8.0f, "</td></tr>\n");
+    }
+    html += "</table></body></html>";
+    benchDoNotOptimize(html.length());
+  }
+  REPORT_ALLOCS(state, before);
+  state.setItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_StringHtmlTableConcatAll)->Arg(8)->Arg(64);
+
+static void BM_StringIntConstructor(BenchState &state) {
+  unsigned int value = 1;
+  for (auto _ : state) {
+    String s(value * 2654435761U, HEX);
+    String d(value++);
+    benchDoNotOptimize(s.length() + d.length());
+  }
+}
+BENCHMARK(BM_StringIntConstructor);
+
+static void BM_StringReplace(BenchState &state) {
+  String text;
+  for (int i = 0; i < 32; i++) {
+    text += "the quick brown fox jumps over the lazy dog ";
+  }
+  for (auto _ : state) {
+    String s = text;
+    s.replace("fox", "cat");
+    s.replace(" ", "%20");
+    benchDoNotOptimize(s.length());
+  }
+  state.setBytesProcessed(state.iterations() * text.length());
+}
+BENCHMARK(BM_StringReplace);
+
+static void BM_StringIndexOf(BenchState &state) {
+  String text;
+  for (int i = 0; i < 64; i++) {
+    text += "Content-Type: text/html\r\n";
+  }
+  text += "Content-Length: 42\r\n";
+  for (auto _ : state) {
+    benchDoNotOptimize(text.indexOf("Content-Length"));
+  }
+  state.setBytesProcessed(state.iterations() * text.length());
+}
+BENCHMARK(BM_StringIndexOf);
+
+static void BM_StringToInt(BenchState &state) {
+  String number = "-1234567";
+  String real = "3.14159";
+  for (auto _ : state) {
+    benchDoNotOptimize(number.toInt());
+    benchDoNotOptimize(real.toFloat());
+  }
+}
+BENCHMARK(BM_StringToInt);
+
+static void BM_PrintInt(BenchState &state) {
+  NullPrint out;
+  long value = 1;
+  for (auto _ : state) {
+    out.print(value);
+    out.print((unsigned long)value, HEX);
+    value = value * 7 + 1;
+  }
+  benchDoNotOptimize(out.written);
+  state.setItemsProcessed(state.iterations() * 2);
+}
+BENCHMARK(BM_PrintInt);
+
+static void BM_PrintFloat(BenchState &state) {
+  NullPrint out;
+  double value = 0.5;
+  for (auto _ : state) {
+    out.print(value, 2);
+    out.print(value * 1e6, 6);
+    value += 0.37;
+  }
+  benchDoNotOptimize(out.written);
+  state.setItemsProcessed(state.iterations() * 2);
+}
+BENCHMARK(BM_PrintFloat);
+
+BENCHMARK_MAIN();
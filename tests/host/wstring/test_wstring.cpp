@@ -0,0 +1,187 @@
+/*
+ * Host tests for String growth: geometric capacity growth on append, exact
+ * reserve(), concatAll()/StringBuilder and buffers taken over from temporaries.
+ */
+
+#include <limits.h>
+#include <utility>
+#include <unity.h>
+#include "WString.h"
+
+// exposes the capacity of the buffer
+class InspectString : public String {
+public:
+  using String::String;
+  unsigned int cap() const {
+    return capacity();
+  }
+};
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_wstring_append_grows_geometrically(void) {
+  InspectString s;
+  unsigned int changes = 0;
+  unsigned int last = s.cap();
+  for (int i = 0; i < 4000; i++) {
+    s += 'x';
+    if (s.cap() != last) {
+      changes++;
+      TEST_ASSERT_GREATER_OR_EQUAL(last + last / 2, s.cap());
+      last = s.cap();
+    }
+  }
+  TEST_ASSERT_EQUAL(4000, s.length());
+  // 16 byte steps would take 250
+  TEST_ASSERT_LESS_THAN(20, changes);
+  for (unsigned int i = 0; i < s.length(); i++) {
+    TEST_ASSERT_EQUAL('x', s[i]);
+  }
+}
+
+void test_wstring_reserve_is_exact(void) {
+  InspectString s;
+  TEST_ASSERT_TRUE(s.reserve(100));
+  TEST_ASSERT_GREATER_OR_EQUAL(100, s.cap());
+  TEST_ASSERT_LESS_THAN(120, s.cap());
+  s += "short";
+  TEST_ASSERT_LESS_THAN(120, s.cap());
+  TEST_ASSERT_FALSE(s.reserve(70000));
+  TEST_ASSERT_EQUAL_STRING("short", s.c_str());
+}
+
+void test_wstring_append_near_capacity_max(void) {
+  // the geometric size would pass the limit, the exact one still fits
+  String s;
+  String chunk;
+  for (int i = 0; i < 1000; i++) {
+    chunk += 'y';
+  }
+  for (int i = 0; i < 65; i++) {
+    TEST_ASSERT_TRUE(s.concat(chunk));
+  }
+  TEST_ASSERT_EQUAL(65000, s.length());
+  TEST_ASSERT_TRUE(s.concat(chunk.c_str(), 500));
+  TEST_ASSERT_EQUAL(65500, s.length());
+  TEST_ASSERT_FALSE(s.concat(chunk));
+  TEST_ASSERT_EQUAL(65500, s.length());
+}
+
+void test_wstring_self_append(void) {
+  String s = "abcdefghijklmnop";
+  s += s;
+  s += s.c_str();
+  TEST_ASSERT_EQUAL_STRING("abcdefghijklmnopabcdefghijklmnopabcdefghijklmnopabcdefghijklmnop", s.c_str());
+}
+
+void test_wstring_concat_all(void) {
+  String expected;
+  expected += "id=";
+  expected += -42;
+  expected += ',';
+  expected += 3000000000U;
+  expected += ',';
+  expected += LLONG_MIN;
+  expected += ',';
+  expected += 2.5f;
+  expected += ',';
+  expected += -1e12;
+  expected += ',';
+  expected += (unsigned char)200;
+  expected += ',';
+  expected += String("tail");
+
+  String s = "id=";
+  TEST_ASSERT_TRUE(s.concatAll(-42, ',', 3000000000U, ',', LLONG_MIN, ',', 2.5f, ',', -1e12, ',', (unsigned char)200, ',', String("tail")));
+  TEST_ASSERT_EQUAL_STRING(expected.c_str(), s.c_str());
+  TEST_ASSERT_TRUE(s.concatAll());
+  TEST_ASSERT_EQUAL_STRING(expected.c_str(), s.c_str());
+}
+
+void test_wstring_concat_all_reserves_once(void) {
+  InspectString s;
+  s.concatAll("{\"name\":\"", "living-room-sensor", "\",\"uptime\":", 123456789UL, ",\"temperature\":", 21.5, '}');
+  TEST_ASSERT_EQUAL_STRING("{\"name\":\"living-room-sensor\",\"uptime\":123456789,\"temperature\":21.50}", s.c_str());
+  // one allocation, sized from the parts rather than grown
+  TEST_ASSERT_LESS_THAN(s.length() + 32, s.cap());
+}
+
+void test_wstring_concat_all_failure_leaves_string(void) {
+  String s = "keep";
+  const char *none = nullptr;
+  TEST_ASSERT_FALSE(s.concatAll(" this", none, " not this"));
+  TEST_ASSERT_EQUAL_STRING("keep", s.c_str());
+}
+
+void test_wstring_builder(void) {
+  String host = "192.168.4.1";
+  String url = StringBuilder("http://", host, ':', 8080, "/items?id=", 12345UL, "&t=", 20.125f);
+  TEST_ASSERT_EQUAL_STRING("http://192.168.4.1:8080/items?id=12345&t=20.13", url.c_str());
+  String empty = StringBuilder();
+  TEST_ASSERT_TRUE(empty);
+  TEST_ASSERT_EQUAL(0, empty.length());
+  const char *none = nullptr;
+  String invalid = StringBuilder("a", none);
+  TEST_ASSERT_FALSE(invalid);
+}
+
+void test_wstring_sum_takes_temporary_buffer(void) {
+  String t;
+  t.reserve(100);
+  t = "a string long enough to live on the heap";
+  const char *buffer = t.c_str();
+  TEST_ASSERT_TRUE((std::move(t) + " and more").c_str() == buffer);
+
+  // a named sum is copied, an rvalue one is taken
+  StringSumHelper sum(String("a sum long enough to live on the heap"));
+  sum + " and more";
+  String a = sum;
+  String b;
+  b = sum;
+  TEST_ASSERT_EQUAL_STRING("a sum long enough to live on the heap and more", a.c_str());
+  TEST_ASSERT_EQUAL_STRING(a.c_str(), b.c_str());
+  TEST_ASSERT_EQUAL_STRING(a.c_str(), sum.c_str());
+  buffer = sum.c_str();
+  String r = std::move(sum);
+  TEST_ASSERT_TRUE(r.c_str() == buffer);
+  TEST_ASSERT_EQUAL_STRING(a.c_str(), r.c_str());
+
+  String host = "example.com";
+  String chain = String(443) + ":" + host + "/" + 1.5 + '/' + -7L;
+  TEST_ASSERT_EQUAL_STRING("443:example.com/1.50/-7", chain.c_str());
+  // the lvalue operands are copied, not taken
+  TEST_ASSERT_EQUAL_STRING("example.com", host.c_str());
+}
+
+void test_wstring_append_takes_temporary_buffer(void) {
+  String part = "another string long enough for the heap";
+  const char *buffer = part.c_str();
+  String s;
+  s += std::move(part);
+  TEST_ASSERT_TRUE(s.c_str() == buffer);
+  s += String(" tail");
+  TEST_ASSERT_EQUAL_STRING("another string long enough for the heap tail", s.c_str());
+  // an invalid string is not taken
+  String other;
+  TEST_ASSERT_FALSE(other.concat(String((const char *)nullptr)));
+  TEST_ASSERT_TRUE(other);
+  TEST_ASSERT_TRUE(other.concat(String("x")));
+  TEST_ASSERT_EQUAL_STRING("x", other.c_str());
+}
+
+int main(void) {
+  UNITY_BEGIN();
+  RUN_TEST(test_wstring_append_grows_geometrically);
+  RUN_TEST(test_wstring_reserve_is_exact);
+  RUN_TEST(test_wstring_append_near_capacity_max);
+  RUN_TEST(test_wstring_self_append);
+  RUN_TEST(test_wstring_concat_all);
+  RUN_TEST(test_wstring_concat_all_reserves_once);
+  RUN_TEST(test_wstring_concat_all_failure_leaves_string);
+  RUN_TEST(test_wstring_builder);
+  RUN_TEST(test_wstring_sum_takes_temporary_buffer);
+  RUN_TEST(test_wstring_append_takes_temporary_buffer);
+  return UNITY_END();
+}
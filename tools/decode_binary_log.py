@@ -0,0 +1,285 @@
+#!/usr/bin/env python3
+"""
+Binary Log Decoder for ESP32 Arduino
+
+Turns the record stream written in LOG_BINARY_RAW mode (see log_binary_set_mode()
+in cores/esp32/esp32-hal-log.h) back into text. The format strings, and the
+constant strings passed as %s arguments, are read from the ELF file of the
+firmware that produced the log.
+
+Usage:
+    python decode_binary_log.py firmware.elf capture.bin
+    python decode_binary_log.py firmware.elf < capture.bin > capture.txt
+    python decode_binary_log.py --level warn firmware.elf capture.bin
+"""
+
+import argparse
+import struct
+import sys
+
+SYNC = 0xB5
+TYPE_MASK = 0x70
+TYPE_LOG = 0x00
+TYPE_HEADER = 0x10
+INFO_TRUNCATED = 0x80
+INFO_LEVEL = 0x0F
+# ARDUHAL_LOG_LEVEL_*, records of log_printf() have none and are always shown
+LEVELS = ["none", "error", "warn", "info", "debug", "verbose"]
+STR_NULL = 0
+STR_REF = 1
+STR_INLINE = 2
+ANCHOR = b"arduhal-binary-log-anchor-v1\0"
+
+SHF_ALLOC = 0x2
+SHT_NOBITS = 8
+
+
+class Elf:
+    """Read-only view of the allocated sections of an ELF file"""
+
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            self.data = f.read()
+        if self.data[:4] != b"\x7fELF":
+            raise ValueError(f"{path} is not an ELF file")
+        if self.data[5] != 1:
+            raise ValueError("only little endian ELF files are supported")
+        is64 = self.data[4] == 2
+        if is64:
+            shoff, shentsize, shnum = struct.unpack_from("<Q10xHH", self.data, 0x28)
+            shdr = "<IIQQQQ"
+        else:
+            shoff, shentsize, shnum = struct.unpack_from("<I10xHH", self.data, 0x20)
+            shdr = "<IIIIII"
+        self.sections = []
+        for i in range(shnum):
+            _, sh_type, sh_flags, sh_addr, sh_offset, sh_size = struct.unpack_from(shdr, self.data, shoff + i * shentsize)
+            if sh_flags & SHF_ALLOC and sh_type != SHT_NOBITS and sh_size:
+                self.sections.append((sh_addr, sh_offset, sh_size))
+
+    def find(self, needle):
+        """Address of the first occurrence of needle in the allocated sections"""
+        for addr, offset, size in self.sections:
+            pos = self.data.find(needle, offset, offset + size)
+            if pos >= 0:
+                return addr + pos - offset
+        return None
+
+    def string(self, addr):
+        """NUL terminated string at addr, or None"""
+        for start, offset, size in self.sections:
+            if start <= addr < start + size:
+                begin = offset + addr - start
+                end = self.data.find(b"\0", begin, offset + size)
+                return self.data[begin : end if end >= 0 else offset + size]
+        return None
+
+
+class Reader:
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def get(self, fmt):
+        size = struct.calcsize(fmt)
+        if self.pos + size > len(self.data):
+            raise EOFError
+        value = struct.unpack_from(fmt, self.data, self.pos)
+        self.pos += size
+        return value[0] if len(value) == 1 else value
+
+    def bytes(self, size):
+        if self.pos + size > len(self.data):
+            raise EOFError
+        value = self.data[self.pos : self.pos + size]
+        self.pos += size
+        return value
+
+
+def int_format(length, ptr_size):
+    if length in ("ll", "j"):
+        return "q"
+    if length in ("l", "z", "t"):
+        return "q" if ptr_size == 8 else "i"
+    return "i"
+
+
+def pad(text, flags, width):
+    if len(text) >= width:
+        return text
+    if "-" in flags:
+        return text + " " * (width - len(text))
+    return " " * (width - len(text)) + text
+
+
+def parse_spec(fmt, pos):
+    """Parses the conversion at fmt[pos] == '%', returns (end, flags, width, precision, length, conv)"""
+    pos += 1
+    start = pos
+    while pos < len(fmt) and fmt[pos] in "-+ #0":
+        pos += 1
+    flags = fmt[start:pos]
+    width = None
+    if pos < len(fmt) and fmt[pos] == "*":
+        width = "*"
+        pos += 1
+    else:
+        start = pos
+        while pos < len(fmt) and fmt[pos].isdigit():
+            pos += 1
+        width = int(fmt[start:pos]) if pos > start else 0
+    precision = -1
+    if pos < len(fmt) and fmt[pos] == ".":
+        pos += 1
+        if pos < len(fmt) and fmt[pos] == "*":
+            precision = "*"
+            pos += 1
+        else:
+            start = pos
+            while pos < len(fmt) and fmt[pos].isdigit():
+                pos += 1
+            precision = int(fmt[start:pos]) if pos > start else 0
+    length = ""
+    for mod in ("hh", "h", "ll", "l", "j", "z", "t", "L"):
+        if fmt.startswith(mod, pos):
+            length = mod
+            pos += len(mod)
+            break
+    conv = fmt[pos] if pos < len(fmt) else ""
+    return pos + (1 if conv else 0), flags, width, precision, length, conv
+
+
+def render(elf, slide, ptr_size, fmt, args):
+    """Formats one record the way printf() would have on the device"""
+    ptr = "<Q" if ptr_size == 8 else "<I"
+    out = []
+    pos = 0
+    while pos < len(fmt):
+        if fmt[pos] != "%":
+            end = fmt.find("%", pos)
+            end = len(fmt) if end < 0 else end
+            out.append(fmt[pos:end])
+            pos = end
+            continue
+        spec_start = pos
+        pos, flags, width, precision, length, conv = parse_spec(fmt, pos)
+        try:
+            if width == "*":
+                width = args.get("<i")
+                if width < 0:
+                    flags += "-"
+                    width = -width
+            if precision == "*":
+                precision = args.get("<i")
+            if conv and conv in "diu":
+                flags = flags.replace("#", "")
+            spec = "%" + flags + (str(width) if width else "") + ("." + str(precision) if precision >= 0 else "")
+            if conv and conv in "diuoxXc":
+                size = int_format(length, ptr_size)
+                value = args.get("<" + (size.upper() if conv in "uoxX" else size))
+                if length == "hh":
+                    value = value & 0xFF if conv in "uoxX" else struct.unpack("<b", struct.pack("<B", value & 0xFF))[0]
+                elif length == "h":
+                    value = value & 0xFFFF if conv in "uoxX" else struct.unpack("<h", struct.pack("<H", value & 0xFFFF))[0]
+                if conv == "c":
+                    out.append(pad(chr(value & 0xFF), flags, width))
+                elif conv == "o" and "#" in flags:
+                    digits = ("%." + str(precision) + "o") % value if precision >= 0 else "%o" % value
+                    out.append(pad(digits if digits.startswith("0") else "0" + digits, flags, width))
+                else:
+                    out.append((spec + ("d" if conv in "diu" else conv)) % value)
+            elif conv == "p":
+                out.append(pad("0x%x" % args.get(ptr), flags, width))
+            elif conv == "s":
+                kind = args.get("<B")
+                if kind == STR_NULL:
+                    text = "(null)"
+                elif kind == STR_REF:
+                    addr = args.get(ptr)
+                    raw = elf.string(addr - slide)
+                    text = raw.decode("latin-1") if raw is not None else "<0x%x>" % addr
+                else:
+                    text = args.bytes(args.get("<B")).decode("latin-1")
+                out.append((spec + "s") % text)
+            elif conv and conv in "fFeEgG":
+                out.append((spec + conv) % args.get("<d"))
+            elif conv and conv in "aA":
+                mantissa, exponent = float.hex(args.get("<d")).split("p")
+                text = mantissa.rstrip("0").rstrip(".") + "p" + exponent
+                out.append(pad(text.upper() if conv == "A" else text, flags, width))
+            elif conv == "n":
+                pass
+            elif conv == "%":
+                out.append("%")
+            else:
+                out.append(fmt[spec_start:pos])
+        except EOFError:
+            # the rest of the arguments did not fit into the record
+            out.append("...\r\n")
+            break
+    return "".join(out)
+
+
+def decode(elf, stream, out, max_level=len(LEVELS) - 1):
+    ptr_size = 4
+    slide = 0
+    pos = 0
+    while pos + 4 <= len(stream):
+        if stream[pos] != SYNC:
+            pos += 1
+            continue
+        info, length = stream[pos + 1], struct.unpack_from("<H", stream, pos + 2)[0]
+        payload = stream[pos + 4 : pos + 4 + length]
+        if len(payload) < length:
+            break
+        kind = info & TYPE_MASK
+        if kind == TYPE_HEADER and length >= 8 and payload[1] in (4, 8):
+            ptr_size = payload[1]
+            anchor = struct.unpack_from("<Q" if ptr_size == 8 else "<I", payload, 4)[0]
+            elf_anchor = elf.find(ANCHOR)
+            slide = anchor - elf_anchor if elf_anchor is not None else 0
+        elif kind == TYPE_LOG and length >= 4 + ptr_size:
+            if (info & INFO_LEVEL) > max_level:
+                pos += 4 + length
+                continue
+            args = Reader(payload)
+            args.get("<I")  # timestamp, the log formats already print one
+            fmt_addr = args.get("<Q" if ptr_size == 8 else "<I")
+            fmt = elf.string(fmt_addr - slide)
+            if fmt is None:
+                out.write(b"<unknown format 0x%x>\n" % fmt_addr)
+            else:
+                out.write(render(elf, slide, ptr_size, fmt.decode("latin-1"), args).encode("latin-1"))
+        else:
+            # not a record boundary, resynchronize
+            pos += 1
+            continue
+        pos += 4 + length
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode ESP32 Arduino binary log records")
+    parser.add_argument("elf", help="ELF file of the firmware that wrote the log")
+    parser.add_argument("log", nargs="?", help="captured binary log (default: stdin)")
+    parser.add_argument("-o", "--output", help="decoded text output (default: stdout)")
+    parser.add_argument("-l", "--level", choices=LEVELS[1:], default=LEVELS[-1], help="most verbose level shown (default: verbose)")
+    args = parser.parse_args()
+    max_level = LEVELS.index(args.level)
+
+    elf = Elf(args.elf)
+    if args.log:
+        with open(args.log, "rb") as f:
+            stream = f.read()
+    else:
+        stream = sys.stdin.buffer.read()
+
+    if args.output:
+        with open(args.output, "wb") as out:
+            decode(elf, stream, out, max_level)
+    else:
+        decode(elf, stream, sys.stdout.buffer, max_level)
+        sys.stdout.buffer.flush()
+
+
+if __name__ == "__main__":
+    main()